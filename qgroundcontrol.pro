@@ -193,6 +193,26 @@ contains (DEFINES, QGC_DISABLE_UVC) {
     }
 }
 
+# Performance tracing (QGC_TRACE_* macros)
+contains (DEFINES, QGC_DISABLE_TRACING) {
+    message("Skipping support for performance tracing (manual override from command line)")
+} else:exists(user_config.pri):infile(user_config.pri, DEFINES, QGC_DISABLE_TRACING) {
+    message("Skipping support for performance tracing (manual override from user_config.pri)")
+    DEFINES += QGC_DISABLE_TRACING
+}
+
+# KMZ import uses the zip reader from Qt's private headers
+contains (DEFINES, QGC_DISABLE_KMZ) {
+    message("Skipping support for KMZ import (manual override from command line)")
+} else:exists(user_config.pri):infile(user_config.pri, DEFINES, QGC_DISABLE_KMZ) {
+    message("Skipping support for KMZ import (manual override from user_config.pri)")
+} else:qtHaveModule(gui_private) {
+    QT      += gui-private
+    DEFINES += QGC_ENABLE_KMZ
+} else {
+    message("Skipping support for KMZ import (Qt private headers not available)")
+}
+
 LinuxBuild {
     CONFIG += link_pkgconfig
 }
@@ -438,20 +458,35 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/MissionManager/SurveyComplexItemTest.h \
         src/MissionManager/TransectStyleComplexItemTest.h \
         src/MissionManager/VisualMissionItemTest.h \
+        src/QGCTracerTest.h \
+        src/QmlControls/AppMessagesTest.h \
+        src/QmlControls/ParameterSearchIndexTest.h \
         src/qgcunittest/FileDialogTest.h \
         src/qgcunittest/FileManagerTest.h \
         src/qgcunittest/FlightGearTest.h \
         src/qgcunittest/GeoTest.h \
+        src/qgcunittest/KMLFileHelperTest.h \
         src/qgcunittest/LinkManagerTest.h \
+        src/qgcunittest/LinkMetricsTest.h \
+        src/qgcunittest/LinechartPlotTest.h \
         src/qgcunittest/MainWindowTest.h \
         src/qgcunittest/MavlinkLogTest.h \
         src/qgcunittest/MessageBoxTest.h \
+        src/qgcunittest/MockLinkSwarmTest.h \
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/RadioConfigTest.h \
+        src/qgcunittest/SerialPortWatcherTest.h \
         src/qgcunittest/TCPLinkTest.h \
         src/qgcunittest/TCPLoopBackServer.h \
+        src/qgcunittest/UDPLinkTest.h \
         src/qgcunittest/UnitTest.h \
+        src/qgcunittest/XPlaneLinkTest.h \
+        src/Vehicle/MAVLinkMessageDispatcherTest.h \
         src/Vehicle/SendMavCommandTest.h \
+        src/Vehicle/TimesyncEstimatorTest.h \
+        src/Vehicle/VehicleStateServerTest.h \
+        src/VideoStreaming/VideoReceiverPoolTest.h \
+        src/VideoStreaming/VideoReceiverTest.h \
 
     SOURCES += \
         src/AnalyzeView/LogDownloadTest.cc \
@@ -479,21 +514,36 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/MissionManager/SurveyComplexItemTest.cc \
         src/MissionManager/TransectStyleComplexItemTest.cc \
         src/MissionManager/VisualMissionItemTest.cc \
+        src/QGCTracerTest.cc \
+        src/QmlControls/AppMessagesTest.cc \
+        src/QmlControls/ParameterSearchIndexTest.cc \
         src/qgcunittest/FileDialogTest.cc \
         src/qgcunittest/FileManagerTest.cc \
         src/qgcunittest/FlightGearTest.cc \
         src/qgcunittest/GeoTest.cc \
+        src/qgcunittest/KMLFileHelperTest.cc \
         src/qgcunittest/LinkManagerTest.cc \
+        src/qgcunittest/LinkMetricsTest.cc \
+        src/qgcunittest/LinechartPlotTest.cc \
         src/qgcunittest/MainWindowTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
         src/qgcunittest/MessageBoxTest.cc \
+        src/qgcunittest/MockLinkSwarmTest.cc \
         src/qgcunittest/MultiSignalSpy.cc \
         src/qgcunittest/RadioConfigTest.cc \
+        src/qgcunittest/SerialPortWatcherTest.cc \
         src/qgcunittest/TCPLinkTest.cc \
         src/qgcunittest/TCPLoopBackServer.cc \
+        src/qgcunittest/UDPLinkTest.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
+        src/qgcunittest/XPlaneLinkTest.cc \
+        src/Vehicle/MAVLinkMessageDispatcherTest.cc \
         src/Vehicle/SendMavCommandTest.cc \
+        src/Vehicle/TimesyncEstimatorTest.cc \
+        src/Vehicle/VehicleStateServerTest.cc \
+        src/VideoStreaming/VideoReceiverPoolTest.cc \
+        src/VideoStreaming/VideoReceiverTest.cc \
 } } } } } }
 
 # Main QGC Headers and Source files
@@ -541,6 +591,7 @@ HEADERS += \
     src/MissionManager/QGCFencePolygon.h \
     src/MissionManager/QGCMapCircle.h \
     src/MissionManager/QGCMapPolygon.h \
+    src/MissionManager/QGCMapPolygonVertexModel.h \
     src/MissionManager/QGCMapPolyline.h \
     src/MissionManager/RallyPoint.h \
     src/MissionManager/RallyPointController.h \
@@ -567,12 +618,15 @@ HEADERS += \
     src/QGCQGeoCoordinate.h \
     src/QGCQmlWidgetHolder.h \
     src/QGCQuickWidget.h \
+    src/QGCStartupTracer.h \
     src/QGCTemporaryFile.h \
     src/QGCToolbox.h \
+    src/QGCTracer.h \
     src/QmlControls/AppMessages.h \
     src/QmlControls/CoordinateVector.h \
     src/QmlControls/EditPositionDialogController.h \
     src/QmlControls/ParameterEditorController.h \
+    src/QmlControls/ParameterSearchIndex.h \
     src/QmlControls/QGCFileDialogController.h \
     src/QmlControls/QGCImageProvider.h \
     src/QmlControls/QGroundControlQmlGlobal.h \
@@ -593,10 +647,15 @@ HEADERS += \
     src/Terrain/TerrainQuery.h \
     src/TerrainTile.h \
     src/Vehicle/MAVLinkLogManager.h \
+    src/Vehicle/MAVLinkMessageDispatcher.h \
+    src/Vehicle/TimesyncEstimator.h \
+    src/Vehicle/VehicleStateServer.h \
     src/VehicleSetup/JoystickConfigController.h \
     src/comm/LinkConfiguration.h \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
+    src/comm/LinkMetricsFactGroup.h \
+    src/comm/MAVLinkDecodePlan.h \
     src/comm/MAVLinkProtocol.h \
     src/comm/ProtocolInterface.h \
     src/comm/QGCMAVLink.h \
@@ -617,6 +676,7 @@ HEADERS += \
     src/comm/MockLink.h \
     src/comm/MockLinkFileServer.h \
     src/comm/MockLinkMissionItemHandler.h \
+    src/comm/MockLinkSwarmBenchmark.h \
 }
 
 WindowsBuild {
@@ -635,6 +695,7 @@ contains(DEFINES, QGC_ENABLE_BLUETOOTH) {
 HEADERS += \
     src/comm/QGCSerialPortInfo.h \
     src/comm/SerialLink.h \
+    src/comm/SerialPortWatcher.h \
 }
 
 !MobileBuild {
@@ -737,6 +798,7 @@ SOURCES += \
     src/MissionManager/QGCFencePolygon.cc \
     src/MissionManager/QGCMapCircle.cc \
     src/MissionManager/QGCMapPolygon.cc \
+    src/MissionManager/QGCMapPolygonVertexModel.cc \
     src/MissionManager/QGCMapPolyline.cc \
     src/MissionManager/RallyPoint.cc \
     src/MissionManager/RallyPointController.cc \
@@ -761,12 +823,15 @@ SOURCES += \
     src/QGCQGeoCoordinate.cc \
     src/QGCQmlWidgetHolder.cpp \
     src/QGCQuickWidget.cc \
+    src/QGCStartupTracer.cc \
     src/QGCTemporaryFile.cc \
     src/QGCToolbox.cc \
+    src/QGCTracer.cc \
     src/QmlControls/AppMessages.cc \
     src/QmlControls/CoordinateVector.cc \
     src/QmlControls/EditPositionDialogController.cc \
     src/QmlControls/ParameterEditorController.cc \
+    src/QmlControls/ParameterSearchIndex.cc \
     src/QmlControls/QGCFileDialogController.cc \
     src/QmlControls/QGCImageProvider.cc \
     src/QmlControls/QGroundControlQmlGlobal.cc \
@@ -787,10 +852,15 @@ SOURCES += \
     src/Terrain/TerrainQuery.cc \
     src/TerrainTile.cc\
     src/Vehicle/MAVLinkLogManager.cc \
+    src/Vehicle/MAVLinkMessageDispatcher.cc \
+    src/Vehicle/TimesyncEstimator.cc \
+    src/Vehicle/VehicleStateServer.cc \
     src/VehicleSetup/JoystickConfigController.cc \
     src/comm/LinkConfiguration.cc \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
+    src/comm/LinkMetricsFactGroup.cc \
+    src/comm/MAVLinkDecodePlan.cc \
     src/comm/MAVLinkProtocol.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
@@ -805,12 +875,14 @@ SOURCES += \
     src/comm/MockLink.cc \
     src/comm/MockLinkFileServer.cc \
     src/comm/MockLinkMissionItemHandler.cc \
+    src/comm/MockLinkSwarmBenchmark.cc \
 }
 
 !NoSerialBuild {
 SOURCES += \
     src/comm/QGCSerialPortInfo.cc \
     src/comm/SerialLink.cc \
+    src/comm/SerialPortWatcher.cc \
 }
 
 contains(DEFINES, QGC_ENABLE_BLUETOOTH) {
@@ -1065,6 +1137,7 @@ HEADERS += \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValueSliderListModel.h \
     src/FactSystem/ParameterManager.h \
+    src/FactSystem/ParameterMetaDataCache.h \
     src/FactSystem/SettingsFact.h \
 
 SOURCES += \
@@ -1075,6 +1148,7 @@ SOURCES += \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValueSliderListModel.cc \
     src/FactSystem/ParameterManager.cc \
+    src/FactSystem/ParameterMetaDataCache.cc \
     src/FactSystem/SettingsFact.cc \
 
 #-------------------------------------------------------------------------------------
@@ -1086,6 +1160,7 @@ INCLUDEPATH += \
 HEADERS += \
     src/VideoStreaming/VideoItem.h \
     src/VideoStreaming/VideoReceiver.h \
+    src/VideoStreaming/VideoReceiverPool.h \
     src/VideoStreaming/VideoStreaming.h \
     src/VideoStreaming/VideoSurface.h \
     src/VideoStreaming/VideoSurface_p.h \
@@ -1093,6 +1168,7 @@ HEADERS += \
 SOURCES += \
     src/VideoStreaming/VideoItem.cc \
     src/VideoStreaming/VideoReceiver.cc \
+    src/VideoStreaming/VideoReceiverPool.cc \
     src/VideoStreaming/VideoStreaming.cc \
     src/VideoStreaming/VideoSurface.cc \
 
@@ -1128,6 +1204,52 @@ contains (CONFIG, QGC_DISABLE_BUILD_SETUP) {
     include(QGCSetup.pri)
 }
 
+#
+# Startup benchmark: "make startup_benchmark" boots the application once with startup tracing on and exits as
+# soon as the user interface is up, reporting the startup time. The trace file is written to the temp directory.
+#
+
+MacBuild {
+    startup_benchmark.commands = $${DESTDIR}/$${TARGET}.app/Contents/MacOS/$${TARGET} --startup-benchmark
+} else {
+    startup_benchmark.commands = $${DESTDIR}/$${TARGET} --startup-benchmark
+}
+QMAKE_EXTRA_TARGETS += startup_benchmark
+
+#
+# Swarm benchmark (debug builds only): "make swarm_benchmark" runs the application against a swarm of MockLink vehicles
+# and reports messages processed per second, gui thread latency, memory growth and cpu use per vehicle. Benchmark
+# options go in SWARM_BENCHMARK_OPTIONS, for example "make swarm_benchmark SWARM_BENCHMARK_OPTIONS=vehicles=100,loss=2".
+# See MockLinkSwarmBenchmark.h for the options. On Linux the application runs without a display.
+#
+
+DebugBuild {
+    LinuxBuild {
+        swarm_benchmark.commands = QT_QPA_PLATFORM=offscreen $${DESTDIR}/$${TARGET} --swarm-benchmark:$(SWARM_BENCHMARK_OPTIONS)
+    } else:MacBuild {
+        swarm_benchmark.commands = $${DESTDIR}/$${TARGET}.app/Contents/MacOS/$${TARGET} --swarm-benchmark:$(SWARM_BENCHMARK_OPTIONS)
+    } else {
+        swarm_benchmark.commands = $${DESTDIR}/$${TARGET} --swarm-benchmark:$(SWARM_BENCHMARK_OPTIONS)
+    }
+    QMAKE_EXTRA_TARGETS += swarm_benchmark
+
+    #
+    # Headless benchmark: "make headless_benchmark" runs the swarm benchmark twice, first with --headless and then with
+    # the user interface, so vehicles per core can be compared. Takes the same SWARM_BENCHMARK_OPTIONS.
+    #
+    MacBuild {
+        HEADLESS_BENCHMARK_APP = $${DESTDIR}/$${TARGET}.app/Contents/MacOS/$${TARGET}
+    } else {
+        HEADLESS_BENCHMARK_APP = $${DESTDIR}/$${TARGET}
+    }
+    headless_benchmark.commands = $${HEADLESS_BENCHMARK_APP} --headless --swarm-benchmark:$(SWARM_BENCHMARK_OPTIONS) $$escape_expand(\\n\\t)
+    LinuxBuild {
+        headless_benchmark.commands += QT_QPA_PLATFORM=offscreen
+    }
+    headless_benchmark.commands += $${HEADLESS_BENCHMARK_APP} --swarm-benchmark:$(SWARM_BENCHMARK_OPTIONS)
+    QMAKE_EXTRA_TARGETS += headless_benchmark
+}
+
 #
 # Installer targets
 #
@@ -323,7 +323,9 @@ QGCCameraControl::takePhoto()
         QString photoPath = qgcApp()->toolbox()->settingsManager()->appSettings()->savePath()->rawValue().toString() + QStringLiteral("/Photo");
         QDir().mkpath(photoPath);
         photoPath += + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss.zzz") + ".jpg";
-        qgcApp()->toolbox()->videoManager()->videoReceiver()->grabImage(photoPath);
+        if (qgcApp()->toolbox()->videoManager()) {
+            qgcApp()->toolbox()->videoManager()->videoReceiver()->grabImage(photoPath);
+        }
         return true;
     }
     return false;
@@ -1254,7 +1256,9 @@ QGCCameraControl::handleCaptureStatus(const mavlink_camera_capture_status_t& cap
         QString photoPath = qgcApp()->toolbox()->settingsManager()->appSettings()->savePath()->rawValue().toString() + QStringLiteral("/Photo");
         QDir().mkpath(photoPath);
         photoPath += + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss.zzz") + ".jpg";
-        qgcApp()->toolbox()->videoManager()->videoReceiver()->grabImage(photoPath);
+        if (qgcApp()->toolbox()->videoManager()) {
+            qgcApp()->toolbox()->videoManager()->videoReceiver()->grabImage(photoPath);
+        }
     }
 }
 
@@ -21,6 +21,8 @@
 #include <QDebug>
 #include <QVariantAnimation>
 #include <QJsonArray>
+#include <QtConcurrent>
+#include <QFutureWatcher>
 
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose1Log,           "ParameterManagerVerbose1Log")
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose2Log,           "ParameterManagerVerbose2Log")
@@ -57,6 +59,7 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     , _totalParamCount                  (0)
 {
     _versionParam = vehicle->firmwarePlugin()->getVersionParam();
+    _parametersReadyTimer.start();
 
     if (_vehicle->isOfflineEditingVehicle()) {
         _loadOfflineEditingParams();
@@ -93,6 +96,7 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
 
 ParameterManager::~ParameterManager()
 {
+    _discardMetaDataPrefetch();
     delete _parameterMetaData;
 }
 
@@ -277,10 +281,18 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
     }
 
     // Get parameter set version
+    bool versionChanged = false;
     if (!_versionParam.isEmpty() && _versionParam == parameterName) {
+        versionChanged = _parameterSetMajorVersion != value.toInt();
         _parameterSetMajorVersion = value.toInt();
     }
 
+    // Parse the meta data on a worker thread while the remaining parameters download. A changed parameter set
+    // version may select a different meta data file.
+    if (!_parameterMetaData && (_metaDataPrefetchFile.isEmpty() || versionChanged)) {
+        _prefetchMetaData();
+    }
+
     if (!_mapParameterName2Variant.contains(componentId) || !_mapParameterName2Variant[componentId].contains(parameterName)) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
 
@@ -1074,7 +1086,60 @@ void ParameterManager::_loadMetaData(void)
     // Load best parameter meta data set
     metaDataFile = parameterMetaDataFile(_vehicle, _vehicle->firmwareType(), _parameterSetMajorVersion, majorVersion, minorVersion);
     qCDebug(ParameterManagerLog) << "Loading meta data file:major:minor" << metaDataFile << majorVersion << minorVersion;
-    _parameterMetaData = _vehicle->firmwarePlugin()->loadParameterMetaData(metaDataFile);
+
+    if (!_metaDataPrefetchFile.isEmpty() && _metaDataPrefetchFile == metaDataFile) {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        _parameterMetaData = _metaDataPrefetch.result();
+        _metaDataPrefetchFile.clear();
+        qCDebug(ParameterManagerLog) << "Meta data taken from prefetch, waited (msecs):" << waitTimer.elapsed();
+    } else {
+        _discardMetaDataPrefetch();
+        _parameterMetaData = _vehicle->firmwarePlugin()->loadParameterMetaData(metaDataFile);
+    }
+}
+
+/// Starts loading the meta data for the current parameter set version on a worker thread. _loadMetaData picks up
+/// the result if the meta data file still matches by then.
+void ParameterManager::_prefetchMetaData(void)
+{
+    int majorVersion, minorVersion;
+
+    QString metaDataFile = parameterMetaDataFile(_vehicle, _vehicle->firmwareType(), _parameterSetMajorVersion, majorVersion, minorVersion);
+    if (metaDataFile == _metaDataPrefetchFile) {
+        return;
+    }
+    _discardMetaDataPrefetch();
+
+    qCDebug(ParameterManagerLog) << "Prefetching meta data file:major:minor" << metaDataFile << majorVersion << minorVersion;
+
+    FirmwarePlugin* firmwarePlugin  = _vehicle->firmwarePlugin();
+    QThread*        ownerThread     = thread();
+    _metaDataPrefetchFile = metaDataFile;
+    _metaDataPrefetch = QtConcurrent::run([firmwarePlugin, metaDataFile, ownerThread]() -> QObject* {
+        QObject* metaData = firmwarePlugin->loadParameterMetaData(metaDataFile);
+        if (metaData) {
+            metaData->moveToThread(ownerThread);
+        }
+        return metaData;
+    });
+}
+
+/// Drops an outstanding prefetch without waiting for it, the meta data is deleted once the worker is done
+void ParameterManager::_discardMetaDataPrefetch(void)
+{
+    if (_metaDataPrefetchFile.isEmpty()) {
+        return;
+    }
+    _metaDataPrefetchFile.clear();
+
+    QFutureWatcher<QObject*>* watcher = new QFutureWatcher<QObject*>();
+    connect(watcher, &QFutureWatcher<QObject*>::finished, [watcher]() {
+        delete watcher->result();
+        watcher->deleteLater();
+    });
+    watcher->setFuture(_metaDataPrefetch);
+    _metaDataPrefetch = QFuture<QObject*>();
 }
 
 void ParameterManager::_addMetaDataToDefaultComponent(void)
@@ -1157,6 +1222,8 @@ void ParameterManager::_checkInitialLoadComplete(void)
         }
     }
 
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Time to parameters ready (msecs):" << _parametersReadyTimer.elapsed();
+
     // Signal load complete
     _parametersReady = true;
     _vehicle->autopilotPlugin()->parametersReadyPreChecks();
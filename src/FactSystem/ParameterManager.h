@@ -16,6 +16,8 @@
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QFuture>
+#include <QElapsedTimer>
 
 #include "FactSystem.h"
 #include "MAVLinkProtocol.h"
@@ -134,6 +136,8 @@ private:
     void _writeLocalParamCache(int vehicleId, int componentId);
     void _tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value);
     void _loadMetaData(void);
+    void _prefetchMetaData(void);
+    void _discardMetaDataPrefetch(void);
     void _clearMetaData(void);
     void _addMetaDataToDefaultComponent(void);
     QString _remapParamNameToVersion(const QString& paramName);
@@ -164,6 +168,9 @@ private:
     QString     _versionParam;                  ///< Parameter which contains parameter set version
     int         _parameterSetMajorVersion;      ///< Version for parameter set, -1 if not known
     QObject*    _parameterMetaData;             ///< Opaque data from FirmwarePlugin::loadParameterMetaDataCall
+    QFuture<QObject*> _metaDataPrefetch;        ///< Meta data being loaded on a worker thread while parameters download
+    QString     _metaDataPrefetchFile;          ///< Meta data file being prefetched, empty if no prefetch outstanding
+    QElapsedTimer _parametersReadyTimer;        ///< Time from start of parameter load to parametersReady
 
     typedef QPair<int /* FactMetaData::ValueType_t */, QVariant /* Fact::rawValue */> ParamTypeVal;
     typedef QMap<QString /* parameter name */, ParamTypeVal> CacheMapName2ParamTypeVal;
@@ -12,6 +12,9 @@
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "PX4ParameterMetaData.h"
+
+#include <QElapsedTimer>
 
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
@@ -138,3 +141,90 @@ void ParameterManagerTest::_requestListMissingParamFail(void)
     // User should have been notified
     checkExpectedMessageBox();
 }
+
+/// Meta data read back from the binary cache must match the meta data parsed from the xml file
+void ParameterManagerTest::_metaDataCache(void)
+{
+    const QString metaDataFile(":/FirmwarePlugin/PX4/PX4ParameterFactMetaData.xml");
+
+    // Force a cold parse
+    QDir cacheDir = ParameterManager::parameterCacheDir();
+    foreach (const QString& cacheFile, cacheDir.entryList(QStringList("PX4.*.metadata"), QDir::Files)) {
+        QVERIFY(cacheDir.remove(cacheFile));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    PX4ParameterMetaData coldMetaData;
+    coldMetaData.loadParameterFactMetaDataFile(metaDataFile);
+    qint64 coldMsecs = timer.restart();
+    PX4ParameterMetaData warmMetaData;
+    warmMetaData.loadParameterFactMetaDataFile(metaDataFile);
+    qint64 warmMsecs = timer.elapsed();
+    qDebug() << "Meta data load (msecs) xml:cache" << coldMsecs << warmMsecs;
+
+    QVERIFY(!coldMetaData.loadedFromCache());
+    QVERIFY(warmMetaData.loadedFromCache());
+
+    QStringList coldNames = coldMetaData.parameterNames();
+    QStringList warmNames = warmMetaData.parameterNames();
+    coldNames.sort();
+    warmNames.sort();
+    QVERIFY(coldNames.count() > 0);
+    QCOMPARE(warmNames, coldNames);
+
+    foreach (const QString& name, coldNames) {
+        FactMetaData* cold = coldMetaData.getMetaDataForFact(name, MAV_TYPE_QUADROTOR);
+        FactMetaData* warm = warmMetaData.getMetaDataForFact(name, MAV_TYPE_QUADROTOR);
+        QVERIFY(cold);
+        QVERIFY(warm);
+        QCOMPARE(warm->name(),                  cold->name());
+        QCOMPARE(warm->type(),                  cold->type());
+        QCOMPARE(warm->category(),              cold->category());
+        QCOMPARE(warm->group(),                 cold->group());
+        QCOMPARE(warm->shortDescription(),      cold->shortDescription());
+        QCOMPARE(warm->longDescription(),       cold->longDescription());
+        QCOMPARE(warm->rawUnits(),              cold->rawUnits());
+        QCOMPARE(warm->rawMin(),                cold->rawMin());
+        QCOMPARE(warm->rawMax(),                cold->rawMax());
+        QCOMPARE(warm->defaultValueAvailable(), cold->defaultValueAvailable());
+        if (cold->defaultValueAvailable()) {
+            QCOMPARE(warm->rawDefaultValue(),   cold->rawDefaultValue());
+        }
+        QCOMPARE(warm->decimalPlaces(),         cold->decimalPlaces());
+        QCOMPARE(QString::number(warm->rawIncrement()), QString::number(cold->rawIncrement()));
+        QCOMPARE(warm->enumStrings(),           cold->enumStrings());
+        QCOMPARE(warm->enumValues(),            cold->enumValues());
+        QCOMPARE(warm->bitmaskStrings(),        cold->bitmaskStrings());
+        QCOMPARE(warm->bitmaskValues(),         cold->bitmaskValues());
+        QCOMPARE(warm->rebootRequired(),        cold->rebootRequired());
+        QCOMPARE(warm->readOnly(),              cold->readOnly());
+        QCOMPARE(warm->volatileValue(),         cold->volatileValue());
+    }
+
+    // Meta data is created on first use only
+    QVERIFY(!warmMetaData.getMetaDataForFact(QStringLiteral("NOT_A_PARAM"), MAV_TYPE_QUADROTOR));
+}
+
+/// Time from MockLink connect to parametersReady, with meta data loaded from the xml file and from the cache
+void ParameterManagerTest::_timeToParametersReady(void)
+{
+    QDir cacheDir = ParameterManager::parameterCacheDir();
+    foreach (const QString& cacheFile, cacheDir.entryList(QStringList("PX4.*.metadata"), QDir::Files)) {
+        QVERIFY(cacheDir.remove(cacheFile));
+    }
+
+    for (int pass=0; pass<2; pass++) {
+        QElapsedTimer timer;
+        timer.start();
+        _connectMockLink(MAV_AUTOPILOT_PX4);
+        qint64 msecs = timer.elapsed();
+
+        Fact* fact = _vehicle->parameterManager()->getParameter(FactSystem::defaultComponentId, QStringLiteral("BAT_N_CELLS"));
+        QVERIFY(fact);
+        QVERIFY(!fact->shortDescription().isEmpty());
+
+        qDebug() << "Time to parametersReady (msecs)" << (pass == 0 ? "xml:" : "cache:") << msecs;
+        _disconnectMockLink();
+    }
+}
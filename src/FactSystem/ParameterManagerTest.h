@@ -25,6 +25,8 @@ private slots:
     void _requestListNoResponse(void);
     void _requestListMissingParamSuccess(void);
     void _requestListMissingParamFail(void);
+    void _metaDataCache(void);
+    void _timeToParametersReady(void);
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
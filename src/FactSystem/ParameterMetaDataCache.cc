@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterMetaDataCache.h"
+#include "ParameterManager.h"
+#include "QGCLoggingCategory.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QSaveFile>
+
+QGC_LOGGING_CATEGORY(ParameterMetaDataCacheLog, "ParameterMetaDataCacheLog")
+
+ParameterMetaDataCache::ParameterMetaDataCache(void)
+    : _data         (NULL)
+    , _size         (0)
+    , _recordsOffset(0)
+{
+
+}
+
+ParameterMetaDataCache::~ParameterMetaDataCache()
+{
+    _close();
+}
+
+QByteArray ParameterMetaDataCache::hashMetaData(const QByteArray& metaDataContents)
+{
+    return QCryptographicHash::hash(metaDataContents, QCryptographicHash::Sha1);
+}
+
+QString ParameterMetaDataCache::cacheFile(const QByteArray& hash, const QString& tag, quint32 formatVersion)
+{
+    return ParameterManager::parameterCacheDir().filePath(QString("%1.%2.v%3.metadata").arg(tag).arg(QString(hash.toHex())).arg(formatVersion));
+}
+
+void ParameterMetaDataCache::_close(void)
+{
+    if (_data) {
+        _file.unmap(_data);
+        _data = NULL;
+    }
+    _file.close();
+    _size = 0;
+    _recordsOffset = 0;
+    _index.clear();
+}
+
+bool ParameterMetaDataCache::open(const QByteArray& hash, const QString& tag, quint32 formatVersion)
+{
+    _close();
+
+    _file.setFileName(cacheFile(hash, tag, formatVersion));
+    if (!_file.exists()) {
+        qCDebug(ParameterMetaDataCacheLog) << "No cache file" << _file.fileName();
+        return false;
+    }
+    if (!_file.open(QIODevice::ReadOnly)) {
+        qCWarning(ParameterMetaDataCacheLog) << "Unable to open cache file" << _file.fileName() << _file.errorString();
+        return false;
+    }
+
+    _size = _file.size();
+    _data = _file.map(0, _size);
+    if (!_data) {
+        qCWarning(ParameterMetaDataCacheLog) << "Unable to map cache file" << _file.fileName() << _file.errorString();
+        _close();
+        return false;
+    }
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(_data), _size));
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32     magic, fileFormatVersion, count;
+    QByteArray  fileHash;
+    stream >> magic >> fileFormatVersion >> fileHash >> count;
+    if (stream.status() != QDataStream::Ok || magic != _magic || fileFormatVersion != formatVersion || fileHash != hash) {
+        qCWarning(ParameterMetaDataCacheLog) << "Cache file header mismatch" << _file.fileName();
+        _close();
+        return false;
+    }
+
+    // The count comes from the file, it has to fit in what is left of it before it sizes anything
+    if (count > (_size - stream.device()->pos()) / _minIndexEntrySize) {
+        qCWarning(ParameterMetaDataCacheLog) << "Cache file index count too large" << _file.fileName() << count;
+        _close();
+        return false;
+    }
+
+    _index.reserve(count);
+    for (quint32 i=0; i<count; i++) {
+        QString key;
+        Record  record;
+        stream >> key >> record.offset >> record.length;
+        _index[key] = record;
+    }
+    _recordsOffset = stream.device()->pos();
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(ParameterMetaDataCacheLog) << "Cache file index truncated" << _file.fileName();
+        _close();
+        return false;
+    }
+    foreach (const Record& record, _index) {
+        if (_recordsOffset + record.offset + record.length > _size) {
+            qCWarning(ParameterMetaDataCacheLog) << "Cache file records truncated" << _file.fileName();
+            _close();
+            return false;
+        }
+    }
+
+    qCDebug(ParameterMetaDataCacheLog) << "Opened cache file" << _file.fileName() << "records:" << count;
+    return true;
+}
+
+QByteArray ParameterMetaDataCache::record(const QString& key) const
+{
+    QHash<QString, Record>::const_iterator iter = _index.constFind(key);
+    if (!_data || iter == _index.constEnd()) {
+        return QByteArray();
+    }
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(_data + _recordsOffset + iter->offset), iter->length);
+}
+
+bool ParameterMetaDataCache::write(const QByteArray& hash, const QString& tag, quint32 formatVersion, const QMap<QString, QByteArray>& records)
+{
+    QDir().mkpath(ParameterManager::parameterCacheDir().absolutePath());
+
+    QSaveFile file(cacheFile(hash, tag, formatVersion));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(ParameterMetaDataCacheLog) << "Unable to create cache file" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << _magic << formatVersion << hash << static_cast<quint32>(records.count());
+
+    quint32 offset = 0;
+    for (QMap<QString, QByteArray>::const_iterator iter = records.constBegin(); iter != records.constEnd(); ++iter) {
+        stream << iter.key() << offset << static_cast<quint32>(iter.value().size());
+        offset += iter.value().size();
+    }
+    for (QMap<QString, QByteArray>::const_iterator iter = records.constBegin(); iter != records.constEnd(); ++iter) {
+        stream.writeRawData(iter.value().constData(), iter.value().size());
+    }
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qCWarning(ParameterMetaDataCacheLog) << "Unable to write cache file" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    qCDebug(ParameterMetaDataCacheLog) << "Wrote cache file" << file.fileName() << "records:" << records.count();
+    return true;
+}
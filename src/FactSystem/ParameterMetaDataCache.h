@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QByteArray>
+#include <QStringList>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterMetaDataCacheLog)
+
+/// Binary cache of parsed parameter meta data.
+///
+/// There is one cache file per meta data file contents, named by the SHA-1 of those contents, so a changed meta
+/// data file never picks up a stale cache. The file holds an index of record keys followed by the records. It is
+/// memory mapped on open and a record is only handed out (as a view into the mapping) when asked for, so the
+/// caller can decode just the records it actually needs.
+///
+/// The record format belongs to the caller, the formatVersion it passes in must be bumped whenever that changes.
+class ParameterMetaDataCache
+{
+public:
+    ParameterMetaDataCache(void);
+    ~ParameterMetaDataCache();
+
+    /// @return SHA-1 of the meta data file contents, used as the cache key
+    static QByteArray hashMetaData(const QByteArray& metaDataContents);
+
+    /// Maps the cache file for the specified meta data
+    ///     @param hash Value returned by hashMetaData
+    ///     @param tag Identifies the meta data kind, for example "PX4"
+    ///     @param formatVersion Record format version
+    /// @return false: no usable cache, caller must parse the meta data and call write
+    bool open(const QByteArray& hash, const QString& tag, quint32 formatVersion);
+
+    bool        isOpen  (void) const { return _data != NULL; }
+    bool        contains(const QString& key) const { return _index.contains(key); }
+    QStringList keys    (void) const { return _index.keys(); }
+
+    /// @return Record for key, empty if not found. The returned array does not own its data and is only valid
+    ///         while the cache is open.
+    QByteArray record(const QString& key) const;
+
+    /// Writes a new cache file, replacing any existing one atomically
+    /// @return false: write failed, the meta data is still usable from the caller's parse
+    static bool write(const QByteArray& hash, const QString& tag, quint32 formatVersion, const QMap<QString, QByteArray>& records);
+
+    /// @return Full path to the cache file for the specified meta data
+    static QString cacheFile(const QByteArray& hash, const QString& tag, quint32 formatVersion);
+
+private:
+    void _close(void);
+
+    struct Record {
+        quint32 offset;
+        quint32 length;
+    };
+
+    QFile                   _file;
+    uchar*                  _data;      ///< Start of mapping, NULL if not open
+    qint64                  _size;
+    qint64                  _recordsOffset;
+    QHash<QString, Record>  _index;
+
+    static const quint32 _magic =               0x51504d43; ///< "QPMC"
+    static const qint64  _minIndexEntrySize =   12;         ///< Index entry with an empty key: key length, offset, length
+};
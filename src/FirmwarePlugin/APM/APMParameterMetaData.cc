@@ -17,9 +17,12 @@
 #include <QDir>
 #include <QDebug>
 #include <QStack>
+#include <QDataStream>
 
 static const char* kInvalidConverstion = "Internal Error: No support for string parameters";
 
+const char* APMParameterMetaData::_cacheTag = "APM";
+
 QGC_LOGGING_CATEGORY(APMParameterMetaDataLog,           "APMParameterMetaDataLog")
 QGC_LOGGING_CATEGORY(APMParameterMetaDataVerboseLog,    "APMParameterMetaDataVerboseLog")
 
@@ -128,6 +131,22 @@ QString APMParameterMetaData::mavTypeToString(MAV_TYPE vehicleTypeEnum)
     return vehicleName;
 }
 
+static QDataStream& operator<<(QDataStream& stream, const APMFactMetaDataRaw& rawMetaData)
+{
+    return stream << rawMetaData.name << rawMetaData.category << rawMetaData.group
+                  << rawMetaData.shortDescription << rawMetaData.longDescription
+                  << rawMetaData.min << rawMetaData.max << rawMetaData.incrementSize << rawMetaData.units
+                  << rawMetaData.rebootRequired << rawMetaData.values << rawMetaData.bitmask;
+}
+
+static QDataStream& operator>>(QDataStream& stream, APMFactMetaDataRaw& rawMetaData)
+{
+    return stream >> rawMetaData.name >> rawMetaData.category >> rawMetaData.group
+                  >> rawMetaData.shortDescription >> rawMetaData.longDescription
+                  >> rawMetaData.min >> rawMetaData.max >> rawMetaData.incrementSize >> rawMetaData.units
+                  >> rawMetaData.rebootRequired >> rawMetaData.values >> rawMetaData.bitmask;
+}
+
 void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaDataFile)
 {
     if (_parameterMetaDataLoaded) {
@@ -135,9 +154,6 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     _parameterMetaDataLoaded = true;
 
-    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
-    QString currentCategory;
-
     qCDebug(APMParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
     QFile xmlFile(metaDataFile);
@@ -147,15 +163,46 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     Q_UNUSED(success);
     Q_ASSERT(success);
 
-    QXmlStreamReader xml(xmlFile.readAll());
+    QByteArray contents = xmlFile.readAll();
     xmlFile.close();
+
+    QByteArray hash = ParameterMetaDataCache::hashMetaData(contents);
+    if (_cache.open(hash, _cacheTag, _cacheFormatVersion)) {
+        qCDebug(APMParameterMetaDataLog) << "Parameter meta data loaded from cache" << metaDataFile;
+        return;
+    }
+
+    if (_parseMetaData(contents)) {
+        QMap<QString, QByteArray> records;
+        foreach (const QString& vehicleType, _vehicleTypeToParametersMap.keys()) {
+            const ParameterNametoFactMetaDataMap& parameterMap = _vehicleTypeToParametersMap[vehicleType];
+            for (ParameterNametoFactMetaDataMap::const_iterator iter = parameterMap.constBegin(); iter != parameterMap.constEnd(); ++iter) {
+                QByteArray  record;
+                QDataStream stream(&record, QIODevice::WriteOnly);
+                stream.setVersion(QDataStream::Qt_5_0);
+                stream << *iter.value();
+                records[vehicleType + QLatin1Char('/') + iter.key()] = record;
+            }
+        }
+        ParameterMetaDataCache::write(hash, _cacheTag, _cacheFormatVersion, records);
+    }
+}
+
+/// Parses the meta data file into _vehicleTypeToParametersMap
+/// @return true: entire file parsed successfully, false: parsing stopped early
+bool APMParameterMetaData::_parseMetaData(const QByteArray& contents)
+{
+    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
+    QString currentCategory;
+
+    QXmlStreamReader xml(contents);
     if (xml.hasError()) {
         qCWarning(APMParameterMetaDataLog) << "Badly formed XML, reading failed: " << xml.errorString();
-        return;
+        return false;
     }
 
     QString             errorString;
-    bool                badMetaData = true;
+    bool                badMetaData = false;
     QStack<int>         xmlState;
     APMFactMetaDataRaw* rawMetaData = NULL;
 
@@ -178,13 +225,13 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             } else if (elementName == "vehicles") {
                 if (xmlState.top() != XmlstateParamFileFound) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, vehicles matched";
-                    return;
+                    return false;
                 }
                 xmlState.push(XmlStateFoundVehicles);
             } else if (elementName == "libraries") {
                 if (xmlState.top() != XmlstateParamFileFound) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, libraries matched";
-                    return;
+                    return false;
                 }
                 currentCategory = "libraries";
                 xmlState.push(XmlStateFoundLibraries);
@@ -192,7 +239,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 if (xmlState.top() != XmlStateFoundVehicles && xmlState.top() != XmlStateFoundLibraries) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, parameters matched"
                                                        << "but we don't have proper vehicle or libraries yet";
-                    return;
+                    return false;
                 }
 
                 if (xml.attributes().hasAttribute("name")) {
@@ -209,7 +256,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                         qCDebug(APMParameterMetaDataVerboseLog) << "not interested in this block of parameters, skipping:" << nameValue;
                         if (skipXMLBlock(xml, "parameters")) {
                             qCWarning(APMParameterMetaDataLog) << "something wrong with the xml, skip of the xml failed";
-                            return;
+                            return false;
                         }
                         xml.readNext();
                         continue;
@@ -219,13 +266,13 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 if (xmlState.top() != XmlStateFoundParameters) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, element param matched"
                                                        << "while we are not yet in parameters";
-                    return;
+                    return false;
                 }
                 xmlState.push(XmlStateFoundParameter);
 
                 if (!xml.attributes().hasAttribute("name")) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, parameter attribute name missing";
-                    return;
+                    return false;
                 }
 
                 QString name = xml.attributes().value("name").toString();
@@ -268,12 +315,12 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 // We should be getting meta data now
                 if (xmlState.top() != XmlStateFoundParameter) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, while reading parameter fields wrong state";
-                    return;
+                    return false;
                 }
                 if (!badMetaData) {
                     if (!parseParameterAttributes(xml, rawMetaData)) {
                         qCDebug(APMParameterMetaDataLog) << "Badly formed XML, failed to read parameter attributes";
-                        return;
+                        return false;
                     }
                     continue;
                 }
@@ -300,6 +347,13 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         }
         xml.readNext();
     }
+
+    if (xml.hasError()) {
+        qCWarning(APMParameterMetaDataLog) << "Badly formed XML, reading failed: " << xml.errorString();
+        return false;
+    }
+
+    return true;
 }
 
 void APMParameterMetaData::correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap,
@@ -419,16 +473,40 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
     return true;
 }
 
+bool APMParameterMetaData::_rawMetaData(const QString& vehicleType, const QString& name, APMFactMetaDataRaw& rawMetaData) const
+{
+    if (_cache.isOpen()) {
+        QByteArray record = _cache.record(vehicleType + QLatin1Char('/') + name);
+        if (record.isEmpty()) {
+            return false;
+        }
+        QDataStream stream(record);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream >> rawMetaData;
+        if (stream.status() != QDataStream::Ok) {
+            qCWarning(APMParameterMetaDataLog) << "Corrupt parameter meta data cache record" << vehicleType << name;
+            return false;
+        }
+        return true;
+    }
+
+    const ParameterNametoFactMetaDataMap parameterMap = _vehicleTypeToParametersMap.value(vehicleType);
+    if (!parameterMap.contains(name)) {
+        return false;
+    }
+    rawMetaData = *parameterMap[name];
+    return true;
+}
+
 void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
 {
     const QString mavTypeString = mavTypeToString(vehicleType);
+    APMFactMetaDataRaw  foundMetaData;
     APMFactMetaDataRaw* rawMetaData = NULL;
 
     // check if we have metadata for fact, use generic otherwise
-    if (_vehicleTypeToParametersMap[mavTypeString].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap[mavTypeString][fact->name()];
-    } else if (_vehicleTypeToParametersMap["libraries"].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap["libraries"][fact->name()];
+    if (_rawMetaData(mavTypeString, fact->name(), foundMetaData) || _rawMetaData(QStringLiteral("libraries"), fact->name(), foundMetaData)) {
+        rawMetaData = &foundMetaData;
     }
 
     FactMetaData *metaData = new FactMetaData(fact->type(), fact);
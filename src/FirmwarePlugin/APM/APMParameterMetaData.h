@@ -20,6 +20,7 @@
 #include "FactSystem.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
+#include "ParameterMetaDataCache.h"
 
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataLog)
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataVerboseLog)
@@ -80,9 +81,15 @@ private:
     bool parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw *rawMetaData);
     void correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap, QMap<QString,QStringList>& groupMembers);
     QString mavTypeToString(MAV_TYPE vehicleTypeEnum);
+    bool _parseMetaData(const QByteArray& contents);
+    bool _rawMetaData(const QString& vehicleType, const QString& name, APMFactMetaDataRaw& rawMetaData) const;
 
     bool _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
-    QMap<QString, ParameterNametoFactMetaDataMap> _vehicleTypeToParametersMap; ///< Maps from a vehicle type to paramametertoFactMeta map>
+    ParameterMetaDataCache _cache;   ///< Open if meta data came from the binary cache, keys are "<vehicle type>/<param name>"
+    QMap<QString, ParameterNametoFactMetaDataMap> _vehicleTypeToParametersMap; ///< Maps from a vehicle type to paramametertoFactMeta map>, empty if loaded from cache
+
+    static const char*      _cacheTag;
+    static const quint32    _cacheFormatVersion = 1;   ///< Bump on any change to the APMFactMetaDataRaw stream format
 };
 
 #endif
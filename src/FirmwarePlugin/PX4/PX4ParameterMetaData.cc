@@ -19,9 +19,12 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QDataStream>
 
 static const char* kInvalidConverstion = "Internal Error: No support for string parameters";
 
+const char* PX4ParameterMetaData::_cacheTag = "PX4";
+
 QGC_LOGGING_CATEGORY(PX4ParameterMetaDataLog, "PX4ParameterMetaDataLog")
 
 PX4ParameterMetaData::PX4ParameterMetaData(void)
@@ -79,6 +82,42 @@ QVariant PX4ParameterMetaData::_stringToTypedVariant(const QString& string, Fact
     return var;
 }
 
+static QDataStream& operator<<(QDataStream& stream, const PX4FactMetaDataRaw& rawMetaData)
+{
+    quint8 flags = (rawMetaData.duplicate       ? 0x01 : 0) |
+                   (rawMetaData.hasDefault      ? 0x02 : 0) |
+                   (rawMetaData.readOnly        ? 0x04 : 0) |
+                   (rawMetaData.volatileValue   ? 0x08 : 0) |
+                   (rawMetaData.rebootRequired  ? 0x10 : 0) |
+                   (rawMetaData.boolean         ? 0x20 : 0);
+
+    return stream << rawMetaData.name << rawMetaData.category << rawMetaData.group << static_cast<qint32>(rawMetaData.type) << flags
+                  << rawMetaData.defaultValue << rawMetaData.shortDescription << rawMetaData.longDescription
+                  << rawMetaData.min << rawMetaData.max << rawMetaData.units << rawMetaData.decimalPlaces << rawMetaData.increment
+                  << rawMetaData.values << rawMetaData.bitmask;
+}
+
+static QDataStream& operator>>(QDataStream& stream, PX4FactMetaDataRaw& rawMetaData)
+{
+    qint32  type;
+    quint8  flags;
+
+    stream >> rawMetaData.name >> rawMetaData.category >> rawMetaData.group >> type >> flags
+           >> rawMetaData.defaultValue >> rawMetaData.shortDescription >> rawMetaData.longDescription
+           >> rawMetaData.min >> rawMetaData.max >> rawMetaData.units >> rawMetaData.decimalPlaces >> rawMetaData.increment
+           >> rawMetaData.values >> rawMetaData.bitmask;
+
+    rawMetaData.type            = static_cast<FactMetaData::ValueType_t>(type);
+    rawMetaData.duplicate       = flags & 0x01;
+    rawMetaData.hasDefault      = flags & 0x02;
+    rawMetaData.readOnly        = flags & 0x04;
+    rawMetaData.volatileValue   = flags & 0x08;
+    rawMetaData.rebootRequired  = flags & 0x10;
+    rawMetaData.boolean         = flags & 0x20;
+
+    return stream;
+}
+
 void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaDataFile)
 {
     qCDebug(ParameterManagerLog) << "PX4ParameterMetaData::loadParameterFactMetaDataFile" << metaDataFile;
@@ -102,19 +141,43 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         qWarning() << "Internal error: Unable to open parameter file:" << metaDataFile << xmlFile.errorString();
         return;
     }
-    
-    QXmlStreamReader xml(xmlFile.readAll());
+
+    QByteArray contents = xmlFile.readAll();
     xmlFile.close();
+
+    QByteArray hash = ParameterMetaDataCache::hashMetaData(contents);
+    if (_cache.open(hash, _cacheTag, _cacheFormatVersion)) {
+        qCDebug(PX4ParameterMetaDataLog) << "Parameter meta data loaded from cache" << metaDataFile;
+        return;
+    }
+
+    if (_parseMetaData(contents, metaDataFile)) {
+        QMap<QString, QByteArray> records;
+        for (QHash<QString, PX4FactMetaDataRaw>::const_iterator iter = _mapParameterName2RawMetaData.constBegin(); iter != _mapParameterName2RawMetaData.constEnd(); ++iter) {
+            QByteArray  record;
+            QDataStream stream(&record, QIODevice::WriteOnly);
+            stream.setVersion(QDataStream::Qt_5_0);
+            stream << iter.value();
+            records[iter.key()] = record;
+        }
+        ParameterMetaDataCache::write(hash, _cacheTag, _cacheFormatVersion, records);
+    }
+}
+
+/// Parses the meta data file into _mapParameterName2RawMetaData
+/// @return true: entire file parsed successfully, false: parsing stopped early
+bool PX4ParameterMetaData::_parseMetaData(const QByteArray& contents, const QString& metaDataFile)
+{
+    QXmlStreamReader xml(contents);
     if (xml.hasError()) {
         qWarning() << "Badly formed XML" << xml.errorString();
-        return;
+        return false;
     }
     
-    QString         factGroup;
-    QString         errorString;
-    FactMetaData*   metaData = NULL;
-    int             xmlState = XmlStateNone;
-    bool            badMetaData = true;
+    QString             factGroup;
+    PX4FactMetaDataRaw* rawMetaData = NULL;
+    int                 xmlState = XmlStateNone;
+    bool                badMetaData = false;
     
     while (!xml.atEnd()) {
         if (xml.isStartElement()) {
@@ -123,14 +186,14 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             if (elementName == "parameters") {
                 if (xmlState != XmlStateNone) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundParameters;
                 
             } else if (elementName == "version") {
                 if (xmlState != XmlStateFoundParameters) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundVersion;
                 
@@ -139,12 +202,12 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 int intVersion = strVersion.toInt(&convertOk);
                 if (!convertOk) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 if (intVersion <= 2) {
                     // We can't read these old files
                     qDebug() << "Parameter version stamp too old, skipping load. Found:" << intVersion << "Want: 3 File:" << metaDataFile;
-                    return;
+                    return false;
                 }
                 
             } else if (elementName == "parameter_version_major") {
@@ -156,13 +219,13 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 if (xmlState != XmlStateFoundVersion) {
                     // We didn't get a version stamp, assume older version we can't read
                     qDebug() << "Parameter version stamp not found, skipping load" << metaDataFile;
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundGroup;
                 
                 if (!xml.attributes().hasAttribute("name")) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 factGroup = xml.attributes().value("name").toString();
                 qCDebug(PX4ParameterMetaDataLog) << "Found group: " << factGroup;
@@ -170,13 +233,13 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             } else if (elementName == "parameter") {
                 if (xmlState != XmlStateFoundGroup) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundParameter;
                 
                 if (!xml.attributes().hasAttribute("name") || !xml.attributes().hasAttribute("type")) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 
                 QString name = xml.attributes().value("name").toString();
@@ -209,103 +272,73 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 FactMetaData::ValueType_t foundType = FactMetaData::stringToType(type, unknownType);
                 if (unknownType) {
                     qWarning() << "Parameter meta data with bad type:" << type << " name:" << name;
-                    return;
+                    return false;
                 }
                 
-                // Now that we know type we can create meta data object and add it to the system
-                
-                metaData = new FactMetaData(foundType);
-                Q_CHECK_PTR(metaData);
-                if (_mapParameterName2FactMetaData.contains(name)) {
+                // Now that we know type we can create the raw meta data and add it to the system
+
+                bool duplicate = _mapParameterName2RawMetaData.contains(name);
+                rawMetaData = &_mapParameterName2RawMetaData[name];
+                *rawMetaData = PX4FactMetaDataRaw();
+                rawMetaData->type = foundType;
+                if (duplicate) {
                     // We can't trust the meta data since we have dups
                     qCWarning(PX4ParameterMetaDataLog) << "Duplicate parameter found:" << name;
                     badMetaData = true;
                     // Reset to default meta data
-                    _mapParameterName2FactMetaData[name] = metaData;
+                    rawMetaData->duplicate = true;
                 } else {
-                    _mapParameterName2FactMetaData[name] = metaData;
-                    metaData->setName(name);
-                    metaData->setCategory(category);
-                    metaData->setGroup(factGroup);
-                    metaData->setReadOnly(readOnly);
-                    metaData->setVolatileValue(volatileValue);
-                    
-                    if (xml.attributes().hasAttribute("default") && !strDefault.isEmpty()) {
-                        QVariant varDefault;
-                        
-                        if (metaData->convertAndValidateRaw(strDefault, false, varDefault, errorString)) {
-                            metaData->setRawDefaultValue(varDefault);
-                        } else {
-                            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << name << " type:" << type << " default:" << strDefault << " error:" << errorString;
-                        }
-                    }
+                    rawMetaData->name = name;
+                    rawMetaData->category = category;
+                    rawMetaData->group = factGroup;
+                    rawMetaData->readOnly = readOnly;
+                    rawMetaData->volatileValue = volatileValue;
+                    rawMetaData->hasDefault = xml.attributes().hasAttribute("default") && !strDefault.isEmpty();
+                    rawMetaData->defaultValue = strDefault;
                 }
                 
             } else {
                 // We should be getting meta data now
                 if (xmlState != XmlStateFoundParameter) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
 
                 if (!badMetaData) {
-                    if (metaData) {
+                    if (rawMetaData) {
                         if (elementName == "short_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Short description:" << text;
-                            metaData->setShortDescription(text);
+                            rawMetaData->shortDescription = text;
 
                         } else if (elementName == "long_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Long description:" << text;
-                            metaData->setLongDescription(text);
+                            rawMetaData->longDescription = text;
 
                         } else if (elementName == "min") {
-                            QString text = xml.readElementText();
-                            qCDebug(PX4ParameterMetaDataLog) << "Min:" << text;
-
-                            QVariant varMin;
-                            if (metaData->convertAndValidateRaw(text, false /* convertOnly */, varMin, errorString)) {
-                                metaData->setRawMin(varMin);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << text << " error:" << errorString;
-                            }
+                            rawMetaData->min = xml.readElementText();
+                            qCDebug(PX4ParameterMetaDataLog) << "Min:" << rawMetaData->min;
 
                         } else if (elementName == "max") {
-                            QString text = xml.readElementText();
-                            qCDebug(PX4ParameterMetaDataLog) << "Max:" << text;
-
-                            QVariant varMax;
-                            if (metaData->convertAndValidateRaw(text, false /* convertOnly */, varMax, errorString)) {
-                                metaData->setRawMax(varMax);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << text << " error:" << errorString;
-                            }
+                            rawMetaData->max = xml.readElementText();
+                            qCDebug(PX4ParameterMetaDataLog) << "Max:" << rawMetaData->max;
 
                         } else if (elementName == "unit") {
-                            QString text = xml.readElementText();
-                            qCDebug(PX4ParameterMetaDataLog) << "Unit:" << text;
-                            metaData->setRawUnits(text);
+                            rawMetaData->units = xml.readElementText();
+                            qCDebug(PX4ParameterMetaDataLog) << "Unit:" << rawMetaData->units;
 
                         } else if (elementName == "decimal") {
-                            QString text = xml.readElementText();
-                            qCDebug(PX4ParameterMetaDataLog) << "Decimal:" << text;
-
-                            bool convertOk;
-                            QVariant varDecimals = QVariant(text).toUInt(&convertOk);
-                            if (convertOk) {
-                                metaData->setDecimalPlaces(varDecimals.toInt());
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << text << " error: invalid number";
-                            }
+                            rawMetaData->decimalPlaces = xml.readElementText();
+                            qCDebug(PX4ParameterMetaDataLog) << "Decimal:" << rawMetaData->decimalPlaces;
 
                         } else if (elementName == "reboot_required") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "RebootRequired:" << text;
                             if (text.compare("true", Qt::CaseInsensitive) == 0) {
-                                metaData->setRebootRequired(true);
+                                rawMetaData->rebootRequired = true;
                             }
 
                         } else if (elementName == "values") {
@@ -316,59 +349,26 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             QString enumString = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
                                                              << "value desc:" << enumString << "code:" << enumValueStr;
+                            rawMetaData->values << QPair<QString, QString>(enumValueStr, enumString);
 
-                            QVariant    enumValue;
-                            QString     errorString;
-                            if (metaData->convertAndValidateRaw(enumValueStr, false /* validate */, enumValue, errorString)) {
-                                metaData->addEnumInfo(enumString, enumValue);
-                            } else {
-                                qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
-                                                                 << " type:" << metaData->type() << " value:" << enumValueStr
-                                                                 << " error:" << errorString;
-                            }
                         } else if (elementName == "increment") {
-                            double  increment;
-                            bool    ok;
-                            QString text = xml.readElementText();
-                            increment = text.toDouble(&ok);
-                            if (ok) {
-                                metaData->setRawIncrement(increment);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << text;
-                            }
+                            rawMetaData->increment = xml.readElementText();
 
                         } else if (elementName == "boolean") {
-                            QVariant    enumValue;
-                            metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Enabled"), enumValue);
-                            metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Disabled"), enumValue);
+                            rawMetaData->boolean = true;
 
                         } else if (elementName == "bitmask") {
                             // doing nothing individual bits will follow anyway. May be used for sanity checking.
 
                         } else if (elementName == "bit") {
+                            QString bitIndex = xml.attributes().value("index").toString();
                             bool ok = false;
-                            unsigned char bit = xml.attributes().value("index").toString().toUInt(&ok);
+                            bitIndex.toUInt(&ok);
                             if (ok) {
                                 QString bitDescription = xml.readElementText();
                                 qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
-                                                                 << "index:" << bit << "description:" << bitDescription;
-
-                                if (bit < 31) {
-                                    QVariant bitmaskRawValue = 1 << bit;
-                                    QVariant bitmaskValue;
-                                    QString errorString;
-                                    if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
-                                        metaData->addBitmaskInfo(bitDescription, bitmaskValue);
-                                    } else {
-                                        qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
-                                                                         << " type:" << metaData->type() << " value:" << bitmaskValue
-                                                                         << " error:" << errorString;
-                                    }
-                                } else {
-                                    qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
-                                }
+                                                                 << "index:" << bitIndex << "description:" << bitDescription;
+                                rawMetaData->bitmask << QPair<QString, QString>(bitIndex, bitDescription);
                             }
                         } else {
                             qCDebug(PX4ParameterMetaDataLog) << "Unknown element in XML: " << elementName;
@@ -382,17 +382,8 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             QString elementName = xml.name().toString();
 
             if (elementName == "parameter") {
-                // Done loading this parameter, validate default value
-                if (metaData->defaultValueAvailable()) {
-                    QVariant var;
-
-                    if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
-                        qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
-                    }
-                }
-
                 // Reset for next parameter
-                metaData = NULL;
+                rawMetaData = NULL;
                 badMetaData = false;
                 xmlState = XmlStateFoundGroup;
             } else if (elementName == "group") {
@@ -403,28 +394,200 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         }
         xml.readNext();
     }
+
+    if (xml.hasError()) {
+        qWarning() << "Badly formed XML" << xml.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool PX4ParameterMetaData::_rawMetaData(const QString& name, PX4FactMetaDataRaw& rawMetaData) const
+{
+    if (_cache.isOpen()) {
+        QByteArray record = _cache.record(name);
+        if (record.isEmpty()) {
+            return false;
+        }
+        QDataStream stream(record);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream >> rawMetaData;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "Internal error: corrupt parameter meta data cache record" << name;
+            return false;
+        }
+        return true;
+    }
+
+    QHash<QString, PX4FactMetaDataRaw>::const_iterator iter = _mapParameterName2RawMetaData.constFind(name);
+    if (iter == _mapParameterName2RawMetaData.constEnd()) {
+        return false;
+    }
+    rawMetaData = iter.value();
+    return true;
+}
+
+/// Creates the FactMetaData for a parameter, validating the raw values from the meta data file against the type
+FactMetaData* PX4ParameterMetaData::_createMetaData(const PX4FactMetaDataRaw& rawMetaData)
+{
+    QString         errorString;
+    FactMetaData*   metaData = new FactMetaData(rawMetaData.type);
+    Q_CHECK_PTR(metaData);
+
+    if (rawMetaData.duplicate) {
+        return metaData;
+    }
+
+    metaData->setName(rawMetaData.name);
+    metaData->setCategory(rawMetaData.category);
+    metaData->setGroup(rawMetaData.group);
+    metaData->setReadOnly(rawMetaData.readOnly);
+    metaData->setVolatileValue(rawMetaData.volatileValue);
+
+    if (rawMetaData.hasDefault) {
+        QVariant varDefault;
+
+        if (metaData->convertAndValidateRaw(rawMetaData.defaultValue, false, varDefault, errorString)) {
+            metaData->setRawDefaultValue(varDefault);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << rawMetaData.name << " type:" << rawMetaData.type << " default:" << rawMetaData.defaultValue << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.shortDescription.isEmpty()) {
+        metaData->setShortDescription(rawMetaData.shortDescription);
+    }
+    if (!rawMetaData.longDescription.isEmpty()) {
+        metaData->setLongDescription(rawMetaData.longDescription);
+    }
+
+    if (!rawMetaData.min.isEmpty()) {
+        QVariant varMin;
+        if (metaData->convertAndValidateRaw(rawMetaData.min, false /* convertOnly */, varMin, errorString)) {
+            metaData->setRawMin(varMin);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << rawMetaData.min << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.max.isEmpty()) {
+        QVariant varMax;
+        if (metaData->convertAndValidateRaw(rawMetaData.max, false /* convertOnly */, varMax, errorString)) {
+            metaData->setRawMax(varMax);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << rawMetaData.max << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.units.isEmpty()) {
+        metaData->setRawUnits(rawMetaData.units);
+    }
+
+    if (!rawMetaData.decimalPlaces.isEmpty()) {
+        bool convertOk;
+        QVariant varDecimals = QVariant(rawMetaData.decimalPlaces).toUInt(&convertOk);
+        if (convertOk) {
+            metaData->setDecimalPlaces(varDecimals.toInt());
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << rawMetaData.decimalPlaces << " error: invalid number";
+        }
+    }
+
+    if (rawMetaData.rebootRequired) {
+        metaData->setRebootRequired(true);
+    }
+
+    for (int i=0; i<rawMetaData.values.count(); i++) {
+        const QPair<QString, QString>& enumPair = rawMetaData.values[i];
+
+        QVariant enumValue;
+        if (metaData->convertAndValidateRaw(enumPair.first, false /* validate */, enumValue, errorString)) {
+            metaData->addEnumInfo(enumPair.second, enumValue);
+        } else {
+            qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
+                                             << " type:" << metaData->type() << " value:" << enumPair.first
+                                             << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.increment.isEmpty()) {
+        bool    ok;
+        double  increment = rawMetaData.increment.toDouble(&ok);
+        if (ok) {
+            metaData->setRawIncrement(increment);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << rawMetaData.increment;
+        }
+    }
+
+    if (rawMetaData.boolean) {
+        QVariant    enumValue;
+        metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Enabled"), enumValue);
+        metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Disabled"), enumValue);
+    }
+
+    for (int i=0; i<rawMetaData.bitmask.count(); i++) {
+        const QPair<QString, QString>& bitmaskPair = rawMetaData.bitmask[i];
+
+        unsigned char bit = bitmaskPair.first.toUInt();
+        if (bit < 31) {
+            QVariant bitmaskRawValue = 1 << bit;
+            QVariant bitmaskValue;
+            if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
+                metaData->addBitmaskInfo(bitmaskPair.second, bitmaskValue);
+            } else {
+                qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
+                                                 << " type:" << metaData->type() << " value:" << bitmaskValue
+                                                 << " error:" << errorString;
+            }
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
+        }
+    }
+
+    // Validate default value against the final min/max
+    if (metaData->defaultValueAvailable()) {
+        QVariant var;
+
+        if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
+        }
+    }
+
+    return metaData;
 }
 
 FactMetaData* PX4ParameterMetaData::getMetaDataForFact(const QString& name, MAV_TYPE vehicleType)
 {
     Q_UNUSED(vehicleType)
 
-    if (_mapParameterName2FactMetaData.contains(name)) {
-        return _mapParameterName2FactMetaData[name];
-    } else {
-        return NULL;
+    FactMetaData* metaData = _mapParameterName2FactMetaData.value(name, NULL);
+    if (!metaData) {
+        PX4FactMetaDataRaw rawMetaData;
+        if (_rawMetaData(name, rawMetaData)) {
+            metaData = _createMetaData(rawMetaData);
+            _mapParameterName2FactMetaData[name] = metaData;
+        }
     }
+    return metaData;
 }
 
 void PX4ParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
 {
-    Q_UNUSED(vehicleType)
-
-    if (_mapParameterName2FactMetaData.contains(fact->name())) {
-        fact->setMetaData(_mapParameterName2FactMetaData[fact->name()]);
+    FactMetaData* metaData = getMetaDataForFact(fact->name(), vehicleType);
+    if (metaData) {
+        fact->setMetaData(metaData);
     }
 }
 
+QStringList PX4ParameterMetaData::parameterNames(void) const
+{
+    return _cache.isOpen() ? _cache.keys() : _mapParameterName2RawMetaData.keys();
+}
+
 void PX4ParameterMetaData::getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion)
 {
     QFile xmlFile(metaDataFile);
@@ -19,12 +19,50 @@
 #include "FactSystem.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
+#include "ParameterMetaDataCache.h"
 
 /// @file
 ///     @author Don Gagne <don@thegagnes.com>
 
 Q_DECLARE_LOGGING_CATEGORY(PX4ParameterMetaDataLog)
 
+/// Parameter meta data as read from the meta data file. FactMetaData is only created from this when a Fact
+/// actually asks for it.
+class PX4FactMetaDataRaw
+{
+public:
+    PX4FactMetaDataRaw(void)
+        : type          (FactMetaData::valueTypeInt32)
+        , duplicate     (false)
+        , hasDefault    (false)
+        , readOnly      (false)
+        , volatileValue (false)
+        , rebootRequired(false)
+        , boolean       (false)
+    { }
+
+    QString                     name;
+    QString                     category;
+    QString                     group;
+    FactMetaData::ValueType_t   type;
+    bool                        duplicate;      ///< true: parameter found more than once, meta data can't be trusted
+    bool                        hasDefault;
+    QString                     defaultValue;
+    bool                        readOnly;
+    bool                        volatileValue;
+    bool                        rebootRequired;
+    bool                        boolean;
+    QString                     shortDescription;
+    QString                     longDescription;
+    QString                     min;
+    QString                     max;
+    QString                     units;
+    QString                     decimalPlaces;
+    QString                     increment;
+    QList<QPair<QString, QString> > values;     ///< code, description
+    QList<QPair<QString, QString> > bitmask;    ///< bit index, description
+};
+
 /// Loads and holds parameter fact meta data for PX4 stack
 class PX4ParameterMetaData : public QObject
 {
@@ -37,6 +75,12 @@ public:
     FactMetaData*   getMetaDataForFact              (const QString& name, MAV_TYPE vehicleType);
     void            addMetaDataToFact               (Fact* fact, MAV_TYPE vehicleType);
 
+    /// @return Names of all parameters which have meta data
+    QStringList     parameterNames                  (void) const;
+
+    /// @return true: meta data was loaded from the binary cache instead of parsing the meta data file
+    bool            loadedFromCache                 (void) const { return _cache.isOpen(); }
+
     static void getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion);
 
 private:
@@ -49,10 +93,18 @@ private:
         XmlStateDone
     };    
 
-    QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    QVariant        _stringToTypedVariant   (const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    bool            _parseMetaData          (const QByteArray& contents, const QString& metaDataFile);
+    bool            _rawMetaData            (const QString& name, PX4FactMetaDataRaw& rawMetaData) const;
+    FactMetaData*   _createMetaData         (const PX4FactMetaDataRaw& rawMetaData);
+
+    bool                                _parameterMetaDataLoaded;           ///< true: parameter meta data already loaded
+    ParameterMetaDataCache              _cache;                             ///< Open if meta data came from the binary cache
+    QHash<QString, PX4FactMetaDataRaw>  _mapParameterName2RawMetaData;      ///< Raw meta data from parsing the file, empty if loaded from cache
+    QMap<QString, FactMetaData*>        _mapParameterName2FactMetaData;     ///< FactMetaData created so far
 
-    bool _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
-    QMap<QString, FactMetaData*> _mapParameterName2FactMetaData; ///< Maps from a parameter name to FactMetaData
+    static const char*      _cacheTag;
+    static const quint32    _cacheFormatVersion = 1;   ///< Bump on any change to the PX4FactMetaDataRaw stream format
 };
 
 #endif
@@ -23,9 +23,13 @@
 #include "ScreenToolsController.h"
 #include "VideoManager.h"
 #include "nodeselector.h"
+#if defined(QGC_GST_STREAMING)
+#include "thermalitem.h"
+#endif
 #include "QGCToolbox.h"
 #include "QGCCorePlugin.h"
 #include "QGCOptions.h"
+#include "QGCStartupTracer.h"
 #include "Settings/SettingsManager.h"
 
 QGC_LOGGING_CATEGORY(VideoManagerLog, "VideoManagerLog")
@@ -33,7 +37,7 @@ QGC_LOGGING_CATEGORY(VideoManagerLog, "VideoManagerLog")
 //-----------------------------------------------------------------------------
 VideoManager::VideoManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
-    , _videoReceiver(NULL)
+    , _videoReceiverPool(NULL)
     , _videoSettings(NULL)
     , _fullScreen(false)
 {
@@ -42,8 +46,8 @@ VideoManager::VideoManager(QGCApplication* app, QGCToolbox* toolbox)
 //-----------------------------------------------------------------------------
 VideoManager::~VideoManager()
 {
-    if(_videoReceiver) {
-        delete _videoReceiver;
+    if(_videoReceiverPool) {
+        delete _videoReceiverPool;
     }
 }
 
@@ -65,8 +69,26 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
    connect(_videoSettings->tcpUrl(),        &Fact::rawValueChanged, this, &VideoManager::_tcpUrlChanged);
 
 #if defined(QGC_GST_STREAMING)
+    qmlRegisterType<LEPTONThermalItem>       ("QGroundControl",              1, 0, "LEPTONThermalItem");
+
+    emit isGStreamerChanged();
+    qCDebug(VideoManagerLog) << "New Video Source:" << videoSource;
+    _videoReceiverPool = new VideoReceiverPool(NodeSelector::instance(), _videoSettings, toolbox->corePlugin(), this);
+    connect(_videoReceiverPool, &VideoReceiverPool::activeChanged, this, &VideoManager::videoReceiverChanged);
+    emit videoReceiverChanged();
+    _updateSettings();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::init()
+{
+#if defined(QGC_GST_STREAMING)
+    QGCStartupTracer::Scope traceScope("VideoManager::init");
 #ifndef QGC_DISABLE_UVC
-   // If we are using a UVC camera setup the device name
+    // If we are using a UVC camera setup the device name
+    QString videoSource = _videoSettings->videoSource()->rawValue().toString();
     QList<QCameraInfo> cameras = QCameraInfo::availableCameras();
     foreach (const QCameraInfo &cameraInfo, cameras) {
         if(cameraInfo.description() == videoSource) {
@@ -77,17 +99,11 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
         }
     }
 #endif
-
-    emit isGStreamerChanged();
-    qCDebug(VideoManagerLog) << "New Video Source:" << videoSource;
-    _videoReceiver = toolbox->corePlugin()->createVideoReceiver(NodeSelector::instance(), this);
-    _updateSettings();
     if(isGStreamer()) {
-        _videoReceiver->start();
+        videoReceiver()->start();
     } else {
-        _videoReceiver->stop();
+        videoReceiver()->stop();
     }
-
 #endif
 }
 
@@ -129,6 +145,24 @@ VideoManager::_tcpUrlChanged()
     _restartVideo();
 }
 
+//-----------------------------------------------------------------------------
+void
+VideoManager::nextVideo()
+{
+    if(_videoReceiverPool) {
+        _videoReceiverPool->next();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::previousVideo()
+{
+    if(_videoReceiverPool) {
+        _videoReceiverPool->previous();
+    }
+}
+
 //-----------------------------------------------------------------------------
 bool
 VideoManager::hasVideo()
@@ -162,15 +196,15 @@ VideoManager::uvcEnabled()
 void
 VideoManager::_updateSettings()
 {
-    if(!_videoSettings || !_videoReceiver)
+    if(!_videoSettings || !_videoReceiverPool)
         return;
     if (_videoSettings->videoSource()->rawValue().toString() == VideoSettings::videoSourceUDP) {
 //        _videoReceiver->setUri(QStringLiteral("udp://0.0.0.0:%1").arg(_videoSettings->udpPort()->rawValue().toInt()));
-        _videoReceiver->setJitter(_videoSettings->jitterBuffer()->rawValue().toUInt());
+        _videoReceiverPool->setJitter(_videoSettings->jitterBuffer()->rawValue().toUInt());
     } else if (_videoSettings->videoSource()->rawValue().toString() == VideoSettings::videoSourceRTSP)
-        _videoReceiver->setUri(_videoSettings->rtspUrl()->rawValue().toString());
+        videoReceiver()->setUri(_videoSettings->rtspUrl()->rawValue().toString());
     else if (_videoSettings->videoSource()->rawValue().toString() == VideoSettings::videoSourceTCP)
-        _videoReceiver->setUri(QStringLiteral("tcp://%1").arg(_videoSettings->tcpUrl()->rawValue().toString()));
+        videoReceiver()->setUri(QStringLiteral("tcp://%1").arg(_videoSettings->tcpUrl()->rawValue().toString()));
 }
 
 //-----------------------------------------------------------------------------
@@ -178,10 +212,11 @@ void
 VideoManager::_restartVideo()
 {
 #if defined(QGC_GST_STREAMING)
-    if(!_videoReceiver)
+    if(!_videoReceiverPool)
         return;
-    _videoReceiver->stop();
+    // Node streams are all configured the same, restart every warm one so they pick up the change
+    _videoReceiverPool->stopAll();
     _updateSettings();
-    _videoReceiver->start();
+    _videoReceiverPool->startAll();
 #endif
 }
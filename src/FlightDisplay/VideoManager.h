@@ -17,6 +17,7 @@
 
 #include "QGCLoggingCategory.h"
 #include "VideoReceiver.h"
+#include "VideoReceiverPool.h"
 #include "QGCToolbox.h"
 
 Q_DECLARE_LOGGING_CATEGORY(VideoManagerLog)
@@ -36,14 +37,14 @@ public:
     Q_PROPERTY(QString          videoSourceID       READ    videoSourceID                               NOTIFY videoSourceIDChanged)
     Q_PROPERTY(bool             uvcEnabled          READ    uvcEnabled                                  CONSTANT)
     Q_PROPERTY(bool             fullScreen          READ    fullScreen      WRITE   setfullScreen       NOTIFY fullScreenChanged)
-    Q_PROPERTY(VideoReceiver*   videoReceiver       READ    videoReceiver                               CONSTANT)
+    Q_PROPERTY(VideoReceiver*   videoReceiver       READ    videoReceiver                               NOTIFY videoReceiverChanged)
 
     bool        hasVideo            ();
     bool        isGStreamer         ();
     bool        fullScreen          () { return _fullScreen; }
     QString     videoSourceID       () { return _videoSourceID; }
 
-    VideoReceiver*  videoReceiver   () { return _videoReceiver; }
+    VideoReceiver*  videoReceiver   () { return _videoReceiverPool ? _videoReceiverPool->active() : NULL; }
 
 #if defined(QGC_DISABLE_UVC)
     bool        uvcEnabled          () { return false; }
@@ -56,14 +57,23 @@ public:
     // Override from QGCTool
     void        setToolbox          (QGCToolbox *toolbox);
 
-    Q_INVOKABLE void startVideo() {_videoReceiver->start();};
-    Q_INVOKABLE void stopVideo() {_videoReceiver->stop();};
+    /// Probes for UVC cameras and starts the video stream. Called once the main window is up so that neither
+    /// holds up startup.
+    void        init                ();
+
+    Q_INVOKABLE void startVideo() {videoReceiver()->start();};
+    Q_INVOKABLE void stopVideo() {videoReceiver()->stop();};
+    /// Switch the displayed stream to the next/previous node. Streams kept warm by the pool
+    /// switch without restarting.
+    Q_INVOKABLE void nextVideo();
+    Q_INVOKABLE void previousVideo();
 
 signals:
     void hasVideoChanged            ();
     void isGStreamerChanged         ();
     void videoSourceIDChanged       ();
     void fullScreenChanged          ();
+    void videoReceiverChanged       ();
 
 private slots:
     void _videoSourceChanged        ();
@@ -76,7 +86,7 @@ private:
     void _updateSettings            ();
     void _restartVideo              ();
 
-    VideoReceiver*  _videoReceiver;
+    VideoReceiverPool*  _videoReceiverPool;
     VideoSettings*  _videoSettings;
     QString         _videoSourceID;
     bool            _fullScreen;
@@ -254,6 +254,7 @@ Item {
             var recording = recordingModesList.get(recordingComboBox.currentIndex).text;
             var optString = "-mm " + metringMode + " -awb " + awbMode + " -g " + iframeRate + " -ex " + exposureMode + " -w " + width + " -h " + height + " -fps " + fps + " -b " + bitrate + flipMode;
             console.log("lets start the video with following optons: " + optString);
+            // new options need a restart of the displayed stream, switching nodes goes through the video manager
             _videoReceiver.stop();
             _videoReceiver.delayedStart(optString, recording == "rec on");
         }
@@ -363,6 +364,29 @@ Item {
             z:            QGroundControl.zOrderWidgets
         }
 
+        // switch the displayed stream between nodes, streams kept warm by the pool switch without a restart
+        RoundButton {
+            id: previousVideoButton
+            buttonImage: "/res/buttonLeft.svg"
+            buttonAnchors.margins:  width*0.15
+            z:            QGroundControl.zOrderWidgets
+            onClicked: {
+                checked = false
+                QGroundControl.videoManager.previousVideo()
+            }
+        }
+
+        RoundButton {
+            id: nextVideoButton
+            buttonImage: "/res/buttonRight.svg"
+            buttonAnchors.margins:  width*0.15
+            z:            QGroundControl.zOrderWidgets
+            onClicked: {
+                checked = false
+                QGroundControl.videoManager.nextVideo()
+            }
+        }
+
         // camera sweep code disable for now.
         RoundButton {
             id: cameraAngleControlButton
@@ -656,6 +680,34 @@ Item {
     }
 
 
+    // thermal camera of the node, shown once its mjpeg server is up
+    LEPTONThermalItem {
+        id:                     thermalView
+        anchors.right:          parent.right
+        anchors.bottom:         parent.bottom
+        anchors.margins:        _margins
+        width:                  parent.width * 0.25
+        height:                 width * 3 / 4
+        visible:                hasThermalData && !_mainIsMap
+        z:                      QGroundControl.zOrderWidgets
+        palette:                1   // ironbow
+        spot:                   Qt.point(0.5, 0.5)
+
+        Connections {
+            target:             QGroundControl.nodeSelector
+            onThermalUrl:       thermalView.source = thermalUrl
+        }
+
+        QGCLabel {
+            anchors.left:       parent.left
+            anchors.bottom:     parent.bottom
+            anchors.margins:    _margins / 2
+            visible:            thermalView.radiometric
+            color:              "white"
+            text:               thermalView.spotTemperature.toFixed(1) + " \u00b0C (" + thermalView.minTemperature.toFixed(1) + " - " + thermalView.maxTemperature.toFixed(1) + ")"
+        }
+    }
+
     Component.onCompleted: {
         // some fidgeting to do to get the combo box working correctly. otherwise the model data
         // comes out to be invalid
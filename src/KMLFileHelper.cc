@@ -8,36 +8,242 @@
  ****************************************************************************/
 
 #include "KMLFileHelper.h"
+#include "QGCGeo.h"
 
 #include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QLocale>
+#include <QPair>
+#include <QXmlStreamReader>
+#include <QScopedPointer>
+#ifdef QGC_ENABLE_KMZ
+#include <private/qzipreader_p.h>
+#endif
+
+#include <algorithm>
 
 const char* KMLFileHelper::_errorPrefix = QT_TR_NOOP("KML file load failed. %1");
 
-QDomDocument KMLFileHelper::loadFile(const QString& kmlFile, QString& errorString)
+namespace {
+
+/// Splits the text of a KML coordinates element into lon,lat[,alt] tuples. The text can be fed in as many chunks
+/// as the xml reader hands out, a number split across two chunks is fine.
+class CoordinateTokenizer
+{
+public:
+    CoordinateTokenizer(QVector<double>& lat, QVector<double>& lon)
+        : _lat          (lat)
+        , _lon          (lon)
+        , _tokenLength  (0)
+        , _valueCount   (0)
+        , _afterComma   (false)
+        , _error        (false)
+    {
+    }
+
+    void add(const QChar* text, int length)
+    {
+        for (int i=0; i<length && !_error; i++) {
+            ushort c = text[i].unicode();
+
+            if (c == ',') {
+                if (_tokenLength == 0) {
+                    _error = true;
+                } else {
+                    _endValue();
+                    _afterComma = true;
+                }
+            } else if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                // Whitespace after a comma is tolerated, otherwise it ends the tuple
+                if (_tokenLength != 0) {
+                    _endValue();
+                    _endTuple();
+                }
+            } else if (c < 128 && _tokenLength < _maxTokenLength) {
+                _token[_tokenLength++] = static_cast<char>(c);
+                _afterComma = false;
+            } else {
+                _error = true;
+            }
+        }
+    }
+
+    /// @return false: badly formed coordinates
+    bool finish(void)
+    {
+        if (_tokenLength != 0) {
+            _endValue();
+            _endTuple();
+        }
+        return !_error && !_afterComma && _valueCount == 0;
+    }
+
+private:
+    void _endValue(void)
+    {
+        bool ok;
+        double value = _toDouble(_token, _tokenLength, ok);
+
+        _tokenLength = 0;
+        if (!ok || _valueCount == _maxValues) {
+            _error = true;
+            return;
+        }
+        _values[_valueCount++] = value;
+    }
+
+    void _endTuple(void)
+    {
+        if (_error) {
+            return;
+        }
+        if (_valueCount < 2) {
+            _error = true;
+            return;
+        }
+        _lon.append(_values[0]);
+        _lat.append(_values[1]);
+        _valueCount = 0;
+        _afterComma = false;
+    }
+
+    /// Fast path for the plain decimal numbers KML files are made of. Numbers with more digits than a double holds
+    /// exactly go through QLocale so the result is always correctly rounded.
+    static double _toDouble(const char* token, int length, bool& ok)
+    {
+        static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                              1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        const char* p =     token;
+        const char* end =   token + length;
+        bool        negative = false;
+        quint64     mantissa = 0;
+        int         digits = 0;
+        int         exponent = 0;
+        bool        anyDigits = false;
+        bool        exact = true;
+
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa ? 1 : 0;
+            } else {
+                exact = false;
+            }
+            anyDigits = true;
+            p++;
+        }
+        if (p < end && *p == '.') {
+            p++;
+            while (p < end && *p >= '0' && *p <= '9') {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    digits += mantissa ? 1 : 0;
+                    exponent--;
+                } else {
+                    exact = false;
+                }
+                anyDigits = true;
+                p++;
+            }
+        }
+        if (!anyDigits) {
+            ok = false;
+            return 0;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            // Rare enough to leave to the slow path, which also validates it
+            exact = false;
+            p = end;
+        }
+        if (p != end) {
+            ok = false;
+            return 0;
+        }
+
+        if (exact && mantissa <= (1ULL << 53) && exponent >= -22) {
+            double value = static_cast<double>(mantissa) / powersOfTen[-exponent];
+            ok = true;
+            return negative ? -value : value;
+        }
+
+        return QLocale::c().toDouble(QString::fromLatin1(token, length), &ok);
+    }
+
+    static const int _maxTokenLength =  63;
+    static const int _maxValues =       3;
+
+    QVector<double>&    _lat;
+    QVector<double>&    _lon;
+    char                _token[_maxTokenLength + 1];
+    int                 _tokenLength;
+    double              _values[_maxValues];
+    int                 _valueCount;
+    bool                _afterComma;
+    bool                _error;
+};
+
+}
+
+QIODevice* KMLFileHelper::_openFile(const QString& kmlFile, QString& errorString)
 {
-    QFile file(kmlFile);
+    QScopedPointer<QFile> file(new QFile(kmlFile));
 
     errorString.clear();
 
-    if (!file.exists()) {
+    if (!file->exists()) {
         errorString = QString(_errorPrefix).arg(tr("File not found: %1").arg(kmlFile));
-        return QDomDocument();
+        return NULL;
     }
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to open file: %1 error: $%2").arg(kmlFile).arg(file.errorString()));
-        return QDomDocument();
+    if (!file->open(QIODevice::ReadOnly)) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to open file: %1 error: $%2").arg(kmlFile).arg(file->errorString()));
+        return NULL;
     }
 
-    QDomDocument doc;
-    QString errorMessage;
-    int errorLine;
-    if (!doc.setContent(&file, &errorMessage, &errorLine)) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(errorMessage).arg(errorLine));
-        return QDomDocument();
+    if (file->peek(4) != QByteArray("PK\x03\x04", 4)) {
+        // Plain KML, read straight from the file
+        return file.take();
     }
 
-    return doc;
+#ifdef QGC_ENABLE_KMZ
+    // KMZ is a zip archive with the document as the first .kml file, usually doc.kml
+    QZipReader zip(file.data());
+    QString kmlPath;
+    foreach (const QZipReader::FileInfo& fileInfo, zip.fileInfoList()) {
+        if (fileInfo.isFile && fileInfo.filePath.endsWith(QStringLiteral(".kml"), Qt::CaseInsensitive)) {
+            kmlPath = fileInfo.filePath;
+            break;
+        }
+    }
+    if (kmlPath.isEmpty()) {
+        errorString = QString(_errorPrefix).arg(tr("No KML document found in KMZ file: %1").arg(kmlFile));
+        return NULL;
+    }
+
+    QByteArray kmlBytes = zip.fileData(kmlPath);
+    if (zip.status() != QZipReader::NoError) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to extract KML document from KMZ file: %1").arg(kmlFile));
+        return NULL;
+    }
+
+    QBuffer* buffer = new QBuffer();
+    buffer->setData(kmlBytes);
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+#else
+    errorString = QString(_errorPrefix).arg(tr("KMZ files are not supported by this build: %1").arg(kmlFile));
+    return NULL;
+#endif
+}
+
+QString KMLFileHelper::_parseError(const QString& kmlFile, const QXmlStreamReader& reader)
+{
+    return QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(reader.errorString()).arg(reader.lineNumber()));
 }
 
 QVariantList KMLFileHelper::determineFileContents(const QString& kmlFile)
@@ -54,18 +260,29 @@ QVariantList KMLFileHelper::determineFileContents(const QString& kmlFile)
 
 KMLFileHelper::KMLFileContents KMLFileHelper::determineFileContents(const QString& kmlFile, QString& errorString)
 {
-    QDomDocument domDocument = KMLFileHelper::loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    QScopedPointer<QIODevice> device(_openFile(kmlFile, errorString));
+    if (!device) {
         return Error;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count()) {
-        return Polygon;
+    // A Polygon anywhere wins over a LineString, so keep going until one is found
+    QXmlStreamReader reader(device.data());
+    bool foundLineString = false;
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QXmlStreamReader::StartElement) {
+            if (reader.name() == QLatin1String("Polygon")) {
+                return Polygon;
+            } else if (reader.name() == QLatin1String("LineString")) {
+                foundLineString = true;
+            }
+        }
+    }
+    if (reader.hasError()) {
+        errorString = _parseError(kmlFile, reader);
+        return Error;
     }
 
-    rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count()) {
+    if (foundLineString) {
         return Polyline;
     }
 
@@ -73,106 +290,208 @@ KMLFileHelper::KMLFileContents KMLFileHelper::determineFileContents(const QStrin
     return Error;
 }
 
-bool KMLFileHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString)
+bool KMLFileHelper::_loadCoordinates(const QString& kmlFile, const QStringList& elementPath, QVector<double>& lat, QVector<double>& lon, QString& errorString)
 {
-    errorString.clear();
-    vertices.clear();
+    lat.clear();
+    lon.clear();
 
-    QDomDocument domDocument = KMLFileHelper::loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    QScopedPointer<QIODevice> device(_openFile(kmlFile, errorString));
+    if (!device) {
         return false;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count() == 0) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to find Polygon node in KML"));
+    QXmlStreamReader reader(device.data());
+
+    // Find the first geometry element anywhere in the document
+    bool found = false;
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QXmlStreamReader::StartElement && reader.name() == elementPath[0]) {
+            found = true;
+            break;
+        }
+    }
+    if (reader.hasError()) {
+        errorString = _parseError(kmlFile, reader);
+        return false;
+    }
+    if (!found) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to find %1 node in KML").arg(elementPath[0]));
         return false;
     }
 
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("outerBoundaryIs").namedItem("LinearRing").namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
-        errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
+    // Walk down the direct children to the coordinates, skipping everything else
+    for (int i=1; i<elementPath.count(); i++) {
+        found = false;
+        while (reader.readNextStartElement()) {
+            if (reader.name() == elementPath[i]) {
+                found = true;
+                break;
+            }
+            reader.skipCurrentElement();
+        }
+        if (reader.hasError()) {
+            errorString = _parseError(kmlFile, reader);
+            return false;
+        }
+        if (!found) {
+            errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
+            return false;
+        }
+    }
+
+    // Coordinates are tokenized as they are read, the text is never held as a whole
+    CoordinateTokenizer tokenizer(lat, lon);
+    while (!reader.atEnd()) {
+        QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::Characters) {
+            QStringRef text = reader.text();
+            tokenizer.add(text.unicode(), text.length());
+        } else if (token == QXmlStreamReader::EndElement || token == QXmlStreamReader::StartElement) {
+            break;
+        }
+    }
+    if (reader.hasError()) {
+        errorString = _parseError(kmlFile, reader);
+        return false;
+    }
+    if (!tokenizer.finish()) {
+        errorString = QString(_errorPrefix).arg(tr("Badly formed coordinates in KML file: %1").arg(kmlFile));
         return false;
     }
 
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
+    return true;
+}
 
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
+bool KMLFileHelper::parseCoordinates(const QString& coordinates, QVector<double>& lat, QVector<double>& lon)
+{
+    lat.clear();
+    lon.clear();
 
-        QStringList rgValueStrings = coordinateString.split(",");
+    CoordinateTokenizer tokenizer(lat, lon);
+    tokenizer.add(coordinates.constData(), coordinates.length());
+    return tokenizer.finish();
+}
 
-        QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
+void KMLFileHelper::simplify(QVector<double>& lat, QVector<double>& lon, double tolerance)
+{
+    int count = lat.count();
 
-        rgCoords.append(coord);
+    if (count < 3 || tolerance <= 0) {
+        return;
     }
 
-    // Determine winding, reverse if needed
-    double sum = 0;
-    for (int i=0; i<rgCoords.count(); i++) {
-        QGeoCoordinate coord1 = rgCoords[i];
-        QGeoCoordinate coord2 = (i == rgCoords.count() - 1) ? rgCoords[0] : rgCoords[i+1];
+    // Distances are measured in a tangent plane at the first vertex
+    QVector<double> north(count), east(count);
+    convertGeoToNed(lat.constData(), lon.constData(), NULL, count, QGeoCoordinate(lat[0], lon[0]), north.data(), east.data(), NULL);
+
+    // Douglas-Peucker, with an explicit stack since outlines can have millions of vertices
+    QVector<bool> keep(count, false);
+    QVector<QPair<int, int>> spans;
+    double toleranceSquared = tolerance * tolerance;
+
+    keep[0] = keep[count - 1] = true;
+    spans.append(qMakePair(0, count - 1));
+    while (!spans.isEmpty()) {
+        QPair<int, int> span = spans.takeLast();
+        int     first =         span.first;
+        int     last =          span.second;
+        double  dNorth =        north[last] - north[first];
+        double  dEast =         east[last] - east[first];
+        double  lengthSquared = dNorth * dNorth + dEast * dEast;
+        double  maxSquared =    -1;
+        int     maxIndex =      -1;
+
+        for (int i=first+1; i<last; i++) {
+            double pNorth = north[i] - north[first];
+            double pEast =  east[i] - east[first];
+
+            // Closest point on the segment, a closed outline starts and ends on the same point
+            double t = lengthSquared > 0 ? qBound(0.0, (pNorth * dNorth + pEast * dEast) / lengthSquared, 1.0) : 0;
+            pNorth -= t * dNorth;
+            pEast -= t * dEast;
+
+            double distanceSquared = pNorth * pNorth + pEast * pEast;
+            if (distanceSquared > maxSquared) {
+                maxSquared = distanceSquared;
+                maxIndex = i;
+            }
+        }
 
-        sum += (coord2.longitude() - coord1.longitude()) * (coord2.latitude() + coord1.latitude());
+        if (maxSquared > toleranceSquared) {
+            keep[maxIndex] = true;
+            spans.append(qMakePair(first, maxIndex));
+            spans.append(qMakePair(maxIndex, last));
+        }
     }
-    bool reverse = sum < 0.0;
-    if (reverse) {
-        QList<QGeoCoordinate> rgReversed;
 
-        for (int i=0; i<rgCoords.count(); i++) {
-            rgReversed.prepend(rgCoords[i]);
+    int kept = 0;
+    for (int i=0; i<count; i++) {
+        if (keep[i]) {
+            lat[kept] = lat[i];
+            lon[kept] = lon[i];
+            kept++;
         }
-        rgCoords = rgReversed;
     }
-
-    vertices = rgCoords;
-
-    return true;
+    lat.resize(kept);
+    lon.resize(kept);
 }
 
-bool KMLFileHelper::loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString)
+bool KMLFileHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString, double simplifyTolerance)
 {
     errorString.clear();
-    coords.clear();
+    vertices.clear();
 
-    QDomDocument domDocument = KMLFileHelper::loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    QVector<double> lat, lon;
+    QStringList elementPath = QStringList() << QStringLiteral("Polygon") << QStringLiteral("outerBoundaryIs") << QStringLiteral("LinearRing") << QStringLiteral("coordinates");
+    if (!_loadCoordinates(kmlFile, elementPath, lat, lon, errorString)) {
         return false;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count() == 0) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to find LineString node in KML"));
-        return false;
+    // KML rings repeat the first vertex at the end
+    if (lat.count() > 1 && lat.first() == lat.last() && lon.first() == lon.last()) {
+        lat.removeLast();
+        lon.removeLast();
     }
 
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
-        errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
-        return false;
-    }
+    simplify(lat, lon, simplifyTolerance);
 
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
+    // Determine winding, reverse if needed
+    double sum = 0;
+    for (int i=0; i<lat.count(); i++) {
+        int next = (i == lat.count() - 1) ? 0 : i + 1;
 
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
+        sum += (lon[next] - lon[i]) * (lat[next] + lat[i]);
+    }
+    if (sum < 0.0) {
+        std::reverse(lat.begin(), lat.end());
+        std::reverse(lon.begin(), lon.end());
+    }
 
-        QStringList rgValueStrings = coordinateString.split(",");
+    vertices.reserve(lat.count());
+    for (int i=0; i<lat.count(); i++) {
+        vertices.append(QGeoCoordinate(lat[i], lon[i]));
+    }
 
-        QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
+    return true;
+}
 
-        rgCoords.append(coord);
+bool KMLFileHelper::loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString, double simplifyTolerance)
+{
+    errorString.clear();
+    coords.clear();
+
+    QVector<double> lat, lon;
+    QStringList elementPath = QStringList() << QStringLiteral("LineString") << QStringLiteral("coordinates");
+    if (!_loadCoordinates(kmlFile, elementPath, lat, lon, errorString)) {
+        return false;
     }
 
-    coords = rgCoords;
+    simplify(lat, lon, simplifyTolerance);
+
+    coords.reserve(lat.count());
+    for (int i=0; i<lat.count(); i++) {
+        coords.append(QGeoCoordinate(lat[i], lon[i]));
+    }
 
     return true;
 }
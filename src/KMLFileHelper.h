@@ -10,12 +10,20 @@
 #pragma once
 
 #include <QObject>
-#include <QDomDocument>
 #include <QList>
+#include <QVector>
 #include <QGeoCoordinate>
 
-/// The QGCMapPolygon class provides a polygon which can be displayed on a map using a map visuals control.
-/// It maintains a representation of the polygon on QVariantList and QmlObjectListModel format.
+class QIODevice;
+class QXmlStreamReader;
+
+/// Loads polygons and polylines from KML files, or KMZ archives holding a KML file.
+///
+/// Files are read with a streaming parser so only the coordinates being loaded are held in memory, never the whole
+/// document. The KML document of a KMZ archive is decompressed into memory first, KMZ support needs Qt's private zip
+/// reader and is only built with QGC_ENABLE_KMZ. Large outlines exported from GIS tools can be simplified while loading
+/// by giving a tolerance in meters: vertices which are closer than that to the simplified outline are dropped
+/// (Douglas-Peucker). Plan imports take the tolerance from AppSettings::kmlImportSimplifyTolerance, off by default.
 class KMLFileHelper : public QObject
 {
     Q_OBJECT
@@ -31,10 +39,26 @@ public:
     Q_INVOKABLE static QVariantList determineFileContents(const QString& kmlFile);
 
     static KMLFileContents determineFileContents(const QString& kmlFile, QString& errorString);
-    static QDomDocument loadFile(const QString& kmlFile, QString& errorString);
-    static bool loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString);
-    static bool loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString);
+    static bool loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString, double simplifyTolerance = 0);
+    static bool loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString, double simplifyTolerance = 0);
+
+    /// Parses the text of a KML coordinates element: whitespace separated lon,lat[,alt] tuples. Altitudes are ignored.
+    ///     @return false: badly formed coordinates
+    static bool parseCoordinates(const QString& coordinates, QVector<double>& lat, QVector<double>& lon);
+
+    /// Simplifies a line to the given tolerance in meters, the first and last vertices are always kept
+    static void simplify(QVector<double>& lat, QVector<double>& lon, double tolerance);
 
 private:
+    /// Opens the file as a KML document, extracting the KML from the archive for KMZ files
+    ///     @return NULL: unable to open, see errorString
+    static QIODevice* _openFile(const QString& kmlFile, QString& errorString);
+
+    /// Reads coordinates from the first element at the given path of nested element names
+    ///     @return false: not found or badly formed, see errorString
+    static bool _loadCoordinates(const QString& kmlFile, const QStringList& elementPath, QVector<double>& lat, QVector<double>& lon, QString& errorString);
+
+    static QString _parseError(const QString& kmlFile, const QXmlStreamReader& reader);
+
     static const char* _errorPrefix;
 };
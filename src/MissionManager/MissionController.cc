@@ -29,6 +29,7 @@
 #include "QGCQGeoCoordinate.h"
 #include "PlanMasterController.h"
 #include "KML.h"
+#include "QGCTracer.h"
 
 #ifndef __mobile__
 #include "MainWindow.h"
@@ -1087,6 +1088,7 @@ void MissionController::_addWaypointLineSegment(CoordVectHashTable& prevItemPair
 
 void MissionController::_recalcWaypointLines(void)
 {
+    QGC_TRACE_SCOPE("mission", "MissionController::_recalcWaypointLines");
     bool                firstCoordinateItem =   true;
     VisualMissionItem*  lastCoordinateItem =    qobject_cast<VisualMissionItem*>(_visualItems->get(0));
 
@@ -1237,6 +1239,7 @@ void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, dou
 
 void MissionController::_recalcMissionFlightStatus()
 {
+    QGC_TRACE_SCOPE("mission", "MissionController::_recalcMissionFlightStatus");
     if (!_visualItems->count()) {
         return;
     }
@@ -1481,6 +1484,7 @@ void MissionController::_recalcMissionFlightStatus()
 // This will update the sequence numbers to be sequential starting from 0
 void MissionController::_recalcSequence(void)
 {
+    QGC_TRACE_SCOPE("mission", "MissionController::_recalcSequence");
     if (_inRecalcSequence) {
         // Don't let this call recurse due to signalling
         return;
@@ -1501,6 +1505,7 @@ void MissionController::_recalcSequence(void)
 // This will update the child item hierarchy
 void MissionController::_recalcChildItems(void)
 {
+    QGC_TRACE_SCOPE("mission", "MissionController::_recalcChildItems");
     VisualMissionItem* currentParentItem = qobject_cast<VisualMissionItem*>(_visualItems->get(0));
 
     currentParentItem->childItems()->clear();
@@ -1551,6 +1556,7 @@ void MissionController::_setPlannedHomePositionFromFirstCoordinate(const QGeoCoo
 /// @param clickCoordinate The location of the user click when inserting a new item
 void MissionController::_recalcAllWithClickCoordinate(QGeoCoordinate& clickCoordinate)
 {
+    QGC_TRACE_SCOPE("mission", "MissionController::_recalcAllWithClickCoordinate");
     if (!_flyView) {
         _setPlannedHomePositionFromFirstCoordinate(clickCoordinate);
     }
@@ -514,6 +514,18 @@ QStringList PlanMasterController::fileKmlFilters(void) const
     return filters;
 }
 
+QStringList PlanMasterController::loadKmlFilters(void) const
+{
+    QStringList filters;
+
+#ifdef QGC_ENABLE_KMZ
+    filters << tr("KML Files (*.%1 *.%2)").arg(kmlFileExtension()).arg(AppSettings::kmzFileExtension) << tr("All Files (*.*)");
+#else
+    filters << tr("KML Files (*.%1)").arg(kmlFileExtension()) << tr("All Files (*.*)");
+#endif
+    return filters;
+}
+
 void PlanMasterController::sendPlanToVehicle(Vehicle* vehicle, const QString& filename)
 {
     // Use a transient PlanMasterController to accomplish this
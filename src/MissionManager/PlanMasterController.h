@@ -45,6 +45,7 @@ public:
     Q_PROPERTY(QStringList  loadNameFilters     READ loadNameFilters                    CONSTANT)                       ///< File filter list loading plan files
     Q_PROPERTY(QStringList  saveNameFilters     READ saveNameFilters                    CONSTANT)                       ///< File filter list saving plan files
     Q_PROPERTY(QStringList  fileKmlFilters      READ fileKmlFilters                     CONSTANT)                       ///< File filter list for load/save KML files
+    Q_PROPERTY(QStringList  loadKmlFilters      READ loadKmlFilters                     CONSTANT)                       ///< File filter list for loading KML or KMZ files
 
     /// Should be called immediately upon Component.onCompleted.
     Q_INVOKABLE void start(bool flyView);
@@ -85,6 +86,7 @@ public:
     QStringList loadNameFilters (void) const;
     QStringList saveNameFilters (void) const;
     QStringList fileKmlFilters  (void) const;
+    QStringList loadKmlFilters  (void) const;
 
     QJsonDocument saveToJson    ();
 
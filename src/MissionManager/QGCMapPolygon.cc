@@ -10,79 +10,142 @@
 #include "QGCMapPolygon.h"
 #include "QGCGeo.h"
 #include "JsonHelper.h"
-#include "QGCQGeoCoordinate.h"
 #include "QGCApplication.h"
 #include "KMLFileHelper.h"
+#include "SettingsManager.h"
 
 #include <QGeoRectangle>
 #include <QDebug>
 #include <QJsonArray>
 #include <QLineF>
 #include <QFile>
-#include <QDomDocument>
 
 const char* QGCMapPolygon::jsonPolygonKey = "polygon";
 
 QGCMapPolygon::QGCMapPolygon(QObject* parent)
-    : QObject               (parent)
-    , _dirty                (false)
-    , _centerDrag           (false)
-    , _ignoreCenterUpdates  (false)
-    , _interactive          (false)
+    : QObject                   (parent)
+    , _pathCacheValid           (true)
+    , _vertexModel              (this)
+    , _geometryUpdateNesting    (0)
+    , _geometryUpdatePending    (false)
+    , _changedVertex            (-1)
+    , _signalledCount           (0)
+    , _dirty                    (false)
+    , _centerDrag               (false)
+    , _ignoreCenterUpdates      (false)
+    , _interactive              (false)
 {
-    _init();
 }
 
 QGCMapPolygon::QGCMapPolygon(const QGCMapPolygon& other, QObject* parent)
-    : QObject               (parent)
-    , _dirty                (false)
-    , _centerDrag           (false)
-    , _ignoreCenterUpdates  (false)
-    , _interactive          (false)
+    : QObject                   (parent)
+    , _pathCacheValid           (true)
+    , _vertexModel              (this)
+    , _geometryUpdateNesting    (0)
+    , _geometryUpdatePending    (false)
+    , _changedVertex            (-1)
+    , _signalledCount           (0)
+    , _dirty                    (false)
+    , _centerDrag               (false)
+    , _ignoreCenterUpdates      (false)
+    , _interactive              (false)
 {
     *this = other;
-
-    _init();
 }
 
-void QGCMapPolygon::_init(void)
+const QGCMapPolygon& QGCMapPolygon::operator=(const QGCMapPolygon& other)
 {
-    connect(&_polygonModel, &QmlObjectListModel::dirtyChanged, this, &QGCMapPolygon::_polygonModelDirtyChanged);
-    connect(&_polygonModel, &QmlObjectListModel::countChanged, this, &QGCMapPolygon::_polygonModelCountChanged);
-    connect(this, &QGCMapPolygon::pathChanged, this, &QGCMapPolygon::_updateCenter);
+    _beginGeometryUpdate();
+    clear();
+    _setVertices(other._latitudes, other._longitudes);
+    _endGeometryUpdate();
+
+    setDirty(true);
+
+    return *this;
 }
 
-const QGCMapPolygon& QGCMapPolygon::operator=(const QGCMapPolygon& other)
+void QGCMapPolygon::_beginGeometryUpdate(void)
 {
-    clear();
+    _geometryUpdateNesting++;
+}
 
-    QVariantList vertices = other.path();
-    QList<QGeoCoordinate> rgCoord;
-    foreach (const QVariant& vertexVar, vertices) {
-        rgCoord.append(vertexVar.value<QGeoCoordinate>());
+void QGCMapPolygon::_endGeometryUpdate(void)
+{
+    if (--_geometryUpdateNesting > 0 || !_geometryUpdatePending) {
+        return;
     }
-    appendVertices(rgCoord);
+    _geometryUpdatePending = false;
 
+    if (_changedVertex == -1) {
+        _vertexModel.verticesChanged();
+    } else {
+        _vertexModel.vertexChanged(_changedVertex);
+    }
+    if (_signalledCount != count()) {
+        _signalledCount = count();
+        emit countChanged(_signalledCount);
+    }
+    emit pathChanged();
+    _updateCenter();
     setDirty(true);
+}
 
-    return *this;
+void QGCMapPolygon::_geometryChanged(int vertexIndex)
+{
+    _pathCacheValid = false;
+
+    if (!_geometryUpdatePending) {
+        _geometryUpdatePending = true;
+        _changedVertex = vertexIndex;
+    } else if (_changedVertex != vertexIndex) {
+        _changedVertex = -1;
+    }
+
+    if (_geometryUpdateNesting == 0) {
+        _beginGeometryUpdate();
+        _endGeometryUpdate();
+    }
+}
+
+void QGCMapPolygon::_setVertices(const QVector<double>& latitudes, const QVector<double>& longitudes)
+{
+    _latitudes = latitudes;
+    _longitudes = longitudes;
+    _geometryChanged(-1);
+}
+
+QVariantList QGCMapPolygon::path(void) const
+{
+    if (!_pathCacheValid) {
+        _pathCache.clear();
+        _pathCache.reserve(count());
+        for (int i=0; i<count(); i++) {
+            _pathCache.append(QVariant::fromValue(QGeoCoordinate(_latitudes[i], _longitudes[i])));
+        }
+        _pathCacheValid = true;
+    }
+
+    return _pathCache;
 }
 
 void QGCMapPolygon::clear(void)
 {
-    // Bug workaround, see below
-    while (_polygonPath.count() > 1) {
-        _polygonPath.takeLast();
+    // Bug workaround, see below. Not needed when clearing is part of a larger update.
+    if (_geometryUpdateNesting == 0 && count() > 1) {
+        _latitudes.resize(1);
+        _longitudes.resize(1);
+        _pathCacheValid = false;
+        emit pathChanged();
     }
-    emit pathChanged();
 
     // Although this code should remove the polygon from the map it doesn't. There appears
     // to be a bug in QGCMapPolygon which causes it to not be redrawn if the list is empty. So
     // we work around it by using the code above to remove all but the last point which in turn
     // will cause the polygon to go away.
-    _polygonPath.clear();
-
-    _polygonModel.clearAndDeleteContents();
+    _latitudes.clear();
+    _longitudes.clear();
+    _geometryChanged(-1);
 
     emit cleared();
 
@@ -91,45 +154,25 @@ void QGCMapPolygon::clear(void)
 
 void QGCMapPolygon::adjustVertex(int vertexIndex, const QGeoCoordinate coordinate)
 {
-    _polygonPath[vertexIndex] = QVariant::fromValue(coordinate);
-    if (!_centerDrag) {
-        // When dragging center we don't signal path changed until add vertices are updated
-        emit pathChanged();
-    }
-    _polygonModel.value<QGCQGeoCoordinate*>(vertexIndex)->setCoordinate(coordinate);
-    setDirty(true);
+    _latitudes[vertexIndex] = coordinate.latitude();
+    _longitudes[vertexIndex] = coordinate.longitude();
+    _geometryChanged(vertexIndex);
 }
 
 void QGCMapPolygon::setDirty(bool dirty)
 {
     if (_dirty != dirty) {
         _dirty = dirty;
-        if (!dirty) {
-            _polygonModel.setDirty(false);
-        }
         emit dirtyChanged(dirty);
     }
 }
 
-QGeoCoordinate QGCMapPolygon::_coordFromPointF(const QPointF& point) const
-{
-    QGeoCoordinate coord;
-
-    if (_polygonPath.count() > 0) {
-        QGeoCoordinate tangentOrigin = _polygonPath[0].value<QGeoCoordinate>();
-        convertNedToGeo(-point.y(), point.x(), 0, tangentOrigin, &coord);
-    }
-
-    return coord;
-}
-
 QPointF QGCMapPolygon::_pointFFromCoord(const QGeoCoordinate& coordinate) const
 {
-    if (_polygonPath.count() > 0) {
+    if (count() > 0) {
         double y, x, down;
-        QGeoCoordinate tangentOrigin = _polygonPath[0].value<QGeoCoordinate>();
 
-        convertGeoToNed(coordinate, tangentOrigin, &y, &x, &down);
+        convertGeoToNed(coordinate, vertexCoordinate(0), &y, &x, &down);
         return QPointF(x, -y);
     }
 
@@ -140,9 +183,9 @@ QPolygonF QGCMapPolygon::_toPolygonF(void) const
 {
     QPolygonF polygon;
 
-    if (_polygonPath.count() > 2) {
-        for (int i=0; i<_polygonPath.count(); i++) {
-            polygon.append(_pointFFromCoord(_polygonPath[i].value<QGeoCoordinate>()));
+    if (count() > 2) {
+        foreach (const QPointF& nedVertex, nedPolygon()) {
+            polygon.append(QPointF(nedVertex.x(), -nedVertex.y()));
         }
     }
 
@@ -151,7 +194,7 @@ QPolygonF QGCMapPolygon::_toPolygonF(void) const
 
 bool QGCMapPolygon::containsCoordinate(const QGeoCoordinate& coordinate) const
 {
-    if (_polygonPath.count() > 2) {
+    if (count() > 2) {
         return _toPolygonF().containsPoint(_pointFFromCoord(coordinate), Qt::OddEvenFill);
     } else {
         return false;
@@ -160,35 +203,38 @@ bool QGCMapPolygon::containsCoordinate(const QGeoCoordinate& coordinate) const
 
 void QGCMapPolygon::setPath(const QList<QGeoCoordinate>& path)
 {
-    _polygonPath.clear();
-    _polygonModel.clearAndDeleteContents();
+    QVector<double> latitudes, longitudes;
+
+    latitudes.reserve(path.count());
+    longitudes.reserve(path.count());
     foreach(const QGeoCoordinate& coord, path) {
-        _polygonPath.append(QVariant::fromValue(coord));
-        _polygonModel.append(new QGCQGeoCoordinate(coord, this));
+        latitudes.append(coord.latitude());
+        longitudes.append(coord.longitude());
     }
 
-    setDirty(true);
-    emit pathChanged();
+    _setVertices(latitudes, longitudes);
 }
 
 void QGCMapPolygon::setPath(const QVariantList& path)
 {
-    _polygonPath = path;
-
-    _polygonModel.clearAndDeleteContents();
-    for (int i=0; i<_polygonPath.count(); i++) {
-        _polygonModel.append(new QGCQGeoCoordinate(_polygonPath[i].value<QGeoCoordinate>(), this));
+    QVector<double> latitudes, longitudes;
+
+    latitudes.reserve(path.count());
+    longitudes.reserve(path.count());
+    foreach(const QVariant& coordVar, path) {
+        QGeoCoordinate coord = coordVar.value<QGeoCoordinate>();
+        latitudes.append(coord.latitude());
+        longitudes.append(coord.longitude());
     }
 
-    setDirty(true);
-    emit pathChanged();
+    _setVertices(latitudes, longitudes);
 }
 
 void QGCMapPolygon::saveToJson(QJsonObject& json)
 {
     QJsonValue jsonValue;
 
-    JsonHelper::saveGeoCoordinateArray(_polygonPath, false /* writeAltitude*/, jsonValue);
+    JsonHelper::saveGeoCoordinateArray(path(), false /* writeAltitude*/, jsonValue);
     json.insert(jsonPolygonKey, jsonValue);
     setDirty(false);
 }
@@ -206,16 +252,13 @@ bool QGCMapPolygon::loadFromJson(const QJsonObject& json, bool required, QString
         return true;
     }
 
-    if (!JsonHelper::loadGeoCoordinateArray(json[jsonPolygonKey], false /* altitudeRequired */, _polygonPath, errorString)) {
+    QVariantList polygonPath;
+    if (!JsonHelper::loadGeoCoordinateArray(json[jsonPolygonKey], false /* altitudeRequired */, polygonPath, errorString)) {
         return false;
     }
-
-    for (int i=0; i<_polygonPath.count(); i++) {
-        _polygonModel.append(new QGCQGeoCoordinate(_polygonPath[i].value<QGeoCoordinate>(), this));
-    }
+    setPath(polygonPath);
 
     setDirty(false);
-    emit pathChanged();
 
     return true;
 }
@@ -224,8 +267,9 @@ QList<QGeoCoordinate> QGCMapPolygon::coordinateList(void) const
 {
     QList<QGeoCoordinate> coords;
 
-    for (int i=0; i<_polygonPath.count(); i++) {
-        coords.append(_polygonPath[i].value<QGeoCoordinate>());
+    coords.reserve(count());
+    for (int i=0; i<count(); i++) {
+        coords.append(QGeoCoordinate(_latitudes[i], _longitudes[i]));
     }
 
     return coords;
@@ -234,12 +278,12 @@ QList<QGeoCoordinate> QGCMapPolygon::coordinateList(void) const
 void QGCMapPolygon::splitPolygonSegment(int vertexIndex)
 {
     int nextIndex = vertexIndex + 1;
-    if (nextIndex > _polygonPath.length() - 1) {
+    if (nextIndex > count() - 1) {
         nextIndex = 0;
     }
 
-    QGeoCoordinate firstVertex = _polygonPath[vertexIndex].value<QGeoCoordinate>();
-    QGeoCoordinate nextVertex = _polygonPath[nextIndex].value<QGeoCoordinate>();
+    QGeoCoordinate firstVertex = vertexCoordinate(vertexIndex);
+    QGeoCoordinate nextVertex = vertexCoordinate(nextIndex);
 
     double distance = firstVertex.distanceTo(nextVertex);
     double azimuth = firstVertex.azimuthTo(nextVertex);
@@ -248,60 +292,49 @@ void QGCMapPolygon::splitPolygonSegment(int vertexIndex)
     if (nextIndex == 0) {
         appendVertex(newVertex);
     } else {
-        _polygonModel.insert(nextIndex, new QGCQGeoCoordinate(newVertex, this));
-        _polygonPath.insert(nextIndex, QVariant::fromValue(newVertex));
-        emit pathChanged();
+        _latitudes.insert(nextIndex, newVertex.latitude());
+        _longitudes.insert(nextIndex, newVertex.longitude());
+        _geometryChanged(-1);
     }
 }
 
 void QGCMapPolygon::appendVertex(const QGeoCoordinate& coordinate)
 {
-    _polygonPath.append(QVariant::fromValue(coordinate));
-    _polygonModel.append(new QGCQGeoCoordinate(coordinate, this));
-    emit pathChanged();
+    _latitudes.append(coordinate.latitude());
+    _longitudes.append(coordinate.longitude());
+    _geometryChanged(-1);
 }
 
 void QGCMapPolygon::appendVertices(const QList<QGeoCoordinate>& coordinates)
 {
-    QList<QObject*> objects;
-
-    foreach (const QGeoCoordinate& coordinate, coordinates) {
-        objects.append(new QGCQGeoCoordinate(coordinate, this));
-        _polygonPath.append(QVariant::fromValue(coordinate));
+    if (coordinates.isEmpty()) {
+        return;
     }
-    _polygonModel.append(objects);
-    emit pathChanged();
-}
 
-void QGCMapPolygon::_polygonModelDirtyChanged(bool dirty)
-{
-    if (dirty) {
-        setDirty(true);
+    _latitudes.reserve(count() + coordinates.count());
+    _longitudes.reserve(count() + coordinates.count());
+    foreach (const QGeoCoordinate& coordinate, coordinates) {
+        _latitudes.append(coordinate.latitude());
+        _longitudes.append(coordinate.longitude());
     }
+    _geometryChanged(-1);
 }
 
 void QGCMapPolygon::removeVertex(int vertexIndex)
 {
-    if (vertexIndex < 0 && vertexIndex > _polygonPath.length() - 1) {
-        qWarning() << "Call to removePolygonCoordinate with bad vertexIndex:count" << vertexIndex << _polygonPath.length();
+    if (vertexIndex < 0 || vertexIndex > count() - 1) {
+        qWarning() << "Call to removePolygonCoordinate with bad vertexIndex:count" << vertexIndex << count();
         return;
     }
 
-    if (_polygonPath.length() <= 3) {
+    if (count() <= 3) {
         // Don't allow the user to trash the polygon
         return;
     }
 
-    QObject* coordObj = _polygonModel.removeAt(vertexIndex);
-    coordObj->deleteLater();
-
-    _polygonPath.removeAt(vertexIndex);
-    emit pathChanged();
-}
-
-void QGCMapPolygon::_polygonModelCountChanged(int count)
-{
-    emit countChanged(count);
+    _latitudes.remove(vertexIndex);
+    _longitudes.remove(vertexIndex);
+    _geometryChanged(-1);
 }
 
 void QGCMapPolygon::_updateCenter(void)
@@ -309,13 +342,13 @@ void QGCMapPolygon::_updateCenter(void)
     if (!_ignoreCenterUpdates) {
         QGeoCoordinate center;
 
-        if (_polygonPath.count() > 2) {
+        if (count() > 2) {
             QPointF centroid(0, 0);
-            QPolygonF polygonF = _toPolygonF();
-            for (int i=0; i<polygonF.count(); i++) {
-                centroid += polygonF[i];
+            QList<QPointF> nedVertices = nedPolygon();
+            foreach (const QPointF& nedVertex, nedVertices) {
+                centroid += nedVertex;
             }
-            center = _coordFromPointF(QPointF(centroid.x() / polygonF.count(), centroid.y() / polygonF.count()));
+            convertNedToGeo(centroid.y() / nedVertices.count(), centroid.x() / nedVertices.count(), 0, vertexCoordinate(0), &center);
         }
         if (_center != center) {
             _center = center;
@@ -327,23 +360,24 @@ void QGCMapPolygon::_updateCenter(void)
 void QGCMapPolygon::setCenter(QGeoCoordinate newCenter)
 {
     if (newCenter != _center) {
-        _ignoreCenterUpdates = true;
-
-        // Adjust polygon vertices to new center
-        double distance = _center.distanceTo(newCenter);
-        double azimuth = _center.azimuthTo(newCenter);
-
-        for (int i=0; i<count(); i++) {
-            QGeoCoordinate oldVertex = _polygonPath[i].value<QGeoCoordinate>();
-            QGeoCoordinate newVertex = oldVertex.atDistanceAndAzimuth(distance, azimuth);
-            adjustVertex(i, newVertex);
+        if (!_center.isValid()) {
+            // Not enough vertices for a center, nothing to move
+            _center = newCenter;
+            emit centerChanged(newCenter);
+            return;
         }
 
-        if (_centerDrag) {
-            // When center dragging signals are delayed until all vertices are updated
-            emit pathChanged();
-        }
+        // Move all vertices in a single update by carrying their offsets from the old center over to the new one
+        int             vertexCount = count();
+        QVector<double> north(vertexCount), east(vertexCount);
+
+        convertGeoToNed(_latitudes.constData(), _longitudes.constData(), NULL, vertexCount, _center, north.data(), east.data(), NULL);
 
+        _ignoreCenterUpdates = true;
+        _beginGeometryUpdate();
+        convertNedToGeo(north.constData(), east.constData(), NULL, vertexCount, newCenter, _latitudes.data(), _longitudes.data(), NULL);
+        _geometryChanged(-1);
+        _endGeometryUpdate();
         _ignoreCenterUpdates = false;
 
         _center = newCenter;
@@ -369,10 +403,10 @@ void QGCMapPolygon::setInteractive(bool interactive)
 
 QGeoCoordinate QGCMapPolygon::vertexCoordinate(int vertex) const
 {
-    if (vertex >= 0 && vertex < _polygonPath.count()) {
-        return _polygonPath[vertex].value<QGeoCoordinate>();
+    if (vertex >= 0 && vertex < count()) {
+        return QGeoCoordinate(_latitudes[vertex], _longitudes[vertex]);
     } else {
-        qWarning() << "QGCMapPolygon::vertexCoordinate bad vertex requested:count" << vertex << _polygonPath.count();
+        qWarning() << "QGCMapPolygon::vertexCoordinate bad vertex requested:count" << vertex << count();
         return QGeoCoordinate();
     }
 }
@@ -380,20 +414,15 @@ QGeoCoordinate QGCMapPolygon::vertexCoordinate(int vertex) const
 QList<QPointF> QGCMapPolygon::nedPolygon(void) const
 {
     QList<QPointF>  nedPolygon;
+    int             vertexCount = count();
 
-    if (count() > 0) {
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+    if (vertexCount > 0) {
+        QVector<double> north(vertexCount), east(vertexCount);
 
-        for (int i=0; i<_polygonModel.count(); i++) {
-            double y, x, down;
-            QGeoCoordinate vertex = vertexCoordinate(i);
-            if (i == 0) {
-                // This avoids a nan calculation that comes out of convertGeoToNed
-                x = y = 0;
-            } else {
-                convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
-            }
-            nedPolygon += QPointF(x, y);
+        convertGeoToNed(_latitudes.constData(), _longitudes.constData(), NULL, vertexCount, vertexCoordinate(0), north.data(), east.data(), NULL);
+
+        for (int i=0; i<vertexCount; i++) {
+            nedPolygon += QPointF(east[i], north[i]);
         }
     }
 
@@ -447,22 +476,26 @@ void QGCMapPolygon::offset(double distance)
         }
     }
 
-    // Update internals
+    // Update internals, as a single path change
+    _beginGeometryUpdate();
     clear();
     appendVertices(rgNewPolygon);
+    _endGeometryUpdate();
 }
 
 bool QGCMapPolygon::loadKMLFile(const QString& kmlFile)
 {
     QString errorString;
     QList<QGeoCoordinate> rgCoords;
-    if (!KMLFileHelper::loadPolygonFromFile(kmlFile, rgCoords, errorString)) {
+    if (!KMLFileHelper::loadPolygonFromFile(kmlFile, rgCoords, errorString, qgcApp()->toolbox()->settingsManager()->appSettings()->kmlImportSimplifyTolerance()->rawValue().toDouble())) {
         qgcApp()->showMessage(errorString);
         return false;
     }
 
+    _beginGeometryUpdate();
     clear();
     appendVertices(rgCoords);
+    _endGeometryUpdate();
 
     return true;
 }
@@ -471,7 +504,7 @@ double QGCMapPolygon::area(void) const
 {
     // https://www.mathopenref.com/coordpolygonarea2.html
 
-    if (_polygonPath.count() < 3) {
+    if (count() < 3) {
         return 0;
     }
 
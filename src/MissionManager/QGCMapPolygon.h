@@ -13,12 +13,15 @@
 #include <QObject>
 #include <QGeoCoordinate>
 #include <QVariantList>
+#include <QVector>
 #include <QPolygon>
 
-#include "QmlObjectListModel.h"
+#include "QGCMapPolygonVertexModel.h"
 
 /// The QGCMapPolygon class provides a polygon which can be displayed on a map using a map visuals control.
-/// It maintains a representation of the polygon on QVariantList and QmlObjectListModel format.
+/// Vertices are stored in packed latitude/longitude arrays. The QVariantList path for drawing is built when asked
+/// for, and the vertex model only holds rows for the vertices which need handles on the map. Each change to the
+/// polygon, including moving or offsetting all of it, is signalled as a single path update.
 class QGCMapPolygon : public QObject
 {
     Q_OBJECT
@@ -29,13 +32,13 @@ public:
 
     const QGCMapPolygon& operator=(const QGCMapPolygon& other);
 
-    Q_PROPERTY(int                  count       READ count                                  NOTIFY countChanged)
-    Q_PROPERTY(QVariantList         path        READ path                                   NOTIFY pathChanged)
-    Q_PROPERTY(QmlObjectListModel*  pathModel   READ qmlPathModel                           CONSTANT)
-    Q_PROPERTY(bool                 dirty       READ dirty          WRITE setDirty          NOTIFY dirtyChanged)
-    Q_PROPERTY(QGeoCoordinate       center      READ center         WRITE setCenter         NOTIFY centerChanged)
-    Q_PROPERTY(bool                 centerDrag  READ centerDrag     WRITE setCenterDrag     NOTIFY centerDragChanged)
-    Q_PROPERTY(bool                 interactive READ interactive    WRITE setInteractive    NOTIFY interactiveChanged)
+    Q_PROPERTY(int                          count       READ count                                  NOTIFY countChanged)
+    Q_PROPERTY(QVariantList                 path        READ path                                   NOTIFY pathChanged)
+    Q_PROPERTY(QGCMapPolygonVertexModel*    pathModel   READ qmlPathModel                           CONSTANT)
+    Q_PROPERTY(bool                         dirty       READ dirty          WRITE setDirty          NOTIFY dirtyChanged)
+    Q_PROPERTY(QGeoCoordinate               center      READ center         WRITE setCenter         NOTIFY centerChanged)
+    Q_PROPERTY(bool                         centerDrag  READ centerDrag     WRITE setCenterDrag     NOTIFY centerDragChanged)
+    Q_PROPERTY(bool                         interactive READ interactive    WRITE setInteractive    NOTIFY interactiveChanged)
 
     Q_INVOKABLE void clear(void);
     Q_INVOKABLE void appendVertex(const QGeoCoordinate& coordinate);
@@ -66,6 +69,10 @@ public:
     /// Returns the QGeoCoordinate for the vertex specified
     QGeoCoordinate vertexCoordinate(int vertex) const;
 
+    /// Packed vertex latitudes/longitudes in degrees
+    const QVector<double>& latitudes    (void) const { return _latitudes; }
+    const QVector<double>& longitudes   (void) const { return _longitudes; }
+
     /// Saves the polygon to the json object.
     ///     @param json Json object to save to
     void saveToJson(QJsonObject& json);
@@ -85,16 +92,16 @@ public:
 
     // Property methods
 
-    int             count       (void) const { return _polygonPath.count(); }
+    int             count       (void) const { return _latitudes.count(); }
     bool            dirty       (void) const { return _dirty; }
     void            setDirty    (bool dirty);
     QGeoCoordinate  center      (void) const { return _center; }
     bool            centerDrag  (void) const { return _centerDrag; }
     bool            interactive (void) const { return _interactive; }
 
-    QVariantList        path        (void) const { return _polygonPath; }
-    QmlObjectListModel* qmlPathModel(void) { return &_polygonModel; }
-    QmlObjectListModel& pathModel   (void) { return _polygonModel; }
+    QVariantList                path        (void) const;
+    QGCMapPolygonVertexModel*   qmlPathModel(void) { return &_vertexModel; }
+    QGCMapPolygonVertexModel&   pathModel   (void) { return _vertexModel; }
 
     void setPath        (const QList<QGeoCoordinate>& path);
     void setPath        (const QVariantList& path);
@@ -113,24 +120,34 @@ signals:
     void centerDragChanged  (bool centerDrag);
     void interactiveChanged (bool interactive);
 
-private slots:
-    void _polygonModelCountChanged(int count);
-    void _polygonModelDirtyChanged(bool dirty);
-    void _updateCenter(void);
-
 private:
-    void _init(void);
+    void _updateCenter(void);
     QPolygonF _toPolygonF(void) const;
-    QGeoCoordinate _coordFromPointF(const QPointF& point) const;
     QPointF _pointFFromCoord(const QGeoCoordinate& coordinate) const;
 
-    QVariantList        _polygonPath;
-    QmlObjectListModel  _polygonModel;
-    bool                _dirty;
-    QGeoCoordinate      _center;
-    bool                _centerDrag;
-    bool                _ignoreCenterUpdates;
-    bool                _interactive;
+    /// Changes made between begin and end are signalled as a single update
+    void _beginGeometryUpdate(void);
+    void _endGeometryUpdate(void);
+
+    /// Records a change to the vertex specified, -1 for vertices added, removed or all changed
+    void _geometryChanged(int vertexIndex);
+
+    void _setVertices(const QVector<double>& latitudes, const QVector<double>& longitudes);
+
+    QVector<double>             _latitudes;
+    QVector<double>             _longitudes;
+    mutable QVariantList        _pathCache;
+    mutable bool                _pathCacheValid;
+    QGCMapPolygonVertexModel    _vertexModel;
+    int                         _geometryUpdateNesting;
+    bool                        _geometryUpdatePending;
+    int                         _changedVertex;         ///< Only vertex changed in the pending update, -1 for many
+    int                         _signalledCount;
+    bool                        _dirty;
+    QGeoCoordinate              _center;
+    bool                        _centerDrag;
+    bool                        _ignoreCenterUpdates;
+    bool                        _interactive;
 };
 
 #endif
@@ -9,7 +9,6 @@
 
 #include "QGCMapPolygonTest.h"
 #include "QGCApplication.h"
-#include "QGCQGeoCoordinate.h"
 
 QGCMapPolygonTest::QGCMapPolygonTest(void)
 {
@@ -30,7 +29,6 @@ void QGCMapPolygonTest::init(void)
     _rgPolygonSignals[centerChangedIndex] =         SIGNAL(centerChanged(QGeoCoordinate));
 
     _rgModelSignals[modelCountChangedIndex] = SIGNAL(countChanged(int));
-    _rgModelSignals[modelDirtyChangedIndex] = SIGNAL(dirtyChanged(bool));
 
     _mapPolygon = new QGCMapPolygon(this);
     _pathModel = _mapPolygon->qmlPathModel();
@@ -50,22 +48,24 @@ void QGCMapPolygonTest::cleanup(void)
     delete _multiSpyModel;
 }
 
+QGeoCoordinate QGCMapPolygonTest::_vertexCoordinate(int row)
+{
+    return _pathModel->data(_pathModel->index(row), QGCMapPolygonVertexModel::coordinateRole).value<QGeoCoordinate>();
+}
+
 void QGCMapPolygonTest::_testDirty(void)
 {
     // Check basic dirty bit set/get
 
     QVERIFY(!_mapPolygon->dirty());
-    QVERIFY(!_pathModel->dirty());
 
     _mapPolygon->setDirty(false);
     QVERIFY(!_mapPolygon->dirty());
-    QVERIFY(!_pathModel->dirty());
     QVERIFY(_multiSpyPolygon->checkNoSignals());
     QVERIFY(_multiSpyModel->checkNoSignals());
 
     _mapPolygon->setDirty(true);
     QVERIFY(_mapPolygon->dirty());
-    QVERIFY(!_pathModel->dirty());
     QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(polygonDirtyChangedMask));
     QVERIFY(_multiSpyPolygon->pullBoolFromSignalIndex(polygonDirtyChangedIndex));
     QVERIFY(_multiSpyModel->checkNoSignals());
@@ -73,31 +73,10 @@ void QGCMapPolygonTest::_testDirty(void)
 
     _mapPolygon->setDirty(false);
     QVERIFY(!_mapPolygon->dirty());
-    QVERIFY(!_pathModel->dirty());
     QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(polygonDirtyChangedMask));
     QVERIFY(!_multiSpyPolygon->pullBoolFromSignalIndex(polygonDirtyChangedIndex));
     QVERIFY(_multiSpyModel->checkNoSignals());
     _multiSpyPolygon->clearAllSignals();
-
-    _pathModel->setDirty(true);
-    QVERIFY(_pathModel->dirty());
-    QVERIFY(_mapPolygon->dirty());
-    QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(polygonDirtyChangedMask));
-    QVERIFY(_multiSpyPolygon->pullBoolFromSignalIndex(polygonDirtyChangedIndex));
-    QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelDirtyChangedMask));
-    QVERIFY(_multiSpyModel->pullBoolFromSignalIndex(modelDirtyChangedIndex));
-    _multiSpyPolygon->clearAllSignals();
-    _multiSpyModel->clearAllSignals();
-
-    _mapPolygon->setDirty(false);
-    QVERIFY(!_mapPolygon->dirty());
-    QVERIFY(!_pathModel->dirty());
-    QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(polygonDirtyChangedMask));
-    QVERIFY(!_multiSpyPolygon->pullBoolFromSignalIndex(polygonDirtyChangedIndex));
-    QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelDirtyChangedMask));
-    QVERIFY(!_multiSpyModel->pullBoolFromSignalIndex(modelDirtyChangedIndex));
-    _multiSpyPolygon->clearAllSignals();
-    _multiSpyModel->clearAllSignals();
 }
 
 void QGCMapPolygonTest::_testVertexManipulation(void)
@@ -128,12 +107,11 @@ void QGCMapPolygonTest::_testVertexManipulation(void)
         } else {
             QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(pathChangedMask | polygonDirtyChangedMask | polygonCountChangedMask));
         }
-        QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelDirtyChangedMask | modelCountChangedMask));
+        QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelCountChangedMask));
         QCOMPARE(_multiSpyPolygon->pullIntFromSignalIndex(polygonCountChangedIndex), i+1);
         QCOMPARE(_multiSpyModel->pullIntFromSignalIndex(modelCountChangedIndex), i+1);
 
         QVERIFY(_mapPolygon->dirty());
-        QVERIFY(_pathModel->dirty());
 
         QCOMPARE(_mapPolygon->count(), i+1);
 
@@ -142,7 +120,7 @@ void QGCMapPolygonTest::_testVertexManipulation(void)
         QCOMPARE(polyList[i].value<QGeoCoordinate>(), _polyPoints[i]);
 
         QCOMPARE(_pathModel->count(), i+1);
-        QCOMPARE(_pathModel->value<QGCQGeoCoordinate*>(i)->coordinate(), _polyPoints[i]);
+        QCOMPARE(_vertexCoordinate(i), _polyPoints[i]);
 
         _mapPolygon->setDirty(false);
         _multiSpyPolygon->clearAllSignals();
@@ -151,23 +129,20 @@ void QGCMapPolygonTest::_testVertexManipulation(void)
 
     // Vertex adjustment testing
 
-    QGCQGeoCoordinate* geoCoord = _pathModel->value<QGCQGeoCoordinate*>(1);
-    QSignalSpy coordSpy(geoCoord, SIGNAL(coordinateChanged(QGeoCoordinate)));
-    QSignalSpy coordDirtySpy(geoCoord, SIGNAL(dirtyChanged(bool)));
+    QSignalSpy dataChangedSpy(_pathModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
     QGeoCoordinate adjustCoord(_polyPoints[1].latitude() + 1, _polyPoints[1].longitude() + 1);
     _mapPolygon->adjustVertex(1, adjustCoord);
     QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(pathChangedMask | polygonDirtyChangedMask | centerChangedMask));
-    QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelDirtyChangedMask));
-    QCOMPARE(coordSpy.count(), 1);
-    QCOMPARE(coordDirtySpy.count(), 1);
-    QCOMPARE(geoCoord->coordinate(), adjustCoord);
+    QVERIFY(_multiSpyModel->checkNoSignals());
+    QCOMPARE(dataChangedSpy.count(), 2);    // Vertex and the split handle of the previous vertex
+    QCOMPARE(_vertexCoordinate(1), adjustCoord);
     QVariantList polyList = _mapPolygon->path();
     QCOMPARE(polyList[0].value<QGeoCoordinate>(), _polyPoints[0]);
-    QCOMPARE(_pathModel->value<QGCQGeoCoordinate*>(0)->coordinate(), _polyPoints[0]);
+    QCOMPARE(_vertexCoordinate(0), _polyPoints[0]);
     QCOMPARE(polyList[2].value<QGeoCoordinate>(), _polyPoints[2]);
-    QCOMPARE(_pathModel->value<QGCQGeoCoordinate*>(2)->coordinate(), _polyPoints[2]);
+    QCOMPARE(_vertexCoordinate(2), _polyPoints[2]);
     QCOMPARE(polyList[3].value<QGeoCoordinate>(), _polyPoints[3]);
-    QCOMPARE(_pathModel->value<QGCQGeoCoordinate*>(3)->coordinate(), _polyPoints[3]);
+    QCOMPARE(_vertexCoordinate(3), _polyPoints[3]);
 
     _mapPolygon->setDirty(false);
     _multiSpyPolygon->clearAllSignals();
@@ -178,25 +153,24 @@ void QGCMapPolygonTest::_testVertexManipulation(void)
     _mapPolygon->removeVertex(1);
     // There is some double signalling on centerChanged which is not yet fixed, hence checkOnlySignals
     QVERIFY(_multiSpyPolygon->checkOnlySignalsByMask(pathChangedMask | polygonDirtyChangedMask | polygonCountChangedMask | centerChangedMask));
-    QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelDirtyChangedMask | modelCountChangedMask));
+    QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelCountChangedMask));
     QCOMPARE(_mapPolygon->count(), 3);
     polyList = _mapPolygon->path();
     QCOMPARE(polyList.count(), 3);
     QCOMPARE(_pathModel->count(), 3);
     QCOMPARE(polyList[0].value<QGeoCoordinate>(), _polyPoints[0]);
-    QCOMPARE(_pathModel->value<QGCQGeoCoordinate*>(0)->coordinate(), _polyPoints[0]);
+    QCOMPARE(_vertexCoordinate(0), _polyPoints[0]);
     QCOMPARE(polyList[1].value<QGeoCoordinate>(), _polyPoints[2]);
-    QCOMPARE(_pathModel->value<QGCQGeoCoordinate*>(1)->coordinate(), _polyPoints[2]);
+    QCOMPARE(_vertexCoordinate(1), _polyPoints[2]);
     QCOMPARE(polyList[2].value<QGeoCoordinate>(), _polyPoints[3]);
-    QCOMPARE(_pathModel->value<QGCQGeoCoordinate*>(2)->coordinate(), _polyPoints[3]);
+    QCOMPARE(_vertexCoordinate(2), _polyPoints[3]);
 
     // Clear testing
 
     _mapPolygon->clear();
     QVERIFY(_multiSpyPolygon->checkOnlySignalsByMask(pathChangedMask | polygonDirtyChangedMask | polygonCountChangedMask | centerChangedMask | clearedMask));
-    QVERIFY(_multiSpyModel->checkOnlySignalsByMask(modelDirtyChangedMask | modelCountChangedMask));
+    QVERIFY(_multiSpyModel->checkOnlySignalsByMask(modelCountChangedMask));
     QVERIFY(_mapPolygon->dirty());
-    QVERIFY(_pathModel->dirty());
     QCOMPARE(_mapPolygon->count(), 0);
     polyList = _mapPolygon->path();
     QCOMPARE(polyList.count(), 0);
@@ -206,6 +180,7 @@ void QGCMapPolygonTest::_testVertexManipulation(void)
 void QGCMapPolygonTest::_testKMLLoad(void)
 {
     QVERIFY(_mapPolygon->loadKMLFile(QStringLiteral(":/unittest/PolygonGood.kml")));
+    QCOMPARE(_mapPolygon->count(), 4);
 
     setExpectedMessageBox(QMessageBox::Ok);
     QVERIFY(!_mapPolygon->loadKMLFile(QStringLiteral(":/unittest/PolygonBadXml.kml")));
@@ -219,3 +194,110 @@ void QGCMapPolygonTest::_testKMLLoad(void)
     QVERIFY(!_mapPolygon->loadKMLFile(QStringLiteral(":/unittest/PolygonBadCoordinatesNode.kml")));
     checkExpectedMessageBox();
 }
+
+void QGCMapPolygonTest::_testVisibleRegion(void)
+{
+    // A circle of 1000 vertices
+    QList<QGeoCoordinate> circle;
+    QGeoCoordinate center(47.633, -122.089);
+    for (int i=0; i<1000; i++) {
+        circle.append(center.atDistanceAndAzimuth(1000, i * 0.36));
+    }
+    _mapPolygon->appendVertices(circle);
+    QCOMPARE(_pathModel->count(), 1000);
+
+    // Only the northern vertices are in view, plus the one whose edge runs into view
+    QGeoRectangle northRegion(QGeoCoordinate(center.latitude() + 0.1, center.longitude() - 0.1), QGeoCoordinate(center.latitude() + 0.0089, center.longitude() + 0.1));
+    _pathModel->setVisibleRegion(northRegion);
+    QVERIFY(_pathModel->count() > 0);
+    QVERIFY(_pathModel->count() < 100);
+    int visibleCount = 0;
+    for (int i=0; i<1000; i++) {
+        visibleCount += northRegion.contains(circle[i]) ? 1 : 0;
+    }
+    QCOMPARE(_pathModel->count(), visibleCount + 1);
+    for (int row=0; row<_pathModel->count(); row++) {
+        int vertexIndex = _pathModel->vertexIndex(row);
+        QCOMPARE(_pathModel->data(_pathModel->index(row), QGCMapPolygonVertexModel::vertexIndexRole).toInt(), vertexIndex);
+        QCOMPARE(_vertexCoordinate(row), circle[vertexIndex]);
+    }
+
+    // The vertex being edited keeps its handle
+    int rowCount = _pathModel->count();
+    _pathModel->setEditVertex(500);
+    QCOMPARE(_pathModel->count(), rowCount + 1);
+    _mapPolygon->adjustVertex(500, center);
+    QCOMPARE(_pathModel->count(), rowCount + 1);
+    _pathModel->setEditVertex(-1);
+    QCOMPARE(_pathModel->count(), rowCount);
+
+    // Moving a vertex into view adds its handle, and the one of the previous vertex whose edge now runs into view
+    _mapPolygon->adjustVertex(500, circle[0]);
+    QCOMPARE(_pathModel->count(), rowCount + 2);
+
+    _pathModel->setVisibleRegion(QGeoRectangle());
+    QCOMPARE(_pathModel->count(), 1000);
+}
+
+void QGCMapPolygonTest::_testVisibleEdge(void)
+{
+    _mapPolygon->appendVertices(_polyPoints);
+    QCOMPARE(_pathModel->count(), 4);
+
+    // Zoomed in on the middle of the north edge, neither of its vertices is in view but its split handle is
+    QGeoCoordinate northMiddle(_polyPoints[0].latitude(), (_polyPoints[0].longitude() + _polyPoints[1].longitude()) / 2);
+    _pathModel->setVisibleRegion(QGeoRectangle(northMiddle, 0.001, 0.001));
+    QCOMPARE(_pathModel->count(), 1);
+    QCOMPARE(_pathModel->vertexIndex(0), 0);
+
+    // Same for the closing edge from the last vertex back to the first
+    QGeoCoordinate westMiddle((_polyPoints[3].latitude() + _polyPoints[0].latitude()) / 2, _polyPoints[0].longitude());
+    _pathModel->setVisibleRegion(QGeoRectangle(westMiddle, 0.001, 0.001));
+    QCOMPARE(_pathModel->count(), 1);
+    QCOMPARE(_pathModel->vertexIndex(0), 3);
+
+    // Inside the polygon away from all edges nothing needs a handle
+    QGeoCoordinate center((_polyPoints[0].latitude() + _polyPoints[2].latitude()) / 2, northMiddle.longitude());
+    _pathModel->setVisibleRegion(QGeoRectangle(center, 0.001, 0.001));
+    QCOMPARE(_pathModel->count(), 0);
+
+    // Outside next to an edge neither
+    QGeoCoordinate north(_polyPoints[0].latitude() + 0.002, northMiddle.longitude());
+    _pathModel->setVisibleRegion(QGeoRectangle(north, 0.001, 0.001));
+    QCOMPARE(_pathModel->count(), 0);
+}
+
+void QGCMapPolygonTest::_testBatchedUpdates(void)
+{
+    QList<QGeoCoordinate> circle;
+    QGeoCoordinate center(47.633, -122.089);
+    for (int i=0; i<1000; i++) {
+        circle.append(center.atDistanceAndAzimuth(1000, i * 0.36));
+    }
+
+    // Appending many vertices is a single update
+    _mapPolygon->appendVertices(circle);
+    QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(pathChangedMask | polygonDirtyChangedMask | polygonCountChangedMask | centerChangedMask));
+    QVERIFY(_multiSpyModel->checkOnlySignalByMask(modelCountChangedMask));
+    _mapPolygon->setDirty(false);
+    _multiSpyPolygon->clearAllSignals();
+    _multiSpyModel->clearAllSignals();
+
+    // Moving the whole polygon is a single update
+    QGeoCoordinate newCenter = _mapPolygon->center().atDistanceAndAzimuth(500, 45);
+    _mapPolygon->setCenter(newCenter);
+    QVERIFY(_multiSpyPolygon->checkOnlySignalByMask(pathChangedMask | polygonDirtyChangedMask | centerChangedMask));
+    QVERIFY(_multiSpyModel->checkNoSignals());
+    QCOMPARE(_mapPolygon->center(), newCenter);
+    QCOMPARE(_mapPolygon->count(), 1000);
+    QVERIFY(_mapPolygon->vertexCoordinate(0).distanceTo(circle[0].atDistanceAndAzimuth(500, 45)) < 1.0);
+    _mapPolygon->setDirty(false);
+    _multiSpyPolygon->clearAllSignals();
+
+    // Offsetting is a single path update
+    _mapPolygon->offset(10);
+    QVERIFY(_multiSpyPolygon->checkSignalByMask(pathChangedMask | polygonDirtyChangedMask | clearedMask));
+    QVERIFY(_multiSpyPolygon->checkNoSignalByMask(polygonCountChangedMask));
+    QCOMPARE(_mapPolygon->count(), 1000);
+    QVERIFY(qAbs(_mapPolygon->vertexCoordinate(0).distanceTo(_mapPolygon->center()) - 1010) < 1);
+}
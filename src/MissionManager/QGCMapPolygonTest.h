@@ -12,7 +12,6 @@
 #include "UnitTest.h"
 #include "MultiSignalSpy.h"
 #include "QGCMapPolygon.h"
-#include "QmlObjectListModel.h"
 
 class QGCMapPolygonTest : public UnitTest
 {
@@ -29,8 +28,14 @@ private slots:
     void _testDirty(void);
     void _testVertexManipulation(void);
     void _testKMLLoad(void);
+    void _testVisibleRegion(void);
+    void _testVisibleEdge(void);
+    void _testBatchedUpdates(void);
 
 private:
+    /// @return Coordinate for the vertex model row
+    QGeoCoordinate _vertexCoordinate(int row);
+
     enum {
         polygonCountChangedIndex = 0,
         pathChangedIndex,
@@ -56,13 +61,11 @@ private:
 
     enum {
         modelCountChangedIndex = 0,
-        modelDirtyChangedIndex,
         maxModelSignalIndex
     };
 
     enum {
         modelCountChangedMask = 1 << modelCountChangedIndex,
-        modelDirtyChangedMask = 1 << modelDirtyChangedIndex,
     };
 
     static const size_t _cModelSignals = maxModelSignalIndex;
@@ -71,6 +74,6 @@ private:
     MultiSignalSpy*         _multiSpyPolygon;
     MultiSignalSpy*         _multiSpyModel;
     QGCMapPolygon*          _mapPolygon;
-    QmlObjectListModel*     _pathModel;
+    QGCMapPolygonVertexModel* _pathModel;
     QList<QGeoCoordinate>   _polyPoints;
 };
@@ -0,0 +1,205 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCMapPolygonVertexModel.h"
+#include "QGCMapPolygon.h"
+
+#include <QQmlEngine>
+
+#include <algorithm>
+
+const int QGCMapPolygonVertexModel::coordinateRole =        Qt::UserRole;
+const int QGCMapPolygonVertexModel::vertexIndexRole =       Qt::UserRole + 1;
+const int QGCMapPolygonVertexModel::splitCoordinateRole =   Qt::UserRole + 2;
+
+QGCMapPolygonVertexModel::QGCMapPolygonVertexModel(QGCMapPolygon* polygon)
+    : QAbstractListModel    (polygon)
+    , _polygon              (polygon)
+    , _editVertex           (-1)
+{
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+}
+
+int QGCMapPolygonVertexModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+
+    return _rows.count();
+}
+
+QVariant QGCMapPolygonVertexModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= _rows.count()) {
+        return QVariant();
+    }
+
+    int vertexIndex = _rows[index.row()];
+
+    if (role == coordinateRole) {
+        return QVariant::fromValue(_polygon->vertexCoordinate(vertexIndex));
+    } else if (role == vertexIndexRole) {
+        return vertexIndex;
+    } else if (role == splitCoordinateRole) {
+        QGeoCoordinate vertex = _polygon->vertexCoordinate(vertexIndex);
+        QGeoCoordinate nextVertex = _polygon->vertexCoordinate(vertexIndex == _polygon->count() - 1 ? 0 : vertexIndex + 1);
+        return QVariant::fromValue(vertex.atDistanceAndAzimuth(vertex.distanceTo(nextVertex) / 2, vertex.azimuthTo(nextVertex)));
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> QGCMapPolygonVertexModel::roleNames(void) const
+{
+    QHash<int, QByteArray> hash;
+
+    hash[coordinateRole] =      "coordinate";
+    hash[vertexIndexRole] =     "vertexIndex";
+    hash[splitCoordinateRole] = "splitCoordinate";
+
+    return hash;
+}
+
+void QGCMapPolygonVertexModel::setVisibleRegion(const QGeoRectangle& visibleRegion)
+{
+    if (_visibleRegion != visibleRegion) {
+        _visibleRegion = visibleRegion;
+        emit visibleRegionChanged();
+        verticesChanged();
+    }
+}
+
+void QGCMapPolygonVertexModel::setEditVertex(int editVertex)
+{
+    if (_editVertex != editVertex) {
+        _editVertex = editVertex;
+        emit editVertexChanged(editVertex);
+        verticesChanged();
+    }
+}
+
+/// Liang-Barsky clip of the segment (x1,y1)-(x2,y2) against the rectangle
+static bool _segmentIntersectsRect(double x1, double y1, double x2, double y2, double left, double bottom, double right, double top)
+{
+    double dx = x2 - x1;
+    double dy = y2 - y1;
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { x1 - left, right - x1, y1 - bottom, top - y1 };
+    double t0 = 0.0;
+    double t1 = 1.0;
+
+    for (int i=0; i<4; i++) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) {
+                // Parallel to and outside of this boundary
+                return false;
+            }
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) {
+                t0 = qMax(t0, t);
+            } else {
+                t1 = qMin(t1, t);
+            }
+            if (t0 > t1) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool QGCMapPolygonVertexModel::_edgeVisible(const QGeoCoordinate& from, const QGeoCoordinate& to) const
+{
+    double west =   _visibleRegion.topLeft().longitude();
+    double east =   _visibleRegion.bottomRight().longitude();
+    double south =  _visibleRegion.bottomRight().latitude();
+    double north =  _visibleRegion.topLeft().latitude();
+
+    if (west <= east) {
+        return _segmentIntersectsRect(from.longitude(), from.latitude(), to.longitude(), to.latitude(), west, south, east, north);
+    }
+
+    // The region crosses the antimeridian
+    return _segmentIntersectsRect(from.longitude(), from.latitude(), to.longitude(), to.latitude(), west, south, 180.0, north) ||
+            _segmentIntersectsRect(from.longitude(), from.latitude(), to.longitude(), to.latitude(), -180.0, south, east, north);
+}
+
+QVector<int> QGCMapPolygonVertexModel::_neededRows(void) const
+{
+    int             vertexCount = _polygon->count();
+    QVector<int>    rows;
+
+    if (!_visibleRegion.isValid()) {
+        rows.resize(vertexCount);
+        for (int i=0; i<vertexCount; i++) {
+            rows[i] = i;
+        }
+        return rows;
+    }
+
+    // A vertex gets handles if it is visible or the edge to the next vertex crosses the view, since the split
+    // handle sits halfway along that edge. The edge may cross the view with both of its vertices out of view.
+    const QVector<double>&  latitudes =     _polygon->latitudes();
+    const QVector<double>&  longitudes =    _polygon->longitudes();
+    for (int i=0; i<vertexCount; i++) {
+        int             next =      i == vertexCount - 1 ? 0 : i + 1;
+        QGeoCoordinate  vertex      (latitudes[i], longitudes[i]);
+        QGeoCoordinate  nextVertex  (latitudes[next], longitudes[next]);
+
+        if (i == _editVertex || _visibleRegion.contains(vertex) || _edgeVisible(vertex, nextVertex)) {
+            rows.append(i);
+        }
+    }
+
+    return rows;
+}
+
+void QGCMapPolygonVertexModel::verticesChanged(void)
+{
+    QVector<int> rows = _neededRows();
+
+    if (rows == _rows) {
+        if (_rows.count()) {
+            emit dataChanged(index(0), index(_rows.count() - 1));
+        }
+        return;
+    }
+
+    int oldCount = _rows.count();
+    beginResetModel();
+    _rows = rows;
+    endResetModel();
+    if (oldCount != _rows.count()) {
+        emit countChanged(_rows.count());
+    }
+}
+
+void QGCMapPolygonVertexModel::vertexChanged(int vertexIndex)
+{
+    if (_visibleRegion.isValid() && vertexIndex != _editVertex) {
+        // The vertex may have moved in or out of view
+        verticesChanged();
+        return;
+    }
+
+    // The split handle of the previous vertex moves as well
+    _vertexDataChanged(vertexIndex);
+    _vertexDataChanged(vertexIndex == 0 ? _polygon->count() - 1 : vertexIndex - 1);
+}
+
+void QGCMapPolygonVertexModel::_vertexDataChanged(int vertexIndex)
+{
+    QVector<int>::const_iterator row = std::lower_bound(_rows.constBegin(), _rows.constEnd(), vertexIndex);
+
+    if (row != _rows.constEnd() && *row == vertexIndex) {
+        QModelIndex modelIndex = index(row - _rows.constBegin());
+        emit dataChanged(modelIndex, modelIndex);
+    }
+}
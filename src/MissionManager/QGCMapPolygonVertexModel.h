@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QGeoRectangle>
+#include <QVector>
+
+class QGCMapPolygon;
+
+/// Provides the vertices of a QGCMapPolygon to the QML drag and split handles.
+///
+/// The polygon keeps its vertices in packed arrays, rows only exist for the vertices which need handles: those
+/// within the visible region (plus the ones starting an edge which crosses it) and the vertex being edited. With no visible
+/// region set every vertex is a row. Roles are coordinate, vertexIndex (index within the polygon) and
+/// splitCoordinate (midpoint of the edge to the next vertex).
+class QGCMapPolygonVertexModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    QGCMapPolygonVertexModel(QGCMapPolygon* polygon);
+
+    Q_PROPERTY(int              count           READ count                                  NOTIFY countChanged)
+    Q_PROPERTY(QGeoRectangle    visibleRegion   READ visibleRegion  WRITE setVisibleRegion  NOTIFY visibleRegionChanged)
+    Q_PROPERTY(int              editVertex      READ editVertex     WRITE setEditVertex     NOTIFY editVertexChanged)   ///< Vertex being dragged, -1 for none
+
+    int             count           (void) const { return _rows.count(); }
+    QGeoRectangle   visibleRegion   (void) const { return _visibleRegion; }
+    int             editVertex      (void) const { return _editVertex; }
+
+    void setVisibleRegion   (const QGeoRectangle& visibleRegion);
+    void setEditVertex      (int editVertex);
+
+    /// @return Polygon vertex index for the row
+    int vertexIndex(int row) const { return _rows[row]; }
+
+    /// Called by the polygon when a single vertex moved
+    void vertexChanged(int vertexIndex);
+
+    /// Called by the polygon when vertices were added, removed or all moved
+    void verticesChanged(void);
+
+    // Overrides from QAbstractListModel
+    int	rowCount(const QModelIndex & parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames(void) const override;
+
+    static const int coordinateRole;
+    static const int vertexIndexRole;
+    static const int splitCoordinateRole;
+
+signals:
+    void countChanged           (int count);
+    void visibleRegionChanged   (void);
+    void editVertexChanged      (int editVertex);
+
+private:
+    QVector<int>    _neededRows     (void) const;
+    bool            _edgeVisible    (const QGeoCoordinate& from, const QGeoCoordinate& to) const;
+    void            _vertexDataChanged(int vertexIndex);
+
+    QGCMapPolygon*  _polygon;
+    QVector<int>    _rows;              ///< Polygon vertex index of each row, ascending
+    QGeoRectangle   _visibleRegion;
+    int             _editVertex;
+};
@@ -61,6 +61,15 @@ Item {
         }
     }
 
+    /// Only vertices on screen get drag and split handles
+    function updateHandleRegion() {
+        var topLeft =       mapControl.toCoordinate(Qt.point(0, 0), false /* clipToViewPort */)
+        var bottomRight =   mapControl.toCoordinate(Qt.point(mapControl.width, mapControl.height), false /* clipToViewPort */)
+        if (topLeft.isValid && bottomRight.isValid) {
+            mapPolygon.pathModel.visibleRegion = QtPositioning.rectangle(topLeft, bottomRight)
+        }
+    }
+
     function removeHandles() {
         if (_dragHandlesComponent) {
             _dragHandlesComponent.destroy()
@@ -148,8 +157,24 @@ Item {
         setCircleRadius(center, radius)
     }
 
+    // Panning and zooming fire often, the handle region only needs to catch up once the map settles
+    Timer {
+        id:             handleRegionTimer
+        interval:       100
+        onTriggered:    updateHandleRegion()
+    }
+
+    Connections {
+        target:                 interactive ? mapControl : null
+        onCenterChanged:        handleRegionTimer.restart()
+        onZoomLevelChanged:     handleRegionTimer.restart()
+        onWidthChanged:         handleRegionTimer.restart()
+        onHeightChanged:        handleRegionTimer.restart()
+    }
+
     onInteractiveChanged: {
         if (interactive) {
+            updateHandleRegion()
             addHandles()
         } else {
             removeHandles()
@@ -159,6 +184,7 @@ Item {
     Component.onCompleted: {
         addVisuals()
         if (interactive) {
+            updateHandleRegion()
             addHandles()
         }
     }
@@ -176,8 +202,9 @@ Item {
         folder:         QGroundControl.settingsManager.appSettings.missionSavePath
         title:          qsTr("Select KML File")
         selectExisting: true
-        nameFilters:    [ qsTr("KML files (*.kml)") ]
+        nameFilters:    [ qsTr("KML files (*.kml *.kmz)") ]
         fileExtension:  QGroundControl.settingsManager.appSettings.kmlFileExtension
+        fileExtension2: QGroundControl.settingsManager.appSettings.kmzFileExtension
 
         onAcceptedForLoad: {
             mapPolygon.loadKMLFile(file)
@@ -290,26 +317,15 @@ Item {
         id: splitHandlesComponent
 
         Repeater {
-            model: mapPolygon.path
+            model: mapPolygon.pathModel
 
             delegate: Item {
                 property var _splitHandle
-                property var _vertices:     mapPolygon.path
-
-                function _setHandlePosition() {
-                    var nextIndex = index + 1
-                    if (nextIndex > _vertices.length - 1) {
-                        nextIndex = 0
-                    }
-                    var distance = _vertices[index].distanceTo(_vertices[nextIndex])
-                    var azimuth = _vertices[index].azimuthTo(_vertices[nextIndex])
-                    _splitHandle.coordinate = _vertices[index].atDistanceAndAzimuth(distance / 2, azimuth)
-                }
 
                 Component.onCompleted: {
                     _splitHandle = splitHandleComponent.createObject(mapControl)
-                    _splitHandle.vertexIndex = index
-                    _setHandlePosition()
+                    _splitHandle.vertexIndex = Qt.binding(function() { return model.vertexIndex })
+                    _splitHandle.coordinate = Qt.binding(function() { return model.splitCoordinate })
                     mapControl.addMapItem(_splitHandle)
                 }
 
@@ -338,6 +354,9 @@ Item {
 
             Component.onCompleted: _creationComplete = true
 
+            onDragStart:    mapPolygon.pathModel.editVertex = polygonVertex
+            onDragStop:     mapPolygon.pathModel.editVertex = -1
+
             onItemCoordinateChanged: {
                 if (_creationComplete) {
                     // During component creation some bad coordinate values got through which screws up draw
@@ -404,7 +423,7 @@ Item {
         }
     }
 
-    // Add all polygon vertex drag handles to the map
+    // Add the vertex drag handles which are in view to the map
     Component {
         id: dragHandlesComponent
 
@@ -416,11 +435,11 @@ Item {
 
                 Component.onCompleted: {
                     var dragHandle = dragHandleComponent.createObject(mapControl)
-                    dragHandle.coordinate = Qt.binding(function() { return object.coordinate })
-                    dragHandle.polygonVertex = Qt.binding(function() { return index })
+                    dragHandle.coordinate = Qt.binding(function() { return model.coordinate })
+                    dragHandle.polygonVertex = Qt.binding(function() { return model.vertexIndex })
                     mapControl.addMapItem(dragHandle)
-                    var dragArea = dragAreaComponent.createObject(mapControl, { "itemIndicator": dragHandle, "itemCoordinate": object.coordinate })
-                    dragArea.polygonVertex = Qt.binding(function() { return index })
+                    var dragArea = dragAreaComponent.createObject(mapControl, { "itemIndicator": dragHandle, "itemCoordinate": model.coordinate })
+                    dragArea.polygonVertex = Qt.binding(function() { return model.vertexIndex })
                     _visuals.push(dragHandle)
                     _visuals.push(dragArea)
                 }
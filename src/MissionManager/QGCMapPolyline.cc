@@ -13,6 +13,7 @@
 #include "QGCQGeoCoordinate.h"
 #include "QGCApplication.h"
 #include "KMLFileHelper.h"
+#include "SettingsManager.h"
 
 #include <QGeoRectangle>
 #include <QDebug>
@@ -341,7 +342,7 @@ bool QGCMapPolyline::loadKMLFile(const QString& kmlFile)
 {
     QString errorString;
     QList<QGeoCoordinate> rgCoords;
-    if (!KMLFileHelper::loadPolylineFromFile(kmlFile, rgCoords, errorString)) {
+    if (!KMLFileHelper::loadPolylineFromFile(kmlFile, rgCoords, errorString, qgcApp()->toolbox()->settingsManager()->appSettings()->kmlImportSimplifyTolerance()->rawValue().toDouble())) {
         qgcApp()->showMessage(errorString);
         return false;
     }
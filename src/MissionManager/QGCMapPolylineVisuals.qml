@@ -118,7 +118,9 @@ Item {
         folder:         QGroundControl.settingsManager.appSettings.missionSavePath
         title:          qsTr("Select KML File")
         selectExisting: true
-        nameFilters:    [ qsTr("KML files (*.kml)") ]
+        nameFilters:    [ qsTr("KML files (*.kml *.kmz)") ]
+        fileExtension:  QGroundControl.settingsManager.appSettings.kmlFileExtension
+        fileExtension2: QGroundControl.settingsManager.appSettings.kmzFileExtension
 
         onAcceptedForLoad: {
             mapPolyline.loadKMLFile(file)
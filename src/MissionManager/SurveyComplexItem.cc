@@ -13,7 +13,6 @@
 #include "MissionController.h"
 #include "QGCGeo.h"
 #include "QGroundControlQmlGlobal.h"
-#include "QGCQGeoCoordinate.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
 
@@ -1092,19 +1091,16 @@ void SurveyComplexItem::_rebuildTransectsPhase1Worker(bool refly)
     // Convert polygon to NED
 
     QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
+    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.vertexCoordinate(0);
     qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
-        double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
-        if (i == 0) {
-            // This avoids a nan calculation that comes out of convertGeoToNed
-            x = y = 0;
-        } else {
-            convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
-        }
-        polygonPoints += QPointF(x, y);
-        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
+    int vertexCount = _surveyAreaPolygon.count();
+    const QVector<double>& vertexLat = _surveyAreaPolygon.latitudes();
+    const QVector<double>& vertexLon = _surveyAreaPolygon.longitudes();
+    QVector<double> vertexNorth(vertexCount), vertexEast(vertexCount);
+    convertGeoToNed(vertexLat.constData(), vertexLon.constData(), NULL, vertexCount, tangentOrigin, vertexNorth.data(), vertexEast.data(), NULL);
+    for (int i=0; i<vertexCount; i++) {
+        polygonPoints += QPointF(vertexEast[i], vertexNorth[i]);
+        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << QGeoCoordinate(vertexLat[i], vertexLon[i]) << polygonPoints.last().x() << polygonPoints.last().y();
     }
 
     // Generate transects
@@ -1182,14 +1178,20 @@ void SurveyComplexItem::_rebuildTransectsPhase1Worker(bool refly)
 
     // Convert from NED to Geo
     QList<QList<QGeoCoordinate>> transects;
-    foreach (const QLineF& line, resultLines) {
-        QGeoCoordinate          coord;
-        QList<QGeoCoordinate>   transect;
-
-        convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-        convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
+    int pointCount = resultLines.count() * 2;
+    QVector<double> north(pointCount), east(pointCount), lat(pointCount), lon(pointCount);
+    for (int i=0; i<resultLines.count(); i++) {
+        north[i * 2] =      resultLines[i].p1().y();
+        east[i * 2] =       resultLines[i].p1().x();
+        north[i * 2 + 1] =  resultLines[i].p2().y();
+        east[i * 2 + 1] =   resultLines[i].p2().x();
+    }
+    convertNedToGeo(north.constData(), east.constData(), NULL, pointCount, tangentOrigin, lat.data(), lon.data(), NULL);
+    for (int i=0; i<pointCount; i+=2) {
+        QList<QGeoCoordinate> transect;
+
+        transect.append(QGeoCoordinate(lat[i], lon[i], tangentOrigin.altitude()));
+        transect.append(QGeoCoordinate(lat[i + 1], lon[i + 1], tangentOrigin.altitude()));
 
         transects.append(transect);
     }
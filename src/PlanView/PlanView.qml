@@ -215,9 +215,9 @@ QGCView {
             fileDialog.title =          qsTr("Load KML")
             fileDialog.planFiles =      false
             fileDialog.selectExisting = true
-            fileDialog.nameFilters =    masterController.fileKmlFilters
+            fileDialog.nameFilters =    masterController.loadKmlFilters
             fileDialog.fileExtension =  QGroundControl.settingsManager.appSettings.kmlFileExtension
-            fileDialog.fileExtension2 = ""
+            fileDialog.fileExtension2 = QGroundControl.settingsManager.appSettings.kmzFileExtension
             fileDialog.openForLoad()
         }
 
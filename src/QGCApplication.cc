@@ -114,6 +114,12 @@
 #endif
 
 #include "QGCMapEngine.h"
+#include "QGCStartupTracer.h"
+#include "VehicleStateServer.h"
+
+#ifdef QT_DEBUG
+#include "MockLinkSwarmBenchmark.h"
+#endif
 
 QGCApplication* QGCApplication::_app = NULL;
 
@@ -148,7 +154,7 @@ static QObject* kmlFileHelperSingletonFactory(QQmlEngine*, QJSEngine*)
     return new KMLFileHelper;
 }
 
-QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
+QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting, bool headless)
 #ifdef __mobile__
     : QGuiApplication           (argc, argv)
     , _qmlAppEngine             (nullptr)
@@ -156,15 +162,20 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     : QApplication              (argc, argv)
 #endif
     , _runningUnitTests         (unitTesting)
+    , _headless                 (headless)
     , _logOutput                (false)
     , _fakeMobile               (false)
     , _settingsUpgraded         (false)
+    , _startupBenchmark         (false)
     , _majorVersion             (0)
     , _minorVersion             (0)
     , _buildVersion             (0)
     , _currentVersionDownload   (nullptr)
+    , _vehicleStateServer       (nullptr)
+    , _vehicleStateServerPort   (VehicleStateServer::defaultPort)
 #ifdef QT_DEBUG
     , _testHighDPI              (false)
+    , _swarmBenchmark           (false)
 #endif
     , _toolbox                  (nullptr)
     , _bluetoothAvailable       (false)
@@ -181,7 +192,7 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
 
 #ifdef Q_OS_LINUX
 #ifndef __mobile__
-    if (!_runningUnitTests) {
+    if (!_runningUnitTests && !_headless) {
         if (getuid() == 0) {
             QMessageBox msgBox;
             msgBox.setInformativeText(tr("You are running %1 as root. "
@@ -225,20 +236,35 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     bool fClearSettingsOptions = false; // Clear stored settings
     bool logging = false;               // Turn on logging
     QString loggingOptions;
+    bool apiPort = false;               // Vehicle state server port for headless mode
+    QString apiPortOption;
 
     CmdLineOpt_t rgCmdLineOptions[] = {
         { "--clear-settings",   &fClearSettingsOptions, NULL },
         { "--logging",          &logging,               &loggingOptions },
         { "--fake-mobile",      &_fakeMobile,           NULL },
         { "--log-output",       &_logOutput,            NULL },
+        { "--startup-benchmark",&_startupBenchmark,     NULL },
+        { "--api-port",         &apiPort,               &apiPortOption },
     #ifdef QT_DEBUG
         { "--test-high-dpi",    &_testHighDPI,          NULL },
+        { "--swarm-benchmark",  &_swarmBenchmark,       &_swarmBenchmarkOptions },
     #endif
         // Add additional command line option flags here
     };
 
     ParseCmdLineOptions(argc, argv, rgCmdLineOptions, sizeof(rgCmdLineOptions)/sizeof(rgCmdLineOptions[0]), false);
 
+    if (apiPort) {
+        bool ok = false;
+        int port = apiPortOption.toInt(&ok);
+        if (ok && port > 0 && port < 65536) {
+            _vehicleStateServerPort = port;
+        } else {
+            qWarning() << "Invalid --api-port, using" << _vehicleStateServerPort;
+        }
+    }
+
     // Set up timer for delayed missing fact display
     _missingParamsDelayedDisplayTimer.setSingleShot(true);
     _missingParamsDelayedDisplayTimer.setInterval(_missingParamsDelayedDisplayTimerTimeout);
@@ -324,10 +350,19 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     }
 
     // Initialize Video Streaming
-    initializeVideoStreaming(argc, argv, savePath.toUtf8().data(), gstDebugLevel.toUtf8().data());
+    if (!_headless) {
+        QGCStartupTracer::Scope trace("initializeVideoStreaming");
+        initializeVideoStreaming(argc, argv, savePath.toUtf8().data(), gstDebugLevel.toUtf8().data());
+    }
 
-    _toolbox = new QGCToolbox(this);
-    _toolbox->setChildToolboxes();
+    {
+        QGCStartupTracer::Scope trace("QGCToolbox()");
+        _toolbox = new QGCToolbox(this);
+    }
+    {
+        QGCStartupTracer::Scope trace("QGCToolbox::setChildToolboxes");
+        _toolbox->setChildToolboxes();
+    }
 
     _checkForNewVersion();
 }
@@ -344,7 +379,11 @@ void QGCApplication::_shutdown(void)
         delete mainWindow;
     }
 #endif
-    shutdownVideoStreaming();
+    delete _vehicleStateServer;
+    _vehicleStateServer = nullptr;
+    if (!_headless) {
+        shutdownVideoStreaming();
+    }
     delete _toolbox;
 }
 
@@ -356,6 +395,7 @@ QGCApplication::~QGCApplication()
 
 void QGCApplication::_initCommon(void)
 {
+    QGCStartupTracer::Scope trace("Qml type registration");
     QSettings settings;
 
     // Register our Qml objects
@@ -381,6 +421,7 @@ void QGCApplication::_initCommon(void)
     qmlRegisterUncreatableType<Joystick>            ("QGroundControl.JoystickManager",      1, 0, "Joystick",               "Reference only");
     qmlRegisterUncreatableType<QGCPositionManager>  ("QGroundControl.QGCPositionManager",   1, 0, "QGCPositionManager",     "Reference only");
     qmlRegisterUncreatableType<QGCMapPolygon>       ("QGroundControl.FlightMap",            1, 0, "QGCMapPolygon",          "Reference only");
+    qmlRegisterUncreatableType<QGCMapPolygonVertexModel>("QGroundControl.FlightMap",        1, 0, "QGCMapPolygonVertexModel","Reference only");
     qmlRegisterUncreatableType<MissionController>   ("QGroundControl.Controllers",          1, 0, "MissionController",      "Reference only");
     qmlRegisterUncreatableType<GeoFenceController>  ("QGroundControl.Controllers",          1, 0, "GeoFenceController",     "Reference only");
     qmlRegisterUncreatableType<RallyPointController>("QGroundControl.Controllers",          1, 0, "RallyPointController",   "Reference only");
@@ -423,10 +464,17 @@ bool QGCApplication::_initForNormalAppBoot(void)
     connect(this, &QGCApplication::lastWindowClosed, this, QGCApplication::quit);
 
 #ifdef __mobile__
-    _qmlAppEngine = toolbox()->corePlugin()->createRootWindow(this);
+    {
+        QGCStartupTracer::Scope trace("Qml root window load");
+        _qmlAppEngine = toolbox()->corePlugin()->createRootWindow(this);
+    }
 #else
     // Start the user interface
-    MainWindow* mainWindow = MainWindow::_create();
+    MainWindow* mainWindow = NULL;
+    {
+        QGCStartupTracer::Scope trace("MainWindow load");
+        mainWindow = MainWindow::_create();
+    }
     Q_CHECK_PTR(mainWindow);
 #endif
 
@@ -435,10 +483,10 @@ bool QGCApplication::_initForNormalAppBoot(void)
     emit checkForLostLogFiles();
 
     // Load known link configurations
-    toolbox()->linkManager()->loadLinkConfigurationList();
-
-    // Probe for joysticks
-    toolbox()->joystickManager()->init();
+    {
+        QGCStartupTracer::Scope trace("LinkManager::loadLinkConfigurationList");
+        toolbox()->linkManager()->loadLinkConfigurationList();
+    }
 
     if (_settingsUpgraded) {
         showMessage(tr("The format for QGroundControl saved settings has been modified. "
@@ -446,7 +494,10 @@ bool QGCApplication::_initForNormalAppBoot(void)
     }
 
     // Connect links with flag AutoconnectLink
-    toolbox()->linkManager()->startAutoConnectedLinks();
+    {
+        QGCStartupTracer::Scope trace("LinkManager::startAutoConnectedLinks");
+        toolbox()->linkManager()->startAutoConnectedLinks();
+    }
 
     if (getQGCMapEngine()->wasCacheReset()) {
         showMessage(tr("The Offline Map Cache database has been upgraded. "
@@ -454,9 +505,65 @@ bool QGCApplication::_initForNormalAppBoot(void)
     }
 
     settings.sync();
+
+    // Runs once the event loop is up and the user interface has been shown
+    QTimer::singleShot(0, this, &QGCApplication::_startupComplete);
+
+    return true;
+}
+
+bool QGCApplication::_initForHeadless(void)
+{
+    connect(this, &QGCApplication::checkForLostLogFiles, toolbox()->mavlinkProtocol(), &MAVLinkProtocol::checkForLostLogFiles);
+    emit checkForLostLogFiles();
+
+    toolbox()->linkManager()->loadLinkConfigurationList();
+    if (_settingsUpgraded) {
+        showMessage(tr("The format for QGroundControl saved settings has been modified. "
+                    "Your saved settings have been reset to defaults."));
+    }
+
+    _vehicleStateServer = new VehicleStateServer(toolbox()->multiVehicleManager());
+    if (!_vehicleStateServer->listen(_vehicleStateServerPort)) {
+        qWarning() << "Unable to start vehicle state server on port" << _vehicleStateServerPort << _vehicleStateServer->errorString();
+        return false;
+    }
+    qDebug() << "Running headless, vehicle state server listening on port" << _vehicleStateServerPort;
+
+    toolbox()->linkManager()->startAutoConnectedLinks();
+
+    QTimer::singleShot(0, this, &QGCApplication::_startupComplete);
+
     return true;
 }
 
+/// Called once the user interface is up. Tools which aren't needed to show the user interface are started from here.
+void QGCApplication::_startupComplete(void)
+{
+    QGCStartupTracer::mark("event loop running");
+    qint64 startupMsecs = QGCStartupTracer::finish();
+
+    if (_startupBenchmark) {
+        qDebug() << "Startup time (msecs):" << startupMsecs;
+        quit();
+        return;
+    }
+
+    if (!_headless) {
+        // Probing for joysticks and video devices can take a while
+        toolbox()->joystickManager()->init();
+        toolbox()->videoManager()->init();
+    }
+
+#ifdef QT_DEBUG
+    if (_swarmBenchmark) {
+        MockLinkSwarmBenchmark* swarmBenchmark = new MockLinkSwarmBenchmark(_swarmBenchmarkOptions, this);
+        connect(swarmBenchmark, &MockLinkSwarmBenchmark::finished, this, &QGCApplication::quit);
+        swarmBenchmark->start();
+    }
+#endif
+}
+
 bool QGCApplication::_initForUnitTests(void)
 {
     return true;
@@ -488,6 +595,10 @@ void QGCApplication::informationMessageBoxOnMainThread(const QString& title, con
 
 void QGCApplication::warningMessageBoxOnMainThread(const QString& title, const QString& msg)
 {
+    if (_headless) {
+        qWarning() << title << msg;
+        return;
+    }
 #ifdef __mobile__
     Q_UNUSED(title)
     showMessage(msg);
@@ -498,6 +609,10 @@ void QGCApplication::warningMessageBoxOnMainThread(const QString& title, const Q
 
 void QGCApplication::criticalMessageBoxOnMainThread(const QString& title, const QString& msg)
 {
+    if (_headless) {
+        qCritical() << title << msg;
+        return;
+    }
 #ifdef __mobile__
     Q_UNUSED(title)
     showMessage(msg);
@@ -529,11 +644,7 @@ void QGCApplication::saveTelemetryLogOnMainThread(QString tempLogfile)
         QFile tempFile(tempLogfile);
         if (!tempFile.copy(saveFilePath)) {
             QString error = tr("Unable to save telemetry log. Error copying telemetry to '%1': '%2'.").arg(saveFilePath).arg(tempFile.errorString());
-#ifndef __mobile__
-            QGCMessageBox::warning(tr("Telemetry Save Error"), error);
-#else
-            showMessage(error);
-#endif
+            warningMessageBoxOnMainThread(tr("Telemetry Save Error"), error);
         }
     }
     QFile::remove(tempLogfile);
@@ -549,6 +660,11 @@ bool QGCApplication::_checkTelemetrySavePath(bool useMessageBox)
 {
     QString errorTitle = tr("Telemetry save error");
 
+    if (_headless) {
+        // There is no one to hold shutdown for
+        useMessageBox = false;
+    }
+
     QString saveDirPath = _toolbox->settingsManager()->appSettings()->telemetrySavePath();
     if (saveDirPath.isEmpty()) {
         QString error = tr("Unable to save telemetry log. Application save directory is not set.");
@@ -651,8 +767,8 @@ QObject* QGCApplication::_rootQmlObject()
     MainWindow * mainWindow = MainWindow::instance();
     if (mainWindow) {
         return mainWindow->rootQmlObject();
-    } else if (runningUnitTests()){
-        // Unit test can run without a main window
+    } else if (runningUnitTests() || _headless) {
+        // Unit test and headless mode run without a main window
         return NULL;
     } else {
         qWarning() << "Why is MainWindow missing?";
@@ -681,6 +797,8 @@ void QGCApplication::showMessage(const QString& message)
         // Unit test can run without a main window which will lead to no root qml object. Use QGCMessageBox instead
         QGCMessageBox::information("Unit Test", message);
 #endif
+    } else if (_headless) {
+        qWarning() << message;
     } else {
         qWarning() << "Internal error";
     }
@@ -704,7 +822,7 @@ bool QGCApplication::isInternetAvailable()
 void QGCApplication::_checkForNewVersion(void)
 {
 #ifndef __mobile__
-    if (!_runningUnitTests) {
+    if (!_runningUnitTests && !_headless) {
         if (_parseVersionText(applicationVersion(), _majorVersion, _minorVersion, _buildVersion)) {
             QString versionCheckFile = toolbox()->corePlugin()->stableVersionCheckFileUrl();
             if (!versionCheckFile.isEmpty()) {
@@ -43,6 +43,7 @@ class QGCSingleton;
 class MainWindow;
 class QGCToolbox;
 class QGCFileDownload;
+class VehicleStateServer;
 
 /**
  * @brief The main application and management class.
@@ -61,7 +62,7 @@ class QGCApplication : public
     Q_OBJECT
 
 public:
-    QGCApplication(int &argc, char* argv[], bool unitTesting);
+    QGCApplication(int &argc, char* argv[], bool unitTesting, bool headless = false);
     ~QGCApplication();
 
     /// @brief Sets the persistent flag to delete all settings the next time QGroundControl is started.
@@ -73,6 +74,9 @@ public:
     /// @brief Returns true if unit tests are being run
     bool runningUnitTests(void) { return _runningUnitTests; }
 
+    /// @brief Returns true if running without a user interface. There is no map or video support and messages go to the log.
+    bool headless(void) { return _headless; }
+
     /// @brief Returns true if Qt debug output should be logged to a file
     bool logOutput(void) { return _logOutput; }
 
@@ -135,6 +139,10 @@ public:
     ///         unit tests. Although public should only be called by main.
     bool _initForNormalAppBoot(void);
 
+    /// @brief Initialize the application for running headless. Vehicle state is served through VehicleStateServer
+    ///         instead of the user interface. Although public should only be called by main.
+    bool _initForHeadless(void);
+
     /// @brief Initialize the application for normal application boot. Or in other words we are not going to run
     ///         unit tests. Although public should only be called by main.
     bool _initForUnitTests(void);
@@ -156,6 +164,7 @@ private slots:
     void _currentVersionDownloadFinished(QString remoteFile, QString localFile);
     void _currentVersionDownloadError(QString errorMsg);
     bool _parseVersionText(const QString& versionString, int& majorVersion, int& minorVersion, int& buildVersion);
+    void _startupComplete(void);
 
 private:
     QObject* _rootQmlObject(void);
@@ -166,6 +175,7 @@ private:
 #endif
 
     bool _runningUnitTests; ///< true: running unit tests, false: normal app
+    bool _headless;         ///< true: running without a user interface
     bool _logOutput;        ///< true: Log Qt debug output to file
 
     static const char*  _darkStyleFile;
@@ -175,13 +185,18 @@ private:
     QStringList         _missingParams;                                     ///< List of missing facts to be displayed
     bool				_fakeMobile;                                        ///< true: Fake ui into displaying mobile interface
     bool                _settingsUpgraded;                                  ///< true: Settings format has been upgrade to new version
+    bool                _startupBenchmark;                                  ///< true: Exit as soon as startup is complete, reporting the startup time
     int                 _majorVersion;
     int                 _minorVersion;
     int                 _buildVersion;
     QGCFileDownload*    _currentVersionDownload;
+    VehicleStateServer* _vehicleStateServer;                                ///< Only created when running headless
+    int                 _vehicleStateServerPort;
 
 #ifdef QT_DEBUG
-    bool _testHighDPI;  ///< true: double fonts sizes for simulating high dpi devices
+    bool    _testHighDPI;           ///< true: double fonts sizes for simulating high dpi devices
+    bool    _swarmBenchmark;        ///< true: Run the MockLink swarm benchmark once startup is complete and exit
+    QString _swarmBenchmarkOptions; ///< Options for the swarm benchmark, see MockLinkSwarmBenchmark
 #endif
 
     QGCToolbox* _toolbox;
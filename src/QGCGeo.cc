@@ -36,69 +36,235 @@ void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, dou
         return;
     }
 
-    double lat_rad = coord.latitude() * M_DEG_TO_RAD;
-    double lon_rad = coord.longitude() * M_DEG_TO_RAD;
+    double lat = coord.latitude();
+    double lon = coord.longitude();
+    double alt = coord.altitude();
 
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
-
-    double sin_lat = sin(lat_rad);
-    double cos_lat = cos(lat_rad);
-    double cos_d_lon = cos(lon_rad - ref_lon_rad);
-
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
+    convertGeoToNed(&lat, &lon, &alt, 1, origin, x, y, z);
+}
 
-    double c = acos(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon);
-    double k = (fabs(c) < epsilon) ? 1.0 : (c / sin(c));
+void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord) {
+    double lat, lon, alt;
 
-    *x = k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
-    *y = k * cos_lat * sin(lon_rad - ref_lon_rad) * CONSTANTS_RADIUS_OF_EARTH;
+    convertNedToGeo(&x, &y, &z, 1, origin, &lat, &lon, &alt);
 
-    *z = -(coord.altitude() - origin.altitude());
+    coord->setLatitude(lat);
+    coord->setLongitude(lon);
+    coord->setAltitude(alt);
 }
 
-void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord) {
-    double x_rad = x / CONSTANTS_RADIUS_OF_EARTH;
-    double y_rad = y / CONSTANTS_RADIUS_OF_EARTH;
-    double c = sqrtf(x_rad * x_rad + y_rad * y_rad);
-    double sin_c = sin(c);
-    double cos_c = cos(c);
+void convertGeoToNed(const double* lat, const double* lon, const double* alt, int count, const QGeoCoordinate& origin, double* x, double* y, double* z)
+{
+    const double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
+    const double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
+    const double ref_sin_lat = sin(ref_lat_rad);
+    const double ref_cos_lat = cos(ref_lat_rad);
 
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
+    for (int i=0; i<count; i++) {
+        double lat_rad = lat[i] * M_DEG_TO_RAD;
+        double d_lon_rad = lon[i] * M_DEG_TO_RAD - ref_lon_rad;
 
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
+        double sin_lat = sin(lat_rad);
+        double cos_lat = cos(lat_rad);
+        double cos_d_lon = cos(d_lon_rad);
 
-    double lat_rad;
-    double lon_rad;
+        // Rounding can push the cosine a hair past 1 for points on top of the origin, which makes acos return NaN
+        double c = acos(qMin(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon, 1.0));
+        double k = (fabs(c) < epsilon) ? 1.0 : (c / sin(c));
 
-    if (fabs(c) > epsilon) {
-        lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
-        lon_rad = (ref_lon_rad + atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
+        x[i] = k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
+        y[i] = k * cos_lat * sin(d_lon_rad) * CONSTANTS_RADIUS_OF_EARTH;
+    }
 
-    } else {
-        lat_rad = ref_lat_rad;
-        lon_rad = ref_lon_rad;
+    if (z) {
+        const double ref_alt = origin.altitude();
+        for (int i=0; i<count; i++) {
+            z[i] = -(alt[i] - ref_alt);
+        }
     }
+}
+
+void convertNedToGeo(const double* x, const double* y, const double* z, int count, const QGeoCoordinate& origin, double* lat, double* lon, double* alt)
+{
+    const double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
+    const double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
+    const double ref_sin_lat = sin(ref_lat_rad);
+    const double ref_cos_lat = cos(ref_lat_rad);
+
+    for (int i=0; i<count; i++) {
+        double x_rad = x[i] / CONSTANTS_RADIUS_OF_EARTH;
+        double y_rad = y[i] / CONSTANTS_RADIUS_OF_EARTH;
+        double c = sqrt(x_rad * x_rad + y_rad * y_rad);
+        double sin_c = sin(c);
+        double cos_c = cos(c);
 
-    coord->setLatitude(lat_rad * M_RAD_TO_DEG);
-    coord->setLongitude(lon_rad * M_RAD_TO_DEG);
+        // sin(c)/c goes to 1 at the origin, using it in both terms keeps the loop free of special cases
+        double sinc = (c > epsilon) ? (sin_c / c) : 1.0;
 
-    coord->setAltitude(-z + origin.altitude());
+        lat[i] = asin(cos_c * ref_sin_lat + x_rad * sinc * ref_cos_lat) * M_RAD_TO_DEG;
+        lon[i] = (ref_lon_rad + atan2(y_rad * sinc, ref_cos_lat * cos_c - x_rad * ref_sin_lat * sinc)) * M_RAD_TO_DEG;
+    }
+
+    if (alt) {
+        const double ref_alt = origin.altitude();
+        for (int i=0; i<count; i++) {
+            alt[i] = -z[i] + ref_alt;
+        }
+    }
 }
 
 int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northing)
 {
-    return LatLonToUTMXY(coord.latitude(), coord.longitude(), -1 /* zone */, easting, northing);
+    double lat = coord.latitude();
+    double lon = coord.longitude();
+
+    // Zone from the longitude, same as LatLonToUTMXY
+    int zone = static_cast<int>(floor((lon + 180.0) / 6)) + 1;
+
+    convertGeoToUTM(&lat, &lon, 1, zone, &easting, &northing);
+
+    return zone;
 }
 
 void convertUTMToGeo(double easting, double northing, int zone, bool southhemi, QGeoCoordinate& coord)
 {
-    double latRadians, lonRadians;
+    double lat, lon;
+
+    convertUTMToGeo(&easting, &northing, 1, zone, southhemi, &lat, &lon);
+
+    coord.setLatitude(lat);
+    coord.setLongitude(lon);
+}
+
+namespace {
+
+/// Transverse Mercator series coefficients for the WGS84 ellipsoid (see UTM.cpp), calculated once
+struct UTMCoefficients_t {
+    UTMCoefficients_t(void)
+    {
+        double n = (sm_a - sm_b) / (sm_a + sm_b);
+        double n2 = n * n;
+        double n3 = n2 * n;
+        double n4 = n3 * n;
+        double n5 = n4 * n;
+
+        ep2 = (sm_a * sm_a - sm_b * sm_b) / (sm_b * sm_b);
+        a2OverB = sm_a * sm_a / sm_b;
+
+        alpha = ((sm_a + sm_b) / 2.0) * (1.0 + (n2 / 4.0) + (n4 / 64.0));
+        beta = (-3.0 * n / 2.0) + (9.0 * n3 / 16.0) + (-3.0 * n5 / 32.0);
+        gamma = (15.0 * n2 / 16.0) + (-15.0 * n4 / 32.0);
+        delta = (-35.0 * n3 / 48.0) + (105.0 * n5 / 256.0);
+        epsilon = (315.0 * n4 / 512.0);
+
+        beta_ = (3.0 * n / 2.0) + (-27.0 * n3 / 32.0) + (269.0 * n5 / 512.0);
+        gamma_ = (21.0 * n2 / 16.0) + (-55.0 * n4 / 32.0);
+        delta_ = (151.0 * n3 / 96.0) + (-417.0 * n5 / 128.0);
+        epsilon_ = (1097.0 * n4 / 512.0);
+    }
+
+    double ep2;
+    double a2OverB;
+
+    // ArcLengthOfMeridian
+    double alpha, beta, gamma, delta, epsilon;
+
+    // FootpointLatitude
+    double beta_, gamma_, delta_, epsilon_;
+};
+
+const UTMCoefficients_t& utmCoefficients(void)
+{
+    static const UTMCoefficients_t coefficients;
+    return coefficients;
+}
+
+/// @return alpha * (phi + beta sin(2 phi) + gamma sin(4 phi) + delta sin(6 phi) + eps sin(8 phi)), with the
+/// higher multiple angles built from sin(2 phi) and cos(2 phi)
+inline double utmSeries(double phi, double alpha, double beta, double gamma, double delta, double eps)
+{
+    double s2 = sin(2.0 * phi);
+    double c2 = cos(2.0 * phi);
+    double s4 = 2.0 * s2 * c2;
+    double c4 = c2 * c2 - s2 * s2;
+    double s6 = s4 * c2 + c4 * s2;
+    double s8 = 2.0 * s4 * c4;
+
+    return alpha * (phi + beta * s2 + gamma * s4 + delta * s6 + eps * s8);
+}
+
+}
+
+void convertGeoToUTM(const double* lat, const double* lon, int count, int zone, double* easting, double* northing)
+{
+    const UTMCoefficients_t& k = utmCoefficients();
+    const double lambda0 = UTMCentralMeridian(zone);
+
+    for (int i=0; i<count; i++) {
+        double phi = lat[i] * M_DEG_TO_RAD;
+        double l = lon[i] * M_DEG_TO_RAD - lambda0;
 
-    UTMXYToLatLon (easting, northing, zone, southhemi, latRadians, lonRadians);
-    coord.setLatitude(RadToDeg(latRadians));
-    coord.setLongitude(RadToDeg(lonRadians));
+        // Same as MapLatLonToXY with the powers expanded
+        double cf = cos(phi);
+        double cf2 = cf * cf;
+        double t = tan(phi);
+        double t2 = t * t;
+        double t4 = t2 * t2;
+        double nu2 = k.ep2 * cf2;
+        double N = k.a2OverB / sqrt(1 + nu2);
+        double l2 = l * l;
+
+        double l3coef = 1.0 - t2 + nu2;
+        double l4coef = 5.0 - t2 + 9 * nu2 + 4.0 * (nu2 * nu2);
+        double l5coef = 5.0 - 18.0 * t2 + t4 + 14.0 * nu2 - 58.0 * t2 * nu2;
+        double l6coef = 61.0 - 58.0 * t2 + t4 + 270.0 * nu2 - 330.0 * t2 * nu2;
+        double l7coef = 61.0 - 479.0 * t2 + 179.0 * t4 - (t4 * t2);
+        double l8coef = 1385.0 - 3111.0 * t2 + 543.0 * t4 - (t4 * t2);
+
+        double x = N * cf * l * (1.0 + cf2 * l2 * (l3coef / 6.0 + cf2 * l2 * (l5coef / 120.0 + cf2 * l2 * l7coef / 5040.0)));
+        double y = utmSeries(phi, k.alpha, k.beta, k.gamma, k.delta, k.epsilon)
+                + t * N * cf2 * l2 * (1.0 / 2.0 + cf2 * l2 * (l4coef / 24.0 + cf2 * l2 * (l6coef / 720.0 + cf2 * l2 * l8coef / 40320.0)));
+
+        // Adjust easting and northing for UTM system
+        easting[i] = x * UTMScaleFactor + 500000.0;
+        y *= UTMScaleFactor;
+        northing[i] = (y < 0.0) ? (y + 10000000.0) : y;
+    }
+}
+
+void convertUTMToGeo(const double* easting, const double* northing, int count, int zone, bool southhemi, double* lat, double* lon)
+{
+    const UTMCoefficients_t& k = utmCoefficients();
+    const double lambda0 = UTMCentralMeridian(zone);
+    const double falseNorthing = southhemi ? 10000000.0 : 0.0;
+
+    for (int i=0; i<count; i++) {
+        double x = (easting[i] - 500000.0) / UTMScaleFactor;
+        double y = (northing[i] - falseNorthing) / UTMScaleFactor;
+
+        // Same as MapXYToLatLon with the powers expanded
+        double phif = utmSeries(y / k.alpha, 1.0, k.beta_, k.gamma_, k.delta_, k.epsilon_);
+        double cf = cos(phif);
+        double nuf2 = k.ep2 * cf * cf;
+        double Nf = k.a2OverB / sqrt(1 + nuf2);
+        double tf = tan(phif);
+        double tf2 = tf * tf;
+        double tf4 = tf2 * tf2;
+        double xOverNf = x / Nf;
+        double xOverNf2 = xOverNf * xOverNf;
+
+        double x2poly = -1.0 - nuf2;
+        double x3poly = -1.0 - 2 * tf2 - nuf2;
+        double x4poly = 5.0 + 3.0 * tf2 + 6.0 * nuf2 - 6.0 * tf2 * nuf2 - 3.0 * (nuf2 * nuf2) - 9.0 * tf2 * (nuf2 * nuf2);
+        double x5poly = 5.0 + 28.0 * tf2 + 24.0 * tf4 + 6.0 * nuf2 + 8.0 * tf2 * nuf2;
+        double x6poly = -61.0 - 90.0 * tf2 - 45.0 * tf4 - 107.0 * nuf2 + 162.0 * tf2 * nuf2;
+        double x7poly = -61.0 - 662.0 * tf2 - 1320.0 * tf4 - 720.0 * (tf4 * tf2);
+        double x8poly = 1385.0 + 3633.0 * tf2 + 4095.0 * tf4 + 1575 * (tf4 * tf2);
+
+        double phi = phif + tf * xOverNf2 * (x2poly / 2.0 + xOverNf2 * (x4poly / 24.0 + xOverNf2 * (x6poly / 720.0 + xOverNf2 * x8poly / 40320.0)));
+        double lambda = lambda0 + (xOverNf / cf) * (1.0 + xOverNf2 * (x3poly / 6.0 + xOverNf2 * (x5poly / 120.0 + xOverNf2 * x7poly / 5040.0)));
+
+        lat[i] = phi * M_RAD_TO_DEG;
+        lon[i] = lambda * M_RAD_TO_DEG;
+    }
 }
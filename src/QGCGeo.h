@@ -41,6 +41,33 @@ void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, dou
  */
 void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord);
 
+/**
+ * @brief Batch version of convertGeoToNed for many coordinates against the same origin. The origin trigonometry
+ * is only calculated once and the loop has no per point branches so the compiler is free to vectorize it.
+ * @param[in] lat Latitudes in degrees.
+ * @param[in] lon Longitudes in degrees.
+ * @param[in] alt Altitudes in meters, may be NULL if z is NULL.
+ * @param[in] count Number of coordinates.
+ * @param[in] origin Geoedetic origin for LTP projection.
+ * @param[out] x North components in meters.
+ * @param[out] y East components in meters.
+ * @param[out] z Down components in meters, may be NULL if only the horizontal position is needed.
+ */
+void convertGeoToNed(const double* lat, const double* lon, const double* alt, int count, const QGeoCoordinate& origin, double* x, double* y, double* z);
+
+/**
+ * @brief Batch version of convertNedToGeo for many local coordinates against the same origin.
+ * @param[in] x North components in meters.
+ * @param[in] y East components in meters.
+ * @param[in] z Down components in meters, may be NULL if alt is NULL.
+ * @param[in] count Number of coordinates.
+ * @param[in] origin Geoedetic origin for LTP.
+ * @param[out] lat Latitudes in degrees.
+ * @param[out] lon Longitudes in degrees.
+ * @param[out] alt Altitudes in meters, may be NULL if only the horizontal position is needed.
+ */
+void convertNedToGeo(const double* x, const double* y, const double* z, int count, const QGeoCoordinate& origin, double* lat, double* lon, double* alt);
+
 // LatLonToUTMXY
 // Converts a latitude/longitude pair to x and y coordinates in the
 // Universal Transverse Mercator projection.
@@ -81,4 +108,28 @@ int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northi
 // The function does not return a value.
 void convertUTMToGeo(double easting, double northing, int zone, bool southhemi, QGeoCoordinate& coord);
 
+/**
+ * @brief Batch version of convertGeoToUTM. All coordinates are projected into the same zone, use convertGeoToUTM
+ * on one of them to pick the zone. The ellipsoid series coefficients are only calculated once.
+ * @param[in] lat Latitudes in degrees.
+ * @param[in] lon Longitudes in degrees.
+ * @param[in] count Number of coordinates.
+ * @param[in] zone UTM zone, range [1,60].
+ * @param[out] easting Eastings in meters.
+ * @param[out] northing Northings in meters.
+ */
+void convertGeoToUTM(const double* lat, const double* lon, int count, int zone, double* easting, double* northing);
+
+/**
+ * @brief Batch version of convertUTMToGeo.
+ * @param[in] easting Eastings in meters.
+ * @param[in] northing Northings in meters.
+ * @param[in] count Number of coordinates.
+ * @param[in] zone UTM zone the coordinates are in, range [1,60].
+ * @param[in] southhemi True if the coordinates are in the southern hemisphere.
+ * @param[out] lat Latitudes in degrees.
+ * @param[out] lon Longitudes in degrees.
+ */
+void convertUTMToGeo(const double* easting, const double* northing, int count, int zone, bool southhemi, double* lat, double* lon);
+
 #endif // QGCGEO_H
@@ -0,0 +1,61 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCStartupTracer.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QStandardPaths>
+
+bool    QGCStartupTracer::_enabled = false;
+qint64  QGCStartupTracer::_startNsecs = 0;
+QString QGCStartupTracer::_fileName;
+
+void QGCStartupTracer::start(const QString& fileName)
+{
+    _fileName = fileName;
+    if (_fileName.isEmpty()) {
+        _fileName = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).filePath(QStringLiteral("%1-startup-trace.json").arg(QCoreApplication::applicationName()));
+    }
+    _startNsecs = QGCTracer::now();
+    _enabled = true;
+    QGCTracer::setEnabled(QGCTracer::SourceStartup, true);
+}
+
+qint64 QGCStartupTracer::finish(void)
+{
+    if (!_enabled) {
+        return -1;
+    }
+
+    qint64 totalNsecs = QGCTracer::now() - _startNsecs;
+    QGCTracer::complete("startup", "startup", _startNsecs, totalNsecs);
+    QGCTracer::writeTrace(_fileName);
+    QGCTracer::setEnabled(QGCTracer::SourceStartup, false);
+    _enabled = false;
+
+    return totalNsecs / 1000000;
+}
+
+void QGCStartupTracer::mark(const char* name)
+{
+    QGCTracer::instant("startup", name);
+}
+
+QGCStartupTracer::Scope::Scope(const char* name)
+    : QGCTracer::Scope("startup", name)
+{
+
+}
+
+QGCStartupTracer::Scope::Scope(const QByteArray& name)
+    : QGCTracer::Scope("startup", QGCTracer::isEnabled() ? QGCTracer::intern(name) : "")
+{
+
+}
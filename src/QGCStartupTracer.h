@@ -0,0 +1,53 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCTracer.h"
+
+#include <QByteArray>
+#include <QString>
+
+/// Records how long each step of application startup takes: toolbox construction, setToolbox calls, QML
+/// registration and loading. Events are recorded through QGCTracer in the "startup" category and written as a
+/// Chrome trace event file when startup completes.
+///
+/// Recording is off unless the application is started with --trace-startup[:file] or --startup-benchmark.
+/// While off, a Scope costs a single flag check.
+class QGCStartupTracer
+{
+public:
+    /// Starts recording. Must be called as early as possible in main since the total startup time is measured
+    /// from this call.
+    ///     @param fileName Trace file to write, default location used if empty
+    static void start(const QString& fileName);
+
+    static bool isEnabled(void) { return _enabled; }
+
+    /// Closes the trace: records the total startup time, writes the trace file and stops recording, unless
+    /// tracing has also been turned on from elsewhere
+    /// @return Total startup time in msecs, -1 if not recording
+    static qint64 finish(void);
+
+    /// Records a point in time, such as the event loop starting
+    static void mark(const char* name);
+
+    /// Times the enclosing scope
+    class Scope : public QGCTracer::Scope
+    {
+    public:
+        Scope(const char* name);
+        Scope(const QByteArray& name);
+    };
+
+private:
+    static bool     _enabled;
+    static qint64   _startNsecs;
+    static QString  _fileName;
+};
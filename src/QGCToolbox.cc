@@ -31,6 +31,7 @@
 #include "hbsettings.h"
 #include "SettingsManager.h"
 #include "QGCApplication.h"
+#include "QGCStartupTracer.h"
 
 #if defined(QGC_CUSTOM_BUILD)
 #include CUSTOMHEADER
@@ -60,57 +61,78 @@ QGCToolbox::QGCToolbox(QGCApplication* app)
     , _settingsManager(NULL)
 {
     // SettingsManager must be first so settings are available to any subsequent tools
-    _settingsManager =          new SettingsManager(app, this);
+    _settingsManager =          _createTool<SettingsManager>        (app);
 
     //-- Scan and load plugins
     _scanAndLoadPlugins(app);
-    _audioOutput =              new AudioOutput             (app, this);
-    _factSystem =               new FactSystem              (app, this);
-    _firmwarePluginManager =    new FirmwarePluginManager   (app, this);
+    _audioOutput =              _createTool<AudioOutput>            (app);
+    _factSystem =               _createTool<FactSystem>             (app);
+    _firmwarePluginManager =    _createTool<FirmwarePluginManager>  (app);
 #ifndef __mobile__
-    _gpsManager =               new GPSManager              (app, this);
+    _gpsManager =               _createTool<GPSManager>             (app);
 #endif
 
-    _imageProvider =            new QGCImageProvider        (app, this);
-    _joystickManager =          new JoystickManager         (app, this);
-    _linkManager =              new LinkManager             (app, this);
-    _mavlinkProtocol =          new MAVLinkProtocol         (app, this);
-    _missionCommandTree =       new MissionCommandTree      (app, this);
-    _multiVehicleManager =      new MultiVehicleManager     (app, this);
-    _mapEngineManager =         new QGCMapEngineManager     (app, this);
-    _uasMessageHandler =        new UASMessageHandler       (app, this);
-    _qgcPositionManager =       new QGCPositionManager      (app, this);
-    _followMe =                 new FollowMe                (app, this);
-    _videoManager =             new VideoManager            (app, this);
-    _mavlinkLogManager =        new MAVLinkLogManager       (app, this);
-    _hbSettings =               new HBSettings              (app, this);
+    _imageProvider =            _createTool<QGCImageProvider>       (app);
+    _joystickManager =          _createTool<JoystickManager>        (app);
+    _linkManager =              _createTool<LinkManager>            (app);
+    _mavlinkProtocol =          _createTool<MAVLinkProtocol>        (app);
+    _missionCommandTree =       _createTool<MissionCommandTree>     (app);
+    _multiVehicleManager =      _createTool<MultiVehicleManager>    (app);
+    if (!app->headless()) {
+        _mapEngineManager =     _createTool<QGCMapEngineManager>    (app);
+    }
+    _uasMessageHandler =        _createTool<UASMessageHandler>      (app);
+    _qgcPositionManager =       _createTool<QGCPositionManager>     (app);
+    _followMe =                 _createTool<FollowMe>               (app);
+    if (!app->headless()) {
+        _videoManager =         _createTool<VideoManager>           (app);
+    }
+    _mavlinkLogManager =        _createTool<MAVLinkLogManager>      (app);
+    _hbSettings =               _createTool<HBSettings>             (app);
+}
+
+/// Constructs a tool, timing it for the startup trace
+template <class T>
+T* QGCToolbox::_createTool(QGCApplication* app)
+{
+    QGCStartupTracer::Scope trace(QByteArray(T::staticMetaObject.className()) + "()");
+    return new T(app, this);
 }
 
 void QGCToolbox::setChildToolboxes(void)
 {
     // SettingsManager must be first so settings are available to any subsequent tools
-    _settingsManager->setToolbox(this);
-
-    _corePlugin->setToolbox(this);
-    _audioOutput->setToolbox(this);
-    _factSystem->setToolbox(this);
-    _firmwarePluginManager->setToolbox(this);
+    QList<QGCTool*> tools;
+    tools << _settingsManager
+          << _corePlugin
+          << _audioOutput
+          << _factSystem
+          << _firmwarePluginManager
 #ifndef __mobile__
-    _gpsManager->setToolbox(this);
+          << _gpsManager
 #endif
-    _imageProvider->setToolbox(this);
-    _joystickManager->setToolbox(this);
-    _linkManager->setToolbox(this);
-    _mavlinkProtocol->setToolbox(this);
-    _missionCommandTree->setToolbox(this);
-    _multiVehicleManager->setToolbox(this);
-    _mapEngineManager->setToolbox(this);
-    _uasMessageHandler->setToolbox(this);
-    _followMe->setToolbox(this);
-    _qgcPositionManager->setToolbox(this);
-    _videoManager->setToolbox(this);
-    _mavlinkLogManager->setToolbox(this);
-    _hbSettings->setToolbox(this);
+          << _imageProvider
+          << _joystickManager
+          << _linkManager
+          << _mavlinkProtocol
+          << _missionCommandTree
+          << _multiVehicleManager
+          << _mapEngineManager
+          << _uasMessageHandler
+          << _followMe
+          << _qgcPositionManager
+          << _videoManager
+          << _mavlinkLogManager
+          << _hbSettings;
+
+    foreach (QGCTool* tool, tools) {
+        if (!tool) {
+            // Gui only tools are not created when running headless
+            continue;
+        }
+        QGCStartupTracer::Scope trace(QByteArray(tool->metaObject()->className()) + "::setToolbox");
+        tool->setToolbox(this);
+    }
 }
 
 void QGCToolbox::_scanAndLoadPlugins(QGCApplication* app)
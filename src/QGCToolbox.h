@@ -48,12 +48,12 @@ public:
     MAVLinkProtocol*            mavlinkProtocol(void)           { return _mavlinkProtocol; }
     MissionCommandTree*         missionCommandTree(void)        { return _missionCommandTree; }
     MultiVehicleManager*        multiVehicleManager(void)       { return _multiVehicleManager; }
-    QGCMapEngineManager*        mapEngineManager(void)          { return _mapEngineManager; }
+    QGCMapEngineManager*        mapEngineManager(void)          { return _mapEngineManager; }   ///< NULL when running headless
     QGCImageProvider*           imageProvider()                 { return _imageProvider; }
     UASMessageHandler*          uasMessageHandler(void)         { return _uasMessageHandler; }
     FollowMe*                   followMe(void)                  { return _followMe; }
     QGCPositionManager*         qgcPositionManager(void)        { return _qgcPositionManager; }
-    VideoManager*               videoManager(void)              { return _videoManager; }
+    VideoManager*               videoManager(void)              { return _videoManager; }       ///< NULL when running headless
     MAVLinkLogManager*          mavlinkLogManager(void)         { return _mavlinkLogManager; }
     QGCCorePlugin*              corePlugin(void)                { return _corePlugin; }
     SettingsManager*            settingsManager(void)           { return _settingsManager; }
@@ -66,6 +66,7 @@ public:
 private:
     void setChildToolboxes(void);
     void _scanAndLoadPlugins(QGCApplication *app);
+    template <class T> T* _createTool(QGCApplication* app);
 
 
     AudioOutput*                _audioOutput;
@@ -0,0 +1,359 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTracer.h"
+
+#include <QAtomicInteger>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+QAtomicInt QGCTracer::_sources;
+
+namespace {
+
+const quint32 _ringCapacity = QGCTracer::ringCapacity;
+const quint32 _ringMask     = _ringCapacity - 1;
+
+/// Ring slots are guarded by a sequence number so a trace can be written while other threads are still
+/// recording: the owning thread zeroes the sequence while it rewrites a slot and then sets it to the event
+/// index + 1. A reader only keeps a copy if the sequence matched before and after copying.
+struct TraceSlot {
+    QAtomicInteger<quint32> sequence;
+    char                    phase;          ///< 'X' complete event, 'i' instant event
+    const char*             category;
+    const char*             name;
+    qint64                  startNsecs;
+    qint64                  durationNsecs;
+};
+
+struct TraceEvent {
+    char        phase;
+    const char* category;
+    const char* name;
+    qint64      startNsecs;
+    qint64      durationNsecs;
+};
+
+struct ThreadRing {
+    int                     tid;
+    QString                 threadName;
+    QAtomicInt              session;        ///< Session the recorded events belong to
+    QAtomicInteger<quint32> head;           ///< Index of the next event, only written by the owning thread
+    TraceSlot               slots[_ringCapacity];
+};
+
+struct TraceRegistry {
+    TraceRegistry(void) : nextTid(1) { clock.start(); }
+
+    QElapsedTimer       clock;
+    QAtomicInt          session;
+    QMutex              mutex;              ///< Guards rings, freeRings, nextTid, names and the ring tid/threadName
+    QList<ThreadRing*>  rings;              ///< Every ring allocated, in use or free
+    QList<ThreadRing*>  freeRings;          ///< Rings of finished threads, ready for reuse
+    int                 nextTid;
+    QSet<QByteArray>    names;
+};
+
+/// Never destroyed: threads which are still running during static destruction may still record
+TraceRegistry* traceRegistry(void)
+{
+    static TraceRegistry* registry = new TraceRegistry;
+    return registry;
+}
+
+/// Ring of the current thread, cached here so recording does not go through QThreadStorage
+thread_local ThreadRing* _threadRing = NULL;
+
+/// Hands the ring back to the registry when its thread finishes. Rings are never freed, since a trace may be
+/// written while a ring is handed over, but they are reused so threads coming and going do not keep adding
+/// rings. The events of a finished thread stay in the trace until another thread takes its ring over.
+class ThreadRingOwner
+{
+public:
+    ThreadRingOwner(ThreadRing* ring) : _ring(ring) { }
+
+    ~ThreadRingOwner()
+    {
+        _threadRing = NULL;
+
+        TraceRegistry* registry = traceRegistry();
+        QMutexLocker lock(&registry->mutex);
+        registry->freeRings.append(_ring);
+    }
+
+private:
+    ThreadRing* _ring;
+};
+
+/// Never destroyed, for the same reason as the registry
+QThreadStorage<ThreadRingOwner*>* threadRingOwner(void)
+{
+    static QThreadStorage<ThreadRingOwner*>* storage = new QThreadStorage<ThreadRingOwner*>;
+    return storage;
+}
+
+ThreadRing* threadRing(void)
+{
+    if (!_threadRing) {
+        TraceRegistry* registry = traceRegistry();
+
+        QThread* thread = QThread::currentThread();
+        QString threadName = thread->objectName();
+        if (threadName.isEmpty()) {
+            if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+                threadName = QStringLiteral("Main");
+            } else {
+                threadName = QString(thread->metaObject()->className());
+            }
+        }
+
+        ThreadRing* ring = NULL;
+        {
+            QMutexLocker lock(&registry->mutex);
+            if (registry->freeRings.isEmpty()) {
+                ring = new ThreadRing;
+                registry->rings.append(ring);
+            } else {
+                ring = registry->freeRings.takeLast();
+            }
+            // A reused ring is taken out of the trace until the previous thread's events are gone
+            ring->session.storeRelease(-1);
+            ring->tid = registry->nextTid++;
+            ring->threadName = threadName;
+        }
+
+        for (quint32 i=0; i<_ringCapacity; i++) {
+            ring->slots[i].sequence.store(0);
+        }
+        ring->head.storeRelease(0);
+        ring->session.storeRelease(registry->session.load());
+
+        _threadRing = ring;
+        threadRingOwner()->setLocalData(new ThreadRingOwner(ring));
+    }
+    return _threadRing;
+}
+
+void record(char phase, const char* category, const char* name, qint64 startNsecs, qint64 durationNsecs)
+{
+    ThreadRing* ring = threadRing();
+
+    int session = traceRegistry()->session.load();
+    if (ring->session.load() != session) {
+        // First event on this thread since tracing was turned back on
+        ring->head.storeRelease(0);
+        ring->session.storeRelease(session);
+    }
+
+    quint32 index = ring->head.load();
+    TraceSlot& slot = ring->slots[index & _ringMask];
+
+    slot.sequence.fetchAndStoreOrdered(0);
+    slot.phase          = phase;
+    slot.category       = category;
+    slot.name           = name;
+    slot.startNsecs     = startNsecs;
+    slot.durationNsecs  = durationNsecs;
+    slot.sequence.storeRelease(index + 1);
+
+    ring->head.storeRelease(index + 1);
+}
+
+/// Copies out the events of the current session which are not being overwritten right now
+QVector<TraceEvent> snapshot(ThreadRing* ring, int session)
+{
+    QVector<TraceEvent> events;
+
+    if (ring->session.loadAcquire() != session) {
+        return events;
+    }
+
+    quint32 head = ring->head.loadAcquire();
+    quint32 first = head > _ringCapacity ? head - _ringCapacity : 0;
+    events.reserve(head - first);
+    for (quint32 index=first; index<head; index++) {
+        TraceSlot& slot = ring->slots[index & _ringMask];
+        if (slot.sequence.loadAcquire() != index + 1) {
+            continue;
+        }
+        TraceEvent event = { slot.phase, slot.category, slot.name, slot.startNsecs, slot.durationNsecs };
+        if (slot.sequence.fetchAndAddOrdered(0) == index + 1) {
+            events.append(event);
+        }
+    }
+    return events;
+}
+
+QByteArray jsonString(const char* value)
+{
+    QByteArray escaped("\"");
+    for (const char* p = value; *p; p++) {
+        switch (*p) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(*p) < 0x20) {
+                escaped += ' ';
+            } else {
+                escaped += *p;
+            }
+            break;
+        }
+    }
+    escaped += '"';
+    return escaped;
+}
+
+QByteArray jsonMicroseconds(qint64 nsecs)
+{
+    return QByteArray::number(nsecs / 1000.0, 'f', 3);
+}
+
+}
+
+void QGCTracer::setEnabled(Source source, bool enabled)
+{
+#if defined(QGC_DISABLE_TRACING)
+    Q_UNUSED(source);
+    if (enabled) {
+        qWarning() << "Tracing is not available, built with QGC_DISABLE_TRACING";
+    }
+#else
+    int sources = _sources.load();
+    int newSources = enabled ? sources | source : sources & ~source;
+
+    if (sources == 0 && newSources != 0) {
+        // Start a new session, each thread drops its old events the next time it records
+        traceRegistry()->session.fetchAndAddOrdered(1);
+    }
+    _sources.store(newSources);
+#endif
+}
+
+qint64 QGCTracer::now(void)
+{
+    return traceRegistry()->clock.nsecsElapsed();
+}
+
+void QGCTracer::complete(const char* category, const char* name, qint64 startNsecs, qint64 durationNsecs)
+{
+    if (isEnabled()) {
+        record('X', category, name, startNsecs, durationNsecs);
+    }
+}
+
+void QGCTracer::instant(const char* category, const char* name)
+{
+    if (isEnabled()) {
+        record('i', category, name, now(), 0);
+    }
+}
+
+int QGCTracer::ringCount(void)
+{
+    TraceRegistry* registry = traceRegistry();
+
+    QMutexLocker lock(&registry->mutex);
+    return registry->rings.count();
+}
+
+const char* QGCTracer::intern(const QByteArray& name)
+{
+    TraceRegistry* registry = traceRegistry();
+
+    QMutexLocker lock(&registry->mutex);
+    // QSet never moves its elements and QByteArray data is null terminated
+    return registry->names.insert(name)->constData();
+}
+
+QString QGCTracer::defaultTraceFile(void)
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).filePath(QStringLiteral("%1-trace.json").arg(QCoreApplication::applicationName()));
+}
+
+bool QGCTracer::writeTrace(const QString& fileName)
+{
+    TraceRegistry*              registry = traceRegistry();
+    int                         session = registry->session.load();
+    QList<ThreadRing*>          rings;
+    QList<int>                  tids;
+    QStringList                 threadNames;
+
+    {
+        // A ring may be handed to a new thread while the trace is written, its tid and name are taken here
+        QMutexLocker lock(&registry->mutex);
+        rings = registry->rings;
+        foreach (ThreadRing* ring, rings) {
+            tids.append(ring->tid);
+            threadNames.append(ring->threadName);
+        }
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write trace" << fileName << file.errorString();
+        return false;
+    }
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    int eventCount = 0;
+
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    file.write("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"args\":{\"name\":" + jsonString(QCoreApplication::applicationName().toUtf8().constData()) + "}}");
+
+    for (int i=0; i<rings.count(); i++) {
+        QVector<TraceEvent> events = snapshot(rings[i], session);
+        if (events.isEmpty()) {
+            continue;
+        }
+
+        const QByteArray tid = QByteArray::number(tids[i]);
+        file.write(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":" + jsonString(threadNames[i].toUtf8().constData()) + "}}");
+
+        QByteArray buffer;
+        foreach (const TraceEvent& event, events) {
+            buffer += ",\n{\"name\":" + jsonString(event.name) + ",\"cat\":" + jsonString(event.category) + ",\"ph\":\"" + event.phase + "\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"ts\":" + jsonMicroseconds(event.startNsecs);
+            if (event.phase == 'X') {
+                buffer += ",\"dur\":" + jsonMicroseconds(event.durationNsecs) + "}";
+            } else {
+                buffer += ",\"s\":\"t\"}";
+            }
+            if (buffer.size() > 64 * 1024) {
+                file.write(buffer);
+                buffer.clear();
+            }
+        }
+        file.write(buffer);
+        eventCount += events.count();
+    }
+
+    file.write("\n]}\n");
+    if (!file.commit()) {
+        qWarning() << "Unable to write trace" << fileName << file.errorString();
+        return false;
+    }
+
+    qDebug() << "Trace written to" << fileName << "events:" << eventCount;
+    return true;
+}
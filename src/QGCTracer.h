@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+
+/// Scoped tracing of hot paths, written out in the Chrome trace event format so a trace can be opened with
+/// chrome://tracing or ui.perfetto.dev and attached to a performance report.
+///
+/// Each thread records into its own fixed size ring of events, so recording takes no locks and once a ring is
+/// full the oldest events are overwritten. Rings are only allocated for threads which record while tracing is on,
+/// and a finished thread's ring is reused by the next thread which starts recording.
+/// While tracing is off a scope costs a single flag check. Building with DEFINES+=QGC_DISABLE_TRACING removes the
+/// QGC_TRACE_* macros entirely.
+///
+/// Category and event names must be string literals (or names returned by intern) since only the pointers are
+/// recorded.
+class QGCTracer
+{
+public:
+    /// Tracing is on while at least one source has it turned on
+    enum Source {
+        SourceCommandLine   = 0x01, ///< --trace[:file]
+        SourceSettings      = 0x02, ///< Console page toggle
+        SourceStartup       = 0x04, ///< --trace-startup, --startup-benchmark
+    };
+
+    /// Turns tracing on/off for the specified source. Turning tracing on when it was off throws away the
+    /// previously recorded events.
+    static void setEnabled(Source source, bool enabled);
+
+    static const quint32 ringCapacity = 16384;  ///< Events kept per thread, must be power of 2
+
+#if defined(QGC_DISABLE_TRACING)
+    static bool isEnabled(void) { return false; }
+#else
+    static bool isEnabled(void) { return _sources.load() != 0; }
+#endif
+
+    /// @return Trace clock time in nsecs
+    static qint64 now(void);
+
+    /// Records an event with a known duration
+    static void complete(const char* category, const char* name, qint64 startNsecs, qint64 durationNsecs);
+
+    /// Records a point in time
+    static void instant(const char* category, const char* name);
+
+    /// @return Name which is valid for the lifetime of the application, for use with names built at runtime.
+    ///         Interning takes a lock, so keep it out of hot paths.
+    static const char* intern(const QByteArray& name);
+
+    /// Writes the events recorded since tracing was last turned on. Tracing is not stopped.
+    /// @return false: file could not be written
+    static bool writeTrace(const QString& fileName);
+
+    /// @return Number of thread rings allocated, in use or waiting for reuse
+    static int ringCount(void);
+
+    /// @return Trace file used when none is specified
+    static QString defaultTraceFile(void);
+
+    /// Times the enclosing scope
+    class Scope
+    {
+    public:
+        Scope(const char* category, const char* name)
+            : _category     (category)
+            , _name         (name)
+            , _startNsecs   (QGCTracer::isEnabled() ? QGCTracer::now() : -1)
+        {
+        }
+
+        ~Scope()
+        {
+            if (_startNsecs >= 0) {
+                QGCTracer::complete(_category, _name, _startNsecs, QGCTracer::now() - _startNsecs);
+            }
+        }
+
+    private:
+        const char* _category;
+        const char* _name;
+        qint64      _startNsecs;
+    };
+
+private:
+    static QAtomicInt _sources;
+};
+
+#define QGC_TRACE_CONCAT_(a, b) a##b
+#define QGC_TRACE_CONCAT(a, b)  QGC_TRACE_CONCAT_(a, b)
+
+#if defined(QGC_DISABLE_TRACING)
+#define QGC_TRACE_SCOPE(category, name)
+#define QGC_TRACE_INSTANT(category, name)
+#else
+#define QGC_TRACE_SCOPE(category, name)     QGCTracer::Scope QGC_TRACE_CONCAT(_qgcTraceScope, __LINE__)(category, name)
+#define QGC_TRACE_INSTANT(category, name)   QGCTracer::instant(category, name)
+#endif
@@ -0,0 +1,221 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTracerTest.h"
+#include "QGCTracer.h"
+#include "QGCTemporaryFile.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
+
+namespace {
+
+/// Records a single instant event and finishes
+class TraceThread : public QThread
+{
+public:
+    TraceThread(const char* name) : _name(name) { }
+
+protected:
+    void run(void) override
+    {
+        QGC_TRACE_INSTANT("test", _name);
+    }
+
+private:
+    const char* _name;
+};
+
+}
+
+QGCTracerTest::QGCTracerTest(void)
+{
+
+}
+
+void QGCTracerTest::cleanup(void)
+{
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, false);
+
+    UnitTest::cleanup();
+}
+
+/// Writes the current trace and returns the events recorded by this test, in file order
+QList<QJsonObject> QGCTracerTest::_writeAndReadTrace(QList<QJsonObject>* metadata)
+{
+    QList<QJsonObject> events;
+
+    QGCTemporaryFile traceFile(QStringLiteral("QGCTracerTest.XXXXXX.json"));
+    if (!traceFile.open()) {
+        return events;
+    }
+    traceFile.close();
+    if (!QGCTracer::writeTrace(traceFile.fileName())) {
+        return events;
+    }
+    QFile file(traceFile.fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return events;
+    }
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    file.close();
+    traceFile.remove();
+    if (error.error != QJsonParseError::NoError) {
+        qWarning() << "Trace is not valid json" << error.errorString();
+        return events;
+    }
+
+    foreach (const QJsonValue& value, doc.object()[QStringLiteral("traceEvents")].toArray()) {
+        QJsonObject event = value.toObject();
+        if (event[QStringLiteral("ph")].toString() == QStringLiteral("M")) {
+            if (metadata) {
+                metadata->append(event);
+            }
+        } else if (event[QStringLiteral("cat")].toString() == QStringLiteral("test")) {
+            events.append(event);
+        }
+    }
+    return events;
+}
+
+void QGCTracerTest::_testDisabled(void)
+{
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, false);
+    QVERIFY(!QGCTracer::isEnabled());
+
+    {
+        QGC_TRACE_SCOPE("test", "disabled scope");
+        QGC_TRACE_INSTANT("test", "disabled instant");
+    }
+
+    QCOMPARE(_writeAndReadTrace().count(), 0);
+}
+
+void QGCTracerTest::_testScopesAndThreads(void)
+{
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, true);
+    QVERIFY(QGCTracer::isEnabled());
+
+    {
+        QGC_TRACE_SCOPE("test", "outer");
+        QGC_TRACE_INSTANT("test", "instant \"quoted\"");
+        QGC_TRACE_SCOPE("test", QGCTracer::intern(QByteArray("runtime") + "Name"));
+    }
+
+    QtConcurrent::run([] {
+        QGC_TRACE_SCOPE("test", "worker");
+    }).waitForFinished();
+
+    QList<QJsonObject> metadata;
+    QList<QJsonObject> events = _writeAndReadTrace(&metadata);
+    QCOMPARE(events.count(), 4);
+
+    QMap<QString, QJsonObject> byName;
+    foreach (const QJsonObject& event, events) {
+        byName[event[QStringLiteral("name")].toString()] = event;
+    }
+    QVERIFY(byName.contains(QStringLiteral("outer")));
+    QVERIFY(byName.contains(QStringLiteral("instant \"quoted\"")));
+    QVERIFY(byName.contains(QStringLiteral("runtimeName")));
+    QVERIFY(byName.contains(QStringLiteral("worker")));
+
+    QJsonObject outer = byName[QStringLiteral("outer")];
+    QJsonObject inner = byName[QStringLiteral("runtimeName")];
+    QCOMPARE(outer[QStringLiteral("ph")].toString(), QStringLiteral("X"));
+    QCOMPARE(byName[QStringLiteral("instant \"quoted\"")][QStringLiteral("ph")].toString(), QStringLiteral("i"));
+
+    // Inner scope nests within the outer one
+    double outerStart = outer[QStringLiteral("ts")].toDouble();
+    double innerStart = inner[QStringLiteral("ts")].toDouble();
+    QVERIFY(innerStart >= outerStart);
+    QVERIFY(innerStart + inner[QStringLiteral("dur")].toDouble() <= outerStart + outer[QStringLiteral("dur")].toDouble());
+
+    // Worker thread records into its own ring, which shows up as its own named thread
+    int mainTid = outer[QStringLiteral("tid")].toInt();
+    int workerTid = byName[QStringLiteral("worker")][QStringLiteral("tid")].toInt();
+    QVERIFY(mainTid != workerTid);
+
+    QSet<int> namedThreads;
+    foreach (const QJsonObject& event, metadata) {
+        if (event[QStringLiteral("name")].toString() == QStringLiteral("thread_name")) {
+            namedThreads.insert(event[QStringLiteral("tid")].toInt());
+        }
+    }
+    QVERIFY(namedThreads.contains(mainTid));
+    QVERIFY(namedThreads.contains(workerTid));
+}
+
+void QGCTracerTest::_testRingOverwrite(void)
+{
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, true);
+
+    const int cEvents = QGCTracer::ringCapacity + 100;
+    for (int i=0; i<cEvents; i++) {
+        QGC_TRACE_INSTANT("test", i < 100 ? "overwritten" : "kept");
+    }
+
+    QList<QJsonObject> events = _writeAndReadTrace();
+    QCOMPARE(events.count(), static_cast<int>(QGCTracer::ringCapacity));
+    foreach (const QJsonObject& event, events) {
+        QCOMPARE(event[QStringLiteral("name")].toString(), QStringLiteral("kept"));
+    }
+}
+
+void QGCTracerTest::_testSessionRestart(void)
+{
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, true);
+    QGC_TRACE_INSTANT("test", "first session");
+
+    // Another source turning off does not stop tracing
+    QGCTracer::setEnabled(QGCTracer::SourceSettings, false);
+    QVERIFY(QGCTracer::isEnabled());
+
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, false);
+    QVERIFY(!QGCTracer::isEnabled());
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, true);
+    QGC_TRACE_INSTANT("test", "second session");
+
+    QList<QJsonObject> events = _writeAndReadTrace();
+    QCOMPARE(events.count(), 1);
+    QCOMPARE(events[0][QStringLiteral("name")].toString(), QStringLiteral("second session"));
+}
+
+void QGCTracerTest::_testRingReuse(void)
+{
+    QGCTracer::setEnabled(QGCTracer::SourceCommandLine, true);
+
+    TraceThread firstThread("first thread");
+    firstThread.start();
+    QVERIFY(firstThread.wait(5000));
+    int ringCount = QGCTracer::ringCount();
+
+    // Threads coming and going one after another take over the ring of the previous one
+    const char* lastName = NULL;
+    for (int i=0; i<10; i++) {
+        lastName = QGCTracer::intern(QByteArray("thread ") + QByteArray::number(i));
+        TraceThread thread(lastName);
+        thread.start();
+        QVERIFY(thread.wait(5000));
+    }
+    QCOMPARE(QGCTracer::ringCount(), ringCount);
+
+    // The last thread's event is still there after it finished
+    bool found = false;
+    foreach (const QJsonObject& event, _writeAndReadTrace()) {
+        if (event[QStringLiteral("name")].toString() == QLatin1String(lastName)) {
+            found = true;
+        }
+    }
+    QVERIFY(found);
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QJsonObject>
+
+class QGCTracerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTracerTest(void);
+
+private slots:
+    void cleanup(void);
+
+    void _testDisabled(void);
+    void _testScopesAndThreads(void);
+    void _testRingOverwrite(void);
+    void _testSessionRestart(void);
+    void _testRingReuse(void);
+
+private:
+    QList<QJsonObject> _writeAndReadTrace(QList<QJsonObject>* metadata = NULL);
+};
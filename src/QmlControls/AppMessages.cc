@@ -17,22 +17,24 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 
-#include <QStringListModel>
 #include <QtConcurrent>
 #include <QTextStream>
+#include <QDateTime>
+
+#include <string.h>
 
 Q_GLOBAL_STATIC(AppLogModel, debug_model)
 
+const quint32   AppLogRing::capacity;
+const int       AppLogModel::maxRows;
+
 static QtMessageHandler old_handler;
 
 static void msgHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-    const char symbols[] = { 'D', 'E', '!', 'X', 'I' };
-    QString output = QString("[%1] at %2:%3 - \"%4\"").arg(symbols[type]).arg(context.file).arg(context.line).arg(msg);
-
     // Avoid recursion
-    if (!QString(context.category).startsWith("qt.quick")) {
-        debug_model->log(output);
+    if (!context.category || strncmp(context.category, "qt.quick", 8) != 0) {
+        AppLogModel::log(type, context, msg);
     }
 
     if (old_handler != nullptr) {
@@ -54,46 +56,184 @@ AppLogModel *AppMessages::getModel()
     return debug_model;
 }
 
-AppLogModel::AppLogModel() : QStringListModel()
+// Bounded queue based on Dmitry Vyukov's MPMC design. Each cell carries a sequence number which tells
+// producers and the consumer whose turn it is, so no locks are needed on either side.
+AppLogRing::AppLogRing(void)
+    : _cells        (new Cell[capacity])
+    , _enqueuePos   (0)
+    , _dequeuePos   (0)
 {
-#ifdef __mobile__
-    Qt::ConnectionType contype = Qt::QueuedConnection;
-#else
-    Qt::ConnectionType contype = Qt::AutoConnection;
-#endif
-    connect(this, &AppLogModel::emitLog, this, &AppLogModel::threadsafeLog, contype);
+    for (quint32 i = 0; i < capacity; i++) {
+        _cells[i].sequence.store(i);
+    }
 }
 
-void AppLogModel::writeMessages(const QString dest_file)
+AppLogRing::~AppLogRing()
 {
-    const QString writebuffer(stringList().join('\n').append('\n'));
+    delete[] _cells;
+}
 
-    QtConcurrent::run([dest_file, writebuffer] {
-        emit debug_model->writeStarted();
-        bool success = false;
-        QFile file(dest_file);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream out(&file);
-            out << writebuffer;
-            success = out.status() == QTextStream::Ok;
+bool AppLogRing::push(const AppLogRecord& record)
+{
+    Cell*   cell;
+    quint32 pos = _enqueuePos.load();
+
+    for (;;) {
+        cell = &_cells[pos & _mask];
+        qint32 diff = static_cast<qint32>(cell->sequence.loadAcquire() - pos);
+        if (diff == 0) {
+            if (_enqueuePos.testAndSetRelaxed(pos, pos + 1)) {
+                break;
+            }
+            pos = _enqueuePos.load();
+        } else if (diff < 0) {
+            // Ring is full
+            return false;
+        } else {
+            pos = _enqueuePos.load();
         }
-        emit debug_model->writeFinished(success);
-    });
+    }
+
+    cell->record = record;
+    cell->sequence.storeRelease(pos + 1);
+    return true;
+}
+
+bool AppLogRing::pop(AppLogRecord& record)
+{
+    Cell* cell = &_cells[_dequeuePos & _mask];
+
+    if (cell->sequence.loadAcquire() != _dequeuePos + 1) {
+        return false;
+    }
+
+    record = cell->record;
+    cell->record.message.clear();
+    cell->sequence.storeRelease(_dequeuePos + capacity);
+    _dequeuePos++;
+    return true;
 }
 
-void AppLogModel::log(const QString message)
+AppLogModel::AppLogModel()
+    : QAbstractListModel    ()
+    , _flushScheduled       (0)
+    , _droppedCount         (0)
+    , _lastReportedDropped  (0)
+    , _records              (maxRows)
+    , _first                (0)
+    , _count                (0)
 {
-    emit debug_model->emitLog(message);
+
 }
 
-void AppLogModel::threadsafeLog(const QString message)
+void AppLogModel::log(QtMsgType type, const QMessageLogContext& context, const QString& message)
 {
-    const int line = rowCount();
-    insertRows(line, 1);
-    setData(index(line), message, Qt::DisplayRole);
+    AppLogModel* model = debug_model;
+
+    AppLogRecord record;
+    record.type     = type;
+    record.category = QByteArray(context.category);
+    record.file     = QByteArray(context.file);
+    record.line     = context.line;
+    record.msecs    = QDateTime::currentMSecsSinceEpoch();
+    record.message  = message;
 
+    if (!model->_ring.push(record)) {
+        model->_droppedCount.fetchAndAddRelaxed(1);
+    }
+
+    // Only a single flush is queued to the model thread no matter how many records arrive before it runs
+    if (model->_flushScheduled.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(model, "_flushPending", Qt::QueuedConnection);
+    }
+}
+
+QString AppLogModel::formatRecord(const AppLogRecord& record)
+{
+    static const char symbols[] = { 'D', 'E', '!', 'X', 'I' };
+
+    return QStringLiteral("%1 [%2] at %3:%4 - \"%5\"")
+            .arg(QDateTime::fromMSecsSinceEpoch(record.msecs).toString(QStringLiteral("hh:mm:ss.zzz")))
+            .arg(record.type >= 0 && record.type < static_cast<int>(sizeof(symbols)) ? QLatin1Char(symbols[record.type]) : QLatin1Char('?'))
+            .arg(QString::fromLatin1(record.file))
+            .arg(record.line)
+            .arg(record.message);
+}
+
+int AppLogModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return _count;
+}
+
+QVariant AppLogModel::data(const QModelIndex& index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= _count) {
+        return QVariant();
+    }
+    return formatRecord(_records[(_first + index.row()) % maxRows]);
+}
+
+void AppLogModel::_flushPending(void)
+{
+    // Clear before draining so records pushed while we drain schedule another flush
+    _flushScheduled.store(0);
+    flush();
+}
+
+void AppLogModel::flush(void)
+{
+    QVector<AppLogRecord> batch;
+    AppLogRecord record;
+    while (_ring.pop(record)) {
+        batch.append(record);
+    }
+
+    int dropped = _droppedCount.load();
+    if (dropped != _lastReportedDropped) {
+        _lastReportedDropped = dropped;
+        emit droppedCountChanged(dropped);
+    }
+
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    // Only the tail of an oversized batch can ever be visible
+    int batchStart = qMax(0, batch.count() - maxRows);
+    int batchCount = batch.count() - batchStart;
+
+    int removeCount = qMax(0, _count + batchCount - maxRows);
+    if (removeCount > 0) {
+        beginRemoveRows(QModelIndex(), 0, removeCount - 1);
+        _first = (_first + removeCount) % maxRows;
+        _count -= removeCount;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), _count, _count + batchCount - 1);
+    for (int i = batchStart; i < batch.count(); i++) {
+        _records[(_first + _count) % maxRows] = batch[i];
+        _count++;
+    }
+    endInsertRows();
+
+    _openLogFile();
+    if (_logFile.isOpen()) {
+        QTextStream out(&_logFile);
+        for (int i = 0; i < batch.count(); i++) {
+            out << formatRecord(batch[i]) << "\n";
+        }
+        out.flush();
+        _logFile.flush();
+    }
+}
+
+void AppLogModel::_openLogFile(void)
+{
     if (qgcApp() && qgcApp()->logOutput() && _logFile.fileName().isEmpty()) {
-        qDebug() << _logFile.fileName().isEmpty() << qgcApp()->logOutput();
         QGCToolbox* toolbox = qgcApp()->toolbox();
         // Be careful of toolbox not being open yet
         if (toolbox) {
@@ -107,10 +247,31 @@ void AppLogModel::threadsafeLog(const QString message)
             }
         }
     }
+}
 
-    if (_logFile.isOpen()) {
-        QTextStream out(&_logFile);
-        out << message << "\n";
-        _logFile.flush();
+void AppLogModel::writeMessages(const QString dest_file)
+{
+    flush();
+
+    // Snapshot is cheap since the message strings are implicitly shared. Formatting happens on the worker.
+    QVector<AppLogRecord> records;
+    records.reserve(_count);
+    for (int i = 0; i < _count; i++) {
+        records.append(_records[(_first + i) % maxRows]);
     }
+
+    emit writeStarted();
+    QtConcurrent::run([dest_file, records] {
+        bool success = false;
+        QFile file(dest_file);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream out(&file);
+            for (int i = 0; i < records.count(); i++) {
+                out << AppLogModel::formatRecord(records[i]) << '\n';
+            }
+            out.flush();
+            success = out.status() == QTextStream::Ok;
+        }
+        emit debug_model->writeFinished(success);
+    });
 }
@@ -11,32 +11,106 @@
 #pragma once
 
 #include <QObject>
-#include <QStringListModel>
+#include <QAbstractListModel>
+#include <QAtomicInteger>
+#include <QVector>
 #include <QUrl>
 #include <QFile>
+#include <QByteArray>
 
 // Hackish way to force only this translation unit to have public ctor access
 #ifndef _LOG_CTOR_ACCESS_
 #define _LOG_CTOR_ACCESS_ private
 #endif
 
-class AppLogModel : public QStringListModel
+/// Raw log record as captured by the message handler. Formatting is deferred until the record
+/// is displayed or written out.
+struct AppLogRecord
+{
+    QtMsgType   type;
+    QByteArray  category;   ///< Copied from QMessageLogContext, which only lives for the duration of the handler call
+    QByteArray  file;       ///< Copied from QMessageLogContext
+    int         line;
+    qint64      msecs;      ///< Capture time, msecs since epoch
+    QString     message;
+};
+
+Q_DECLARE_TYPEINFO(AppLogRecord, Q_MOVABLE_TYPE);
+
+/// Fixed capacity, lock-free, multi-producer/single-consumer ring of log records. Producers can be
+/// on any thread. The consumer is always the thread AppLogModel lives on.
+class AppLogRing
+{
+public:
+    AppLogRing(void);
+    ~AppLogRing();
+
+    static const quint32 capacity = 4096;   ///< Must be power of 2
+
+    /// Thread safe. Returns false if the ring is full, record is dropped.
+    bool push(const AppLogRecord& record);
+
+    /// Single consumer only
+    bool pop(AppLogRecord& record);
+
+private:
+    struct Cell {
+        QAtomicInteger<quint32> sequence;
+        AppLogRecord            record;
+    };
+
+    static const quint32 _mask = capacity - 1;
+
+    Cell*                   _cells;
+    QAtomicInteger<quint32> _enqueuePos;
+    quint32                 _dequeuePos;
+};
+
+class AppLogModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
+    Q_PROPERTY(int droppedCount READ droppedCount NOTIFY droppedCountChanged)
+
     Q_INVOKABLE void writeMessages(const QString dest_file);
-    static void log(const QString message);
+
+    /// Thread safe. Captures the record without formatting it.
+    static void log(QtMsgType type, const QMessageLogContext& context, const QString& message);
+
+    /// Moves all pending records from the ring into the model. Normally called automatically
+    /// from the event loop.
+    void flush(void);
+
+    int droppedCount(void) const { return _droppedCount.load(); }
+
+    /// Formats a record the same way it is displayed and written to file
+    static QString formatRecord(const AppLogRecord& record);
+
+    static const int maxRows = 10000;   ///< Number of most recent records available from the model
+
+    // Overrides from QAbstractListModel
+    int         rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant    data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
 
 signals:
-    void emitLog(const QString message);
     void writeStarted();
     void writeFinished(bool success);
+    void droppedCountChanged(int droppedCount);
 
 private slots:
-    void threadsafeLog(const QString message);
+    void _flushPending(void);
 
 private:
-    QFile _logFile;
+    void _openLogFile(void);
+
+    AppLogRing              _ring;
+    QAtomicInt              _flushScheduled;
+    QAtomicInt              _droppedCount;
+    int                     _lastReportedDropped;
+    QVector<AppLogRecord>   _records;   ///< Circular window of most recent records, maxRows in size
+    int                     _first;     ///< Index into _records of oldest record
+    int                     _count;     ///< Number of valid records in _records
+    QFile                   _logFile;
 
 _LOG_CTOR_ACCESS_:
     AppLogModel();
@@ -87,7 +87,7 @@ QGCView {
             Connections {
                 target: debugMessageModel
 
-                onDataChanged: {
+                onRowsInserted: {
                     // Keep the view in sync if the button is checked
                     if (loaded) {
                         if (followTail.checked) {
@@ -182,6 +182,37 @@ QGCView {
                 visible:        !writeButton.enabled
             }
 
+            QGCFileDialog {
+                id:             traceDialog
+                folder:         QGroundControl.settingsManager.appSettings.logSavePath
+                nameFilters:    [qsTr("Trace files (*.json)"), qsTr("All Files (*)")]
+                selectExisting: false
+                title:          qsTr("Select trace save file")
+                qgcView:        _qgcView
+                onAcceptedForSave: {
+                    QGroundControl.writeTrace(file);
+                    visible = false;
+                }
+            }
+
+            FactCheckBox {
+                id:                     traceCheckBox
+                anchors.baseline:       writeButton.baseline
+                anchors.left:           writeBusy.right
+                anchors.leftMargin:     ScreenTools.defaultFontPixelWidth
+                text:                   qsTr("Record trace")
+                fact:                   QGroundControl.settingsManager.appSettings.tracing
+            }
+
+            QGCButton {
+                anchors.bottom:         parent.bottom
+                anchors.left:           traceCheckBox.right
+                anchors.leftMargin:     ScreenTools.defaultFontPixelWidth
+                text:                   qsTr("Save Trace")
+                enabled:                traceCheckBox.checked
+                onClicked:              traceDialog.openForSave()
+            }
+
             QGCButton {
                 id:                     followTail
                 anchors.right:          filterButton.left
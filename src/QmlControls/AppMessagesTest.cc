@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "AppMessagesTest.h"
+#include "AppMessages.h"
+
+#include <QtConcurrent>
+
+AppMessagesTest::AppMessagesTest(void)
+{
+
+}
+
+static AppLogRecord _record(int line)
+{
+    AppLogRecord record;
+    record.type     = QtDebugMsg;
+    record.category = "test";
+    record.file     = __FILE__;
+    record.line     = line;
+    record.msecs    = 0;
+    record.message  = QStringLiteral("message %1").arg(line);
+    return record;
+}
+
+void AppMessagesTest::_testRingOrderAndOverflow(void)
+{
+    AppLogRing ring;
+    AppLogRecord record;
+
+    QVERIFY(!ring.pop(record));
+
+    for (quint32 i = 0; i < AppLogRing::capacity; i++) {
+        QVERIFY(ring.push(_record(i)));
+    }
+    QVERIFY(!ring.push(_record(-1)));
+
+    for (quint32 i = 0; i < AppLogRing::capacity; i++) {
+        QVERIFY(ring.pop(record));
+        QCOMPARE(record.line, static_cast<int>(i));
+    }
+    QVERIFY(!ring.pop(record));
+
+    // Wrap around
+    QVERIFY(ring.push(_record(42)));
+    QVERIFY(ring.pop(record));
+    QCOMPARE(record.line, 42);
+}
+
+void AppMessagesTest::_testRingMultiProducer(void)
+{
+    const int cProducers = 4;
+    const int cPerProducer = 1000;
+
+    AppLogRing ring;
+    QAtomicInt pushFailures(0);
+    QList<QFuture<void>> producers;
+    for (int producer = 0; producer < cProducers; producer++) {
+        producers.append(QtConcurrent::run([&ring, &pushFailures, producer, cPerProducer] {
+            for (int i = 0; i < cPerProducer; i++) {
+                if (!ring.push(_record(producer * cPerProducer + i))) {
+                    pushFailures.fetchAndAddRelaxed(1);
+                }
+            }
+        }));
+    }
+
+    // Drain concurrently with the producers, each producer's records must come out in order. A failed push means
+    // its record never shows up, so draining stops once the producers are done and the ring is empty.
+    QVector<int> lastSeen(cProducers, -1);
+    int received = 0;
+    AppLogRecord record;
+    while (received < cProducers * cPerProducer) {
+        bool producersFinished = true;
+        for (int i = 0; i < producers.count(); i++) {
+            producersFinished &= producers[i].isFinished();
+        }
+        if (ring.pop(record)) {
+            int producer = record.line / cPerProducer;
+            QVERIFY(record.line > lastSeen[producer]);
+            lastSeen[producer] = record.line;
+            received++;
+        } else if (producersFinished) {
+            break;
+        }
+    }
+    for (int i = 0; i < producers.count(); i++) {
+        producers[i].waitForFinished();
+    }
+    QCOMPARE(pushFailures.load(), 0);
+    QCOMPARE(received, cProducers * cPerProducer);
+    QVERIFY(!ring.pop(record));
+}
+
+void AppMessagesTest::_testModelWindow(void)
+{
+    AppLogModel* model = AppMessages::getModel();
+    QMessageLogContext context(__FILE__, __LINE__, Q_FUNC_INFO, "test");
+
+    model->flush();
+
+    const int cTotal = AppLogModel::maxRows + 1000;
+    for (int i = 0; i < cTotal; i++) {
+        AppLogModel::log(QtDebugMsg, context, QStringLiteral("window %1").arg(i));
+        if (i % 1000 == 0) {
+            model->flush();
+        }
+    }
+    model->flush();
+
+    QCOMPARE(model->rowCount(), static_cast<int>(AppLogModel::maxRows));
+    QVERIFY(model->data(model->index(model->rowCount() - 1)).toString().contains(QStringLiteral("\"window %1\"").arg(cTotal - 1)));
+    QVERIFY(model->data(model->index(0)).toString().contains(QStringLiteral("\"window %1\"").arg(cTotal - AppLogModel::maxRows)));
+}
+
+void AppMessagesTest::_benchmarkLog(void)
+{
+    AppLogModel* model = AppMessages::getModel();
+    QMessageLogContext context(__FILE__, __LINE__, Q_FUNC_INFO, "test");
+    const QString message(QStringLiteral("benchmark message"));
+
+    // Result is for 1000 calls to log plus a single flush into the model. Divide by 1000 for the per call cost.
+    model->flush();
+    QBENCHMARK {
+        for (int i = 0; i < 1000; i++) {
+            AppLogModel::log(QtDebugMsg, context, message);
+        }
+        model->flush();
+    }
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class AppMessagesTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    AppMessagesTest(void);
+
+private slots:
+    void _testRingOrderAndOverflow(void);
+    void _testRingMultiProducer(void);
+    void _testModelWindow(void);
+    void _benchmarkLog(void);
+};
@@ -24,6 +24,7 @@
 #endif
 
 #include <QStandardPaths>
+#include <QSet>
 
 /// @Brief Constructs a new ParameterEditorController Widget. This widget is used within the PX4VehicleConfig set of screens.
 ParameterEditorController::ParameterEditorController(void)
@@ -41,10 +42,14 @@ ParameterEditorController::ParameterEditorController(void)
     if (categoryMap.contains(_currentCategory) && categoryMap[_currentCategory].size() != 0) {
         _currentGroup = categoryMap[_currentCategory].keys()[0];
     }
+    if (_vehicle->parameterManager()->parametersReady()) {
+        _searchIndex.update(_vehicle->parameterManager(), _vehicle->defaultComponentId());
+    }
     _updateParameters();
 
     connect(this, &ParameterEditorController::searchTextChanged, this, &ParameterEditorController::_updateParameters);
     connect(this, &ParameterEditorController::currentGroupChanged, this, &ParameterEditorController::_updateParameters);
+    connect(_vehicle->parameterManager(), &ParameterManager::parametersReadyChanged, this, &ParameterEditorController::_parametersReadyChanged);
 }
 
 ParameterEditorController::~ParameterEditorController()
@@ -69,22 +74,12 @@ QStringList ParameterEditorController::getParametersForGroup(const QString& cate
 QStringList ParameterEditorController::searchParameters(const QString& searchText, bool searchInName, bool searchInDescriptions)
 {
     QStringList list;
-    
-    foreach(const QString &paramName, _vehicle->parameterManager()->parameterNames(_vehicle->defaultComponentId())) {
-        if (searchText.isEmpty()) {
-            list += paramName;
-        } else {
-            Fact* fact = _vehicle->parameterManager()->getParameter(_vehicle->defaultComponentId(), paramName);
-            
-            if (searchInName && fact->name().contains(searchText, Qt::CaseInsensitive)) {
-                list += paramName;
-            } else if (searchInDescriptions && (fact->shortDescription().contains(searchText, Qt::CaseInsensitive) || fact->longDescription().contains(searchText, Qt::CaseInsensitive))) {
-                list += paramName;
-            }
-        }
+
+    foreach (Fact* fact, _searchIndex.search(searchText, searchInName, searchInDescriptions)) {
+        list += fact->name();
     }
     list.sort();
-    
+
     return list;
 }
 
@@ -164,31 +159,63 @@ void ParameterEditorController::setRCToParam(const QString& paramName)
 void ParameterEditorController::_updateParameters(void)
 {
     QObjectList newParameterList;
-    QStringList searchItems = _searchText.split(' ', QString::SkipEmptyParts);
 
-    if (searchItems.isEmpty()) {
+    if (_searchText.trimmed().isEmpty()) {
         const QMap<QString, QMap<QString, QStringList> >& categoryMap = _vehicle->parameterManager()->getCategoryMap();
         foreach (const QString& parameter, categoryMap[_currentCategory][_currentGroup]) {
             newParameterList.append(_vehicle->parameterManager()->getParameter(_vehicle->defaultComponentId(), parameter));
         }
     } else {
-        foreach(const QString &parameter, _vehicle->parameterManager()->parameterNames(_vehicle->defaultComponentId())) {
-            Fact* fact = _vehicle->parameterManager()->getParameter(_vehicle->defaultComponentId(), parameter);
-            bool matched = true;
-
-            // all of the search items must match in order for the parameter to be added to the list
-            for (const auto& searchItem : searchItems) {
-                if (!fact->name().contains(searchItem, Qt::CaseInsensitive) &&
-                        !fact->shortDescription().contains(searchItem, Qt::CaseInsensitive) &&
-                        !fact->longDescription().contains(searchItem, Qt::CaseInsensitive)) {
-                    matched = false;
-                }
-            }
-            if (matched) {
-                newParameterList.append(fact);
-            }
+        // all of the search items must match in order for the parameter to be added to the list
+        foreach (Fact* fact, _searchIndex.search(_searchText)) {
+            newParameterList.append(fact);
+        }
+    }
+
+    _applyParameterList(newParameterList);
+}
+
+void ParameterEditorController::_parametersReadyChanged(bool parametersReady)
+{
+    if (parametersReady) {
+        _searchIndex.update(_vehicle->parameterManager(), _vehicle->defaultComponentId());
+        _updateParameters();
+    }
+}
+
+/// Turns the current list into the new one with row inserts and removes, so the view keeps its
+/// delegates and scroll position while typing. Lists which have little in common are swapped.
+void ParameterEditorController::_applyParameterList(const QObjectList& newParameterList)
+{
+    QSet<QObject*> newSet = newParameterList.toSet();
+    int kept = 0;
+    for (int i = 0; i < _parameters->count(); i++) {
+        if (newSet.contains((*_parameters)[i])) {
+            kept++;
         }
     }
+    int inserts = newParameterList.count() - kept;
+    int removes = _parameters->count() - kept;
+    if (inserts + removes > kept) {
+        _parameters->swapObjectList(newParameterList);
+        return;
+    }
 
-    _parameters->swapObjectList(newParameterList);
+    for (int i = _parameters->count() - 1; i >= 0; i--) {
+        if (!newSet.contains((*_parameters)[i])) {
+            _parameters->removeAt(i);
+        }
+    }
+    for (int i = 0; i < newParameterList.count(); i++) {
+        QObject* object = newParameterList[i];
+        if (i < _parameters->count() && (*_parameters)[i] == object) {
+            continue;
+        }
+        // Ranking moved it, take it out further down the list
+        int current = _parameters->indexOf(object);
+        if (current > i) {
+            _parameters->removeAt(current);
+        }
+        _parameters->insert(i, object);
+    }
 }
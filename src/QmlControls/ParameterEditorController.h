@@ -21,6 +21,7 @@
 #include "UASInterface.h"
 #include "FactPanelController.h"
 #include "QmlObjectListModel.h"
+#include "ParameterSearchIndex.h"
 
 class ParameterEditorController : public FactPanelController
 {
@@ -57,8 +58,12 @@ signals:
 
 private slots:
     void _updateParameters(void);
+    void _parametersReadyChanged(bool parametersReady);
 
 private:
+    void _applyParameterList(const QObjectList& newParameterList);
+
+    ParameterSearchIndex _searchIndex;
     QStringList         _categories;
     QString             _searchText;
     QString             _currentCategory;
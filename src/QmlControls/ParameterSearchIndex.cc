@@ -0,0 +1,233 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterSearchIndex.h"
+#include "ParameterManager.h"
+#include "Fact.h"
+
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+
+ParameterSearchIndex::ParameterSearchIndex(void)
+    : _lastSearchInName(true)
+    , _lastSearchInDescriptions(true)
+{
+
+}
+
+void ParameterSearchIndex::clear(void)
+{
+    _entries.clear();
+    _tokens.clear();
+    _resetLastSearch();
+}
+
+QString ParameterSearchIndex::_description(Fact* fact)
+{
+    return (fact->shortDescription() + QLatin1Char('\n') + fact->longDescription()).toCaseFolded();
+}
+
+void ParameterSearchIndex::update(ParameterManager* parameterManager, int componentId)
+{
+    QList<Fact*> facts;
+    foreach (const QString& name, parameterManager->parameterNames(componentId)) {
+        facts.append(parameterManager->getParameter(componentId, name));
+    }
+    update(facts);
+}
+
+void ParameterSearchIndex::update(const QList<Fact*>& facts)
+{
+    QHash<QString, Fact*> current;
+    foreach (Fact* fact, facts) {
+        current.insert(fact->name(), fact);
+    }
+    QSet<Fact*> indexed;
+    bool changed = false;
+
+    // Drop parameters which are gone, were replaced or got new descriptions, for example from metadata loaded later
+    QVector<Entry> kept;
+    kept.reserve(facts.count());
+    for (int i = 0; i < _entries.count(); i++) {
+        Fact* fact = _entries[i].fact;
+        if (current.value(fact->name()) == fact && _description(fact) == _entries[i].description) {
+            kept.append(_entries[i]);
+            indexed.insert(fact);
+        } else {
+            changed = true;
+        }
+    }
+    _entries.swap(kept);
+
+    foreach (Fact* fact, current) {
+        if (indexed.contains(fact)) {
+            continue;
+        }
+        Entry entry;
+        entry.fact          = fact;
+        entry.name          = fact->name().toCaseFolded();
+        entry.description   = _description(fact);
+        _entries.append(entry);
+        changed = true;
+    }
+
+    if (changed) {
+        std::sort(_entries.begin(), _entries.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+        _rebuildTokens();
+        _resetLastSearch();
+    }
+}
+
+void ParameterSearchIndex::_rebuildTokens(void)
+{
+    _tokens.clear();
+    for (int i = 0; i < _entries.count(); i++) {
+        _addTokens(i, _entries[i].name, true);
+        _addTokens(i, _entries[i].description, false);
+    }
+    std::sort(_tokens.begin(), _tokens.end());
+    _tokenRank.resize(_entries.count());
+}
+
+/// Words are runs of letters and digits, so MOT_THR_MAX gives mot, thr and max
+void ParameterSearchIndex::_addTokens(int entry, const QString& text, bool inName)
+{
+    const QChar* chars = text.constData();
+    int length = text.length();
+    int start = -1;
+    for (int i = 0; i <= length; i++) {
+        bool wordChar = i < length && chars[i].isLetterOrNumber();
+        if (wordChar && start < 0) {
+            start = i;
+        } else if (!wordChar && start >= 0) {
+            Token token;
+            token.text      = text.mid(start, i - start);
+            token.entry     = entry;
+            token.inName    = inName;
+            _tokens.append(token);
+            start = -1;
+        }
+    }
+}
+
+/// Finds the best token match per entry with a binary search for the first word starting with term
+void ParameterSearchIndex::_rankTokens(const QString& term, bool searchInName, bool searchInDescriptions)
+{
+    _tokenRank.fill(NoMatch);
+
+    Token key;
+    key.text = term;
+    QVector<Token>::const_iterator it = std::lower_bound(_tokens.constBegin(), _tokens.constEnd(), key);
+    for (; it != _tokens.constEnd() && it->text.startsWith(term); ++it) {
+        if (it->inName ? !searchInName : !searchInDescriptions) {
+            continue;
+        }
+        quint8 rank = it->inName ? NameToken : DescriptionToken;
+        if (rank < _tokenRank[it->entry]) {
+            _tokenRank[it->entry] = rank;
+        }
+    }
+}
+
+/// Cheap checks first, the descriptions are only scanned if no word of them starts with term
+ParameterSearchIndex::MatchRank ParameterSearchIndex::_rank(int entry, const QString& term, bool searchInName, bool searchInDescriptions) const
+{
+    const Entry& e = _entries[entry];
+    if (searchInName) {
+        if (e.name.startsWith(term)) {
+            return NamePrefix;
+        }
+        if (_tokenRank[entry] == NameToken) {
+            return NameToken;
+        }
+        if (e.name.contains(term)) {
+            return NameSubstring;
+        }
+    }
+    if (searchInDescriptions) {
+        if (_tokenRank[entry] == DescriptionToken) {
+            return DescriptionToken;
+        }
+        if (e.description.contains(term)) {
+            return DescriptionSubstring;
+        }
+    }
+    return NoMatch;
+}
+
+QList<Fact*> ParameterSearchIndex::search(const QString& searchText, bool searchInName, bool searchInDescriptions)
+{
+    QList<Fact*> results;
+    QStringList terms = searchText.toCaseFolded().split(QLatin1Char(' '), QString::SkipEmptyParts);
+
+    if (terms.isEmpty()) {
+        _resetLastSearch();
+        results.reserve(_entries.count());
+        for (int i = 0; i < _entries.count(); i++) {
+            results.append(_entries[i].fact);
+        }
+        return results;
+    }
+
+    // Every match of the new search also matched the previous one if the text was only extended
+    QVector<int> candidates;
+    if (!_lastSearch.isEmpty() && searchText.startsWith(_lastSearch) &&
+            searchInName == _lastSearchInName && searchInDescriptions == _lastSearchInDescriptions) {
+        candidates = _lastMatches;
+    } else {
+        candidates.resize(_entries.count());
+        for (int i = 0; i < candidates.count(); i++) {
+            candidates[i] = i;
+        }
+    }
+
+    // All terms have to match, the ranks of the terms add up
+    QVector<int> scores(candidates.count(), 0);
+    foreach (const QString& term, terms) {
+        _rankTokens(term, searchInName, searchInDescriptions);
+        int kept = 0;
+        for (int i = 0; i < candidates.count(); i++) {
+            MatchRank rank = _rank(candidates[i], term, searchInName, searchInDescriptions);
+            if (rank == NoMatch) {
+                continue;
+            }
+            candidates[kept] = candidates[i];
+            scores[kept] = scores[i] + rank;
+            kept++;
+        }
+        candidates.resize(kept);
+        scores.resize(kept);
+    }
+
+    _lastSearch                 = searchText;
+    _lastSearchInName           = searchInName;
+    _lastSearchInDescriptions   = searchInDescriptions;
+    _lastMatches                = candidates;
+
+    // Entries are sorted by name, so the entry index breaks ties by name
+    QVector<QPair<int, int>> ranked(candidates.count());
+    for (int i = 0; i < candidates.count(); i++) {
+        ranked[i] = qMakePair(scores[i], candidates[i]);
+    }
+    std::sort(ranked.begin(), ranked.end());
+
+    results.reserve(ranked.count());
+    for (int i = 0; i < ranked.count(); i++) {
+        results.append(_entries[ranked[i].second].fact);
+    }
+    return results;
+}
+
+void ParameterSearchIndex::_resetLastSearch(void)
+{
+    _lastSearch.clear();
+    _lastMatches.clear();
+}
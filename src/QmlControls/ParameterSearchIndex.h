@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class Fact;
+class ParameterManager;
+
+/// Search index over the names and descriptions of the parameters of one component. Text is case
+/// folded once when a parameter is indexed, words are kept in a sorted token list for prefix lookups.
+class ParameterSearchIndex
+{
+public:
+    ParameterSearchIndex(void);
+
+    /// How well a search term matched a parameter, lower is better
+    enum MatchRank {
+        NamePrefix = 0,         ///< Name starts with the term
+        NameToken,              ///< A word of the name (split at '_') starts with the term
+        NameSubstring,          ///< Term is somewhere in the name
+        DescriptionToken,       ///< A word of the descriptions starts with the term
+        DescriptionSubstring,   ///< Term is somewhere in the descriptions
+        NoMatch
+    };
+
+    /// Indexes parameters which are new since the last update and drops the ones which are gone
+    void update(ParameterManager* parameterManager, int componentId);
+
+    /// Same as above with the parameters given directly. Parameters whose Fact was replaced or whose
+    /// descriptions changed are indexed again.
+    void update(const QList<Fact*>& facts);
+
+    void clear(void);
+
+    int count(void) const { return _entries.count(); }
+
+    /// Parameters matching all space separated terms of searchText, best matches first and by name
+    /// within a rank. A search extending the previous one (typing on) only looks at its matches.
+    QList<Fact*> search(const QString& searchText, bool searchInName = true, bool searchInDescriptions = true);
+
+private:
+    struct Entry {
+        Fact*   fact;
+        QString name;           ///< Case folded
+        QString description;    ///< Case folded short and long description
+    };
+
+    struct Token {
+        QString text;
+        int     entry;
+        bool    inName;
+        bool operator<(const Token& other) const { return text < other.text; }
+    };
+
+    static QString _description     (Fact* fact);
+    void        _rebuildTokens      (void);
+    void        _addTokens          (int entry, const QString& text, bool inName);
+    void        _rankTokens         (const QString& term, bool searchInName, bool searchInDescriptions);
+    MatchRank   _rank               (int entry, const QString& term, bool searchInName, bool searchInDescriptions) const;
+    void        _resetLastSearch    (void);
+
+    QVector<Entry>      _entries;           ///< Sorted by name
+    QVector<Token>      _tokens;            ///< Sorted by text
+
+    QVector<quint8>     _tokenRank;         ///< Scratch, best token rank per entry for the current term
+
+    QString             _lastSearch;
+    bool                _lastSearchInName;
+    bool                _lastSearchInDescriptions;
+    QVector<int>        _lastMatches;
+};
@@ -0,0 +1,163 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterSearchIndexTest.h"
+#include "ParameterSearchIndex.h"
+#include "Fact.h"
+
+ParameterSearchIndexTest::ParameterSearchIndexTest(void)
+{
+
+}
+
+void ParameterSearchIndexTest::init(void)
+{
+    UnitTest::init();
+
+    // One parameter for each rank of "thr", and one which does not match
+    _facts << _fact("THR_MIN",          "Minimum throttle");                                        // NamePrefix
+    _facts << _fact("MOT_THR_MAX",      "Maximum motor output");                                    // NameToken
+    _facts << _fact("MPC_THR_HOVER",    "Hover thrust");                                            // NameToken
+    _facts << _fact("RC_MAP_THROTTLE",  "Throttle channel mapping");                                // NameToken
+    _facts << _fact("COM_ARM_ATHRESH",  "Arming acceleration limit");                               // NameSubstring
+    _facts << _fact("BAT_CAPACITY",     "Battery capacity", "Scales the throttle compensation");    // DescriptionToken
+    _facts << _fact("FW_AUTO",          "Enable autothrottle");                                     // DescriptionSubstring
+    _facts << _fact("GPS_DELAY",        "GPS delay");
+}
+
+void ParameterSearchIndexTest::cleanup(void)
+{
+    qDeleteAll(_facts);
+    _facts.clear();
+
+    UnitTest::cleanup();
+}
+
+Fact* ParameterSearchIndexTest::_fact(const QString& name, const QString& shortDescription, const QString& longDescription)
+{
+    Fact* fact = new Fact(1, name, FactMetaData::valueTypeFloat);
+
+    FactMetaData* metaData = new FactMetaData(FactMetaData::valueTypeFloat, fact);
+    metaData->setShortDescription(shortDescription);
+    metaData->setLongDescription(longDescription);
+    fact->setMetaData(metaData);
+
+    return fact;
+}
+
+void ParameterSearchIndexTest::_setDescription(Fact* fact, const QString& shortDescription)
+{
+    FactMetaData* metaData = new FactMetaData(FactMetaData::valueTypeFloat, fact);
+    metaData->setShortDescription(shortDescription);
+    fact->setMetaData(metaData);
+}
+
+QStringList ParameterSearchIndexTest::_names(const QList<Fact*>& facts)
+{
+    QStringList names;
+    foreach (Fact* fact, facts) {
+        names.append(fact->name());
+    }
+    return names;
+}
+
+void ParameterSearchIndexTest::_testRankOrder(void)
+{
+    ParameterSearchIndex index;
+    index.update(_facts);
+    QCOMPARE(index.count(), _facts.count());
+
+    // Best rank first, by name within a rank. Case does not matter.
+    QStringList expected;
+    expected << "THR_MIN" << "MOT_THR_MAX" << "MPC_THR_HOVER" << "RC_MAP_THROTTLE" << "COM_ARM_ATHRESH" << "BAT_CAPACITY" << "FW_AUTO";
+    QCOMPARE(_names(index.search("thr")), expected);
+    QCOMPARE(_names(index.search("THR")), expected);
+
+    // Names only and descriptions only
+    QCOMPARE(_names(index.search("thr", true, false)), expected.mid(0, 5));
+    QCOMPARE(_names(index.search("thr", false, true)), QStringList() << "BAT_CAPACITY" << "MPC_THR_HOVER" << "RC_MAP_THROTTLE" << "THR_MIN" << "FW_AUTO");
+
+    // No search text gives everything by name
+    QStringList all = _names(index.search(QString()));
+    QCOMPARE(all.count(), _facts.count());
+    QCOMPARE(all.first(), QStringLiteral("BAT_CAPACITY"));
+    QCOMPARE(all.last(), QStringLiteral("THR_MIN"));
+}
+
+void ParameterSearchIndexTest::_testMultipleTerms(void)
+{
+    ParameterSearchIndex index;
+    index.update(_facts);
+
+    // Every term has to match, ranks add up
+    QCOMPARE(_names(index.search("thr max")), QStringList() << "MOT_THR_MAX");
+    QCOMPARE(_names(index.search("thr hover")), QStringList() << "MPC_THR_HOVER");
+    QCOMPARE(_names(index.search("throttle channel")), QStringList() << "RC_MAP_THROTTLE");
+    QCOMPARE(_names(index.search("thr  gps")), QStringList());
+}
+
+void ParameterSearchIndexTest::_testIncrementalSearch(void)
+{
+    ParameterSearchIndex index;
+    index.update(_facts);
+
+    // Typing on narrows the previous matches, which has to give the same result as searching from scratch
+    QStringList steps;
+    steps << "t" << "th" << "thr" << "thro" << "throt" << "throttle" << "throttle " << "throttle c";
+    foreach (const QString& step, steps) {
+        ParameterSearchIndex fresh;
+        fresh.update(_facts);
+        QCOMPARE(_names(index.search(step)), _names(fresh.search(step)));
+    }
+    QCOMPARE(_names(index.search("thro")).count(), 4);
+
+    // Deleting characters widens the search again
+    QCOMPARE(_names(index.search("thr")).count(), 7);
+
+    // So does a different term
+    QCOMPARE(_names(index.search("gps")), QStringList() << "GPS_DELAY");
+}
+
+void ParameterSearchIndexTest::_testUpdate(void)
+{
+    ParameterSearchIndex index;
+    index.update(_facts);
+    QCOMPARE(index.search("thr").count(), 7);
+
+    // An added parameter shows up, also in a search extending the previous one
+    _facts << _fact("THR_MDL_FAC", "Thrust to motor control model");
+    index.update(_facts);
+    QCOMPARE(index.count(), _facts.count());
+    QCOMPARE(_names(index.search("thr_")), QStringList() << "THR_MDL_FAC" << "THR_MIN" << "MOT_THR_MAX" << "MPC_THR_HOVER");
+
+    // Changed descriptions are indexed again
+    _setDescription(_facts[6], "Enable airspeed-less flight");
+    _setDescription(_facts[7], "Delay of the throttle response");
+    index.update(_facts);
+    QStringList names = _names(index.search("thr"));
+    QVERIFY(!names.contains("FW_AUTO"));
+    QVERIFY(names.contains("GPS_DELAY"));
+    QCOMPARE(_names(index.search("airspeed")), QStringList() << "FW_AUTO");
+
+    // A replaced parameter is indexed with its new Fact
+    Fact* replaced = _facts.takeAt(0);
+    _facts << _fact("THR_MIN", "Idle output");
+    index.update(_facts);
+    QList<Fact*> results = index.search("idle");
+    QCOMPARE(results.count(), 1);
+    QCOMPARE(results[0], _facts.last());
+    QVERIFY(!index.search("thr").contains(replaced));
+    delete replaced;
+
+    // A removed parameter is gone
+    delete _facts.takeLast();
+    index.update(_facts);
+    QCOMPARE(index.count(), _facts.count());
+    QVERIFY(!_names(index.search("thr")).contains("THR_MIN"));
+}
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class Fact;
+
+class ParameterSearchIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterSearchIndexTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _testRankOrder(void);
+    void _testMultipleTerms(void);
+    void _testIncrementalSearch(void);
+    void _testUpdate(void);
+
+private:
+    Fact*       _fact           (const QString& name, const QString& shortDescription, const QString& longDescription = QString());
+    void        _setDescription (Fact* fact, const QString& shortDescription);
+    QStringList _names          (const QList<Fact*>& facts);
+
+    QList<Fact*> _facts;
+};
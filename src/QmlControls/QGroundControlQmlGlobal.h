@@ -22,6 +22,7 @@
 #include "FactMetaData.h"
 #include "SimulatedPosition.h"
 #include "QGCLoggingCategory.h"
+#include "QGCTracer.h"
 #include "AppSettings.h"
 #ifndef __mobile__
 #include "GPS/GPSManager.h"
@@ -131,6 +132,9 @@ public:
     /// Updates the logging filter rules after settings have changed
     Q_INVOKABLE void updateLoggingFilterRules(void) { QGCLoggingCategoryRegister::instance()->setFilterRulesFromSettings(QString()); }
 
+    /// Writes the performance trace recorded since tracing was turned on. Tracing keeps running.
+    Q_INVOKABLE bool writeTrace(const QString& file) { return QGCTracer::writeTrace(file); }
+
     Q_INVOKABLE bool linesIntersect(QPointF xLine1, QPointF yLine1, QPointF xLine2, QPointF yLine2);
 
     // Property accesors
@@ -18,6 +18,7 @@
 
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTracer.h"
 
 #include <QVariant>
 #include <QtSql/QSqlQuery>
@@ -241,6 +242,7 @@ QGCCacheWorker::_getDefaultTileSet()
 void
 QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_saveTile");
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
         QSqlQuery query(*_db);
@@ -273,6 +275,7 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 void
 QGCCacheWorker::_getTile(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_getTile");
     if(!_testTask(mtask)) {
         return;
     }
@@ -301,6 +304,7 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
 void
 QGCCacheWorker::_getTileSets(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_getTileSets");
     if(!_testTask(mtask)) {
         return;
     }
@@ -394,6 +398,7 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
 void
 QGCCacheWorker::_updateTotals()
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_updateTotals");
     QSqlQuery query(*_db);
     QString s;
     s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
@@ -434,6 +439,7 @@ quint64 QGCCacheWorker::_findTile(const QString hash)
 void
 QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_createTileSet");
     if(_valid) {
         //-- Create Tile Set
         quint32 actual_count = 0;
@@ -515,6 +521,7 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
 void
 QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_getTileDownloadList");
     if(!_testTask(mtask)) {
         return;
     }
@@ -546,6 +553,7 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
 void
 QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_updateTileDownloadState");
     if(!_testTask(mtask)) {
         return;
     }
@@ -570,6 +578,7 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
 void
 QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_pruneCache");
     if(!_testTask(mtask)) {
         return;
     }
@@ -600,6 +609,7 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
 void
 QGCCacheWorker::_deleteTileSet(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_deleteTileSet");
     if(!_testTask(mtask)) {
         return;
     }
@@ -630,6 +640,7 @@ QGCCacheWorker::_deleteTileSet(qulonglong id)
 void
 QGCCacheWorker::_renameTileSet(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_renameTileSet");
     if(!_testTask(mtask)) {
         return;
     }
@@ -646,6 +657,7 @@ QGCCacheWorker::_renameTileSet(QGCMapTask* mtask)
 void
 QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_resetCacheDatabase");
     if(!_testTask(mtask)) {
         return;
     }
@@ -668,6 +680,7 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
 void
 QGCCacheWorker::_importSets(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_importSets");
     if(!_testTask(mtask)) {
         return;
     }
@@ -855,6 +868,7 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
 void
 QGCCacheWorker::_exportSets(QGCMapTask* mtask)
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_exportSets");
     if(!_testTask(mtask)) {
         return;
     }
@@ -974,6 +988,7 @@ bool QGCCacheWorker::_testTask(QGCMapTask* mtask)
 bool
 QGCCacheWorker::_init()
 {
+    QGC_TRACE_SCOPE("tilecache", "QGCCacheWorker::_init");
     _failed = false;
     if(!_databasePath.isEmpty()) {
         qCDebug(QGCTileCacheLog) << "Mapping cache directory:" << _databasePath;
@@ -10,6 +10,7 @@
 #include "AppSettings.h"
 #include "QGCPalette.h"
 #include "QGCApplication.h"
+#include "QGCTracer.h"
 
 #include <QQmlEngine>
 #include <QtQml>
@@ -26,6 +27,7 @@ const char* AppSettings::offlineEditingAscentSpeedSettingsName =        "Offline
 const char* AppSettings::offlineEditingDescentSpeedSettingsName =       "OfflineEditingDescentSpeed";
 const char* AppSettings::batteryPercentRemainingAnnounceSettingsName =  "batteryPercentRemainingAnnounce";
 const char* AppSettings::defaultMissionItemAltitudeSettingsName =       "DefaultMissionItemAltitude";
+const char* AppSettings::kmlImportSimplifyToleranceName =               "KMLImportSimplifyTolerance";
 const char* AppSettings::telemetrySaveName =                            "PromptFLightDataSave";
 const char* AppSettings::telemetrySaveNotArmedName =                    "PromptFLightDataSaveNotArmed";
 const char* AppSettings::audioMutedName =                               "AudioMuted";
@@ -41,6 +43,7 @@ const char* AppSettings::mapboxTokenName =                              "MapboxT
 const char* AppSettings::esriTokenName =                                "EsriToken";
 const char* AppSettings::defaultFirmwareTypeName =                      "DefaultFirmwareType";
 const char* AppSettings::gstDebugName =                                 "GstreamerDebugLevel";
+const char* AppSettings::tracingName =                                  "Tracing";
 const char* AppSettings::followTargetName =                             "FollowTarget";
 
 const char* AppSettings::parameterFileExtension =   "params";
@@ -51,6 +54,7 @@ const char* AppSettings::fenceFileExtension =       "fence";
 const char* AppSettings::rallyPointFileExtension =  "rally";
 const char* AppSettings::telemetryFileExtension =   "tlog";
 const char* AppSettings::kmlFileExtension =         "kml";
+const char* AppSettings::kmzFileExtension =         "kmz";
 const char* AppSettings::logFileExtension =         "ulg";
 
 const char* AppSettings::parameterDirectory =       "Parameters";
@@ -70,6 +74,7 @@ AppSettings::AppSettings(QObject* parent)
     , _offlineEditingDescentSpeedFact       (NULL)
     , _batteryPercentRemainingAnnounceFact  (NULL)
     , _defaultMissionItemAltitudeFact       (NULL)
+    , _kmlImportSimplifyToleranceFact       (NULL)
     , _telemetrySaveFact                    (NULL)
     , _telemetrySaveNotArmedFact            (NULL)
     , _audioMutedFact                       (NULL)
@@ -85,11 +90,13 @@ AppSettings::AppSettings(QObject* parent)
     , _esriTokenFact                        (NULL)
     , _defaultFirmwareTypeFact              (NULL)
     , _gstDebugFact                         (NULL)
+    , _tracingFact                          (NULL)
     , _followTargetFact                     (NULL)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     qmlRegisterUncreatableType<AppSettings>("QGroundControl.SettingsManager", 1, 0, "AppSettings", "Reference only");
     QGCPalette::setGlobalTheme(indoorPalette()->rawValue().toBool() ? QGCPalette::Dark : QGCPalette::Light);
+    _tracingChanged();
 
     // Instantiate savePath so we can check for override and setup default path if needed
 
@@ -199,6 +206,15 @@ Fact* AppSettings::defaultMissionItemAltitude(void)
     return _defaultMissionItemAltitudeFact;
 }
 
+Fact* AppSettings::kmlImportSimplifyTolerance(void)
+{
+    if (!_kmlImportSimplifyToleranceFact) {
+        _kmlImportSimplifyToleranceFact = _createSettingsFact(kmlImportSimplifyToleranceName);
+    }
+
+    return _kmlImportSimplifyToleranceFact;
+}
+
 Fact* AppSettings::telemetrySave(void)
 {
     if (!_telemetrySaveFact) {
@@ -271,6 +287,21 @@ Fact* AppSettings::gstDebug(void)
     return _gstDebugFact;
 }
 
+Fact* AppSettings::tracing(void)
+{
+    if (!_tracingFact) {
+        _tracingFact = _createSettingsFact(tracingName);
+        connect(_tracingFact, &Fact::rawValueChanged, this, &AppSettings::_tracingChanged);
+    }
+
+    return _tracingFact;
+}
+
+void AppSettings::_tracingChanged(void)
+{
+    QGCTracer::setEnabled(QGCTracer::SourceSettings, tracing()->rawValue().toBool());
+}
+
 Fact* AppSettings::indoorPalette(void)
 {
     if (!_indoorPaletteFact) {
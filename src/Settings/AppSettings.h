@@ -28,6 +28,7 @@ public:
     Q_PROPERTY(Fact* offlineEditingDescentSpeed         READ offlineEditingDescentSpeed         CONSTANT)
     Q_PROPERTY(Fact* batteryPercentRemainingAnnounce    READ batteryPercentRemainingAnnounce    CONSTANT)
     Q_PROPERTY(Fact* defaultMissionItemAltitude         READ defaultMissionItemAltitude         CONSTANT)
+    Q_PROPERTY(Fact* kmlImportSimplifyTolerance         READ kmlImportSimplifyTolerance         CONSTANT)
     Q_PROPERTY(Fact* telemetrySave                      READ telemetrySave                      CONSTANT)
     Q_PROPERTY(Fact* telemetrySaveNotArmed              READ telemetrySaveNotArmed              CONSTANT)
     Q_PROPERTY(Fact* audioMuted                         READ audioMuted                         CONSTANT)
@@ -43,6 +44,7 @@ public:
     Q_PROPERTY(Fact* esriToken                          READ esriToken                          CONSTANT)
     Q_PROPERTY(Fact* defaultFirmwareType                READ defaultFirmwareType                CONSTANT)
     Q_PROPERTY(Fact* gstDebug                           READ gstDebug                           CONSTANT)
+    Q_PROPERTY(Fact* tracing                            READ tracing                            CONSTANT)
     Q_PROPERTY(Fact* followTarget                       READ followTarget                       CONSTANT)
 
     Q_PROPERTY(QString missionSavePath      READ missionSavePath    NOTIFY savePathsChanged)
@@ -58,6 +60,7 @@ public:
     Q_PROPERTY(QString parameterFileExtension   MEMBER parameterFileExtension   CONSTANT)
     Q_PROPERTY(QString telemetryFileExtension   MEMBER telemetryFileExtension   CONSTANT)
     Q_PROPERTY(QString kmlFileExtension         MEMBER kmlFileExtension         CONSTANT)
+    Q_PROPERTY(QString kmzFileExtension         MEMBER kmzFileExtension         CONSTANT)
     Q_PROPERTY(QString logFileExtension         MEMBER logFileExtension         CONSTANT)
 
     Fact* offlineEditingFirmwareType        (void);
@@ -68,6 +71,7 @@ public:
     Fact* offlineEditingDescentSpeed        (void);
     Fact* batteryPercentRemainingAnnounce   (void);
     Fact* defaultMissionItemAltitude        (void);
+    Fact* kmlImportSimplifyTolerance        (void);
     Fact* telemetrySave                     (void);
     Fact* telemetrySaveNotArmed             (void);
     Fact* audioMuted                        (void);
@@ -83,6 +87,7 @@ public:
     Fact* esriToken                         (void);
     Fact* defaultFirmwareType               (void);
     Fact* gstDebug                          (void);
+    Fact* tracing                           (void);
     Fact* followTarget                      (void);
 
     QString missionSavePath     (void);
@@ -106,6 +111,7 @@ public:
     static const char* offlineEditingDescentSpeedSettingsName;
     static const char* batteryPercentRemainingAnnounceSettingsName;
     static const char* defaultMissionItemAltitudeSettingsName;
+    static const char* kmlImportSimplifyToleranceName;
     static const char* telemetrySaveName;
     static const char* telemetrySaveNotArmedName;
     static const char* audioMutedName;
@@ -121,6 +127,7 @@ public:
     static const char* esriTokenName;
     static const char* defaultFirmwareTypeName;
     static const char* gstDebugName;
+    static const char* tracingName;
     static const char* followTargetName;
 
     // Application wide file extensions
@@ -132,6 +139,7 @@ public:
     static const char* rallyPointFileExtension;
     static const char* telemetryFileExtension;
     static const char* kmlFileExtension;
+    static const char* kmzFileExtension;
     static const char* logFileExtension;
 
     // Child directories of savePath for specific file types
@@ -147,6 +155,7 @@ signals:
 
 private slots:
     void _indoorPaletteChanged(void);
+    void _tracingChanged(void);
     void _checkSavePathDirectories(void);
 
 private:
@@ -158,6 +167,7 @@ private:
     SettingsFact* _offlineEditingDescentSpeedFact;
     SettingsFact* _batteryPercentRemainingAnnounceFact;
     SettingsFact* _defaultMissionItemAltitudeFact;
+    SettingsFact* _kmlImportSimplifyToleranceFact;
     SettingsFact* _telemetrySaveFact;
     SettingsFact* _telemetrySaveNotArmedFact;
     SettingsFact* _audioMutedFact;
@@ -173,6 +183,7 @@ private:
     SettingsFact* _esriTokenFact;
     SettingsFact* _defaultFirmwareTypeFact;
     SettingsFact* _gstDebugFact;
+    SettingsFact* _tracingFact;
     SettingsFact* _followTargetFact;
 };
 
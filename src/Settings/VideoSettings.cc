@@ -22,6 +22,9 @@ const char* VideoSettings::settingsGroup =          ""; // settings are in root
 
 const char* VideoSettings::videoSourceName =        "VideoSource";
 const char* VideoSettings::jitterBufferName =       "JitterBuffer";
+const char* VideoSettings::poolSizeName =           "VideoPoolSize";
+const char* VideoSettings::leakyQueueName =         "VideoLeakyQueue";
+const char* VideoSettings::decoderThreadsName =     "VideoDecoderThreads";
 const char* VideoSettings::udpPortName =            "VideoUDPPort";
 const char* VideoSettings::rtspUrlName =            "VideoRTSPUrl";
 const char* VideoSettings::tcpUrlName =             "VideoTCPUrl";
@@ -29,6 +32,8 @@ const char* VideoSettings::videoAspectRatioName =   "VideoAspectRatio";
 const char* VideoSettings::videoGridLinesName =     "VideoGridLines";
 const char* VideoSettings::showRecControlName =     "ShowRecControl";
 const char* VideoSettings::recordingFormatName =    "RecordingFormat";
+const char* VideoSettings::recordingPreRollName =   "RecordingPreRoll";
+const char* VideoSettings::recordingSegmentDurationName = "RecordingSegmentDuration";
 const char* VideoSettings::maxVideoSizeName =       "MaxVideoSize";
 const char* VideoSettings::enableStorageLimitName = "EnableStorageLimit";
 const char* VideoSettings::rtspTimeoutName =        "RtspTimeout";
@@ -45,6 +50,9 @@ VideoSettings::VideoSettings(QObject* parent)
     : SettingsGroup(name, settingsGroup, parent)
     , _videoSourceFact(NULL)
     , _jitterBufferFact(NULL)
+    , _poolSizeFact(NULL)
+    , _leakyQueueFact(NULL)
+    , _decoderThreadsFact(NULL)
     , _udpPortFact(NULL)
     , _tcpUrlFact(NULL)
     , _rtspUrlFact(NULL)
@@ -52,6 +60,8 @@ VideoSettings::VideoSettings(QObject* parent)
     , _gridLinesFact(NULL)
     , _showRecControlFact(NULL)
     , _recordingFormatFact(NULL)
+    , _recordingPreRollFact(NULL)
+    , _recordingSegmentDurationFact(NULL)
     , _maxVideoSizeFact(NULL)
     , _enableStorageLimitFact(NULL)
     , _rtspTimeoutFact(NULL)
@@ -124,6 +134,30 @@ Fact* VideoSettings::jitterBuffer(void)
     return _jitterBufferFact;
 }
 
+Fact* VideoSettings::poolSize(void)
+{
+    if (!_poolSizeFact) {
+        _poolSizeFact = _createSettingsFact(poolSizeName);
+    }
+    return _poolSizeFact;
+}
+
+Fact* VideoSettings::leakyQueue(void)
+{
+    if (!_leakyQueueFact) {
+        _leakyQueueFact = _createSettingsFact(leakyQueueName);
+    }
+    return _leakyQueueFact;
+}
+
+Fact* VideoSettings::decoderThreads(void)
+{
+    if (!_decoderThreadsFact) {
+        _decoderThreadsFact = _createSettingsFact(decoderThreadsName);
+    }
+    return _decoderThreadsFact;
+}
+
 Fact* VideoSettings::rtspUrl(void)
 {
     if (!_rtspUrlFact) {
@@ -174,6 +208,22 @@ Fact* VideoSettings::recordingFormat(void)
     return _recordingFormatFact;
 }
 
+Fact* VideoSettings::recordingPreRoll(void)
+{
+    if (!_recordingPreRollFact) {
+        _recordingPreRollFact = _createSettingsFact(recordingPreRollName);
+    }
+    return _recordingPreRollFact;
+}
+
+Fact* VideoSettings::recordingSegmentDuration(void)
+{
+    if (!_recordingSegmentDurationFact) {
+        _recordingSegmentDurationFact = _createSettingsFact(recordingSegmentDurationName);
+    }
+    return _recordingSegmentDurationFact;
+}
+
 Fact* VideoSettings::maxVideoSize(void)
 {
     if (!_maxVideoSizeFact) {
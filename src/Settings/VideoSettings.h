@@ -21,6 +21,9 @@ public:
 
     Q_PROPERTY(Fact* videoSource            READ videoSource            CONSTANT)
     Q_PROPERTY(Fact* jitterBuffer           READ jitterBuffer           CONSTANT)
+    Q_PROPERTY(Fact* poolSize               READ poolSize               CONSTANT)
+    Q_PROPERTY(Fact* leakyQueue             READ leakyQueue             CONSTANT)
+    Q_PROPERTY(Fact* decoderThreads         READ decoderThreads         CONSTANT)
     Q_PROPERTY(Fact* udpPort                READ udpPort                CONSTANT)
     Q_PROPERTY(Fact* tcpUrl                 READ tcpUrl                 CONSTANT)
     Q_PROPERTY(Fact* rtspUrl                READ rtspUrl                CONSTANT)
@@ -28,6 +31,8 @@ public:
     Q_PROPERTY(Fact* gridLines              READ gridLines              CONSTANT)
     Q_PROPERTY(Fact* showRecControl         READ showRecControl         CONSTANT)
     Q_PROPERTY(Fact* recordingFormat        READ recordingFormat        CONSTANT)
+    Q_PROPERTY(Fact* recordingPreRoll       READ recordingPreRoll       CONSTANT)
+    Q_PROPERTY(Fact* recordingSegmentDuration READ recordingSegmentDuration CONSTANT)
     Q_PROPERTY(Fact* maxVideoSize           READ maxVideoSize           CONSTANT)
     Q_PROPERTY(Fact* enableStorageLimit     READ enableStorageLimit     CONSTANT)
     Q_PROPERTY(Fact* rtspTimeout            READ rtspTimeout            CONSTANT)
@@ -37,6 +42,9 @@ public:
 
     Fact* videoSource           (void);
     Fact* jitterBuffer          (void);
+    Fact* poolSize              (void);
+    Fact* leakyQueue            (void);
+    Fact* decoderThreads        (void);
     Fact* udpPort               (void);
     Fact* rtspUrl               (void);
     Fact* tcpUrl                (void);
@@ -44,6 +52,8 @@ public:
     Fact* gridLines             (void);
     Fact* showRecControl        (void);
     Fact* recordingFormat       (void);
+    Fact* recordingPreRoll      (void);
+    Fact* recordingSegmentDuration (void);
     Fact* maxVideoSize          (void);
     Fact* enableStorageLimit    (void);
     Fact* rtspTimeout           (void);
@@ -56,6 +66,9 @@ public:
 
     static const char* videoSourceName;
     static const char* jitterBufferName;
+    static const char* poolSizeName;
+    static const char* leakyQueueName;
+    static const char* decoderThreadsName;
     static const char* udpPortName;
     static const char* rtspUrlName;
     static const char* tcpUrlName;
@@ -63,6 +76,8 @@ public:
     static const char* videoGridLinesName;
     static const char* showRecControlName;
     static const char* recordingFormatName;
+    static const char* recordingPreRollName;
+    static const char* recordingSegmentDurationName;
     static const char* maxVideoSizeName;
     static const char* enableStorageLimitName;
     static const char* rtspTimeoutName;
@@ -84,6 +99,9 @@ private slots:
 private:
     SettingsFact* _videoSourceFact;
     SettingsFact* _jitterBufferFact;
+    SettingsFact* _poolSizeFact;
+    SettingsFact* _leakyQueueFact;
+    SettingsFact* _decoderThreadsFact;
     SettingsFact* _udpPortFact;
     SettingsFact* _tcpUrlFact;
     SettingsFact* _rtspUrlFact;
@@ -91,6 +109,8 @@ private:
     SettingsFact* _gridLinesFact;
     SettingsFact* _showRecControlFact;
     SettingsFact* _recordingFormatFact;
+    SettingsFact* _recordingPreRollFact;
+    SettingsFact* _recordingSegmentDurationFact;
     SettingsFact* _maxVideoSizeFact;
     SettingsFact* _enableStorageLimitFact;
     SettingsFact* _rtspTimeoutFact;
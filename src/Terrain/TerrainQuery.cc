@@ -11,6 +11,7 @@
 #include "QGCMapEngine.h"
 #include "QGeoMapReplyQGC.h"
 #include "QGCApplication.h"
+#include "QGCTracer.h"
 
 #include <QUrl>
 #include <QUrlQuery>
@@ -154,6 +155,7 @@ void TerrainAirMapQuery::_sslErrors(const QList<QSslError> &errors)
 
 void TerrainAirMapQuery::_requestFinished(void)
 {
+    QGC_TRACE_SCOPE("terrain", "TerrainAirMapQuery::_requestFinished");
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
 
     if (reply->error() != QNetworkReply::NoError) {
@@ -335,6 +337,7 @@ TerrainTileManager::TerrainTileManager(void)
 
 void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates)
 {
+    QGC_TRACE_SCOPE("terrain", "TerrainTileManager::addCoordinateQuery");
     qCDebug(TerrainQueryLog) << "TerrainTileManager::addCoordinateQuery count" << coordinates.count();
 
     if (coordinates.length() > 0) {
@@ -361,6 +364,7 @@ void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQu
 
 void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint)
 {
+    QGC_TRACE_SCOPE("terrain", "TerrainTileManager::addPathQuery");
     // Convert to individual coordinate queries
     QList<QGeoCoordinate> coordinates;
     double lat = startPoint.latitude();
@@ -402,6 +406,7 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
 /// @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
 bool TerrainTileManager::_getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error)
 {
+    QGC_TRACE_SCOPE("terrain", "TerrainTileManager::_getAltitudesForCoordinates");
     error = false;
 
     foreach (const QGeoCoordinate& coordinate, coordinates) {
@@ -463,6 +468,7 @@ void TerrainTileManager::_tileFailed(void)
 
 void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error)
 {
+    QGC_TRACE_SCOPE("terrain", "TerrainTileManager::_terrainDone");
     QGeoTiledMapReplyQGC* reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
     _state = State::Idle;
 
@@ -566,6 +572,7 @@ void TerrainAtCoordinateBatchManager::addQuery(TerrainAtCoordinateQuery* terrain
 
 void TerrainAtCoordinateBatchManager::_sendNextBatch(void)
 {
+    QGC_TRACE_SCOPE("terrain", "TerrainAtCoordinateBatchManager::_sendNextBatch");
     qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch _state:_requestQueue.count:_sentRequests.count" << _stateToString(_state) << _requestQueue.count() << _sentRequests.count();
 
     if (_state != State::Idle) {
@@ -12,7 +12,7 @@
 #include <QDebug>
 #include <QtMath>
 
-ADSBVehicle::ADSBVehicle(mavlink_adsb_vehicle_t& adsbVehicle, QObject* parent)
+ADSBVehicle::ADSBVehicle(const mavlink_adsb_vehicle_t& adsbVehicle, QObject* parent)
     : QObject       (parent)
     , _icaoAddress  (adsbVehicle.ICAO_address)
     , _callsign     (adsbVehicle.callsign)
@@ -27,7 +27,7 @@ ADSBVehicle::ADSBVehicle(mavlink_adsb_vehicle_t& adsbVehicle, QObject* parent)
     update(adsbVehicle);
 }
 
-void ADSBVehicle::update(mavlink_adsb_vehicle_t& adsbVehicle)
+void ADSBVehicle::update(const mavlink_adsb_vehicle_t& adsbVehicle)
 {
     if (_icaoAddress != adsbVehicle.ICAO_address) {
         qWarning() << "ICAO address mismatch expected:actual" << _icaoAddress << adsbVehicle.ICAO_address;
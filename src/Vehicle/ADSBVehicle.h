@@ -19,7 +19,7 @@ class ADSBVehicle : public QObject
     Q_OBJECT
 
 public:
-    ADSBVehicle(mavlink_adsb_vehicle_t& adsbVehicle, QObject* parent = NULL);
+    ADSBVehicle(const mavlink_adsb_vehicle_t& adsbVehicle, QObject* parent = NULL);
 
     Q_PROPERTY(int              icaoAddress READ icaoAddress    CONSTANT)
     Q_PROPERTY(QString          callsign    READ callsign       NOTIFY callsignChanged)
@@ -34,7 +34,7 @@ public:
     double          heading     (void) const { return _heading; }
 
     /// Update the vehicle with new information
-    void update(mavlink_adsb_vehicle_t& adsbVehicle);
+    void update(const mavlink_adsb_vehicle_t& adsbVehicle);
 
 signals:
     void coordinateChanged(QGeoCoordinate coordinate);
@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcher.h"
+
+void MAVLinkMessageDispatcher::add(uint32_t msgId, std::function<void(LinkInterface*, const mavlink_message_t&)> handler)
+{
+    _addHandler(_entries[msgId], [handler](LinkInterface* link, const mavlink_message_t& message, const void*) {
+        handler(link, message);
+    });
+}
+
+void MAVLinkMessageDispatcher::_addHandler(Entry_t& entry, const HandlerFunc_t& handler)
+{
+    entry.handlers.append(handler);
+    if (!_late) {
+        entry.lateIndex = entry.handlers.count();
+    }
+}
+
+bool MAVLinkMessageDispatcher::dispatch(LinkInterface* link, const mavlink_message_t& message, const std::function<void()>& beforeLate) const
+{
+    QHash<uint32_t, Entry_t>::const_iterator iter = _entries.constFind(message.msgid);
+    if (iter == _entries.constEnd()) {
+        if (beforeLate) {
+            beforeLate();
+        }
+        return false;
+    }
+
+    // The buffer is on the stack so a handler can dispatch another message. The handler list is copied (which is
+    // cheap since it is shared) so a handler can also register new handlers.
+    quint64 decoded[(_decodeBufferBytes + sizeof(quint64) - 1) / sizeof(quint64)];
+    QList<HandlerFunc_t> handlers = iter->handlers;
+    int lateIndex = iter->lateIndex;
+
+    if (iter->decoder) {
+        iter->decoder(message, decoded);
+    }
+    for (int i=0; i<handlers.count(); i++) {
+        if (i == lateIndex && beforeLate) {
+            beforeLate();
+        }
+        handlers[i](link, message, decoded);
+    }
+    if (lateIndex == handlers.count() && beforeLate) {
+        beforeLate();
+    }
+
+    return true;
+}
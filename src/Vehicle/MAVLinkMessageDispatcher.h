@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+
+#include <QHash>
+#include <QList>
+
+#include <functional>
+
+class LinkInterface;
+
+/// Hands incoming messages to the handlers registered for their message id, decoding each message only once.
+///
+/// Handlers are registered together with the generated mavlink_msg_*_decode function for their message. When a
+/// message is dispatched it is decoded into a stack buffer and every handler for the message id gets the same
+/// decoded struct, in the order the handlers were registered. All handlers of a message id must use the same
+/// decode function. Handlers which only pass the message on can be registered without a decode function, a message
+/// which only has those is not decoded at all. Handlers may dispatch further messages or register new handlers while
+/// being called.
+///
+/// Handlers registered after beginLateHandlers() run after the callback passed to dispatch(), so that something else
+/// can see the message in between without the message being decoded again.
+class MAVLinkMessageDispatcher
+{
+    // Lets the decoded type come from the decoder alone so lambdas can be passed as handlers
+    template <class U> struct _NonDeduced { typedef U type; };
+
+public:
+    MAVLinkMessageDispatcher(void) : _late(false) { }
+
+    template <class T> using Decoder = void (*)(const mavlink_message_t*, T*);
+    template <class T> using Handler = std::function<void(LinkInterface*, const mavlink_message_t&, const T&)>;
+
+    /// Registers a handler which gets the link, the message and the decoded struct
+    template <class T>
+    void add(uint32_t msgId, Decoder<T> decoder, typename _NonDeduced<Handler<T>>::type handler)
+    {
+        static_assert(sizeof(T) <= _decodeBufferBytes, "Decoded message does not fit the decode buffer");
+
+        Entry_t& entry = _entries[msgId];
+        if (!entry.decodedSize) {
+            entry.decoder = [decoder](const mavlink_message_t& message, void* buffer) { decoder(&message, static_cast<T*>(buffer)); };
+            entry.decodedSize = sizeof(T);
+        }
+        Q_ASSERT(entry.decodedSize == sizeof(T));
+        _addHandler(entry, [handler](LinkInterface* link, const mavlink_message_t& message, const void* decoded) {
+            handler(link, message, *static_cast<const T*>(decoded));
+        });
+    }
+
+    /// Registers a member function which only needs the decoded struct
+    template <class T, class O>
+    void add(uint32_t msgId, Decoder<T> decoder, O* object, void (O::*handler)(const T&))
+    {
+        add<T>(msgId, decoder, [object, handler](LinkInterface*, const mavlink_message_t&, const T& decoded) { (object->*handler)(decoded); });
+    }
+
+    /// Registers a member function which also needs the message header
+    template <class T, class O>
+    void add(uint32_t msgId, Decoder<T> decoder, O* object, void (O::*handler)(const mavlink_message_t&, const T&))
+    {
+        add<T>(msgId, decoder, [object, handler](LinkInterface*, const mavlink_message_t& message, const T& decoded) { (object->*handler)(message, decoded); });
+    }
+
+    /// Registers a member function which also needs the link and the message header
+    template <class T, class O>
+    void add(uint32_t msgId, Decoder<T> decoder, O* object, void (O::*handler)(LinkInterface*, const mavlink_message_t&, const T&))
+    {
+        add<T>(msgId, decoder, [object, handler](LinkInterface* link, const mavlink_message_t& message, const T& decoded) { (object->*handler)(link, message, decoded); });
+    }
+
+    /// Registers a handler which works on the message itself
+    void add(uint32_t msgId, std::function<void(LinkInterface*, const mavlink_message_t&)> handler);
+
+    /// Handlers registered from now on are late handlers
+    void beginLateHandlers(void) { _late = true; }
+
+    /// Decodes the message once and calls its handlers
+    ///     @param beforeLate Called after the handlers registered before beginLateHandlers() and before the late
+    ///                       handlers, whether the message has handlers or not
+    ///     @return false: no handlers for the message id
+    bool dispatch(LinkInterface* link, const mavlink_message_t& message, const std::function<void()>& beforeLate = std::function<void()>()) const;
+
+    /// @return true: there are handlers for the message id
+    bool contains(uint32_t msgId) const { return _entries.contains(msgId); }
+
+private:
+    typedef std::function<void(const mavlink_message_t&, void*)>                        DecodeFunc_t;
+    typedef std::function<void(LinkInterface*, const mavlink_message_t&, const void*)>  HandlerFunc_t;
+
+    struct Entry_t {
+        Entry_t(void) : decodedSize(0), lateIndex(0) { }
+
+        DecodeFunc_t            decoder;        ///< Empty if no handler needs the decoded struct
+        size_t                  decodedSize;
+        QList<HandlerFunc_t>    handlers;       ///< Handlers, late handlers last
+        int                     lateIndex;      ///< Index of the first late handler
+    };
+
+    void _addHandler(Entry_t& entry, const HandlerFunc_t& handler);
+
+    QHash<uint32_t, Entry_t>    _entries;
+    bool                        _late;
+
+    static const size_t _decodeBufferBytes = MAVLINK_MAX_PAYLOAD_LEN;
+};
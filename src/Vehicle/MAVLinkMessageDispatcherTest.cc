@@ -0,0 +1,378 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcherTest.h"
+#include "MAVLinkMessageDispatcher.h"
+
+namespace {
+
+int _attitudeDecodeCount = 0;
+
+void _countingAttitudeDecode(const mavlink_message_t* message, mavlink_attitude_t* attitude)
+{
+    _attitudeDecodeCount++;
+    mavlink_msg_attitude_decode(message, attitude);
+}
+
+mavlink_message_t _attitudeMessage(float roll)
+{
+    mavlink_attitude_t attitude;
+    mavlink_message_t message;
+
+    memset(&attitude, 0, sizeof(attitude));
+    attitude.roll = roll;
+    mavlink_msg_attitude_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+    return message;
+}
+
+mavlink_message_t _heartbeatMessage(uint32_t customMode)
+{
+    mavlink_heartbeat_t heartbeat;
+    mavlink_message_t message;
+
+    memset(&heartbeat, 0, sizeof(heartbeat));
+    heartbeat.custom_mode = customMode;
+    mavlink_msg_heartbeat_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &heartbeat);
+    return message;
+}
+
+}
+
+void MAVLinkMessageDispatcherTest::_testDecodeOnce(void)
+{
+    MAVLinkMessageDispatcher dispatcher;
+    QList<float> rolls;
+
+    _attitudeDecodeCount = 0;
+    for (int i=0; i<3; i++) {
+        dispatcher.add<mavlink_attitude_t>(MAVLINK_MSG_ID_ATTITUDE, _countingAttitudeDecode, [&rolls](LinkInterface*, const mavlink_message_t&, const mavlink_attitude_t& attitude) {
+            rolls.append(attitude.roll);
+        });
+    }
+
+    QVERIFY(dispatcher.dispatch(NULL, _attitudeMessage(0.5f)));
+    QCOMPARE(_attitudeDecodeCount, 1);
+    QCOMPARE(rolls, QList<float>() << 0.5f << 0.5f << 0.5f);
+}
+
+void MAVLinkMessageDispatcherTest::_testHandlerOrder(void)
+{
+    MAVLinkMessageDispatcher dispatcher;
+    QList<int> calls;
+
+    for (int i=0; i<5; i++) {
+        dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode, [&calls, i](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t&) {
+            calls.append(i);
+        });
+    }
+
+    dispatcher.dispatch(NULL, _heartbeatMessage(0));
+    QCOMPARE(calls, QList<int>() << 0 << 1 << 2 << 3 << 4);
+}
+
+void MAVLinkMessageDispatcherTest::_testUnknownMessage(void)
+{
+    MAVLinkMessageDispatcher dispatcher;
+    bool called = false;
+
+    dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode, [&called](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t&) {
+        called = true;
+    });
+
+    QVERIFY(dispatcher.contains(MAVLINK_MSG_ID_HEARTBEAT));
+    QVERIFY(!dispatcher.contains(MAVLINK_MSG_ID_ATTITUDE));
+    QVERIFY(!dispatcher.dispatch(NULL, _attitudeMessage(0.5f)));
+    QVERIFY(!called);
+}
+
+void MAVLinkMessageDispatcherTest::_testRawHandler(void)
+{
+    MAVLinkMessageDispatcher dispatcher;
+    QList<int> calls;
+
+    // A message with only raw handlers is never decoded
+    _attitudeDecodeCount = 0;
+    dispatcher.add(MAVLINK_MSG_ID_ATTITUDE, [&calls](LinkInterface*, const mavlink_message_t& message) {
+        QCOMPARE(message.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_ATTITUDE));
+        calls.append(0);
+    });
+    QVERIFY(dispatcher.dispatch(NULL, _attitudeMessage(0.5f)));
+    QCOMPARE(calls, QList<int>() << 0);
+
+    // Adding a decoded handler later decodes for that handler only
+    dispatcher.add<mavlink_attitude_t>(MAVLINK_MSG_ID_ATTITUDE, _countingAttitudeDecode, [&calls](LinkInterface*, const mavlink_message_t&, const mavlink_attitude_t& attitude) {
+        QCOMPARE(attitude.roll, 0.25f);
+        calls.append(1);
+    });
+    calls.clear();
+    QVERIFY(dispatcher.dispatch(NULL, _attitudeMessage(0.25f)));
+    QCOMPARE(calls, QList<int>() << 0 << 1);
+    QCOMPARE(_attitudeDecodeCount, 1);
+}
+
+void MAVLinkMessageDispatcherTest::_testNestedDispatch(void)
+{
+    MAVLinkMessageDispatcher dispatcher;
+    QList<uint32_t> customModes;
+    float roll = 0;
+
+    // The first heartbeat handler dispatches an attitude message, the second must still see the heartbeat
+    dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode, [&dispatcher, &customModes](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t& heartbeat) {
+        customModes.append(heartbeat.custom_mode);
+        dispatcher.dispatch(NULL, _attitudeMessage(1.5f));
+    });
+    dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode, [&customModes](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t& heartbeat) {
+        customModes.append(heartbeat.custom_mode);
+    });
+    dispatcher.add<mavlink_attitude_t>(MAVLINK_MSG_ID_ATTITUDE, mavlink_msg_attitude_decode, [&roll](LinkInterface*, const mavlink_message_t&, const mavlink_attitude_t& attitude) {
+        roll = attitude.roll;
+    });
+
+    QVERIFY(dispatcher.dispatch(NULL, _heartbeatMessage(42)));
+    QCOMPARE(customModes, QList<uint32_t>() << 42 << 42);
+    QCOMPARE(roll, 1.5f);
+}
+
+QList<mavlink_message_t> MAVLinkMessageDispatcherTest::_telemetryMix(void)
+{
+    QList<mavlink_message_t> messages;
+    mavlink_message_t message;
+
+    mavlink_heartbeat_t heartbeat;
+    memset(&heartbeat, 0, sizeof(heartbeat));
+    mavlink_msg_heartbeat_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &heartbeat);
+    messages.append(message);
+
+    mavlink_sys_status_t sysStatus;
+    memset(&sysStatus, 0, sizeof(sysStatus));
+    sysStatus.voltage_battery = 12600;
+    mavlink_msg_sys_status_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &sysStatus);
+    messages.append(message);
+
+    mavlink_attitude_t attitude;
+    memset(&attitude, 0, sizeof(attitude));
+    attitude.roll = 0.1f;
+    mavlink_msg_attitude_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+    messages.append(message);
+
+    mavlink_attitude_target_t attitudeTarget;
+    memset(&attitudeTarget, 0, sizeof(attitudeTarget));
+    attitudeTarget.q[0] = 1.0f;
+    mavlink_msg_attitude_target_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &attitudeTarget);
+    messages.append(message);
+
+    mavlink_global_position_int_t globalPosition;
+    memset(&globalPosition, 0, sizeof(globalPosition));
+    globalPosition.lat = 473977420;
+    mavlink_msg_global_position_int_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &globalPosition);
+    messages.append(message);
+
+    mavlink_gps_raw_int_t gpsRaw;
+    memset(&gpsRaw, 0, sizeof(gpsRaw));
+    gpsRaw.satellites_visible = 12;
+    mavlink_msg_gps_raw_int_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &gpsRaw);
+    messages.append(message);
+
+    mavlink_vfr_hud_t vfrHud;
+    memset(&vfrHud, 0, sizeof(vfrHud));
+    vfrHud.groundspeed = 5.0f;
+    mavlink_msg_vfr_hud_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &vfrHud);
+    messages.append(message);
+
+    mavlink_statustext_t statusText;
+    memset(&statusText, 0, sizeof(statusText));
+    strncpy(statusText.text, "Benchmark", MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
+    mavlink_msg_statustext_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &statusText);
+    messages.append(message);
+
+    // Attitude and position are streamed at a higher rate than the rest
+    QList<mavlink_message_t> mix;
+    for (int i=0; i<10; i++) {
+        mix << messages << messages[2] << messages[3] << messages[4];
+    }
+    return mix;
+}
+
+// Decodes the way the Vehicle message switch used to
+void MAVLinkMessageDispatcherTest::_vehicleConsumer(const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    {
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        _sink += heartbeat.custom_mode;
+    }
+        break;
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink_sys_status_t sysStatus;
+        mavlink_msg_sys_status_decode(&message, &sysStatus);
+        _sink += sysStatus.voltage_battery;
+    }
+        break;
+    case MAVLINK_MSG_ID_ATTITUDE:
+    {
+        mavlink_attitude_t attitude;
+        mavlink_msg_attitude_decode(&message, &attitude);
+        _sink += attitude.roll;
+    }
+        break;
+    case MAVLINK_MSG_ID_ATTITUDE_TARGET:
+    {
+        mavlink_attitude_target_t attitudeTarget;
+        mavlink_msg_attitude_target_decode(&message, &attitudeTarget);
+        _sink += attitudeTarget.q[0];
+    }
+        break;
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    {
+        mavlink_global_position_int_t globalPosition;
+        mavlink_msg_global_position_int_decode(&message, &globalPosition);
+        _sink += globalPosition.lat;
+    }
+        break;
+    case MAVLINK_MSG_ID_GPS_RAW_INT:
+    {
+        mavlink_gps_raw_int_t gpsRaw;
+        mavlink_msg_gps_raw_int_decode(&message, &gpsRaw);
+        _sink += gpsRaw.satellites_visible;
+    }
+        break;
+    case MAVLINK_MSG_ID_VFR_HUD:
+    {
+        mavlink_vfr_hud_t vfrHud;
+        mavlink_msg_vfr_hud_decode(&message, &vfrHud);
+        _sink += vfrHud.groundspeed;
+    }
+        break;
+    }
+}
+
+// Decodes the way UAS::receiveMessage used to, for the messages both it and the vehicle handle
+void MAVLinkMessageDispatcherTest::_uasConsumer(const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    {
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        _sink += heartbeat.base_mode;
+    }
+        break;
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink_sys_status_t sysStatus;
+        mavlink_msg_sys_status_decode(&message, &sysStatus);
+        _sink += sysStatus.load;
+    }
+        break;
+    case MAVLINK_MSG_ID_ATTITUDE_TARGET:
+    {
+        mavlink_attitude_target_t attitudeTarget;
+        mavlink_msg_attitude_target_decode(&message, &attitudeTarget);
+        _sink += attitudeTarget.q[1];
+    }
+        break;
+    case MAVLINK_MSG_ID_STATUSTEXT:
+    {
+        mavlink_statustext_t statusText;
+        mavlink_msg_statustext_decode(&message, &statusText);
+        _sink += statusText.severity;
+    }
+        break;
+    }
+}
+
+void MAVLinkMessageDispatcherTest::_testLateHandlers(void)
+{
+    MAVLinkMessageDispatcher dispatcher;
+    QList<int> calls;
+    auto beforeLate = [&calls]() { calls.append(-1); };
+
+    dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode, [&calls](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t&) {
+        calls.append(0);
+    });
+    dispatcher.beginLateHandlers();
+    dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode, [&calls](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t&) {
+        calls.append(1);
+    });
+    _attitudeDecodeCount = 0;
+    dispatcher.add<mavlink_attitude_t>(MAVLINK_MSG_ID_ATTITUDE, _countingAttitudeDecode, [&calls](LinkInterface*, const mavlink_message_t&, const mavlink_attitude_t&) {
+        calls.append(2);
+    });
+
+    // The callback runs between the handlers, before the late handlers of a message which only has those and for
+    // messages without handlers
+    QVERIFY(dispatcher.dispatch(NULL, _heartbeatMessage(0), beforeLate));
+    QCOMPARE(calls, QList<int>() << 0 << -1 << 1);
+
+    calls.clear();
+    QVERIFY(dispatcher.dispatch(NULL, _attitudeMessage(0.5f), beforeLate));
+    QCOMPARE(calls, QList<int>() << -1 << 2);
+    QCOMPARE(_attitudeDecodeCount, 1);
+
+    calls.clear();
+    mavlink_message_t message;
+    mavlink_msg_system_time_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 0, 0);
+    QVERIFY(!dispatcher.dispatch(NULL, message, beforeLate));
+    QCOMPARE(calls, QList<int>() << -1);
+}
+
+void MAVLinkMessageDispatcherTest::_benchmarkDecodePerConsumer(void)
+{
+    QList<mavlink_message_t> messages = _telemetryMix();
+
+    _sink = 0;
+    QBENCHMARK {
+        foreach (const mavlink_message_t& message, messages) {
+            _vehicleConsumer(message);
+            _uasConsumer(message);
+        }
+    }
+    QVERIFY(_sink != 0);
+}
+
+void MAVLinkMessageDispatcherTest::_benchmarkDecodeOnce(void)
+{
+    QList<mavlink_message_t> messages = _telemetryMix();
+    MAVLinkMessageDispatcher dispatcher;
+
+    // Same consumers as _benchmarkDecodePerConsumer
+    dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode,
+                                        [this](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t& heartbeat) { _sink += heartbeat.custom_mode; });
+    dispatcher.add<mavlink_sys_status_t>(MAVLINK_MSG_ID_SYS_STATUS, mavlink_msg_sys_status_decode,
+                                         [this](LinkInterface*, const mavlink_message_t&, const mavlink_sys_status_t& sysStatus) { _sink += sysStatus.voltage_battery; });
+    dispatcher.add<mavlink_attitude_t>(MAVLINK_MSG_ID_ATTITUDE, mavlink_msg_attitude_decode,
+                                       [this](LinkInterface*, const mavlink_message_t&, const mavlink_attitude_t& attitude) { _sink += attitude.roll; });
+    dispatcher.add<mavlink_attitude_target_t>(MAVLINK_MSG_ID_ATTITUDE_TARGET, mavlink_msg_attitude_target_decode,
+                                              [this](LinkInterface*, const mavlink_message_t&, const mavlink_attitude_target_t& attitudeTarget) { _sink += attitudeTarget.q[0]; });
+    dispatcher.add<mavlink_global_position_int_t>(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, mavlink_msg_global_position_int_decode,
+                                                  [this](LinkInterface*, const mavlink_message_t&, const mavlink_global_position_int_t& globalPosition) { _sink += globalPosition.lat; });
+    dispatcher.add<mavlink_gps_raw_int_t>(MAVLINK_MSG_ID_GPS_RAW_INT, mavlink_msg_gps_raw_int_decode,
+                                          [this](LinkInterface*, const mavlink_message_t&, const mavlink_gps_raw_int_t& gpsRaw) { _sink += gpsRaw.satellites_visible; });
+    dispatcher.add<mavlink_vfr_hud_t>(MAVLINK_MSG_ID_VFR_HUD, mavlink_msg_vfr_hud_decode,
+                                      [this](LinkInterface*, const mavlink_message_t&, const mavlink_vfr_hud_t& vfrHud) { _sink += vfrHud.groundspeed; });
+    dispatcher.add<mavlink_heartbeat_t>(MAVLINK_MSG_ID_HEARTBEAT, mavlink_msg_heartbeat_decode,
+                                        [this](LinkInterface*, const mavlink_message_t&, const mavlink_heartbeat_t& heartbeat) { _sink += heartbeat.base_mode; });
+    dispatcher.add<mavlink_sys_status_t>(MAVLINK_MSG_ID_SYS_STATUS, mavlink_msg_sys_status_decode,
+                                         [this](LinkInterface*, const mavlink_message_t&, const mavlink_sys_status_t& sysStatus) { _sink += sysStatus.load; });
+    dispatcher.add<mavlink_attitude_target_t>(MAVLINK_MSG_ID_ATTITUDE_TARGET, mavlink_msg_attitude_target_decode,
+                                              [this](LinkInterface*, const mavlink_message_t&, const mavlink_attitude_target_t& attitudeTarget) { _sink += attitudeTarget.q[1]; });
+    dispatcher.add<mavlink_statustext_t>(MAVLINK_MSG_ID_STATUSTEXT, mavlink_msg_statustext_decode,
+                                         [this](LinkInterface*, const mavlink_message_t&, const mavlink_statustext_t& statusText) { _sink += statusText.severity; });
+
+    _sink = 0;
+    QBENCHMARK {
+        foreach (const mavlink_message_t& message, messages) {
+            dispatcher.dispatch(NULL, message);
+        }
+    }
+    QVERIFY(_sink != 0);
+}
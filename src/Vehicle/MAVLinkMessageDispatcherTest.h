@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+/// Unit test for MAVLinkMessageDispatcher. The benchmarks compare the per message cost of every consumer decoding
+/// the message itself (the way Vehicle and UAS used to) against decoding once through the dispatcher.
+class MAVLinkMessageDispatcherTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testDecodeOnce(void);
+    void _testHandlerOrder(void);
+    void _testUnknownMessage(void);
+    void _testRawHandler(void);
+    void _testNestedDispatch(void);
+    void _testLateHandlers(void);
+    void _benchmarkDecodePerConsumer(void);
+    void _benchmarkDecodeOnce(void);
+
+private:
+    /// @return Telemetry mix similar to what a vehicle streams
+    static QList<mavlink_message_t> _telemetryMix(void);
+
+    void _vehicleConsumer(const mavlink_message_t& message);
+    void _uasConsumer(const mavlink_message_t& message);
+
+    double _sink;
+};
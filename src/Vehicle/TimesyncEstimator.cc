@@ -0,0 +1,162 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TimesyncEstimator.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <cmath>
+
+namespace {
+
+const double    _minAlpha =             0.05;   ///< Settled filter gain
+const double    _roundTripGain =        0.1;    ///< Round trip time filter gain
+const double    _outlierRoundTrips =    3.0;    ///< Settled round trips longer than this many times the filtered round trip are dropped
+const qint64    _outlierMinNsecs =      2000000; ///< Round trips shorter than this are never dropped, guards against a near zero filtered round trip
+
+struct GroundClock {
+    GroundClock(void)
+        : epochNsecs(QDateTime::currentMSecsSinceEpoch() * 1000000LL)
+    {
+        timer.start();
+    }
+
+    qint64          epochNsecs;
+    QElapsedTimer   timer;
+};
+
+}
+
+TimesyncEstimator::TimesyncEstimator(void)
+{
+    reset();
+}
+
+qint64 TimesyncEstimator::now(void)
+{
+    static GroundClock clock;
+    return clock.epochNsecs + clock.timer.nsecsElapsed();
+}
+
+void TimesyncEstimator::reset(void)
+{
+    QMutexLocker lock(&_mutex);
+
+    _sampleCount =      0;
+    _lastSampleNsecs =  0;
+    _offsetNsecs =      0;
+    _skew =             0;
+    _roundTripNsecs =   -1;
+}
+
+bool TimesyncEstimator::addSample(qint64 requestSentNsecs, qint64 vehicleNsecs, qint64 responseReceivedNsecs)
+{
+    qint64 roundTripNsecs = responseReceivedNsecs - requestSentNsecs;
+    if (roundTripNsecs < 0 || roundTripNsecs > maxRoundTripNsecs) {
+        return false;
+    }
+
+    QMutexLocker lock(&_mutex);
+
+    double measuredOffset = static_cast<double>(requestSentNsecs - vehicleNsecs) + roundTripNsecs / 2.0;
+
+    if (_sampleCount == 0) {
+        _restart(measuredOffset, roundTripNsecs, responseReceivedNsecs);
+        return true;
+    }
+
+    qint64 deltaNsecs = responseReceivedNsecs - _lastSampleNsecs;
+    if (deltaNsecs <= 0) {
+        return false;
+    }
+
+    if (_sampleCount >= convergeSampleCount && roundTripNsecs > _outlierMinNsecs && roundTripNsecs > _roundTripNsecs * _outlierRoundTrips) {
+        // Still follow the round trip time slowly so a link which gets slower for good is not rejected forever
+        _roundTripNsecs += _roundTripGain * _minAlpha * (roundTripNsecs - _roundTripNsecs);
+        return false;
+    }
+
+    double predictedOffset = _offsetNsecs + _skew * deltaNsecs;
+    double residual = measuredOffset - predictedOffset;
+
+    if (std::fabs(residual) > resetOffsetNsecs) {
+        // Vehicle rebooted or its clock was set
+        _restart(measuredOffset, roundTripNsecs, responseReceivedNsecs);
+        return true;
+    }
+
+    double alpha = qMax(_minAlpha, 1.0 / (_sampleCount + 1));
+    double beta = (alpha * alpha) / (2.0 - alpha);
+
+    _offsetNsecs = predictedOffset + alpha * residual;
+    _skew += beta * residual / deltaNsecs;
+    _roundTripNsecs += qMax(_roundTripGain, alpha) * (roundTripNsecs - _roundTripNsecs);
+    _lastSampleNsecs = responseReceivedNsecs;
+    _sampleCount++;
+
+    return true;
+}
+
+void TimesyncEstimator::_restart(double measuredOffset, qint64 roundTripNsecs, qint64 responseReceivedNsecs)
+{
+    _sampleCount =      1;
+    _lastSampleNsecs =  responseReceivedNsecs;
+    _offsetNsecs =      measuredOffset;
+    _skew =             0;
+    _roundTripNsecs =   roundTripNsecs;
+}
+
+bool TimesyncEstimator::converged(void) const
+{
+    QMutexLocker lock(&_mutex);
+
+    return _sampleCount >= convergeSampleCount;
+}
+
+qint64 TimesyncEstimator::vehicleToGround(qint64 vehicleNsecs) const
+{
+    QMutexLocker lock(&_mutex);
+
+    if (_sampleCount < convergeSampleCount) {
+        return -1;
+    }
+
+    double groundNsecs = vehicleNsecs + _offsetNsecs;
+    return static_cast<qint64>(groundNsecs + _skew * (groundNsecs - _lastSampleNsecs));
+}
+
+qint64 TimesyncEstimator::offsetNsecs(void) const
+{
+    QMutexLocker lock(&_mutex);
+
+    return static_cast<qint64>(_offsetNsecs);
+}
+
+double TimesyncEstimator::driftPPM(void) const
+{
+    QMutexLocker lock(&_mutex);
+
+    return _skew * 1.0e6;
+}
+
+qint64 TimesyncEstimator::roundTripNsecs(void) const
+{
+    QMutexLocker lock(&_mutex);
+
+    return static_cast<qint64>(_roundTripNsecs);
+}
+
+qint64 TimesyncEstimator::latencyNsecs(void) const
+{
+    QMutexLocker lock(&_mutex);
+
+    return _roundTripNsecs < 0 ? -1 : static_cast<qint64>(_roundTripNsecs / 2.0);
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+#include <QMutex>
+
+/// Estimates the offset and drift between the vehicle clock and the ground clock from TIMESYNC round trips.
+///
+/// Each round trip gives a measured offset which assumes the request and response took equally long. Round trips
+/// which take much longer than usual are dropped since their halves are the most likely to be lopsided. The
+/// remaining samples go through an alpha-beta filter which tracks offset and drift; the filter starts out with
+/// high gain to converge quickly and settles to low gain to smooth out link jitter. An offset jump of more than
+/// a second is taken to be a vehicle reboot and restarts the estimate.
+///
+/// All times are in nanoseconds. Ground time is from now(), vehicle time is the vehicle's time since boot as
+/// sent in TIMESYNC tc1. Samples are added from the gui thread, the estimate can be read from any thread.
+class TimesyncEstimator
+{
+public:
+    TimesyncEstimator(void);
+
+    /// @return Monotonic ground time, aligned to the Unix epoch when first called
+    static qint64 now(void);
+
+    /// Adds a round trip
+    ///     @param requestSentNsecs Ground time the TIMESYNC request was sent
+    ///     @param vehicleNsecs Vehicle time from the TIMESYNC response
+    ///     @param responseReceivedNsecs Ground time the TIMESYNC response was received
+    /// @return false: sample rejected
+    bool addSample(qint64 requestSentNsecs, qint64 vehicleNsecs, qint64 responseReceivedNsecs);
+
+    /// Throws away the estimate
+    void reset(void);
+
+    /// @return true: enough samples have been seen for the estimate to be used
+    bool converged(void) const;
+
+    /// Converts vehicle time to ground time
+    ///     @return -1 if not converged
+    qint64 vehicleToGround(qint64 vehicleNsecs) const;
+
+    /// @return Ground minus vehicle time at the most recent sample
+    qint64 offsetNsecs(void) const;
+
+    /// @return Vehicle clock drift relative to the ground clock in parts per million
+    double driftPPM(void) const;
+
+    /// @return Filtered round trip time, -1 if no samples
+    qint64 roundTripNsecs(void) const;
+
+    /// @return Estimated one way link latency, -1 if no samples
+    qint64 latencyNsecs(void) const;
+
+    static const int    convergeSampleCount = 5;            ///< Samples needed before the estimate is used
+    static const qint64 maxRoundTripNsecs = 10000000000LL;  ///< Longer round trips are never used
+    static const qint64 resetOffsetNsecs = 1000000000LL;    ///< Offset jump which restarts the estimate
+
+private:
+    /// Starts a new estimate from a single sample, _mutex must be held
+    void _restart(double measuredOffset, qint64 roundTripNsecs, qint64 responseReceivedNsecs);
+
+    mutable QMutex  _mutex;
+    int             _sampleCount;
+    qint64          _lastSampleNsecs;   ///< Ground time of the last accepted sample
+    double          _offsetNsecs;       ///< Ground minus vehicle time at _lastSampleNsecs
+    double          _skew;              ///< Offset change per ground nanosecond
+    double          _roundTripNsecs;    ///< Filtered round trip time
+};
@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TimesyncEstimatorTest.h"
+#include "TimesyncEstimator.h"
+
+namespace {
+
+const qint64    _nsecsPerMsec = 1000000LL;
+const qint64    _nsecsPerSec =  1000000000LL;
+const double    _vehicleDrift = 20.0e-6;        ///< Simulated vehicle clock runs 20 ppm slow
+
+}
+
+qint64 TimesyncEstimatorTest::_vehicleTime(qint64 groundNsecs) const
+{
+    return static_cast<qint64>((groundNsecs - _vehicleBootNsecs) * (1.0 - _vehicleDrift));
+}
+
+void TimesyncEstimatorTest::_runRoundTrips(TimesyncEstimator& estimator, int count)
+{
+    for (int i=0; i<count; i++) {
+        qint64 upNsecs =    20 * _nsecsPerMsec + (qrand() % (4 * _nsecsPerMsec));
+        qint64 downNsecs =  20 * _nsecsPerMsec + (qrand() % (4 * _nsecsPerMsec));
+
+        QVERIFY(estimator.addSample(_groundNsecs, _vehicleTime(_groundNsecs + upNsecs), _groundNsecs + upNsecs + downNsecs));
+        _groundNsecs += _nsecsPerSec;
+    }
+}
+
+void TimesyncEstimatorTest::_testConvergence(void)
+{
+    TimesyncEstimator estimator;
+
+    qsrand(1);
+    _groundNsecs = 1500000000LL * _nsecsPerSec;
+    _vehicleBootNsecs = _groundNsecs - 60 * _nsecsPerSec;
+
+    QVERIFY(!estimator.converged());
+    QCOMPARE(estimator.vehicleToGround(0), -1LL);
+    QCOMPARE(estimator.roundTripNsecs(), -1LL);
+
+    _runRoundTrips(estimator, TimesyncEstimator::convergeSampleCount);
+    QVERIFY(estimator.converged());
+
+    _runRoundTrips(estimator, 300);
+
+    // Link jitter of a few msecs per second leaves some noise in the drift estimate
+    QVERIFY(qAbs(estimator.driftPPM() - 20.0) < 12.0);
+    QVERIFY(qAbs(estimator.roundTripNsecs() - 44 * _nsecsPerMsec) < 4 * _nsecsPerMsec);
+    QVERIFY(qAbs(estimator.latencyNsecs() - 22 * _nsecsPerMsec) < 2 * _nsecsPerMsec);
+
+    // Vehicle timestamps map back to the ground time they were taken at
+    qint64 groundNsecs = _groundNsecs + _nsecsPerSec / 2;
+    QVERIFY(qAbs(estimator.vehicleToGround(_vehicleTime(groundNsecs)) - groundNsecs) < 2 * _nsecsPerMsec);
+}
+
+void TimesyncEstimatorTest::_testOutlierRejected(void)
+{
+    TimesyncEstimator estimator;
+
+    qsrand(1);
+    _groundNsecs = 1500000000LL * _nsecsPerSec;
+    _vehicleBootNsecs = _groundNsecs - 60 * _nsecsPerSec;
+
+    _runRoundTrips(estimator, 20);
+    qint64 offsetNsecs = estimator.offsetNsecs();
+
+    // Response stuck in a queue for half a second
+    QVERIFY(!estimator.addSample(_groundNsecs, _vehicleTime(_groundNsecs + 20 * _nsecsPerMsec), _groundNsecs + 520 * _nsecsPerMsec));
+    QCOMPARE(estimator.offsetNsecs(), offsetNsecs);
+
+    // Round trips out of order or too long are never used
+    QVERIFY(!estimator.addSample(_groundNsecs, _vehicleTime(_groundNsecs), _groundNsecs - 1));
+    QVERIFY(!estimator.addSample(_groundNsecs, _vehicleTime(_groundNsecs), _groundNsecs + TimesyncEstimator::maxRoundTripNsecs + 1));
+}
+
+void TimesyncEstimatorTest::_testReboot(void)
+{
+    TimesyncEstimator estimator;
+
+    qsrand(1);
+    _groundNsecs = 1500000000LL * _nsecsPerSec;
+    _vehicleBootNsecs = _groundNsecs - 60 * _nsecsPerSec;
+
+    _runRoundTrips(estimator, 20);
+    QVERIFY(estimator.converged());
+
+    // Vehicle reboots, the estimate starts over
+    _vehicleBootNsecs = _groundNsecs;
+    _runRoundTrips(estimator, 1);
+    QVERIFY(!estimator.converged());
+
+    _runRoundTrips(estimator, TimesyncEstimator::convergeSampleCount);
+    QVERIFY(estimator.converged());
+    qint64 groundNsecs = _groundNsecs;
+    QVERIFY(qAbs(estimator.vehicleToGround(_vehicleTime(groundNsecs)) - groundNsecs) < 5 * _nsecsPerMsec);
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TimesyncEstimator;
+
+/// Unit test for TimesyncEstimator offset and drift estimation
+class TimesyncEstimatorTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testConvergence(void);
+    void _testOutlierRejected(void);
+    void _testReboot(void);
+
+private:
+    /// @return Simulated vehicle clock for the specified ground time
+    qint64 _vehicleTime(qint64 groundNsecs) const;
+
+    /// Runs round trips one second apart with 20-24 msec each way, starting at _groundNsecs
+    void _runRoundTrips(TimesyncEstimator& estimator, int count);
+
+    qint64  _groundNsecs;
+    qint64  _vehicleBootNsecs;  ///< Ground time the simulated vehicle booted
+};
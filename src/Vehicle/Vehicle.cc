@@ -40,6 +40,7 @@
 #include "VideoReceiver.h"
 #include "VideoManager.h"
 #include "hbsettings.h"
+#include "QGCTracer.h"
 
 QGC_LOGGING_CATEGORY(VehicleLog, "VehicleLog")
 
@@ -80,6 +81,7 @@ const char* Vehicle::_vibrationFactGroupName =      "vibration";
 const char* Vehicle::_temperatureFactGroupName =    "temperature";
 const char* Vehicle::_clockFactGroupName =          "clock";
 const char* Vehicle::_distanceSensorFactGroupName = "distanceSensor";
+const char* Vehicle::_timesyncFactGroupName =       "timesync";
 
 Vehicle::Vehicle(LinkInterface*             link,
                  int                        vehicleId,
@@ -206,6 +208,7 @@ Vehicle::Vehicle(LinkInterface*             link,
     , _temperatureFactGroup(this)
     , _clockFactGroup(this)
     , _distanceSensorFactGroup(this)
+    , _timesyncFactGroup(this)
 {
     connect(_joystickManager, &JoystickManager::activeJoystickChanged, this, &Vehicle::_loadSettings);
     connect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::activeVehicleAvailableChanged, this, &Vehicle::_loadSettings);
@@ -222,6 +225,10 @@ Vehicle::Vehicle(LinkInterface*             link,
 
     connect(_toolbox->multiVehicleManager(), &MultiVehicleManager::parameterReadyVehicleAvailableChanged, this, &Vehicle::_vehicleParamLoaded);
 
+    // Vehicle handlers are registered first so the vehicle state is up to date when the UAS handlers run. The UAS
+    // handlers run after mavlinkMessageReceived is emitted.
+    _registerMessageHandlers();
+    _messageDispatcher.beginLateHandlers();
     _uas = new UAS(_mavlink, this, _firmwarePluginManager);
 
     connect(_uas, &UAS::imageReady,                     this, &Vehicle::_imageReady);
@@ -286,6 +293,14 @@ Vehicle::Vehicle(LinkInterface*             link,
     _1STimer.setInterval(1000);
     connect(&_1STimer, &QTimer::timeout, this, &Vehicle::_on1STimerTimeout);
 
+    // Clock alignment is shared with other threads through MAVLinkProtocol
+    _timesync = QSharedPointer<TimesyncEstimator>(new TimesyncEstimator);
+    _mavlink->setTimesyncEstimator(_id, _timesync);
+    if (!_highLatencyLink) {
+        connect(&_timesyncTimer, &QTimer::timeout, this, &Vehicle::_sendTimesync);
+        _timesyncTimer.start(_timesyncRateMSecs);
+    }
+
     // Create camera manager instance
     _cameras = _firmwarePlugin->createCameraManager(this);
     emit dynamicCamerasChanged();
@@ -396,6 +411,7 @@ Vehicle::Vehicle(MAV_AUTOPILOT              firmwareType,
     , _vibrationFactGroup(this)
     , _clockFactGroup(this)
     , _distanceSensorFactGroup(this)
+    , _timesyncFactGroup(this)
 {
     _commonInit();
     _firmwarePlugin->initializeVehicle(this);
@@ -468,6 +484,7 @@ void Vehicle::_commonInit(void)
     _addFactGroup(&_temperatureFactGroup,       _temperatureFactGroupName);
     _addFactGroup(&_clockFactGroup,             _clockFactGroupName);
     _addFactGroup(&_distanceSensorFactGroup,    _distanceSensorFactGroupName);
+    _addFactGroup(&_timesyncFactGroup,          _timesyncFactGroupName);
 
     // Add firmware-specific fact groups, if provided
     QMap<QString, FactGroup*>* fwFactGroups = _firmwarePlugin->factGroups();
@@ -487,6 +504,10 @@ Vehicle::~Vehicle()
 {
     qCDebug(VehicleLog) << "~Vehicle" << this;
 
+    if (_timesync) {
+        _mavlink->setTimesyncEstimator(_id, QSharedPointer<TimesyncEstimator>());
+    }
+
     delete _missionManager;
     _missionManager = NULL;
 
@@ -578,6 +599,8 @@ void Vehicle::resetCounters()
 
 void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
 {
+    QGC_TRACE_SCOPE("vehicle", "Vehicle::_mavlinkMessageReceived");
+
     // if the minimum supported version of MAVLink is already 2.0
     // set our max proto version to it.
     unsigned mavlinkVersion = _mavlink->getCurrentVersion();
@@ -633,162 +656,84 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         return;
     }
 
-    switch (message.msgid) {
-    case MAVLINK_MSG_ID_HOME_POSITION:
-        _handleHomePosition(message);
-        break;
-    case MAVLINK_MSG_ID_HEARTBEAT:
-        _handleHeartbeat(message);
-        break;
-    case MAVLINK_MSG_ID_RADIO_STATUS:
-        _handleRadioStatus(message);
-        break;
-    case MAVLINK_MSG_ID_RC_CHANNELS:
-        _handleRCChannels(message);
-        break;
-    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-        _handleRCChannelsRaw(message);
-        break;
-    case MAVLINK_MSG_ID_BATTERY_STATUS:
-        _handleBatteryStatus(message);
-        break;
-    case MAVLINK_MSG_ID_SYS_STATUS:
-        _handleSysStatus(message);
-        break;
-    case MAVLINK_MSG_ID_RAW_IMU:
-        emit mavlinkRawImu(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU:
-        emit mavlinkScaledImu1(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU2:
-        emit mavlinkScaledImu2(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU3:
-        emit mavlinkScaledImu3(message);
-        break;
-    case MAVLINK_MSG_ID_VIBRATION:
-        _handleVibration(message);
-        break;
-    case MAVLINK_MSG_ID_EXTENDED_SYS_STATE:
-        _handleExtendedSysState(message);
-        break;
-    case MAVLINK_MSG_ID_COMMAND_ACK:
-        _handleCommandAck(message);
-        break;
-    case MAVLINK_MSG_ID_COMMAND_LONG:
-        _handleCommandLong(message);
-        break;
-    case MAVLINK_MSG_ID_AUTOPILOT_VERSION:
-        _handleAutopilotVersion(link, message);
-        break;
-    case MAVLINK_MSG_ID_PROTOCOL_VERSION:
-        _handleProtocolVersion(link, message);
-        break;
-    case MAVLINK_MSG_ID_WIND_COV:
-        _handleWindCov(message);
-        break;
-    case MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS:
-        _handleHilActuatorControls(message);
-        break;
-    case MAVLINK_MSG_ID_LOGGING_DATA:
-        _handleMavlinkLoggingData(message);
-        break;
-    case MAVLINK_MSG_ID_LOGGING_DATA_ACKED:
-        _handleMavlinkLoggingDataAcked(message);
-        break;
-    case MAVLINK_MSG_ID_GPS_RAW_INT:
-        _handleGpsRawInt(message);
-        break;
-    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
-        _handleGlobalPositionInt(message);
-        break;
-    case MAVLINK_MSG_ID_ALTITUDE:
-        _handleAltitude(message);
-        break;
-    case MAVLINK_MSG_ID_VFR_HUD:
-        _handleVfrHud(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE:
-        _handleScaledPressure(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE2:
-        _handleScaledPressure2(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE3:
-        _handleScaledPressure3(message);
-        break;
-    case MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED:
-        _handleCameraImageCaptured(message);
-        break;
-    case MAVLINK_MSG_ID_ADSB_VEHICLE:
-        _handleADSBVehicle(message);
-        break;
-    case MAVLINK_MSG_ID_HIGH_LATENCY2:
-        _handleHighLatency2(message);
-        break;
-    case MAVLINK_MSG_ID_ATTITUDE:
-        _handleAttitude(message);
-        break;
-    case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
-        _handleAttitudeQuaternion(message);
-        break;
-    case MAVLINK_MSG_ID_ATTITUDE_TARGET:
-        _handleAttitudeTarget(message);
-        break;
-    case MAVLINK_MSG_ID_DISTANCE_SENSOR:
-        _handleDistanceSensor(message);
-        break;
-    case MAVLINK_MSG_ID_PING:
-        _handlePing(link, message);
-        break;
-
-    case MAVLINK_MSG_ID_SERIAL_CONTROL:
-    {
-        mavlink_serial_control_t ser;
-        mavlink_msg_serial_control_decode(&message, &ser);
-        emit mavlinkSerialControl(ser.device, ser.flags, ser.timeout, ser.baudrate, QByteArray(reinterpret_cast<const char*>(ser.data), ser.count));
-    }
-        break;
-
-        // Following are ArduPilot dialect messages
+    // Vehicle and UAS handlers all get the message decoded once by the dispatcher. mavlinkMessageReceived must be emitted
+    // after the vehicle processes the message. This way the vehicle state is up to date when anyone else does processing.
+    // The UAS handlers run after it.
+    _messageDispatcher.dispatch(link, message, [this, &message]() {
+        emit mavlinkMessageReceived(message);
+    });
+}
+
+void Vehicle::_registerMessageHandlers(void)
+{
+    MAVLinkMessageDispatcher& d = _messageDispatcher;
+
+    d.add(MAVLINK_MSG_ID_HOME_POSITION,         mavlink_msg_home_position_decode,           this, &Vehicle::_handleHomePosition);
+    d.add(MAVLINK_MSG_ID_HEARTBEAT,             mavlink_msg_heartbeat_decode,               this, &Vehicle::_handleHeartbeat);
+    d.add(MAVLINK_MSG_ID_RADIO_STATUS,          mavlink_msg_radio_status_decode,            this, &Vehicle::_handleRadioStatus);
+    d.add(MAVLINK_MSG_ID_RC_CHANNELS,           mavlink_msg_rc_channels_decode,             this, &Vehicle::_handleRCChannels);
+    d.add(MAVLINK_MSG_ID_RC_CHANNELS_RAW,       mavlink_msg_rc_channels_raw_decode,         this, &Vehicle::_handleRCChannelsRaw);
+    d.add(MAVLINK_MSG_ID_BATTERY_STATUS,        mavlink_msg_battery_status_decode,          this, &Vehicle::_handleBatteryStatus);
+    d.add(MAVLINK_MSG_ID_SYS_STATUS,            mavlink_msg_sys_status_decode,              this, &Vehicle::_handleSysStatus);
+    d.add(MAVLINK_MSG_ID_VIBRATION,             mavlink_msg_vibration_decode,               this, &Vehicle::_handleVibration);
+    d.add(MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    mavlink_msg_extended_sys_state_decode,      this, &Vehicle::_handleExtendedSysState);
+    d.add(MAVLINK_MSG_ID_COMMAND_ACK,           mavlink_msg_command_ack_decode,             this, &Vehicle::_handleCommandAck);
+    d.add(MAVLINK_MSG_ID_COMMAND_LONG,          mavlink_msg_command_long_decode,            this, &Vehicle::_handleCommandLong);
+    d.add(MAVLINK_MSG_ID_AUTOPILOT_VERSION,     mavlink_msg_autopilot_version_decode,       this, &Vehicle::_handleAutopilotVersion);
+    d.add(MAVLINK_MSG_ID_PROTOCOL_VERSION,      mavlink_msg_protocol_version_decode,        this, &Vehicle::_handleProtocolVersion);
+    d.add(MAVLINK_MSG_ID_WIND_COV,              mavlink_msg_wind_cov_decode,                this, &Vehicle::_handleWindCov);
+    d.add(MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS, mavlink_msg_hil_actuator_controls_decode,   this, &Vehicle::_handleHilActuatorControls);
+    d.add(MAVLINK_MSG_ID_LOGGING_DATA,          mavlink_msg_logging_data_decode,            this, &Vehicle::_handleMavlinkLoggingData);
+    d.add(MAVLINK_MSG_ID_LOGGING_DATA_ACKED,    mavlink_msg_logging_data_acked_decode,      this, &Vehicle::_handleMavlinkLoggingDataAcked);
+    d.add(MAVLINK_MSG_ID_GPS_RAW_INT,           mavlink_msg_gps_raw_int_decode,             this, &Vehicle::_handleGpsRawInt);
+    d.add(MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   mavlink_msg_global_position_int_decode,     this, &Vehicle::_handleGlobalPositionInt);
+    d.add(MAVLINK_MSG_ID_ALTITUDE,              mavlink_msg_altitude_decode,                this, &Vehicle::_handleAltitude);
+    d.add(MAVLINK_MSG_ID_VFR_HUD,               mavlink_msg_vfr_hud_decode,                 this, &Vehicle::_handleVfrHud);
+    d.add(MAVLINK_MSG_ID_SCALED_PRESSURE,       mavlink_msg_scaled_pressure_decode,         this, &Vehicle::_handleScaledPressure);
+    d.add(MAVLINK_MSG_ID_SCALED_PRESSURE2,      mavlink_msg_scaled_pressure2_decode,        this, &Vehicle::_handleScaledPressure2);
+    d.add(MAVLINK_MSG_ID_SCALED_PRESSURE3,      mavlink_msg_scaled_pressure3_decode,        this, &Vehicle::_handleScaledPressure3);
+    d.add(MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED, mavlink_msg_camera_image_captured_decode,   this, &Vehicle::_handleCameraImageCaptured);
+    d.add(MAVLINK_MSG_ID_ADSB_VEHICLE,          mavlink_msg_adsb_vehicle_decode,            this, &Vehicle::_handleADSBVehicle);
+    d.add(MAVLINK_MSG_ID_HIGH_LATENCY2,         mavlink_msg_high_latency2_decode,           this, &Vehicle::_handleHighLatency2);
+    d.add(MAVLINK_MSG_ID_ATTITUDE,              mavlink_msg_attitude_decode,                this, &Vehicle::_handleAttitude);
+    d.add(MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   mavlink_msg_attitude_quaternion_decode,     this, &Vehicle::_handleAttitudeQuaternion);
+    d.add(MAVLINK_MSG_ID_ATTITUDE_TARGET,       mavlink_msg_attitude_target_decode,         this, &Vehicle::_handleAttitudeTarget);
+    d.add(MAVLINK_MSG_ID_DISTANCE_SENSOR,       mavlink_msg_distance_sensor_decode,         this, &Vehicle::_handleDistanceSensor);
+    d.add(MAVLINK_MSG_ID_PING,                  mavlink_msg_ping_decode,                    this, &Vehicle::_handlePing);
+    d.add(MAVLINK_MSG_ID_TIMESYNC,              mavlink_msg_timesync_decode,                this, &Vehicle::_handleTimesync);
+    d.add(MAVLINK_MSG_ID_SERIAL_CONTROL,        mavlink_msg_serial_control_decode,          this, &Vehicle::_handleSerialControl);
+
+    // Raw sensor messages are passed on as is
+    d.add(MAVLINK_MSG_ID_RAW_IMU,       [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkRawImu(message); });
+    d.add(MAVLINK_MSG_ID_SCALED_IMU,    [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkScaledImu1(message); });
+    d.add(MAVLINK_MSG_ID_SCALED_IMU2,   [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkScaledImu2(message); });
+    d.add(MAVLINK_MSG_ID_SCALED_IMU3,   [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkScaledImu3(message); });
+
+    // Following are ArduPilot dialect messages
 #if !defined(NO_ARDUPILOT_DIALECT)
-    case MAVLINK_MSG_ID_CAMERA_FEEDBACK:
-        _handleCameraFeedback(message);
-        break;
-    case MAVLINK_MSG_ID_WIND:
-        _handleWind(message);
-        break;
+    d.add(MAVLINK_MSG_ID_CAMERA_FEEDBACK,       mavlink_msg_camera_feedback_decode,         this, &Vehicle::_handleCameraFeedback);
+    d.add(MAVLINK_MSG_ID_WIND,                  mavlink_msg_wind_decode,                    this, &Vehicle::_handleWind);
 #endif
-    }
-
-    // This must be emitted after the vehicle processes the message. This way the vehicle state is up to date when anyone else
-    // does processing.
-    emit mavlinkMessageReceived(message);
+}
 
-    _uas->receiveMessage(message);
+void Vehicle::_handleSerialControl(const mavlink_serial_control_t& serialControl)
+{
+    emit mavlinkSerialControl(serialControl.device, serialControl.flags, serialControl.timeout, serialControl.baudrate,
+                              QByteArray(reinterpret_cast<const char*>(serialControl.data), serialControl.count));
 }
 
 
 #if !defined(NO_ARDUPILOT_DIALECT)
-void Vehicle::_handleCameraFeedback(const mavlink_message_t& message)
+void Vehicle::_handleCameraFeedback(const mavlink_camera_feedback_t& feedback)
 {
-    mavlink_camera_feedback_t feedback;
-
-    mavlink_msg_camera_feedback_decode(&message, &feedback);
-
     QGeoCoordinate imageCoordinate((double)feedback.lat / qPow(10.0, 7.0), (double)feedback.lng / qPow(10.0, 7.0), feedback.alt_msl);
     qCDebug(VehicleLog) << "_handleCameraFeedback coord:index" << imageCoordinate << feedback.img_idx;
     _cameraTriggerPoints.append(new QGCQGeoCoordinate(imageCoordinate, this));
 }
 #endif
 
-void Vehicle::_handleCameraImageCaptured(const mavlink_message_t& message)
+void Vehicle::_handleCameraImageCaptured(const mavlink_camera_image_captured_t& feedback)
 {
-    mavlink_camera_image_captured_t feedback;
-
-    mavlink_msg_camera_image_captured_decode(&message, &feedback);
-
     QGeoCoordinate imageCoordinate((double)feedback.lat / qPow(10.0, 7.0), (double)feedback.lon / qPow(10.0, 7.0), feedback.alt);
     qCDebug(VehicleLog) << "_handleCameraFeedback coord:index" << imageCoordinate << feedback.image_index << feedback.capture_result;
     if (feedback.capture_result == 1) {
@@ -796,22 +741,15 @@ void Vehicle::_handleCameraImageCaptured(const mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleVfrHud(mavlink_message_t& message)
+void Vehicle::_handleVfrHud(const mavlink_vfr_hud_t& vfrHud)
 {
-    mavlink_vfr_hud_t vfrHud;
-    mavlink_msg_vfr_hud_decode(&message, &vfrHud);
-
     _airSpeedFact.setRawValue(qIsNaN(vfrHud.airspeed) ? 0 : vfrHud.airspeed);
     _groundSpeedFact.setRawValue(qIsNaN(vfrHud.groundspeed) ? 0 : vfrHud.groundspeed);
     _climbRateFact.setRawValue(qIsNaN(vfrHud.climb) ? 0 : vfrHud.climb);
 }
 
-void Vehicle::_handleDistanceSensor(mavlink_message_t& message)
+void Vehicle::_handleDistanceSensor(const mavlink_distance_sensor_t& distanceSensor)
 {
-    mavlink_distance_sensor_t distanceSensor;
-
-    mavlink_msg_distance_sensor_decode(&message, &distanceSensor);\
-
     if (!_distanceSensorFactGroup.idSet()) {
         _distanceSensorFactGroup.setIdSet(true);
         _distanceSensorFactGroup.setId(distanceSensor.id);
@@ -849,12 +787,8 @@ void Vehicle::_handleDistanceSensor(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleAttitudeTarget(mavlink_message_t& message)
+void Vehicle::_handleAttitudeTarget(const mavlink_attitude_target_t& attitudeTarget)
 {
-    mavlink_attitude_target_t attitudeTarget;
-
-    mavlink_msg_attitude_target_decode(&message, &attitudeTarget);
-
     float roll, pitch, yaw;
     mavlink_quaternion_to_euler(attitudeTarget.q, &roll, &pitch, &yaw);
 
@@ -890,25 +824,19 @@ void Vehicle::_handleAttitudeWorker(double rollRadians, double pitchRadians, dou
     _headingFact.setRawValue(yaw);
 }
 
-void Vehicle::_handleAttitude(mavlink_message_t& message)
+void Vehicle::_handleAttitude(const mavlink_attitude_t& attitude)
 {
     if (_receivingAttitudeQuaternion) {
         return;
     }
 
-    mavlink_attitude_t attitude;
-    mavlink_msg_attitude_decode(&message, &attitude);
-
     _handleAttitudeWorker(attitude.roll, attitude.pitch, attitude.yaw);
 }
 
-void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
+void Vehicle::_handleAttitudeQuaternion(const mavlink_attitude_quaternion_t& attitudeQuaternion)
 {
     _receivingAttitudeQuaternion = true;
 
-    mavlink_attitude_quaternion_t attitudeQuaternion;
-    mavlink_msg_attitude_quaternion_decode(&message, &attitudeQuaternion);
-
     float roll, pitch, yaw;
     float q[] = { attitudeQuaternion.q1, attitudeQuaternion.q2, attitudeQuaternion.q3, attitudeQuaternion.q4 };
     mavlink_quaternion_to_euler(q, &roll, &pitch, &yaw);
@@ -920,11 +848,8 @@ void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
     yawRate()->setRawValue(qRadiansToDegrees(attitudeQuaternion.yawspeed));
 }
 
-void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
+void Vehicle::_handleGpsRawInt(const mavlink_gps_raw_int_t& gpsRawInt)
 {
-    mavlink_gps_raw_int_t gpsRawInt;
-    mavlink_msg_gps_raw_int_decode(&message, &gpsRawInt);
-
     _gpsRawIntMessageAvailable = true;
 
     if (gpsRawInt.fix_type >= GPS_FIX_TYPE_3D_FIX) {
@@ -947,11 +872,8 @@ void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
     _gpsFactGroup.lock()->setRawValue(gpsRawInt.fix_type);
 }
 
-void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
+void Vehicle::_handleGlobalPositionInt(const mavlink_global_position_int_t& globalPositionInt)
 {
-    mavlink_global_position_int_t globalPositionInt;
-    mavlink_msg_global_position_int_decode(&message, &globalPositionInt);
-
     _altitudeRelativeFact.setRawValue(globalPositionInt.relative_alt / 1000.0);
     _altitudeAMSLFact.setRawValue(globalPositionInt.alt / 1000.0);
 
@@ -969,11 +891,8 @@ void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleHighLatency2(mavlink_message_t& message)
+void Vehicle::_handleHighLatency2(const mavlink_high_latency2_t& highLatency2)
 {
-    mavlink_high_latency2_t highLatency2;
-    mavlink_msg_high_latency2_decode(&message, &highLatency2);
-
     QString previousFlightMode;
     if (_base_mode != 0 || _custom_mode != 0){
         // Vehicle is initialized with _base_mode=0 and _custom_mode=0. Don't pass this to flightMode() since it will complain about
@@ -1048,11 +967,8 @@ void Vehicle::_handleHighLatency2(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleAltitude(mavlink_message_t& message)
+void Vehicle::_handleAltitude(const mavlink_altitude_t& altitude)
 {
-    mavlink_altitude_t altitude;
-    mavlink_msg_altitude_decode(&message, &altitude);
-
     // If data from GPS is available it takes precedence over ALTITUDE message
     if (!_globalPositionIntMessageAvailable) {
         _altitudeRelativeFact.setRawValue(altitude.altitude_relative);
@@ -1086,13 +1002,8 @@ void Vehicle::_setCapabilities(uint64_t capabilityBits)
     qCDebug(VehicleLog) << QString("Vehicle %1 RallyPoints").arg(_capabilityBits & MAV_PROTOCOL_CAPABILITY_MISSION_RALLY ? supports : doesNotSupport);
 }
 
-void Vehicle::_handleAutopilotVersion(LinkInterface *link, mavlink_message_t& message)
+void Vehicle::_handleAutopilotVersion(const mavlink_autopilot_version_t& autopilotVersion)
 {
-    Q_UNUSED(link);
-
-    mavlink_autopilot_version_t autopilotVersion;
-    mavlink_msg_autopilot_version_decode(&message, &autopilotVersion);
-
     _uid = (quint64)autopilotVersion.uid;
     emit vehicleUIDChanged();
 
@@ -1131,13 +1042,8 @@ void Vehicle::_handleAutopilotVersion(LinkInterface *link, mavlink_message_t& me
     _startPlanRequest();
 }
 
-void Vehicle::_handleProtocolVersion(LinkInterface *link, mavlink_message_t& message)
+void Vehicle::_handleProtocolVersion(const mavlink_protocol_version_t& protoVersion)
 {
-    Q_UNUSED(link);
-
-    mavlink_protocol_version_t protoVersion;
-    mavlink_msg_protocol_version_decode(&message, &protoVersion);
-
     _setMaxProtoVersion(protoVersion.max_version);
 }
 
@@ -1172,10 +1078,8 @@ QString Vehicle::vehicleUIDStr()
     return uid;
 }
 
-void Vehicle::_handleHilActuatorControls(mavlink_message_t &message)
+void Vehicle::_handleHilActuatorControls(const mavlink_hil_actuator_controls_t& hil)
 {
-    mavlink_hil_actuator_controls_t hil;
-    mavlink_msg_hil_actuator_controls_decode(&message, &hil);
     emit hilActuatorControlsChanged(hil.time_usec, hil.flags,
                                     hil.controls[0],
             hil.controls[1],
@@ -1196,15 +1100,12 @@ void Vehicle::_handleHilActuatorControls(mavlink_message_t &message)
             hil.mode);
 }
 
-void Vehicle::_handleCommandLong(mavlink_message_t& message)
+void Vehicle::_handleCommandLong(const mavlink_command_long_t& cmd)
 {
 #ifdef NO_SERIAL_LINK
     // If not using serial link, bail out.
-    Q_UNUSED(message)
+    Q_UNUSED(cmd)
 #else
-    mavlink_command_long_t cmd;
-    mavlink_msg_command_long_decode(&message, &cmd);
-
     switch (cmd.command) {
     // Other component on the same system
     // requests that QGC frees up the serial port of the autopilot
@@ -1225,11 +1126,8 @@ void Vehicle::_handleCommandLong(mavlink_message_t& message)
 #endif
 }
 
-void Vehicle::_handleExtendedSysState(mavlink_message_t& message)
+void Vehicle::_handleExtendedSysState(const mavlink_extended_sys_state_t& extendedState)
 {
-    mavlink_extended_sys_state_t extendedState;
-    mavlink_msg_extended_sys_state_decode(&message, &extendedState);
-
     switch (extendedState.landed_state) {
     case MAV_LANDED_STATE_ON_GROUND:
         _setFlying(false);
@@ -1257,11 +1155,8 @@ void Vehicle::_handleExtendedSysState(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleVibration(mavlink_message_t& message)
+void Vehicle::_handleVibration(const mavlink_vibration_t& vibration)
 {
-    mavlink_vibration_t vibration;
-    mavlink_msg_vibration_decode(&message, &vibration);
-
     _vibrationFactGroup.xAxis()->setRawValue(vibration.vibration_x);
     _vibrationFactGroup.yAxis()->setRawValue(vibration.vibration_y);
     _vibrationFactGroup.zAxis()->setRawValue(vibration.vibration_z);
@@ -1270,11 +1165,8 @@ void Vehicle::_handleVibration(mavlink_message_t& message)
     _vibrationFactGroup.clipCount3()->setRawValue(vibration.clipping_2);
 }
 
-void Vehicle::_handleWindCov(mavlink_message_t& message)
+void Vehicle::_handleWindCov(const mavlink_wind_cov_t& wind)
 {
-    mavlink_wind_cov_t wind;
-    mavlink_msg_wind_cov_decode(&message, &wind);
-
     float direction = qRadiansToDegrees(qAtan2(wind.wind_y, wind.wind_x));
     float speed = qSqrt(qPow(wind.wind_x, 2) + qPow(wind.wind_y, 2));
 
@@ -1288,11 +1180,8 @@ void Vehicle::_handleWindCov(mavlink_message_t& message)
 }
 
 #if !defined(NO_ARDUPILOT_DIALECT)
-void Vehicle::_handleWind(mavlink_message_t& message)
+void Vehicle::_handleWind(const mavlink_wind_t& wind)
 {
-    mavlink_wind_t wind;
-    mavlink_msg_wind_decode(&message, &wind);
-
     // We don't want negative wind angles
     float direction = wind.direction;
     if (direction < 0) {
@@ -1311,11 +1200,8 @@ bool Vehicle::_apmArmingNotRequired(void)
             _parameterManager->getParameter(FactSystem::defaultComponentId, armingRequireParam)->rawValue().toInt() == 0;
 }
 
-void Vehicle::_handleSysStatus(mavlink_message_t& message)
+void Vehicle::_handleSysStatus(const mavlink_sys_status_t& sysStatus)
 {
-    mavlink_sys_status_t sysStatus;
-    mavlink_msg_sys_status_decode(&message, &sysStatus);
-
     if (sysStatus.current_battery == -1) {
         _battery1FactGroup.current()->setRawValue(VehicleBatteryFactGroup::_currentUnavailable);
     } else {
@@ -1367,11 +1253,8 @@ void Vehicle::_handleSysStatus(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleBatteryStatus(mavlink_message_t& message)
+void Vehicle::_handleBatteryStatus(const mavlink_battery_status_t& bat_status)
 {
-    mavlink_battery_status_t bat_status;
-    mavlink_msg_battery_status_decode(&message, &bat_status);
-
     VehicleBatteryFactGroup& batteryFactGroup = bat_status.id == 0 ? _battery1FactGroup : _battery2FactGroup;
 
     if (bat_status.temperature == INT16_MAX) {
@@ -1420,12 +1303,8 @@ void Vehicle::_setHomePosition(QGeoCoordinate& homeCoord)
     }
 }
 
-void Vehicle::_handleHomePosition(mavlink_message_t& message)
+void Vehicle::_handleHomePosition(const mavlink_home_position_t& homePos)
 {
-    mavlink_home_position_t homePos;
-
-    mavlink_msg_home_position_decode(&message, &homePos);
-
     QGeoCoordinate newHomePosition (homePos.latitude / 10000000.0,
                                     homePos.longitude / 10000000.0,
                                     homePos.altitude / 1000.0);
@@ -1447,18 +1326,24 @@ void Vehicle::_updateArmed(bool armed)
             // Also handle Video Streaming
             if(_settingsManager->videoSettings()->disableWhenDisarmed()->rawValue().toBool()) {
                 _settingsManager->videoSettings()->streamEnabled()->setRawValue(false);
-                qgcApp()->toolbox()->videoManager()->videoReceiver()->stop();
+                VideoManager* videoManager = qgcApp()->toolbox()->videoManager();
+                if (videoManager) {
+                    // There is no video manager when running headless
+                    videoManager->videoReceiver()->stop();
+                }
             }
         }
     }
 }
 
-void Vehicle::_handlePing(LinkInterface* link, mavlink_message_t& message)
+void Vehicle::_handlePing(LinkInterface* link, const mavlink_message_t& message, const mavlink_ping_t& ping)
 {
-    mavlink_ping_t      ping;
     mavlink_message_t   msg;
 
-    mavlink_msg_ping_decode(&message, &ping);
+    if (ping.target_system != 0) {
+        // Only respond to ping requests, not to responses from pings we sent ourselves
+        return;
+    }
     mavlink_msg_ping_pack_chan(_mavlink->getSystemId(),
                                _mavlink->getComponentId(),
                                priorityLink()->mavlinkChannel(),
@@ -1470,15 +1355,64 @@ void Vehicle::_handlePing(LinkInterface* link, mavlink_message_t& message)
     sendMessageOnLink(link, msg);
 }
 
-void Vehicle::_handleHeartbeat(mavlink_message_t& message)
+void Vehicle::_sendTimesync(void)
+{
+    LinkInterface* link = priorityLink();
+    if (!link || link->highLatency()) {
+        return;
+    }
+
+    mavlink_message_t msg;
+    mavlink_msg_timesync_pack_chan(_mavlink->getSystemId(),
+                                   _mavlink->getComponentId(),
+                                   link->mavlinkChannel(),
+                                   &msg,
+                                   0,                               // tc1 0 marks a request
+                                   TimesyncEstimator::now());       // ts1 comes back in the response
+    sendMessageOnLink(link, msg);
+}
+
+void Vehicle::_handleTimesync(LinkInterface* link, const mavlink_message_t& message, const mavlink_timesync_t& timesync)
 {
+    qint64 receivedNsecs = TimesyncEstimator::now();
+
     if (message.compid != _defaultComponentId) {
         return;
     }
 
-    mavlink_heartbeat_t heartbeat;
+    if (timesync.tc1 == 0) {
+        // Request from the vehicle so it can align its clock with ours
+        mavlink_message_t msg;
+        mavlink_msg_timesync_pack_chan(_mavlink->getSystemId(),
+                                       _mavlink->getComponentId(),
+                                       link->mavlinkChannel(),
+                                       &msg,
+                                       receivedNsecs,
+                                       timesync.ts1);
+        sendMessageOnLink(link, msg);
+        return;
+    }
+
+    // Response to one of our requests
+    if (!_timesync->addSample(timesync.ts1, timesync.tc1, receivedNsecs)) {
+        return;
+    }
+
+    link->metrics()->roundTrip((receivedNsecs - timesync.ts1) / 1000);
 
-    mavlink_msg_heartbeat_decode(&message, &heartbeat);
+    if (_timesync->converged()) {
+        _timesyncFactGroup.offset()->setRawValue(_timesync->offsetNsecs() / 1.0e6);
+        _timesyncFactGroup.drift()->setRawValue(_timesync->driftPPM());
+    }
+    _timesyncFactGroup.latency()->setRawValue(_timesync->latencyNsecs() / 1.0e6);
+    _timesyncFactGroup.roundTrip()->setRawValue(_timesync->roundTripNsecs() / 1.0e6);
+}
+
+void Vehicle::_handleHeartbeat(const mavlink_message_t& message, const mavlink_heartbeat_t& heartbeat)
+{
+    if (message.compid != _defaultComponentId) {
+        return;
+    }
 
     bool newArmed = heartbeat.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY;
 
@@ -1510,13 +1444,9 @@ void Vehicle::_handleHeartbeat(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleRadioStatus(mavlink_message_t& message)
+void Vehicle::_handleRadioStatus(const mavlink_message_t& message, const mavlink_radio_status_t& rstatus)
 {
-
     //-- Process telemetry status message
-    mavlink_radio_status_t rstatus;
-    mavlink_msg_radio_status_decode(&message, &rstatus);
-
     int rssi    = rstatus.rssi;
     int remrssi = rstatus.remrssi;
     int lnoise = (int)(int8_t)rstatus.noise;
@@ -1570,13 +1500,9 @@ void Vehicle::_handleRadioStatus(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleRCChannels(mavlink_message_t& message)
+void Vehicle::_handleRCChannels(const mavlink_rc_channels_t& channels)
 {
-    mavlink_rc_channels_t channels;
-
-    mavlink_msg_rc_channels_decode(&message, &channels);
-
-    uint16_t* _rgChannelvalues[cMaxRcChannels] = {
+    const uint16_t* _rgChannelvalues[cMaxRcChannels] = {
         &channels.chan1_raw,
         &channels.chan2_raw,
         &channels.chan3_raw,
@@ -1612,16 +1538,12 @@ void Vehicle::_handleRCChannels(mavlink_message_t& message)
     emit rcChannelsChanged(channels.chancount, pwmValues);
 }
 
-void Vehicle::_handleRCChannelsRaw(mavlink_message_t& message)
+void Vehicle::_handleRCChannelsRaw(const mavlink_rc_channels_raw_t& channels)
 {
     // We handle both RC_CHANNLES and RC_CHANNELS_RAW since different firmware will only
     // send one or the other.
 
-    mavlink_rc_channels_raw_t channels;
-
-    mavlink_msg_rc_channels_raw_decode(&message, &channels);
-
-    uint16_t* _rgChannelvalues[cMaxRcChannels] = {
+    const uint16_t* _rgChannelvalues[cMaxRcChannels] = {
         &channels.chan1_raw,
         &channels.chan2_raw,
         &channels.chan3_raw,
@@ -1657,21 +1579,18 @@ void Vehicle::_handleRCChannelsRaw(mavlink_message_t& message)
     emit rcChannelsChanged(channelCount, pwmValues);
 }
 
-void Vehicle::_handleScaledPressure(mavlink_message_t& message) {
-    mavlink_scaled_pressure_t pressure;
-    mavlink_msg_scaled_pressure_decode(&message, &pressure);
+void Vehicle::_handleScaledPressure(const mavlink_scaled_pressure_t& pressure)
+{
     _temperatureFactGroup.temperature1()->setRawValue(pressure.temperature / 100.0);
 }
 
-void Vehicle::_handleScaledPressure2(mavlink_message_t& message) {
-    mavlink_scaled_pressure2_t pressure;
-    mavlink_msg_scaled_pressure2_decode(&message, &pressure);
+void Vehicle::_handleScaledPressure2(const mavlink_scaled_pressure2_t& pressure)
+{
     _temperatureFactGroup.temperature2()->setRawValue(pressure.temperature / 100.0);
 }
 
-void Vehicle::_handleScaledPressure3(mavlink_message_t& message) {
-    mavlink_scaled_pressure3_t pressure;
-    mavlink_msg_scaled_pressure3_decode(&message, &pressure);
+void Vehicle::_handleScaledPressure3(const mavlink_scaled_pressure3_t& pressure)
+{
     _temperatureFactGroup.temperature3()->setRawValue(pressure.temperature / 100.0);
 }
 
@@ -1749,7 +1668,7 @@ void Vehicle::_sendMessageOnLink(LinkInterface* link, mavlink_message_t message)
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
     int len = mavlink_msg_to_send_buffer(buffer, &message);
 
-    link->writeBytesSafe((const char*)buffer, len);
+    link->writeBytesSafe((const char*)buffer, len, MAVLinkProtocol::sendPriority(message));
     _messagesSent++;
     emit messagesSentChanged();
 }
@@ -3319,13 +3238,10 @@ void Vehicle::_sendNextQueuedMavCommand(void)
 }
 
 
-void Vehicle::_handleCommandAck(mavlink_message_t& message)
+void Vehicle::_handleCommandAck(const mavlink_message_t& message, const mavlink_command_ack_t& ack)
 {
     bool showError = false;
 
-    mavlink_command_ack_t ack;
-    mavlink_msg_command_ack_decode(&message, &ack);
-
     if (ack.command == MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES && ack.result != MAV_RESULT_ACCEPTED) {
         // We aren't going to get a response back for capabilities, so stop waiting for it before we ask for mission items
         qCDebug(VehicleLog) << QStringLiteral("Vehicle responded to MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES with error(%1). Setting no capabilities. Starting Plan request.").arg(ack.result);
@@ -3598,18 +3514,14 @@ void Vehicle::_ackMavlinkLogData(uint16_t sequence)
     sendMessageOnLink(priorityLink(), msg);
 }
 
-void Vehicle::_handleMavlinkLoggingData(mavlink_message_t& message)
+void Vehicle::_handleMavlinkLoggingData(const mavlink_logging_data_t& log)
 {
-    mavlink_logging_data_t log;
-    mavlink_msg_logging_data_decode(&message, &log);
     emit mavlinkLogData(this, log.target_system, log.target_component, log.sequence,
                         log.first_message_offset, QByteArray((const char*)log.data, log.length), false);
 }
 
-void Vehicle::_handleMavlinkLoggingDataAcked(mavlink_message_t& message)
+void Vehicle::_handleMavlinkLoggingDataAcked(const mavlink_logging_data_acked_t& log)
 {
-    mavlink_logging_data_acked_t log;
-    mavlink_msg_logging_data_acked_decode(&message, &log);
     _ackMavlinkLogData(log.sequence);
     emit mavlinkLogData(this, log.target_system, log.target_component, log.sequence,
                         log.first_message_offset, QByteArray((const char*)log.data, log.length), true);
@@ -3716,12 +3628,10 @@ bool Vehicle::autoDisarm(void)
     return false;
 }
 
-void Vehicle::_handleADSBVehicle(const mavlink_message_t& message)
+void Vehicle::_handleADSBVehicle(const mavlink_adsb_vehicle_t& adsbVehicle)
 {
-    mavlink_adsb_vehicle_t adsbVehicle;
     static const int maxTimeSinceLastSeen = 15;
 
-    mavlink_msg_adsb_vehicle_decode(&message, &adsbVehicle);
     if (adsbVehicle.flags | ADSB_FLAGS_VALID_COORDS) {
         if (_adsbICAOMap.contains(adsbVehicle.ICAO_address)) {
             if (adsbVehicle.tslc > maxTimeSinceLastSeen) {
@@ -3963,6 +3873,30 @@ void VehicleClockFactGroup::_updateAllValues(void)
     FactGroup::_updateAllValues();
 }
 
+const char* VehicleTimesyncFactGroup::_offsetFactName =     "offset";
+const char* VehicleTimesyncFactGroup::_driftFactName =      "drift";
+const char* VehicleTimesyncFactGroup::_latencyFactName =    "latency";
+const char* VehicleTimesyncFactGroup::_roundTripFactName =  "roundTrip";
+
+VehicleTimesyncFactGroup::VehicleTimesyncFactGroup(QObject* parent)
+    : FactGroup     (1000, ":/json/Vehicle/TimesyncFact.json", parent)
+    , _offsetFact   (0, _offsetFactName,    FactMetaData::valueTypeDouble)
+    , _driftFact    (0, _driftFactName,     FactMetaData::valueTypeDouble)
+    , _latencyFact  (0, _latencyFactName,   FactMetaData::valueTypeDouble)
+    , _roundTripFact(0, _roundTripFactName, FactMetaData::valueTypeDouble)
+{
+    _addFact(&_offsetFact,      _offsetFactName);
+    _addFact(&_driftFact,       _driftFactName);
+    _addFact(&_latencyFact,     _latencyFactName);
+    _addFact(&_roundTripFact,   _roundTripFactName);
+
+    // Start out as not available "--.--"
+    _offsetFact.setRawValue     (std::numeric_limits<float>::quiet_NaN());
+    _driftFact.setRawValue      (std::numeric_limits<float>::quiet_NaN());
+    _latencyFact.setRawValue    (std::numeric_limits<float>::quiet_NaN());
+    _roundTripFact.setRawValue  (std::numeric_limits<float>::quiet_NaN());
+}
+
 const char* VehicleSetpointFactGroup::_rollFactName =       "roll";
 const char* VehicleSetpointFactGroup::_pitchFactName =      "pitch";
 const char* VehicleSetpointFactGroup::_yawFactName =        "yaw";
@@ -20,6 +20,8 @@
 #include "MAVLinkProtocol.h"
 #include "UASMessageHandler.h"
 #include "SettingsFact.h"
+#include "TimesyncEstimator.h"
+#include "MAVLinkMessageDispatcher.h"
 
 class UAS;
 class UASInterface;
@@ -355,6 +357,35 @@ private:
     Fact            _currentDateFact;
 };
 
+class VehicleTimesyncFactGroup : public FactGroup
+{
+    Q_OBJECT
+
+public:
+    VehicleTimesyncFactGroup(QObject* parent = NULL);
+
+    Q_PROPERTY(Fact* offset             READ offset             CONSTANT)
+    Q_PROPERTY(Fact* drift              READ drift              CONSTANT)
+    Q_PROPERTY(Fact* latency            READ latency            CONSTANT)
+    Q_PROPERTY(Fact* roundTrip          READ roundTrip          CONSTANT)
+
+    Fact* offset    (void) { return &_offsetFact; }
+    Fact* drift     (void) { return &_driftFact; }
+    Fact* latency   (void) { return &_latencyFact; }
+    Fact* roundTrip (void) { return &_roundTripFact; }
+
+    static const char* _offsetFactName;
+    static const char* _driftFactName;
+    static const char* _latencyFactName;
+    static const char* _roundTripFactName;
+
+private:
+    Fact            _offsetFact;
+    Fact            _driftFact;
+    Fact            _latencyFact;
+    Fact            _roundTripFact;
+};
+
 class Vehicle : public FactGroup
 {
     Q_OBJECT
@@ -537,6 +568,7 @@ public:
     Q_PROPERTY(FactGroup* temperature READ temperatureFactGroup CONSTANT)
     Q_PROPERTY(FactGroup* clock       READ clockFactGroup       CONSTANT)
     Q_PROPERTY(FactGroup* setpoint    READ setpointFactGroup    CONSTANT)
+    Q_PROPERTY(FactGroup* timesync    READ timesyncFactGroup    CONSTANT)
 
     Q_PROPERTY(int      firmwareMajorVersion        READ firmwareMajorVersion       NOTIFY firmwareVersionChanged)
     Q_PROPERTY(int      firmwareMinorVersion        READ firmwareMinorVersion       NOTIFY firmwareVersionChanged)
@@ -682,6 +714,9 @@ public:
     /// Provides access to uas from vehicle. Temporary workaround until UAS is fully phased out.
     UAS* uas(void) { return _uas; }
 
+    /// Handlers registered here get the messages from this vehicle already decoded
+    MAVLinkMessageDispatcher* messageDispatcher(void) { return &_messageDispatcher; }
+
     /// Provides access to uas from vehicle. Temporary workaround until AutoPilotPlugin is fully phased out.
     AutoPilotPlugin* autopilotPlugin(void) { return _autopilotPlugin; }
 
@@ -837,6 +872,10 @@ public:
     FactGroup* clockFactGroup           (void) { return &_clockFactGroup; }
     FactGroup* setpointFactGroup        (void) { return &_setpointFactGroup; }
     FactGroup* distanceSensorFactGroup  (void) { return &_distanceSensorFactGroup; }
+    FactGroup* timesyncFactGroup        (void) { return &_timesyncFactGroup; }
+
+    /// Vehicle clock estimate from TIMESYNC, for aligning vehicle timestamps with ground time
+    QSharedPointer<TimesyncEstimator> timesync(void) { return _timesync; }
 
     void setConnectionLostEnabled(bool connectionLostEnabled);
 
@@ -1067,6 +1106,7 @@ private slots:
     void _updateHobbsMeter(void);
     void _vehicleParamLoaded(bool ready);
     void _sendQGCTimeToVehicle(void);
+    void _sendTimesync(void);
 
     void _onHeadingChanged();
     void _on1STimerTimeout();
@@ -1079,42 +1119,45 @@ private:
     void _loadSettings(void);
     void _saveSettings(void);
     void _startJoystick(bool start);
-    void _handlePing(LinkInterface* link, mavlink_message_t& message);
-    void _handleHomePosition(mavlink_message_t& message);
-    void _handleHeartbeat(mavlink_message_t& message);
-    void _handleRadioStatus(mavlink_message_t& message);
-    void _handleRCChannels(mavlink_message_t& message);
-    void _handleRCChannelsRaw(mavlink_message_t& message);
-    void _handleBatteryStatus(mavlink_message_t& message);
-    void _handleSysStatus(mavlink_message_t& message);
-    void _handleWindCov(mavlink_message_t& message);
-    void _handleVibration(mavlink_message_t& message);
-    void _handleExtendedSysState(mavlink_message_t& message);
-    void _handleCommandAck(mavlink_message_t& message);
-    void _handleCommandLong(mavlink_message_t& message);
-    void _handleAutopilotVersion(LinkInterface* link, mavlink_message_t& message);
-    void _handleProtocolVersion(LinkInterface* link, mavlink_message_t& message);
-    void _handleHilActuatorControls(mavlink_message_t& message);
-    void _handleGpsRawInt(mavlink_message_t& message);
-    void _handleGlobalPositionInt(mavlink_message_t& message);
-    void _handleAltitude(mavlink_message_t& message);
-    void _handleVfrHud(mavlink_message_t& message);
-    void _handleScaledPressure(mavlink_message_t& message);
-    void _handleScaledPressure2(mavlink_message_t& message);
-    void _handleScaledPressure3(mavlink_message_t& message);
-    void _handleHighLatency2(mavlink_message_t& message);
+    void _registerMessageHandlers(void);
+    void _handlePing(LinkInterface* link, const mavlink_message_t& message, const mavlink_ping_t& ping);
+    void _handleTimesync(LinkInterface* link, const mavlink_message_t& message, const mavlink_timesync_t& timesync);
+    void _handleHomePosition(const mavlink_home_position_t& homePos);
+    void _handleHeartbeat(const mavlink_message_t& message, const mavlink_heartbeat_t& heartbeat);
+    void _handleRadioStatus(const mavlink_message_t& message, const mavlink_radio_status_t& rstatus);
+    void _handleRCChannels(const mavlink_rc_channels_t& channels);
+    void _handleRCChannelsRaw(const mavlink_rc_channels_raw_t& channels);
+    void _handleBatteryStatus(const mavlink_battery_status_t& bat_status);
+    void _handleSysStatus(const mavlink_sys_status_t& sysStatus);
+    void _handleWindCov(const mavlink_wind_cov_t& wind);
+    void _handleVibration(const mavlink_vibration_t& vibration);
+    void _handleExtendedSysState(const mavlink_extended_sys_state_t& extendedState);
+    void _handleCommandAck(const mavlink_message_t& message, const mavlink_command_ack_t& ack);
+    void _handleCommandLong(const mavlink_command_long_t& cmd);
+    void _handleAutopilotVersion(const mavlink_autopilot_version_t& autopilotVersion);
+    void _handleProtocolVersion(const mavlink_protocol_version_t& protoVersion);
+    void _handleHilActuatorControls(const mavlink_hil_actuator_controls_t& hil);
+    void _handleGpsRawInt(const mavlink_gps_raw_int_t& gpsRawInt);
+    void _handleGlobalPositionInt(const mavlink_global_position_int_t& globalPositionInt);
+    void _handleAltitude(const mavlink_altitude_t& altitude);
+    void _handleVfrHud(const mavlink_vfr_hud_t& vfrHud);
+    void _handleScaledPressure(const mavlink_scaled_pressure_t& pressure);
+    void _handleScaledPressure2(const mavlink_scaled_pressure2_t& pressure);
+    void _handleScaledPressure3(const mavlink_scaled_pressure3_t& pressure);
+    void _handleHighLatency2(const mavlink_high_latency2_t& highLatency2);
     void _handleAttitudeWorker(double rollRadians, double pitchRadians, double yawRadians);
-    void _handleAttitude(mavlink_message_t& message);
-    void _handleAttitudeQuaternion(mavlink_message_t& message);
-    void _handleAttitudeTarget(mavlink_message_t& message);
-    void _handleDistanceSensor(mavlink_message_t& message);
+    void _handleAttitude(const mavlink_attitude_t& attitude);
+    void _handleAttitudeQuaternion(const mavlink_attitude_quaternion_t& attitudeQuaternion);
+    void _handleAttitudeTarget(const mavlink_attitude_target_t& attitudeTarget);
+    void _handleDistanceSensor(const mavlink_distance_sensor_t& distanceSensor);
+    void _handleSerialControl(const mavlink_serial_control_t& serialControl);
     // ArduPilot dialect messages
 #if !defined(NO_ARDUPILOT_DIALECT)
-    void _handleCameraFeedback(const mavlink_message_t& message);
-    void _handleWind(mavlink_message_t& message);
+    void _handleCameraFeedback(const mavlink_camera_feedback_t& feedback);
+    void _handleWind(const mavlink_wind_t& wind);
 #endif
-    void _handleCameraImageCaptured(const mavlink_message_t& message);
-    void _handleADSBVehicle(const mavlink_message_t& message);
+    void _handleCameraImageCaptured(const mavlink_camera_image_captured_t& feedback);
+    void _handleADSBVehicle(const mavlink_adsb_vehicle_t& adsbVehicle);
     void _missionManagerError(int errorCode, const QString& errorMsg);
     void _geoFenceManagerError(int errorCode, const QString& errorMsg);
     void _rallyPointManagerError(int errorCode, const QString& errorMsg);
@@ -1123,8 +1166,8 @@ private:
     void _linkActiveChanged(LinkInterface* link, bool active, int vehicleID);
     void _say(const QString& text);
     QString _vehicleIdSpeech(void);
-    void _handleMavlinkLoggingData(mavlink_message_t& message);
-    void _handleMavlinkLoggingDataAcked(mavlink_message_t& message);
+    void _handleMavlinkLoggingData(const mavlink_logging_data_t& log);
+    void _handleMavlinkLoggingDataAcked(const mavlink_logging_data_acked_t& log);
     void _ackMavlinkLogData(uint16_t sequence);
     void _sendNextQueuedMavCommand(void);
     void _updatePriorityLink(bool updateActive, bool sendCommand);
@@ -1328,6 +1371,7 @@ private:
     VehicleClockFactGroup           _clockFactGroup;
     VehicleSetpointFactGroup        _setpointFactGroup;
     VehicleDistanceSensorFactGroup  _distanceSensorFactGroup;
+    VehicleTimesyncFactGroup        _timesyncFactGroup;
 
     static const char* _rollFactName;
     static const char* _pitchFactName;
@@ -1353,6 +1397,7 @@ private:
     static const char* _temperatureFactGroupName;
     static const char* _clockFactGroupName;
     static const char* _distanceSensorFactGroupName;
+    static const char* _timesyncFactGroupName;
 
     static const int _vehicleUIUpdateRateMSecs = 100;
 
@@ -1374,4 +1419,9 @@ private:
     double         _flyToRelAltitude;
     QTimer         _1STimer;
     int            _1STimerSecsCount;
+
+    // Clock alignment
+    QSharedPointer<TimesyncEstimator>   _timesync;
+    QTimer                              _timesyncTimer;
+    static const int                    _timesyncRateMSecs = 1000;
 };
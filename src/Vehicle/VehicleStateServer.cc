@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleStateServer.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+#include "LinkInterface.h"
+#include "JsonHelper.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QTimer>
+
+QGC_LOGGING_CATEGORY(VehicleStateServerLog, "VehicleStateServerLog")
+
+const char* VehicleStateServer::_jsonCommandKey =   "command";
+const char* VehicleStateServer::_jsonIdKey =        "id";
+const char* VehicleStateServer::_jsonRateKey =      "rate";
+const char* VehicleStateServer::_jsonErrorKey =     "error";
+const char* VehicleStateServer::_jsonVehiclesKey =  "vehicles";
+
+VehicleStateServer::VehicleStateServer(MultiVehicleManager* multiVehicleManager, QObject* parent)
+    : QObject               (parent)
+    , _multiVehicleManager  (multiVehicleManager)
+{
+    connect(&_server, &QTcpServer::newConnection, this, &VehicleStateServer::_newConnection);
+}
+
+bool VehicleStateServer::listen(quint16 port)
+{
+    // Vehicle state is only served locally, anything further away should go through a proper gateway
+    return _server.listen(QHostAddress::LocalHost, port);
+}
+
+void VehicleStateServer::_newConnection(void)
+{
+    while (_server.hasPendingConnections()) {
+        QTcpSocket* client = _server.nextPendingConnection();
+        qCDebug(VehicleStateServerLog) << "Client connected" << client->peerPort();
+        connect(client, &QTcpSocket::readyRead,     this,   &VehicleStateServer::_readyRead);
+        connect(client, &QTcpSocket::disconnected,  this,   &VehicleStateServer::_disconnected);
+        connect(client, &QTcpSocket::disconnected,  client, &QTcpSocket::deleteLater);
+    }
+}
+
+void VehicleStateServer::_readyRead(void)
+{
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    if (!client) {
+        return;
+    }
+
+    while (client->canReadLine()) {
+        QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        QJsonObject reply;
+        if (parseError.error != QJsonParseError::NoError) {
+            reply = _error(parseError.errorString());
+        } else if (!doc.isObject()) {
+            reply = _error(tr("Request must be an object"));
+        } else {
+            reply = handleRequest(doc.object(), client);
+        }
+        if (!reply.isEmpty()) {
+            _send(client, reply);
+        }
+    }
+
+    if (client->bytesAvailable() > maxRequestBytes) {
+        qCDebug(VehicleStateServerLog) << "Request too long, dropping client" << client->peerPort();
+        client->abort();
+    }
+}
+
+void VehicleStateServer::_disconnected(void)
+{
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    if (client) {
+        delete _subscriptions.take(client);
+    }
+}
+
+QJsonObject VehicleStateServer::handleRequest(const QJsonObject& request, QTcpSocket* client)
+{
+    QString command = request[_jsonCommandKey].toString();
+
+    if (command == QStringLiteral("vehicles")) {
+        return _allVehiclesState();
+    } else if (command == QStringLiteral("vehicle")) {
+        Vehicle* vehicle = _multiVehicleManager->getVehicleById(request[_jsonIdKey].toInt());
+        if (!vehicle) {
+            return _error(tr("Unknown vehicle id %1").arg(request[_jsonIdKey].toInt()));
+        }
+        return vehicleState(vehicle);
+    } else if (command == QStringLiteral("subscribe")) {
+        if (!client) {
+            return _error(tr("Subscribe needs a client"));
+        }
+        _subscribe(client, request[_jsonRateKey].toInt());
+        return QJsonObject();
+    }
+
+    return _error(tr("Unknown command '%1'").arg(command));
+}
+
+void VehicleStateServer::_subscribe(QTcpSocket* client, int rate)
+{
+    QTimer* timer = _subscriptions.value(client);
+
+    if (rate <= 0) {
+        delete _subscriptions.take(client);
+        return;
+    }
+
+    if (!timer) {
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, [this, client]() { _publish(client); });
+        _subscriptions[client] = timer;
+    }
+    timer->start(1000 / qMin(rate, static_cast<int>(maxSubscribeRate)));
+}
+
+void VehicleStateServer::_publish(QTcpSocket* client)
+{
+    if (client->bytesToWrite() > maxClientBacklogBytes) {
+        qCDebug(VehicleStateServerLog) << "Client backlogged, skipping update" << client->peerPort();
+        return;
+    }
+    _send(client, _allVehiclesState());
+}
+
+QJsonObject VehicleStateServer::_allVehiclesState(void)
+{
+    QJsonArray vehicles;
+    QmlObjectListModel* vehicleList = _multiVehicleManager->vehicles();
+    for (int i=0; i<vehicleList->count(); i++) {
+        vehicles.append(vehicleState(vehicleList->value<Vehicle*>(i)));
+    }
+
+    QJsonObject state;
+    state[_jsonVehiclesKey] = vehicles;
+    return state;
+}
+
+QJsonObject VehicleStateServer::vehicleState(Vehicle* vehicle)
+{
+    QJsonObject state = factGroupState(vehicle);
+
+    state[_jsonIdKey] =                 vehicle->id();
+    state["firmwareType"] =             static_cast<int>(vehicle->firmwareType());
+    state["vehicleType"] =              vehicle->vehicleTypeName();
+    state["armed"] =                    vehicle->armed();
+    state["flightMode"] =               vehicle->flightMode();
+
+    QJsonValue coordinate;
+    JsonHelper::saveGeoCoordinate(vehicle->coordinate(), true /* writeAltitude */, coordinate);
+    state["coordinate"] = coordinate;
+
+    LinkInterface* link = vehicle->priorityLink();
+    if (link) {
+        QJsonObject linkState = factGroupState(link->metrics());
+        linkState["name"] = link->getName();
+        state["link"] = linkState;
+    }
+
+    return state;
+}
+
+QJsonObject VehicleStateServer::factGroupState(FactGroup* factGroup)
+{
+    QJsonObject state;
+
+    foreach (const QString& factName, factGroup->factNames()) {
+        // Not a number values are written out as null
+        state[factName] = QJsonValue::fromVariant(factGroup->getFact(factName)->rawValue());
+    }
+    foreach (const QString& factGroupName, factGroup->factGroupNames()) {
+        state[factGroupName] = factGroupState(factGroup->getFactGroup(factGroupName));
+    }
+
+    return state;
+}
+
+void VehicleStateServer::_send(QTcpSocket* client, const QJsonObject& json)
+{
+    client->write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    client->write("\n", 1);
+}
+
+QJsonObject VehicleStateServer::_error(const QString& error)
+{
+    QJsonObject reply;
+    reply[_jsonErrorKey] = error;
+    return reply;
+}
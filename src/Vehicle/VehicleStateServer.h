@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QJsonObject>
+#include <QHash>
+
+class MultiVehicleManager;
+class Vehicle;
+class FactGroup;
+class QTimer;
+
+Q_DECLARE_LOGGING_CATEGORY(VehicleStateServerLog)
+
+/// Serves vehicle state to local clients when QGC is running headless.
+///
+/// Clients connect over TCP to localhost and talk newline delimited JSON. Requests:
+///     {"command":"vehicles"}                  Replies with the state of all vehicles
+///     {"command":"vehicle","id":<id>}         Replies with the state of a single vehicle
+///     {"command":"subscribe","rate":<hz>}     Sends the state of all vehicles at the given rate, 0 stops
+/// Vehicle state holds the id, types, armed and flight mode, the coordinate, the value of every vehicle fact
+/// and fact group by name, and the priority link metrics. Bad requests are answered with {"error":"<text>"}.
+/// Subscription updates are skipped for a client which is not reading them fast enough. A client sending a request
+/// longer than maxRequestBytes is disconnected.
+class VehicleStateServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    VehicleStateServer(MultiVehicleManager* multiVehicleManager, QObject* parent = NULL);
+
+    /// Starts listening on localhost
+    ///     @return false: unable to listen, see errorString
+    bool listen(quint16 port);
+
+    QString errorString(void) const { return _server.errorString(); }
+
+    /// @return Port being listened on, useful when listening on port 0
+    quint16 serverPort(void) const { return _server.serverPort(); }
+
+    /// @return State of the vehicle as sent to clients
+    static QJsonObject vehicleState(Vehicle* vehicle);
+
+    /// @return Fact values by name, with nested objects for the child fact groups
+    static QJsonObject factGroupState(FactGroup* factGroup);
+
+    /// Handles a single request
+    ///     @return Reply to send back to the client, empty for no reply
+    QJsonObject handleRequest(const QJsonObject& request, QTcpSocket* client);
+
+    static const int defaultPort =                  5780;
+    static const int maxSubscribeRate =             50;         ///< Hz
+    static const int maxClientBacklogBytes =        1048576;    ///< Subscription updates are skipped above this
+    static const int maxRequestBytes =              65536;      ///< Clients sending longer requests are dropped
+
+private slots:
+    void _newConnection(void);
+    void _readyRead(void);
+    void _disconnected(void);
+
+private:
+    QJsonObject _allVehiclesState(void);
+    void _subscribe(QTcpSocket* client, int rate);
+    void _publish(QTcpSocket* client);
+    static void _send(QTcpSocket* client, const QJsonObject& json);
+    static QJsonObject _error(const QString& error);
+
+    MultiVehicleManager*            _multiVehicleManager;
+    QTcpServer                      _server;
+    QHash<QTcpSocket*, QTimer*>     _subscriptions;     ///< Update timer of each subscribed client
+
+    static const char* _jsonCommandKey;
+    static const char* _jsonIdKey;
+    static const char* _jsonRateKey;
+    static const char* _jsonErrorKey;
+    static const char* _jsonVehiclesKey;
+};
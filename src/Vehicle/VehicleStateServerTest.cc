@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleStateServerTest.h"
+#include "VehicleStateServer.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+void VehicleStateServerTest::_testRequests(void)
+{
+    _connectMockLink();
+
+    MultiVehicleManager* vehicleManager = qgcApp()->toolbox()->multiVehicleManager();
+    Vehicle* vehicle = vehicleManager->activeVehicle();
+    QVERIFY(vehicle);
+
+    VehicleStateServer server(vehicleManager);
+    QJsonObject request;
+
+    request["command"] = "vehicles";
+    QJsonArray vehicles = server.handleRequest(request, NULL)["vehicles"].toArray();
+    QCOMPARE(vehicles.count(), 1);
+    QJsonObject state = vehicles[0].toObject();
+    QCOMPARE(state["id"].toInt(), vehicle->id());
+    QCOMPARE(state["armed"].toBool(), vehicle->armed());
+    QCOMPARE(state["flightMode"].toString(), vehicle->flightMode());
+    QVERIFY(state["gps"].isObject());
+    QVERIFY(state["link"].toObject().contains("messagesLost"));
+
+    request["command"] = "vehicle";
+    request["id"] = vehicle->id();
+    QCOMPARE(server.handleRequest(request, NULL)["id"].toInt(), vehicle->id());
+
+    request["id"] = vehicle->id() + 1;
+    QVERIFY(server.handleRequest(request, NULL).contains("error"));
+
+    request["command"] = "bogus";
+    QVERIFY(server.handleRequest(request, NULL).contains("error"));
+}
+
+void VehicleStateServerTest::_testSubscribe(void)
+{
+    _connectMockLink();
+
+    VehicleStateServer server(qgcApp()->toolbox()->multiVehicleManager());
+    QVERIFY(server.listen(0));
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(client.waitForConnected(1000));
+
+    client.write("{\"command\":\"subscribe\",\"rate\":20}\n");
+
+    // 20 Hz for half a second should give a handful of updates
+    int updates = 0;
+    for (int i=0; i<50 && updates < 5; i++) {
+        QTest::qWait(20);
+        while (client.canReadLine()) {
+            QJsonDocument doc = QJsonDocument::fromJson(client.readLine());
+            QCOMPARE(doc.object()["vehicles"].toArray().count(), 1);
+            updates++;
+        }
+    }
+    QVERIFY(updates >= 5);
+
+    // The server runs on this thread, so the client waits through the event loop. Updates keep coming in between.
+    client.write("not json\n");
+    bool error = false;
+    for (int i=0; i<50 && !error; i++) {
+        QTest::qWait(20);
+        while (client.canReadLine()) {
+            error |= QJsonDocument::fromJson(client.readLine()).object().contains("error");
+        }
+    }
+    QVERIFY(error);
+
+    // Unsubscribing stops the updates
+    client.write("{\"command\":\"subscribe\",\"rate\":0}\n");
+    QTest::qWait(200);
+    client.readAll();
+    QTest::qWait(200);
+    QCOMPARE(client.bytesAvailable(), 0LL);
+}
+
+void VehicleStateServerTest::_testLongRequest(void)
+{
+    VehicleStateServer server(qgcApp()->toolbox()->multiVehicleManager());
+    QVERIFY(server.listen(0));
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(client.waitForConnected(1000));
+
+    // A request which never ends is not buffered forever
+    client.write(QByteArray(VehicleStateServer::maxRequestBytes + 1024, 'x'));
+    QTRY_COMPARE_WITH_TIMEOUT(client.state(), QAbstractSocket::UnconnectedState, 2000);
+}
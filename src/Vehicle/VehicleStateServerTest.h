@@ -0,0 +1,23 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for VehicleStateServer
+class VehicleStateServerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testRequests(void);
+    void _testSubscribe(void);
+    void _testLongRequest(void);
+};
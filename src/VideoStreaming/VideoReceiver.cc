@@ -18,10 +18,12 @@
 #include "SettingsManager.h"
 #include "QGCApplication.h"
 #include "VideoManager.h"
+#include "QGCTracer.h"
 
 #include <QDebug>
 #include <QUrl>
 #include <QDir>
+#include <QFileInfo>
 #include <QDateTime>
 #include <QSysInfo>
 #include <QThread>
@@ -46,6 +48,12 @@ static const char* kVideoMuxes[] =
 
 #define NUM_MUXES (sizeof(kVideoMuxes) / sizeof(char*))
 
+// While recording, the recording queue holds this much stream beyond the pre-roll before it
+// starts dropping frames because storage is not keeping up
+static const guint64 kRecordingBacklog      = 3 * GST_SECOND;
+// Upper bound for the recording queue in case the stream has no usable timestamps
+static const guint   kRecordingQueueMaxBytes = 64 * 1024 * 1024;
+
 #endif
 
 
@@ -62,10 +70,21 @@ VideoReceiver::VideoReceiver(NodeSelector *piNodeSelector, QObject* parent)
     , _pipeline(NULL)
     , _pipelineStopRec(NULL)
     , _videoSink(NULL)
+    , _jitterBuffer(NULL)
+    , _droppedFrames(0)
+    , _videoStorageBytes(0)
+    , _reportedDroppedFrames(0)
+    , _decoderThreads(0)
+    , _streamDroppedFrames(0)
+    , _streamLatency(0)
+    , _displayDropped(0)
+    , _qosDropped(0)
+    , _qosJitterUs(0)
     , _socket(NULL)
     , _serverPresent(false)
     , _rtspTestInterval_ms(5000)
 #endif
+    , _nodeIndex(-1)
     , _videoSurface(NULL)
     , _jitterLatency(0)
     , _expectedLatency(20)
@@ -83,8 +102,9 @@ VideoReceiver::VideoReceiver(NodeSelector *piNodeSelector, QObject* parent)
     connect(this, &VideoReceiver::msgErrorReceived, this, &VideoReceiver::_handleError);
     connect(this, &VideoReceiver::msgEOSReceived, this, &VideoReceiver::_handleEOS);
     connect(this, &VideoReceiver::msgStateChangedReceived, this, &VideoReceiver::_handleStateChanged);
+    connect(this, &VideoReceiver::msgFragmentOpenedReceived, this, &VideoReceiver::_handleFragmentOpened);
     connect(&_frameTimer, &QTimer::timeout, this, &VideoReceiver::_updateTimer);
-//    connect(&_statsTimer, &QTimer::timeout, this, &VideoReceiver::_onStatsTimer);
+    connect(&_statsTimer, &QTimer::timeout, this, &VideoReceiver::_onStatsTimer);
     _frameTimer.start(1000);
 #endif
 }
@@ -132,6 +152,7 @@ VideoReceiver::grabImage(QString imageFile)
 static void
 newPadCB(GstElement* element, GstPad* pad, gpointer data)
 {
+    QGC_TRACE_SCOPE("video", "newPadCB");
     gchar* name;
     name = gst_pad_get_name(pad);
     //g_print("A new pad %s was created\n", name);
@@ -222,15 +243,21 @@ void VideoReceiver::delayedStart(const QString &optionsString, bool recording)
 {
 #if defined(QGC_GST_STREAMING)
     if (!optionsString.isEmpty()) {
+        PiNode node = _nodeSelector->currentNode();
+        PiNodeList nodes = _nodeSelector->discoverer()->discoveredNodes();
+        if (_nodeIndex >= 0 && _nodeIndex < nodes.count()) {
+            node = nodes.at(_nodeIndex);
+        }
+
         // start new stream
-        _nodeSelector->startStreaming(_nodeSelector->currentNode(), optionsString, recording);
+        _nodeSelector->startStreaming(node, optionsString, recording);
 
         if (!_jitterLatency) {
 //            _expectedLatency = _nodeSelector->currentNode().latency;
         } else {
             _expectedLatency = _jitterLatency/2;
         }
-        QString newUri = QString("udp://0.0.0.0:") + QString::number(_nodeSelector->currentNode().targetStreamingPort);
+        QString newUri = QString("udp://0.0.0.0:") + QString::number(node.targetStreamingPort);
         qDebug() << newUri;
         setUri(newUri);
     }
@@ -247,18 +274,26 @@ void VideoReceiver::setJitter(quint16 jitter)
 {
     qDebug() << "new jitter latency is " << jitter;
     _jitterLatency = jitter;
+    if (_jitterLatency) {
+        _expectedLatency = _jitterLatency/2;
+    }
 }
 
 //-----------------------------------------------------------------------------
 // When we finish our pipeline will look like this:
 //
-//                                   +-->queue-->decoder-->_videosink
-//                                   |
-//    datasource-->demux-->parser-->tee
+//                                            +-->queue-->decoder-->_videosink
+//                                            |
+//    datasource-->demux-->parser-->capsfilter-->tee
+//                                            |
+//                                            +-->queue (pre-roll, only if enabled)
 //
-//                                   ^
-//                                   |
-//                                   +-Here we will later link elements for recording
+//                                            ^
+//                                            |
+//                                            +-Here we will later link elements for recording
+//
+// The capsfilter makes the parser output avc/au, which both the decoder and all recording
+// muxes accept, so the recording branch does not need a parser of its own.
 void VideoReceiver::start()
 {
     if(!_videoSettings->streamEnabled()->rawValue().toBool() ||
@@ -303,6 +338,7 @@ void VideoReceiver::start()
     GstCaps*        caps        = NULL;
     GstElement*     demux       = NULL;
     GstElement*     parser      = NULL;
+    GstElement*     parserCaps  = NULL;
     GstElement*     queue       = NULL;
     GstElement*     decoder     = NULL;
     GstElement*     queue1      = NULL;
@@ -352,7 +388,6 @@ void VideoReceiver::start()
                 break;
             }
             _jitterBuffer = udpjitter;
-            _statsTimer.start(1000);
             if ((demux = gst_element_factory_make("rtph264depay", "rtp-h264-depacketizer")) == NULL) {
                 qCritical() << "VideoReceiver::start() failed. Error with gst_element_factory_make('rtph264depay')";
                 break;
@@ -373,6 +408,15 @@ void VideoReceiver::start()
             break;
         }
 
+        if ((parserCaps = gst_element_factory_make("capsfilter", "h264-parser-caps")) == NULL) {
+            qCritical() << "VideoReceiver::start() failed. Error with gst_element_factory_make('capsfilter')";
+            break;
+        }
+
+        GstCaps* streamCaps = gst_caps_from_string("video/x-h264, stream-format=(string)avc, alignment=(string)au");
+        g_object_set(G_OBJECT(parserCaps), "caps", streamCaps, NULL);
+        gst_caps_unref(streamCaps);
+
         if((_tee = gst_element_factory_make("tee", NULL)) == NULL)  {
             qCritical() << "VideoReceiver::start() failed. Error with gst_element_factory_make('tee')";
             break;
@@ -390,18 +434,28 @@ void VideoReceiver::start()
             break;
         }
 
+        // 0 lets libav pick one thread per core
+        g_object_set(G_OBJECT(decoder), "max-threads", _decoderThreads, NULL);
+
         if ((queue1 = gst_element_factory_make("queue", NULL)) == NULL) {
             qCritical() << "VideoReceiver::start() failed. Error with gst_element_factory_make('queue') [1]";
             break;
         }
 
-        gst_bin_add_many(GST_BIN(_pipeline), dataSource, udpjitter, demux, parser, _tee, queue, decoder, queue1, _videoSink, NULL);
+        // Only decoded frames are dropped, dropping in front of the decoder would corrupt the
+        // picture up to the next keyframe.
+        if (_videoSettings->leakyQueue()->rawValue().toBool()) {
+            g_object_set(G_OBJECT(queue1), "leaky", 2, "max-size-buffers", 1, "max-size-bytes", 0, "max-size-time", static_cast<guint64>(0), NULL);
+            g_signal_connect(queue1, "overrun", G_CALLBACK(_displayOverrun), this);
+        }
+
+        gst_bin_add_many(GST_BIN(_pipeline), dataSource, udpjitter, demux, parser, parserCaps, _tee, queue, decoder, queue1, _videoSink, NULL);
 //        gst_bin_add_many(GST_BIN(_pipeline), dataSource, demux, parser, _tee, queue, decoder, queue1, _videoSink, NULL);
         pipelineUp = true;
 
         if(isUdp) {
             // Link the pipeline in front of the tee
-            if(!gst_element_link_many(dataSource, udpjitter, demux, parser, _tee, queue, decoder, queue1, _videoSink, NULL)) {
+            if(!gst_element_link_many(dataSource, udpjitter, demux, parser, parserCaps, _tee, queue, decoder, queue1, _videoSink, NULL)) {
                 qCritical() << "Unable to link UDP elements.";
                 break;
             }
@@ -415,20 +469,25 @@ void VideoReceiver::start()
                 qCritical() << "Unable to link TCP dataSource to Demux.";
                 break;
             }
-            if(!gst_element_link_many(parser, _tee, queue, decoder, queue1, _videoSink, NULL)) {
+            if(!gst_element_link_many(parser, parserCaps, _tee, queue, decoder, queue1, _videoSink, NULL)) {
                 qCritical() << "Unable to link TCP pipline to parser.";
                 break;
             }
             g_signal_connect(demux, "pad-added", G_CALLBACK(newPadCB), parser);
         } else {
             g_signal_connect(dataSource, "pad-added", G_CALLBACK(newPadCB), demux);
-            if(!gst_element_link_many(demux, parser, _tee, queue, decoder, _videoSink, NULL)) {
+            if(!gst_element_link_many(demux, parser, parserCaps, _tee, queue, decoder, queue1, _videoSink, NULL)) {
                 qCritical() << "Unable to link RTSP elements.";
                 break;
             }
         }
 
-        dataSource = udpjitter = demux = parser = queue = decoder = queue1 = NULL;
+        dataSource = udpjitter = demux = parser = parserCaps = queue = decoder = queue1 = NULL;
+
+        //-- Start keeping the pre-roll right away so it is available when recording starts
+        if(_videoSettings->recordingPreRoll()->rawValue().toUInt() > 0 && !_attachRecordingQueue()) {
+            qWarning() << "VideoReceiver::start() unable to set up recording pre-roll";
+        }
 
         GstBus* bus = NULL;
 
@@ -470,6 +529,11 @@ void VideoReceiver::start()
                 parser = NULL;
             }
 
+            if (parserCaps != NULL) {
+                gst_object_unref(parserCaps);
+                parserCaps = NULL;
+            }
+
             if (demux != NULL) {
                 gst_object_unref(demux);
                 demux = NULL;
@@ -495,6 +559,7 @@ void VideoReceiver::start()
     } else {
         GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-playing");
         _running = true;
+        _statsTimer.start(1000);
         qCDebug(VideoReceiverLog) << "Running";
     }
     _starting = false;
@@ -555,8 +620,7 @@ VideoReceiver::_shutdownPipeline() {
     gst_bin_remove(GST_BIN(_pipeline), _videoSink);
     gst_object_unref(_pipeline);
     _pipeline = NULL;
-    delete _sink;
-    _sink = NULL;
+    _releaseSink();
     _serverPresent = false;
     _streaming = false;
     _recording = false;
@@ -565,6 +629,14 @@ VideoReceiver::_shutdownPipeline() {
 
     _statsTimer.stop();
     _jitterBuffer = NULL;
+    g_atomic_int_set(&_displayDropped, 0);
+    g_atomic_int_set(&_qosDropped, 0);
+    g_atomic_int_set(&_qosJitterUs, 0);
+    if(_streamDroppedFrames || _streamLatency) {
+        _streamDroppedFrames = 0;
+        _streamLatency = 0;
+        emit streamStatsChanged();
+    }
 
     emit recordingChanged();
 }
@@ -586,7 +658,7 @@ VideoReceiver::_handleEOS() {
     if(_stopping) {
         _shutdownPipeline();
         qCDebug(VideoReceiverLog) << "Stopped";
-    } else if(_recording && _sink->removing) {
+    } else if(_recording && _sink && _sink->removing) {
         _shutdownRecordingBranch();
     } else {
         qWarning() << "VideoReceiver: Unexpected EOS!";
@@ -611,6 +683,7 @@ VideoReceiver::_handleStateChanged() {
 gboolean
 VideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
 {
+    QGC_TRACE_SCOPE("video", "VideoReceiver::_onBusMessage");
     Q_UNUSED(bus)
     Q_ASSERT(msg != NULL && data != NULL);
     VideoReceiver* pThis = (VideoReceiver*)data;
@@ -632,6 +705,29 @@ VideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
     case(GST_MESSAGE_STATE_CHANGED):
         pThis->msgStateChangedReceived();
         break;
+    case(GST_MESSAGE_QOS):
+        // Only the video sink knows how late frames really are when they reach the screen
+        if(GST_MESSAGE_SRC(msg) == GST_OBJECT(pThis->_videoSink)) {
+            GstFormat format;
+            guint64 processed = 0;
+            guint64 dropped = 0;
+            gint64 jitter = 0;
+            gst_message_parse_qos_stats(msg, &format, &processed, &dropped);
+            gst_message_parse_qos_values(msg, &jitter, NULL, NULL);
+            if(format == GST_FORMAT_BUFFERS || format == GST_FORMAT_DEFAULT) {
+                g_atomic_int_set(&pThis->_qosDropped, static_cast<gint>(dropped));
+            }
+            g_atomic_int_set(&pThis->_qosJitterUs, static_cast<gint>(jitter / 1000));
+        }
+        break;
+    case(GST_MESSAGE_ELEMENT): {
+        // splitmuxsink announces each new recording segment
+        const GstStructure* s = gst_message_get_structure(msg);
+        if(s && gst_structure_has_name(s, "splitmuxsink-fragment-opened")) {
+            pThis->msgFragmentOpenedReceived(QString::fromUtf8(gst_structure_get_string(s, "location")));
+        }
+    }
+        break;
     default:
         break;
     }
@@ -643,63 +739,51 @@ VideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
 #if defined(QGC_GST_STREAMING)
 void VideoReceiver::_onStatsTimer()
 {
-    // figure out if we need to switch streaming rates or latency.
-    if (!_pipeline || !_jitterBuffer) {
+    if (!_pipeline) {
         return;
     }
 
-    GstStructure *stats;
-    gint fill_percent = 0;
-
-    g_object_get(_jitterBuffer, "stats", &stats, NULL);
-    g_object_get(_jitterBuffer, "percent", &fill_percent, NULL);
-
-    guint64 num_pushed = 0;
-    guint64 num_lost = 0;
-    guint64 num_late = 0;
-    guint64 num_duplicates = 0;
-    guint64 rtx_count = 0;
-    guint64 rtx_success_count = 0;
-    gdouble rtx_per_packet = 0;
-    guint64 rtx_rtt = 0;
-
-    gst_structure_get(stats, "num-pushed",
-                      gst_structure_get_field_type(stats,"num-pushed"),
-                      &num_pushed, NULL);
-    gst_structure_get(stats, "num-lost",
-                      gst_structure_get_field_type(stats,"num-lost"),
-                      &num_lost, NULL);
-    gst_structure_get(stats, "num-late",
-                      gst_structure_get_field_type(stats,"num-late"),
-                      &num_late, NULL);
-    gst_structure_get(stats, "num-duplicates",
-                      gst_structure_get_field_type(stats,"num-duplicates"),
-                      &num_duplicates, NULL);
-    gst_structure_get(stats, "rtx-count",
-                      gst_structure_get_field_type(stats,"rtx-count"),
-                      &rtx_count, NULL);
-    gst_structure_get(stats, "rtx-success-count",
-                      gst_structure_get_field_type(stats,"rtx-success-count"),
-                      &rtx_success_count, NULL);
-    gst_structure_get(stats, "rtx-per-packet",
-                      gst_structure_get_field_type(stats,"rtx-per-packet"),
-                      &rtx_per_packet, NULL);
-    gst_structure_get(stats, "rtx-rtt",
-                      gst_structure_get_field_type(stats,"rtx-rtt"),
-                      &rtx_rtt, NULL);
-
-    qDebug() << "Stats structure: " << gst_structure_get_name(stats);
-    qDebug() << "Stats structure num-pushed: " << num_pushed;
-    qDebug() << "Stats structure num-lost: " << num_lost;
-    qDebug() << "Stats structure num-late: " << num_late;
-    qDebug() << "Stats structure num-duplicates: " << num_duplicates;
-    qDebug() << "Stats structure rtx-count: " << rtx_count;
-    qDebug() << "Stats structure rtx-success-count: " << rtx_success_count;
-    qDebug() << "Stats structure rtx-per-packet: " << rtx_per_packet;
-    qDebug() << "Stats structure rtx-rtt: " << rtx_rtt;
-    qDebug() << "buffer filled percentage" << fill_percent;
-
-    gst_structure_free (stats);
+    guint64 numLost = 0;
+    guint64 numLate = 0;
+    guint64 rtxRtt  = 0;
+
+    if (_jitterBuffer) {
+        GstStructure* stats = NULL;
+        g_object_get(_jitterBuffer, "stats", &stats, NULL);
+        if (stats) {
+            gst_structure_get_uint64(stats, "num-lost", &numLost);
+            gst_structure_get_uint64(stats, "num-late", &numLate);
+            gst_structure_get_uint64(stats, "rtx-rtt",  &rtxRtt);
+            gst_structure_free(stats);
+        }
+    }
+
+    // The receiver side of the glass-to-glass latency is what the pipeline reports (jitter buffer
+    // plus decoder) and how late frames still reach the sink. Network transit is half the
+    // retransmission round trip when the jitter buffer has measured one.
+    GstClockTime pipelineLatency = 0;
+    GstQuery* query = gst_query_new_latency();
+    if (gst_element_query(_pipeline, query)) {
+        gboolean live;
+        GstClockTime maxLatency;
+        gst_query_parse_latency(query, &live, &pipelineLatency, &maxLatency);
+    }
+    gst_query_unref(query);
+
+    qint64 latencyUs = static_cast<qint64>(pipelineLatency / GST_USECOND) + qMax(0, g_atomic_int_get(&_qosJitterUs));
+    if (rtxRtt) {
+        latencyUs += static_cast<qint64>(rtxRtt / GST_USECOND / 2);
+    }
+
+    int dropped = static_cast<int>(numLost + numLate) + g_atomic_int_get(&_displayDropped) + g_atomic_int_get(&_qosDropped);
+    int latency = static_cast<int>(latencyUs / 1000);
+
+    if (dropped != _streamDroppedFrames || latency != _streamLatency) {
+        _streamDroppedFrames = dropped;
+        _streamLatency = latency;
+        qCDebug(VideoReceiverLog) << "Stream" << _uri << "latency" << _streamLatency << "ms dropped" << _streamDroppedFrames;
+        emit streamStatsChanged();
+    }
 }
 #endif
 
@@ -738,8 +822,105 @@ VideoReceiver::_cleanupOldVideos()
                 file.remove();
                 vidList.removeLast();
             }
+            _videoStorageBytes = total;
+        } else {
+            _videoStorageBytes = 0;
+        }
+    }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Sets up the head of the recording branch:
+//
+//    tee-->teepad-->queue (leaky)-->X
+//
+// The queue src pad stays blocked until recording starts. Since the queue leaks its oldest
+// buffers, it always holds the most recent pre-roll seconds of stream.
+#if defined(QGC_GST_STREAMING)
+bool
+VideoReceiver::_attachRecordingQueue()
+{
+    if(_sink) {
+        return true;
+    }
+
+    _sink               = new Sink();
+    _sink->teepad       = gst_element_get_request_pad(_tee, "src_%u");
+    _sink->queue        = gst_element_factory_make("queue", NULL);
+    _sink->mux          = NULL;
+    _sink->muxpad       = NULL;
+    _sink->blockProbe   = 0;
+    _sink->recording    = FALSE;
+    _sink->waitKeyframe = TRUE;
+    _sink->dropped      = 0;
+    _sink->started      = FALSE;
+    _sink->removing     = FALSE;
+
+    if(!_sink->teepad || !_sink->queue) {
+        qCritical() << "VideoReceiver::_attachRecordingQueue() failed to make _sink elements";
+        if(_sink->queue) {
+            gst_object_unref(_sink->queue);
+            _sink->queue = NULL;
+        }
+        if(_sink->teepad) {
+            gst_element_release_request_pad(_tee, _sink->teepad);
         }
+        _releaseSink();
+        return false;
     }
+
+    guint64 preRoll = static_cast<guint64>(_videoSettings->recordingPreRoll()->rawValue().toUInt()) * GST_SECOND;
+    g_object_set(G_OBJECT(_sink->queue),
+                 "leaky",               2,  // downstream, drop oldest
+                 "max-size-time",       preRoll,
+                 "max-size-buffers",    0,
+                 "max-size-bytes",      kRecordingQueueMaxBytes,
+                 NULL);
+    g_signal_connect(_sink->queue, "overrun", G_CALLBACK(_recordingOverrun), _sink);
+
+    gst_object_ref(_sink->queue);
+    gst_bin_add(GST_BIN(_pipeline), _sink->queue);
+
+    GstPad* srcpad = gst_element_get_static_pad(_sink->queue, "src");
+    _sink->blockProbe = gst_pad_add_probe(srcpad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, _preRollBlock, NULL, NULL);
+    // Installed now so it sees the first buffer let through once recording starts
+    gst_pad_add_probe(srcpad, GST_PAD_PROBE_TYPE_BUFFER, _recordingWatch, _sink, NULL);
+    gst_object_unref(srcpad);
+
+    gst_element_sync_state_with_parent(_sink->queue);
+
+    GstPad* sinkpad = gst_element_get_static_pad(_sink->queue, "sink");
+    gst_pad_link(_sink->teepad, sinkpad);
+    gst_object_unref(sinkpad);
+
+    qCDebug(VideoReceiverLog) << "Recording queue attached, pre-roll (s):" << preRoll / GST_SECOND;
+    return true;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_releaseSink()
+{
+    if(!_sink) {
+        return;
+    }
+    if(_sink->muxpad) {
+        gst_object_unref(_sink->muxpad);
+    }
+    if(_sink->teepad) {
+        gst_object_unref(_sink->teepad);
+    }
+    if(_sink->mux) {
+        gst_object_unref(_sink->mux);
+    }
+    if(_sink->queue) {
+        gst_object_unref(_sink->queue);
+    }
+    delete _sink;
+    _sink = NULL;
 }
 #endif
 
@@ -748,13 +929,16 @@ VideoReceiver::_cleanupOldVideos()
 //
 //                                   +-->queue-->decoder-->_videosink
 //                                   |
-//    datasource-->demux-->parser-->tee
+//    ...-->parser-->capsfilter-->tee
 //                                   |
-//                                   |    +--------------_sink-------------------+
-//                                   |    |                                      |
-//   we are adding these elements->  +->teepad-->queue-->matroskamux-->_filesink |
-//                                        |                                      |
-//                                        +--------------------------------------+
+//                                   |    +-----------------_sink-------------------+
+//                                   |    |                                         |
+//   we are adding these elements->  +->teepad-->queue (leaky)-->splitmuxsink       |
+//                                        |                                         |
+//                                        +-----------------------------------------+
+//
+// If pre-roll is enabled the queue is already there and holds the last seconds of stream,
+// which are written out first.
 void
 VideoReceiver::startRecording(const QString &videoFile)
 {
@@ -773,66 +957,107 @@ VideoReceiver::startRecording(const QString &videoFile)
         return;
     }
 
+    QString fileBase;
+    if(videoFile.isEmpty()) {
+        QString savePath = qgcApp()->toolbox()->settingsManager()->appSettings()->videoSavePath();
+        if(savePath.isEmpty()) {
+            qgcApp()->showMessage(tr("Unabled to record video. Video save path must be specified in Settings."));
+            return;
+        }
+        fileBase = savePath + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss");
+    }
+
     //-- Disk usage maintenance
     _cleanupOldVideos();
+    _openSegment.clear();
 
-    _sink           = new Sink();
-    _sink->teepad   = gst_element_get_request_pad(_tee, "src_%u");
-    _sink->queue    = gst_element_factory_make("queue", NULL);
-    _sink->parse    = gst_element_factory_make("h264parse", NULL);
-    _sink->mux      = gst_element_factory_make(kVideoMuxes[muxIdx], NULL);
-    _sink->filesink = gst_element_factory_make("filesink", NULL);
-    _sink->removing = false;
+    if(!_attachRecordingQueue()) {
+        return;
+    }
+
+    GstElement* muxer   = gst_element_factory_make(kVideoMuxes[muxIdx], NULL);
+    _sink->mux          = gst_element_factory_make("splitmuxsink", NULL);
 
-    if(!_sink->teepad || !_sink->queue || !_sink->mux || !_sink->filesink || !_sink->parse) {
+    if(!muxer || !_sink->mux) {
         qCritical() << "VideoReceiver::startRecording() failed to make _sink elements";
+        if(muxer) {
+            gst_object_unref(muxer);
+        }
+        if(_sink->mux) {
+            gst_object_unref(_sink->mux);
+            _sink->mux = NULL;
+        }
         return;
     }
 
-    if(videoFile.isEmpty()) {
-        QString savePath = qgcApp()->toolbox()->settingsManager()->appSettings()->videoSavePath();
-        if(savePath.isEmpty()) {
-            qgcApp()->showMessage(tr("Unabled to record video. Video save path must be specified in Settings."));
-            return;
-        }
-        _videoFile = savePath + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss") + "." + kVideoExtensions[muxIdx];
-    } else {
+    //-- splitmuxsink expands the location with the segment number. A file given by the caller is
+    //   recorded as is, segments only apply to the generated file names.
+    QString extension = kVideoExtensions[muxIdx];
+    QString location;
+    guint64 segment   = 0;
+    if(!videoFile.isEmpty()) {
+        location   = QString(videoFile).replace("%", "%%");
         _videoFile = videoFile;
+    } else {
+        segment = static_cast<guint64>(_videoSettings->recordingSegmentDuration()->rawValue().toUInt()) * GST_SECOND;
+        location = QString(fileBase).replace("%", "%%");
+        if(segment > 0) {
+            location  += "_%03d." + extension;
+            _videoFile = fileBase + "_000." + extension;
+        } else {
+            location  += "." + extension;
+            _videoFile = fileBase + "." + extension;
+        }
     }
     emit videoFileChanged();
 
-    g_object_set(G_OBJECT(_sink->filesink), "location", qPrintable(_videoFile), NULL);
+    g_object_set(G_OBJECT(_sink->mux),
+                 "muxer",           muxer,
+                 "location",        qPrintable(location),
+                 "max-size-time",   segment,
+                 NULL);
     qCDebug(VideoReceiverLog) << "New video file:" << _videoFile;
 
-    gst_object_ref(_sink->queue);
-    gst_object_ref(_sink->parse);
     gst_object_ref(_sink->mux);
-    gst_object_ref(_sink->filesink);
-
-    gst_bin_add_many(GST_BIN(_pipeline), _sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
-    gst_element_link_many(_sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
-
-    gst_element_sync_state_with_parent(_sink->queue);
-    gst_element_sync_state_with_parent(_sink->parse);
+    gst_bin_add(GST_BIN(_pipeline), _sink->mux);
     gst_element_sync_state_with_parent(_sink->mux);
-    gst_element_sync_state_with_parent(_sink->filesink);
 
-    // Install a probe on the recording branch to drop buffers until we hit our first keyframe
-    // When we hit our first keyframe, we can offset the timestamps appropriately according to the first keyframe time
-    // This will ensure the first frame is a keyframe at t=0, and decoding can begin immediately on playback
-    GstPad* probepad = gst_element_get_static_pad(_sink->queue, "src");
-    gst_pad_add_probe(probepad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER /* | GST_PAD_PROBE_TYPE_BLOCK */), _keyframeWatch, this, NULL); // to drop the buffer or to block the buffer?
-    gst_object_unref(probepad);
+    _sink->muxpad = gst_element_get_request_pad(_sink->mux, "video");
+    GstPad* srcpad = gst_element_get_static_pad(_sink->queue, "src");
+    if(!_sink->muxpad || gst_pad_link(srcpad, _sink->muxpad) != GST_PAD_LINK_OK) {
+        qCritical() << "VideoReceiver::startRecording() failed to link recording branch";
+        gst_object_unref(srcpad);
+        if(_sink->muxpad) {
+            gst_element_release_request_pad(_sink->mux, _sink->muxpad);
+            gst_object_unref(_sink->muxpad);
+            _sink->muxpad = NULL;
+        }
+        gst_element_set_state(_sink->mux, GST_STATE_NULL);
+        gst_bin_remove(GST_BIN(_pipeline), _sink->mux);
+        gst_object_unref(_sink->mux);
+        _sink->mux = NULL;
+        return;
+    }
 
-    // Link the recording branch to the pipeline
-    GstPad* sinkpad = gst_element_get_static_pad(_sink->queue, "sink");
-    gst_pad_link(_sink->teepad, sinkpad);
-    gst_object_unref(sinkpad);
+    //-- Leave room for storage hiccups on top of the pre-roll which is written out first
+    guint64 preRoll = static_cast<guint64>(_videoSettings->recordingPreRoll()->rawValue().toUInt()) * GST_SECOND;
+    g_object_set(G_OBJECT(_sink->queue), "max-size-time", preRoll + kRecordingBacklog, NULL);
+
+    // Let the data through. _recordingWatch drops buffers until we hit our first keyframe and
+    // offsets the timestamps so the recording starts at zero.
+    g_atomic_int_set(&_sink->recording, TRUE);
+    if(_sink->blockProbe) {
+        gst_pad_remove_probe(srcpad, _sink->blockProbe);
+        _sink->blockProbe = 0;
+    }
+    gst_object_unref(srcpad);
 
     GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-recording");
 
+    _droppedFrames = 0;
     _recording = true;
     emit recordingChanged();
+    emit recordingDroppedFramesChanged();
     qCDebug(VideoReceiverLog) << "Recording started";
 #else
     Q_UNUSED(videoFile)
@@ -855,41 +1080,80 @@ VideoReceiver::stopRecording(void)
 #endif
 }
 
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+int
+VideoReceiver::recordingDroppedFrames()
+{
+    if(_recording && _sink) {
+        return g_atomic_int_get(&_sink->dropped);
+    }
+    return _droppedFrames;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_handleFragmentOpened(QString location)
+{
+    qCDebug(VideoReceiverLog) << "New video segment:" << location;
+    if(_videoFile != location) {
+        _videoFile = location;
+        emit videoFileChanged();
+    }
+    //-- Long recordings are kept within the storage limit segment by segment. The segment before this one is
+    //-- finished now, the directory is only scanned once the finished segments push past the limit.
+    if(_videoSettings->enableStorageLimit()->rawValue().toBool()) {
+        if(!_openSegment.isEmpty()) {
+            _videoStorageBytes += QFileInfo(_openSegment).size();
+        }
+        if(_videoStorageBytes >= _videoSettings->maxVideoSize()->rawValue().toUInt() * 1024ull * 1024ull) {
+            _cleanupOldVideos();
+        }
+    }
+    _openSegment = location;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // This is only installed on the transient _pipelineStopRec in order
 // to finalize a video file. It is not used for the main _pipeline.
 // -EOS has appeared on the bus of the temporary pipeline
 // -At this point all of the recoring elements have been flushed, and the video file has been finalized
 // -Now we can remove the temporary pipeline and its elements
+// -If pre-roll is enabled, start keeping a new pre-roll for the next recording
 #if defined(QGC_GST_STREAMING)
 void
 VideoReceiver::_shutdownRecordingBranch()
 {
     gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->queue);
-    gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->parse);
     gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->mux);
-    gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->filesink);
 
     gst_element_set_state(_pipelineStopRec, GST_STATE_NULL);
     gst_object_unref(_pipelineStopRec);
     _pipelineStopRec = NULL;
 
-    gst_element_set_state(_sink->filesink,  GST_STATE_NULL);
-    gst_element_set_state(_sink->parse,     GST_STATE_NULL);
     gst_element_set_state(_sink->mux,       GST_STATE_NULL);
     gst_element_set_state(_sink->queue,     GST_STATE_NULL);
 
-    gst_object_unref(_sink->queue);
-    gst_object_unref(_sink->parse);
-    gst_object_unref(_sink->mux);
-    gst_object_unref(_sink->filesink);
+    gst_element_release_request_pad(_sink->mux, _sink->muxpad);
 
-    delete _sink;
-    _sink = NULL;
+    _droppedFrames = g_atomic_int_get(&_sink->dropped);
+    if(_droppedFrames > 0) {
+        qWarning() << "VideoReceiver: storage too slow," << _droppedFrames << "frames were dropped from" << _videoFile;
+    }
+
+    _releaseSink();
     _recording = false;
 
     emit recordingChanged();
+    emit recordingDroppedFramesChanged();
     qCDebug(VideoReceiverLog) << "Recording Stopped";
+
+    if(_pipeline && _running && _videoSettings->recordingPreRoll()->rawValue().toUInt() > 0) {
+        _attachRecordingQueue();
+    }
 }
 #endif
 
@@ -905,18 +1169,21 @@ VideoReceiver::_detachRecordingBranch(GstPadProbeInfo* info)
     Q_UNUSED(info)
 
     // Also unlinks and unrefs
-    gst_bin_remove_many(GST_BIN(_pipeline), _sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
+    gst_bin_remove_many(GST_BIN(_pipeline), _sink->queue, _sink->mux, NULL);
 
     // Give tee its pad back
     gst_element_release_request_pad(_tee, _sink->teepad);
     gst_object_unref(_sink->teepad);
+    _sink->teepad = NULL;
 
     // Create temporary pipeline
     _pipelineStopRec = gst_pipeline_new("pipeStopRec");
 
     // Put our elements from the recording branch into the temporary pipeline
-    gst_bin_add_many(GST_BIN(_pipelineStopRec), _sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
-    gst_element_link_many(_sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
+    gst_bin_add_many(GST_BIN(_pipelineStopRec), _sink->queue, _sink->mux, NULL);
+    GstPad* srcpad = gst_element_get_static_pad(_sink->queue, "src");
+    gst_pad_link(srcpad, _sink->muxpad);
+    gst_object_unref(srcpad);
 
     // Add handler for EOS event
     GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(_pipelineStopRec));
@@ -941,6 +1208,7 @@ VideoReceiver::_detachRecordingBranch(GstPadProbeInfo* info)
 GstPadProbeReturn
 VideoReceiver::_unlinkCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
+    QGC_TRACE_SCOPE("video", "VideoReceiver::_unlinkCallBack");
     Q_UNUSED(pad);
     if(info != NULL && user_data != NULL) {
         VideoReceiver* pThis = (VideoReceiver*)user_data;
@@ -954,29 +1222,92 @@ VideoReceiver::_unlinkCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user
 #endif
 
 //-----------------------------------------------------------------------------
+// Holds the streaming thread of the pre-roll queue, so the queue fills up and leaks
 #if defined(QGC_GST_STREAMING)
 GstPadProbeReturn
-VideoReceiver::_keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+VideoReceiver::_preRollBlock(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
     Q_UNUSED(pad);
-    if(info != NULL && user_data != NULL) {
-        GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
-        if(GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT)) { // wait for a keyframe
-            return GST_PAD_PROBE_DROP;
-        } else {
-            VideoReceiver* pThis = (VideoReceiver*)user_data;
-            // reset the clock
-            GstClock* clock = gst_pipeline_get_clock(GST_PIPELINE(pThis->_pipeline));
-            GstClockTime time = gst_clock_get_time(clock);
-            gst_object_unref(clock);
-            gst_element_set_base_time(pThis->_pipeline, time); // offset pipeline timestamps to start at zero again
-            buf->dts = 0; // The offset will not apply to this current buffer, our first frame, timestamp is zero
-            buf->pts = 0;
-            qCDebug(VideoReceiverLog) << "Got keyframe, stop dropping buffers";
+    Q_UNUSED(info);
+    Q_UNUSED(user_data);
+    return GST_PAD_PROBE_OK;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// The recording queue is full. It drops its oldest buffers, which breaks the references of the
+// frames following them, so the recording skips ahead to the next keyframe.
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_recordingOverrun(GstElement* queue, gpointer user_data)
+{
+    QGC_TRACE_INSTANT("video", "VideoReceiver::_recordingOverrun");
+    Q_UNUSED(queue);
+    Sink* sink = (Sink*)user_data;
+    // Overruns are how the pre-roll works, they only count once recording
+    if(g_atomic_int_get(&sink->recording)) {
+        g_atomic_int_inc(&sink->dropped);
+        g_atomic_int_set(&sink->waitKeyframe, TRUE);
+    }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Called each time the leaky display queue is about to drop a decoded frame
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_displayOverrun(GstElement* queue, gpointer user_data)
+{
+    QGC_TRACE_INSTANT("video", "VideoReceiver::_displayOverrun");
+    Q_UNUSED(queue);
+    VideoReceiver* pThis = (VideoReceiver*)user_data;
+    g_atomic_int_inc(&pThis->_displayDropped);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Drop buffers until we hit a keyframe. On the first keyframe, offset the timestamps of the
+// recording branch so the first frame is at t=0 and decoding can begin immediately on playback.
+#if defined(QGC_GST_STREAMING)
+GstPadProbeReturn
+VideoReceiver::_recordingWatch(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    QGC_TRACE_SCOPE("video", "VideoReceiver::_recordingWatch");
+    if(info == NULL || user_data == NULL) {
+        return GST_PAD_PROBE_OK;
+    }
+    Sink* sink = (Sink*)user_data;
+    if(!g_atomic_int_get(&sink->waitKeyframe)) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
+    if(GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        if(sink->started) {
+            g_atomic_int_inc(&sink->dropped);
         }
+        return GST_PAD_PROBE_DROP;
     }
 
-    return GST_PAD_PROBE_REMOVE;
+    if(!sink->started) {
+        GstEvent* event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+        if(event) {
+            const GstSegment* segment = NULL;
+            gst_event_parse_segment(event, &segment);
+            GstClockTime time = GST_BUFFER_DTS_IS_VALID(buf) ? GST_BUFFER_DTS(buf) : GST_BUFFER_PTS(buf);
+            guint64 runningTime = gst_segment_to_running_time(segment, GST_FORMAT_TIME, time);
+            if(GST_CLOCK_TIME_IS_VALID(runningTime)) {
+                // The segment is sent again with the offset before this buffer goes out
+                gst_pad_set_offset(pad, -static_cast<gint64>(runningTime));
+            }
+            gst_event_unref(event);
+        }
+        sink->started = TRUE;
+        qCDebug(VideoReceiverLog) << "Got keyframe, stop dropping buffers";
+    }
+    g_atomic_int_set(&sink->waitKeyframe, FALSE);
+
+    return GST_PAD_PROBE_OK;
 }
 #endif
 
@@ -985,6 +1316,11 @@ void
 VideoReceiver::_updateTimer()
 {
 #if defined(QGC_GST_STREAMING)
+    int droppedFrames = recordingDroppedFrames();
+    if(droppedFrames != _reportedDroppedFrames) {
+        _reportedDroppedFrames = droppedFrames;
+        emit recordingDroppedFramesChanged();
+    }
     if(_videoSurface) {
         if(stopping() || starting()) {
             return;
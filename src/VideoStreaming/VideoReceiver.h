@@ -40,7 +40,11 @@ class VideoReceiver : public QObject
 public:
 #if defined(QGC_GST_STREAMING)
     Q_PROPERTY(bool             recording           READ    recording           NOTIFY recordingChanged)
+    Q_PROPERTY(int              recordingDroppedFrames READ recordingDroppedFrames NOTIFY recordingDroppedFramesChanged)
+    Q_PROPERTY(int              droppedFrames       READ    droppedFrames       NOTIFY streamStatsChanged)
+    Q_PROPERTY(int              latency             READ    latency             NOTIFY streamStatsChanged)
 #endif
+    Q_PROPERTY(int              nodeIndex           READ    nodeIndex           CONSTANT)
     Q_PROPERTY(VideoSurface*    videoSurface        READ    videoSurface        CONSTANT)
     Q_PROPERTY(bool             videoRunning        READ    videoRunning        NOTIFY  videoRunningChanged)
     Q_PROPERTY(QString          imageFile           READ    imageFile           NOTIFY  imageFileChanged)
@@ -56,8 +60,19 @@ public:
     virtual bool            streaming       () { return _streaming; }
     virtual bool            starting        () { return _starting;  }
     virtual bool            stopping        () { return _stopping;  }
+    virtual int             recordingDroppedFrames();
+    /// Frames lost on this stream since it started: network loss, late and display drops
+    virtual int             droppedFrames   () { return _streamDroppedFrames; }
+    /// Estimated glass-to-glass latency of this stream in milliseconds, 0 if not known yet
+    virtual int             latency         () { return _streamLatency; }
+    /// Total decoder threads for this stream, 0 for one per core. Applied when the pipeline starts.
+    virtual void            setDecoderThreads(int threads) { _decoderThreads = threads; }
 #endif
 
+    /// Index of the node this receiver streams from, -1 to follow the node selector
+    int                     nodeIndex       () const { return _nodeIndex; }
+    void                    setNodeIndex    (int nodeIndex) { _nodeIndex = nodeIndex; }
+
     virtual VideoSurface*   videoSurface    () { return _videoSurface; }
     virtual bool            videoRunning    () { return _videoRunning; }
     virtual QString         imageFile       () { return _imageFile; }
@@ -75,9 +90,12 @@ signals:
     void showFullScreenChanged              ();
 #if defined(QGC_GST_STREAMING)
     void recordingChanged                   ();
+    void recordingDroppedFramesChanged      ();
+    void streamStatsChanged                 ();
     void msgErrorReceived                   ();
     void msgEOSReceived                     ();
     void msgStateChangedReceived            ();
+    void msgFragmentOpenedReceived          (QString location);
 #endif
 
 public slots:
@@ -101,19 +119,27 @@ protected slots:
     virtual void _handleError               ();
     virtual void _handleEOS                 ();
     virtual void _handleStateChanged        ();
+    virtual void _handleFragmentOpened      (QString location);
     void _onStatsTimer                      ();
 #endif
 
 protected:
 #if defined(QGC_GST_STREAMING)
 
+    // Recording branch. The queue is leaky so a slow disk drops recorded frames instead of
+    // stalling the tee and with it the live view. While only pre-rolling, the queue src pad is
+    // blocked and the queue holds the last few seconds of stream in memory.
     typedef struct
     {
         GstPad*         teepad;
         GstElement*     queue;
-        GstElement*     mux;
-        GstElement*     filesink;
-        GstElement*     parse;
+        GstElement*     mux;            ///< splitmuxsink, NULL until recording starts
+        GstPad*         muxpad;
+        gulong          blockProbe;     ///< Holds the pre-roll in the queue, 0 once recording
+        gint            recording;      ///< Buffers flow into the mux
+        gint            waitKeyframe;   ///< Drop delta units until the next keyframe
+        gint            dropped;        ///< Frames lost from the recording after it started
+        gboolean        started;        ///< First keyframe has been recorded
         gboolean        removing;
     } Sink;
 
@@ -128,8 +154,13 @@ protected:
 
     static gboolean             _onBusMessage           (GstBus* bus, GstMessage* message, gpointer user_data);
     static GstPadProbeReturn    _unlinkCallBack         (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
-    static GstPadProbeReturn    _keyframeWatch          (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn    _recordingWatch         (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn    _preRollBlock           (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static void                 _recordingOverrun       (GstElement* queue, gpointer user_data);
+    static void                 _displayOverrun         (GstElement* queue, gpointer user_data);
 
+    virtual bool                _attachRecordingQueue   ();
+    virtual void                _releaseSink            ();
     virtual void                _detachRecordingBranch  (GstPadProbeInfo* info);
     virtual void                _shutdownRecordingBranch();
     virtual void                _shutdownPipeline       ();
@@ -141,6 +172,16 @@ protected:
     GstElement*     _videoSink;
     GstElement*     _jitterBuffer;
     QTimer          _statsTimer;
+    int             _droppedFrames;         ///< Dropped frames of the last finished recording
+    quint64         _videoStorageBytes;     ///< Size of the saved videos as of the last cleanup plus finished segments since
+    QString         _openSegment;           ///< Segment splitmuxsink is writing to, not counted in _videoStorageBytes yet
+    int             _reportedDroppedFrames;
+    int             _decoderThreads;
+    int             _streamDroppedFrames;
+    int             _streamLatency;
+    gint            _displayDropped;        ///< Decoded frames leaked by the display queue
+    gint            _qosDropped;            ///< Frames the video sink reported as dropped
+    gint            _qosJitterUs;           ///< Last lateness reported by the video sink
 
     //-- Wait for Video Server to show up before starting
     QTimer          _frameTimer;
@@ -152,6 +193,7 @@ protected:
 #endif
 
     NodeSelector*   _nodeSelector;
+    int             _nodeIndex;
     QString         _uri;
     quint16         _jitterLatency;
     quint32         _expectedLatency;
@@ -0,0 +1,225 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "VideoReceiverPool.h"
+#include "VideoReceiver.h"
+#include "VideoSettings.h"
+#include "QGCCorePlugin.h"
+#include "nodeselector.h"
+
+#include <QThread>
+
+QGC_LOGGING_CATEGORY(VideoReceiverPoolLog, "VideoReceiverPoolLog")
+
+VideoReceiverPool::VideoReceiverPool(NodeSelector* nodeSelector, VideoSettings* videoSettings, QGCCorePlugin* corePlugin, QObject* parent)
+    : QObject(parent)
+    , _nodeSelector(nodeSelector)
+    , _videoSettings(videoSettings)
+    , _corePlugin(corePlugin)
+    , _active(NULL)
+{
+    connect(_videoSettings->poolSize(),         &Fact::rawValueChanged, this, &VideoReceiverPool::_poolSizeChanged);
+    connect(_videoSettings->decoderThreads(),   &Fact::rawValueChanged, this, &VideoReceiverPool::_decoderThreadsChanged);
+#if defined(QGC_GST_STREAMING)
+    connect(_nodeSelector->discoverer(), &PiDiscoverer::nodeDiscovered, this, &VideoReceiverPool::_nodeDiscovered);
+    connect(_nodeSelector->discoverer(), &PiDiscoverer::nodeLost,       this, &VideoReceiverPool::_nodeLost);
+    _active = receiver(_nodeSelector->currentNodeIndex());
+#else
+    _active = receiver(-1);
+#endif
+}
+
+VideoReceiverPool::~VideoReceiverPool()
+{
+    qDeleteAll(_receivers);
+}
+
+VideoReceiver* VideoReceiverPool::receiver(int nodeIndex)
+{
+    for (int i = 0; i < _receivers.count(); i++) {
+        if (_receivers[i]->nodeIndex() == nodeIndex) {
+            return _receivers[i];
+        }
+    }
+    return _create(nodeIndex);
+}
+
+VideoReceiver* VideoReceiverPool::_create(int nodeIndex)
+{
+    VideoReceiver* videoReceiver = _corePlugin->createVideoReceiver(_nodeSelector, this);
+    videoReceiver->setNodeIndex(nodeIndex);
+    videoReceiver->setJitter(_videoSettings->jitterBuffer()->rawValue().toUInt());
+    _receivers.append(videoReceiver);
+    _applyDecoderThreads();
+    qCDebug(VideoReceiverPoolLog) << "Receiver added for node" << nodeIndex << "pool size" << _receivers.count();
+    return videoReceiver;
+}
+
+void VideoReceiverPool::activate(int nodeIndex)
+{
+    VideoReceiver* videoReceiver = receiver(nodeIndex);
+
+    // Keep most recently used first so _trim() drops the coldest streams
+    _receivers.removeOne(videoReceiver);
+    _receivers.prepend(videoReceiver);
+
+    if (videoReceiver != _active) {
+        _active = videoReceiver;
+        qCDebug(VideoReceiverPoolLog) << "Active node" << nodeIndex;
+        emit activeChanged();
+    }
+
+#if defined(QGC_GST_STREAMING)
+    // Cold node, bring it up with the options the last stream was started with
+    if (!_active->running() && !_nodeSelector->streamingOptions().isEmpty()) {
+        _active->delayedStart(_nodeSelector->streamingOptions(), _nodeSelector->recordingStatus());
+    }
+#endif
+
+    _trim();
+}
+
+void VideoReceiverPool::next()
+{
+#if defined(QGC_GST_STREAMING)
+    _nodeSelector->selectNext();
+    activate(_nodeSelector->currentNodeIndex());
+#endif
+}
+
+void VideoReceiverPool::previous()
+{
+#if defined(QGC_GST_STREAMING)
+    _nodeSelector->selectPrevious();
+    activate(_nodeSelector->currentNodeIndex());
+#endif
+}
+
+void VideoReceiverPool::startAll()
+{
+    for (int i = 0; i < _receivers.count(); i++) {
+        _receivers[i]->start();
+    }
+}
+
+void VideoReceiverPool::stopAll()
+{
+    for (int i = 0; i < _receivers.count(); i++) {
+        _receivers[i]->stop();
+    }
+}
+
+void VideoReceiverPool::setJitter(quint16 jitter)
+{
+    for (int i = 0; i < _receivers.count(); i++) {
+        _receivers[i]->setJitter(jitter);
+    }
+}
+
+void VideoReceiverPool::_nodeDiscovered(const PiNode& node)
+{
+#if defined(QGC_GST_STREAMING)
+    // Only warm up new cameras once we know how streams are being started and there is room
+    if (!(node.caps & PiNode::PICAM) || _nodeSelector->streamingOptions().isEmpty() || _receivers.count() >= _poolSize()) {
+        return;
+    }
+    int nodeIndex = _nodeSelector->discoverer()->indexOf(node.uniqueId);
+    if (nodeIndex < 0) {
+        return;
+    }
+    VideoReceiver* videoReceiver = receiver(nodeIndex);
+    if (!videoReceiver->running()) {
+        qCDebug(VideoReceiverPoolLog) << "Warming up node" << nodeIndex << node.addressString;
+        videoReceiver->delayedStart(_nodeSelector->streamingOptions(), _nodeSelector->recordingStatus());
+    }
+#else
+    Q_UNUSED(node);
+#endif
+}
+
+/// The stream of a lost node is gone with it. Warm receivers are released to make room for live
+/// nodes, the active one is stopped so it is started again when the node comes back.
+void VideoReceiverPool::_nodeLost(const PiNode& node)
+{
+#if defined(QGC_GST_STREAMING)
+    int nodeIndex = _nodeSelector->discoverer()->indexOf(node.uniqueId);
+    for (int i = 0; i < _receivers.count(); i++) {
+        VideoReceiver* videoReceiver = _receivers[i];
+        if (videoReceiver->nodeIndex() != nodeIndex) {
+            continue;
+        }
+        qCDebug(VideoReceiverPoolLog) << "Node lost" << nodeIndex << node.addressString;
+        if (videoReceiver == _active) {
+            videoReceiver->stop();
+        } else {
+            _receivers.removeAt(i);
+            videoReceiver->deleteLater();
+            _applyDecoderThreads();
+        }
+        break;
+    }
+#else
+    Q_UNUSED(node);
+#endif
+}
+
+void VideoReceiverPool::_trim()
+{
+    int poolSize = _poolSize();
+    while (_receivers.count() > poolSize) {
+        VideoReceiver* videoReceiver = _receivers.last();
+        if (videoReceiver == _active) {
+            break;
+        }
+        _receivers.removeLast();
+        qCDebug(VideoReceiverPoolLog) << "Releasing node" << videoReceiver->nodeIndex();
+#if defined(QGC_GST_STREAMING)
+        if (videoReceiver->nodeIndex() >= 0) {
+            _nodeSelector->stopStreaming(videoReceiver->nodeIndex());
+        }
+#endif
+        videoReceiver->deleteLater();
+    }
+    _applyDecoderThreads();
+}
+
+/// Splits the decoder thread budget evenly across the warm streams. Running pipelines keep the
+/// thread count they were started with, so a switch never restarts a warm stream.
+void VideoReceiverPool::_applyDecoderThreads()
+{
+#if defined(QGC_GST_STREAMING)
+    if (_receivers.isEmpty()) {
+        return;
+    }
+    int budget = _videoSettings->decoderThreads()->rawValue().toInt();
+    if (budget <= 0) {
+        budget = QThread::idealThreadCount();
+    }
+    int threads = qMax(1, budget / _receivers.count());
+    for (int i = 0; i < _receivers.count(); i++) {
+        _receivers[i]->setDecoderThreads(threads);
+    }
+#endif
+}
+
+int VideoReceiverPool::_poolSize()
+{
+    return qMax(1, _videoSettings->poolSize()->rawValue().toInt());
+}
+
+void VideoReceiverPool::_poolSizeChanged()
+{
+    _trim();
+}
+
+void VideoReceiverPool::_decoderThreadsChanged()
+{
+    _applyDecoderThreads();
+}
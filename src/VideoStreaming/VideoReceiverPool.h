@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef VideoReceiverPool_H
+#define VideoReceiverPool_H
+
+#include <QObject>
+#include <QList>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(VideoReceiverPoolLog)
+
+class VideoReceiver;
+class VideoSettings;
+class NodeSelector;
+class PiNode;
+class QGCCorePlugin;
+
+/// Keeps one VideoReceiver per camera node decoding in the background so switching the displayed
+/// node only swaps which receiver is active instead of tearing down and rebuilding a pipeline.
+/// Each receiver decodes into its own VideoSurface.
+class VideoReceiverPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    VideoReceiverPool(NodeSelector* nodeSelector, VideoSettings* videoSettings, QGCCorePlugin* corePlugin, QObject* parent = NULL);
+    ~VideoReceiverPool();
+
+    /// Receiver for the node currently selected in the node selector
+    VideoReceiver*  active          () { return _active; }
+
+    /// Receiver for the given node, created if it is not in the pool yet
+    VideoReceiver*  receiver        (int nodeIndex);
+
+    /// Number of receivers currently kept in the pool
+    int             count           () const { return _receivers.count(); }
+
+    /// Makes the receiver for the node the active one. Least recently used receivers beyond
+    /// the pool size are stopped and released.
+    void            activate        (int nodeIndex);
+
+    /// Applied to every pooled receiver
+    void            startAll        ();
+    void            stopAll         ();
+    void            setJitter       (quint16 jitter);
+
+public slots:
+    void            next            ();
+    void            previous        ();
+
+signals:
+    void            activeChanged   ();
+
+private slots:
+    void            _nodeDiscovered     (const PiNode& node);
+    void            _nodeLost           (const PiNode& node);
+    void            _poolSizeChanged    ();
+    void            _decoderThreadsChanged();
+
+private:
+    VideoReceiver*  _create             (int nodeIndex);
+    void            _trim               ();
+    void            _applyDecoderThreads();
+    int             _poolSize           ();
+
+    NodeSelector*           _nodeSelector;
+    VideoSettings*          _videoSettings;
+    QGCCorePlugin*          _corePlugin;
+    QList<VideoReceiver*>   _receivers;     ///< Most recently used first
+    VideoReceiver*          _active;
+};
+
+#endif
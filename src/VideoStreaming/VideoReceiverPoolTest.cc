@@ -0,0 +1,122 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoReceiverPoolTest.h"
+#include "VideoReceiverPool.h"
+#include "VideoReceiver.h"
+#include "VideoSettings.h"
+#include "SettingsManager.h"
+#include "QGCApplication.h"
+#include "nodeselector.h"
+
+#include <QPointer>
+#include <QSignalSpy>
+
+static const int _cNodes = 3;
+
+VideoReceiverPoolTest::VideoReceiverPoolTest(void)
+{
+
+}
+
+void VideoReceiverPoolTest::init(void)
+{
+    UnitTest::init();
+
+    PiDiscoverer* discoverer = NodeSelector::instance()->discoverer();
+    _savedNodes = discoverer->discoveredNodes();
+    _savedPoolSize = qgcApp()->toolbox()->settingsManager()->videoSettings()->poolSize()->rawValue();
+
+    PiNodeList nodes;
+    for (int i = 0; i < _cNodes; i++) {
+        PiNode node;
+        node.addressString = QStringLiteral("10.0.0.%1").arg(i + 1);
+        node.uniqueId = QStringLiteral("node%1").arg(i);
+        nodes.append(node);
+    }
+    discoverer->setDiscoveredNodes(nodes);
+}
+
+void VideoReceiverPoolTest::cleanup(void)
+{
+    NodeSelector::instance()->discoverer()->setDiscoveredNodes(_savedNodes);
+    qgcApp()->toolbox()->settingsManager()->videoSettings()->poolSize()->setRawValue(_savedPoolSize);
+
+    UnitTest::cleanup();
+}
+
+void VideoReceiverPoolTest::_testRotation(void)
+{
+    NodeSelector* nodeSelector = NodeSelector::instance();
+    VideoSettings* videoSettings = qgcApp()->toolbox()->settingsManager()->videoSettings();
+    videoSettings->poolSize()->setRawValue(_cNodes);
+
+    VideoReceiverPool pool(nodeSelector, videoSettings, qgcApp()->toolbox()->corePlugin());
+    QSignalSpy activeSpy(&pool, &VideoReceiverPool::activeChanged);
+
+    int firstNode = nodeSelector->currentNodeIndex();
+    VideoReceiver* receivers[_cNodes] = { NULL };
+    receivers[firstNode] = pool.active();
+    QCOMPARE(pool.active()->nodeIndex(), firstNode);
+
+    // A full round forward brings up a receiver per node and ends up back on the first one
+    for (int i = 1; i <= _cNodes; i++) {
+        pool.next();
+        int node = (firstNode + i) % _cNodes;
+        QCOMPARE(nodeSelector->currentNodeIndex(), node);
+        QCOMPARE(pool.active()->nodeIndex(), node);
+        if (receivers[node]) {
+            // Warm receivers are switched to, not created again
+            QCOMPARE(pool.active(), receivers[node]);
+        }
+        receivers[node] = pool.active();
+    }
+    QCOMPARE(activeSpy.count(), _cNodes);
+    QCOMPARE(pool.count(), _cNodes);
+
+    // And back again
+    pool.previous();
+    int node = (firstNode + _cNodes - 1) % _cNodes;
+    QCOMPARE(nodeSelector->currentNodeIndex(), node);
+    QCOMPARE(pool.active(), receivers[node]);
+    pool.next();
+    QCOMPARE(pool.active(), receivers[firstNode]);
+    QCOMPARE(activeSpy.count(), _cNodes + 2);
+    QCOMPARE(pool.count(), _cNodes);
+}
+
+void VideoReceiverPoolTest::_testEviction(void)
+{
+    NodeSelector* nodeSelector = NodeSelector::instance();
+    VideoSettings* videoSettings = qgcApp()->toolbox()->settingsManager()->videoSettings();
+    videoSettings->poolSize()->setRawValue(2);
+
+    VideoReceiverPool pool(nodeSelector, videoSettings, qgcApp()->toolbox()->corePlugin());
+
+    QPointer<VideoReceiver> receiverA = pool.active();
+    pool.next();
+    QPointer<VideoReceiver> receiverB = pool.active();
+    QCOMPARE(pool.count(), 2);
+
+    // Going back to A makes B the least recently used, so B goes when the third node comes in the other way round
+    pool.previous();
+    QCOMPARE(pool.active(), receiverA.data());
+    pool.previous();
+    QPointer<VideoReceiver> receiverC = pool.active();
+    QCOMPARE(pool.count(), 2);
+    QVERIFY(receiverC != receiverA && receiverC != receiverB);
+    QTRY_VERIFY(receiverB.isNull());
+    QVERIFY(!receiverA.isNull());
+
+    // Shrinking the pool keeps only the active receiver
+    videoSettings->poolSize()->setRawValue(1);
+    QCOMPARE(pool.count(), 1);
+    QCOMPARE(pool.active(), receiverC.data());
+    QTRY_VERIFY(receiverA.isNull());
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "pidiscoverer.h"
+
+/// Unit test for VideoReceiverPool. Stand-in nodes without camera caps are put into the node selector so no
+/// commands go out to the network.
+class VideoReceiverPoolTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    VideoReceiverPoolTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _testRotation(void);
+    void _testEviction(void);
+
+private:
+    PiNodeList  _savedNodes;
+    QVariant    _savedPoolSize;
+};
@@ -0,0 +1,210 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoReceiverTest.h"
+#include "VideoReceiver.h"
+#include "VideoSettings.h"
+#include "AppSettings.h"
+#include "SettingsManager.h"
+#include "QGCApplication.h"
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QUdpSocket>
+#include <QScopedPointer>
+
+VideoReceiverTest::VideoReceiverTest(void)
+{
+
+}
+
+void VideoReceiverTest::init(void)
+{
+    UnitTest::init();
+
+    SettingsManager* settingsManager = qgcApp()->toolbox()->settingsManager();
+    VideoSettings* videoSettings = settingsManager->videoSettings();
+    _savedFacts.clear();
+    _savedFacts << videoSettings->videoSource()
+                << videoSettings->udpPort()
+                << videoSettings->streamEnabled()
+                << videoSettings->recordingFormat()
+                << videoSettings->recordingPreRoll()
+                << videoSettings->recordingSegmentDuration()
+                << settingsManager->appSettings()->savePath();
+    _savedValues.clear();
+    foreach (Fact* fact, _savedFacts) {
+        _savedValues.append(fact->rawValue());
+    }
+}
+
+void VideoReceiverTest::cleanup(void)
+{
+    for (int i = 0; i < _savedFacts.count(); i++) {
+        _savedFacts[i]->setRawValue(_savedValues[i]);
+    }
+    _savedFacts.clear();
+    _savedValues.clear();
+
+    UnitTest::cleanup();
+}
+
+/// @return true if this build can stream and record the test video
+static bool _testElementsAvailable(void)
+{
+#if defined(QGC_GST_STREAMING)
+    const char* requiredElements[] = { "videotestsrc", "x264enc", "rtph264pay", "udpsink", "splitmuxsink", "matroskamux" };
+    for (size_t i = 0; i < sizeof(requiredElements) / sizeof(requiredElements[0]); i++) {
+        GstElementFactory* factory = gst_element_factory_find(requiredElements[i]);
+        if (!factory) {
+            qWarning() << "GStreamer element not available:" << requiredElements[i];
+            return false;
+        }
+        gst_object_unref(factory);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(QGC_GST_STREAMING)
+/// QScopedPointer cleanup for a pipeline, stops it before releasing it
+struct GstPipelineCleanup
+{
+    static void cleanup(GstElement* pipeline)
+    {
+        if (pipeline) {
+            gst_element_set_state(pipeline, GST_STATE_NULL);
+            gst_object_unref(pipeline);
+        }
+    }
+};
+#endif
+
+void VideoReceiverTest::_record(uint preRollSecs, uint segmentSecs, int liveMsecs, const QString& fileName, QStringList& files)
+{
+#if defined(QGC_GST_STREAMING)
+    // Find a free port
+    QUdpSocket socket;
+    QVERIFY(socket.bind(QHostAddress::LocalHost, 0));
+    quint16 port = socket.localPort();
+    socket.close();
+
+    VideoSettings* videoSettings = qgcApp()->toolbox()->settingsManager()->videoSettings();
+    videoSettings->videoSource()->setRawValue(VideoSettings::videoSourceUDP);
+    videoSettings->udpPort()->setRawValue(port);
+    videoSettings->streamEnabled()->setRawValue(true);
+    videoSettings->recordingFormat()->setRawValue(0);   // mkv
+    videoSettings->recordingPreRoll()->setRawValue(preRollSecs);
+    videoSettings->recordingSegmentDuration()->setRawValue(segmentSecs);
+
+    // Declared ahead of the receiver and sender so a failed check stops both before the directory goes away
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QScopedPointer<VideoReceiver> receiver(new VideoReceiver(NULL));
+    receiver->setUri(QStringLiteral("udp://0.0.0.0:%1").arg(port));
+    receiver->start();
+    QVERIFY(receiver->running());
+
+    // Short GOP so keyframe waits and segment splits stay small compared to the test durations
+    QString senderDescription = QStringLiteral("videotestsrc is-live=true pattern=ball ! video/x-raw,width=320,height=240,framerate=30/1 ! "
+                                               "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=10 ! "
+                                               "rtph264pay config-interval=1 pt=96 ! udpsink host=127.0.0.1 port=%1").arg(port);
+    GError* error = NULL;
+    QScopedPointer<GstElement, GstPipelineCleanup> sender(gst_parse_launch(qPrintable(senderDescription), &error));
+    if (error) {
+        g_error_free(error);
+    }
+    QVERIFY(sender);
+    QVERIFY(gst_element_set_state(sender.data(), GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+    // Wait for decoded frames, then give the pre-roll time to fill up
+    QTRY_VERIFY_WITH_TIMEOUT(receiver->videoSurface()->lastFrame() != 0, 10000);
+    QTest::qWait(static_cast<int>(preRollSecs * 1000) + 500);
+
+    AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
+    appSettings->savePath()->setRawValue(dir.path());
+    QString recordingPath = fileName.isEmpty() ? appSettings->videoSavePath() : dir.path();
+    QVERIFY(QDir().mkpath(recordingPath));
+    receiver->startRecording(fileName.isEmpty() ? QString() : dir.filePath(fileName));
+    QVERIFY(receiver->recording());
+    QTest::qWait(liveMsecs);
+    receiver->stopRecording();
+    QTRY_VERIFY_WITH_TIMEOUT(!receiver->recording(), 10000);
+
+    // Local disk keeps up with a 320x240 stream
+    QCOMPARE(receiver->recordingDroppedFrames(), 0);
+
+    sender.reset();
+    receiver.reset();
+
+    files.clear();
+    foreach (const QFileInfo& fileInfo, QDir(recordingPath).entryInfoList(QStringList(QStringLiteral("*.mkv")), QDir::Files, QDir::Name)) {
+        QVERIFY2(fileInfo.size() > 0, qPrintable(fileInfo.fileName()));
+        files.append(fileInfo.fileName());
+    }
+#else
+    Q_UNUSED(preRollSecs);
+    Q_UNUSED(segmentSecs);
+    Q_UNUSED(liveMsecs);
+    Q_UNUSED(fileName);
+    Q_UNUSED(files);
+#endif
+}
+
+void VideoReceiverTest::_testColdRecording(void)
+{
+    if (!_testElementsAvailable()) {
+        QSKIP("Video streaming or test elements not available");
+    }
+
+    QStringList files;
+    _record(0, 0, 2000, QStringLiteral("test.mkv"), files);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QCOMPARE(files, QStringList(QStringLiteral("test.mkv")));
+}
+
+void VideoReceiverTest::_testExplicitFileNotSegmented(void)
+{
+    if (!_testElementsAvailable()) {
+        QSKIP("Video streaming or test elements not available");
+    }
+
+    // A file name given by the caller is used as is, even with segmenting on
+    QStringList files;
+    _record(0, 1, 2500, QStringLiteral("test.mkv"), files);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QCOMPARE(files, QStringList(QStringLiteral("test.mkv")));
+}
+
+void VideoReceiverTest::_testPreRollSegmentedRecording(void)
+{
+    if (!_testElementsAvailable()) {
+        QSKIP("Video streaming or test elements not available");
+    }
+
+    QStringList files;
+    _record(3, 1, 1500, QString(), files);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // 1.5 seconds live would only fill two one second segments, the pre-roll adds almost
+    // three more seconds which were captured before recording started
+    QVERIFY2(files.count() >= 4, qPrintable(files.join(", ")));
+    QVERIFY2(files.first().endsWith(QStringLiteral("_000.mkv")), qPrintable(files.first()));
+}
@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class VideoReceiver;
+class Fact;
+
+/// Records from a local videotestsrc/x264enc RTP stream, so no camera hardware is needed
+class VideoReceiverTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    VideoReceiverTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _testColdRecording(void);
+    void _testExplicitFileNotSegmented(void);
+    void _testPreRollSegmentedRecording(void);
+
+private:
+    /// Streams test video to the receiver, records liveMsecs of it and returns the recorded files
+    ///     @param fileName File name to record to, empty to record to the video save path with generated names
+    void _record(uint preRollSecs, uint segmentSecs, int liveMsecs, const QString& fileName, QStringList& files);
+
+    QList<Fact*>    _savedFacts;    ///< Settings changed by the test
+    QVariantList    _savedValues;   ///< Values of _savedFacts before the test
+};
@@ -97,6 +97,7 @@ LinuxBuild {
             -lgstrtpmanager \
             -lgstisomp4 \
             -lgstmatroska \
+            -lgstmultifile \
 
         # Rest of GStreamer dependencies
         LIBS += -L$$GST_ROOT/lib \
@@ -50,11 +50,20 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPointer& config, bool isPX4F
     , _enableRateCollection     (false)
     , _decodedFirstMavlinkPacket(false)
     , _isPX4Flow                (isPX4Flow)
+    , _metrics                  (new LinkMetricsFactGroup(config->name()))
+    , _sendQueueHasControl      (false)
+    , _sendFlushPending         (false)
+    , _sendCoalescing           (false)
+    , _sendCoalesceTimer        (NULL)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 
     _config->setLink(this);
 
+    // Metrics are not a child of the link since some links move themselves to their own thread. They need to
+    // stay on the gui thread along with the rest of the Facts.
+    QQmlEngine::setObjectOwnership(_metrics, QQmlEngine::CppOwnership);
+
     // Initialize everything for the data rate calculation buffers.
     _inDataIndex  = 0;
     _outDataIndex = 0;
@@ -65,10 +74,114 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPointer& config, bool isPX4F
     memset(_outDataWriteAmounts,0, sizeof(_outDataWriteAmounts));
     memset(_outDataWriteTimes,  0, sizeof(_outDataWriteTimes));
 
-    QObject::connect(this, &LinkInterface::_invokeWriteBytes, this, &LinkInterface::_writeBytes);
+    // Always queued, even for links which live on the gui thread, so that everything sent before the link gets to
+    // run goes out together
+    QObject::connect(this, &LinkInterface::_invokeWriteBytes, this, &LinkInterface::_writeBytesQueued, Qt::QueuedConnection);
+
+    // Direct connection so received bytes are counted on the link's thread as they are handed off to the gui thread
+    LinkMetricsFactGroup* metrics = _metrics;
+    QObject::connect(this, &LinkInterface::bytesReceived, _metrics, [metrics](LinkInterface* link, QByteArray bytes) {
+        Q_UNUSED(link);
+        metrics->receiveQueued(bytes.size());
+    }, Qt::DirectConnection);
     qRegisterMetaType<LinkInterface*>("LinkInterface*");
 }
 
+void LinkInterface::writeBytesSafe(const char *bytes, int length, SendPriority_t priority)
+{
+    bool postFlush = false;
+    int queuedMessages;
+
+    _metrics->sendQueued(length);
+
+    {
+        QMutexLocker locker(&_sendQueueMutex);
+
+        _sendQueue.append(QByteArray(bytes, length));
+        queuedMessages = _sendQueue.count();
+        if (priority == SendPriorityControl) {
+            _sendQueueHasControl = true;
+        }
+
+        // A control message cuts short the wait for more RTCM/bulk messages
+        if (!_sendFlushPending || (priority == SendPriorityControl && _sendCoalescing)) {
+            postFlush = true;
+            _sendFlushPending = true;
+            _sendCoalescing = false;
+        }
+    }
+
+    _metrics->sendQueueDepth(queuedMessages);
+    if (postFlush) {
+        emit _invokeWriteBytes();
+    }
+}
+
+void LinkInterface::_writeBytesQueued(void)
+{
+    QList<QByteArray> messages;
+
+    {
+        QMutexLocker locker(&_sendQueueMutex);
+
+        if (_sendQueue.isEmpty()) {
+            // Already flushed by an earlier call
+            return;
+        }
+
+        if (!_sendCoalescing && !_sendQueueHasControl) {
+            // Only RTCM and bulk messages so far, give the rest of the burst a chance to show up
+            if (!_sendCoalesceTimer) {
+                _sendCoalesceTimer = new QTimer(this);
+                _sendCoalesceTimer->setSingleShot(true);
+                _sendCoalesceTimer->setInterval(_sendCoalesceMSecs);
+                QObject::connect(_sendCoalesceTimer, &QTimer::timeout, this, &LinkInterface::_writeBytesQueued);
+            }
+            _sendCoalescing = true;
+            _sendCoalesceTimer->start();
+            return;
+        }
+
+        messages.swap(_sendQueue);
+        _sendQueueHasControl = false;
+        _sendFlushPending = false;
+        _sendCoalescing = false;
+    }
+
+    if (_sendCoalesceTimer) {
+        _sendCoalesceTimer->stop();
+    }
+
+    int bytes = 0;
+    foreach (const QByteArray& message, messages) {
+        bytes += message.size();
+    }
+    _metrics->sent(bytes);
+    _metrics->sentBatch(messages.count());
+
+    _writeMessages(messages);
+}
+
+void LinkInterface::_writeMessages(const QList<QByteArray>& messages)
+{
+    if (messages.count() == 1) {
+        _writeBytes(messages.first());
+        return;
+    }
+
+    int bytes = 0;
+    foreach (const QByteArray& message, messages) {
+        bytes += message.size();
+    }
+
+    QByteArray buffer;
+    buffer.reserve(bytes);
+    foreach (const QByteArray& message, messages) {
+        buffer.append(message);
+    }
+    _writeBytes(buffer);
+}
+
 /// This function logs the send times and amounts of datas for input. Data is used for calculating
 /// the transmission rate.
 ///     @param byteCount Number of bytes received
@@ -22,6 +22,7 @@
 #include "QGCMAVLink.h"
 #include "LinkConfiguration.h"
 #include "MavlinkMessagesTimer.h"
+#include "LinkMetricsFactGroup.h"
 
 class LinkManager;
 
@@ -41,10 +42,12 @@ public:
     virtual ~LinkInterface() {
         stopMavlinkMessagesTimer();
         _config->setLink(NULL);
+        _metrics->deleteLater();
     }
 
     Q_PROPERTY(bool active      READ active     NOTIFY activeChanged)
     Q_PROPERTY(bool isPX4Flow   READ isPX4Flow  CONSTANT)
+    Q_PROPERTY(FactGroup* metrics READ metricsFactGroup CONSTANT)
 
     Q_INVOKABLE bool link_active(int vehicle_id) const;
     Q_INVOKABLE bool getHighLatency(void) const { return _highLatency; }
@@ -52,9 +55,20 @@ public:
     // Property accessors
     bool active() const;
     bool isPX4Flow(void) const { return _isPX4Flow; }
+    FactGroup* metricsFactGroup(void) { return _metrics; }
+    LinkMetricsFactGroup* metrics(void) { return _metrics; }
 
     LinkConfiguration* getLinkConfiguration(void) { return _config.data(); }
 
+    /// Send priority classes. Messages always go out in the order they were queued, the class only decides whether
+    /// the link flushes right away or waits briefly for more messages to go out with.
+    typedef enum {
+        SendPriorityControl,    ///< Commands, heartbeats and anything else which needs to go out right away
+        SendPriorityRTCM,       ///< GPS correction data
+        SendPriorityBulk,       ///< Parameter, mission, log and file transfers
+        SendPriorityCount
+    } SendPriority_t;
+
     /* Connection management */
 
     /**
@@ -143,28 +157,31 @@ public slots:
     /**
      * @brief This method allows to write bytes to the interface.
      *
-     * If the underlying communication is packet oriented,
-     * one write command equals a datagram. In case of serial
-     * communication arbitrary byte lengths can be written. The method ensures
-     * thread safety regardless of the underlying LinkInterface implementation.
+     * The bytes are added to the link's send queue and written from the link's thread. Everything queued
+     * before the link gets to run goes out in a single write, in the order it was queued. A control message
+     * flushes the queue as soon as the link gets to run, RTCM and bulk messages are held for up to
+     * _sendCoalesceMSecs so that bursts of them go out together. If the underlying
+     * communication is packet oriented every message still goes out in a packet of its own.
+     * The method ensures thread safety regardless of the underlying LinkInterface implementation.
      *
      * @param bytes The pointer to the byte array containing the data
      * @param length The length of the data array
+     * @param priority Send priority class of the data
      **/
-    void writeBytesSafe(const char *bytes, int length)
-    {
-        emit _invokeWriteBytes(QByteArray(bytes, length));
-    }
+    void writeBytesSafe(const char *bytes, int length, SendPriority_t priority = SendPriorityControl);
 
 private slots:
     virtual void _writeBytes(const QByteArray) = 0;
 
+    /// Runs on the link's thread to flush the send queue
+    void _writeBytesQueued(void);
+
     void _activeChanged(bool active, int vehicle_id);
     
 signals:
     void autoconnectChanged(bool autoconnect);
     void activeChanged(LinkInterface* link, bool active, int vehicle_id);
-    void _invokeWriteBytes(QByteArray);
+    void _invokeWriteBytes(void);
     void highLatencyChanged(bool highLatency);
 
     /// Signalled when a link suddenly goes away due to it being removed by for example pulling the cable to the connection.
@@ -218,6 +235,12 @@ protected:
     ///     @param time Time in ms receive occurred
     void _logOutputDataRate(quint64 byteCount, qint64 time);
 
+    /// Writes the messages taken from the send queue, called on the link's thread. The default implementation
+    /// writes all of them with a single _writeBytes call. Packet oriented links override this to decide how the
+    /// messages are split into packets.
+    ///     @param messages Messages in send order, each one a complete message
+    virtual void _writeMessages(const QList<QByteArray>& messages);
+
     SharedLinkConfigurationPointer _config;
     bool _highLatency;
 
@@ -303,6 +326,17 @@ private:
     bool _decodedFirstMavlinkPacket;    ///< true: link has correctly decoded it's first mavlink packet
     bool _isPX4Flow;
 
+    LinkMetricsFactGroup* _metrics;
+
+    QMutex              _sendQueueMutex;                        ///< Protects the send queue members, writeBytesSafe can be called from any thread
+    QList<QByteArray>   _sendQueue;                             ///< FIFO across all priority classes
+    bool                _sendQueueHasControl;                   ///< true: A control message is queued, flush without waiting
+    bool                _sendFlushPending;                      ///< true: A flush has been posted to the link's thread
+    bool                _sendCoalescing;                        ///< true: The flush is holding off for more RTCM/bulk messages
+    QTimer*             _sendCoalesceTimer;                     ///< Created on the link's thread by the first flush which needs it
+
+    static const int _sendCoalesceMSecs = 2;    ///< How long RTCM and bulk messages wait for more messages to go out with
+
     QMap<int /* vehicle id */, MavlinkMessagesTimer*> _mavlinkMessagesTimers;
 };
 
@@ -51,6 +51,9 @@ LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
     , _mavlinkChannelsUsedBitMask(1)    // We never use channel 0 to avoid sequence numbering problems
     , _autoConnectSettings(NULL)
     , _mavlinkProtocol(NULL)
+#ifndef NO_SERIAL_LINK
+    , _serialPortWatcher(NULL)
+#endif
 #ifndef __mobile__
     , _nmeaPort(NULL)
 #endif
@@ -82,8 +85,20 @@ void LinkManager::setToolbox(QGCToolbox *toolbox)
 
     connect(_mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &LinkManager::_mavlinkMessageReceived);
 
+#ifndef NO_SERIAL_LINK
+    // Port enumeration happens on the watcher thread, autoconnect only works from the port table it keeps
+    if (!qgcApp()->runningUnitTests()) {
+        _serialPortWatcher = new SerialPortWatcher(this);
+        connect(_serialPortWatcher, &SerialPortWatcher::portAdded,   this, &LinkManager::_serialPortAdded);
+        connect(_serialPortWatcher, &SerialPortWatcher::portRemoved, this, &LinkManager::_serialPortRemoved);
+        _serialPortWatcher->start();
+    }
+#endif
+    _autoconnectClock.start();
+
+    // Port changes are handled as they come in, the timer takes care of everything else such as settings changes
     connect(&_portListTimer, &QTimer::timeout, this, &LinkManager::_updateAutoConnectLinks);
-    _portListTimer.start(_autoconnectUpdateTimerMSecs); // timeout must be long enough to get past bootloader on second pass
+    _portListTimer.start(_autoconnectUpdateTimerMSecs);
 
 }
 
@@ -482,22 +497,33 @@ void LinkManager::_updateAutoConnectLinks(void)
     }
 
 #ifndef NO_SERIAL_LINK
+    if (!_serialPortWatcher) {
+        return;
+    }
+
     QStringList currentPorts;
-    QList<QGCSerialPortInfo> portList;
+    QList<SerialPortWatcher::PortInfo_t> portList;
 
 #ifdef __android__
     // Android builds only support a single serial connection. Repeatedly calling availablePorts after that one serial
     // port is connected leaks file handles due to a bug somewhere in android serial code. In order to work around that
     // bug after we connect the first serial port we stop probing for additional ports.
+    _serialPortWatcher->setSuspended(_sharedAutoconnectConfigurations.count() > 0);
     if (!_sharedAutoconnectConfigurations.count()) {
-        portList = QGCSerialPortInfo::availablePorts();
+        portList = _serialPortWatcher->ports().values();
     }
 #else
-    portList = QGCSerialPortInfo::availablePorts();
+    portList = _serialPortWatcher->ports().values();
 #endif
 
     // Iterate Comm Ports
-    foreach (QGCSerialPortInfo portInfo, portList) {
+    foreach (const SerialPortWatcher::PortInfo_t& port, portList) {
+        if (port.systemPort) {
+            // Only listed for manual connections
+            continue;
+        }
+        const QGCSerialPortInfo& portInfo = port.portInfo;
+
         qCDebug(LinkManagerVerboseLog) << "-----------------------------------------------------";
         qCDebug(LinkManagerVerboseLog) << "portName:          " << portInfo.portName();
         qCDebug(LinkManagerVerboseLog) << "systemLocation:    " << portInfo.systemLocation();
@@ -510,8 +536,8 @@ void LinkManager::_updateAutoConnectLinks(void)
         // Save port name
         currentPorts << portInfo.systemLocation();
 
-        QGCSerialPortInfo::BoardType_t boardType;
-        QString boardName;
+        QGCSerialPortInfo::BoardType_t boardType = port.boardType;
+        QString boardName = port.boardName;
 
 #ifndef __mobile__
         if (portInfo.systemLocation().trimmed() == _autoConnectSettings->autoConnectNmeaPort()->cookedValueString()) {
@@ -539,8 +565,8 @@ void LinkManager::_updateAutoConnectLinks(void)
             }
         } else
 #endif
-        if (portInfo.getBoardInfo(boardType, boardName)) {
-            if (portInfo.isBootloader()) {
+        if (port.knownBoard) {
+            if (port.bootloader) {
                 // Don't connect to bootloader
                 qCDebug(LinkManagerLog) << "Waiting for bootloader to finish" << portInfo.systemLocation();
                 continue;
@@ -551,10 +577,10 @@ void LinkManager::_updateAutoConnectLinks(void)
             } else if (!_autoconnectWaitList.contains(portInfo.systemLocation())) {
                 // We don't connect to the port the first time we see it. The ability to correctly detect whether we
                 // are in the bootloader is flaky from a cross-platform standpoint. So by putting it on a wait list
-                // and only connect on the second pass we leave enough time for the board to boot up.
+                // and only connecting once the connect delay has passed we leave enough time for the board to boot up.
                 qCDebug(LinkManagerLog) << "Waiting for next autoconnect pass" << portInfo.systemLocation();
-                _autoconnectWaitList[portInfo.systemLocation()] = 1;
-            } else if (++_autoconnectWaitList[portInfo.systemLocation()] * _autoconnectUpdateTimerMSecs > _autoconnectConnectDelayMSecs) {
+                _autoconnectWaitList[portInfo.systemLocation()] = _autoconnectClock.elapsed();
+            } else if (_autoconnectClock.elapsed() - _autoconnectWaitList[portInfo.systemLocation()] >= _autoconnectConnectDelayMSecs) {
                 SerialConfiguration* pSerialConfig = NULL;
 
                 _autoconnectWaitList.remove(portInfo.systemLocation());
@@ -664,6 +690,31 @@ void LinkManager::_updateAutoConnectLinks(void)
 #endif // NO_SERIAL_LINK
 }
 
+#ifndef NO_SERIAL_LINK
+void LinkManager::_serialPortAdded(const SerialPortWatcher::PortInfo_t& port)
+{
+    Q_UNUSED(port);
+
+    // The port goes on the wait list now, and gets connected once the connect delay has passed
+    _updateAutoConnectLinks();
+    QTimer::singleShot(_autoconnectConnectDelayMSecs, Qt::PreciseTimer, this, &LinkManager::_updateAutoConnectLinks);
+
+    _updateSerialPorts();
+    emit commPortsChanged();
+    emit commPortStringsChanged();
+}
+
+void LinkManager::_serialPortRemoved(const QString& systemLocation)
+{
+    _autoconnectWaitList.remove(systemLocation);
+    _updateAutoConnectLinks();
+
+    _updateSerialPorts();
+    emit commPortsChanged();
+    emit commPortStringsChanged();
+}
+#endif
+
 void LinkManager::shutdown(void)
 {
     setConnectionsSuspended(tr("Shutdown"));
@@ -702,10 +753,18 @@ void LinkManager::_updateSerialPorts()
     _commPortList.clear();
     _commPortDisplayList.clear();
 #ifndef NO_SERIAL_LINK
-    QList<QSerialPortInfo> portList = QSerialPortInfo::availablePorts();
-    foreach (const QSerialPortInfo &info, portList)
+    QStringList systemLocations;
+    if (_serialPortWatcher) {
+        // Includes the system ports autoconnect skips, same list as QSerialPortInfo::availablePorts
+        systemLocations = _serialPortWatcher->ports().keys();
+    } else {
+        foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()) {
+            systemLocations += info.systemLocation();
+        }
+    }
+    foreach (const QString& systemLocation, systemLocations)
     {
-        QString port = info.systemLocation().trimmed();
+        QString port = systemLocation.trimmed();
         _commPortList += port;
         _commPortDisplayList += SerialConfiguration::cleanPortDisplayname(port);
     }
@@ -17,6 +17,7 @@
 #include <QList>
 #include <QMultiMap>
 #include <QMutex>
+#include <QElapsedTimer>
 
 #include "LinkConfiguration.h"
 #include "LinkInterface.h"
@@ -31,6 +32,7 @@
 
 #ifndef NO_SERIAL_LINK
     #include "SerialLink.h"
+    #include "SerialPortWatcher.h"
 #endif
 
 #ifdef QT_DEBUG
@@ -190,6 +192,8 @@ private slots:
     void _linkConnectionRemoved(LinkInterface* link);
 #ifndef NO_SERIAL_LINK
     void _activeLinkCheck(void);
+    void _serialPortAdded(const SerialPortWatcher::PortInfo_t& port);
+    void _serialPortRemoved(const QString& systemLocation);
 #endif
 
 private:
@@ -222,11 +226,13 @@ private:
     QString                                 _autoConnectRTKPort;
     QmlObjectListModel                      _qmlConfigurations;
 
-    QMap<QString, int>  _autoconnectWaitList;   ///< key: QGCSerialPortInfo.systemLocation, value: wait count
+    QMap<QString, qint64>   _autoconnectWaitList;   ///< key: QGCSerialPortInfo.systemLocation, value: _autoconnectClock msecs when first seen
+    QElapsedTimer           _autoconnectClock;
     QStringList _commPortList;
     QStringList _commPortDisplayList;
 
 #ifndef NO_SERIAL_LINK
+    SerialPortWatcher*  _serialPortWatcher;                     ///< Serial port table for autoconnect, NULL when not watching
     QTimer              _activeLinkCheckTimer;                  ///< Timer which checks for a vehicle showing up on a usb direct link
     QList<SerialLink*>  _activeLinkCheckList;                   ///< List of links we are waiting for a vehicle to show up on
     static const int    _activeLinkCheckTimeoutMSecs = 15000;   ///< Amount of time to wait for a heatbeat. Keep in mind ArduPilot stack heartbeat is slow to come.
@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkMetricsFactGroup.h"
+
+#include <limits>
+
+QGC_LOGGING_CATEGORY(LinkMetricsLog, "LinkMetricsLog")
+
+const char* LinkMetricsFactGroup::_bytesInRateFactName =        "bytesInRate";
+const char* LinkMetricsFactGroup::_bytesOutRateFactName =       "bytesOutRate";
+const char* LinkMetricsFactGroup::_messagesInRateFactName =     "messagesInRate";
+const char* LinkMetricsFactGroup::_messagesOutRateFactName =    "messagesOutRate";
+const char* LinkMetricsFactGroup::_bytesInFactName =            "bytesIn";
+const char* LinkMetricsFactGroup::_bytesOutFactName =           "bytesOut";
+const char* LinkMetricsFactGroup::_messagesLostFactName =       "messagesLost";
+const char* LinkMetricsFactGroup::_parseLoadFactName =          "parseLoad";
+const char* LinkMetricsFactGroup::_receiveBacklogFactName =     "receiveBacklog";
+const char* LinkMetricsFactGroup::_sendBacklogFactName =        "sendBacklog";
+const char* LinkMetricsFactGroup::_sendQueuePeakFactName =      "sendQueuePeak";
+const char* LinkMetricsFactGroup::_messagesPerWriteFactName =   "messagesPerWrite";
+const char* LinkMetricsFactGroup::_rttFactName =                "rtt";
+const char* LinkMetricsFactGroup::_rttP95FactName =             "rttP95";
+
+const int LinkMetricsFactGroup::_rgRttBucketLimitsMsecs[LinkMetricsFactGroup::_cRttBuckets - 1] = { 10, 25, 50, 100, 250, 500, 1000 };
+
+LinkMetricsFactGroup::LinkMetricsFactGroup(const QString& linkName, QObject* parent)
+    : FactGroup             (1000, ":/json/LinkMetricsFact.json", parent)
+    , _linkName             (linkName)
+    , _bytesInCount         (0)
+    , _bytesOutCount        (0)
+    , _messagesInCount      (0)
+    , _messagesOutCount     (0)
+    , _messagesLostCount    (0)
+    , _parseNsecs           (0)
+    , _receiveQueuedBytes   (0)
+    , _receivedBytes        (0)
+    , _sendQueuedBytes      (0)
+    , _sentBytes            (0)
+    , _sendQueuePeak        (0)
+    , _writesCount          (0)
+    , _batchedMessagesCount (0)
+    , _lastRttUsecs         (-1)
+    , _lastBytesIn          (0)
+    , _lastBytesOut         (0)
+    , _lastMessagesIn       (0)
+    , _lastMessagesOut      (0)
+    , _lastParseNsecs       (0)
+    , _lastWrites           (0)
+    , _lastBatchedMessages  (0)
+    , _bytesInRateFact      (0, _bytesInRateFactName,       FactMetaData::valueTypeDouble)
+    , _bytesOutRateFact     (0, _bytesOutRateFactName,      FactMetaData::valueTypeDouble)
+    , _messagesInRateFact   (0, _messagesInRateFactName,    FactMetaData::valueTypeDouble)
+    , _messagesOutRateFact  (0, _messagesOutRateFactName,   FactMetaData::valueTypeDouble)
+    , _bytesInFact          (0, _bytesInFactName,           FactMetaData::valueTypeUint64)
+    , _bytesOutFact         (0, _bytesOutFactName,          FactMetaData::valueTypeUint64)
+    , _messagesLostFact     (0, _messagesLostFactName,      FactMetaData::valueTypeUint64)
+    , _parseLoadFact        (0, _parseLoadFactName,         FactMetaData::valueTypeDouble)
+    , _receiveBacklogFact   (0, _receiveBacklogFactName,    FactMetaData::valueTypeInt64)
+    , _sendBacklogFact      (0, _sendBacklogFactName,       FactMetaData::valueTypeInt64)
+    , _sendQueuePeakFact    (0, _sendQueuePeakFactName,     FactMetaData::valueTypeUint32)
+    , _messagesPerWriteFact (0, _messagesPerWriteFactName,  FactMetaData::valueTypeDouble)
+    , _rttFact              (0, _rttFactName,               FactMetaData::valueTypeDouble)
+    , _rttP95Fact           (0, _rttP95FactName,            FactMetaData::valueTypeDouble)
+{
+    for (int i=0; i<_cRttBuckets; i++) {
+        _rttBuckets[i].store(0);
+    }
+
+    _addFact(&_bytesInRateFact,     _bytesInRateFactName);
+    _addFact(&_bytesOutRateFact,    _bytesOutRateFactName);
+    _addFact(&_messagesInRateFact,  _messagesInRateFactName);
+    _addFact(&_messagesOutRateFact, _messagesOutRateFactName);
+    _addFact(&_bytesInFact,         _bytesInFactName);
+    _addFact(&_bytesOutFact,        _bytesOutFactName);
+    _addFact(&_messagesLostFact,    _messagesLostFactName);
+    _addFact(&_parseLoadFact,       _parseLoadFactName);
+    _addFact(&_receiveBacklogFact,  _receiveBacklogFactName);
+    _addFact(&_sendBacklogFact,     _sendBacklogFactName);
+    _addFact(&_sendQueuePeakFact,   _sendQueuePeakFactName);
+    _addFact(&_messagesPerWriteFact,_messagesPerWriteFactName);
+    _addFact(&_rttFact,             _rttFactName);
+    _addFact(&_rttP95Fact,          _rttP95FactName);
+
+    // Not available "--.--" until there is a measurement
+    _rttFact.setRawValue   (std::numeric_limits<float>::quiet_NaN());
+    _rttP95Fact.setRawValue(std::numeric_limits<float>::quiet_NaN());
+
+    _intervalTimer.start();
+}
+
+void LinkMetricsFactGroup::received(int bytes, int messages, qint64 parseNsecs)
+{
+    _receivedBytes.fetchAndAddRelaxed(bytes);
+    _bytesInCount.fetchAndAddRelaxed(bytes);
+    _messagesInCount.fetchAndAddRelaxed(messages);
+    _parseNsecs.fetchAndAddRelaxed(parseNsecs);
+}
+
+void LinkMetricsFactGroup::sendQueued(int bytes)
+{
+    _sendQueuedBytes.fetchAndAddRelaxed(bytes);
+    _messagesOutCount.fetchAndAddRelaxed(1);
+}
+
+void LinkMetricsFactGroup::sent(int bytes)
+{
+    _sentBytes.fetchAndAddRelaxed(bytes);
+    _bytesOutCount.fetchAndAddRelaxed(bytes);
+}
+
+void LinkMetricsFactGroup::sendQueueDepth(int messages)
+{
+    int peak = _sendQueuePeak.load();
+    while (messages > peak && !_sendQueuePeak.testAndSetRelaxed(peak, messages)) {
+        peak = _sendQueuePeak.load();
+    }
+}
+
+void LinkMetricsFactGroup::sentBatch(int messages)
+{
+    _writesCount.fetchAndAddRelaxed(1);
+    _batchedMessagesCount.fetchAndAddRelaxed(messages);
+}
+
+void LinkMetricsFactGroup::roundTrip(qint64 usecs)
+{
+    int bucket = 0;
+    while (bucket < _cRttBuckets - 1 && usecs >= _rgRttBucketLimitsMsecs[bucket] * 1000) {
+        bucket++;
+    }
+    _rttBuckets[bucket].fetchAndAddRelaxed(1);
+    _lastRttUsecs.store(usecs);
+}
+
+QVariantList LinkMetricsFactGroup::rttHistogram(void) const
+{
+    QVariantList histogram;
+    for (int i=0; i<_cRttBuckets; i++) {
+        histogram.append(_rttBuckets[i].load());
+    }
+    return histogram;
+}
+
+QVariantList LinkMetricsFactGroup::rttBucketLimits(void) const
+{
+    QVariantList limits;
+    for (int i=0; i<_cRttBuckets - 1; i++) {
+        limits.append(_rgRttBucketLimitsMsecs[i]);
+    }
+    return limits;
+}
+
+void LinkMetricsFactGroup::_updateAllValues(void)
+{
+    double seconds = _intervalTimer.restart() / 1000.0;
+    if (seconds <= 0) {
+        return;
+    }
+
+    quint64 bytesIn         = _bytesInCount.load();
+    quint64 bytesOut        = _bytesOutCount.load();
+    quint64 messagesIn      = _messagesInCount.load();
+    quint64 messagesOut     = _messagesOutCount.load();
+    quint64 parseNsecs      = _parseNsecs.load();
+    quint64 writes          = _writesCount.load();
+    quint64 batchedMessages = _batchedMessagesCount.load();
+
+    _bytesInRateFact.setRawValue    ((bytesIn - _lastBytesIn) / seconds);
+    _bytesOutRateFact.setRawValue   ((bytesOut - _lastBytesOut) / seconds);
+    _messagesInRateFact.setRawValue ((messagesIn - _lastMessagesIn) / seconds);
+    _messagesOutRateFact.setRawValue((messagesOut - _lastMessagesOut) / seconds);
+    _bytesInFact.setRawValue        (bytesIn);
+    _bytesOutFact.setRawValue       (bytesOut);
+    _messagesLostFact.setRawValue   (_messagesLostCount.load());
+    // Percentage of the gui thread spent parsing this link
+    _parseLoadFact.setRawValue      (((parseNsecs - _lastParseNsecs) / 1.0e7) / seconds);
+    _receiveBacklogFact.setRawValue (_receiveQueuedBytes.load() - _receivedBytes.load());
+    _sendBacklogFact.setRawValue    (_sendQueuedBytes.load() - _sentBytes.load());
+    _sendQueuePeakFact.setRawValue  (_sendQueuePeak.fetchAndStoreRelaxed(0));
+    if (writes != _lastWrites) {
+        _messagesPerWriteFact.setRawValue(static_cast<double>(batchedMessages - _lastBatchedMessages) / (writes - _lastWrites));
+    }
+
+    _lastBytesIn        = bytesIn;
+    _lastBytesOut       = bytesOut;
+    _lastMessagesIn     = messagesIn;
+    _lastMessagesOut    = messagesOut;
+    _lastParseNsecs     = parseNsecs;
+    _lastWrites         = writes;
+    _lastBatchedMessages= batchedMessages;
+
+    qint64 lastRttUsecs = _lastRttUsecs.load();
+    if (lastRttUsecs >= 0) {
+        _rttFact.setRawValue(lastRttUsecs / 1000.0);
+
+        // 95th percentile, reported as the upper limit of the bucket it falls in
+        quint32 rgCounts[_cRttBuckets];
+        quint64 total = 0;
+        for (int i=0; i<_cRttBuckets; i++) {
+            rgCounts[i] = _rttBuckets[i].load();
+            total += rgCounts[i];
+        }
+        quint64 cumulative = 0;
+        for (int i=0; i<_cRttBuckets; i++) {
+            cumulative += rgCounts[i];
+            if (cumulative * 100 >= total * 95) {
+                _rttP95Fact.setRawValue(i < _cRttBuckets - 1 ? _rgRttBucketLimitsMsecs[i] : std::numeric_limits<float>::infinity());
+                break;
+            }
+        }
+        emit rttHistogramChanged();
+    }
+
+    qCDebug(LinkMetricsLog) << _linkName
+                            << "in B/s:"        << _bytesInRateFact.rawValue().toDouble()
+                            << "out B/s:"       << _bytesOutRateFact.rawValue().toDouble()
+                            << "in msg/s:"      << _messagesInRateFact.rawValue().toDouble()
+                            << "out msg/s:"     << _messagesOutRateFact.rawValue().toDouble()
+                            << "lost:"          << _messagesLostFact.rawValue().toULongLong()
+                            << "parse %:"       << _parseLoadFact.rawValue().toDouble()
+                            << "rx backlog:"    << _receiveBacklogFact.rawValue().toLongLong()
+                            << "tx backlog:"    << _sendBacklogFact.rawValue().toLongLong()
+                            << "tx queue peak:" << _sendQueuePeakFact.rawValue().toUInt()
+                            << "msg/write:"     << _messagesPerWriteFact.rawValue().toDouble()
+                            << "rtt ms:"        << _rttFact.rawValue().toDouble();
+
+    FactGroup::_updateAllValues();
+}
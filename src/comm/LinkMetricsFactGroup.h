@@ -0,0 +1,169 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FactGroup.h"
+#include "QGCLoggingCategory.h"
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QVariantList>
+
+Q_DECLARE_LOGGING_CATEGORY(LinkMetricsLog)
+
+/// Throughput, parse cost, backlog and round trip time metrics for a single link.
+///
+/// The record methods are called from the link thread (bytes received and written) as well as the gui thread
+/// (parsing, sends queued) so they only touch atomic counters. The Facts are refreshed from the counters once
+/// a second on the gui thread. Turning on LinkMetricsLog logs a line per link each time the Facts refresh.
+class LinkMetricsFactGroup : public FactGroup
+{
+    Q_OBJECT
+
+public:
+    LinkMetricsFactGroup(const QString& linkName, QObject* parent = NULL);
+
+    Q_PROPERTY(Fact* bytesInRate        READ bytesInRate        CONSTANT)
+    Q_PROPERTY(Fact* bytesOutRate       READ bytesOutRate       CONSTANT)
+    Q_PROPERTY(Fact* messagesInRate     READ messagesInRate     CONSTANT)
+    Q_PROPERTY(Fact* messagesOutRate    READ messagesOutRate    CONSTANT)
+    Q_PROPERTY(Fact* bytesIn            READ bytesIn            CONSTANT)
+    Q_PROPERTY(Fact* bytesOut           READ bytesOut           CONSTANT)
+    Q_PROPERTY(Fact* messagesLost       READ messagesLost       CONSTANT)
+    Q_PROPERTY(Fact* parseLoad          READ parseLoad          CONSTANT)
+    Q_PROPERTY(Fact* receiveBacklog     READ receiveBacklog     CONSTANT)
+    Q_PROPERTY(Fact* sendBacklog        READ sendBacklog        CONSTANT)
+    Q_PROPERTY(Fact* sendQueuePeak      READ sendQueuePeak      CONSTANT)
+    Q_PROPERTY(Fact* messagesPerWrite   READ messagesPerWrite   CONSTANT)
+    Q_PROPERTY(Fact* rtt                READ rtt                CONSTANT)
+    Q_PROPERTY(Fact* rttP95             READ rttP95             CONSTANT)
+
+    /// Round trip time counts per bucket, see rttBucketLimits
+    Q_PROPERTY(QVariantList rttHistogram        READ rttHistogram   NOTIFY rttHistogramChanged)
+    /// Upper limit in msecs of each rttHistogram bucket, the last bucket has no upper limit
+    Q_PROPERTY(QVariantList rttBucketLimits     READ rttBucketLimits CONSTANT)
+
+    Fact* bytesInRate       (void) { return &_bytesInRateFact; }
+    Fact* bytesOutRate      (void) { return &_bytesOutRateFact; }
+    Fact* messagesInRate    (void) { return &_messagesInRateFact; }
+    Fact* messagesOutRate   (void) { return &_messagesOutRateFact; }
+    Fact* bytesIn           (void) { return &_bytesInFact; }
+    Fact* bytesOut          (void) { return &_bytesOutFact; }
+    Fact* messagesLost      (void) { return &_messagesLostFact; }
+    Fact* parseLoad         (void) { return &_parseLoadFact; }
+    Fact* receiveBacklog    (void) { return &_receiveBacklogFact; }
+    Fact* sendBacklog       (void) { return &_sendBacklogFact; }
+    Fact* sendQueuePeak     (void) { return &_sendQueuePeakFact; }
+    Fact* messagesPerWrite  (void) { return &_messagesPerWriteFact; }
+    Fact* rtt               (void) { return &_rttFact; }
+    Fact* rttP95            (void) { return &_rttP95Fact; }
+
+    QVariantList rttHistogram   (void) const;
+    QVariantList rttBucketLimits(void) const;
+
+    // Recording, thread safe
+
+    /// Link has handed received bytes off to the gui thread
+    void receiveQueued(int bytes) { _receiveQueuedBytes.fetchAndAddRelaxed(bytes); }
+
+    /// Received bytes have been parsed
+    ///     @param bytes Number of bytes parsed, these are no longer part of the receive backlog
+    ///     @param messages Number of complete messages parsed from the bytes
+    ///     @param parseNsecs Time taken to parse the bytes
+    void received(int bytes, int messages, qint64 parseNsecs);
+
+    /// Messages were found missing in the received sequence numbers
+    void lost(int messages) { _messagesLostCount.fetchAndAddRelaxed(messages); }
+
+    /// A message has been handed to the link for sending
+    void sendQueued(int bytes);
+
+    /// Bytes queued for sending have been written to the link
+    void sent(int bytes);
+
+    /// Number of messages waiting in the link's send queue, the largest value since the last update is reported
+    void sendQueueDepth(int messages);
+
+    /// The link has written a batch of messages from its send queue with a single write
+    void sentBatch(int messages);
+
+    /// A round trip time has been measured, from the TIMESYNC exchange with a vehicle on the link
+    void roundTrip(qint64 usecs);
+
+    static const char* _bytesInRateFactName;
+    static const char* _bytesOutRateFactName;
+    static const char* _messagesInRateFactName;
+    static const char* _messagesOutRateFactName;
+    static const char* _bytesInFactName;
+    static const char* _bytesOutFactName;
+    static const char* _messagesLostFactName;
+    static const char* _parseLoadFactName;
+    static const char* _receiveBacklogFactName;
+    static const char* _sendBacklogFactName;
+    static const char* _sendQueuePeakFactName;
+    static const char* _messagesPerWriteFactName;
+    static const char* _rttFactName;
+    static const char* _rttP95FactName;
+
+    static const int _cRttBuckets = 8;
+
+signals:
+    void rttHistogramChanged(void);
+
+private slots:
+    void _updateAllValues(void) override;
+
+private:
+    QString         _linkName;
+    QElapsedTimer   _intervalTimer;         ///< Time since last update
+
+    // Cumulative counters, written from any thread
+    QAtomicInteger<quint64> _bytesInCount;
+    QAtomicInteger<quint64> _bytesOutCount;
+    QAtomicInteger<quint64> _messagesInCount;
+    QAtomicInteger<quint64> _messagesOutCount;
+    QAtomicInteger<quint64> _messagesLostCount;
+    QAtomicInteger<quint64> _parseNsecs;
+    QAtomicInteger<qint64>  _receiveQueuedBytes;
+    QAtomicInteger<qint64>  _receivedBytes;
+    QAtomicInteger<qint64>  _sendQueuedBytes;
+    QAtomicInteger<qint64>  _sentBytes;
+    QAtomicInteger<int>     _sendQueuePeak;     ///< Reset on each update
+    QAtomicInteger<quint64> _writesCount;
+    QAtomicInteger<quint64> _batchedMessagesCount;
+    QAtomicInteger<qint64>  _lastRttUsecs;      ///< -1 until first measurement
+    QAtomicInteger<quint32> _rttBuckets[_cRttBuckets];
+
+    // Counter values at the last update, gui thread only
+    quint64 _lastBytesIn;
+    quint64 _lastBytesOut;
+    quint64 _lastMessagesIn;
+    quint64 _lastMessagesOut;
+    quint64 _lastParseNsecs;
+    quint64 _lastWrites;
+    quint64 _lastBatchedMessages;
+
+    Fact _bytesInRateFact;
+    Fact _bytesOutRateFact;
+    Fact _messagesInRateFact;
+    Fact _messagesOutRateFact;
+    Fact _bytesInFact;
+    Fact _bytesOutFact;
+    Fact _messagesLostFact;
+    Fact _parseLoadFact;
+    Fact _receiveBacklogFact;
+    Fact _sendBacklogFact;
+    Fact _sendQueuePeakFact;
+    Fact _messagesPerWriteFact;
+    Fact _rttFact;
+    Fact _rttP95Fact;
+
+    static const int _rgRttBucketLimitsMsecs[_cRttBuckets - 1];
+};
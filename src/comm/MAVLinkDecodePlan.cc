@@ -0,0 +1,227 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2018 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkDecodePlan.h"
+
+#include <string.h>
+
+static const char* _typeName(uint8_t type)
+{
+    switch (type) {
+    case MAVLINK_TYPE_CHAR:     return "char";
+    case MAVLINK_TYPE_UINT8_T:  return "uint8_t";
+    case MAVLINK_TYPE_INT8_T:   return "int8_t";
+    case MAVLINK_TYPE_UINT16_T: return "uint16_t";
+    case MAVLINK_TYPE_INT16_T:  return "int16_t";
+    case MAVLINK_TYPE_UINT32_T: return "uint32_t";
+    case MAVLINK_TYPE_INT32_T:  return "int32_t";
+    case MAVLINK_TYPE_UINT64_T: return "uint64_t";
+    case MAVLINK_TYPE_INT64_T:  return "int64_t";
+    case MAVLINK_TYPE_FLOAT:    return "float";
+    case MAVLINK_TYPE_DOUBLE:   return "double";
+    }
+    return "unknown";
+}
+
+static unsigned _typeSize(uint8_t type)
+{
+    switch (type) {
+    case MAVLINK_TYPE_CHAR:
+    case MAVLINK_TYPE_UINT8_T:
+    case MAVLINK_TYPE_INT8_T:
+        return 1;
+    case MAVLINK_TYPE_UINT16_T:
+    case MAVLINK_TYPE_INT16_T:
+        return 2;
+    case MAVLINK_TYPE_UINT32_T:
+    case MAVLINK_TYPE_INT32_T:
+    case MAVLINK_TYPE_FLOAT:
+        return 4;
+    case MAVLINK_TYPE_UINT64_T:
+    case MAVLINK_TYPE_INT64_T:
+    case MAVLINK_TYPE_DOUBLE:
+        return 8;
+    }
+    return 0;
+}
+
+// Payload values are read through memcpy so there are no alignment assumptions on the payload
+template<typename T>
+static T _read(const uint8_t* payload, unsigned offset)
+{
+    T value;
+    memcpy(&value, payload + offset, sizeof(T));
+    return value;
+}
+
+static double _readDouble(const uint8_t* payload, uint8_t type, unsigned offset)
+{
+    switch (type) {
+    case MAVLINK_TYPE_CHAR:     return _read<char>(payload, offset);
+    case MAVLINK_TYPE_UINT8_T:  return _read<uint8_t>(payload, offset);
+    case MAVLINK_TYPE_INT8_T:   return _read<int8_t>(payload, offset);
+    case MAVLINK_TYPE_UINT16_T: return _read<uint16_t>(payload, offset);
+    case MAVLINK_TYPE_INT16_T:  return _read<int16_t>(payload, offset);
+    case MAVLINK_TYPE_UINT32_T: return _read<uint32_t>(payload, offset);
+    case MAVLINK_TYPE_INT32_T:  return _read<int32_t>(payload, offset);
+    case MAVLINK_TYPE_UINT64_T: return static_cast<double>(_read<uint64_t>(payload, offset));
+    case MAVLINK_TYPE_INT64_T:  return static_cast<double>(_read<int64_t>(payload, offset));
+    case MAVLINK_TYPE_FLOAT:    return _read<float>(payload, offset);
+    case MAVLINK_TYPE_DOUBLE:   return _read<double>(payload, offset);
+    }
+    return 0;
+}
+
+static QVariant _readVariant(const uint8_t* payload, uint8_t type, unsigned offset)
+{
+    switch (type) {
+    case MAVLINK_TYPE_CHAR:     return _read<char>(payload, offset);
+    case MAVLINK_TYPE_UINT8_T:  return _read<uint8_t>(payload, offset);
+    case MAVLINK_TYPE_INT8_T:   return _read<int8_t>(payload, offset);
+    case MAVLINK_TYPE_UINT16_T: return _read<uint16_t>(payload, offset);
+    case MAVLINK_TYPE_INT16_T:  return _read<int16_t>(payload, offset);
+    case MAVLINK_TYPE_UINT32_T: return _read<uint32_t>(payload, offset);
+    case MAVLINK_TYPE_INT32_T:  return _read<int32_t>(payload, offset);
+    case MAVLINK_TYPE_UINT64_T: return static_cast<quint64>(_read<uint64_t>(payload, offset));
+    case MAVLINK_TYPE_INT64_T:  return static_cast<qint64>(_read<int64_t>(payload, offset));
+    case MAVLINK_TYPE_FLOAT:    return _read<float>(payload, offset);
+    case MAVLINK_TYPE_DOUBLE:   return _read<double>(payload, offset);
+    }
+    return QVariant();
+}
+
+MAVLinkDecodePlan::MAVLinkDecodePlan(const mavlink_message_info_t* info)
+    : msgid         (info->msgid)
+    , name          (info->name)
+    , _timeField    (-1)
+    , _timeIsUsec   (false)
+{
+    for (unsigned fieldIndex = 0; fieldIndex < info->num_fields; fieldIndex++) {
+        const mavlink_field_info_t& fieldInfo = info->fields[fieldIndex];
+
+        MAVLinkFieldPlan field;
+        field.name          = QString(fieldInfo.name);
+        field.type          = fieldInfo.type;
+        field.wireOffset    = fieldInfo.wire_offset;
+        field.arrayLength   = fieldInfo.array_length;
+        field.firstColumn   = -1;
+        if (field.arrayLength > 0) {
+            field.typeName = QStringLiteral("%1[%2]").arg(_typeName(field.type)).arg(field.arrayLength);
+        } else {
+            field.typeName = _typeName(field.type);
+        }
+
+        // Char arrays are strings, they have no numeric representation
+        if (!(field.type == MAVLINK_TYPE_CHAR && field.arrayLength > 0)) {
+            field.firstColumn = columns.count();
+            QString columnName = QStringLiteral("%1.%2").arg(name).arg(field.name);
+            if (field.arrayLength == 0) {
+                columns.append({ fields.count(), field.type, field.wireOffset });
+                columnNames.append(columnName);
+                columnUnits.append(field.typeName);
+            } else {
+                for (unsigned element = 0; element < field.arrayLength; element++) {
+                    columns.append({ fields.count(), field.type, field.wireOffset + element * _typeSize(field.type) });
+                    columnNames.append(QStringLiteral("%1.%2").arg(columnName).arg(element));
+                    columnUnits.append(field.typeName);
+                }
+            }
+        }
+
+        fields.append(field);
+    }
+
+    // Time stamped messages have the time as the first field
+    if (fields.count() > 0) {
+        const MAVLinkFieldPlan& field = fields[0];
+        if (field.name == QLatin1String("time_boot_ms") && field.type == MAVLINK_TYPE_UINT32_T) {
+            _timeField = 0;
+        } else if (field.name.contains(QLatin1String("usec")) && field.type == MAVLINK_TYPE_UINT64_T) {
+            _timeField = 0;
+            _timeIsUsec = true;
+        }
+    }
+}
+
+void MAVLinkDecodePlan::decode(const mavlink_message_t& message, double* values) const
+{
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+
+    for (int i = 0; i < columns.count(); i++) {
+        values[i] = _readDouble(payload, columns[i].type, columns[i].wireOffset);
+    }
+}
+
+QVariant MAVLinkDecodePlan::columnValue(const mavlink_message_t& message, int column) const
+{
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+
+    return _readVariant(payload, columns[column].type, columns[column].wireOffset);
+}
+
+QVariant MAVLinkDecodePlan::fieldValue(const mavlink_message_t& message, int fieldIndex) const
+{
+    const MAVLinkFieldPlan& field = fields[fieldIndex];
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+
+    if (field.arrayLength == 0) {
+        return _readVariant(payload, field.type, field.wireOffset);
+    }
+
+    if (field.type == MAVLINK_TYPE_CHAR) {
+        // Strings are not required to be null terminated when they fill the field
+        const char* str = reinterpret_cast<const char*>(payload + field.wireOffset);
+        return QString::fromLatin1(str, static_cast<int>(qstrnlen(str, field.arrayLength)));
+    }
+
+    QString string;
+    for (unsigned element = 0; element < field.arrayLength; element++) {
+        string += _readVariant(payload, field.type, field.wireOffset + element * _typeSize(field.type)).toString();
+        string += QStringLiteral(", ");
+    }
+    return string;
+}
+
+quint64 MAVLinkDecodePlan::onboardTimeMs(const mavlink_message_t& message) const
+{
+    if (_timeField == -1) {
+        return 0;
+    }
+
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+    if (_timeIsUsec) {
+        // Scale to milliseconds, round up/down correctly
+        return (_read<uint64_t>(payload, fields[_timeField].wireOffset) + 500) / 1000;
+    } else {
+        return _read<uint32_t>(payload, fields[_timeField].wireOffset);
+    }
+}
+
+MAVLinkDecodePlanCache::~MAVLinkDecodePlanCache()
+{
+    qDeleteAll(_plans);
+}
+
+const MAVLinkDecodePlan* MAVLinkDecodePlanCache::plan(uint32_t msgid)
+{
+    QHash<uint32_t, MAVLinkDecodePlan*>::const_iterator iter = _plans.constFind(msgid);
+    if (iter != _plans.constEnd()) {
+        return iter.value();
+    }
+
+    MAVLinkDecodePlan* plan = NULL;
+    const mavlink_message_info_t* info = mavlink_get_message_info_by_id(msgid);
+    if (info) {
+        plan = new MAVLinkDecodePlan(info);
+    }
+
+    // Unknown ids are cached as well so they are only looked up once
+    _plans.insert(msgid, plan);
+    return plan;
+}
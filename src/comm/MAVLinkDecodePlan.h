@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2018 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QVariant>
+
+#include "QGCMAVLink.h"
+
+/// Decode information for a single field of a MAVLink message
+struct MAVLinkFieldPlan {
+    QString     name;           ///< Field name
+    QString     typeName;       ///< C type name, arrays include the length: "float[4]"
+    uint8_t     type;           ///< MAVLINK_TYPE_*
+    unsigned    wireOffset;     ///< Offset of field in payload
+    unsigned    arrayLength;    ///< 0 for scalar fields
+    int         firstColumn;    ///< Index of first numeric column of this field, -1 for char arrays
+};
+
+/// Decode information for a single numeric value. Array fields have one column per element.
+struct MAVLinkColumnPlan {
+    int         field;          ///< Index into MAVLinkDecodePlan::fields
+    uint8_t     type;           ///< MAVLINK_TYPE_*
+    unsigned    wireOffset;     ///< Offset of value in payload
+};
+
+/// Precomputed decode plan for one MAVLink message id.
+///
+/// Built once from the MAVLink message info, so decoding a message does not need to walk the metadata,
+/// compare field names or build strings. Numeric values are exposed as columns, which is what plotting
+/// and the inspector consume.
+class MAVLinkDecodePlan
+{
+public:
+    MAVLinkDecodePlan(const mavlink_message_info_t* info);
+
+    /// Decodes all columns of the message into columns, which must hold columnCount() values
+    void decode(const mavlink_message_t& message, double* columns) const;
+
+    /// @return Value of a single column in its native type
+    QVariant columnValue(const mavlink_message_t& message, int column) const;
+
+    /// @return Value of a field as shown to the user. Arrays are returned as a comma separated string.
+    QVariant fieldValue(const mavlink_message_t& message, int field) const;
+
+    /// @return Onboard time in milliseconds from the time_boot_ms or time_usec field, 0 if the message has none
+    quint64 onboardTimeMs(const mavlink_message_t& message) const;
+
+    int columnCount(void) const { return columns.count(); }
+
+    uint32_t                    msgid;
+    QString                     name;           ///< Message name
+    QVector<MAVLinkFieldPlan>   fields;
+    QVector<MAVLinkColumnPlan>  columns;
+    QStringList                 columnNames;    ///< "MSG.field" or "MSG.field.N" for array elements
+    QStringList                 columnUnits;    ///< Field type name for each column
+
+private:
+    int     _timeField;     ///< Index of time field, -1 for none
+    bool    _timeIsUsec;    ///< true: time field is in usecs, false: msecs
+};
+
+/// Lazily builds and owns decode plans. Not thread safe, each thread which decodes should have its own cache.
+class MAVLinkDecodePlanCache
+{
+public:
+    MAVLinkDecodePlanCache(void) { }
+    ~MAVLinkDecodePlanCache();
+
+    /// @return Plan for msgid, NULL if the message is not known to the MAVLink dialect
+    const MAVLinkDecodePlan* plan(uint32_t msgid);
+
+private:
+    QHash<uint32_t, MAVLinkDecodePlan*> _plans;
+
+    Q_DISABLE_COPY(MAVLinkDecodePlanCache)
+};
@@ -38,6 +38,8 @@
 #include "QGCLoggingCategory.h"
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
+#include "QGCTracer.h"
+#include "TimesyncEstimator.h"
 
 Q_DECLARE_METATYPE(mavlink_message_t)
 
@@ -173,6 +175,8 @@ void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
  **/
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
+    QGC_TRACE_SCOPE("mavlink", "MAVLinkProtocol::receiveBytes");
+
     // Since receiveBytes signals cross threads we can end up with signals in the queue
     // that come through after the link is disconnected. For these we just drop the data
     // since the link is closed.
@@ -186,6 +190,10 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 
     int mavlinkChannel = link->mavlinkChannel();
 
+    QElapsedTimer parseTimer;
+    int messageCount = 0;
+    parseTimer.start();
+
     static int nonmavlinkCount = 0;
     static bool checkedUserNonMavlink = false;
     static bool warnedUserNonMavlink = false;
@@ -212,12 +220,15 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
                     // side effects (e.g. if its a modem)
                     qDebug() << "disconnected link" << link->getName() << "as it contained no MAVLink data";
                     QMetaObject::invokeMethod(_linkMgr, "disconnectLink", Q_ARG( LinkInterface*, link ) );
+                    link->metrics()->received(b.size(), messageCount, parseTimer.nsecsElapsed());
                     return;
                 }
             }
         }
         if (decodeState == 1)
         {
+            messageCount++;
+
             if (!link->decodedFirstMavlinkPacket()) {
                 link->setDecodedFirstMavlinkPacket(true);
                 mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
@@ -325,6 +336,7 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
                 // And log how many were lost for all time and just this timestep
                 totalLossCounter[mavlinkChannel] += lostMessages;
                 currLossCounter[mavlinkChannel] += lostMessages;
+                link->metrics()->lost(lostMessages);
             }
 
             // And update the last sequence number for this system/component pair
@@ -349,6 +361,8 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
             emit messageReceived(link, message);
         }
     }
+
+    link->metrics()->received(b.size(), messageCount, parseTimer.nsecsElapsed());
 }
 
 /**
@@ -392,6 +406,57 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
     }
 }
 
+LinkInterface::SendPriority_t MAVLinkProtocol::sendPriority(const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_GPS_RTCM_DATA:
+    case MAVLINK_MSG_ID_GPS_INJECT_DATA:
+        return LinkInterface::SendPriorityRTCM;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+    case MAVLINK_MSG_ID_PARAM_SET:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+        return LinkInterface::SendPriorityBulk;
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+        // current 2/3 is an ArduPilot guided mode goto/altitude change, which is a flight command
+        return mavlink_msg_mission_item_get_current(&message) >= 2 ? LinkInterface::SendPriorityControl : LinkInterface::SendPriorityBulk;
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+        return mavlink_msg_mission_item_int_get_current(&message) >= 2 ? LinkInterface::SendPriorityControl : LinkInterface::SendPriorityBulk;
+    case MAVLINK_MSG_ID_MISSION_ACK:
+    case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+    case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+    case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+    case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+    case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
+    case MAVLINK_MSG_ID_ENCAPSULATED_DATA:
+        return LinkInterface::SendPriorityBulk;
+    default:
+        // Commands, heartbeats, manual control and anything else which should not wait
+        return LinkInterface::SendPriorityControl;
+    }
+}
+
+void MAVLinkProtocol::setTimesyncEstimator(int sysid, QSharedPointer<TimesyncEstimator> estimator)
+{
+    QMutexLocker lock(&_timesyncMutex);
+
+    if (estimator.isNull()) {
+        _timesyncEstimators.remove(sysid);
+    } else {
+        _timesyncEstimators[sysid] = estimator;
+    }
+}
+
+QSharedPointer<TimesyncEstimator> MAVLinkProtocol::timesyncEstimator(int sysid) const
+{
+    QMutexLocker lock(&_timesyncMutex);
+
+    return _timesyncEstimators.value(sysid);
+}
+
 /// @brief Closes the log file if it is open
 bool MAVLinkProtocol::_closeLogFile(void)
 {
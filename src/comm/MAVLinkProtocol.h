@@ -14,6 +14,7 @@
 #include <QMutex>
 #include <QString>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QMap>
 #include <QByteArray>
@@ -28,6 +29,7 @@
 class LinkManager;
 class MultiVehicleManager;
 class QGCApplication;
+class TimesyncEstimator;
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkProtocolLog)
 
@@ -97,6 +99,16 @@ public:
     /// Set protocol version
     void setVersion(unsigned version);
 
+    /// Makes the clock estimate for a vehicle available to other threads. Pass a null estimator to remove it.
+    void setTimesyncEstimator(int sysid, QSharedPointer<TimesyncEstimator> estimator);
+
+    /// Thread safe
+    /// @return Clock estimate for the vehicle, null if there is none
+    QSharedPointer<TimesyncEstimator> timesyncEstimator(int sysid) const;
+
+    /// @return Send priority class for an outgoing message
+    static LinkInterface::SendPriority_t sendPriority(const mavlink_message_t& message);
+
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
@@ -189,6 +201,9 @@ private:
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+
+    mutable QMutex                                  _timesyncMutex;
+    QMap<int, QSharedPointer<TimesyncEstimator>>    _timesyncEstimators;    ///< Keyed by vehicle system id
 };
 
 #endif // MAVLINKPROTOCOL_H_
@@ -19,6 +19,7 @@
 #include <QTimer>
 #include <QDebug>
 #include <QFile>
+#include <QtMath>
 
 #include <string.h>
 
@@ -52,14 +53,21 @@ const char* MockConfiguration::_vehicleTypeKey =    "VehicleType";
 const char* MockConfiguration::_sendStatusTextKey = "SendStatusText";
 const char* MockConfiguration::_highLatencyKey =    "HighLatency";
 const char* MockConfiguration::_failureModeKey =    "FailureMode";
-
-MockLink::MockLink(SharedLinkConfigurationPointer& config)
+const char* MockConfiguration::_vehicleCountKey =       "VehicleCount";
+const char* MockConfiguration::_rateProfileKey =        "RateProfile";
+const char* MockConfiguration::_messageRatesKey =       "MessageRates";
+const char* MockConfiguration::_packetLossPercentKey =  "PacketLossPercent";
+const char* MockConfiguration::_jitterMsecsKey =        "JitterMsecs";
+const char* MockConfiguration::_reorderPercentKey =     "ReorderPercent";
+const char* MockConfiguration::_mavlink1Key =           "Mavlink1";
+
+MockLink::MockLink(SharedLinkConfigurationPointer& config, MockLink* swarmParent)
     : LinkInterface                         (config)
     , _missionItemHandler                   (this, qgcApp()->toolbox()->mavlinkProtocol())
     , _name                                 ("MockLink")
     , _connected                            (false)
     , _mavlinkChannel                       (0)
-    , _vehicleSystemId                      (_nextVehicleSystemId++)
+    , _vehicleSystemId                      (_allocateVehicleSystemId())
     , _vehicleComponentId                   (MAV_COMP_ID_AUTOPILOT1)
     , _inNSH                                (false)
     , _mavlinkStarted                       (true)
@@ -81,6 +89,11 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     , _logDownloadCurrentOffset             (0)
     , _logDownloadBytesRemaining            (0)
     , _adsbAngle                            (0)
+    , _swarmParent                          (swarmParent)
+    , _mavlink1                             (false)
+    , _packetLossPercent                    (0)
+    , _jitterMsecs                          (0)
+    , _reorderPercent                       (0)
 {
     MockConfiguration* mockConfig = qobject_cast<MockConfiguration*>(_config.data());
     _firmwareType = mockConfig->firmwareType();
@@ -88,6 +101,19 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     _sendStatusText = mockConfig->sendStatusText();
     _highLatency = mockConfig->highLatency();
     _failureMode = mockConfig->failureMode();
+    _mavlink1 = mockConfig->mavlink1();
+
+    memset(&_txStatus, 0, sizeof(_txStatus));
+
+    QMap<int, int> messageRates = mockConfig->messageRates();
+    foreach (int msgId, messageRates.keys()) {
+        LoadStream_t stream;
+        stream.msgId =          msgId;
+        stream.intervalNsecs =  1000000000LL / messageRates[msgId];
+        // Spread the vehicles out so they don't all send in the same tick
+        stream.nextNsecs =      (stream.intervalNsecs * (_vehicleSystemId % 10)) / 10;
+        _loadStreams.append(stream);
+    }
 
     union px4_custom_mode   px4_cm;
 
@@ -98,17 +124,55 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     _fileServer = new MockLinkFileServer(_vehicleSystemId, _vehicleComponentId, this);
     Q_CHECK_PTR(_fileServer);
 
-    moveToThread(this);
+    // Swarm vehicles don't have a thread of their own, they run from the thread of the link carrying them
+    moveToThread(_swarmParent ? _swarmParent : this);
 
     _loadParams();
 
     _adsbVehicleCoordinate = QGeoCoordinate(_vehicleLatitude, _vehicleLongitude).atDistanceAndAzimuth(1000, _adsbAngle);
     _adsbVehicleCoordinate.setAltitude(100);
+
+    if (!_swarmParent) {
+        _packetLossPercent =    mockConfig->packetLossPercent();
+        _jitterMsecs =          mockConfig->jitterMsecs();
+        _reorderPercent =       mockConfig->reorderPercent();
+        _deliverTimer.start();
+
+        for (int i=1; i<mockConfig->vehicleCount(); i++) {
+            // Each vehicle needs a configuration of its own since the configuration keeps track of the link using it
+            MockConfiguration* vehicleConfig = new MockConfiguration(mockConfig);
+            vehicleConfig->setName(QString("%1 Vehicle %2").arg(mockConfig->name()).arg(i + 1));
+            vehicleConfig->setVehicleCount(1);
+            SharedLinkConfigurationPointer sharedVehicleConfig(vehicleConfig);
+            _swarmVehicles.append(new MockLink(sharedVehicleConfig, this));
+        }
+    }
+}
+
+uint8_t MockLink::_allocateVehicleSystemId(void)
+{
+    // Swarms can use up the id space, ids wrap around short of the ids used by ground stations
+    if (_nextVehicleSystemId > 250) {
+        _nextVehicleSystemId = 1;
+    }
+    return _nextVehicleSystemId++;
+}
+
+QList<int> MockLink::vehicleIds(void) const
+{
+    QList<int> ids;
+
+    ids.append(_vehicleSystemId);
+    foreach (MockLink* vehicle, _swarmVehicles) {
+        ids.append(vehicle->_vehicleSystemId);
+    }
+    return ids;
 }
 
 MockLink::~MockLink(void)
 {
     _disconnect();
+    qDeleteAll(_swarmVehicles);
     if (!_logDownloadFilename.isEmpty()) {
         QFile::remove(_logDownloadFilename);
     }
@@ -123,9 +187,17 @@ bool MockLink::_connect(void)
             qWarning() << "No mavlink channels available";
             return false;
         }
-        // MockLinks use Mavlink 2.0
+        // MockLinks use Mavlink 2.0 unless configured otherwise
         mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(_mavlinkChannel);
-        mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        if (_mavlink1) {
+            mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        } else {
+            mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+        foreach (MockLink* vehicle, _swarmVehicles) {
+            vehicle->_mavlinkChannel = _mavlinkChannel;
+            vehicle->_connected = true;
+        }
         start();
         emit connected();
     }
@@ -142,6 +214,9 @@ void MockLink::_disconnect(void)
         _connected = false;
         quit();
         wait();
+        foreach (MockLink* vehicle, _swarmVehicles) {
+            vehicle->_connected = false;
+        }
         emit disconnected();
     }
 }
@@ -167,6 +242,9 @@ void MockLink::run(void)
     QObject::disconnect(&timer500HzTasks, &QTimer::timeout, this, &MockLink::_run500HzTasks);
 
     _missionItemHandler.shutdown();
+    foreach (MockLink* vehicle, _swarmVehicles) {
+        vehicle->_missionItemHandler.shutdown();
+    }
 }
 
 void MockLink::_run1HzTasks(void)
@@ -193,6 +271,10 @@ void MockLink::_run1HzTasks(void)
             }
         }
     }
+
+    foreach (MockLink* vehicle, _swarmVehicles) {
+        vehicle->_run1HzTasks();
+    }
 }
 
 void MockLink::_run10HzTasks(void)
@@ -210,6 +292,10 @@ void MockLink::_run10HzTasks(void)
             _sendGpsRawInt();
         }
     }
+
+    foreach (MockLink* vehicle, _swarmVehicles) {
+        vehicle->_run10HzTasks();
+    }
 }
 
 void MockLink::_run500HzTasks(void)
@@ -221,6 +307,15 @@ void MockLink::_run500HzTasks(void)
     if (_mavlinkStarted && _connected) {
         _paramRequestListWorker();
         _logDownloadWorker();
+        _sendLoadStreams();
+    }
+
+    foreach (MockLink* vehicle, _swarmVehicles) {
+        vehicle->_run500HzTasks();
+    }
+
+    if (!_swarmParent) {
+        _releaseDelayedBytes();
     }
 }
 
@@ -373,13 +468,195 @@ void MockLink::_sendVibration(void)
     respondWithMavlinkMessage(msg);
 }
 
+void MockLink::_sendLoadStreams(void)
+{
+    if (_loadStreams.isEmpty()) {
+        return;
+    }
+    if (!_loadStreamTimer.isValid()) {
+        _loadStreamTimer.start();
+    }
+
+    qint64 nowNsecs = _loadStreamTimer.nsecsElapsed();
+    for (int i=0; i<_loadStreams.count(); i++) {
+        LoadStream_t& stream = _loadStreams[i];
+
+        if (nowNsecs - stream.nextNsecs > 1000000000LL) {
+            // Thread was starved for over a second, don't try to make up for it with a burst
+            stream.nextNsecs = nowNsecs;
+        }
+        while (stream.nextNsecs <= nowNsecs) {
+            _sendLoadStreamMessage(stream.msgId, (uint32_t)(nowNsecs / 1000000));
+            stream.nextNsecs += stream.intervalNsecs;
+        }
+    }
+}
+
+/// Sends a load generator message. The vehicle flies a 50 meter circle around its position once a minute.
+void MockLink::_sendLoadStreamMessage(int msgId, uint32_t timeBootMsecs)
+{
+    const double radius =   50;
+    const double period =   60;
+    const double speed =    2 * M_PI * radius / period;
+
+    double          angle =     (timeBootMsecs % (int)(period * 1000)) / (period * 1000) * 2 * M_PI;
+    double          north =     radius * cos(angle);
+    double          east =      radius * sin(angle);
+    double          vNorth =    -speed * sin(angle);
+    double          vEast =     speed * cos(angle);
+    double          heading =   fmod(qRadiansToDegrees(angle) + 90, 360);
+    double          relativeAlt = 20;
+    QGeoCoordinate  coord =     QGeoCoordinate(_vehicleLatitude, _vehicleLongitude).atDistanceAndAzimuth(radius, qRadiansToDegrees(angle));
+
+    mavlink_message_t msg;
+
+    switch (msgId) {
+    case MAVLINK_MSG_ID_ATTITUDE:
+    {
+        mavlink_attitude_t attitude;
+        memset(&attitude, 0, sizeof(attitude));
+        attitude.time_boot_ms = timeBootMsecs;
+        attitude.roll =         qDegreesToRadians(10.0);    // Banked into the turn
+        attitude.pitch =        qDegreesToRadians(2.0 * sin(angle * 8));
+        attitude.yaw =          qDegreesToRadians(heading > 180 ? heading - 360 : heading);
+        attitude.yawspeed =     2 * M_PI / period;
+        mavlink_msg_attitude_encode_chan(_vehicleSystemId, _vehicleComponentId, _mavlinkChannel, &msg, &attitude);
+        break;
+    }
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    {
+        mavlink_global_position_int_t globalPosition;
+        memset(&globalPosition, 0, sizeof(globalPosition));
+        globalPosition.time_boot_ms =   timeBootMsecs;
+        globalPosition.lat =            (int32_t)(coord.latitude() * 1E7);
+        globalPosition.lon =            (int32_t)(coord.longitude() * 1E7);
+        globalPosition.alt =            (int32_t)((_vehicleAltitude + relativeAlt) * 1000);
+        globalPosition.relative_alt =   (int32_t)(relativeAlt * 1000);
+        globalPosition.vx =             (int16_t)(vNorth * 100);
+        globalPosition.vy =             (int16_t)(vEast * 100);
+        globalPosition.hdg =            (uint16_t)(heading * 100);
+        mavlink_msg_global_position_int_encode_chan(_vehicleSystemId, _vehicleComponentId, _mavlinkChannel, &msg, &globalPosition);
+        break;
+    }
+    case MAVLINK_MSG_ID_LOCAL_POSITION_NED:
+    {
+        mavlink_local_position_ned_t localPosition;
+        memset(&localPosition, 0, sizeof(localPosition));
+        localPosition.time_boot_ms =    timeBootMsecs;
+        localPosition.x =               north;
+        localPosition.y =               east;
+        localPosition.z =               -relativeAlt;
+        localPosition.vx =              vNorth;
+        localPosition.vy =              vEast;
+        mavlink_msg_local_position_ned_encode_chan(_vehicleSystemId, _vehicleComponentId, _mavlinkChannel, &msg, &localPosition);
+        break;
+    }
+    case MAVLINK_MSG_ID_VFR_HUD:
+    {
+        mavlink_vfr_hud_t vfrHud;
+        memset(&vfrHud, 0, sizeof(vfrHud));
+        vfrHud.airspeed =       speed;
+        vfrHud.groundspeed =    speed;
+        vfrHud.alt =            _vehicleAltitude + relativeAlt;
+        vfrHud.heading =        (int16_t)heading;
+        vfrHud.throttle =       50;
+        mavlink_msg_vfr_hud_encode_chan(_vehicleSystemId, _vehicleComponentId, _mavlinkChannel, &msg, &vfrHud);
+        break;
+    }
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink_sys_status_t sysStatus;
+        memset(&sysStatus, 0, sizeof(sysStatus));
+        sysStatus.load =                300;                // 30%
+        sysStatus.voltage_battery =     12200;
+        sysStatus.current_battery =     1500;               // 15A
+        sysStatus.battery_remaining =   80;
+        mavlink_msg_sys_status_encode_chan(_vehicleSystemId, _vehicleComponentId, _mavlinkChannel, &msg, &sysStatus);
+        break;
+    }
+    default:
+        return;
+    }
+
+    respondWithMavlinkMessage(msg);
+}
+
 void MockLink::respondWithMavlinkMessage(const mavlink_message_t& msg)
 {
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int     cBuffer;
+
+    const mavlink_msg_entry_t* msgEntry = mavlink_get_msg_entry(msg.msgid);
+    if ((_swarmParent || !_swarmVehicles.isEmpty()) && msgEntry) {
+        // All vehicles on the link pack their messages on the link's channel, which means they share its sequence
+        // numbers. Re-sequence the message from the vehicle's own sequence so QGC doesn't count the messages sent by
+        // the other vehicles as lost.
+        mavlink_message_t vehicleMsg = msg;
+        _txStatus.flags = mavlink_get_channel_status(_mavlinkChannel)->flags;
+        mavlink_finalize_message_buffer(&vehicleMsg, msg.sysid, msg.compid, &_txStatus, msg.len, msg.len, msgEntry->crc_extra);
+        cBuffer = mavlink_msg_to_send_buffer(buffer, &vehicleMsg);
+    } else {
+        cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
+    }
 
-    int cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
     QByteArray bytes((char *)buffer, cBuffer);
-    emit bytesReceived(this, bytes);
+    if (_swarmParent) {
+        _swarmParent->_deliverBytes(bytes);
+    } else {
+        _deliverBytes(bytes);
+    }
+}
+
+/// Delivers bytes to QGC, applying the configured link impairments
+void MockLink::_deliverBytes(const QByteArray& bytes)
+{
+    if (_packetLossPercent == 0 && _jitterMsecs == 0 && _reorderPercent == 0) {
+        emit bytesReceived(this, bytes);
+        return;
+    }
+
+    QMutexLocker lock(&_deliverMutex);
+
+    if (qrand() % 100 < _packetLossPercent) {
+        return;
+    }
+
+    if (_reorderHeldBytes.isEmpty() && qrand() % 100 < _reorderPercent) {
+        _reorderHeldBytes = bytes;
+        return;
+    }
+
+    _queueBytes(bytes);
+    if (!_reorderHeldBytes.isEmpty()) {
+        _queueBytes(_reorderHeldBytes);
+        _reorderHeldBytes.clear();
+    }
+}
+
+/// Sends bytes to QGC once their jitter delay has passed. _deliverMutex must be held.
+void MockLink::_queueBytes(const QByteArray& bytes)
+{
+    if (_jitterMsecs == 0) {
+        emit bytesReceived(this, bytes);
+        return;
+    }
+
+    qint64 releaseMsecs = _deliverTimer.elapsed() + (qrand() % (_jitterMsecs + 1));
+    if (!_delayedBytes.isEmpty()) {
+        // Delays vary but messages don't overtake each other, that is what reordering is for
+        releaseMsecs = qMax(releaseMsecs, _delayedBytes.last().first);
+    }
+    _delayedBytes.append(qMakePair(releaseMsecs, bytes));
+}
+
+void MockLink::_releaseDelayedBytes(void)
+{
+    QMutexLocker lock(&_deliverMutex);
+
+    qint64 nowMsecs = _deliverTimer.elapsed();
+    while (!_delayedBytes.isEmpty() && _delayedBytes.first().first <= nowMsecs) {
+        emit bytesReceived(this, _delayedBytes.takeFirst().second);
+    }
 }
 
 /// @brief Called when QGC wants to write bytes to the MAV
@@ -433,54 +710,89 @@ void MockLink::_handleIncomingMavlinkBytes(const uint8_t* bytes, int cBytes)
             continue;
         }
 
-        if (_missionItemHandler.handleMessage(msg)) {
-            continue;
+        emit mavlinkMessageReceived(msg);
+
+        if (_swarmVehicles.isEmpty()) {
+            _handleIncomingMavlinkMessage(msg);
+        } else {
+            _routeIncomingMavlinkMessage(msg);
         }
+    }
+}
 
-        switch (msg.msgid) {
-        case MAVLINK_MSG_ID_HEARTBEAT:
-            _handleHeartBeat(msg);
-            break;
+/// Hands a message to the vehicle it is targeted at, messages without a target go to all vehicles on the link
+void MockLink::_routeIncomingMavlinkMessage(const mavlink_message_t& msg)
+{
+    int targetSystem = 0;
 
-        case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
-            _handleParamRequestList(msg);
-            break;
+    const mavlink_msg_entry_t* msgEntry = mavlink_get_msg_entry(msg.msgid);
+    if (msgEntry && (msgEntry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) && msgEntry->target_system_ofs < msg.len) {
+        targetSystem = _MAV_PAYLOAD(&msg)[msgEntry->target_system_ofs];
+    }
 
-        case MAVLINK_MSG_ID_SET_MODE:
-            _handleSetMode(msg);
-            break;
+    if (targetSystem == 0 || targetSystem == _vehicleSystemId) {
+        _handleIncomingMavlinkMessage(msg);
+    }
+    foreach (MockLink* vehicle, _swarmVehicles) {
+        if (targetSystem == 0 || targetSystem == vehicle->_vehicleSystemId) {
+            vehicle->_handleIncomingMavlinkMessage(msg);
+        }
+    }
+}
 
-        case MAVLINK_MSG_ID_PARAM_SET:
-            _handleParamSet(msg);
-            break;
+void MockLink::_handleIncomingMavlinkMessage(const mavlink_message_t& msg)
+{
+    if (_missionItemHandler.handleMessage(msg)) {
+        return;
+    }
 
-        case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
-            _handleParamRequestRead(msg);
-            break;
+    switch (msg.msgid) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+        _handleHeartBeat(msg);
+        break;
 
-        case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
-            _handleFTP(msg);
-            break;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        _handleParamRequestList(msg);
+        break;
 
-        case MAVLINK_MSG_ID_COMMAND_LONG:
-            _handleCommandLong(msg);
-            break;
+    case MAVLINK_MSG_ID_SET_MODE:
+        _handleSetMode(msg);
+        break;
 
-        case MAVLINK_MSG_ID_MANUAL_CONTROL:
-            _handleManualControl(msg);
-            break;
+    case MAVLINK_MSG_ID_PARAM_SET:
+        _handleParamSet(msg);
+        break;
 
-        case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
-            _handleLogRequestList(msg);
-            break;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        _handleParamRequestRead(msg);
+        break;
 
-        case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
-            _handleLogRequestData(msg);
-            break;
+    case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+        _handleFTP(msg);
+        break;
 
-        default:
-            break;
-        }
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+        _handleCommandLong(msg);
+        break;
+
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        _handleManualControl(msg);
+        break;
+
+    case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+        _handleLogRequestList(msg);
+        break;
+
+    case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+        _handleLogRequestData(msg);
+        break;
+
+    case MAVLINK_MSG_ID_PING:
+        _handlePing(msg);
+        break;
+
+    default:
+        break;
     }
 }
 
@@ -490,6 +802,27 @@ void MockLink::_handleHeartBeat(const mavlink_message_t& msg)
     qCDebug(MockLinkLog) << "Heartbeat";
 }
 
+void MockLink::_handlePing(const mavlink_message_t& msg)
+{
+    mavlink_ping_t request;
+    mavlink_msg_ping_decode(&msg, &request);
+
+    if (request.target_system != 0) {
+        return;
+    }
+
+    mavlink_message_t responseMsg;
+    mavlink_msg_ping_pack_chan(_vehicleSystemId,
+                               _vehicleComponentId,
+                               _mavlinkChannel,
+                               &responseMsg,
+                               request.time_usec,
+                               request.seq,
+                               msg.sysid,
+                               msg.compid);
+    respondWithMavlinkMessage(responseMsg);
+}
+
 void MockLink::_handleSetMode(const mavlink_message_t& msg)
 {
     mavlink_set_mode_t request;
@@ -1073,6 +1406,12 @@ MockConfiguration::MockConfiguration(const QString& name)
     , _sendStatusText   (false)
     , _highLatency      (false)
     , _failureMode      (FailNone)
+    , _vehicleCount     (1)
+    , _rateProfile      (RateProfileNone)
+    , _packetLossPercent(0)
+    , _jitterMsecs      (0)
+    , _reorderPercent   (0)
+    , _mavlink1         (false)
 {
 
 }
@@ -1085,6 +1424,13 @@ MockConfiguration::MockConfiguration(MockConfiguration* source)
     _sendStatusText =   source->_sendStatusText;
     _highLatency =      source->_highLatency;
     _failureMode =      source->_failureMode;
+    _vehicleCount =         source->_vehicleCount;
+    _rateProfile =          source->_rateProfile;
+    _messageRateOverrides = source->_messageRateOverrides;
+    _packetLossPercent =    source->_packetLossPercent;
+    _jitterMsecs =          source->_jitterMsecs;
+    _reorderPercent =       source->_reorderPercent;
+    _mavlink1 =             source->_mavlink1;
 }
 
 void MockConfiguration::copyFrom(LinkConfiguration *source)
@@ -1102,6 +1448,13 @@ void MockConfiguration::copyFrom(LinkConfiguration *source)
     _sendStatusText =   usource->_sendStatusText;
     _highLatency =      usource->_highLatency;
     _failureMode =      usource->_failureMode;
+    _vehicleCount =         usource->_vehicleCount;
+    _rateProfile =          usource->_rateProfile;
+    _messageRateOverrides = usource->_messageRateOverrides;
+    _packetLossPercent =    usource->_packetLossPercent;
+    _jitterMsecs =          usource->_jitterMsecs;
+    _reorderPercent =       usource->_reorderPercent;
+    _mavlink1 =             usource->_mavlink1;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -1112,6 +1465,17 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue(_sendStatusTextKey, _sendStatusText);
     settings.setValue(_highLatencyKey, _highLatency);
     settings.setValue(_failureModeKey, (int)_failureMode);
+    settings.setValue(_vehicleCountKey, _vehicleCount);
+    settings.setValue(_rateProfileKey, (int)_rateProfile);
+    settings.setValue(_packetLossPercentKey, _packetLossPercent);
+    settings.setValue(_jitterMsecsKey, _jitterMsecs);
+    settings.setValue(_reorderPercentKey, _reorderPercent);
+    settings.setValue(_mavlink1Key, _mavlink1);
+    QVariantMap messageRates;
+    foreach (int msgId, _messageRateOverrides.keys()) {
+        messageRates[QString::number(msgId)] = _messageRateOverrides[msgId];
+    }
+    settings.setValue(_messageRatesKey, messageRates);
     settings.sync();
     settings.endGroup();
 }
@@ -1124,6 +1488,17 @@ void MockConfiguration::loadSettings(QSettings& settings, const QString& root)
     _sendStatusText = settings.value(_sendStatusTextKey, false).toBool();
     _highLatency = settings.value(_highLatencyKey, false).toBool();
     _failureMode = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _vehicleCount = qBound(1, settings.value(_vehicleCountKey, 1).toInt(), static_cast<int>(maxVehicleCount));
+    _rateProfile = (RateProfile_t)settings.value(_rateProfileKey, (int)RateProfileNone).toInt();
+    _packetLossPercent = settings.value(_packetLossPercentKey, 0).toInt();
+    _jitterMsecs = settings.value(_jitterMsecsKey, 0).toInt();
+    _reorderPercent = settings.value(_reorderPercentKey, 0).toInt();
+    _mavlink1 = settings.value(_mavlink1Key, false).toBool();
+    _messageRateOverrides.clear();
+    QVariantMap messageRates = settings.value(_messageRatesKey).toMap();
+    foreach (const QString& msgId, messageRates.keys()) {
+        _messageRateOverrides[msgId.toInt()] = messageRates[msgId].toInt();
+    }
     settings.endGroup();
 }
 
@@ -1139,6 +1514,63 @@ void MockConfiguration::updateSettings()
     }
 }
 
+QList<int> MockConfiguration::loadStreamMessageIds(void)
+{
+    QList<int> msgIds;
+
+    msgIds << MAVLINK_MSG_ID_ATTITUDE
+           << MAVLINK_MSG_ID_GLOBAL_POSITION_INT
+           << MAVLINK_MSG_ID_LOCAL_POSITION_NED
+           << MAVLINK_MSG_ID_VFR_HUD
+           << MAVLINK_MSG_ID_SYS_STATUS;
+    return msgIds;
+}
+
+void MockConfiguration::setMessageRate(int msgId, int hz)
+{
+    if (!loadStreamMessageIds().contains(msgId)) {
+        qWarning() << "MockConfiguration::setMessageRate message not supported by load generator" << msgId;
+        return;
+    }
+    _messageRateOverrides[msgId] = qMax(0, hz);
+    emit loadGeneratorChanged();
+}
+
+QMap<int, int> MockConfiguration::messageRates(void) const
+{
+    QMap<int, int> rates;
+
+    switch (_rateProfile) {
+    case RateProfileTelemetryRadio:
+        rates[MAVLINK_MSG_ID_ATTITUDE] =            10;
+        rates[MAVLINK_MSG_ID_GLOBAL_POSITION_INT] = 5;
+        rates[MAVLINK_MSG_ID_LOCAL_POSITION_NED] =  5;
+        rates[MAVLINK_MSG_ID_VFR_HUD] =             4;
+        rates[MAVLINK_MSG_ID_SYS_STATUS] =          2;
+        break;
+    case RateProfileOnboard:
+        rates[MAVLINK_MSG_ID_ATTITUDE] =            100;
+        rates[MAVLINK_MSG_ID_GLOBAL_POSITION_INT] = 50;
+        rates[MAVLINK_MSG_ID_LOCAL_POSITION_NED] =  30;
+        rates[MAVLINK_MSG_ID_VFR_HUD] =             20;
+        rates[MAVLINK_MSG_ID_SYS_STATUS] =          5;
+        break;
+    case RateProfileNone:
+        break;
+    }
+
+    foreach (int msgId, _messageRateOverrides.keys()) {
+        rates[msgId] = _messageRateOverrides[msgId];
+    }
+    foreach (int msgId, rates.keys()) {
+        if (rates[msgId] <= 0) {
+            rates.remove(msgId);
+        }
+    }
+
+    return rates;
+}
+
 MockLink*  MockLink::_startMockLink(MockConfiguration* mockConfig)
 {
     LinkManager* linkMgr = qgcApp()->toolbox()->linkManager();
@@ -1209,6 +1641,27 @@ MockLink*  MockLink::startAPMArduSubMockLink(bool sendStatusText, MockConfigurat
     return _startMockLink(mockConfig);
 }
 
+MockLink* MockLink::startSwarmMockLink(int                                vehicleCount,
+                                       MockConfiguration::RateProfile_t   rateProfile,
+                                       bool                               mavlink1,
+                                       int                                packetLossPercent,
+                                       int                                jitterMsecs,
+                                       int                                reorderPercent)
+{
+    MockConfiguration* mockConfig = new MockConfiguration(QString("Swarm MockLink %1").arg(_nextVehicleSystemId));
+
+    mockConfig->setFirmwareType(MAV_AUTOPILOT_PX4);
+    mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+    mockConfig->setVehicleCount(vehicleCount);
+    mockConfig->setRateProfile(rateProfile);
+    mockConfig->setMavlink1(mavlink1);
+    mockConfig->setPacketLossPercent(packetLossPercent);
+    mockConfig->setJitterMsecs(jitterMsecs);
+    mockConfig->setReorderPercent(reorderPercent);
+
+    return _startMockLink(mockConfig);
+}
+
 void MockLink::_sendRCChannels(void)
 {
     mavlink_message_t   msg;
@@ -14,6 +14,8 @@
 #include <QMap>
 #include <QLoggingCategory>
 #include <QGeoCoordinate>
+#include <QElapsedTimer>
+#include <QMutex>
 
 #include "MockLinkMissionItemHandler.h"
 #include "MockLinkFileServer.h"
@@ -34,6 +36,14 @@ public:
     Q_PROPERTY(bool     sendStatus  READ sendStatusText     WRITE setSendStatusText NOTIFY sendStatusChanged)
     Q_PROPERTY(bool     highLatency READ highLatency        WRITE setHighLatency    NOTIFY highLatencyChanged)
 
+    // Load generator
+    Q_PROPERTY(int      vehicleCount        READ vehicleCount       WRITE setVehicleCount       NOTIFY loadGeneratorChanged)
+    Q_PROPERTY(int      rateProfile         READ rateProfile        WRITE setRateProfile        NOTIFY loadGeneratorChanged)
+    Q_PROPERTY(int      packetLossPercent   READ packetLossPercent  WRITE setPacketLossPercent  NOTIFY loadGeneratorChanged)
+    Q_PROPERTY(int      jitterMsecs         READ jitterMsecs        WRITE setJitterMsecs        NOTIFY loadGeneratorChanged)
+    Q_PROPERTY(int      reorderPercent      READ reorderPercent     WRITE setReorderPercent     NOTIFY loadGeneratorChanged)
+    Q_PROPERTY(bool     mavlink1            READ mavlink1           WRITE setMavlink1           NOTIFY loadGeneratorChanged)
+
     // QML Access
     int     firmware        () { return (int)_firmwareType; }
     void    setFirmware     (int type) { _firmwareType = (MAV_AUTOPILOT)type; emit firmwareChanged(); }
@@ -64,6 +74,49 @@ public:
     FailureMode_t failureMode(void) { return _failureMode; }
     void setFailureMode(FailureMode_t failureMode) { _failureMode = failureMode; }
 
+    /// Extra telemetry streamed by each vehicle on top of the regular MockLink messages
+    typedef enum {
+        RateProfileNone,            // Regular MockLink messages only
+        RateProfileTelemetryRadio,  // Rates typical of a vehicle on a telemetry radio
+        RateProfileOnboard,         // Rates typical of a vehicle on usb or a companion computer link
+    } RateProfile_t;
+
+    /// @return Number of vehicles simulated on the link, all vehicles share the link
+    int vehicleCount(void) const { return _vehicleCount; }
+    void setVehicleCount(int vehicleCount) { _vehicleCount = qBound(1, vehicleCount, static_cast<int>(maxVehicleCount)); emit loadGeneratorChanged(); }
+
+    int rateProfile(void) const { return _rateProfile; }
+    void setRateProfile(int rateProfile) { _rateProfile = (RateProfile_t)rateProfile; emit loadGeneratorChanged(); }
+
+    /// Overrides the rate profile for a single message
+    ///     @param msgId Message to stream, must be one of loadStreamMessageIds
+    ///     @param hz Rate to stream the message at, 0 to not stream it
+    void setMessageRate(int msgId, int hz);
+
+    /// @return Rate in hz for each message streamed from the rate profile and the overrides
+    QMap<int, int> messageRates(void) const;
+
+    /// @return Messages which can be streamed by the load generator
+    static QList<int> loadStreamMessageIds(void);
+
+    /// @return Percentage of messages dropped by the link
+    int packetLossPercent(void) const { return _packetLossPercent; }
+    void setPacketLossPercent(int percent) { _packetLossPercent = qBound(0, percent, 100); emit loadGeneratorChanged(); }
+
+    /// @return Messages are delayed by a random time of up to this many msecs, order is kept
+    int jitterMsecs(void) const { return _jitterMsecs; }
+    void setJitterMsecs(int msecs) { _jitterMsecs = qMax(0, msecs); emit loadGeneratorChanged(); }
+
+    /// @return Percentage of messages which are delivered after the message following them
+    int reorderPercent(void) const { return _reorderPercent; }
+    void setReorderPercent(int percent) { _reorderPercent = qBound(0, percent, 100); emit loadGeneratorChanged(); }
+
+    /// @return true: vehicles on the link send MAVLink 1.0, false: MAVLink 2.0
+    bool mavlink1(void) const { return _mavlink1; }
+    void setMavlink1(bool mavlink1) { _mavlink1 = mavlink1; emit loadGeneratorChanged(); }
+
+    static const int maxVehicleCount = 100;
+
     // Overrides from LinkConfiguration
     LinkType    type            (void) { return LinkConfiguration::TypeMock; }
     void        copyFrom        (LinkConfiguration* source);
@@ -77,6 +130,7 @@ signals:
     void vehicleChanged     ();
     void sendStatusChanged  ();
     void highLatencyChanged ();
+    void loadGeneratorChanged();
 
 private:
     MAV_AUTOPILOT   _firmwareType;
@@ -84,12 +138,26 @@ private:
     bool            _sendStatusText;
     bool            _highLatency;
     FailureMode_t   _failureMode;
+    int             _vehicleCount;
+    RateProfile_t   _rateProfile;
+    QMap<int, int>  _messageRateOverrides;
+    int             _packetLossPercent;
+    int             _jitterMsecs;
+    int             _reorderPercent;
+    bool            _mavlink1;
 
     static const char* _firmwareTypeKey;
     static const char* _vehicleTypeKey;
     static const char* _sendStatusTextKey;
     static const char* _highLatencyKey;
     static const char* _failureModeKey;
+    static const char* _vehicleCountKey;
+    static const char* _rateProfileKey;
+    static const char* _messageRatesKey;
+    static const char* _packetLossPercentKey;
+    static const char* _jitterMsecsKey;
+    static const char* _reorderPercentKey;
+    static const char* _mavlink1Key;
 };
 
 class MockLink : public LinkInterface
@@ -97,11 +165,15 @@ class MockLink : public LinkInterface
     Q_OBJECT
 
 public:
-    MockLink(SharedLinkConfigurationPointer& config);
+    /// @param swarmParent Link which carries this vehicle when it is one of several vehicles on a link, NULL for a regular link
+    MockLink(SharedLinkConfigurationPointer& config, MockLink* swarmParent = NULL);
     ~MockLink(void);
 
     // MockLink methods
     int vehicleId(void) { return _vehicleSystemId; }
+
+    /// @return System ids of all vehicles on the link, starting with vehicleId
+    QList<int> vehicleIds(void) const;
     MAV_AUTOPILOT getFirmwareType(void) { return _firmwareType; }
     void setFirmwareType(MAV_AUTOPILOT autopilot) { _firmwareType = autopilot; }
     void setSendStatusText(bool sendStatusText) { _sendStatusText = sendStatusText; }
@@ -157,6 +229,18 @@ public:
     static MockLink* startAPMArduPlaneMockLink   (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduSubMockLink     (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
 
+    /// Starts a link which simulates a swarm of PX4 vehicles
+    static MockLink* startSwarmMockLink(int                             vehicleCount,
+                                        MockConfiguration::RateProfile_t rateProfile,
+                                        bool                            mavlink1,
+                                        int                             packetLossPercent = 0,
+                                        int                             jitterMsecs = 0,
+                                        int                             reorderPercent = 0);
+
+signals:
+    /// Emitted on the MockLink thread for every mavlink message QGC sends to the vehicle
+    void mavlinkMessageReceived(const mavlink_message_t& msg);
+
 private slots:
     virtual void _writeBytes(const QByteArray bytes);
 
@@ -178,9 +262,12 @@ private:
     void _sendHighLatency2(void);
     void _handleIncomingNSHBytes(const char* bytes, int cBytes);
     void _handleIncomingMavlinkBytes(const uint8_t* bytes, int cBytes);
+    void _handleIncomingMavlinkMessage(const mavlink_message_t& msg);
+    void _routeIncomingMavlinkMessage(const mavlink_message_t& msg);
     void _loadParams(void);
     void _handleHeartBeat(const mavlink_message_t& msg);
     void _handleSetMode(const mavlink_message_t& msg);
+    void _handlePing(const mavlink_message_t& msg);
     void _handleParamRequestList(const mavlink_message_t& msg);
     void _handleParamSet(const mavlink_message_t& msg);
     void _handleParamRequestRead(const mavlink_message_t& msg);
@@ -202,8 +289,14 @@ private:
     void _logDownloadWorker(void);
     void _sendADSBVehicles(void);
     void _moveADSBVehicle(void);
+    void _sendLoadStreams(void);
+    void _sendLoadStreamMessage(int msgId, uint32_t timeBootMsecs);
+    void _deliverBytes(const QByteArray& bytes);
+    void _queueBytes(const QByteArray& bytes);
+    void _releaseDelayedBytes(void);
 
     static MockLink* _startMockLink(MockConfiguration* mockConfig);
+    static uint8_t _allocateVehicleSystemId(void);
 
     MockLinkMissionItemHandler  _missionItemHandler;
 
@@ -252,6 +345,28 @@ private:
     QGeoCoordinate  _adsbVehicleCoordinate;
     double          _adsbAngle;
 
+    typedef struct {
+        int     msgId;
+        qint64  intervalNsecs;
+        qint64  nextNsecs;      ///< Time to send the next message, relative to _loadStreamTimer
+    } LoadStream_t;
+
+    MockLink*           _swarmParent;       ///< Link carrying this vehicle's messages, NULL for the link's own vehicle
+    QList<MockLink*>    _swarmVehicles;     ///< Additional vehicles carried by this link
+    mavlink_status_t    _txStatus;          ///< Vehicle's own sequence numbers when several vehicles share the link's channel
+    QList<LoadStream_t> _loadStreams;
+    QElapsedTimer       _loadStreamTimer;
+    bool                _mavlink1;
+
+    // Link impairments, only used on the link's own vehicle
+    int                                 _packetLossPercent;
+    int                                 _jitterMsecs;
+    int                                 _reorderPercent;
+    QMutex                              _deliverMutex;      ///< Protects the impairment state, messages can be sent from outside the link thread
+    QElapsedTimer                       _deliverTimer;
+    QByteArray                          _reorderHeldBytes;  ///< Message held back to be delivered after the next one
+    QList<QPair<qint64, QByteArray> >   _delayedBytes;      ///< Jittered messages waiting for their release time in msecs
+
     static double       _defaultVehicleLatitude;
     static double       _defaultVehicleLongitude;
     static double       _defaultVehicleAltitude;
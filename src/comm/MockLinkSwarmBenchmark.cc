@@ -0,0 +1,265 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkSwarmBenchmark.h"
+#include "QGCApplication.h"
+#include "MultiVehicleManager.h"
+
+#include <QFile>
+
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+    #include <windows.h>
+#elif defined(Q_OS_UNIX)
+    #include <sys/resource.h>
+    #include <unistd.h>
+    #if defined(Q_OS_MAC)
+        #include <mach/mach.h>
+    #endif
+#endif
+
+MockLinkSwarmBenchmark::MockLinkSwarmBenchmark(const QString& options, QObject* parent)
+    : QObject               (parent)
+    , _vehicleCount         (50)
+    , _rateProfile          (MockConfiguration::RateProfileOnboard)
+    , _mavlink1Percent      (0)
+    , _packetLossPercent    (0)
+    , _jitterMsecs          (0)
+    , _reorderPercent       (0)
+    , _warmupSecs           (15)
+    , _durationSecs         (30)
+    , _measuring            (false)
+    , _messageCount         (0)
+    , _startResidentBytes   (-1)
+    , _startCpuMsecs        (-1)
+    , _lastLatencyNsecs     (0)
+{
+    _parseOptions(options);
+
+    _latencyTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_latencyTimer, &QTimer::timeout, this, &MockLinkSwarmBenchmark::_latencyTimeout);
+}
+
+void MockLinkSwarmBenchmark::_parseOptions(const QString& options)
+{
+    foreach (const QString& option, options.split(',', QString::SkipEmptyParts)) {
+        QString key = option.section('=', 0, 0).trimmed();
+        QString value = option.section('=', 1).trimmed();
+
+        if (key == "profile") {
+            if (value == "standard") {
+                _rateProfile = MockConfiguration::RateProfileNone;
+            } else if (value == "radio") {
+                _rateProfile = MockConfiguration::RateProfileTelemetryRadio;
+            } else if (value == "onboard") {
+                _rateProfile = MockConfiguration::RateProfileOnboard;
+            } else {
+                qWarning() << "Swarm benchmark: unknown profile" << value;
+            }
+            continue;
+        }
+
+        bool ok = false;
+        int intValue = value.toInt(&ok);
+        if (!ok) {
+            qWarning() << "Swarm benchmark: bad option" << option;
+            continue;
+        }
+
+        if (key == "vehicles") {
+            _vehicleCount = intValue;
+        } else if (key == "mavlink1") {
+            _mavlink1Percent = intValue;
+        } else if (key == "loss") {
+            _packetLossPercent = intValue;
+        } else if (key == "jitter") {
+            _jitterMsecs = intValue;
+        } else if (key == "reorder") {
+            _reorderPercent = intValue;
+        } else if (key == "warmup") {
+            _warmupSecs = intValue;
+        } else if (key == "duration") {
+            _durationSecs = intValue;
+        } else {
+            qWarning() << "Swarm benchmark: unknown option" << key;
+        }
+    }
+
+    // Vehicle ids are shared with any other MockLinks
+    _vehicleCount =     qBound(1, _vehicleCount, 200);
+    _mavlink1Percent =  qBound(0, _mavlink1Percent, 100);
+    _durationSecs =     qMax(1, _durationSecs);
+}
+
+void MockLinkSwarmBenchmark::start(void)
+{
+    int mavlink1Count = qRound(_vehicleCount * _mavlink1Percent / 100.0);
+
+    // MAVLink 1 and 2 vehicles are on links of their own, each link carries as many vehicles as it can
+    for (int mavlink1=0; mavlink1<2; mavlink1++) {
+        int remaining = mavlink1 ? mavlink1Count : _vehicleCount - mavlink1Count;
+        while (remaining > 0) {
+            int linkVehicles = qMin(remaining, static_cast<int>(MockConfiguration::maxVehicleCount));
+            MockLink* link = MockLink::startSwarmMockLink(linkVehicles, _rateProfile, mavlink1 != 0, _packetLossPercent, _jitterMsecs, _reorderPercent);
+            if (!link) {
+                qWarning() << "Swarm benchmark: unable to start link";
+                break;
+            }
+            _links.append(link);
+            remaining -= linkVehicles;
+        }
+    }
+
+    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &MockLinkSwarmBenchmark::_messageReceived);
+
+    qDebug() << "Swarm benchmark:" << _vehicleCount << "vehicles on" << _links.count() << "links, warming up for" << _warmupSecs << "secs";
+    QTimer::singleShot(_warmupSecs * 1000, this, &MockLinkSwarmBenchmark::_startMeasuring);
+}
+
+void MockLinkSwarmBenchmark::_startMeasuring(void)
+{
+    _measuring =            true;
+    _messageCount =         0;
+    _startResidentBytes =   _residentBytes();
+    _startCpuMsecs =        _cpuMsecs();
+    _latencyUsecs.clear();
+    _latencyUsecs.reserve(_durationSecs * (1000 / _latencyIntervalMsecs));
+
+    _latencyClock.start();
+    _lastLatencyNsecs = 0;
+    _latencyTimer.start(_latencyIntervalMsecs);
+    _measureTimer.start();
+
+    QTimer::singleShot(_durationSecs * 1000, this, &MockLinkSwarmBenchmark::_finish);
+}
+
+void MockLinkSwarmBenchmark::_messageReceived(LinkInterface* link, mavlink_message_t message)
+{
+    Q_UNUSED(message);
+
+    if (_measuring && _links.contains(qobject_cast<MockLink*>(link))) {
+        _messageCount++;
+    }
+}
+
+void MockLinkSwarmBenchmark::_latencyTimeout(void)
+{
+    qint64 nowNsecs = _latencyClock.nsecsElapsed();
+    qint64 lateNsecs = nowNsecs - _lastLatencyNsecs - (_latencyIntervalMsecs * 1000000LL);
+
+    _latencyUsecs.append(qMax(0LL, lateNsecs) / 1000);
+    _lastLatencyNsecs = nowNsecs;
+}
+
+void MockLinkSwarmBenchmark::_finish(void)
+{
+    _measuring = false;
+    _latencyTimer.stop();
+
+    double  seconds =       _measureTimer.elapsed() / 1000.0;
+    qint64  residentBytes = _residentBytes();
+    qint64  cpuMsecs =      _cpuMsecs();
+    int     vehiclesUp =    qgcApp()->toolbox()->multiVehicleManager()->vehicles()->count();
+
+    quint64 messagesLost = 0;
+    foreach (MockLink* link, _links) {
+        messagesLost += link->metrics()->messagesLost()->rawValue().toULongLong();
+    }
+
+    double latencyMean = 0;
+    double latencyP99 = 0;
+    double latencyMax = 0;
+    if (!_latencyUsecs.isEmpty()) {
+        QVector<qint64> sorted = _latencyUsecs;
+        std::sort(sorted.begin(), sorted.end());
+        qint64 total = 0;
+        foreach (qint64 usecs, sorted) {
+            total += usecs;
+        }
+        latencyMean =   total / 1000.0 / sorted.count();
+        latencyP99 =    sorted[qMin(sorted.count() - 1, (sorted.count() * 99) / 100)] / 1000.0;
+        latencyMax =    sorted.last() / 1000.0;
+    }
+
+    qDebug() << "Swarm benchmark results" << (qgcApp()->headless() ? "(headless)" : "(user interface)");
+    qDebug() << "  Vehicles:" << _vehicleCount << "up:" << vehiclesUp << "MAVLink 1 %:" << _mavlink1Percent;
+    qDebug() << "  Link loss %:" << _packetLossPercent << "jitter msecs:" << _jitterMsecs << "reorder %:" << _reorderPercent;
+    qDebug() << "  Messages/sec:" << _messageCount / seconds << "messages lost:" << messagesLost;
+    qDebug() << "  Gui thread latency msecs mean:" << latencyMean << "p99:" << latencyP99 << "max:" << latencyMax;
+    if (residentBytes >= 0 && _startResidentBytes >= 0) {
+        qDebug() << "  Memory growth KB:" << (residentBytes - _startResidentBytes) / 1024 << "resident KB:" << residentBytes / 1024;
+    } else {
+        qDebug() << "  Memory growth KB: not available";
+    }
+    if (cpuMsecs >= 0 && _startCpuMsecs >= 0) {
+        double cpuPercent = ((cpuMsecs - _startCpuMsecs) / 10.0) / seconds;
+        double cpuPercentPerVehicle = cpuPercent / _vehicleCount;
+        qDebug() << "  CPU %:" << cpuPercent << "per vehicle:" << cpuPercentPerVehicle;
+        if (cpuPercentPerVehicle > 0) {
+            // How many vehicles a single core could keep up with at this load
+            qDebug() << "  Vehicles per core:" << 100.0 / cpuPercentPerVehicle;
+        }
+    } else {
+        qDebug() << "  CPU %: not available";
+    }
+
+    LinkManager* linkManager = qgcApp()->toolbox()->linkManager();
+    foreach (MockLink* link, _links) {
+        linkManager->disconnectLink(link);
+    }
+    _links.clear();
+
+    emit finished();
+}
+
+qint64 MockLinkSwarmBenchmark::_residentBytes(void)
+{
+#if defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.count() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+    return -1;
+#elif defined(Q_OS_MAC)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS) {
+        return info.resident_size;
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+qint64 MockLinkSwarmBenchmark::_cpuMsecs(void)
+{
+#if defined(Q_OS_WIN)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        // FILETIME is in 100 nsec units
+        quint64 kernel = ((quint64)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+        quint64 user = ((quint64)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+        return (kernel + user) / 10000;
+    }
+    return -1;
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000LL + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
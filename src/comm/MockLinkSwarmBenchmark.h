@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "MockLink.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+
+/// Runs QGC against a swarm of MockLink vehicles and reports how well it keeps up.
+///
+/// After a warmup period which lets the vehicles come up and load their parameters the benchmark measures messages
+/// processed per second, gui thread latency (how late a 10 msec timer fires), memory growth, cpu use per vehicle and
+/// from that the number of vehicles a single core could keep up with. Runs the same with or without --headless.
+/// Options are given as a comma separated list of key=value pairs:
+///     vehicles    Number of vehicles (50)
+///     profile     Telemetry rate profile: standard, radio or onboard (onboard)
+///     mavlink1    Percentage of the vehicles using MAVLink 1 (0)
+///     loss        Packet loss percentage (0)
+///     jitter      Link jitter in msecs (0)
+///     reorder     Reordered message percentage (0)
+///     warmup      Warmup seconds (15)
+///     duration    Measurement seconds (30)
+class MockLinkSwarmBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    MockLinkSwarmBenchmark(const QString& options, QObject* parent = NULL);
+
+    /// Starts the swarm, finished is signalled once the results have been reported
+    void start(void);
+
+signals:
+    void finished(void);
+
+private slots:
+    void _startMeasuring(void);
+    void _finish(void);
+    void _latencyTimeout(void);
+    void _messageReceived(LinkInterface* link, mavlink_message_t message);
+
+private:
+    void _parseOptions(const QString& options);
+
+    /// @return Resident memory in bytes, -1 if not available
+    static qint64 _residentBytes(void);
+
+    /// @return Process cpu time in msecs, -1 if not available
+    static qint64 _cpuMsecs(void);
+
+    int                                 _vehicleCount;
+    MockConfiguration::RateProfile_t    _rateProfile;
+    int                                 _mavlink1Percent;
+    int                                 _packetLossPercent;
+    int                                 _jitterMsecs;
+    int                                 _reorderPercent;
+    int                                 _warmupSecs;
+    int                                 _durationSecs;
+
+    QList<MockLink*>    _links;
+    bool                _measuring;
+    quint64             _messageCount;
+    QElapsedTimer       _measureTimer;
+    qint64              _startResidentBytes;
+    qint64              _startCpuMsecs;
+
+    QTimer              _latencyTimer;
+    QElapsedTimer       _latencyClock;
+    qint64              _lastLatencyNsecs;
+    QVector<qint64>     _latencyUsecs;      ///< How late each latency timer tick was
+
+    static const int _latencyIntervalMsecs = 10;
+};
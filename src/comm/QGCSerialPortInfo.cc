@@ -15,10 +15,12 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMutexLocker>
 
 QGC_LOGGING_CATEGORY(QGCSerialPortInfoLog, "QGCSerialPortInfoLog")
 
 bool         QGCSerialPortInfo::_jsonLoaded =           false;
+QMutex       QGCSerialPortInfo::_jsonLoadMutex;
 const char*  QGCSerialPortInfo::_jsonFileTypeValue =    "USBBoardInfo";
 const char*  QGCSerialPortInfo::_jsonBoardInfoKey =     "boardInfo";
 const char*  QGCSerialPortInfo::_jsonBoardFallbackKey = "boardFallback";
@@ -54,11 +56,19 @@ QGCSerialPortInfo::QGCSerialPortInfo(const QSerialPort & port) :
 
 void QGCSerialPortInfo::_loadJsonData(void)
 {
+    // Board info is looked up from the gui thread, the serial port watcher and the firmware upgrade thread. The lists
+    // are only written here under the lock and never change once it is released.
+    QMutexLocker locker(&_jsonLoadMutex);
+
     if (_jsonLoaded) {
         return;
     }
+    _loadJsonFile();
     _jsonLoaded = true;
+}
 
+void QGCSerialPortInfo::_loadJsonFile(void)
+{
     QFile file(QStringLiteral(":/json/USBBoardInfo.json"));
 
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
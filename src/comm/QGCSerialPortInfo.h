@@ -19,6 +19,8 @@
 
 #include "QGCLoggingCategory.h"
 
+#include <QMutex>
+
 Q_DECLARE_LOGGING_CATEGORY(QGCSerialPortInfoLog)
 
 /// QGC's version of Qt QSerialPortInfo. It provides additional information about board types
@@ -72,10 +74,12 @@ private:
     } BoardFallback_t;
 
     static void _loadJsonData(void);
+    static void _loadJsonFile(void);
     static BoardType_t _boardClassStringToType(const QString& boardClass);
     static QString _boardTypeToString(BoardType_t boardType);
 
     static bool         _jsonLoaded;
+    static QMutex       _jsonLoadMutex;
     static const char*  _jsonFileTypeValue;
     static const char*  _jsonBoardInfoKey;
     static const char*  _jsonBoardFallbackKey;
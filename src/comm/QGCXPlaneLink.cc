@@ -25,11 +25,39 @@
 #include <iostream>
 #include <Eigen/Eigen>
 
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "QGCXPlaneLink.h"
 #include "QGC.h"
 #include "UAS.h"
 #include "UASInterface.h"
 #include "QGCMessageBox.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "MAVLinkProtocol.h"
+
+QGC_LOGGING_CATEGORY(XPlaneLinkLog, "XPlaneLinkLog")
+
+namespace {
+    // Sensor noise variances, in the units of the HIL_SENSOR fields
+    const float kNoiseScaler =          0.0001f;
+    const float kXAccVar =              kNoiseScaler * 0.2914f;
+    const float kYAccVar =              kNoiseScaler * 0.2914f;
+    const float kZAccVar =              kNoiseScaler * 0.9577f;
+    const float kRollSpeedVar =         kNoiseScaler * 0.8126f;
+    const float kPitchSpeedVar =        kNoiseScaler * 0.6145f;
+    const float kYawSpeedVar =          kNoiseScaler * 0.5852f;
+    const float kXMagVar =              kNoiseScaler * 0.0786f;
+    const float kYMagVar =              kNoiseScaler * 0.0566f;
+    const float kZMagVar =              kNoiseScaler * 0.0333f;
+    const float kAbsPressureVar =       kNoiseScaler * 0.5604f;
+    const float kDiffPressureVar =      kNoiseScaler * 0.2604f;
+    const float kPressureAltVar =       kNoiseScaler * 0.5604f;
+    const float kTemperatureVar =       kNoiseScaler * 0.7290f;
+}
 
 QGCXPlaneLink::QGCXPlaneLink(Vehicle* vehicle, QString remoteHost, QHostAddress localHost, quint16 localPort) :
     _vehicle(vehicle),
@@ -42,14 +70,19 @@ QGCXPlaneLink::QGCXPlaneLink(Vehicle* vehicle, QString remoteHost, QHostAddress
     airframeID(QGCXPlaneLink::AIRFRAME_UNKNOWN),
     xPlaneConnected(false),
     xPlaneVersion(0),
-    simUpdateLast(QGC::groundTimeMilliseconds()),
     simUpdateFirst(0),
-    simUpdateLastText(QGC::groundTimeMilliseconds()),
     simUpdateLastGroundTruth(QGC::groundTimeMilliseconds()),
-    simUpdateHz(0),
     _sensorHilEnabled(true),
     _useHilActuatorControls(true),
-    _should_exit(false)
+    _vehicleId(0),
+    _vehicleType(vehicle->vehicleType()),
+    _vehicleHilMode(false),
+    _mavlinkChannel(qgcApp()->toolbox()->linkManager()->_reserveMavlinkChannel()),
+    _systemId(0),
+    _componentId(MAV_COMP_ID_SYSTEM_CONTROL),
+    _datagramBuffer(_cMaxDatagramBytes, 0),
+    _noiseGenerator(std::random_device()()),
+    _statisticsTimer(NULL)
 {
     // We're doing it wrong - because the Qt folks got the API wrong:
     // http://blog.qt.digia.com/blog/2010/06/17/youre-doing-it-wrong/
@@ -64,18 +97,21 @@ QGCXPlaneLink::QGCXPlaneLink(Vehicle* vehicle, QString remoteHost, QHostAddress
     this->name = tr("X-Plane Link (localPort:%1)").arg(localPort);
     setRemoteHost(remoteHost);
     loadSettings();
+
+    if (_mavlinkChannel == 0) {
+        qWarning() << "QGCXPlaneLink: Ran out of mavlink channels";
+    }
 }
 
 QGCXPlaneLink::~QGCXPlaneLink()
 {
     storeSettings();
-    // Tell the thread to exit
-    _should_exit = true;
+    // Tell the thread to exit, it closes the socket on the way out
+    quit();
+    wait();
 
-    if (socket) {
-        socket->close();
-        socket->deleteLater();
-        socket = NULL;
+    if (_mavlinkChannel != 0) {
+        qgcApp()->toolbox()->linkManager()->_freeMavlinkChannel(_mavlinkChannel);
     }
 }
 
@@ -172,6 +208,13 @@ void QGCXPlaneLink::run()
         return;
     }
 
+    if (!_vehicleLink || _mavlinkChannel == 0) {
+        emit statusMessage(tr("No vehicle link available"));
+        return;
+    }
+
+    _setRealtimePriority();
+
     socket = new QUdpSocket(this);
     socket->moveToThread(this);
     connectState = socket->bind(localHost, localPort, QAbstractSocket::ReuseAddressHint);
@@ -181,22 +224,46 @@ void QGCXPlaneLink::run()
 
         socket->deleteLater();
         socket = NULL;
+        _vehicleLink.clear();
         return;
     }
 
     emit statusMessage(tr("Waiting for XPlane.."));
 
+    // Reset the loop state and statistics
+    _loopClock.start();
+    _lastSendUsecs =            -_cMinSendIntervalUsecs;
+    _lastGpsSendUsecs =         -_cGpsSendIntervalUsecs;
+    _lastSensorSendUsecs =      -1;
+    _lastHilModeRequestUsecs =  0;
+    _lastFrameUsecs =           -1;
+    _intervalFrames =           0;
+    _intervalPeriods =          0;
+    _intervalPeriodSum =        0;
+    _intervalPeriodSquareSum =  0;
+    _intervalLoops =            0;
+    _intervalLoopSum =          0;
+    _intervalLoopMax =          0;
+    _intervalLatencies =        0;
+    _intervalLatencySum =       0;
+    _intervalLatencyMax =       0;
+    {
+        QMutexLocker locker(&statisticsMutex);
+        _statistics = HilStatistics_t();
+    }
+
+    _statisticsTimer = new QTimer(this);
+    _statisticsTimer->setInterval(_cStatisticsMSecs);
+    QObject::connect(_statisticsTimer, &QTimer::timeout, this, &QGCXPlaneLink::_publishStatistics);
+    _statisticsTimer->start();
+
     QObject::connect(socket, &QUdpSocket::readyRead, this, &QGCXPlaneLink::readBytes);
 
-    connect(_vehicle->uas(), &UAS::hilControlsChanged, this, &QGCXPlaneLink::updateControls, Qt::QueuedConnection);
-    connect(_vehicle, &Vehicle::hilActuatorControlsChanged, this, &QGCXPlaneLink::updateActuatorControls, Qt::QueuedConnection);
+    // The vehicle's bytes are parsed again on this thread so its controls don't have to go through the gui thread
+    QObject::connect(_vehicleLink.data(), &LinkInterface::bytesReceived, this, &QGCXPlaneLink::_vehicleBytesReceived, Qt::QueuedConnection);
 
+    connect(this, &QGCXPlaneLink::_requestVehicleHilMode, _vehicle, &Vehicle::setHilMode, Qt::QueuedConnection);
     connect(this, &QGCXPlaneLink::hilGroundTruthChanged, _vehicle->uas(), &UAS::sendHilGroundTruth, Qt::QueuedConnection);
-    connect(this, &QGCXPlaneLink::hilStateChanged, _vehicle->uas(), &UAS::sendHilState, Qt::QueuedConnection);
-    connect(this, &QGCXPlaneLink::sensorHilGpsChanged, _vehicle->uas(), &UAS::sendHilGps, Qt::QueuedConnection);
-    connect(this, &QGCXPlaneLink::sensorHilRawImuChanged, _vehicle->uas(), &UAS::sendHilSensors, Qt::QueuedConnection);
-
-    _vehicle->uas()->startHil();
 
 #pragma pack(push, 1)
     struct iset_struct
@@ -241,31 +308,96 @@ void QGCXPlaneLink::run()
     /* Call function which makes sure individual control override is enabled/disabled */
     enableHilActuatorControls(_useHilActuatorControls);
 
-    _should_exit = false;
-
-    while(!_should_exit) {
-        QCoreApplication::processEvents();
-        QGC::SLEEP::msleep(5);
-    }
-
-    disconnect(_vehicle->uas(), &UAS::hilControlsChanged, this, &QGCXPlaneLink::updateControls);
+    exec();
 
+    QObject::disconnect(_vehicleLink.data(), &LinkInterface::bytesReceived, this, &QGCXPlaneLink::_vehicleBytesReceived);
+    disconnect(this, &QGCXPlaneLink::_requestVehicleHilMode, _vehicle, &Vehicle::setHilMode);
     disconnect(this, &QGCXPlaneLink::hilGroundTruthChanged, _vehicle->uas(), &UAS::sendHilGroundTruth);
-    disconnect(this, &QGCXPlaneLink::hilStateChanged, _vehicle->uas(), &UAS::sendHilState);
-    disconnect(this, &QGCXPlaneLink::sensorHilGpsChanged, _vehicle->uas(), &UAS::sendHilGps);
-    disconnect(this, &QGCXPlaneLink::sensorHilRawImuChanged, _vehicle->uas(), &UAS::sendHilSensors);
     connectState = false;
 
     disconnect(socket, &QUdpSocket::readyRead, this, &QGCXPlaneLink::readBytes);
 
+    delete _statisticsTimer;
+    _statisticsTimer = NULL;
+
     socket->close();
-    socket->deleteLater();
+    delete socket;
     socket = NULL;
 
+    _vehicleLink.clear();
+
     emit simulationDisconnected();
     emit simulationConnected(false);
 }
 
+/// Moves the bridge thread to real-time scheduling where the system allows it. Otherwise it stays at
+/// QThread::TimeCriticalPriority.
+void QGCXPlaneLink::_setRealtimePriority(void)
+{
+#if defined(Q_OS_LINUX)
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err == 0) {
+        qCDebug(XPlaneLinkLog) << "Bridge thread running SCHED_FIFO";
+    } else {
+        qCDebug(XPlaneLinkLog) << "SCHED_FIFO not available, using time critical priority" << err;
+    }
+#endif
+}
+
+QGCXPlaneLink::HilStatistics_t QGCXPlaneLink::statistics(void)
+{
+    QMutexLocker locker(&statisticsMutex);
+    return _statistics;
+}
+
+void QGCXPlaneLink::_publishStatistics(void)
+{
+    QMutexLocker locker(&statisticsMutex);
+
+    if (_intervalFrames) {
+        _statistics.framePeriodUsecs = 0;
+        _statistics.frameJitterUsecs = 0;
+        if (_intervalPeriods) {
+            double mean = _intervalPeriodSum / _intervalPeriods;
+            _statistics.framePeriodUsecs = mean;
+            _statistics.frameJitterUsecs = sqrt(qMax(0.0, (_intervalPeriodSquareSum / _intervalPeriods) - (mean * mean)));
+        }
+        _statistics.loopUsecs =     _intervalLoops ? _intervalLoopSum / _intervalLoops : 0;
+        _statistics.loopMaxUsecs =  _intervalLoopMax;
+        if (_intervalLatencies) {
+            _statistics.controlLatencyUsecs =       _intervalLatencySum / _intervalLatencies;
+            _statistics.controlLatencyMaxUsecs =    _intervalLatencyMax;
+        }
+
+        qCDebug(XPlaneLinkLog) << "frames:"         << _intervalFrames
+                               << "period us:"      << _statistics.framePeriodUsecs
+                               << "jitter us:"      << _statistics.frameJitterUsecs
+                               << "loop us:"        << _statistics.loopUsecs
+                               << "loop max us:"    << _statistics.loopMaxUsecs
+                               << "control us:"     << _statistics.controlLatencyUsecs
+                               << "control max us:" << _statistics.controlLatencyMaxUsecs;
+
+        emit statusMessage(tr("Receiving from XPlane at %1 Hz, jitter %2 ms, loop %3 ms")
+                           .arg(static_cast<int>((_intervalFrames * 1000.0) / _cStatisticsMSecs))
+                           .arg(_statistics.frameJitterUsecs / 1000.0, 0, 'f', 2)
+                           .arg(_statistics.loopUsecs / 1000.0, 0, 'f', 2));
+    }
+
+    _intervalFrames =           0;
+    _intervalPeriods =          0;
+    _intervalPeriodSum =        0;
+    _intervalPeriodSquareSum =  0;
+    _intervalLoops =            0;
+    _intervalLoopSum =          0;
+    _intervalLoopMax =          0;
+    _intervalLatencies =        0;
+    _intervalLatencySum =       0;
+    _intervalLatencyMax =       0;
+}
+
 void QGCXPlaneLink::setPort(int localPort)
 {
     this->localPort = localPort;
@@ -366,65 +498,47 @@ void QGCXPlaneLink::updateControls(quint64 time, float rollAilerons, float pitch
         //qDebug() << "received HIL_CONTROL but not using it";
         return;
     }
-    #pragma pack(push, 1)
-    struct payload {
-        char b[5];
-        int index;
-        float f[8];
-    } p;
-    #pragma pack(pop)
-
-    p.b[0] = 'D';
-    p.b[1] = 'A';
-    p.b[2] = 'T';
-    p.b[3] = 'A';
-    p.b[4] = '\0';
 
     Q_UNUSED(time);
     Q_UNUSED(systemMode);
     Q_UNUSED(navMode);
 
-    if (_vehicle->vehicleType() == MAV_TYPE_QUADROTOR
-        || _vehicle->vehicleType() == MAV_TYPE_HEXAROTOR
-        || _vehicle->vehicleType() == MAV_TYPE_OCTOROTOR)
-    {
-        qDebug() << "MAV_TYPE_QUADROTOR";
+    DataSegment_t segments[3];
+    memset(segments, 0, sizeof(segments));
 
+    if (_vehicleType == MAV_TYPE_QUADROTOR
+        || _vehicleType == MAV_TYPE_HEXAROTOR
+        || _vehicleType == MAV_TYPE_OCTOROTOR)
+    {
         // Individual effort will be provided directly to the actuators on Xplane quadrotor.
-        p.f[0] = yawRudder;
-        p.f[1] = rollAilerons;
-        p.f[2] = throttle;
-        p.f[3] = pitchElevator;
+        segments[0].values[0] = yawRudder;
+        segments[0].values[1] = rollAilerons;
+        segments[0].values[2] = throttle;
+        segments[0].values[3] = pitchElevator;
 
         // Direct throttle control
-        p.index = 25;
-        writeBytesSafe((const char*)&p, sizeof(p));
+        segments[0].index = 25;
+        _sendDataSegments(segments, 1);
     }
     else
     {
         // direct pass-through, normal fixed-wing.
-        p.f[0] = -pitchElevator;
-        p.f[1] = rollAilerons;
-        p.f[2] = yawRudder;
-
-        // Ail / Elevon / Rudder
-
-        // Send to group 12
-        p.index = 12;
-        writeBytesSafe((const char*)&p, sizeof(p));
-
-        // Send to group 8, which equals manual controls
-        p.index = 8;
-        writeBytesSafe((const char*)&p, sizeof(p));
+        // Ail / Elevon / Rudder to group 12 and group 8, which equals manual controls
+        segments[0].index = 12;
+        segments[0].values[0] = -pitchElevator;
+        segments[0].values[1] = rollAilerons;
+        segments[0].values[2] = yawRudder;
+        segments[1] = segments[0];
+        segments[1].index = 8;
 
         // Send throttle to all four motors
-        p.index = 25;
-        memset(p.f, 0, sizeof(p.f));
-        p.f[0] = throttle;
-        p.f[1] = throttle;
-        p.f[2] = throttle;
-        p.f[3] = throttle;
-        writeBytesSafe((const char*)&p, sizeof(p));
+        segments[2].index = 25;
+        segments[2].values[0] = throttle;
+        segments[2].values[1] = throttle;
+        segments[2].values[2] = throttle;
+        segments[2].values[3] = throttle;
+
+        _sendDataSegments(segments, 3);
     }
 }
 
@@ -443,40 +557,28 @@ void QGCXPlaneLink::updateActuatorControls(quint64 time, quint64 flags, float ct
     Q_UNUSED(ctl_14);
     Q_UNUSED(ctl_15);
 
-    #pragma pack(push, 1)
-    struct payload {
-        char b[5];
-        int index;
-        float f[8];
-    } p;
-    #pragma pack(pop)
-
-    p.b[0] = 'D';
-    p.b[1] = 'A';
-    p.b[2] = 'T';
-    p.b[3] = 'A';
-    p.b[4] = '\0';
+    DataSegment_t segments[2];
 
     /* Initialize with zeroes */
-    memset(p.f, 0, sizeof(p.f));
+    memset(segments, 0, sizeof(segments));
 
-    switch (_vehicle->vehicleType()) {
+    switch (_vehicleType) {
         case MAV_TYPE_QUADROTOR:
         case MAV_TYPE_HEXAROTOR:
         case MAV_TYPE_OCTOROTOR:
         {
-            p.f[0] = ctl_0;         ///< X-Plane Engine 1
-            p.f[1] = ctl_1;         ///< X-Plane Engine 2
-            p.f[2] = ctl_2;         ///< X-Plane Engine 3
-            p.f[3] = ctl_3;         ///< X-Plane Engine 4
-            p.f[4] = ctl_4;         ///< X-Plane Engine 5
-            p.f[5] = ctl_5;         ///< X-Plane Engine 6
-            p.f[6] = ctl_6;         ///< X-Plane Engine 7
-            p.f[7] = ctl_7;         ///< X-Plane Engine 8
+            segments[0].values[0] = ctl_0;         ///< X-Plane Engine 1
+            segments[0].values[1] = ctl_1;         ///< X-Plane Engine 2
+            segments[0].values[2] = ctl_2;         ///< X-Plane Engine 3
+            segments[0].values[3] = ctl_3;         ///< X-Plane Engine 4
+            segments[0].values[4] = ctl_4;         ///< X-Plane Engine 5
+            segments[0].values[5] = ctl_5;         ///< X-Plane Engine 6
+            segments[0].values[6] = ctl_6;         ///< X-Plane Engine 7
+            segments[0].values[7] = ctl_7;         ///< X-Plane Engine 8
 
             /* Direct throttle control */
-            p.index = 25;
-            writeBytesSafe((const char*)&p, sizeof(p));
+            segments[0].index = 25;
+            _sendDataSegments(segments, 1);
             break;
         }
         case MAV_TYPE_VTOL_RESERVED2:
@@ -486,18 +588,18 @@ void QGCXPlaneLink::updateActuatorControls(quint64 time, quint64 flags, float ct
              */
 
             /* Throttle channels */
-            p.f[0] = ctl_0;
-            p.f[1] = ctl_1;
-            p.f[2] = ctl_2;
-            p.f[3] = ctl_3;
-            p.f[4] = ctl_4;
-            p.f[5] = ctl_5;
-            p.f[6] = ctl_6;
-            p.f[7] = ctl_7;
-            p.index = 25;
-            writeBytesSafe((const char*)&p, sizeof(p));
-
-            /* Control individual actuators */
+            segments[0].values[0] = ctl_0;
+            segments[0].values[1] = ctl_1;
+            segments[0].values[2] = ctl_2;
+            segments[0].values[3] = ctl_3;
+            segments[0].values[4] = ctl_4;
+            segments[0].values[5] = ctl_5;
+            segments[0].values[6] = ctl_6;
+            segments[0].values[7] = ctl_7;
+            segments[0].index = 25;
+            _sendDataSegments(segments, 1);
+
+            /* Control individual actuators, X-Plane only takes a single dataref per DREF packet */
             float max_surface_deflection = 30.0f; // Degrees
             sendDataRef("sim/flightmodel/controls/wing1l_ail1def", ctl_8 * max_surface_deflection);
             sendDataRef("sim/flightmodel/controls/wing1r_ail1def", ctl_9 * max_surface_deflection);
@@ -512,26 +614,19 @@ void QGCXPlaneLink::updateActuatorControls(quint64 time, quint64 flags, float ct
         }
         default:
         {
-            /* direct pass-through, normal fixed-wing. */
-            p.f[0] = -ctl_1;        ///< X-Plane Elevator
-            p.f[1] = ctl_0;         ///< X-Plane Aileron
-            p.f[2] = ctl_2;         ///< X-Plane Rudder
-
-            /* Send to group 8, which equals manual controls */
-            p.index = 8;
-            writeBytesSafe((const char*)&p, sizeof(p));
-
-            /* Send throttle to all eight motors */
-            p.index = 25;
-            p.f[0] = ctl_3;
-            p.f[1] = ctl_3;
-            p.f[2] = ctl_3;
-            p.f[3] = ctl_3;
-            p.f[4] = ctl_3;
-            p.f[5] = ctl_3;
-            p.f[6] = ctl_3;
-            p.f[7] = ctl_3;
-            writeBytesSafe((const char*)&p, sizeof(p));
+            /* direct pass-through, normal fixed-wing. Group 8 equals manual controls */
+            segments[0].index = 8;
+            segments[0].values[0] = -ctl_1;        ///< X-Plane Elevator
+            segments[0].values[1] = ctl_0;         ///< X-Plane Aileron
+            segments[0].values[2] = ctl_2;         ///< X-Plane Rudder
+
+            /* Throttle to all eight motors */
+            segments[1].index = 25;
+            for (int i=0; i<8; i++) {
+                segments[1].values[i] = ctl_3;
+            }
+
+            _sendDataSegments(segments, 2);
 
             /* Send flap signals, assuming that they are mapped to channel 5 (ctl_4) */
             sendDataRef("sim/flightmodel/controls/flaprqst", ctl_4);
@@ -543,6 +638,32 @@ void QGCXPlaneLink::updateActuatorControls(quint64 time, quint64 flags, float ct
 
 }
 
+/// Sends all segments in a single DATA packet, which X-Plane applies together
+void QGCXPlaneLink::_sendDataSegments(const DataSegment_t* segments, int count)
+{
+    static const int headerBytes =  5;
+    static const int segmentBytes = sizeof(qint32) + (8 * sizeof(float));
+
+    QByteArray packet(headerBytes + (count * segmentBytes), 0);
+    char* data = packet.data();
+
+    memcpy(data, "DATA", 4);
+    for (int i=0; i<count; i++) {
+        char* segment = data + headerBytes + (i * segmentBytes);
+        memcpy(segment, &segments[i].index, sizeof(qint32));
+        memcpy(segment + sizeof(qint32), segments[i].values, 8 * sizeof(float));
+    }
+
+    if (QThread::currentThread() == this) {
+        _writeBytes(packet);
+    } else {
+        writeBytesSafe(packet.constData(), packet.length());
+    }
+
+    QMutexLocker locker(&statisticsMutex);
+    _statistics.controlPackets++;
+}
+
 Eigen::Matrix3f euler_to_wRo(double yaw, double pitch, double roll) {
   double c__ = cos(yaw);
   double _c_ = cos(pitch);
@@ -587,27 +708,36 @@ void QGCXPlaneLink::_writeBytes(const QByteArray data)
  * @brief Read all pending packets from the interface.
  **/
 void QGCXPlaneLink::readBytes()
+{
+    while (socket && socket->hasPendingDatagrams()) {
+        qint64 receivedUsecs = _loopUsecs();
+
+        qint64 pendingSize = socket->pendingDatagramSize();
+        if (pendingSize > _cMaxDatagramBytes) {
+            qCWarning(XPlaneLinkLog) << "UDP datagram overflow, allowed to read less bytes than datagram size:" << pendingSize;
+        }
+
+        qint64 length = socket->readDatagram(_datagramBuffer.data(), _datagramBuffer.size());
+        if (length < 5) {
+            // Every X-Plane packet has a 5 byte header
+            continue;
+        }
+
+        _processDatagram(_datagramBuffer.constData(), length, receivedUsecs);
+    }
+}
+
+/// Parses a single X-Plane packet and sends the resulting HIL messages to the vehicle
+///     @param receivedUsecs Loop clock time the packet was read
+void QGCXPlaneLink::_processDatagram(const char* data, qint64 length, qint64 receivedUsecs)
 {
     // Only emit updates on attitude message
     bool emitUpdate = false;
     quint16 fields_changed = 0;
 
-    const qint64 maxLength = 65536;
-    char data[maxLength];
-    QHostAddress sender;
-    quint16 senderPort;
-
-    unsigned int s = socket->pendingDatagramSize();
-    if (s > maxLength) std::cerr << __FILE__ << __LINE__ << " UDP datagram overflow, allowed to read less bytes than datagram size: " << s << std::endl;
-    socket->readDatagram(data, maxLength, &sender, &senderPort);
-    if (s > maxLength) {
-    	std::string headStr = std::string(data, data+5);
-    	std::cerr << __FILE__ << __LINE__ << " UDP datagram header: " << headStr << std::endl;
-    }
-
     // Calculate the number of data segments a 36 bytes
     // XPlane always has 5 bytes header: 'DATA@'
-    unsigned nsegs = (s-5)/36;
+    unsigned nsegs = (length-5)/36;
 
     //qDebug() << "XPLANE:" << "LEN:" << s << "segs:" << nsegs;
 
@@ -631,6 +761,19 @@ void QGCXPlaneLink::readBytes()
             simUpdateFirst = QGC::groundTimeMilliseconds();
         }
 
+        if (_lastFrameUsecs >= 0) {
+            double period = receivedUsecs - _lastFrameUsecs;
+            _intervalPeriods++;
+            _intervalPeriodSum += period;
+            _intervalPeriodSquareSum += period * period;
+        }
+        _lastFrameUsecs = receivedUsecs;
+        _intervalFrames++;
+        {
+            QMutexLocker locker(&statisticsMutex);
+            _statistics.frames++;
+        }
+
         for (unsigned i = 0; i < nsegs; i++)
         {
             // Get index
@@ -848,18 +991,18 @@ void QGCXPlaneLink::readBytes()
     }
 
     // Send updated state
-    if (emitUpdate && (QGC::groundTimeMilliseconds() - simUpdateLast) > 2)
+    if (emitUpdate && (receivedUsecs - _lastSendUsecs) >= _cMinSendIntervalUsecs)
     {
-        simUpdateHz = simUpdateHz * 0.9f + 0.1f * (1000.0f / (QGC::groundTimeMilliseconds() - simUpdateLast));
-        if (QGC::groundTimeMilliseconds() - simUpdateLastText > 2000) {
-            emit statusMessage(tr("Receiving from XPlane at %1 Hz").arg(static_cast<int>(simUpdateHz)));
-            // Reset lowpass with current value
-            simUpdateHz = (1000.0f / (QGC::groundTimeMilliseconds() - simUpdateLast));
-            // Set state
-            simUpdateLastText = QGC::groundTimeMilliseconds();
+        if (!_vehicleHilMode) {
+            // The vehicle ignores HIL messages until it is in HIL mode, keep asking while X-Plane is sending
+            if (_lastHilModeRequestUsecs == 0 || receivedUsecs - _lastHilModeRequestUsecs > 1000000) {
+                emit _requestVehicleHilMode(true);
+                _lastHilModeRequestUsecs = receivedUsecs;
+            }
+            return;
         }
 
-        simUpdateLast = QGC::groundTimeMilliseconds();
+        _lastSendUsecs = receivedUsecs;
 
         if (_sensorHilEnabled)
         {
@@ -891,24 +1034,21 @@ void QGCXPlaneLink::readBytes()
             // set pressure alt to changed
             fields_changed |= (1 << 11);
 
-            emit sensorHilRawImuChanged(QGC::groundTimeUsecs(), xacc, yacc, zacc, rollspeed, pitchspeed, yawspeed,
-                                        xmag, ymag, zmag, abs_pressure, diff_pressure / 100.0, pressure_alt, temperature, fields_changed);
-
-            // XXX make these GUI-configurable and add randomness
-            int gps_fix_type = 3;
-            float eph = 0.3f;
-            float epv = 0.6f;
-            float vel = sqrt(vx*vx + vy*vy + vz*vz);
-            float cog = atan2(vy, vx);
-            int satellites = 8;
+            _sendHilSensor(fields_changed);
 
-            emit sensorHilGpsChanged(QGC::groundTimeUsecs(), lat, lon, alt, gps_fix_type, eph, epv, vel, vx, vy, vz, cog, satellites);
+            if (receivedUsecs - _lastGpsSendUsecs >= _cGpsSendIntervalUsecs) {
+                _sendHilGps();
+                _lastGpsSendUsecs = receivedUsecs;
+            }
         } else {
-            emit hilStateChanged(QGC::groundTimeUsecs(), roll, pitch, yaw, rollspeed,
-                                 pitchspeed, yawspeed, lat, lon, alt,
-                                 vx, vy, vz, ind_airspeed, true_airspeed, xacc, yacc, zacc);
+            _sendHilState();
         }
 
+        qint64 loopUsecs = _loopUsecs() - receivedUsecs;
+        _intervalLoops++;
+        _intervalLoopSum += loopUsecs;
+        _intervalLoopMax = qMax(_intervalLoopMax, loopUsecs);
+
         // Limit ground truth to 25 Hz
         if (QGC::groundTimeMilliseconds() - simUpdateLastGroundTruth > 40) {
             emit hilGroundTruthChanged(QGC::groundTimeUsecs(), roll, pitch, yaw, rollspeed,
@@ -936,6 +1076,205 @@ void QGCXPlaneLink::readBytes()
 }
 
 
+float QGCXPlaneLink::_addNoise(float value, float variance)
+{
+    std::normal_distribution<float> noise(0.0f, sqrt(variance));
+    return value + noise(_noiseGenerator);
+}
+
+void QGCXPlaneLink::_sendHilSensor(quint32 fieldsChanged)
+{
+    mavlink_message_t msg;
+    mavlink_msg_hil_sensor_pack_chan(_systemId,
+                                     _componentId,
+                                     _mavlinkChannel,
+                                     &msg,
+                                     QGC::groundTimeUsecs(),
+                                     _addNoise(xacc, kXAccVar),
+                                     _addNoise(yacc, kYAccVar),
+                                     _addNoise(zacc, kZAccVar),
+                                     _addNoise(rollspeed, kRollSpeedVar),
+                                     _addNoise(pitchspeed, kPitchSpeedVar),
+                                     _addNoise(yawspeed, kYawSpeedVar),
+                                     _addNoise(xmag, kXMagVar),
+                                     _addNoise(ymag, kYMagVar),
+                                     _addNoise(zmag, kZMagVar),
+                                     _addNoise(abs_pressure, kAbsPressureVar),
+                                     _addNoise(diff_pressure / 100.0f, kDiffPressureVar),
+                                     _addNoise(pressure_alt, kPressureAltVar),
+                                     _addNoise(temperature, kTemperatureVar),
+                                     fieldsChanged);
+    _sendToVehicle(msg);
+    _lastSensorSendUsecs = _loopUsecs();
+}
+
+void QGCXPlaneLink::_sendHilGps(void)
+{
+    // XXX make these GUI-configurable and add randomness
+    int gps_fix_type = 3;
+    float eph = 0.3f;
+    float epv = 0.6f;
+    float vel = sqrt(vx*vx + vy*vy + vz*vz);
+    int satellites = 8;
+
+    // Course over ground in centi-degrees, 0..360
+    float course = atan2(vy, vx);
+    if (course < 0) {
+        course += 2.0f * static_cast<float>(M_PI);
+    }
+    course = (course / M_PI) * 180.0f;
+
+    mavlink_message_t msg;
+    mavlink_msg_hil_gps_pack_chan(_systemId,
+                                  _componentId,
+                                  _mavlinkChannel,
+                                  &msg,
+                                  QGC::groundTimeUsecs(),
+                                  gps_fix_type,
+                                  lat * 1e7,
+                                  lon * 1e7,
+                                  alt * 1e3,
+                                  eph * 1e2,
+                                  epv * 1e2,
+                                  vel * 1e2,
+                                  vx * 1e2,
+                                  vy * 1e2,
+                                  vz * 1e2,
+                                  course * 1e2,
+                                  satellites);
+    _sendToVehicle(msg);
+}
+
+void QGCXPlaneLink::_sendHilState(void)
+{
+    float q[4];
+
+    double cosPhi_2 = cos(double(roll) / 2.0);
+    double sinPhi_2 = sin(double(roll) / 2.0);
+    double cosTheta_2 = cos(double(pitch) / 2.0);
+    double sinTheta_2 = sin(double(pitch) / 2.0);
+    double cosPsi_2 = cos(double(yaw) / 2.0);
+    double sinPsi_2 = sin(double(yaw) / 2.0);
+    q[0] = (cosPhi_2 * cosTheta_2 * cosPsi_2 +
+            sinPhi_2 * sinTheta_2 * sinPsi_2);
+    q[1] = (sinPhi_2 * cosTheta_2 * cosPsi_2 -
+            cosPhi_2 * sinTheta_2 * sinPsi_2);
+    q[2] = (cosPhi_2 * sinTheta_2 * cosPsi_2 +
+            sinPhi_2 * cosTheta_2 * sinPsi_2);
+    q[3] = (cosPhi_2 * cosTheta_2 * sinPsi_2 -
+            sinPhi_2 * sinTheta_2 * cosPsi_2);
+
+    mavlink_message_t msg;
+    mavlink_msg_hil_state_quaternion_pack_chan(_systemId,
+                                               _componentId,
+                                               _mavlinkChannel,
+                                               &msg,
+                                               QGC::groundTimeUsecs(),
+                                               q,
+                                               rollspeed,
+                                               pitchspeed,
+                                               yawspeed,
+                                               lat * 1e7f,
+                                               lon * 1e7f,
+                                               alt * 1000,
+                                               vx * 100,
+                                               vy * 100,
+                                               vz * 100,
+                                               ind_airspeed * 100,
+                                               true_airspeed * 100,
+                                               xacc * 1000 / 9.81,
+                                               yacc * 1000 / 9.81,
+                                               zacc * 1000 / 9.81);
+    _sendToVehicle(msg);
+    _lastSensorSendUsecs = _loopUsecs();
+}
+
+/// Queues the message on the vehicle link at control priority, which flushes it without waiting for the gui thread
+void QGCXPlaneLink::_sendToVehicle(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int len = mavlink_msg_to_send_buffer(buffer, &message);
+    _vehicleLink->writeBytesSafe((const char*)buffer, len, LinkInterface::SendPriorityControl);
+
+    QMutexLocker locker(&statisticsMutex);
+    _statistics.sensorMessages++;
+}
+
+void QGCXPlaneLink::_vehicleBytesReceived(LinkInterface* link, QByteArray bytes)
+{
+    Q_UNUSED(link);
+
+    mavlink_message_t message;
+    mavlink_status_t status;
+
+    for (int i=0; i<bytes.length(); i++) {
+        if (!mavlink_parse_char(_mavlinkChannel, static_cast<uint8_t>(bytes[i]), &message, &status)) {
+            continue;
+        }
+        if (message.sysid != _vehicleId) {
+            continue;
+        }
+
+        switch (message.msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        {
+            mavlink_heartbeat_t heartbeat;
+            mavlink_msg_heartbeat_decode(&message, &heartbeat);
+            _vehicleHilMode = heartbeat.base_mode & MAV_MODE_FLAG_HIL_ENABLED;
+            break;
+        }
+        case MAVLINK_MSG_ID_HIL_CONTROLS:
+        {
+            mavlink_hil_controls_t hil;
+            mavlink_msg_hil_controls_decode(&message, &hil);
+            _recordControlLatency();
+            updateControls(hil.time_usec, hil.roll_ailerons, hil.pitch_elevator, hil.yaw_rudder, hil.throttle, hil.mode, hil.nav_mode);
+            break;
+        }
+        case MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS:
+        {
+            mavlink_hil_actuator_controls_t hil;
+            mavlink_msg_hil_actuator_controls_decode(&message, &hil);
+            _recordControlLatency();
+            updateActuatorControls(hil.time_usec, hil.flags,
+                                   hil.controls[0],
+                                   hil.controls[1],
+                                   hil.controls[2],
+                                   hil.controls[3],
+                                   hil.controls[4],
+                                   hil.controls[5],
+                                   hil.controls[6],
+                                   hil.controls[7],
+                                   hil.controls[8],
+                                   hil.controls[9],
+                                   hil.controls[10],
+                                   hil.controls[11],
+                                   hil.controls[12],
+                                   hil.controls[13],
+                                   hil.controls[14],
+                                   hil.controls[15],
+                                   hil.mode);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+/// Time from the last sensor data going out to the vehicle's controls coming back
+void QGCXPlaneLink::_recordControlLatency(void)
+{
+    if (_lastSensorSendUsecs < 0) {
+        return;
+    }
+
+    qint64 latencyUsecs = _loopUsecs() - _lastSensorSendUsecs;
+    _intervalLatencies++;
+    _intervalLatencySum += latencyUsecs;
+    _intervalLatencyMax = qMax(_intervalLatencyMax, latencyUsecs);
+}
+
 /**
  * @brief Get the number of bytes to read.
  *
@@ -955,7 +1294,7 @@ bool QGCXPlaneLink::disconnectSimulation()
 {
     if (connectState)
     {
-        _should_exit = true;
+        quit();
     } else {
         emit simulationDisconnected();
         emit simulationConnected(false);
@@ -1098,11 +1437,39 @@ bool QGCXPlaneLink::connectSimulation()
     if (connectState) {
         qDebug() << "Simulation already active";
     } else {
+        LinkInterface* vehicleLink = _vehicle->priorityLink();
+        if (!vehicleLink || _mavlinkChannel == 0) {
+            emit statusMessage(tr("No vehicle link available"));
+            return false;
+        }
+
         qDebug() << "STARTING X-PLANE LINK, CONNECTING TO" << remoteHost << ":" << remotePort;
         // XXX Hack
         storeSettings();
 
-        start(HighPriority);
+        // Everything the bridge thread needs from the vehicle is captured here, on the gui thread
+        LinkManager* linkManager = qgcApp()->toolbox()->linkManager();
+        MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+        _vehicleLink =      linkManager->sharedLinkInterfacePointerForLink(vehicleLink);
+        _vehicleId =        _vehicle->id();
+        _vehicleHilMode =   _vehicle->hilMode();
+        _systemId =         mavlinkProtocol->getSystemId();
+
+        // Pack with the same protocol version the vehicle link is using
+        mavlink_status_t* vehicleStatus = mavlink_get_channel_status(vehicleLink->mavlinkChannel());
+        mavlink_status_t* bridgeStatus = mavlink_get_channel_status(_mavlinkChannel);
+        if (vehicleStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1) {
+            bridgeStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        } else {
+            bridgeStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+
+        if (!_vehicleHilMode) {
+            _vehicle->setHilMode(true);
+        }
+
+        start(TimeCriticalPriority);
     }
 
     return true;
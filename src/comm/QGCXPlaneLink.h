@@ -25,16 +25,31 @@
 #include <QUdpSocket>
 #include <QTimer>
 #include <QProcess>
+#include <QElapsedTimer>
 #include <LinkInterface.h>
 #include "QGCConfig.h"
 #include "QGCHilLink.h"
+#include "QGCLoggingCategory.h"
 #include "Vehicle.h"
 
+#include <random>
+
+Q_DECLARE_LOGGING_CATEGORY(XPlaneLinkLog)
+
+/// X-Plane HIL bridge.
+///
+/// The bridge runs its own thread, at real-time priority where the system allows it. X-Plane DATA packets are
+/// turned into HIL messages which are encoded on the bridge thread and handed straight to the vehicle link. The
+/// vehicle's HIL_CONTROLS/HIL_ACTUATOR_CONTROLS are parsed from the vehicle link's bytes on the bridge thread as
+/// well and go back to X-Plane as a single DATA packet, so the gui thread is not part of the HIL loop.
+
 class QGCXPlaneLink : public QGCHilLink
 {
     Q_OBJECT
     //Q_INTERFACES(QGCXPlaneLinkInterface:LinkInterface)
 
+    friend class XPlaneLinkTest;
+
 public:
     QGCXPlaneLink(Vehicle* vehicle, QString remoteHost=QString("127.0.0.1:49000"), QHostAddress localHost = QHostAddress::Any, quint16 localPort = 49005);
     ~QGCXPlaneLink();
@@ -96,10 +111,42 @@ public:
         return _useHilActuatorControls;
     }
 
+    /// Timing of the HIL loop, all times in usecs
+    struct HilStatistics_t {
+        HilStatistics_t(void)
+            : frames                (0)
+            , sensorMessages        (0)
+            , controlPackets        (0)
+            , framePeriodUsecs      (0)
+            , frameJitterUsecs      (0)
+            , loopUsecs             (0)
+            , loopMaxUsecs          (0)
+            , controlLatencyUsecs   (0)
+            , controlLatencyMaxUsecs(0)
+        { }
+
+        quint64 frames;                 ///< DATA packets received from X-Plane
+        quint64 sensorMessages;         ///< HIL_SENSOR/HIL_STATE_QUATERNION messages sent to the vehicle
+        quint64 controlPackets;         ///< Control DATA packets sent to X-Plane
+        double  framePeriodUsecs;       ///< Mean time between DATA packets
+        double  frameJitterUsecs;       ///< Standard deviation of the time between DATA packets
+        double  loopUsecs;              ///< Mean time from a DATA packet coming in to its HIL messages being queued on the vehicle link
+        qint64  loopMaxUsecs;
+        double  controlLatencyUsecs;    ///< Mean time from sending sensor data to the vehicle to its actuator controls coming back
+        qint64  controlLatencyMaxUsecs;
+    };
+
+    /// Thread safe
+    /// @return Counters since the simulation was connected, timing from the last statistics interval which had frames
+    HilStatistics_t statistics(void);
+
 signals:
     /** @brief Sensor leve HIL state changed */
     void useHilActuatorControlsChanged(bool enabled);
 
+    /// Asks the gui thread to put the vehicle into HIL mode
+    void _requestVehicleHilMode(bool hilMode);
+
 public slots:
 //    void setAddress(QString address);
     void setPort(int port);
@@ -152,6 +199,11 @@ private slots:
      **/
     void _writeBytes(const QByteArray data);
 
+    /// Parses the vehicle's messages on the bridge thread, looking for its controls
+    void _vehicleBytesReceived(LinkInterface* link, QByteArray bytes);
+
+    void _publishStatistics(void);
+
 public slots:
     bool connectSimulation();
     bool disconnectSimulation();
@@ -222,17 +274,69 @@ protected:
     enum AIRFRAME airframeID;
     bool xPlaneConnected;
     unsigned int xPlaneVersion;
-    quint64 simUpdateLast;
     quint64 simUpdateFirst;
-    quint64 simUpdateLastText;
     quint64 simUpdateLastGroundTruth;
-    float simUpdateHz;
     bool _sensorHilEnabled;
     bool _useHilActuatorControls;
-    bool _should_exit;
 
     void setName(QString name);
     void sendDataRef(QString ref, float value);
+
+private:
+    /// One segment of an X-Plane DATA packet
+    struct DataSegment_t {
+        qint32  index;
+        float   values[8];
+    };
+
+    void _processDatagram       (const char* data, qint64 length, qint64 receivedUsecs);
+    void _sendDataSegments      (const DataSegment_t* segments, int count);
+    void _sendHilSensor         (quint32 fieldsChanged);
+    void _sendHilGps            (void);
+    void _sendHilState          (void);
+    void _sendToVehicle         (const mavlink_message_t& message);
+    void _setRealtimePriority   (void);
+    void _recordControlLatency  (void);
+    float _addNoise             (float value, float variance);
+
+    /// @return Usecs on the loop clock
+    qint64 _loopUsecs(void) const { return _loopClock.nsecsElapsed() / 1000; }
+
+    SharedLinkInterfacePointer  _vehicleLink;           ///< Link the HIL messages go out on, captured on connect
+    int                         _vehicleId;
+    MAV_TYPE                    _vehicleType;           ///< Taken from the vehicle on construction, only read by the bridge thread
+    bool                        _vehicleHilMode;        ///< Tracked from the vehicle's heartbeats on the bridge thread
+    int                         _mavlinkChannel;        ///< Packs the HIL messages and parses the vehicle's messages on the bridge thread, 0 for none
+    uint8_t                     _systemId;
+    uint8_t                     _componentId;           ///< Own component id, the bridge channel's sequence numbers are not those of QGC's traffic
+    QByteArray                  _datagramBuffer;
+    std::mt19937                _noiseGenerator;
+
+    // Bridge thread only
+    QElapsedTimer   _loopClock;
+    QTimer*         _statisticsTimer;
+    qint64          _lastSendUsecs;
+    qint64          _lastGpsSendUsecs;
+    qint64          _lastSensorSendUsecs;       ///< -1 until sensor data has been sent
+    qint64          _lastHilModeRequestUsecs;
+    qint64          _lastFrameUsecs;            ///< -1 until the first DATA packet
+    quint64         _intervalFrames;
+    quint64         _intervalPeriods;
+    double          _intervalPeriodSum;
+    double          _intervalPeriodSquareSum;
+    quint64         _intervalLoops;
+    double          _intervalLoopSum;
+    qint64          _intervalLoopMax;
+    quint64         _intervalLatencies;
+    double          _intervalLatencySum;
+    qint64          _intervalLatencyMax;
+
+    HilStatistics_t _statistics;                ///< Protected by statisticsMutex
+
+    static const int _cMinSendIntervalUsecs =   2000;       ///< HIL messages go out at most this often
+    static const int _cGpsSendIntervalUsecs =   100000;     ///< 10 Hz GPS
+    static const int _cStatisticsMSecs =        1000;
+    static const int _cMaxDatagramBytes =       65536;
 };
 
 #endif // QGCXPLANESIMULATIONLINK_H
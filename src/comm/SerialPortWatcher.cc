@@ -0,0 +1,298 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SerialPortWatcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSocketNotifier>
+
+#if defined(Q_OS_LINUX) && !defined(__android__)
+#define SERIAL_PORT_WATCHER_INOTIFY
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+QGC_LOGGING_CATEGORY(SerialPortWatcherLog, "SerialPortWatcherLog")
+
+SerialPortWatcher::SerialPortWatcher(QObject* parent)
+    : QObject       (parent)
+    , _worker       (NULL)
+    , _workerThread (NULL)
+    , _suspended    (false)
+{
+    qRegisterMetaType<SerialPortWatcher::PortInfo_t>("SerialPortWatcher::PortInfo_t");
+}
+
+SerialPortWatcher::~SerialPortWatcher()
+{
+    if (_workerThread) {
+        // The worker is deleted on its own thread once the thread finishes
+        _workerThread->quit();
+        _workerThread->wait();
+    }
+}
+
+void SerialPortWatcher::start(const QString& devicePath, bool forcePolling)
+{
+    if (_workerThread) {
+        qWarning() << "SerialPortWatcher::start called twice";
+        return;
+    }
+
+    _worker = new SerialPortWatcherWorker();
+    _workerThread = new QThread(this);
+    _workerThread->setObjectName(QStringLiteral("SerialPortWatcher"));
+    _worker->moveToThread(_workerThread);
+
+    connect(_workerThread,  &QThread::finished,                             _worker,    &QObject::deleteLater);
+    connect(this,           &SerialPortWatcher::_initThreadWorker,          _worker,    &SerialPortWatcherWorker::init);
+    connect(this,           &SerialPortWatcher::_setSuspendedOnThread,      _worker,    &SerialPortWatcherWorker::setSuspended);
+    connect(_worker,        &SerialPortWatcherWorker::portAdded,            this,       &SerialPortWatcher::_portAdded);
+    connect(_worker,        &SerialPortWatcherWorker::portRemoved,          this,       &SerialPortWatcher::_portRemoved);
+
+    _workerThread->start();
+
+    emit _initThreadWorker(devicePath, forcePolling);
+    if (_suspended) {
+        emit _setSuspendedOnThread(true);
+    }
+}
+
+void SerialPortWatcher::setSuspended(bool suspended)
+{
+    if (suspended != _suspended) {
+        _suspended = suspended;
+        if (_workerThread) {
+            emit _setSuspendedOnThread(suspended);
+        }
+    }
+}
+
+void SerialPortWatcher::_portAdded(const SerialPortWatcher::PortInfo_t& port)
+{
+    qCDebug(SerialPortWatcherLog) << "Port added" << port.systemLocation << port.boardName << "bootloader:" << port.bootloader;
+    _ports[port.systemLocation] = port;
+    emit portAdded(port);
+}
+
+void SerialPortWatcher::_portRemoved(const QString& systemLocation)
+{
+    qCDebug(SerialPortWatcherLog) << "Port removed" << systemLocation;
+    _ports.remove(systemLocation);
+    emit portRemoved(systemLocation);
+}
+
+SerialPortWatcherWorker::SerialPortWatcherWorker(void)
+    : _suspended        (false)
+    , _notifyFd         (-1)
+    , _notifier         (NULL)
+    , _pollTimer        (NULL)
+    , _settleTimer      (NULL)
+    , _followUpTimer    (NULL)
+{
+
+}
+
+SerialPortWatcherWorker::~SerialPortWatcherWorker()
+{
+#ifdef SERIAL_PORT_WATCHER_INOTIFY
+    if (_notifyFd != -1) {
+        delete _notifier;
+        close(_notifyFd);
+    }
+#endif
+}
+
+/// Creates the timers and the device notifier, which must happen on the worker thread, and does the first scan.
+void SerialPortWatcherWorker::init(const QString& devicePath, bool forcePolling)
+{
+    _devicePath = devicePath;
+
+    _settleTimer = new QTimer(this);
+    _settleTimer->setSingleShot(true);
+    _settleTimer->setInterval(SerialPortWatcher::settleMSecs);
+    connect(_settleTimer, &QTimer::timeout, this, &SerialPortWatcherWorker::_scan);
+
+    _followUpTimer = new QTimer(this);
+    _followUpTimer->setSingleShot(true);
+    _followUpTimer->setInterval(SerialPortWatcher::followUpScanMSecs);
+    connect(_followUpTimer, &QTimer::timeout, this, &SerialPortWatcherWorker::_scan);
+
+    if (forcePolling || !_startDeviceNotifications()) {
+        qCDebug(SerialPortWatcherLog) << "Polling for port changes";
+        _pollTimer = new QTimer(this);
+        _pollTimer->setInterval(SerialPortWatcher::pollIntervalMSecs);
+        connect(_pollTimer, &QTimer::timeout, this, &SerialPortWatcherWorker::_scan);
+        if (!_suspended) {
+            _pollTimer->start();
+        }
+    }
+
+    _scan();
+}
+
+bool SerialPortWatcherWorker::_startDeviceNotifications(void)
+{
+#ifdef SERIAL_PORT_WATCHER_INOTIFY
+    QString watchPath = _devicePath.isEmpty() ? QStringLiteral("/dev") : _devicePath;
+
+    _notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_notifyFd == -1) {
+        qCWarning(SerialPortWatcherLog) << "inotify_init1 failed" << errno;
+        return false;
+    }
+
+    // IN_ATTRIB comes in when udev is done setting up the device node, which is when the port becomes usable
+    if (inotify_add_watch(_notifyFd, QFile::encodeName(watchPath).constData(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB) == -1) {
+        qCWarning(SerialPortWatcherLog) << "inotify_add_watch failed" << watchPath << errno;
+        close(_notifyFd);
+        _notifyFd = -1;
+        return false;
+    }
+
+    _notifier = new QSocketNotifier(_notifyFd, QSocketNotifier::Read, this);
+    connect(_notifier, &QSocketNotifier::activated, this, &SerialPortWatcherWorker::_deviceEvent);
+
+    qCDebug(SerialPortWatcherLog) << "Watching for device changes" << watchPath;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SerialPortWatcherWorker::_deviceEvent(void)
+{
+#ifdef SERIAL_PORT_WATCHER_INOTIFY
+    bool portEvent = false;
+
+    // Drain all pending events, they are only used to decide whether a rescan is needed
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t cBytes;
+    while ((cBytes = read(_notifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char* next = buffer; next < buffer + cBytes; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(next);
+            if (event->len) {
+                QByteArray name(event->name);
+                if (name.startsWith("tty") || name.startsWith("rfcomm")) {
+                    portEvent = true;
+                }
+            }
+            next += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    if (portEvent && !_suspended) {
+        _settleTimer->start();
+        _followUpTimer->start();
+    }
+#endif
+}
+
+void SerialPortWatcherWorker::setSuspended(bool suspended)
+{
+    _suspended = suspended;
+
+    if (!_settleTimer) {
+        // Not initialized yet, init picks up the suspended state
+        return;
+    }
+
+    if (_suspended) {
+        _settleTimer->stop();
+        _followUpTimer->stop();
+        if (_pollTimer) {
+            _pollTimer->stop();
+        }
+    } else {
+        if (_pollTimer) {
+            _pollTimer->start();
+        }
+        _scan();
+    }
+}
+
+void SerialPortWatcherWorker::_scan(void)
+{
+    if (_suspended) {
+        return;
+    }
+
+    _updatePorts(_scanPorts());
+}
+
+void SerialPortWatcherWorker::_updatePorts(const QList<SerialPortWatcher::PortInfo_t>& scannedPorts)
+{
+    QMap<QString, SerialPortWatcher::PortInfo_t> currentPorts;
+    foreach (const SerialPortWatcher::PortInfo_t& port, scannedPorts) {
+        currentPorts[port.systemLocation] = port;
+    }
+
+    // Removals go out first so that a changed port is seen as removed and then added again
+    foreach (const QString& systemLocation, _ports.keys()) {
+        if (!currentPorts.contains(systemLocation) || !_samePort(currentPorts[systemLocation], _ports[systemLocation])) {
+            _ports.remove(systemLocation);
+            emit portRemoved(systemLocation);
+        }
+    }
+
+    foreach (const SerialPortWatcher::PortInfo_t& port, currentPorts) {
+        if (!_ports.contains(port.systemLocation)) {
+            _ports[port.systemLocation] = port;
+            emit portAdded(port);
+        }
+    }
+}
+
+QList<SerialPortWatcher::PortInfo_t> SerialPortWatcherWorker::_scanPorts(void)
+{
+    QList<SerialPortWatcher::PortInfo_t> ports;
+
+    if (!_devicePath.isEmpty()) {
+        // Plain tty devices with no board info behind them
+        QDir dir(_devicePath);
+        foreach (const QFileInfo& fileInfo, dir.entryInfoList(QStringList(QStringLiteral("tty*")), QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot)) {
+            SerialPortWatcher::PortInfo_t port;
+            port.systemLocation =   fileInfo.absoluteFilePath();
+            port.portName =         fileInfo.fileName();
+            ports.append(port);
+        }
+        return ports;
+    }
+
+    foreach (QSerialPortInfo serialPortInfo, QSerialPortInfo::availablePorts()) {
+        const QGCSerialPortInfo& portInfo = *((QGCSerialPortInfo*)&serialPortInfo);
+
+        SerialPortWatcher::PortInfo_t port;
+        port.portInfo =         portInfo;
+        port.systemLocation =   portInfo.systemLocation();
+        port.portName =         portInfo.portName();
+        port.systemPort =       QGCSerialPortInfo::isSystemPort(&serialPortInfo);
+        if (!port.systemPort) {
+            port.knownBoard =   portInfo.getBoardInfo(port.boardType, port.boardName);
+            port.bootloader =   port.knownBoard && portInfo.isBootloader();
+        }
+        ports.append(port);
+    }
+
+    return ports;
+}
+
+bool SerialPortWatcherWorker::_samePort(const SerialPortWatcher::PortInfo_t& port1, const SerialPortWatcher::PortInfo_t& port2)
+{
+    return port1.systemPort == port2.systemPort &&
+            port1.knownBoard == port2.knownBoard &&
+            port1.boardType == port2.boardType &&
+            port1.bootloader == port2.bootloader &&
+            port1.portInfo.vendorIdentifier() == port2.portInfo.vendorIdentifier() &&
+            port1.portInfo.productIdentifier() == port2.portInfo.productIdentifier() &&
+            port1.portInfo.serialNumber() == port2.portInfo.serialNumber() &&
+            port1.portInfo.description() == port2.portInfo.description();
+}
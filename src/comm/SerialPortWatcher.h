@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCSerialPortInfo.h"
+#include "QGCLoggingCategory.h"
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QMap>
+
+class QSocketNotifier;
+class SerialPortWatcherWorker;
+
+Q_DECLARE_LOGGING_CATEGORY(SerialPortWatcherLog)
+
+/// Keeps track of the serial ports on the system without enumerating them on the gui thread.
+///
+/// Enumeration and board identification run on a separate thread. On Linux the worker watches the device directory
+/// with inotify and rescans shortly after a tty device shows up, goes away or has its attributes changed by udev.
+/// Everywhere else, or if inotify is not available, it falls back to polling. The gui thread only sees portAdded and
+/// portRemoved as the cached port table changes. A port whose board info changes, for example a board leaving its
+/// bootloader, is reported as removed and then added again. Operating system ports (QGCSerialPortInfo::isSystemPort)
+/// are in the table too, flagged with systemPort, so they can still be picked for manual connections.
+class SerialPortWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    SerialPortWatcher(QObject* parent = NULL);
+    ~SerialPortWatcher();
+
+    struct PortInfo_t {
+        PortInfo_t(void) : boardType(QGCSerialPortInfo::BoardTypeUnknown), knownBoard(false), bootloader(false), systemPort(false) { }
+
+        QGCSerialPortInfo               portInfo;
+        QString                         systemLocation;
+        QString                         portName;
+        QGCSerialPortInfo::BoardType_t  boardType;
+        QString                         boardName;
+        bool                            knownBoard;     ///< true: getBoardInfo recognized the board
+        bool                            bootloader;     ///< true: board is currently in its bootloader
+        bool                            systemPort;     ///< true: operating system port, never autoconnected
+    };
+
+    /// Starts watching
+    ///     @param devicePath Directory to watch for tty devices instead of the system ports, used by unit tests
+    ///     @param forcePolling true: poll even if hotplug notifications are available
+    void start(const QString& devicePath = QString(), bool forcePolling = false);
+
+    /// Stops looking for port changes while suspended, the port table is left as is
+    void setSuspended(bool suspended);
+
+    /// @return Current port table, key is the system location
+    const QMap<QString, PortInfo_t>& ports(void) const { return _ports; }
+
+    bool contains(const QString& systemLocation) const { return _ports.contains(systemLocation); }
+
+    static const int pollIntervalMSecs =        1000;   ///< Rescan interval when polling
+    static const int settleMSecs =              100;    ///< Delay from a device event to the rescan, collects bursts of events
+    static const int followUpScanMSecs =        1000;   ///< Second rescan after a device event, catches slow udev rules
+
+signals:
+    void portAdded(const SerialPortWatcher::PortInfo_t& port);
+    void portRemoved(const QString& systemLocation);
+
+    // Internal signals to communicate with thread worker
+    void _initThreadWorker(const QString& devicePath, bool forcePolling);
+    void _setSuspendedOnThread(bool suspended);
+
+private slots:
+    void _portAdded(const SerialPortWatcher::PortInfo_t& port);
+    void _portRemoved(const QString& systemLocation);
+
+private:
+    SerialPortWatcherWorker*    _worker;
+    QThread*                    _workerThread;      ///< Thread which SerialPortWatcherWorker runs on
+    bool                        _suspended;
+    QMap<QString, PortInfo_t>   _ports;
+};
+
+Q_DECLARE_METATYPE(SerialPortWatcher::PortInfo_t)
+
+/// Does the enumeration and device watching for SerialPortWatcher, lives on the watcher thread
+class SerialPortWatcherWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    SerialPortWatcherWorker(void);
+    ~SerialPortWatcherWorker();
+
+signals:
+    void portAdded(const SerialPortWatcher::PortInfo_t& port);
+    void portRemoved(const QString& systemLocation);
+
+public slots:
+    void init(const QString& devicePath, bool forcePolling);
+    void setSuspended(bool suspended);
+
+private slots:
+    void _scan(void);
+    void _deviceEvent(void);
+
+private:
+    bool _startDeviceNotifications(void);
+    QList<SerialPortWatcher::PortInfo_t> _scanPorts(void);
+
+    /// Compares a fresh scan with the port table and signals the differences
+    void _updatePorts(const QList<SerialPortWatcher::PortInfo_t>& scannedPorts);
+
+    /// @return true: both entries describe the same board state
+    static bool _samePort(const SerialPortWatcher::PortInfo_t& port1, const SerialPortWatcher::PortInfo_t& port2);
+
+    QString                                         _devicePath;
+    bool                                            _suspended;
+    int                                             _notifyFd;
+    QSocketNotifier*                                _notifier;
+    QTimer*                                         _pollTimer;
+    QTimer*                                         _settleTimer;
+    QTimer*                                         _followUpTimer;
+    QMap<QString, SerialPortWatcher::PortInfo_t>    _ports;
+
+    friend class SerialPortWatcherTest;
+};
@@ -31,7 +31,11 @@
 #include "SettingsManager.h"
 #include "AutoConnectSettings.h"
 
-#define REMOVE_GONE_HOSTS 0
+#ifdef UDPLINK_MMSG
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+#endif
 
 static const char* kZeroconfRegistration = "_qgroundcontrol._udp";
 
@@ -87,6 +91,10 @@ UDPLink::UDPLink(SharedLinkConfigurationPointer& config)
     , _socket(NULL)
     , _udpConfig(qobject_cast<UDPConfiguration*>(config.data()))
     , _connectState(false)
+    , _sessionExpiryTimer(NULL)
+    , _sessionTimeoutMSecs(_cSessionTimeoutMSecs)
+    , _receivePool(_cReceivePoolSize)
+    , _receiveBuffer(NULL)
 {
     if (!_udpConfig) {
         qWarning() << "Internal error";
@@ -103,8 +111,7 @@ UDPLink::~UDPLink()
     // Tell the thread to exit
     _running = false;
     // Clear client list
-    qDeleteAll(_sessionTargets);
-    _sessionTargets.clear();
+    _clearSessions();
     quit();
     // Wait for it to exit
     wait();
@@ -170,17 +177,116 @@ void UDPLink::_writeBytes(const QByteArray data)
     if (!_socket) {
         return;
     }
-    // Send to all manually targeted systems
+    foreach(const UDPCLient* target, _sendTargets()) {
+        _writeDataGram(data, target);
+    }
+}
+
+/// Sends each message from the send queue to every target as a datagram of its own. On Linux all of it goes out with
+/// a single sendmmsg call, each datagram pointing straight at the message buffer.
+void UDPLink::_writeMessages(const QList<QByteArray>& messages)
+{
+    if (!_socket) {
+        return;
+    }
+
+    QList<const UDPCLient*> targets = _sendTargets();
+    QList<const UDPCLient*> datagramTargets;    // Written through the socket one datagram at a time
+
+#ifdef UDPLINK_MMSG
+    QVarLengthArray<struct iovec, 64>       iovecs(messages.count());
+    QVarLengthArray<struct sockaddr_in, 16> addresses;
+    QVarLengthArray<struct mmsghdr, 64>     headers;
+
+    for (int i=0; i<messages.count(); i++) {
+        iovecs[i].iov_base =    const_cast<char*>(messages[i].constData());
+        iovecs[i].iov_len =     messages[i].size();
+    }
+
+    foreach (const UDPCLient* target, targets) {
+        if (target->address.protocol() != QAbstractSocket::IPv4Protocol) {
+            datagramTargets.append(target);
+            continue;
+        }
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family =        AF_INET;
+        address.sin_addr.s_addr =   htonl(target->address.toIPv4Address());
+        address.sin_port =          htons(target->port);
+        addresses.append(address);
+    }
+
+    // The address array is complete at this point so the headers can point into it
+    for (int i=0; i<addresses.count(); i++) {
+        for (int j=0; j<messages.count(); j++) {
+            struct mmsghdr header;
+            memset(&header, 0, sizeof(header));
+            header.msg_hdr.msg_name =       &addresses[i];
+            header.msg_hdr.msg_namelen =    sizeof(struct sockaddr_in);
+            header.msg_hdr.msg_iov =        &iovecs[j];
+            header.msg_hdr.msg_iovlen =     1;
+            headers.append(header);
+        }
+    }
+
+    int fd = static_cast<int>(_socket->socketDescriptor());
+    quint64 sentBytes = 0;
+    int sent = 0;
+    int dropped = 0;
+    int sendErrno = 0;
+    while (sent < headers.count()) {
+        int count = sendmmsg(fd, headers.data() + sent, headers.count() - sent, MSG_DONTWAIT);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            sendErrno = errno;
+            if (sendErrno == EAGAIN || sendErrno == EWOULDBLOCK) {
+                // Socket buffer is full, retrying right away would only spin. Drop the rest of the batch, same as
+                // writeDatagram does, the protocols above retry what they need.
+                dropped += headers.count() - sent;
+                break;
+            }
+            // Error for this datagram's target only (unreachable host and such), the others still go out
+            dropped++;
+            sent++;
+            continue;
+        }
+        for (int i=sent; i<sent + count; i++) {
+            sentBytes += headers[i].msg_len;
+        }
+        sent += count;
+    }
+    if (sentBytes) {
+        _logOutputDataRate(sentBytes, QDateTime::currentMSecsSinceEpoch());
+    }
+    if (dropped) {
+        qWarning() << "UDP write dropped" << dropped << "of" << headers.count() << "datagrams:" << strerror(sendErrno);
+    }
+#else
+    datagramTargets = targets;
+#endif
+
+    foreach (const QByteArray& message, messages) {
+        foreach (const UDPCLient* target, datagramTargets) {
+            _writeDataGram(message, target);
+        }
+    }
+}
+
+/// @return Manually targeted systems which are not already covered by a session, followed by all sessions
+QList<const UDPCLient*> UDPLink::_sendTargets(void) const
+{
+    QList<const UDPCLient*> targets;
     foreach(UDPCLient* target, _udpConfig->targetHosts()) {
-        // Skip it if it's part of the session clients below
-        if(!contains_target(_sessionTargets, target->address, target->port)) {
-            _writeDataGram(data, target);
+        if(!_sessionEndpoints.contains(_endpointKey(target->address.toIPv4Address(), target->port))) {
+            targets.append(target);
         }
     }
-    // Send to all connected systems
-    foreach(UDPCLient* target, _sessionTargets) {
-        _writeDataGram(data, target);
+    foreach(const Session_t* session, _sessions) {
+        targets.append(&session->client);
     }
+    return targets;
 }
 
 void UDPLink::_writeDataGram(const QByteArray data, const UDPCLient* target)
@@ -205,42 +311,210 @@ void UDPLink::readBytes()
     if (!_socket) {
         return;
     }
-    QByteArray databuffer;
-    while (_socket->hasPendingDatagrams())
-    {
-        QByteArray datagram;
-        datagram.resize(_socket->pendingDatagramSize());
-        QHostAddress sender;
-        quint16 senderPort;
-        //-- Note: This call is broken in Qt 5.9.3 on Windows. It always returns a blank sender and 0 for the port.
-        _socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
-        databuffer.append(datagram);
-        //-- Wait a bit before sending it over
-        if(databuffer.size() > 10 * 1024) {
-            emit bytesReceived(this, databuffer);
-            databuffer.clear();
+
+    // One timestamp for everything which came in together
+    qint64 now = _sessionClock.elapsed();
+
+    // The first datagram always goes through the socket since reading from it is what re-arms its read notification
+    if (_socket->hasPendingDatagrams()) {
+        _readSocketDatagram(now);
+    }
+#ifdef UDPLINK_MMSG
+    _readDatagramBatches(now);
+#else
+    while (_socket->hasPendingDatagrams()) {
+        _readSocketDatagram(now);
+    }
+#endif
+
+    //-- Send whatever is left
+    _flushReceived();
+}
+
+void UDPLink::_readSocketDatagram(qint64 now)
+{
+    QHostAddress sender;
+    quint16 senderPort = 0;
+
+    qint64 datagramSize = _socket->pendingDatagramSize();
+    if (datagramSize > _cMaxDatagramBytes) {
+        qWarning() << "UDP: Dropping oversized datagram" << datagramSize;
+        _socket->readDatagram(NULL, 0);
+        return;
+    }
+
+    if (_datagramBuffer.isEmpty()) {
+        _datagramBuffer.resize(_cBatchDatagrams * _cMaxDatagramBytes);
+    }
+    //-- Note: This call is broken in Qt 5.9.3 on Windows. It always returns a blank sender and 0 for the port.
+    qint64 length = _socket->readDatagram(_datagramBuffer.data(), _cMaxDatagramBytes, &sender, &senderPort);
+    if (length >= 0) {
+        _receiveDatagram(_datagramBuffer.constData(), static_cast<int>(length), sender.toIPv4Address(), senderPort, now);
+    }
+}
+
+#ifdef UDPLINK_MMSG
+/// Drains the socket with recvmmsg, a batch of datagrams per system call straight into the datagram buffer
+void UDPLink::_readDatagramBatches(qint64 now)
+{
+    if (_datagramBuffer.isEmpty()) {
+        _datagramBuffer.resize(_cBatchDatagrams * _cMaxDatagramBytes);
+    }
+
+    int fd = static_cast<int>(_socket->socketDescriptor());
+    forever {
+        for (int i=0; i<_cBatchDatagrams; i++) {
+            _batchIovecs[i].iov_base =              _datagramBuffer.data() + (i * _cMaxDatagramBytes);
+            _batchIovecs[i].iov_len =               _cMaxDatagramBytes;
+            _batchHeaders[i].msg_hdr.msg_name =     &_batchAddresses[i];
+            _batchHeaders[i].msg_hdr.msg_namelen =  sizeof(_batchAddresses[i]);
+            _batchHeaders[i].msg_hdr.msg_iov =      &_batchIovecs[i];
+            _batchHeaders[i].msg_hdr.msg_iovlen =   1;
+            _batchHeaders[i].msg_hdr.msg_control =  NULL;
+            _batchHeaders[i].msg_hdr.msg_controllen = 0;
+            _batchHeaders[i].msg_hdr.msg_flags =    0;
         }
-        _logInputDataRate(datagram.length(), QDateTime::currentMSecsSinceEpoch());
-        // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
+
+        int count = recvmmsg(fd, _batchHeaders, _cBatchDatagrams, MSG_DONTWAIT, NULL);
+        if (count <= 0) {
+            if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                qWarning() << "UDP: recvmmsg failed" << errno;
+            }
+            return;
         }
-        if(!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
+
+        for (int i=0; i<count; i++) {
+            const struct msghdr& header = _batchHeaders[i].msg_hdr;
+            if (header.msg_flags & MSG_TRUNC) {
+                // Handing on part of a datagram would only throw the parser off
+                qWarning() << "UDP: Dropping oversized datagram";
+                continue;
+            }
+            quint32 senderAddress = 0;
+            quint16 senderPort = 0;
+            if (_batchAddresses[i].sin_family == AF_INET) {
+                senderAddress = ntohl(_batchAddresses[i].sin_addr.s_addr);
+                senderPort = ntohs(_batchAddresses[i].sin_port);
+            }
+            _receiveDatagram(static_cast<const char*>(_batchIovecs[i].iov_base), static_cast<int>(_batchHeaders[i].msg_len), senderAddress, senderPort, now);
+        }
+
+        if (count < _cBatchDatagrams) {
+            // Socket is drained
+            return;
         }
     }
-    //-- Send whatever is left
-    if(databuffer.size()) {
-        emit bytesReceived(this, databuffer);
+}
+#else
+void UDPLink::_readDatagramBatches(qint64 now)
+{
+    Q_UNUSED(now);
+}
+#endif
+
+/// Hands a datagram on to the parser and keeps the sender's session alive. Datagrams are never split across
+/// bytesReceived signals, each signal holds whole datagrams in the order they came in.
+void UDPLink::_receiveDatagram(const char* data, int length, quint32 senderAddress, quint16 senderPort, qint64 now)
+{
+    // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    Session_t* session = _sessionEndpoints.value(_endpointKey(senderAddress, senderPort));
+    if (!session) {
+        session = _addSession(senderAddress, senderPort);
+    }
+    session->lastSeenMSecs = now;
+
+    if (!_receiveBuffer) {
+        // Look for a pool buffer which no queued bytesReceived holds on to anymore
+        for (int i=0; i<_receivePool.count(); i++) {
+            QByteArray& buffer = _receivePool[i];
+            if (buffer.isNull()) {
+                buffer.reserve(_cEmitBytes + _cMaxDatagramBytes);
+            }
+            if (buffer.isDetached()) {
+                buffer.resize(0);
+                _receiveBuffer = &buffer;
+                break;
+            }
+        }
+        if (!_receiveBuffer) {
+            _receiveOverflow = QByteArray();
+            _receiveOverflow.reserve(_cEmitBytes + _cMaxDatagramBytes);
+            _receiveBuffer = &_receiveOverflow;
+        }
+    }
+
+    _receiveBuffer->append(data, length);
+    //-- Wait a bit before sending it over
+    if (_receiveBuffer->size() > _cEmitBytes) {
+        _flushReceived();
+    }
+}
+
+void UDPLink::_flushReceived()
+{
+    if (_receiveBuffer) {
+        if (_receiveBuffer->size()) {
+            _logInputDataRate(_receiveBuffer->size(), QDateTime::currentMSecsSinceEpoch());
+            emit bytesReceived(this, *_receiveBuffer);
+        }
+        _receiveBuffer = NULL;
+    }
+}
+
+UDPLink::Session_t* UDPLink::_addSession(quint32 senderAddress, quint16 senderPort)
+{
+    // Add host to broadcast list if not yet present, or update its port
+    QHostAddress address(senderAddress);
+    if(_isIpLocal(address)) {
+        address = QHostAddress(QString("127.0.0.1"));
+    }
+
+    quint64 targetKey = _endpointKey(address.toIPv4Address(), senderPort);
+    Session_t* session = _sessionEndpoints.value(targetKey);
+    if (!session) {
+        qDebug() << "Adding target" << address << senderPort;
+        session = new Session_t(address, senderPort);
+        session->endpointKeys.append(targetKey);
+        _sessionEndpoints[targetKey] = session;
+        _sessions.append(session);
+    }
+
+    // A local sender can show up under its interface address as well as loopback, both lead to the same session
+    quint64 senderKey = _endpointKey(senderAddress, senderPort);
+    if (senderKey != targetKey) {
+        session->endpointKeys.append(senderKey);
+        _sessionEndpoints[senderKey] = session;
+    }
+
+    return session;
+}
+
+void UDPLink::_expireSessions()
+{
+    qint64 now = _sessionClock.elapsed();
+
+    for (int i=_sessions.count()-1; i>=0; i--) {
+        Session_t* session = _sessions[i];
+        if (now - session->lastSeenMSecs > _sessionTimeoutMSecs) {
+            qDebug() << "Removing target" << session->client.address << session->client.port;
+            foreach (quint64 key, session->endpointKeys) {
+                _sessionEndpoints.remove(key);
+            }
+            _sessions.removeAt(i);
+            delete session;
+        }
     }
 }
 
+void UDPLink::_clearSessions()
+{
+    qDeleteAll(_sessions);
+    _sessions.clear();
+    _sessionEndpoints.clear();
+}
+
 /**
  * @brief Disconnect the connection.
  *
@@ -300,6 +574,17 @@ bool UDPLink::_hardwareConnect()
 #endif
         _registerZeroconf(_udpConfig->localPort(), kZeroconfRegistration);
         QObject::connect(_socket, &QUdpSocket::readyRead, this, &UDPLink::readBytes);
+
+        // Created here so the timer lives on the link thread along with the socket. Sessions are kept across
+        // reconnects so the clock keeps running as well.
+        if (!_sessionClock.isValid()) {
+            _sessionClock.start();
+        }
+        if (!_sessionExpiryTimer) {
+            _sessionExpiryTimer = new QTimer(this);
+            QObject::connect(_sessionExpiryTimer, &QTimer::timeout, this, &UDPLink::_expireSessions);
+        }
+        _sessionExpiryTimer->start(_cSessionExpiryMSecs);
         emit connected();
     } else {
         emit communicationError(tr("UDP Link Error"), tr("Error binding UDP port: %1").arg(_socket->errorString()));
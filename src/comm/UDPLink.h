@@ -26,6 +26,11 @@
 #include <QMutexLocker>
 #include <QQueue>
 #include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVarLengthArray>
 
 #if defined(QGC_ZEROCONF_ENABLED)
 #include <dns_sd.h>
@@ -34,6 +39,12 @@
 #include "QGCConfig.h"
 #include "LinkManager.h"
 
+#if defined(Q_OS_LINUX) && !defined(__android__)
+#define UDPLINK_MMSG
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
 class UDPCLient {
 public:
     UDPCLient(const QHostAddress& address_, quint16 port_)
@@ -150,6 +161,7 @@ class UDPLink : public LinkInterface
 
     friend class UDPConfiguration;
     friend class LinkManager;
+    friend class UDPLinkTest;
 
 public:
     void    requestReset            () override { }
@@ -183,6 +195,17 @@ private:
     // From LinkInterface
     bool    _connect                (void) override;
     void    _disconnect             (void) override;
+    void    _writeMessages          (const QList<QByteArray>& messages) override;
+
+    /// A peer we have heard from. Each session is in the endpoint table under the address it is sent to and, if it
+    /// differs, under the address it was received from.
+    struct Session_t {
+        Session_t(const QHostAddress& address, quint16 port) : client(address, port), lastSeenMSecs(0) { }
+
+        UDPCLient       client;
+        qint64          lastSeenMSecs;
+        QList<quint64>  endpointKeys;
+    };
 
     bool    _isIpLocal              (const QHostAddress& add);
     bool    _hardwareConnect        ();
@@ -190,18 +213,50 @@ private:
     void    _registerZeroconf       (uint16_t port, const std::string& regType);
     void    _deregisterZeroconf     ();
     void    _writeDataGram          (const QByteArray data, const UDPCLient* target);
+    QList<const UDPCLient*> _sendTargets(void) const;
+
+    void    _readSocketDatagram     (qint64 now);
+    void    _readDatagramBatches    (qint64 now);
+    void    _receiveDatagram        (const char* data, int length, quint32 senderAddress, quint16 senderPort, qint64 now);
+    void    _flushReceived          ();
+    Session_t* _addSession          (quint32 senderAddress, quint16 senderPort);
+    void    _expireSessions         ();
+    void    _clearSessions          ();
+
+    /// @return Key for the endpoint table, the socket only binds IPv4 so the address and port fit into 48 bits
+    static quint64 _endpointKey(quint32 address, quint16 port) { return (static_cast<quint64>(address) << 16) | port; }
+
+    static const int _cBatchDatagrams =         32;         ///< Datagrams read per recvmmsg call
+    static const int _cMaxDatagramBytes =       16 * 1024;  ///< Larger datagrams are dropped
+    static const int _cEmitBytes =              10 * 1024;  ///< Received bytes are signalled once a buffer holds this much
+    static const int _cReceivePoolSize =        8;
+    static const int _cSessionTimeoutMSecs =    30000;
+    static const int _cSessionExpiryMSecs =     1000;       ///< How often timed out sessions are looked for
 
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef  _dnssServiceRef;
 #endif
 
-    bool                    _running;
-    QUdpSocket*             _socket;
-    UDPConfiguration*       _udpConfig;
-    bool                    _connectState;
-    QList<UDPCLient*>       _sessionTargets;
-    QList<QHostAddress>     _localAddress;
-
+    bool                        _running;
+    QUdpSocket*                 _socket;
+    UDPConfiguration*           _udpConfig;
+    bool                        _connectState;
+    QList<Session_t*>           _sessions;
+    QHash<quint64, Session_t*>  _sessionEndpoints;      ///< Endpoint key to session
+    QElapsedTimer               _sessionClock;
+    QTimer*                     _sessionExpiryTimer;
+    qint64                      _sessionTimeoutMSecs;   ///< Sessions not heard from for this long are dropped
+    QList<QHostAddress>         _localAddress;
+
+    QVector<QByteArray>         _receivePool;           ///< Reused for bytesReceived once the receivers have let go of them
+    QByteArray                  _receiveOverflow;       ///< Used when every pool buffer is still queued
+    QByteArray*                 _receiveBuffer;         ///< Buffer being filled, NULL for none
+    QByteArray                  _datagramBuffer;        ///< Datagrams are read into this, one slot per datagram of a batch
+#ifdef UDPLINK_MMSG
+    struct mmsghdr              _batchHeaders[_cBatchDatagrams];
+    struct iovec                _batchIovecs[_cBatchDatagrams];
+    struct sockaddr_in          _batchAddresses[_cBatchDatagrams];
+#endif
 };
 
 #endif // UDPLINK_H
@@ -5,15 +5,33 @@ INCLUDEPATH += \
 
 HEADERS += \
     src/hb/pidiscoverer.h \
+    src/hb/nodecommandqueue.h \
     src/hb/nodeselector.h \
-    src/hb/thermalimageprovider.h \
+    src/hb/thermalitem.h \
+    src/hb/thermalkernel.h \
     src/hb/mjpegimagegrabber.h
 
 SOURCES += \
     src/hb/pidiscoverer.cpp \
+    src/hb/nodecommandqueue.cpp \
     src/hb/nodeselector.cpp \
-    src/hb/thermalimageprovider.cpp \
+    src/hb/thermalitem.cpp \
+    src/hb/thermalkernel.cpp \
     src/hb/mjpegimagegrabber.cpp
+
+contains(DEFINES, UNITTEST_BUILD) {
+    HEADERS += \
+        src/hb/pidiscoverertest.h \
+        src/hb/nodecommandqueuetest.h \
+        src/hb/mjpegimagegrabbertest.h \
+        src/hb/thermalkerneltest.h
+
+    SOURCES += \
+        src/hb/pidiscoverertest.cpp \
+        src/hb/nodecommandqueuetest.cpp \
+        src/hb/mjpegimagegrabbertest.cpp \
+        src/hb/thermalkerneltest.cpp
+}
 }
 
 HEADERS += \
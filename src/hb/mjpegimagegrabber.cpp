@@ -1,12 +1,34 @@
 #include "mjpegimagegrabber.h"
 #include <QDebug>
-#include <QFile>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <string.h>
+
 const char streamSperator[] = "--jpgboundary";
 
+// a part that grows past this without a boundary is garbage, drop it
+static const int MAX_FRAME_SIZE = 8 * 1024 * 1024;
+static const int INITIAL_BUFFER_SIZE = 256 * 1024;
+// receive buffers kept around for reuse, one receiving, one decoding, one pending and spare
+static const int MAX_FREE_BUFFERS = 4;
+static const int MAX_HEADER_SIZE = 512;
+// lepton 2.x and 3.x
+static const int LEPTON_FRAME_SIZES[][2] = { { 80, 60 }, { 160, 120 } };
+
+// jpeg decoding for all grabbers, each grabber has at most one decode in flight
+Q_GLOBAL_STATIC(QThreadPool, decodePool)
+
 MJPEGImageGrabber::MJPEGImageGrabber(QNetworkAccessManager *nam, const QUrl &url, QObject *parent) :
-    QObject(parent), m_reply(0), m_nam(nam), m_imageStarted(false), m_mjpegStreamUrl(url), m_fps(0)
+    QObject(parent), m_reply(0), m_nam(nam), m_mjpegStreamUrl(url),
+    m_boundary(QByteArray(streamSperator)), m_used(0), m_partStart(-1), m_scanPos(0),
+    m_fps(0), m_currentFps(0), m_decodedCount(0), m_decodeTimeNs(0), m_decodeTimeMs(0),
+    m_droppedFrames(0), m_corruptFrames(0)
 {
     qDebug() << "creating image grabber with url : " << url;
+    m_buffer = acquireBuffer(INITIAL_BUFFER_SIZE);
+
     QNetworkRequest request(url);
     request.setRawHeader("User-Agent", "Mozilla/5.0 (Unknown; Linux i686) AppleWebKit/537.21 (KHTML, like Gecko)");
     m_reply = m_nam->get(request);
@@ -16,65 +38,259 @@ MJPEGImageGrabber::MJPEGImageGrabber(QNetworkAccessManager *nam, const QUrl &url
     connect(m_timer, SIGNAL(timeout()), SLOT(onFPSTImer()));
     m_timer->start();
 
+    connect(&m_decodeWatcher, SIGNAL(finished()), this, SLOT(onDecodeFinished()));
     connect(m_reply, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
     connect(m_reply, SIGNAL(finished()), this, SLOT(onFinished()));
     connect(m_reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(onError(QNetworkReply::NetworkError)));
 }
 
+MJPEGImageGrabber::~MJPEGImageGrabber()
+{
+    // a running decode holds its own reference to the buffer, its result is simply dropped
+    m_decodeWatcher.disconnect(this);
+}
+
 void MJPEGImageGrabber::onFPSTImer()
 {
-//    qDebug() << "FPS" << m_fps;
+    m_currentFps = m_fps;
+    m_decodeTimeMs = m_decodedCount ? m_decodeTimeNs / 1e6 / m_decodedCount : 0;
     m_fps = 0;
+    m_decodedCount = 0;
+    m_decodeTimeNs = 0;
+    Q_EMIT statsChanged();
 }
 
-
 void MJPEGImageGrabber::onReadyRead()
 {
-//    qDebug() << "got ready read";
-    m_imageData.append(m_reply->readAll());
-//    qDebug() << "number of bytes in imageData" << m_imageData.size();
+    // read straight into the receive buffer instead of going through readAll()
+    for (;;) {
+        qint64 available = m_reply->bytesAvailable();
+        if (available <= 0) {
+            break;
+        }
+        reserve(m_used + static_cast<int>(available));
+        qint64 read = m_reply->read(m_buffer.data() + m_used, available);
+        if (read <= 0) {
+            break;
+        }
+        m_used += read;
+        scanBuffer();
+    }
+}
 
-    QByteArray marker(streamSperator, strlen(streamSperator));
-//    qDebug() << "Marker " << marker;
+// Looks for boundaries in the data that has not been searched yet. The search position is kept
+// between chunks so every byte is only looked at once, however the frame is split up.
+void MJPEGImageGrabber::scanBuffer()
+{
+    const int markerLength = static_cast<int>(strlen(streamSperator));
 
-    if (!m_imageStarted) {
-        int index = m_imageData.indexOf(marker);
-        if (index < 0) { // current data doesn't have a image start
-//            qDebug() << "not started yet, leaving... looked for marker";
-            m_imageData.clear();
-            return;
+    for (;;) {
+        int index = m_boundary.indexIn(m_buffer.constData(), m_used, m_scanPos);
+        if (index < 0) {
+            break;
+        }
+        if (m_partStart >= 0) {
+            // frameComplete() moves whatever follows the boundary into a fresh buffer
+            frameComplete(m_partStart, index - m_partStart, index + markerLength);
+        } else {
+            m_partStart = index + markerLength;
+            m_scanPos = m_partStart;
         }
-        m_imageStarted = true; //started
-        m_imageData = m_imageData.mid(index+marker.length()); // discard data before the start
     }
 
-    int index = m_imageData.indexOf(marker);
+    // a boundary may be split across chunks, back off so it is found once the rest arrives
+    int resume = qMax(0, m_used - markerLength + 1);
 
-    if (index < 0) { // no end yet
-//        qDebug() << "frame started but no end yet, leaving...";
+    if (m_partStart < 0) {
+        // nothing of value before the first boundary
+        discardBefore(resume);
+        m_scanPos = 0;
         return;
     }
 
-    // end reached, get the frame
-//    qDebug() << "one frame complete, process it";
-    QByteArray fullFrame = m_imageData.left(index);
-    Q_EMIT processData(fullFrame);
-    m_imageStarted = false;
-    m_imageData = m_imageData.mid(index+marker.length()); // discard data upto the extracted frame
+    if (m_used - m_partStart > MAX_FRAME_SIZE) {
+        qDebug() << "mjpeg frame too big, dropping it";
+        m_droppedFrames++;
+        m_partStart = -1;
+        discardBefore(resume);
+        m_scanPos = 0;
+        return;
+    }
+
+    m_scanPos = qMax(m_partStart, resume);
 }
 
-void MJPEGImageGrabber::processData(const QByteArray &data)
+// Hands the buffer holding the frame to the decoder as is and continues receiving into a pooled
+// buffer. Only the few bytes following the boundary are copied.
+void MJPEGImageGrabber::frameComplete(int partStart, int partLength, int tailStart)
 {
-    m_fps++;
+    int tailLength = m_used - tailStart;
+    QByteArray frameBuffer = m_buffer;
+
+    m_buffer = acquireBuffer(qMax(INITIAL_BUFFER_SIZE, tailLength));
+    memcpy(m_buffer.data(), frameBuffer.constData() + tailStart, tailLength);
+    m_used = tailLength;
+    m_partStart = 0;
+    m_scanPos = 0;
 
-    QImage image = QImage::fromData(data, "JPG");
-    if (image.isNull()) {
+    queueDecode(frameBuffer, partStart, partLength);
+}
+
+void MJPEGImageGrabber::queueDecode(const QByteArray &buffer, int offset, int length)
+{
+    if (m_decodeWatcher.isRunning()) {
+        if (!m_pending.buffer.isNull()) {
+            // decoder did not keep up, the newer frame replaces the waiting one
+            m_droppedFrames++;
+            releaseBuffer(m_pending.buffer);
+        }
+        m_pending.buffer = buffer;
+        m_pending.offset = offset;
+        m_pending.length = length;
+        return;
+    }
+    startDecode(buffer, offset, length);
+}
+
+void MJPEGImageGrabber::startDecode(const QByteArray &buffer, int offset, int length)
+{
+    m_decoding = buffer;
+    m_decodeWatcher.setFuture(QtConcurrent::run(decodePool(), &MJPEGImageGrabber::decodeFrame, buffer, offset, length));
+}
+
+void MJPEGImageGrabber::onDecodeFinished()
+{
+    MJPEGDecodedFrame frame = m_decodeWatcher.result();
+    releaseBuffer(m_decoding);
+
+    if (!m_pending.buffer.isNull()) {
+        PendingFrame pending = m_pending;
+        m_pending = PendingFrame();
+        startDecode(pending.buffer, pending.offset, pending.length);
+    }
+
+    if (frame.image.isNull() && frame.raw.isEmpty()) {
         qDebug() << "image is invalid";
-        m_imageData.clear();
+        m_corruptFrames++;
         return;
     }
 
-    Q_EMIT newFrame(QPixmap::fromImage(image));
+    m_fps++;
+    m_decodedCount++;
+    m_decodeTimeNs += frame.decodeTimeNs;
+    if (!frame.raw.isEmpty()) {
+        Q_EMIT newRawFrame(frame.raw, frame.rawSize);
+    } else {
+        Q_EMIT newFrame(frame.image);
+    }
+}
+
+// value of the content-length header in the lower cased part headers, -1 if there is none
+static int contentLengthHeader(const QByteArray &headers)
+{
+    static const QByteArray name("content-length:");
+    int start = headers.indexOf(name);
+    if (start < 0) {
+        return -1;
+    }
+    start += name.length();
+    int end = headers.indexOf('\n', start);
+    bool ok = false;
+    int contentLength = headers.mid(start, end < 0 ? -1 : end - start).trimmed().toInt(&ok);
+    return ok ? contentLength : -1;
+}
+
+MJPEGDecodedFrame MJPEGImageGrabber::decodeFrame(const QByteArray &data, int offset, int length)
+{
+    MJPEGDecodedFrame frame;
+    QElapsedTimer timer;
+    timer.start();
+
+    const uchar *part = reinterpret_cast<const uchar*>(data.constData()) + offset;
+
+    // raw frames are told apart by their part headers, the pixel data may contain anything
+    int headerEnd = QByteArray::fromRawData(reinterpret_cast<const char*>(part), qMin(length, MAX_HEADER_SIZE)).indexOf("\r\n\r\n");
+    if (headerEnd >= 0) {
+        QByteArray headers = QByteArray(reinterpret_cast<const char*>(part), headerEnd).toLower();
+        if (headers.contains("application/octet-stream")) {
+            const uchar *body = part + headerEnd + 4;
+            int bodyLength = length - headerEnd - 4;
+            // the pixel data may end in 0x0d or 0x0a bytes itself, so only the one line break in
+            // front of the next boundary is dropped, or the body is cut to its content length
+            int contentLength = contentLengthHeader(headers);
+            if (contentLength >= 0 && contentLength <= bodyLength) {
+                bodyLength = contentLength;
+            } else if (bodyLength >= 2 && body[bodyLength-2] == '\r' && body[bodyLength-1] == '\n') {
+                bodyLength -= 2;
+            } else if (bodyLength >= 1 && body[bodyLength-1] == '\n') {
+                bodyLength--;
+            }
+            for (size_t i = 0; i < sizeof(LEPTON_FRAME_SIZES) / sizeof(LEPTON_FRAME_SIZES[0]); i++) {
+                QSize size(LEPTON_FRAME_SIZES[i][0], LEPTON_FRAME_SIZES[i][1]);
+                int pixels = size.width() * size.height();
+                if (bodyLength == pixels * 2) {
+                    frame.raw.resize(pixels);
+                    for (int p = 0; p < pixels; p++) {
+                        frame.raw[p] = qFromLittleEndian<quint16>(body + p * 2);
+                    }
+                    frame.rawSize = size;
+                    break;
+                }
+            }
+            frame.decodeTimeNs = timer.nsecsElapsed();
+            return frame;
+        }
+    }
+
+    // skip the part headers, the jpeg starts at the SOI marker
+    int start = 0;
+    while (start + 1 < length && !(part[start] == 0xFF && part[start+1] == 0xD8)) {
+        start++;
+    }
+    if (start + 1 >= length) {
+        return frame;
+    }
+
+    frame.image = QImage::fromData(part + start, length - start, "JPG");
+    frame.decodeTimeNs = timer.nsecsElapsed();
+    return frame;
+}
+
+void MJPEGImageGrabber::reserve(int size)
+{
+    if (size > m_buffer.size()) {
+        m_buffer.resize(qMax(size, m_buffer.size() * 2));
+    }
+}
+
+void MJPEGImageGrabber::discardBefore(int offset)
+{
+    if (offset <= 0) {
+        return;
+    }
+    memmove(m_buffer.data(), m_buffer.constData() + offset, m_used - offset);
+    m_used -= offset;
+}
+
+QByteArray MJPEGImageGrabber::acquireBuffer(int size)
+{
+    QByteArray buffer;
+    if (!m_freeBuffers.isEmpty()) {
+        buffer = m_freeBuffers.takeLast();
+    }
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+    return buffer;
+}
+
+void MJPEGImageGrabber::releaseBuffer(QByteArray &buffer)
+{
+    // a buffer still referenced by a finishing decode would detach on the next write
+    if (buffer.isDetached() && m_freeBuffers.count() < MAX_FREE_BUFFERS) {
+        m_freeBuffers.append(buffer);
+    }
+    buffer = QByteArray();
 }
 
 void MJPEGImageGrabber::onError(QNetworkReply::NetworkError error)
@@ -88,7 +304,3 @@ void MJPEGImageGrabber::onFinished()
     Q_EMIT finished(m_reply->errorString());
     m_reply->deleteLater();
 }
-
-
-
-
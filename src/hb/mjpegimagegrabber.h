@@ -7,19 +7,47 @@
 #include <QNetworkRequest>
 #include <QUrl>
 #include <QByteArray>
-#include <QPixmap>
+#include <QByteArrayMatcher>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QSize>
+#include <QVector>
 #include <QTimer>
 
+// result of decoding one part on the decode pool, either a jpeg or a raw 16-bit lepton frame
+struct MJPEGDecodedFrame
+{
+    MJPEGDecodedFrame() : decodeTimeNs(0) {}
+    QImage              image;
+    QVector<quint16>    raw;
+    QSize               rawSize;
+    qint64              decodeTimeNs;
+};
+
 class MJPEGImageGrabber : public QObject
 {
     Q_OBJECT
 public:
     explicit MJPEGImageGrabber(QNetworkAccessManager *nam, const QUrl &url, QObject *parent = 0);
+    ~MJPEGImageGrabber();
+
+    // statistics over the last second, updated with statsChanged()
+    int fps() const { return m_currentFps; }
+    double decodeTime() const { return m_decodeTimeMs; }
+    // totals since the grabber was created
+    int droppedFrames() const { return m_droppedFrames; }
+    int corruptFrames() const { return m_corruptFrames; }
+
+    // decodes the part in data[offset, offset+length), used by the decode pool. Parts sent as
+    // application/octet-stream holding exactly one lepton sized frame are returned as raw data.
+    static MJPEGDecodedFrame decodeFrame(const QByteArray &data, int offset, int length);
 
 Q_SIGNALS:
-    void newFrame(const QPixmap &pixmap);
+    void newFrame(const QImage &image);
+    void newRawFrame(const QVector<quint16> &data, const QSize &size);
     void newFrameData(const QString &data);
     void finished(const QString &errorString);
+    void statsChanged();
 
 public Q_SLOTS:
 //    void start();
@@ -29,18 +57,54 @@ private Q_SLOTS:
     void onReadyRead();
     void onFinished();
     void onError(QNetworkReply::NetworkError);
+    void onDecodeFinished();
 
 private:
-    void processData(const QByteArray &data);
+    friend class MJPEGImageGrabberTest;
+
+    void scanBuffer();
+    void frameComplete(int partStart, int partLength, int tailStart);
+    void queueDecode(const QByteArray &buffer, int offset, int length);
+    void startDecode(const QByteArray &buffer, int offset, int length);
+    void reserve(int size);
+    void discardBefore(int offset);
+    QByteArray acquireBuffer(int size);
+    void releaseBuffer(QByteArray &buffer);
+
+    // frame waiting for the decoder, replaced by newer frames (latest frame wins)
+    struct PendingFrame {
+        PendingFrame() : offset(0), length(0) {}
+        QByteArray  buffer;
+        int         offset;
+        int         length;
+    };
 
     QNetworkReply                   *m_reply;
     QNetworkAccessManager           *m_nam;
-    bool                             m_imageStarted;
-    QByteArray                       m_imageData;
     QUrl                             m_mjpegStreamUrl;
-    int                              m_fps;
     QTimer                           *m_timer;
 
+    // receive side, parts are scanned for in place and handed to the decoder as views
+    QByteArrayMatcher                m_boundary;
+    QByteArray                       m_buffer;      // sized to its capacity, m_used bytes valid
+    int                              m_used;
+    int                              m_partStart;   // -1 until the first boundary is seen
+    int                              m_scanPos;     // boundary search resumes here
+    QVector<QByteArray>              m_freeBuffers;
+
+    // decode side
+    QFutureWatcher<MJPEGDecodedFrame> m_decodeWatcher;
+    QByteArray                       m_decoding;
+    PendingFrame                     m_pending;
+
+    // statistics
+    int                              m_fps;
+    int                              m_currentFps;
+    int                              m_decodedCount;
+    qint64                           m_decodeTimeNs;
+    double                           m_decodeTimeMs;
+    int                              m_droppedFrames;
+    int                              m_corruptFrames;
 };
 
 #endif // MJPEGIMAGEGRABBER_H
@@ -0,0 +1,183 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "mjpegimagegrabbertest.h"
+#include "mjpegimagegrabber.h"
+
+#include <QtEndian>
+#include <QNetworkAccessManager>
+
+static const int _cLeptonWidth  = 80;
+static const int _cLeptonHeight = 60;
+static const char _cBoundary[]  = "--jpgboundary";
+
+/// Nothing listens here, the grabber only sees what the test hands it
+static const char _cStreamUrl[] = "http://127.0.0.1:1/";
+
+MJPEGImageGrabberTest::MJPEGImageGrabberTest(void)
+{
+
+}
+
+/// Little endian lepton frame whose last pixel is lastPixel
+static QByteArray _rawBody(quint16 lastPixel)
+{
+    QByteArray body(_cLeptonWidth * _cLeptonHeight * 2, 0);
+    for (int p = 0; p < _cLeptonWidth * _cLeptonHeight; p++) {
+        qToLittleEndian<quint16>(static_cast<quint16>(29315 + p % 100), reinterpret_cast<uchar*>(body.data()) + p * 2);
+    }
+    qToLittleEndian<quint16>(lastPixel, reinterpret_cast<uchar*>(body.data()) + body.size() - 2);
+    return body;
+}
+
+void MJPEGImageGrabberTest::_testRawFrameLineBreaks(void)
+{
+    // Pixel data ending in line break bytes must survive, only the line break in front of the boundary goes
+    const quint16 lastPixels[] = { 0x0a0d, 0x0d0a, 0x0a0a, 0x0d0d, 0x0a00, 0x0d00 };
+    const char* lineBreaks[] = { "\r\n", "\n" };
+
+    for (size_t i = 0; i < sizeof(lastPixels) / sizeof(lastPixels[0]); i++) {
+        for (size_t j = 0; j < sizeof(lineBreaks) / sizeof(lineBreaks[0]); j++) {
+            QByteArray part = QByteArray("\r\nContent-Type: application/octet-stream\r\n\r\n") + _rawBody(lastPixels[i]) + lineBreaks[j];
+
+            MJPEGDecodedFrame frame = MJPEGImageGrabber::decodeFrame(part, 0, part.size());
+            QCOMPARE(frame.rawSize, QSize(_cLeptonWidth, _cLeptonHeight));
+            QCOMPARE(frame.raw.count(), _cLeptonWidth * _cLeptonHeight);
+            QCOMPARE(frame.raw.last(), lastPixels[i]);
+            QCOMPARE(frame.raw.first(), static_cast<quint16>(29315));
+        }
+    }
+}
+
+void MJPEGImageGrabberTest::_testRawFrameContentLength(void)
+{
+    QByteArray body = _rawBody(0x0d0a);
+    QByteArray headers = QStringLiteral("\r\nContent-Type: application/octet-stream\r\nContent-Length: %1\r\n\r\n").arg(body.size()).toLatin1();
+
+    // With a content length whatever follows the body is ignored
+    QByteArray part = headers + body + "\r\n\r\n";
+    MJPEGDecodedFrame frame = MJPEGImageGrabber::decodeFrame(part, 0, part.size());
+    QCOMPARE(frame.rawSize, QSize(_cLeptonWidth, _cLeptonHeight));
+    QCOMPARE(frame.raw.last(), static_cast<quint16>(0x0d0a));
+
+    // The part is found at an offset into the receive buffer
+    QByteArray buffer = QByteArray("--jpgboundary") + part + "--jpgboundary";
+    frame = MJPEGImageGrabber::decodeFrame(buffer, 13, part.size());
+    QCOMPARE(frame.rawSize, QSize(_cLeptonWidth, _cLeptonHeight));
+    QCOMPARE(frame.raw.last(), static_cast<quint16>(0x0d0a));
+
+    // A body which is not a lepton frame is not taken as one
+    part = headers + body.left(body.size() - 2) + "\r\n";
+    frame = MJPEGImageGrabber::decodeFrame(part, 0, part.size());
+    QVERIFY(frame.raw.isEmpty());
+}
+
+/// Raw lepton part following a boundary
+static QByteArray _rawPart(quint16 lastPixel)
+{
+    return QByteArray("\r\nContent-Type: application/octet-stream\r\n\r\n") + _rawBody(lastPixel) + "\r\n";
+}
+
+void MJPEGImageGrabberTest::_receive(MJPEGImageGrabber& grabber, const QByteArray& bytes)
+{
+    grabber.reserve(grabber.m_used + bytes.size());
+    memcpy(grabber.m_buffer.data() + grabber.m_used, bytes.constData(), bytes.size());
+    grabber.m_used += bytes.size();
+    grabber.scanBuffer();
+}
+
+void MJPEGImageGrabberTest::_testBoundarySplitAcrossReads(void)
+{
+    const int markerLength = static_cast<int>(strlen(_cBoundary));
+    QByteArray stream = QByteArray(_cBoundary) + _rawPart(1) + _cBoundary + _rawPart(2) + _cBoundary;
+    int splitBoundary = stream.indexOf(_cBoundary, markerLength);
+
+    // Every split of the boundary between the two frames, plus the stream a byte at a time
+    QList<int> chunkSizes;
+    for (int split = splitBoundary; split <= splitBoundary + markerLength; split++) {
+        chunkSizes.append(split);
+    }
+    chunkSizes.append(1);
+
+    foreach (int chunkSize, chunkSizes) {
+        QNetworkAccessManager nam;
+        MJPEGImageGrabber grabber(&nam, QUrl(_cStreamUrl));
+        QList<quint16> lastPixels;
+        connect(&grabber, &MJPEGImageGrabber::newRawFrame, this, [&lastPixels](const QVector<quint16>& data, const QSize&) {
+            lastPixels.append(data.last());
+        });
+
+        // A byte at a time splits every boundary, otherwise the stream goes in two reads
+        int offset = 0;
+        while (offset < stream.size()) {
+            int length = chunkSize == 1 ? 1 : (offset == 0 ? chunkSize : stream.size() - offset);
+            _receive(grabber, stream.mid(offset, length));
+            offset += length;
+
+            // The search never goes back further than a partial boundary
+            if (grabber.m_partStart >= 0) {
+                QVERIFY(grabber.m_scanPos >= grabber.m_used - markerLength + 1);
+            }
+        }
+
+        QTRY_COMPARE_WITH_TIMEOUT(lastPixels.count(), 2, 2000);
+        QCOMPARE(lastPixels, QList<quint16>() << 1 << 2);
+        QCOMPARE(grabber.droppedFrames(), 0);
+        QCOMPARE(grabber.corruptFrames(), 0);
+    }
+}
+
+void MJPEGImageGrabberTest::_testBufferReuse(void)
+{
+    QNetworkAccessManager nam;
+    MJPEGImageGrabber grabber(&nam, QUrl(_cStreamUrl));
+
+    // A released buffer comes back on the next acquire, a buffer still shared with a decode does not
+    QByteArray buffer = grabber.acquireBuffer(1024);
+    const char* data = buffer.constData();
+    grabber.releaseBuffer(buffer);
+    QVERIFY(buffer.isNull());
+    QCOMPARE(grabber.m_freeBuffers.count(), 1);
+    buffer = grabber.acquireBuffer(512);
+    QCOMPARE(buffer.constData(), data);
+    QCOMPARE(grabber.m_freeBuffers.count(), 0);
+
+    QByteArray shared = buffer;
+    grabber.releaseBuffer(buffer);
+    QCOMPARE(grabber.m_freeBuffers.count(), 0);
+
+    // The pool does not grow without bound
+    QList<QByteArray> buffers;
+    for (int i = 0; i < 10; i++) {
+        buffers.append(grabber.acquireBuffer(1024));
+    }
+    for (int i = 0; i < buffers.count(); i++) {
+        grabber.releaseBuffer(buffers[i]);
+    }
+    QVERIFY(grabber.m_freeBuffers.count() < buffers.count());
+
+    // A completed frame goes to the decoder in its buffer, receiving carries on in a pooled one
+    grabber.m_freeBuffers.clear();
+    QByteArray spare(256 * 1024, 0);      // as big as the receive buffer, so it is not reallocated
+    data = spare.constData();
+    grabber.m_freeBuffers.append(spare);
+    spare = QByteArray();
+    const char* frameData = grabber.m_buffer.constData();
+
+    int frameCount = 0;
+    connect(&grabber, &MJPEGImageGrabber::newRawFrame, this, [&frameCount](const QVector<quint16>&, const QSize&) {
+        frameCount++;
+    });
+    _receive(grabber, QByteArray(_cBoundary) + _rawPart(1) + _cBoundary + "\r\n");
+    QCOMPARE(grabber.m_decoding.constData(), frameData);
+    QCOMPARE(grabber.m_buffer.constData(), data);
+    QVERIFY(grabber.m_freeBuffers.isEmpty());
+    QCOMPARE(grabber.m_used, 2);
+    QTRY_COMPARE_WITH_TIMEOUT(frameCount, 1, 2000);
+}
@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MJPEGImageGrabber;
+
+class MJPEGImageGrabberTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MJPEGImageGrabberTest(void);
+
+private slots:
+    void _testRawFrameLineBreaks(void);
+    void _testRawFrameContentLength(void);
+    void _testBoundarySplitAcrossReads(void);
+    void _testBufferReuse(void);
+
+private:
+    /// Hands bytes to the grabber the way onReadyRead does
+    void _receive(MJPEGImageGrabber& grabber, const QByteArray& bytes);
+};
@@ -0,0 +1,169 @@
+#include "nodecommandqueue.h"
+
+#include <QNetworkRequest>
+#include <QTimer>
+
+static const int DEFAULT_MAX_IN_FLIGHT = 8;
+static const int DEFAULT_TIMEOUT = 5000;    // milliseconds
+static const int DEFAULT_MAX_RETRIES = 2;
+static const int RETRY_BACKOFF = 250;       // milliseconds, doubled for every further attempt
+static const char TIMED_OUT_PROPERTY[] = "nodeCommandTimedOut";
+
+NodeCommandQueue::NodeCommandQueue(QNetworkAccessManager *nam, QObject *parent) :
+    QObject(parent),
+    m_nam(nam),
+    m_inFlightCount(0),
+    m_retrying(0),
+    m_maxInFlight(DEFAULT_MAX_IN_FLIGHT),
+    m_timeout(DEFAULT_TIMEOUT),
+    m_maxRetries(DEFAULT_MAX_RETRIES),
+    m_total(0),
+    m_finished(0),
+    m_failed(0)
+{
+    Q_ASSERT(m_nam);
+}
+
+QString NodeCommandQueue::nodeKey(const QUrl &url)
+{
+    return url.host() + ':' + QString::number(url.port(80));
+}
+
+void NodeCommandQueue::enqueue(const QUrl &url, const QVariantMap &properties, bool idempotent)
+{
+    // the last batch is done, start counting a new one
+    if (m_finished == m_total) {
+        m_total = m_finished = m_failed = 0;
+    }
+
+    Command command;
+    command.url = url;
+    command.properties = properties;
+    command.idempotent = idempotent;
+    m_nodes[nodeKey(url)].queued.enqueue(command);
+    m_total++;
+    Q_EMIT progressChanged();
+
+    dispatch();
+}
+
+// Takes one command per node and pass, so a node with a long queue does not starve the others.
+void NodeCommandQueue::dispatch()
+{
+    bool sent = true;
+    while (sent && m_inFlightCount < m_maxInFlight) {
+        sent = false;
+        QHash<QString, NodeQueue>::iterator it = m_nodes.begin();
+        for (; it != m_nodes.end() && m_inFlightCount < m_maxInFlight; ++it) {
+            NodeQueue &node = it.value();
+            if (node.queued.isEmpty() || node.inFlight || node.backingOff) {
+                continue;
+            }
+            node.inFlight = true;
+            send(node.queued.dequeue());
+            sent = true;
+        }
+    }
+}
+
+void NodeCommandQueue::send(const Command &command)
+{
+    QNetworkRequest request(command.url);
+    // pipelining is only safe for requests that can be sent again
+    if (command.idempotent) {
+        request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    }
+
+    QNetworkReply *reply = m_nam->get(request);
+    Command sent = command;
+    sent.attempts++;
+    m_inFlight.insert(reply, sent);
+    m_inFlightCount++;
+
+    if (m_timeout > 0) {
+        QTimer *deadline = new QTimer(reply);
+        deadline->setSingleShot(true);
+        connect(deadline, SIGNAL(timeout()), SLOT(onDeadline()));
+        deadline->start(m_timeout);
+    }
+    connect(reply, SIGNAL(finished()), SLOT(onReplyFinished()));
+}
+
+void NodeCommandQueue::onDeadline()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender()->parent());
+    if (!reply || reply->isFinished()) {
+        return;
+    }
+    qDebug() << "node command timed out" << reply->url();
+    reply->setProperty(TIMED_OUT_PROPERTY, true);
+    reply->abort();
+}
+
+void NodeCommandQueue::onReplyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
+
+    QHash<QNetworkReply*, Command>::iterator it = m_inFlight.find(reply);
+    if (it == m_inFlight.end()) {
+        return;
+    }
+    Command command = it.value();
+    m_inFlight.erase(it);
+    m_inFlightCount--;
+
+    QString node = nodeKey(command.url);
+    NodeQueue &queue = m_nodes[node];
+    queue.inFlight = false;
+
+    int error = reply->error();
+    if (reply->property(TIMED_OUT_PROPERTY).toBool()) {
+        error = QNetworkReply::TimeoutError;
+    }
+
+    // network errors are below the proxy errors, the node did not answer. Errors the node
+    // answered with are final.
+    bool networkError = error != QNetworkReply::NoError && error < QNetworkReply::ProxyConnectionRefusedError;
+    if (networkError && command.idempotent && command.attempts <= m_maxRetries) {
+        retry(node, command);
+    } else {
+        if (queue.queued.isEmpty() && !queue.inFlight) {
+            m_nodes.remove(node);
+        }
+        complete(command, error, error == QNetworkReply::NoError ? reply->readAll() : QByteArray());
+    }
+
+    dispatch();
+}
+
+void NodeCommandQueue::retry(const QString &node, const Command &command)
+{
+    int backoff = RETRY_BACKOFF << (command.attempts - 1);
+    qDebug() << "retrying node command in" << backoff << "ms" << command.url;
+    m_retrying++;
+    // nothing else goes to the node until the retry has been sent, commands to a node run in order
+    m_nodes[node].backingOff = true;
+    QTimer::singleShot(backoff, this, [this, node, command]() {
+        m_retrying--;
+        NodeQueue &queue = m_nodes[node];
+        queue.backingOff = false;
+        queue.queued.prepend(command);
+        dispatch();
+    });
+}
+
+void NodeCommandQueue::complete(const Command &command, int error, const QByteArray &body)
+{
+    m_finished++;
+    if (error != QNetworkReply::NoError) {
+        qDebug() << "node command failed" << command.url << "error" << error << "attempts" << command.attempts;
+        m_failed++;
+    }
+    Q_EMIT commandFinished(command.properties, error, body);
+    Q_EMIT progressChanged();
+
+    if (m_finished == m_total && !m_retrying && !m_inFlightCount) {
+        Q_EMIT idle();
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef NODECOMMANDQUEUE_H
+#define NODECOMMANDQUEUE_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QHash>
+#include <QQueue>
+#include <QUrl>
+#include <QVariantMap>
+
+// Sends the http commands for the nodes. Every node (host and port of the url) has its own queue
+// so a slow or dead node only holds up its own commands. A node has at most one request in flight
+// and its queue is held while a command waits out its retry backoff, so the commands to a node
+// run in the order they were queued. The number of requests in flight in total is bounded,
+// requests get a deadline and idempotent ones are retried with backoff. Connections are kept
+// alive by the access manager and reused across commands.
+class NodeCommandQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NodeCommandQueue(QNetworkAccessManager *nam, QObject *parent = 0);
+
+    void setMaxInFlight(int maxInFlight) { m_maxInFlight = qMax(1, maxInFlight); }
+    void setTimeout(int msecs) { m_timeout = msecs; }
+    void setMaxRetries(int retries) { m_maxRetries = qMax(0, retries); }
+
+    // properties come back with commandFinished. Idempotent commands are retried after network
+    // errors and timeouts, and may be pipelined on a connection.
+    void enqueue(const QUrl &url, const QVariantMap &properties = QVariantMap(), bool idempotent = false);
+
+    // progress of the current batch, a batch ends when the queue runs empty
+    int pending() const { return m_total - m_finished; }
+    int finished() const { return m_finished; }
+    int failed() const { return m_failed; }
+    int total() const { return m_total; }
+
+Q_SIGNALS:
+    // error is a QNetworkReply::NetworkError, body is empty unless the command succeeded
+    void commandFinished(const QVariantMap &properties, int error, const QByteArray &body);
+    void progressChanged();
+    void idle();
+
+private Q_SLOTS:
+    void onReplyFinished();
+    void onDeadline();
+
+private:
+    struct Command {
+        Command() : idempotent(false), attempts(0) {}
+        QUrl        url;
+        QVariantMap properties;
+        bool        idempotent;
+        int         attempts;
+    };
+
+    struct NodeQueue {
+        NodeQueue() : inFlight(false), backingOff(false) {}
+        QQueue<Command> queued;
+        bool            inFlight;
+        bool            backingOff;     // a retried command waits at the head of the queue
+    };
+
+    static QString nodeKey(const QUrl &url);
+    void dispatch();
+    void send(const Command &command);
+    void retry(const QString &node, const Command &command);
+    void complete(const Command &command, int error, const QByteArray &body);
+
+    QNetworkAccessManager          *m_nam;
+    QHash<QString, NodeQueue>       m_nodes;
+    QHash<QNetworkReply*, Command>  m_inFlight;
+    int                             m_inFlightCount;
+    int                             m_retrying;     // commands waiting out their backoff
+
+    int                             m_maxInFlight;
+    int                             m_timeout;      // milliseconds
+    int                             m_maxRetries;
+
+    int                             m_total;
+    int                             m_finished;
+    int                             m_failed;
+};
+
+#endif // NODECOMMANDQUEUE_H
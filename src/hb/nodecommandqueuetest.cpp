@@ -0,0 +1,255 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "nodecommandqueuetest.h"
+#include "nodecommandqueue.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QPointer>
+#include <QTimer>
+
+int NodeStandIn::totalInFlight = 0;
+int NodeStandIn::maxTotalInFlight = 0;
+
+NodeStandIn::NodeStandIn(bool answer, int delayMsecs, QObject* parent)
+    : QTcpServer(parent)
+    , dropRequests(0)
+    , connections(0)
+    , requests(0)
+    , inFlight(0)
+    , maxInFlight(0)
+    , _answer(answer)
+    , _delayMsecs(delayMsecs)
+{
+    connect(this, &QTcpServer::newConnection, this, &NodeStandIn::_newConnection);
+    listen(QHostAddress::LocalHost);
+}
+
+void NodeStandIn::_newConnection(void)
+{
+    while (hasPendingConnections()) {
+        QTcpSocket* socket = nextPendingConnection();
+        connections++;
+        connect(socket, &QTcpSocket::readyRead, this, &NodeStandIn::_readyRead);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QObject::destroyed, this, [this, socket]() { _buffers.remove(socket); });
+    }
+}
+
+void NodeStandIn::_readyRead(void)
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    QByteArray& buffer = _buffers[socket];
+    buffer.append(socket->readAll());
+
+    // Requests may be pipelined, answer them one by one in order
+    int end;
+    while ((end = buffer.indexOf("\r\n\r\n")) >= 0) {
+        QByteArray path = buffer.left(buffer.indexOf("\r\n")).split(' ').value(1);
+        buffer.remove(0, end + 4);
+
+        requests++;
+        paths.append(path);
+        if (dropRequests > 0) {
+            // Dropped on the floor, the client gives up on it
+            dropRequests--;
+            continue;
+        }
+        maxInFlight = qMax(maxInFlight, ++inFlight);
+        maxTotalInFlight = qMax(maxTotalInFlight, ++totalInFlight);
+        if (!_answer) {
+            continue;
+        }
+
+        QPointer<QTcpSocket> target(socket);
+        QTimer::singleShot(_delayMsecs, this, [this, target, path]() {
+            inFlight--;
+            totalInFlight--;
+            if (target) {
+                QByteArray body = "ok " + path;
+                target->write("HTTP/1.1 200 OK\r\nConnection: keep-alive\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body);
+            }
+        });
+    }
+}
+
+NodeCommandQueueTest::NodeCommandQueueTest(void)
+{
+
+}
+
+static QUrl _url(const NodeStandIn& node, const QString& path)
+{
+    return QUrl(QStringLiteral("http://127.0.0.1:%1%2").arg(node.serverPort()).arg(path));
+}
+
+void NodeCommandQueueTest::_testConcurrency(void)
+{
+    const int nodeCount     = 4;
+    const int commandCount  = 10;
+
+    QNetworkAccessManager nam;
+    nam.setProxy(QNetworkProxy::NoProxy);
+    NodeCommandQueue queue(&nam);
+    queue.setMaxInFlight(3);
+
+    NodeStandIn::totalInFlight = NodeStandIn::maxTotalInFlight = 0;
+    QObject owner;
+    QList<NodeStandIn*> nodes;
+    for (int i = 0; i < nodeCount; i++) {
+        nodes.append(new NodeStandIn(true, 50, &owner));
+        QVERIFY(nodes.last()->isListening());
+    }
+
+    int finished    = 0;
+    int errors      = 0;
+    int idle        = 0;
+    QByteArray lastBody;
+    connect(&queue, &NodeCommandQueue::commandFinished, [&](const QVariantMap& properties, int error, const QByteArray& body) {
+        finished++;
+        errors += error ? 1 : 0;
+        if (properties["node"].toInt() == 0 && properties["command"].toInt() == commandCount - 1) {
+            lastBody = body;
+        }
+    });
+    connect(&queue, &NodeCommandQueue::idle, [&idle]() { idle++; });
+
+    for (int command = 0; command < commandCount; command++) {
+        for (int node = 0; node < nodeCount; node++) {
+            QVariantMap properties;
+            properties["node"]      = node;
+            properties["command"]   = command;
+            queue.enqueue(_url(*nodes[node], QStringLiteral("/picam/?command=%1").arg(command)), properties, true);
+        }
+    }
+    QCOMPARE(queue.total(), nodeCount * commandCount);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished, nodeCount * commandCount, 10000);
+    QCOMPARE(errors, 0);
+    QCOMPARE(idle, 1);
+    QCOMPARE(queue.pending(), 0);
+    QCOMPARE(queue.failed(), 0);
+    QCOMPARE(lastBody, QByteArray("ok /picam/?command=9"));
+
+    // One at a time per node and bounded in total, but nodes are served in parallel
+    QVERIFY(NodeStandIn::maxTotalInFlight <= 3);
+    QVERIFY(NodeStandIn::maxTotalInFlight > 1);
+    for (int node = 0; node < nodeCount; node++) {
+        QCOMPARE(nodes[node]->requests, commandCount);
+        QCOMPARE(nodes[node]->maxInFlight, 1);
+        // Connections are kept alive between commands
+        QVERIFY(nodes[node]->connections < commandCount);
+    }
+}
+
+void NodeCommandQueueTest::_testDeadlineAndRetry(void)
+{
+    QNetworkAccessManager nam;
+    nam.setProxy(QNetworkProxy::NoProxy);
+    NodeCommandQueue queue(&nam);
+    queue.setTimeout(300);
+    queue.setMaxRetries(2);
+
+    NodeStandIn hung(false);
+    NodeStandIn healthy(true);
+    QVERIFY(hung.isListening());
+    QVERIFY(healthy.isListening());
+
+    QStringList finished;
+    QList<int> errors;
+    connect(&queue, &NodeCommandQueue::commandFinished, [&](const QVariantMap& properties, int error, const QByteArray&) {
+        finished.append(properties["id"].toString());
+        errors.append(error);
+    });
+
+    // A command which is not idempotent is tried once. The hung node does not hold up the healthy one.
+    QVariantMap properties;
+    properties["id"] = QStringLiteral("hung");
+    queue.enqueue(_url(hung, QStringLiteral("/picam/?command=start")), properties, false);
+    for (int i = 0; i < 5; i++) {
+        properties["id"] = QStringLiteral("healthy");
+        queue.enqueue(_url(healthy, QStringLiteral("/hostapdget")), properties, true);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 6, 5000);
+    QCOMPARE(finished.last(), QStringLiteral("hung"));
+    QCOMPARE(errors.last(), static_cast<int>(QNetworkReply::TimeoutError));
+    QCOMPARE(finished.count(QStringLiteral("healthy")), 5);
+    QCOMPARE(hung.requests, 1);
+    QCOMPARE(queue.failed(), 1);
+
+    // An idempotent one is retried until it runs out of retries
+    finished.clear();
+    errors.clear();
+    properties["id"] = QStringLiteral("retried");
+    queue.enqueue(_url(hung, QStringLiteral("/picam/?command=terminate")), properties, true);
+    QCOMPARE(queue.total(), 1);
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 10000);
+    QCOMPARE(errors.last(), static_cast<int>(QNetworkReply::TimeoutError));
+    QCOMPARE(hung.requests, 1 + 3);
+}
+
+void NodeCommandQueueTest::_testDeadNode(void)
+{
+    QNetworkAccessManager nam;
+    nam.setProxy(QNetworkProxy::NoProxy);
+    NodeCommandQueue queue(&nam);
+
+    // Nothing listens on the port of a closed server
+    NodeStandIn dead(true);
+    QUrl deadUrl = _url(dead, QStringLiteral("/picam/?command=terminate"));
+    dead.close();
+    NodeStandIn healthy(true);
+
+    QList<int> errors;
+    int idle = 0;
+    connect(&queue, &NodeCommandQueue::commandFinished, [&errors](const QVariantMap&, int error, const QByteArray&) { errors.append(error); });
+    connect(&queue, &NodeCommandQueue::idle, [&idle]() { idle++; });
+
+    queue.enqueue(deadUrl, QVariantMap(), true);
+    queue.enqueue(_url(healthy, QStringLiteral("/hostapdget")), QVariantMap(), true);
+
+    QTRY_COMPARE_WITH_TIMEOUT(idle, 1, 10000);
+    QCOMPARE(errors.count(), 2);
+    QCOMPARE(errors.first(), static_cast<int>(QNetworkReply::NoError));
+    QCOMPARE(errors.last(), static_cast<int>(QNetworkReply::ConnectionRefusedError));
+    QCOMPARE(queue.total(), 2);
+    QCOMPARE(queue.failed(), 1);
+    QCOMPARE(queue.pending(), 0);
+}
+
+void NodeCommandQueueTest::_testRetryOrder(void)
+{
+    QNetworkAccessManager nam;
+    nam.setProxy(QNetworkProxy::NoProxy);
+    NodeCommandQueue queue(&nam);
+    queue.setTimeout(300);
+
+    // The node misses the first terminate, which is retried after its backoff. The start queued
+    // behind it must not go out before the retried terminate.
+    NodeStandIn node(true);
+    node.dropRequests = 1;
+    QVERIFY(node.isListening());
+
+    QStringList finished;
+    connect(&queue, &NodeCommandQueue::commandFinished, [&finished](const QVariantMap& properties, int error, const QByteArray&) {
+        finished.append(QStringLiteral("%1 %2").arg(properties["id"].toString()).arg(error));
+    });
+
+    QVariantMap properties;
+    properties["id"] = QStringLiteral("terminate");
+    queue.enqueue(_url(node, QStringLiteral("/picam/?command=terminate")), properties, true);
+    properties["id"] = QStringLiteral("start");
+    queue.enqueue(_url(node, QStringLiteral("/picam/?command=start")), properties, false);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 2, 5000);
+    QCOMPARE(finished, QStringList() << QStringLiteral("terminate 0") << QStringLiteral("start 0"));
+    QCOMPARE(node.paths, QList<QByteArray>() << "/picam/?command=terminate" << "/picam/?command=terminate" << "/picam/?command=start");
+    QCOMPARE(node.maxInFlight, 1);
+}
@@ -0,0 +1,62 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+
+/// Local stand-in for the http server on a node. Answers every request after a delay, or never
+/// when it plays a hung node.
+class NodeStandIn : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    NodeStandIn(bool answer, int delayMsecs = 0, QObject* parent = NULL);
+
+    /// Leaves the given number of first requests unanswered, like a node which is busy for a moment
+    int dropRequests;
+
+    QList<QByteArray> paths;    ///< Paths of the requests in the order they came in
+    int connections;
+    int requests;
+    int inFlight;
+    int maxInFlight;
+
+    /// Requests in flight over all stand-ins
+    static int totalInFlight;
+    static int maxTotalInFlight;
+
+private slots:
+    void _newConnection (void);
+    void _readyRead     (void);
+
+private:
+    bool                            _answer;
+    int                             _delayMsecs;
+    QHash<QTcpSocket*, QByteArray>  _buffers;
+};
+
+class NodeCommandQueueTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    NodeCommandQueueTest(void);
+
+private slots:
+    void _testConcurrency(void);
+    void _testDeadlineAndRetry(void);
+    void _testDeadNode(void);
+    void _testRetryOrder(void);
+};
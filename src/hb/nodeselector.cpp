@@ -20,7 +20,9 @@ NodeSelector* NodeSelector::instance(QNetworkAccessManager *nam)
 
 NodeSelector::NodeSelector(QNetworkAccessManager *nam, QObject *parent) :
     QObject(parent),
+    m_nam(0),
     m_currentIndex(0),
+    m_recordingStatus(false),
     m_hasVideo(false)
 {
     // use supplied QNAM, otherwise create your own
@@ -36,6 +38,12 @@ NodeSelector::NodeSelector(QNetworkAccessManager *nam, QObject *parent) :
     }
     Q_ASSERT(m_nam);
 
+    m_commands = new NodeCommandQueue(m_nam, this);
+    connect(m_commands, &NodeCommandQueue::commandFinished,
+            this, &NodeSelector::onCommandFinished);
+    connect(m_commands, &NodeCommandQueue::progressChanged,
+            this, &NodeSelector::commandProgressChanged);
+
     m_discoverer = new PiDiscoverer(this);
     connect(m_discoverer, &PiDiscoverer::nodeDiscovered,
             this, &NodeSelector::onNewNodeDiscovered);
@@ -59,7 +67,7 @@ void NodeSelector::terminatePicam(const PiNode &node)
     if (node.caps & PiNode::PICAM) {
         qDebug() << "termiante picam at node" << node.addressString;
         QUrl terminateUrl("http://" + node.addressString + ":8080/picam/?command=terminate");
-        sendRequest(terminateUrl);
+        sendRequest(terminateUrl, QVariantMap(), true);
     }
 }
 
@@ -80,7 +88,7 @@ void NodeSelector::hostapdget()
     QVariantMap map;
     map.insert("requestFor", PiNode::AP);
     map.insert("nodeIndex", m_currentIndex);
-    sendRequest(mavcmd, map);
+    sendRequest(mavcmd, map, true);
 }
 
 void NodeSelector::terminateThermal(const PiNode &node)
@@ -88,10 +96,11 @@ void NodeSelector::terminateThermal(const PiNode &node)
     if (node.caps & PiNode::LEPTON) {
         qDebug() << "termiante thermal at node" << node.addressString;
         QUrl terminateUrl = QUrl("http://" + node.addressString + ":8080/thermalcam/?command=terminate");
-        sendRequest(terminateUrl);
+        sendRequest(terminateUrl, QVariantMap(), true);
     }
 }
 
+// halt and reboot are not retried, a node going down may never answer them
 void NodeSelector::shutdownAll()
 {
     PiNodeList nodes = m_discoverer->discoveredNodes();
@@ -117,7 +126,7 @@ void NodeSelector::terminateMavProxy(const PiNode &node)
     if (node.caps & PiNode::MAVUDP) {
         qDebug() << "terminate mavproxy at node" << node.addressString;
         QUrl terminateUrl = QUrl("http://" + node.addressString + ":8080/mavproxy/?command=screen -X -S MAVPROXY quit");
-        sendRequest(terminateUrl);
+        sendRequest(terminateUrl, QVariantMap(), true);
     }
 }
 
@@ -141,7 +150,7 @@ void NodeSelector::selectPrevious()
         return;
     }
 
-    m_currentIndex = m_currentIndex-1 < 0 ? nodes.size()-1 : m_currentIndex;
+    m_currentIndex = m_currentIndex-1 < 0 ? nodes.size()-1 : m_currentIndex-1;
 }
 
 PiNode NodeSelector::currentNode() const
@@ -171,15 +180,14 @@ void NodeSelector::setCurrentHostAPDConf(const QVariantMap &config)
     PiNode node = nodes[m_currentIndex];
     QString mavcmd = "http://" + node.addressString + ":8080/hostapdset?";
     mavcmd.replace("$CLIENT_IP", deviceAddress(node));
-    Q_FOREACH(const QVariant &key, config.keys()) {
-        mavcmd.append(key.toString() + "=" + config.value(key.toString()).toString());
+    Q_FOREACH(const QString &key, config.keys()) {
+        mavcmd.append(key + "=" + config.value(key).toString());
         if (key != config.keys().last()) {
             mavcmd.append("&");
         }
     }
     qDebug() << "mav command " << mavcmd;
-    QVariantMap map;
-    sendRequest(mavcmd, map);
+    sendRequest(mavcmd, QVariantMap(), true);
 }
 
 void NodeSelector::onNewNodeDiscovered(const PiNode &node)
@@ -191,7 +199,7 @@ void NodeSelector::onNewNodeDiscovered(const PiNode &node)
                 qDebug() << "mav command " << mavcmd;
                 QVariantMap map;
                 map.insert("requestFor", PiNode::MAVUDP);
-                map.insert("nodeIndex", m_currentIndex);
+                map.insert("nodeIndex", m_discoverer->indexOf(node.uniqueId));
                 sendRequest(mavcmd, map);
             }
         }
@@ -258,7 +266,7 @@ int NodeSelector::startStreaming(const PiNode &node, const QString &optionsStrin
 
         QVariantMap map;
         map.insert("requestFor", PiNode::PICAM);
-        map.insert("nodeIndex", m_currentIndex);
+        map.insert("nodeIndex", m_discoverer->indexOf(node.uniqueId));
         qDebug() << "sending out new streaming command " << servercmd;
         sendRequest(servercmd, map);
         return node.targetStreamingPort;
@@ -297,9 +305,11 @@ bool NodeSelector::startThermal(const PiNode &node)
             qDebug() << "thermal server start url " << startUrl;
             QVariantMap map;
             map.insert("requestFor", PiNode::LEPTON);
-            map.insert("nodeIndex", m_currentIndex);
+            map.insert("nodeIndex", m_discoverer->indexOf(node.uniqueId));
 //                map.insert("camUrl", mjpegUrl);
             sendRequest(startUrl, map);
+        } else {
+            Q_EMIT thermalUrl(node.mjpegServerUrl());
         }
         return true;
     }
@@ -340,48 +350,42 @@ QString NodeSelector::deviceAddress(const PiNode& node) const
     return address;
 }
 
-void NodeSelector::replyFinished()
+void NodeSelector::onCommandFinished(const QVariantMap &properties, int error, const QByteArray &body)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    reply->deleteLater();
     PiNodeList nodes = m_discoverer->discoveredNodes();
     if (!nodes.size()) {
         return;
     }
-    Q_ASSERT(reply);
-    if (reply->error() == QNetworkReply::NoError)
+    if (error == QNetworkReply::NoError)
     {
         bool ok = false;
-        int capibility = reply->property("requestFor").toInt(&ok);
+        int capibility = properties.value("requestFor").toInt(&ok);
         if (!ok) {
             qDebug() << "generic request return";
             return;
         }
 
-        int index;
-        QUrl url;
+        int index = properties.value("nodeIndex", -1).toInt();
+        if (index < 0 || index >= nodes.count()) {
+            return;
+        }
         switch (capibility) {
         case PiNode::PICAM:
-            index = reply->property("nodeIndex").toInt();
             nodes[index].capsRunning |= PiNode::PICAM;
             qDebug() << "picam started without any error";
             break;
         case PiNode::LEPTON:
-            index = reply->property("nodeIndex").toInt();
             nodes[index].capsRunning |= PiNode::LEPTON;
-//            url = reply->property("camUrl").toUrl();
-//            Q_EMIT thermalUrl(url);
+            Q_EMIT thermalUrl(nodes[index].mjpegServerUrl());
             qDebug() << "thermal camera started without any error";
             break;
         case PiNode::MAVUDP:
-            index = reply->property("nodeIndex").toInt();
             nodes[index].capsRunning |= PiNode::MAVUDP;
             qDebug() << "mavproxy started without any error";
             break;
         case PiNode::AP:
         {
-            index = reply->property("nodeIndex").toInt();
-            QString replyString = reply->readAll();
+            QString replyString = body;
             QStringList replyList = replyString.split("\n");
             qDebug() << replyList;
             QVariantMap keyPair;
@@ -405,12 +409,7 @@ void NodeSelector::replyFinished()
 //    }
 }
 
-void NodeSelector::sendRequest(const QUrl &url, const QVariantMap &properties)
+void NodeSelector::sendRequest(const QUrl &url, const QVariantMap &properties, bool idempotent)
 {
-    QNetworkRequest request(url);
-    QNetworkReply *reply = m_nam->get(request);
-    Q_FOREACH(const QString &key, properties.keys()) {
-        reply->setProperty(key.toStdString().c_str(), properties.value(key));
-    }
-    connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+    m_commands->enqueue(url, properties, idempotent);
 }
@@ -7,18 +7,31 @@
 #include <QVariantMap>
 
 #include "pidiscoverer.h"
+#include "nodecommandqueue.h"
 
 class NodeSelector : public QObject
 {
     Q_OBJECT
+    // progress of the last batch of node commands, e.g. shutdownAll()
+    Q_PROPERTY(int commandsPending  READ commandsPending  NOTIFY commandProgressChanged)
+    Q_PROPERTY(int commandsFailed   READ commandsFailed   NOTIFY commandProgressChanged)
+    Q_PROPERTY(int commandsTotal    READ commandsTotal    NOTIFY commandProgressChanged)
 public:
     static NodeSelector* instance(QNetworkAccessManager *nam = 0);
     QString deviceAddress(const PiNode& node) const;
     PiDiscoverer* discoverer() const { return m_discoverer; }
     QString videoUriForCurrentNode();
+    // options and recording state of the last stream started, empty until one was started
+    QString streamingOptions() const { return m_picamOptString; }
+    bool recordingStatus() const { return m_recordingStatus; }
+    NodeCommandQueue* commands() const { return m_commands; }
+    int commandsPending() const { return m_commands->pending(); }
+    int commandsFailed() const { return m_commands->failed(); }
+    int commandsTotal() const { return m_commands->total(); }
 
 Q_SIGNALS:
     void thermalUrl(const QUrl &thermalUrl);
+    void commandProgressChanged();
 
 public Q_SLOTS:
     QVariantMap currentHostAPDConf() const;
@@ -43,17 +56,18 @@ public Q_SLOTS:
     // mavproxy and thermal start automatically if the node is capable
 
 private Q_SLOTS:
-    void replyFinished();
+    void onCommandFinished(const QVariantMap &properties, int error, const QByteArray &body);
 
 private:
     explicit NodeSelector(QNetworkAccessManager *nam = 0, QObject *parent = 0);
     virtual ~NodeSelector();
     void hostapdget();
-    void sendRequest(const QUrl &url, const QVariantMap &properties = QVariantMap());
+    void sendRequest(const QUrl &url, const QVariantMap &properties = QVariantMap(), bool idempotent = false);
     void terminateMavProxy(const PiNode& node);
 
     PiDiscoverer            *m_discoverer;
     QNetworkAccessManager   *m_nam;
+    NodeCommandQueue        *m_commands;
     int                      m_currentIndex;
     QString                  m_picamOptString;
     bool                     m_recordingStatus,
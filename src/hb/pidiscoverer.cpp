@@ -1,7 +1,22 @@
 #include "pidiscoverer.h"
 
-#define PIDISCOVERER_BROADCAST_PORT 31311
+#include <QHash>
+#include <cstring>
+
 #define STREAMING_PORT_LOWEST 5003
+
+static const char BEACON_TAG[] = "raspberry";
+static const int BEACON_TAG_LENGTH = sizeof(BEACON_TAG) - 1;
+// raspberry <uniqueId> <caps> <beaconInterval> <seqNum>
+static const int BEACON_TOKENS = 5;
+
+static const qint64 MIN_LIVENESS_TIMEOUT = 500; // milliseconds
+static const int WHEEL_SLOTS = 64;
+static const int WHEEL_TICK = 100;              // milliseconds, the wheel spans 6.4s
+static const int RECEIVE_BUFFER_SIZE = 256 * 1024;
+
+const quint16 PiDiscoverer::broadcastPort;
+
 PiNode::PiNode()
 {
     caps        = PiNode::NONE;
@@ -9,121 +24,320 @@ PiNode::PiNode()
 
     targetStreamingPort = STREAMING_PORT_LOWEST;
     beaconInterval      = 0;
+    heartBeatCount      = 0;
+    unorderedCount      = 0;
     lastLanSeqNum       = 0;
     latency             = 0;
 }
 
+qint64 PiNode::livenessTimeout() const
+{
+    return qMax(MIN_LIVENESS_TIMEOUT, 5 * static_cast<qint64>(beaconInterval));
+}
+
 bool PiNode::operator ==(const PiNode &node) const
 {
-    return (this->address == node.address);
+    return (this->uniqueId == node.uniqueId);
 }
 
-PiDiscoverer::PiDiscoverer(QObject *parent) : QObject(parent)
+// splits a beacon into space separated tokens in place, returns how many were found
+static int tokenize(const char *data, int size, const char **tokens, int *lengths, int maxTokens)
 {
+    int count = 0;
+    int i = 0;
+    while (count < maxTokens) {
+        while (i < size && (data[i] == ' ' || data[i] == '\r' || data[i] == '\n' || data[i] == '\0')) {
+            i++;
+        }
+        if (i == size) {
+            break;
+        }
+        int start = i;
+        while (i < size && data[i] != ' ' && data[i] != '\r' && data[i] != '\n' && data[i] != '\0') {
+            i++;
+        }
+        tokens[count] = data + start;
+        lengths[count] = i - start;
+        count++;
+    }
+    return count;
 }
 
-void PiDiscoverer::startDiscovery()
+static bool parseNumber(const char *data, int length, quint32 *value)
 {
-    static bool started = false;
-    if (!started) {
-        m_socket.bind(QHostAddress::Any, PIDISCOVERER_BROADCAST_PORT);
-        connect(&m_socket, SIGNAL(readyRead()), SLOT(datagramReceived()));
+    if (length <= 0 || length > 10) {
+        return false;
+    }
+    quint64 result = 0;
+    for (int i = 0; i < length; i++) {
+        if (data[i] < '0' || data[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (data[i] - '0');
+    }
+    if (result > 0xffffffffu) {
+        return false;
     }
+    *value = static_cast<quint32>(result);
+    return true;
+}
+
+PiDiscoverer::PiDiscoverer(QObject *parent) :
+    QObject(parent),
+    m_started(false),
+    m_wheelPos(0),
+    m_aliveCount(0)
+{
+    m_datagram.resize(512);
+    m_wheel.resize(WHEEL_SLOTS);
+    m_sweepTimer.setInterval(WHEEL_TICK);
+    connect(&m_sweepTimer, SIGNAL(timeout()), SLOT(sweep()));
+}
+
+bool PiDiscoverer::startDiscovery(quint16 port)
+{
+    if (m_started) {
+        return true;
+    }
+    if (!m_socket.bind(QHostAddress::Any, port)) {
+        qWarning() << "could not listen for node beacons on port" << port << m_socket.errorString();
+        return false;
+    }
+    // leave room for a burst of beacons in the kernel until the event loop gets to them
+    m_socket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, RECEIVE_BUFFER_SIZE);
+    connect(&m_socket, SIGNAL(readyRead()), SLOT(datagramReceived()));
+    m_started = true;
+    return true;
 }
 
 void PiDiscoverer::datagramReceived()
 {
-    qint64 datagramSize = m_socket.pendingDatagramSize();
-    QByteArray datagram;
-    datagram.resize(datagramSize);
-    QHostAddress addr;
-    m_socket.readDatagram(datagram.data(), datagramSize, &addr);
+    // readyRead is not emitted again for datagrams that were already queued, drain them all
+    while (m_socket.hasPendingDatagrams()) {
+        qint64 datagramSize = m_socket.pendingDatagramSize();
+        if (datagramSize > m_datagram.size()) {
+            m_datagram.resize(datagramSize);
+        }
+        qint64 read = m_socket.readDatagram(m_datagram.data(), m_datagram.size(), &m_sender);
+        if (read < 0) {
+            break;
+        }
+        processDatagram(m_datagram.constData(), static_cast<int>(read), m_sender);
+    }
+}
 
+// Beacons of known nodes are parsed in place and looked up by the hash of their id, nothing is
+// allocated for them. Only new nodes are turned into strings.
+void PiDiscoverer::processDatagram(const char *data, int size, const QHostAddress &sender)
+{
     // not our packet
-    if (!datagram.startsWith("raspberry")) {
+    if (size < BEACON_TAG_LENGTH || memcmp(data, BEACON_TAG, BEACON_TAG_LENGTH) != 0) {
         return;
     }
 
-    // process packet
-    QString beacon = QString(datagram);
-    QStringList tokens = beacon.split(' ');
-
-    if (tokens.count() < 5) {
+    const char *tokens[BEACON_TOKENS];
+    int lengths[BEACON_TOKENS];
+    if (tokenize(data, size, tokens, lengths, BEACON_TOKENS) < BEACON_TOKENS) {
         qDebug() << "something wrong with the heartbeat, we have less than 5 tokens";
         return;
     }
 
-    PiNode node;
+    quint32 caps, beaconInterval, seqNum;
+    if (!parseNumber(tokens[2], lengths[2], &caps) ||
+            !parseNumber(tokens[3], lengths[3], &beaconInterval) ||
+            !parseNumber(tokens[4], lengths[4], &seqNum)) {
+        qDebug() << "something wrong with the heartbeat, malformed numbers";
+        return;
+    }
+
+    uint hash = qHashBits(tokens[1], lengths[1]);
+    int index = findNode(tokens[1], lengths[1], hash);
+    if (index < 0) {
+        addNode(tokens[1], lengths[1], hash, caps, beaconInterval, seqNum, sender);
+    } else {
+        updateNode(index, beaconInterval, seqNum, sender);
+    }
+}
+
+int PiDiscoverer::findNode(const char *id, int length, uint hash) const
+{
+    QMultiHash<uint, int>::const_iterator it = m_index.constFind(hash);
+    for (; it != m_index.constEnd() && it.key() == hash; ++it) {
+        const QByteArray &nodeId = m_keys.at(it.value()).id;
+        if (nodeId.size() == length && memcmp(nodeId.constData(), id, length) == 0) {
+            return it.value();
+        }
+    }
+    return -1;
+}
+
+int PiDiscoverer::indexOf(const QString &uniqueId) const
+{
+    QByteArray id = uniqueId.toUtf8();
+    return findNode(id.constData(), id.size(), qHashBits(id.constData(), id.size()));
+}
 
-    // TODO: some optimization opportunity, we don't need to process the whole node
-    // as if it is not a new node, we need very few fields
-    node.uniqueId            = tokens.at(1);
-    node.caps                = QString(tokens.at(2)).toInt();
-    node.beaconInterval      = QString(tokens.at(3)).toInt();
+void PiDiscoverer::addNode(const char *id, int length, uint hash, int caps, int beaconInterval,
+                           quint32 seqNum, const QHostAddress &sender)
+{
+    PiNode node;
+    node.uniqueId            = QString::fromUtf8(id, length);
+    node.caps                = caps;
+    node.beaconInterval      = beaconInterval;
     node.heartBeatCount      = 1;
-    node.address             = addr;
-    node.addressString       = addr.toString().split(":").last();
-    node.lastLanSeqNum       = QString(tokens.at(4)).toUInt();
+    node.address             = sender;
+    node.addressString       = sender.toString().split(":").last();
+    node.lastLanSeqNum       = seqNum;
     node.targetStreamingPort = STREAMING_PORT_LOWEST + m_discoveredNodes.count();
     node.beaconTimer.start();
+    node.lastSeen.start();
 
-    if (!m_discoveredNodes.contains(node)) {
-        qDebug() << "new unique node adding";
-        m_discoveredNodes << node;
-        Q_EMIT nodeDiscovered(node);
-        onNodeDiscovered(node);
-    } else {
-        updateNode(node);
+    NodeKey key;
+    key.id   = QByteArray(id, length);
+    key.hash = hash;
+    key.lost = false;
+
+    int index = m_discoveredNodes.count();
+    qDebug() << "new unique node adding" << node.uniqueId << node.addressString;
+    m_discoveredNodes << node;
+    m_keys << key;
+    m_index.insert(hash, index);
+
+    m_aliveCount++;
+    schedule(index);
+    if (!m_sweepTimer.isActive()) {
+        m_sweepTimer.start();
     }
+
+    Q_EMIT nodeDiscovered(node);
+    onNodeDiscovered(node);
 }
 
 // this is not the first heartbeat for this node.
 // we need to update the latency numbers averaged
 // and publish it as  discovered if more than 3 heartbeats
 // have been receieved for this node
-void PiDiscoverer::updateNode(const PiNode &node)
-{
-    int index = m_discoveredNodes.indexOf(node);
-    auto expectedSeqNum = m_discoveredNodes[index].lastLanSeqNum+1;
-    static auto unordered = 0;
-    if (expectedSeqNum != node.lastLanSeqNum) {
-//        qDebug() << "lost a packet or unordered packets coming" << "expected: " << expectedSeqNum << " last seq no: " << node.lastLanSeqNum;
-        if (expectedSeqNum > node.lastLanSeqNum) {
-//            qDebug() << "got late heartbeat " << "expected: " << expectedSeqNum << " last seq no: " << node.lastLanSeqNum;
+void PiDiscoverer::updateNode(int index, int beaconInterval, quint32 seqNum, const QHostAddress &sender)
+{
+    PiNode &node = m_discoveredNodes[index];
+    node.lastSeen.restart();
+
+    // the node got a new lease
+    if (node.address != sender) {
+        node.address = sender;
+        node.addressString = sender.toString().split(":").last();
+    }
+
+    if (m_keys[index].lost) {
+        // back after a reboot or out of range, whatever ran on it has to be started again
+        qDebug() << "node is back" << node.uniqueId << node.addressString;
+        m_keys[index].lost  = false;
+        node.capsRunning    = PiNode::NONE;
+        node.beaconInterval = beaconInterval;
+        node.heartBeatCount = 1;
+        node.unorderedCount = 0;
+        node.lastLanSeqNum  = seqNum;
+        node.beaconTimer.restart();
+
+        m_aliveCount++;
+        schedule(index);
+        if (!m_sweepTimer.isActive()) {
+            m_sweepTimer.start();
         }
-        m_discoveredNodes[index].lastLanSeqNum = node.lastLanSeqNum;
-//        m_discoveredNodes[index].beaconTimer.restart();
-        unordered++;
+
+        PiNode discovered = node;
+        Q_EMIT nodeDiscovered(discovered);
+        onNodeDiscovered(discovered);
+        return;
+    }
+
+    auto expectedSeqNum = node.lastLanSeqNum+1;
+    if (expectedSeqNum != seqNum) {
+        // lost a packet or unordered packets coming
+        node.lastLanSeqNum = seqNum;
+        node.unorderedCount++;
         return;
     }
 
-//    qDebug() << "unordered lost till now" << unordered;
-    auto newLatency = m_discoveredNodes[index].beaconTimer.restart() - node.beaconInterval*(unordered+1);
-//    qDebug() << "calculated latency" << newLatency;
-    unordered = 0;
+    auto newLatency = node.beaconTimer.restart() - beaconInterval*(node.unorderedCount+1);
+    node.unorderedCount = 0;
 
-    auto oldLatency =  m_discoveredNodes[index].latency;
+    auto oldLatency = node.latency;
     newLatency = newLatency < 0 ? 0 : newLatency;
     newLatency = newLatency ? newLatency : oldLatency;
 
-//    qDebug() << "adjusted new latency" << newLatency << " beacon interval " << node.beaconInterval;
+    node.latency = oldLatency ? (0.7*oldLatency + 0.3*newLatency) : newLatency;
+    node.beaconInterval = beaconInterval;
+    node.lastLanSeqNum = seqNum;
+    node.heartBeatCount++;
 
+//    debugNode(node);
+    Q_EMIT nodeUpdated(node);
+}
+
+// Puts the node in the wheel slot it would expire in. It is only looked at again when the wheel
+// gets there, beacons arriving meanwhile just restart its lastSeen timer.
+void PiDiscoverer::schedule(int index)
+{
+    const PiNode &node = m_discoveredNodes.at(index);
+    qint64 remaining = node.livenessTimeout() - node.lastSeen.elapsed();
+    int ticks = static_cast<int>(qBound<qint64>(1, (remaining + WHEEL_TICK - 1) / WHEEL_TICK, WHEEL_SLOTS - 1));
+    m_wheel[(m_wheelPos + ticks) % WHEEL_SLOTS].append(index);
+}
+
+void PiDiscoverer::sweep()
+{
+    m_wheelPos = (m_wheelPos + 1) % WHEEL_SLOTS;
+    if (m_wheel[m_wheelPos].isEmpty()) {
+        return;
+    }
 
-//    m_discoveredNodes[index].latency = oldLatency ? (0.7*oldLatency + 0.3*newLatency) : newLatency;
-    m_discoveredNodes[index].latency = 1000;
-    m_discoveredNodes[index].lastLanSeqNum = node.lastLanSeqNum;
-    m_discoveredNodes[index].heartBeatCount++;
+    QVector<int> due;
+    due.swap(m_wheel[m_wheelPos]);
+    for (int i = 0; i < due.count(); i++) {
+        int index = due[i];
+        if (index >= m_discoveredNodes.count() || m_keys[index].lost) {
+            continue;
+        }
+        if (m_discoveredNodes.at(index).isAlive()) {
+            schedule(index);
+            continue;
+        }
 
-    if (m_discoveredNodes[index].heartBeatCount == 30) { // we will use higher count and latency determination here later.
-//    if (m_discoveredNodes[index].heartBeatCount == 1) {
-//        Q_EMIT nodeDiscovered(m_discoveredNodes[index]);
-//        onNodeDiscovered(m_discoveredNodes[index]);
-        // not waiting for latency number before claiming we have one.
-        // we are not uing latency anyway
+        m_keys[index].lost = true;
+        m_aliveCount--;
+        PiNode node = m_discoveredNodes.at(index);
+        qDebug() << "node lost" << node.uniqueId << node.addressString;
+        Q_EMIT nodeLost(node);
     }
 
-//    debugNode(m_discoveredNodes[index]);
-    Q_EMIT nodeUpdated(m_discoveredNodes[index]);
+    if (m_aliveCount <= 0) {
+        m_sweepTimer.stop();
+    }
+}
+
+void PiDiscoverer::rebuildIndex()
+{
+    int oldCount = m_keys.count();
+    m_keys.resize(m_discoveredNodes.count());
+    m_index.clear();
+    m_aliveCount = 0;
+    for (int i = 0; i < m_discoveredNodes.count(); i++) {
+        NodeKey &key = m_keys[i];
+        key.id   = m_discoveredNodes.at(i).uniqueId.toUtf8();
+        key.hash = qHashBits(key.id.constData(), key.id.size());
+        if (i >= oldCount) {
+            key.lost = false;
+            schedule(i);
+        }
+        m_index.insert(key.hash, i);
+        if (!key.lost) {
+            m_aliveCount++;
+        }
+    }
+    if (m_aliveCount > 0 && !m_sweepTimer.isActive()) {
+        m_sweepTimer.start();
+    }
 }
 
 void PiDiscoverer::debugNode(const PiNode &node)
@@ -143,9 +357,10 @@ PiNodeList PiDiscoverer::discoveredNodes() const
 void PiDiscoverer::setDiscoveredNodes(const QList<PiNode> nodes)
 {
     m_discoveredNodes = nodes;
+    rebuildIndex();
 }
 
 void PiDiscoverer::onNodeDiscovered(const PiNode &node)
 {
-
+    Q_UNUSED(node);
 }
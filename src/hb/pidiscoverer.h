@@ -4,6 +4,9 @@
 #include <QObject>
 #include <QUrl>
 #include <QElapsedTimer>
+#include <QMultiHash>
+#include <QTimer>
+#include <QVector>
 #include <QtNetwork/QUdpSocket>
 
 class PiNode
@@ -11,7 +14,9 @@ class PiNode
 public:
     PiNode();
     bool isValid() const { return !addressString.isEmpty(); }
-    bool isAlive() const { return beaconTimer.isValid() && beaconTimer.elapsed() < 5*latency; }
+    // a node is alive until it misses five beacons, going by the interval it announces
+    bool isAlive() const { return lastSeen.isValid() && lastSeen.elapsed() < livenessTimeout(); }
+    qint64 livenessTimeout() const;
     QUrl mjpegServerUrl() const { return QUrl("http://"+ addressString + ":5002/cam.mjpg"); }
     bool operator ==(const PiNode &node) const;
 
@@ -32,39 +37,79 @@ public:
     int                     targetStreamingPort;
     int                     beaconInterval;
     int                     heartBeatCount;
+    int                     unorderedCount;
     quint32                 lastLanSeqNum;
     QHostAddress            address;
     quint32                 latency; // milliseconds
     QString                 addressString,
                             uniqueId;
     QVariantMap             hostAPDConf;
-    QElapsedTimer           beaconTimer;
+    QElapsedTimer           beaconTimer;    // restarted by in order beacons, used for latency
+    QElapsedTimer           lastSeen;       // restarted by every beacon, used for liveness
 };
 
 #define PiNodeList QList<PiNode>
 
+// Listens for the beacons the nodes broadcast. Nodes keep their index in discoveredNodes() for the
+// lifetime of the discoverer, a node that stops beaconing is reported lost and gets its old index
+// back when it returns.
 class PiDiscoverer : public QObject
 {
     Q_OBJECT
 public:
+    static const quint16 broadcastPort = 31311;
+
     explicit PiDiscoverer(QObject *parent = 0);
-    void startDiscovery();
+    bool startDiscovery(quint16 port = broadcastPort);
+    quint16 port() const { return m_socket.localPort(); }
     PiNodeList discoveredNodes() const;
     void setDiscoveredNodes(const PiNodeList nodes);
+    // index of the node in discoveredNodes(), -1 if it was never seen
+    int indexOf(const QString &uniqueId) const;
+
+    // handles one beacon, the socket feeds every datagram through here
+    void processDatagram(const char *data, int size, const QHostAddress &sender);
 
 Q_SIGNALS:
     void nodeDiscovered(const PiNode &node);
     void nodeUpdated(const PiNode &node);
+    void nodeLost(const PiNode &node);
 
 private Q_SLOTS:
     void datagramReceived();
     void onNodeDiscovered(const PiNode &node);
+    void sweep();
 
 private:
-    void updateNode(const PiNode &node);
+    // per node lookup state, indexed like m_discoveredNodes
+    struct NodeKey {
+        NodeKey() : hash(0), lost(false) {}
+        QByteArray  id;
+        uint        hash;
+        bool        lost;
+    };
+
+    int findNode(const char *id, int length, uint hash) const;
+    void addNode(const char *id, int length, uint hash, int caps, int beaconInterval,
+                 quint32 seqNum, const QHostAddress &sender);
+    void updateNode(int index, int beaconInterval, quint32 seqNum, const QHostAddress &sender);
+    void rebuildIndex();
+    void schedule(int index);
     void debugNode(const PiNode &node);
+
     QUdpSocket m_socket;
+    bool m_started;
+    QByteArray m_datagram;              // receive buffer, reused for every datagram
+    QHostAddress m_sender;
     PiNodeList m_discoveredNodes;
+    QVector<NodeKey> m_keys;
+    QMultiHash<uint, int> m_index;      // hash of the unique id -> node index
+
+    // timer wheel for liveness, every slot holds the nodes to look at when the wheel gets there
+    QVector<QVector<int> > m_wheel;
+    int m_wheelPos;
+    int m_aliveCount;
+    QTimer m_sweepTimer;
 };
 
 #endif // PIDISCOVERER_H
@@ -0,0 +1,182 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "pidiscoverertest.h"
+#include "pidiscoverer.h"
+
+#include <QSet>
+#include <QUdpSocket>
+
+PiDiscovererTest::PiDiscovererTest(void)
+{
+
+}
+
+static QByteArray _beacon(int node, int caps, int beaconInterval, quint32 seqNum)
+{
+    return QStringLiteral("raspberry node-%1 %2 %3 %4\n").arg(node).arg(caps).arg(beaconInterval).arg(seqNum).toLatin1();
+}
+
+static void _send(PiDiscoverer& discoverer, const QByteArray& beacon, const QHostAddress& sender)
+{
+    discoverer.processDatagram(beacon.constData(), beacon.size(), sender);
+}
+
+void PiDiscovererTest::_testBeaconFlood(void)
+{
+    const int nodeCount     = 200;
+    const int beaconCount   = 50;
+
+    PiDiscoverer discoverer;
+    int discovered  = 0;
+    int updated     = 0;
+    connect(&discoverer, &PiDiscoverer::nodeDiscovered, [&discovered](const PiNode&) { discovered++; });
+    connect(&discoverer, &PiDiscoverer::nodeUpdated,    [&updated](const PiNode&) { updated++; });
+
+    // Beacons of all nodes interleaved, with some noise that has to be ignored
+    for (quint32 seq = 1; seq <= beaconCount; seq++) {
+        for (int node = 0; node < nodeCount; node++) {
+            QHostAddress sender(QStringLiteral("10.0.%1.%2").arg(node / 250).arg(node % 250 + 1));
+            _send(discoverer, _beacon(node, PiNode::PICAM | PiNode::MAVUDP, 1000, seq), sender);
+        }
+        _send(discoverer, QByteArray("not a beacon"), QHostAddress::LocalHost);
+        _send(discoverer, QByteArray("raspberry short 1"), QHostAddress::LocalHost);
+        _send(discoverer, QByteArray("raspberry bad x 1000 1"), QHostAddress::LocalHost);
+    }
+
+    QCOMPARE(discovered, nodeCount);
+    QCOMPARE(updated, nodeCount * (beaconCount - 1));
+
+    PiNodeList nodes = discoverer.discoveredNodes();
+    QCOMPARE(nodes.count(), nodeCount);
+    QSet<int> ports;
+    for (int i = 0; i < nodes.count(); i++) {
+        const PiNode& node = nodes[i];
+        QCOMPARE(node.uniqueId, QStringLiteral("node-%1").arg(i));
+        QCOMPARE(discoverer.indexOf(node.uniqueId), i);
+        QCOMPARE(node.heartBeatCount, beaconCount);
+        QCOMPARE(node.lastLanSeqNum, static_cast<quint32>(beaconCount));
+        QCOMPARE(node.caps, PiNode::PICAM | PiNode::MAVUDP);
+        QVERIFY(node.isAlive());
+        ports.insert(node.targetStreamingPort);
+    }
+    QCOMPARE(ports.count(), nodeCount);
+    QCOMPARE(discoverer.indexOf(QStringLiteral("node-unknown")), -1);
+
+    // Out of order beacons do not count as heartbeats, the next in order one does
+    _send(discoverer, _beacon(0, PiNode::PICAM, 1000, beaconCount + 2), QHostAddress(QStringLiteral("10.0.0.1")));
+    QCOMPARE(discoverer.discoveredNodes()[0].heartBeatCount, beaconCount);
+    _send(discoverer, _beacon(0, PiNode::PICAM, 1000, beaconCount + 3), QHostAddress(QStringLiteral("10.0.0.1")));
+    QCOMPARE(discoverer.discoveredNodes()[0].heartBeatCount, beaconCount + 1);
+
+    // A node moving to another address stays the same node
+    _send(discoverer, _beacon(1, PiNode::PICAM, 1000, beaconCount + 1), QHostAddress(QStringLiteral("10.1.0.1")));
+    QCOMPARE(discoverer.discoveredNodes().count(), nodeCount);
+    QCOMPARE(discoverer.discoveredNodes()[1].addressString, QStringLiteral("10.1.0.1"));
+}
+
+void PiDiscovererTest::_testSocketDrain(void)
+{
+    const int nodeCount     = 10;
+    const int beaconCount   = 10;
+
+    PiDiscoverer discoverer;
+    QVERIFY(discoverer.startDiscovery(0));
+    QVERIFY(discoverer.port() != 0);
+
+    int received = 0;
+    connect(&discoverer, &PiDiscoverer::nodeDiscovered, [&received](const PiNode&) { received++; });
+    connect(&discoverer, &PiDiscoverer::nodeUpdated,    [&received](const PiNode&) { received++; });
+
+    // Everything is queued before the event loop runs, a single readyRead has to drain it all
+    QUdpSocket sender;
+    for (quint32 seq = 1; seq <= beaconCount; seq++) {
+        for (int node = 0; node < nodeCount; node++) {
+            QByteArray beacon = _beacon(node, PiNode::PICAM, 1000, seq);
+            QCOMPARE(sender.writeDatagram(beacon, QHostAddress::LocalHost, discoverer.port()), static_cast<qint64>(beacon.size()));
+        }
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(received, nodeCount * beaconCount, 5000);
+    QCOMPARE(discoverer.discoveredNodes().count(), nodeCount);
+}
+
+void PiDiscovererTest::_testNodeLost(void)
+{
+    PiDiscoverer discoverer;
+    QStringList lost;
+    int discovered = 0;
+    connect(&discoverer, &PiDiscoverer::nodeLost,       [&lost](const PiNode& node) { lost.append(node.uniqueId); });
+    connect(&discoverer, &PiDiscoverer::nodeDiscovered, [&discovered](const PiNode&) { discovered++; });
+
+    const QHostAddress address(QStringLiteral("10.0.0.1"));
+    for (int node = 0; node < 3; node++) {
+        _send(discoverer, _beacon(node, PiNode::PICAM, 20, 1), address);
+    }
+    QCOMPARE(discovered, 3);
+
+    // node-0 keeps beaconing, the others go silent and expire
+    quint32 seq = 1;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (elapsed.elapsed() < 1500) {
+        _send(discoverer, _beacon(0, PiNode::PICAM, 20, ++seq), address);
+        QTest::qWait(50);
+    }
+    lost.sort();
+    QCOMPARE(lost, QStringList() << QStringLiteral("node-1") << QStringLiteral("node-2"));
+
+    PiNodeList nodes = discoverer.discoveredNodes();
+    QVERIFY(nodes[0].isAlive());
+    QVERIFY(!nodes[1].isAlive());
+    QVERIFY(!nodes[2].isAlive());
+
+    // A returning node is discovered again and keeps its index and streaming port
+    int port = nodes[2].targetStreamingPort;
+    _send(discoverer, _beacon(2, PiNode::PICAM, 20, 1), address);
+    QCOMPARE(discovered, 4);
+    QCOMPARE(discoverer.discoveredNodes().count(), 3);
+    QCOMPARE(discoverer.indexOf(QStringLiteral("node-2")), 2);
+    QCOMPARE(discoverer.discoveredNodes()[2].targetStreamingPort, port);
+    QVERIFY(discoverer.discoveredNodes()[2].isAlive());
+
+    // and is reported lost only once more when it goes silent again
+    QTRY_COMPARE_WITH_TIMEOUT(lost.count(), 3, 3000);
+    QCOMPARE(lost.last(), QStringLiteral("node-2"));
+}
+
+void PiDiscovererTest::_testLivenessTimeout(void)
+{
+    // Five beacon intervals, but no less than half a second
+    PiNode node;
+    node.beaconInterval = 20;
+    QCOMPARE(node.livenessTimeout(), 500LL);
+    node.beaconInterval = 2000;
+    QCOMPARE(node.livenessTimeout(), 10000LL);
+
+    PiDiscoverer discoverer;
+    QStringList lost;
+    connect(&discoverer, &PiDiscoverer::nodeLost, [&lost](const PiNode& node) { lost.append(node.uniqueId); });
+
+    // In order beacons update the latency, which must not stretch the timeout
+    const QHostAddress address(QStringLiteral("10.0.0.1"));
+    for (quint32 seq = 1; seq <= 2; seq++) {
+        _send(discoverer, _beacon(0, PiNode::PICAM, 20, seq), address);
+        _send(discoverer, _beacon(1, PiNode::PICAM, 300, seq), address);
+    }
+    PiNodeList nodes = discoverer.discoveredNodes();
+    QCOMPARE(nodes[0].livenessTimeout(), 500LL);
+    QCOMPARE(nodes[1].livenessTimeout(), 1500LL);
+
+    QTRY_COMPARE_WITH_TIMEOUT(lost, QStringList() << QStringLiteral("node-0"), 1000);
+    QVERIFY(discoverer.discoveredNodes()[1].isAlive());
+
+    QTRY_COMPARE_WITH_TIMEOUT(lost.count(), 2, 2000);
+    QCOMPARE(lost.last(), QStringLiteral("node-1"));
+}
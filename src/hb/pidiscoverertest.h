@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class PiDiscovererTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    PiDiscovererTest(void);
+
+private slots:
+    void _testBeaconFlood(void);
+    void _testSocketDrain(void);
+    void _testNodeLost(void);
+    void _testLivenessTimeout(void);
+};
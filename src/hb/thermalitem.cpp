@@ -0,0 +1,174 @@
+#include "thermalitem.h"
+#include "thermalkernel.h"
+
+#include <QDebug>
+#include <QQuickWindow>
+#include <QSGSimpleTextureNode>
+#include <QTimer>
+
+// lepton radiometric output (TLinear) is in hundredths of a kelvin
+static const double KELVIN_PER_COUNT = 0.01;
+static const double KELVIN_TO_CELSIUS = -273.15;
+
+static double toCelsius(double counts)
+{
+    return counts * KELVIN_PER_COUNT + KELVIN_TO_CELSIUS;
+}
+
+LEPTONThermalItem::LEPTONThermalItem(QQuickItem *parent) :
+    QQuickItem(parent),
+    m_mjpegGrabber(0),
+    m_palette(ThermalKernel::IRONBOW),
+    m_spot(0.5, 0.5),
+    m_frameDirty(false),
+    m_rawMin(0),
+    m_rawMax(0),
+    m_radiometric(false),
+    m_minTemperature(0),
+    m_maxTemperature(0),
+    m_spotTemperature(0)
+{
+    setFlag(ItemHasContents, true);
+    m_nam = new QNetworkAccessManager(this);
+}
+
+void LEPTONThermalItem::setSource(const QUrl &url)
+{
+    if (url == m_camUrl) {
+        return;
+    }
+    if (m_mjpegGrabber) {
+        m_mjpegGrabber->deleteLater();
+        m_mjpegGrabber = 0;
+    }
+    m_camUrl = url;
+    Q_EMIT sourceChanged();
+
+    if (m_camUrl.isEmpty()) {
+        onNewImage(QImage());
+        return;
+    }
+
+    qDebug() << "delay request to the thermal server for it to start properly";
+    QTimer::singleShot(2000, this, SLOT(startImageGrabber()));
+}
+
+void LEPTONThermalItem::setPalette(int palette)
+{
+    if (palette == m_palette || !ThermalKernel::palette(palette)) {
+        return;
+    }
+    m_palette = palette;
+    Q_EMIT paletteChanged();
+    if (m_radiometric) {
+        colorize();
+    }
+}
+
+void LEPTONThermalItem::setSpot(const QPointF &spot)
+{
+    QPointF clamped(qBound(0.0, spot.x(), 1.0), qBound(0.0, spot.y(), 1.0));
+    if (clamped == m_spot) {
+        return;
+    }
+    m_spot = clamped;
+    Q_EMIT spotChanged();
+    if (m_radiometric) {
+        updateSpot();
+        Q_EMIT statsChanged();
+    }
+}
+
+void LEPTONThermalItem::startImageGrabber()
+{
+    if (m_mjpegGrabber || m_camUrl.isEmpty()) {
+        return;
+    }
+    qDebug() << "starting thermal image grabber";
+    m_mjpegGrabber = new MJPEGImageGrabber(m_nam, m_camUrl, this);
+    connect(m_mjpegGrabber, SIGNAL(newFrame(QImage)),
+            this, SLOT(onNewImage(QImage)));
+    connect(m_mjpegGrabber, SIGNAL(newRawFrame(QVector<quint16>,QSize)),
+            this, SLOT(onNewRawFrame(QVector<quint16>,QSize)));
+    connect(m_mjpegGrabber, SIGNAL(statsChanged()), this, SIGNAL(statsChanged()));
+}
+
+void LEPTONThermalItem::onNewImage(const QImage &image)
+{
+    m_frame = image;
+    m_frameDirty = true;
+    if (m_radiometric) {
+        m_radiometric = false;
+        m_raw.clear();
+        Q_EMIT statsChanged();
+    }
+    update();
+}
+
+void LEPTONThermalItem::onNewRawFrame(const QVector<quint16> &data, const QSize &size)
+{
+    m_raw = data;
+    m_rawSize = size;
+    m_radiometric = true;
+
+    ThermalKernel::minMax(m_raw.constData(), m_raw.count(), &m_rawMin, &m_rawMax);
+    m_minTemperature = toCelsius(m_rawMin);
+    m_maxTemperature = toCelsius(m_rawMax);
+    updateSpot();
+    Q_EMIT statsChanged();
+
+    colorize();
+}
+
+// Colorises into the frame image in place. Only if the scene graph still holds on to the last
+// frame does this cost an allocation.
+void LEPTONThermalItem::colorize()
+{
+    if (m_frame.size() != m_rawSize || m_frame.format() != QImage::Format_RGB32) {
+        m_frame = QImage(m_rawSize, QImage::Format_RGB32);
+    }
+    // 32-bit rows are never padded, the image is one contiguous run of pixels
+    ThermalKernel::applyPalette(m_raw.constData(), m_raw.count(), m_rawMin, m_rawMax,
+                                ThermalKernel::palette(m_palette), reinterpret_cast<QRgb*>(m_frame.bits()));
+    m_frameDirty = true;
+    update();
+}
+
+void LEPTONThermalItem::updateSpot()
+{
+    int x = qMin(m_rawSize.width() - 1, static_cast<int>(m_spot.x() * m_rawSize.width()));
+    int y = qMin(m_rawSize.height() - 1, static_cast<int>(m_spot.y() * m_rawSize.height()));
+    m_spotTemperature = toCelsius(ThermalKernel::spotMean(m_raw.constData(), m_rawSize.width(), m_rawSize.height(), x, y));
+}
+
+QSGNode *LEPTONThermalItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode*>(oldNode);
+
+    if (m_frame.isNull()) {
+        delete node;
+        return 0;
+    }
+
+    if (!node) {
+        node = new QSGSimpleTextureNode;
+        node->setOwnsTexture(true);
+        node->setFiltering(QSGTexture::Linear);
+        m_frameDirty = true;
+    }
+
+    if (m_frameDirty) {
+        // the previous texture is released by the node
+        node->setTexture(window()->createTextureFromImage(m_frame));
+        m_frameDirty = false;
+    }
+
+    // fit the frame into the item keeping its aspect ratio
+    QSizeF frameSize = QSizeF(m_frame.size()).scaled(boundingRect().size(), Qt::KeepAspectRatio);
+    QRectF rect(QPointF(0, 0), frameSize);
+    rect.moveCenter(boundingRect().center());
+    node->setRect(rect);
+
+    return node;
+}
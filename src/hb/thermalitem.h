@@ -0,0 +1,88 @@
+#ifndef THERMALITEM_H
+#define THERMALITEM_H
+
+#include <QQuickItem>
+#include <QNetworkAccessManager>
+#include <QImage>
+#include <QPointF>
+#include <QUrl>
+#include <QVector>
+
+#include "mjpegimagegrabber.h"
+
+// Shows the thermal camera of a node. Frames are uploaded straight into a scene graph texture.
+// Colorised jpegs are shown as they are. Raw 16-bit radiometric frames are colorised here, which
+// also makes the temperature readouts available.
+class LEPTONThermalItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QUrl     source          READ source          WRITE setSource     NOTIFY sourceChanged)
+    Q_PROPERTY(int      palette         READ palette         WRITE setPalette    NOTIFY paletteChanged)
+    Q_PROPERTY(QPointF  spot            READ spot            WRITE setSpot       NOTIFY spotChanged)
+    Q_PROPERTY(bool     hasThermalData  READ hasThermalData                      NOTIFY sourceChanged)
+    Q_PROPERTY(bool     radiometric     READ radiometric                         NOTIFY statsChanged)
+    Q_PROPERTY(double   minTemperature  READ minTemperature                      NOTIFY statsChanged)
+    Q_PROPERTY(double   maxTemperature  READ maxTemperature                      NOTIFY statsChanged)
+    Q_PROPERTY(double   spotTemperature READ spotTemperature                     NOTIFY statsChanged)
+    Q_PROPERTY(int      fps             READ fps                                 NOTIFY statsChanged)
+
+public:
+    LEPTONThermalItem(QQuickItem *parent = 0);
+
+    QUrl source() const { return m_camUrl; }
+    void setSource(const QUrl &url);
+
+    // one of ThermalKernel::Palette
+    int palette() const { return m_palette; }
+    void setPalette(int palette);
+
+    // spot meter position, normalized to the frame
+    QPointF spot() const { return m_spot; }
+    void setSpot(const QPointF &spot);
+
+    bool hasThermalData() const { return !m_camUrl.isEmpty(); }
+    bool radiometric() const { return m_radiometric; }
+    // degrees celsius, only valid for radiometric frames
+    double minTemperature() const { return m_minTemperature; }
+    double maxTemperature() const { return m_maxTemperature; }
+    double spotTemperature() const { return m_spotTemperature; }
+    int fps() const { return m_mjpegGrabber ? m_mjpegGrabber->fps() : 0; }
+
+Q_SIGNALS:
+    void sourceChanged();
+    void paletteChanged();
+    void spotChanged();
+    void statsChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private Q_SLOTS:
+    void onNewImage(const QImage &image);
+    void onNewRawFrame(const QVector<quint16> &data, const QSize &size);
+    void startImageGrabber();
+
+private:
+    void colorize();
+    void updateSpot();
+
+    MJPEGImageGrabber *m_mjpegGrabber;
+    QNetworkAccessManager *m_nam;
+    QUrl m_camUrl;
+    int m_palette;
+    QPointF m_spot;
+
+    QImage m_frame;             // what the texture is made from
+    bool m_frameDirty;
+    QVector<quint16> m_raw;     // last radiometric frame, kept for palette and spot changes
+    QSize m_rawSize;
+    quint16 m_rawMin;
+    quint16 m_rawMax;
+
+    bool m_radiometric;
+    double m_minTemperature;
+    double m_maxTemperature;
+    double m_spotTemperature;
+};
+
+#endif // THERMALITEM_H
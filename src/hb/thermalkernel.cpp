@@ -0,0 +1,208 @@
+#include "thermalkernel.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define THERMAL_KERNEL_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define THERMAL_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+
+const int ThermalKernel::paletteSize;
+
+void ThermalKernel::minMax(const quint16 *src, int count, quint16 *min, quint16 *max)
+{
+    if (count <= 0) {
+        *min = *max = 0;
+        return;
+    }
+
+    quint16 lo = src[0];
+    quint16 hi = src[0];
+    int i = 0;
+
+#if defined(THERMAL_KERNEL_SSE2)
+    if (count >= 8) {
+        // SSE2 only has signed 16-bit min/max, flipping the sign bit keeps the ordering
+        const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+        __m128i vmin = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), bias);
+        __m128i vmax = vmin;
+        for (i = 8; i + 8 <= count; i += 8) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), bias);
+            vmin = _mm_min_epi16(vmin, v);
+            vmax = _mm_max_epi16(vmax, v);
+        }
+        quint16 lanes[8];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_xor_si128(vmin, bias));
+        lo = lanes[0];
+        for (int l = 1; l < 8; l++) {
+            lo = qMin(lo, lanes[l]);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_xor_si128(vmax, bias));
+        hi = lanes[0];
+        for (int l = 1; l < 8; l++) {
+            hi = qMax(hi, lanes[l]);
+        }
+    }
+#elif defined(THERMAL_KERNEL_NEON)
+    if (count >= 8) {
+        uint16x8_t vmin = vld1q_u16(src);
+        uint16x8_t vmax = vmin;
+        for (i = 8; i + 8 <= count; i += 8) {
+            uint16x8_t v = vld1q_u16(src + i);
+            vmin = vminq_u16(vmin, v);
+            vmax = vmaxq_u16(vmax, v);
+        }
+        quint16 lanes[8];
+        vst1q_u16(lanes, vmin);
+        lo = lanes[0];
+        for (int l = 1; l < 8; l++) {
+            lo = qMin(lo, lanes[l]);
+        }
+        vst1q_u16(lanes, vmax);
+        hi = lanes[0];
+        for (int l = 1; l < 8; l++) {
+            hi = qMax(hi, lanes[l]);
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        lo = qMin(lo, src[i]);
+        hi = qMax(hi, src[i]);
+    }
+
+    *min = lo;
+    *max = hi;
+}
+
+// The palette index is (clamp(v, min, max) - min) * scale >> shift. The shift is picked so the
+// scale fits 16 bits: 16 for ranges of 256 and up, 8 for narrow ranges.
+void ThermalKernel::applyPalette(const quint16 *src, int count, quint16 min, quint16 max,
+                                 const QRgb *palette, QRgb *dst)
+{
+    quint32 range = max > min ? max - min : 1;
+    int shift = range >= 256 ? 16 : 8;
+    quint32 scale = (static_cast<quint32>(paletteSize - 1) << shift) / range;
+    int i = 0;
+
+#if defined(THERMAL_KERNEL_SSE2)
+    const __m128i vmin = _mm_set1_epi16(static_cast<short>(min));
+    const __m128i vrange = _mm_set1_epi16(static_cast<short>(range));
+    const __m128i vscale = _mm_set1_epi16(static_cast<short>(scale));
+    const __m128i lowShift = _mm_cvtsi32_si128(shift);
+    const __m128i highShift = _mm_cvtsi32_si128(16 - shift);
+    quint16 index[8];
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_subs_epu16(v, vmin);
+        d = _mm_sub_epi16(d, _mm_subs_epu16(d, vrange));    // min(d, range)
+        __m128i lo = _mm_mullo_epi16(d, vscale);
+        __m128i hi = _mm_mulhi_epu16(d, vscale);
+        __m128i idx = _mm_or_si128(_mm_srl_epi16(lo, lowShift), _mm_sll_epi16(hi, highShift));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(index), idx);
+        for (int l = 0; l < 8; l++) {
+            dst[i + l] = palette[index[l]];
+        }
+    }
+#elif defined(THERMAL_KERNEL_NEON)
+    const uint16x8_t vmin = vdupq_n_u16(min);
+    const uint16x8_t vrange = vdupq_n_u16(static_cast<quint16>(range));
+    const uint16x4_t vscale = vdup_n_u16(static_cast<quint16>(scale));
+    const int32x4_t vshift = vdupq_n_s32(-shift);
+    quint16 index[8];
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t d = vminq_u16(vqsubq_u16(vld1q_u16(src + i), vmin), vrange);
+        uint32x4_t lo = vshlq_u32(vmull_u16(vget_low_u16(d), vscale), vshift);
+        uint32x4_t hi = vshlq_u32(vmull_u16(vget_high_u16(d), vscale), vshift);
+        vst1q_u16(index, vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+        for (int l = 0; l < 8; l++) {
+            dst[i + l] = palette[index[l]];
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        quint32 d = src[i] > min ? qMin<quint32>(src[i] - min, range) : 0;
+        dst[i] = palette[(d * scale) >> shift];
+    }
+}
+
+double ThermalKernel::spotMean(const quint16 *src, int width, int height, int x, int y, int radius)
+{
+    int x0 = qMax(0, x - radius);
+    int x1 = qMin(width - 1, x + radius);
+    int y0 = qMax(0, y - radius);
+    int y1 = qMin(height - 1, y + radius);
+    if (x0 > x1 || y0 > y1) {
+        return 0;
+    }
+
+    quint64 sum = 0;
+    for (int row = y0; row <= y1; row++) {
+        const quint16 *line = src + row * width;
+        for (int col = x0; col <= x1; col++) {
+            sum += line[col];
+        }
+    }
+    return static_cast<double>(sum) / ((x1 - x0 + 1) * (y1 - y0 + 1));
+}
+
+struct PaletteStop {
+    int     position;
+    QRgb    color;
+};
+
+static void interpolate(const PaletteStop *stops, int stopCount, QRgb *palette)
+{
+    for (int s = 0; s + 1 < stopCount; s++) {
+        const PaletteStop &a = stops[s];
+        const PaletteStop &b = stops[s + 1];
+        int span = b.position - a.position;
+        for (int p = a.position; p <= b.position; p++) {
+            int t = p - a.position;
+            palette[p] = qRgb(qRed(a.color)   + (qRed(b.color)   - qRed(a.color))   * t / span,
+                              qGreen(a.color) + (qGreen(b.color) - qGreen(a.color)) * t / span,
+                              qBlue(a.color)  + (qBlue(b.color)  - qBlue(a.color))  * t / span);
+        }
+    }
+}
+
+struct ThermalPalettes {
+    ThermalPalettes()
+    {
+        for (int i = 0; i < ThermalKernel::paletteSize; i++) {
+            palettes[ThermalKernel::GRAYSCALE][i] = qRgb(i, i, i);
+        }
+
+        static const PaletteStop ironbow[] = {
+            {   0, qRgb(  0,   0,   0) },
+            {  48, qRgb( 32,   0, 140) },
+            { 112, qRgb(204,   0, 119) },
+            { 176, qRgb(255, 120,   0) },
+            { 224, qRgb(255, 215,   0) },
+            { 255, qRgb(255, 255, 255) },
+        };
+        interpolate(ironbow, sizeof(ironbow) / sizeof(ironbow[0]), palettes[ThermalKernel::IRONBOW]);
+
+        static const PaletteStop rainbow[] = {
+            {   0, qRgb(  0,   0, 255) },
+            {  64, qRgb(  0, 255, 255) },
+            { 128, qRgb(  0, 255,   0) },
+            { 192, qRgb(255, 255,   0) },
+            { 255, qRgb(255,   0,   0) },
+        };
+        interpolate(rainbow, sizeof(rainbow) / sizeof(rainbow[0]), palettes[ThermalKernel::RAINBOW]);
+    }
+
+    QRgb palettes[ThermalKernel::PALETTE_COUNT][ThermalKernel::paletteSize];
+};
+
+const QRgb *ThermalKernel::palette(int id)
+{
+    static const ThermalPalettes palettes;
+    if (id < 0 || id >= PALETTE_COUNT) {
+        return NULL;
+    }
+    return palettes.palettes[id];
+}
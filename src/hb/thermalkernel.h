@@ -0,0 +1,35 @@
+#ifndef THERMALKERNEL_H
+#define THERMALKERNEL_H
+
+#include <QtGlobal>
+#include <QRgb>
+
+// Per-pixel work on raw 16-bit Lepton frames. SSE2 and NEON paths handle eight pixels at a time,
+// other targets and the frame tail fall back to scalar code producing the same result.
+class ThermalKernel
+{
+public:
+    enum Palette {
+        GRAYSCALE   = 0,
+        IRONBOW     = 1,
+        RAINBOW     = 2,
+        PALETTE_COUNT
+    };
+
+    static const int paletteSize = 256;
+
+    // lowest and highest value in src, both are 0 for an empty frame
+    static void minMax(const quint16 *src, int count, quint16 *min, quint16 *max);
+
+    // maps [min, max] linearly onto the palette, values outside the range are clamped
+    static void applyPalette(const quint16 *src, int count, quint16 min, quint16 max,
+                             const QRgb *palette, QRgb *dst);
+
+    // mean of the pixels within radius of (x, y), clipped to the frame
+    static double spotMean(const quint16 *src, int width, int height, int x, int y, int radius = 1);
+
+    // paletteSize entries, NULL for an unknown palette
+    static const QRgb *palette(int id);
+};
+
+#endif // THERMALKERNEL_H
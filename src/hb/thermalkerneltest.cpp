@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "thermalkerneltest.h"
+#include "thermalkernel.h"
+
+#include <QVector>
+
+// lepton frames, frames shorter than a block and frames with a tail
+static const int _rgCounts[] = { 80 * 60, 160 * 120, 1, 7, 8, 9, 15, 16, 4801 };
+
+ThermalKernelTest::ThermalKernelTest(void)
+{
+
+}
+
+/// Random frame, scene temperatures around 20 C in centikelvin unless fullRange is set
+static QVector<quint16> _randomFrame(int count, bool fullRange)
+{
+    QVector<quint16> frame(count);
+    for (int i = 0; i < count; i++) {
+        frame[i] = fullRange ? static_cast<quint16>(qrand() & 0xffff) : static_cast<quint16>(29315 + qrand() % 2000);
+    }
+    return frame;
+}
+
+static void _referenceMinMax(const QVector<quint16>& src, quint16& min, quint16& max)
+{
+    min = max = src.isEmpty() ? 0 : src[0];
+    for (int i = 1; i < src.count(); i++) {
+        min = qMin(min, src[i]);
+        max = qMax(max, src[i]);
+    }
+}
+
+static int _referenceIndex(quint16 value, quint16 min, quint16 max)
+{
+    quint32 range = max > min ? max - min : 1;
+    int shift = range >= 256 ? 16 : 8;
+    quint32 scale = (static_cast<quint32>(ThermalKernel::paletteSize - 1) << shift) / range;
+    quint32 d = value > min ? qMin<quint32>(value - min, range) : 0;
+    return static_cast<int>((d * scale) >> shift);
+}
+
+void ThermalKernelTest::_testMinMax(void)
+{
+    qsrand(1);
+
+    for (size_t i = 0; i < sizeof(_rgCounts) / sizeof(_rgCounts[0]); i++) {
+        for (int fullRange = 0; fullRange < 2; fullRange++) {
+            QVector<quint16> frame = _randomFrame(_rgCounts[i], fullRange);
+
+            // Extremes in the tail and in the first block, the sign bit flip of the SSE2 path has to hold up
+            if (fullRange && frame.count() > 2) {
+                frame[0] = 0x8000;
+                frame[frame.count() - 1] = 0xffff;
+                frame[frame.count() / 2] = 0;
+            }
+
+            quint16 expectedMin, expectedMax, min, max;
+            _referenceMinMax(frame, expectedMin, expectedMax);
+            ThermalKernel::minMax(frame.constData(), frame.count(), &min, &max);
+            QCOMPARE(min, expectedMin);
+            QCOMPARE(max, expectedMax);
+        }
+    }
+
+    quint16 min = 1, max = 1;
+    ThermalKernel::minMax(NULL, 0, &min, &max);
+    QCOMPARE(min, static_cast<quint16>(0));
+    QCOMPARE(max, static_cast<quint16>(0));
+}
+
+void ThermalKernelTest::_testApplyPalette(void)
+{
+    qsrand(2);
+
+    const QRgb* palette = ThermalKernel::palette(ThermalKernel::IRONBOW);
+    QVERIFY(palette);
+    QVERIFY(!ThermalKernel::palette(ThermalKernel::PALETTE_COUNT));
+
+    for (size_t i = 0; i < sizeof(_rgCounts) / sizeof(_rgCounts[0]); i++) {
+        for (int fullRange = 0; fullRange < 2; fullRange++) {
+            QVector<quint16> frame = _randomFrame(_rgCounts[i], fullRange);
+            quint16 frameMin, frameMax;
+            _referenceMinMax(frame, frameMin, frameMax);
+
+            // Frame range, a narrow range taking the 8 bit shift with values clamped on both sides, and a flat frame
+            quint16 ranges[][2] = {
+                { frameMin,                                     frameMax },
+                { static_cast<quint16>(frameMin + 100),         static_cast<quint16>(frameMin + 200) },
+                { frameMin,                                     frameMin },
+                { 0,                                            0xffff },
+            };
+
+            for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+                QVector<QRgb> dst(frame.count());
+                ThermalKernel::applyPalette(frame.constData(), frame.count(), ranges[r][0], ranges[r][1], palette, dst.data());
+                for (int p = 0; p < frame.count(); p++) {
+                    int index = _referenceIndex(frame[p], ranges[r][0], ranges[r][1]);
+                    QVERIFY(index >= 0 && index < ThermalKernel::paletteSize);
+                    if (dst[p] != palette[index]) {
+                        QFAIL(qPrintable(QStringLiteral("count %1 range %2-%3 pixel %4 value %5: expected palette index %6")
+                                         .arg(frame.count()).arg(ranges[r][0]).arg(ranges[r][1]).arg(p).arg(frame[p]).arg(index)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ThermalKernelTest::_testSpotMean(void)
+{
+    const int width = 4;
+    const int height = 3;
+    const quint16 frame[width * height] = {
+        1, 2, 3, 4,
+        5, 6, 7, 8,
+        9, 10, 11, 12,
+    };
+
+    QCOMPARE(ThermalKernel::spotMean(frame, width, height, 1, 1), (1 + 2 + 3 + 5 + 6 + 7 + 9 + 10 + 11) / 9.0);
+    // Clipped at the corner
+    QCOMPARE(ThermalKernel::spotMean(frame, width, height, 0, 0), (1 + 2 + 5 + 6) / 4.0);
+    QCOMPARE(ThermalKernel::spotMean(frame, width, height, 3, 2, 0), 12.0);
+    QCOMPARE(ThermalKernel::spotMean(frame, width, height, 10, 10), 0.0);
+}
@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Checks the vectorized ThermalKernel paths against a plain scalar reference. Frame sizes are picked so both the
+/// eight pixel blocks and the scalar tail are used.
+class ThermalKernelTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ThermalKernelTest(void);
+
+private slots:
+    void _testMinMax(void);
+    void _testApplyPalette(void);
+    void _testSpotMean(void);
+};
@@ -26,6 +26,8 @@
 #include <QStringListModel>
 #include "QGCApplication.h"
 #include "AppMessages.h"
+#include "CmdLineOptParser.h"
+#include "QGCStartupTracer.h"
 
 #ifndef __mobile__
     #include "QGCSerialPortInfo.h"
@@ -36,11 +38,8 @@
     #include "UnitTest.h"
 #endif
 
-#ifdef QT_DEBUG
-    #include "CmdLineOptParser.h"
-    #ifdef Q_OS_WIN
-        #include <crtdbg.h>
-    #endif
+#if defined(QT_DEBUG) && defined(Q_OS_WIN)
+    #include <crtdbg.h>
 #endif
 
 #ifdef QGC_ENABLE_BLUETOOTH
@@ -102,11 +101,26 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved)
 
 int main(int argc, char *argv[])
 {
+    // Headless mode must be known before the run guard and the QApplication object are created
+    bool headless = false;
 #ifndef __mobile__
-    RunGuard guard("QGroundControlRunGuardKey");
+    {
+        CmdLineOpt_t rgHeadlessOptions[] = {
+            { "--headless",             &headless,          NULL },
+        };
+        ParseCmdLineOptions(argc, argv, rgHeadlessOptions, sizeof(rgHeadlessOptions)/sizeof(rgHeadlessOptions[0]), false);
+    }
+
+    // A headless server has its own run guard so it can run alongside the normal user interface
+    RunGuard guard(headless ? "QGroundControlHeadlessRunGuardKey" : "QGroundControlRunGuardKey");
     if (!guard.tryToRun()) {
         return 0;
     }
+
+    if (headless && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        // No windows are ever shown so there is no need for a display
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
 #endif
 
 #ifdef Q_OS_UNIX
@@ -118,6 +132,27 @@ int main(int argc, char *argv[])
     // install the message handler
     AppMessages::installHandler();
 
+    // Tracing must start before anything else of note happens since the startup time is measured from here
+    bool    trace = false;
+    QString traceFile;
+    {
+        bool    traceStartup = false;
+        bool    startupBenchmark = false;
+        QString startupTraceFile;
+        CmdLineOpt_t rgTraceOptions[] = {
+            { "--trace",                &trace,             &traceFile },
+            { "--trace-startup",        &traceStartup,      &startupTraceFile },
+            { "--startup-benchmark",    &startupBenchmark,  NULL },
+        };
+        ParseCmdLineOptions(argc, argv, rgTraceOptions, sizeof(rgTraceOptions)/sizeof(rgTraceOptions[0]), false);
+        if (trace) {
+            QGCTracer::setEnabled(QGCTracer::SourceCommandLine, true);
+        }
+        if (traceStartup || startupBenchmark) {
+            QGCStartupTracer::start(startupTraceFile);
+        }
+    }
+
 #ifdef Q_OS_MAC
 #ifndef __ios__
     // Prevent Apple's app nap from screwing us over
@@ -206,7 +241,11 @@ int main(int argc, char *argv[])
 #endif
 #endif // QT_DEBUG
 
-    QGCApplication* app = new QGCApplication(argc, argv, runUnitTests);
+    QGCApplication* app = NULL;
+    {
+        QGCStartupTracer::Scope trace("QGCApplication()");
+        app = new QGCApplication(argc, argv, runUnitTests, headless);
+    }
     Q_CHECK_PTR(app);
 
 #ifdef Q_OS_LINUX
@@ -220,9 +259,14 @@ int main(int argc, char *argv[])
     // on in the code.
     qRegisterMetaType<QList<QPair<QByteArray,QByteArray> > >();
 
-    app->_initCommon();
-    //-- Initialize Cache System
-    getQGCMapEngine()->init();
+    if (!headless) {
+        app->_initCommon();
+        //-- Initialize Cache System
+        {
+            QGCStartupTracer::Scope trace("QGCMapEngine::init");
+            getQGCMapEngine()->init();
+        }
+    }
 
     int exitCode = 0;
 
@@ -247,12 +291,24 @@ int main(int argc, char *argv[])
     } else
 #endif
     {
-        if (!app->_initForNormalAppBoot()) {
+        bool initialized = false;
+        if (headless) {
+            QGCStartupTracer::Scope trace("QGCApplication::_initForHeadless");
+            initialized = app->_initForHeadless();
+        } else {
+            QGCStartupTracer::Scope trace("QGCApplication::_initForNormalAppBoot");
+            initialized = app->_initForNormalAppBoot();
+        }
+        if (!initialized) {
             return -1;
         }
         exitCode = app->exec();
     }
 
+    if (trace) {
+        QGCTracer::writeTrace(traceFile.isEmpty() ? QGCTracer::defaultTraceFile() : traceFile);
+    }
+
     app->_shutdown();
     delete app;
     //-- Shutdown Cache System
@@ -15,6 +15,9 @@
 
 #include "GeoTest.h"
 #include "QGCGeo.h"
+#include "UTM.h"
+
+#include <QtMath>
 
 /*
 GeoTest::GeoTest(void)
@@ -91,3 +94,146 @@ void GeoTest::_convertNedToGeoAtOrigin_test(void)
     QCOMPARE(coord.longitude(), expectedLon);
     QCOMPARE(coord.altitude(), expectedAlt);
 }
+
+void GeoTest::_fillGrid(QVector<double>& lat, QVector<double>& lon, int count)
+{
+    int side = qCeil(qSqrt(count));
+
+    lat.resize(count);
+    lon.resize(count);
+    for (int i=0; i<count; i++) {
+        lat[i] = _origin.latitude() + ((i / side) - side / 2) * (0.2 / side);
+        lon[i] = _origin.longitude() + ((i % side) - side / 2) * (0.2 / side);
+    }
+}
+
+void GeoTest::_convertGeoToNedBatch_test(void)
+{
+    QVector<double> lat, lon;
+    _fillGrid(lat, lon, 441);
+    QVector<double> alt(lat.count(), 25.0);
+    QVector<double> x(lat.count()), y(lat.count()), z(lat.count());
+
+    // The grid goes through the origin which must not come out as NaN
+    convertGeoToNed(lat.constData(), lon.constData(), alt.constData(), lat.count(), _origin, x.data(), y.data(), z.data());
+
+    for (int i=0; i<lat.count(); i++) {
+        double expectedX, expectedY, expectedZ;
+        convertGeoToNed(QGeoCoordinate(lat[i], lon[i], alt[i]), _origin, &expectedX, &expectedY, &expectedZ);
+
+        QVERIFY(qAbs(x[i] - expectedX) < 1e-6);
+        QVERIFY(qAbs(y[i] - expectedY) < 1e-6);
+        QCOMPARE(z[i], -25.0);
+    }
+
+    // Horizontal only
+    convertGeoToNed(lat.constData(), lon.constData(), NULL, lat.count(), _origin, x.data(), y.data(), NULL);
+    double expectedX, expectedY, expectedZ;
+    convertGeoToNed(QGeoCoordinate(lat.last(), lon.last(), 0), _origin, &expectedX, &expectedY, &expectedZ);
+    QVERIFY(qAbs(x.last() - expectedX) < 1e-6);
+    QVERIFY(qAbs(y.last() - expectedY) < 1e-6);
+}
+
+void GeoTest::_convertNedToGeoBatch_test(void)
+{
+    QVector<double> lat, lon;
+    _fillGrid(lat, lon, 441);
+    QVector<double> alt(lat.count(), 25.0);
+    QVector<double> x(lat.count()), y(lat.count()), z(lat.count());
+    QVector<double> lat2(lat.count()), lon2(lat.count()), alt2(lat.count());
+
+    convertGeoToNed(lat.constData(), lon.constData(), alt.constData(), lat.count(), _origin, x.data(), y.data(), z.data());
+    convertNedToGeo(x.constData(), y.constData(), z.constData(), lat.count(), _origin, lat2.data(), lon2.data(), alt2.data());
+
+    // Round trip to well below a millimeter
+    for (int i=0; i<lat.count(); i++) {
+        QVERIFY(qAbs(lat2[i] - lat[i]) < 1e-9);
+        QVERIFY(qAbs(lon2[i] - lon[i]) < 1e-9);
+        QCOMPARE(alt2[i], 25.0);
+
+        QGeoCoordinate coord;
+        convertNedToGeo(x[i], y[i], z[i], _origin, &coord);
+        QCOMPARE(coord.latitude(), lat2[i]);
+        QCOMPARE(coord.longitude(), lon2[i]);
+    }
+}
+
+void GeoTest::_convertUTMBatch_test(void)
+{
+    QVector<double> lat, lon;
+    _fillGrid(lat, lon, 441);
+    QVector<double> easting(lat.count()), northing(lat.count());
+    QVector<double> lat2(lat.count()), lon2(lat.count());
+
+    double firstEasting, firstNorthing;
+    int zone = convertGeoToUTM(QGeoCoordinate(lat[0], lon[0]), firstEasting, firstNorthing);
+
+    convertGeoToUTM(lat.constData(), lon.constData(), lat.count(), zone, easting.data(), northing.data());
+    convertUTMToGeo(easting.constData(), northing.constData(), lat.count(), zone, false /* southhemi */, lat2.data(), lon2.data());
+
+    for (int i=0; i<lat.count(); i++) {
+        // Same zone for the whole grid, so the original UTM code has to agree
+        double expectedEasting, expectedNorthing;
+        QCOMPARE(LatLonToUTMXY(lat[i], lon[i], -1 /* zone */, expectedEasting, expectedNorthing), zone);
+        QVERIFY(qAbs(easting[i] - expectedEasting) < 1e-6);
+        QVERIFY(qAbs(northing[i] - expectedNorthing) < 1e-6);
+
+        double latRadians, lonRadians;
+        UTMXYToLatLon(easting[i], northing[i], zone, false /* southhemi */, latRadians, lonRadians);
+        QVERIFY(qAbs(lat2[i] - RadToDeg(latRadians)) < 1e-9);
+        QVERIFY(qAbs(lon2[i] - RadToDeg(lonRadians)) < 1e-9);
+
+        // The single point versions go through the batch code
+        double singleEasting, singleNorthing;
+        QCOMPARE(convertGeoToUTM(QGeoCoordinate(lat[i], lon[i]), singleEasting, singleNorthing), zone);
+        QCOMPARE(singleEasting, easting[i]);
+        QCOMPARE(singleNorthing, northing[i]);
+        QGeoCoordinate coord;
+        convertUTMToGeo(easting[i], northing[i], zone, false /* southhemi */, coord);
+        QCOMPARE(coord.latitude(), lat2[i]);
+        QCOMPARE(coord.longitude(), lon2[i]);
+
+        QVERIFY(qAbs(lat2[i] - lat[i]) < 1e-7);
+        QVERIFY(qAbs(lon2[i] - lon[i]) < 1e-7);
+    }
+
+    // Southern hemisphere
+    double southLat = -33.8688;
+    double southLon = 151.2093;
+    double expectedEasting, expectedNorthing;
+    double southEasting, southNorthing;
+    zone = LatLonToUTMXY(southLat, southLon, -1 /* zone */, expectedEasting, expectedNorthing);
+    convertGeoToUTM(&southLat, &southLon, 1, zone, &southEasting, &southNorthing);
+    QVERIFY(qAbs(southEasting - expectedEasting) < 1e-6);
+    QVERIFY(qAbs(southNorthing - expectedNorthing) < 1e-6);
+    convertUTMToGeo(&southEasting, &southNorthing, 1, zone, true /* southhemi */, &southLat, &southLon);
+    QVERIFY(qAbs(southLat - -33.8688) < 1e-7);
+    QVERIFY(qAbs(southLon - 151.2093) < 1e-7);
+}
+
+// Converts a million points per iteration, so points per second is 1e9 / msecs
+void GeoTest::_convertGeoToNedBatch_benchmark(void)
+{
+    QVector<double> lat, lon;
+    _fillGrid(lat, lon, 1000000);
+    QVector<double> x(lat.count()), y(lat.count());
+
+    QBENCHMARK {
+        convertGeoToNed(lat.constData(), lon.constData(), NULL, lat.count(), _origin, x.data(), y.data(), NULL);
+    }
+}
+
+// Converts a million points per iteration, so points per second is 1e9 / msecs
+void GeoTest::_convertGeoToUTMBatch_benchmark(void)
+{
+    QVector<double> lat, lon;
+    _fillGrid(lat, lon, 1000000);
+    QVector<double> easting(lat.count()), northing(lat.count());
+
+    double firstEasting, firstNorthing;
+    int zone = convertGeoToUTM(_origin, firstEasting, firstNorthing);
+
+    QBENCHMARK {
+        convertGeoToUTM(lat.constData(), lon.constData(), lat.count(), zone, easting.data(), northing.data());
+    }
+}
@@ -17,6 +17,7 @@
 #define GEOTEST_H
 
 #include <QGeoCoordinate>
+#include <QVector>
 
 #include "UnitTest.h"
 
@@ -34,7 +35,15 @@ private slots:
     void _convertGeoToNedAtOrigin_test(void);
     void _convertNedToGeo_test(void);
     void _convertNedToGeoAtOrigin_test(void);
+    void _convertGeoToNedBatch_test(void);
+    void _convertNedToGeoBatch_test(void);
+    void _convertUTMBatch_test(void);
+    void _convertGeoToNedBatch_benchmark(void);
+    void _convertGeoToUTMBatch_benchmark(void);
 private:
+    /// Fills lat/lon with a grid of points covering roughly 20km x 20km around the origin
+    void _fillGrid(QVector<double>& lat, QVector<double>& lon, int count);
+
     QGeoCoordinate _origin;
 };
 
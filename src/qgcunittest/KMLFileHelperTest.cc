@@ -0,0 +1,245 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "KMLFileHelperTest.h"
+#include "KMLFileHelper.h"
+
+#include <QTemporaryFile>
+#include <QDir>
+#include <QtMath>
+#ifdef QGC_ENABLE_KMZ
+#include <private/qzipwriter_p.h>
+#endif
+
+const double KMLFileHelperTest::_cImportSimplifyTolerance = 0.05;
+
+void KMLFileHelperTest::_writeKML(QTemporaryFile& file, bool polygon, const QByteArray& coordinates)
+{
+    QVERIFY(file.open());
+    file.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document><Placemark>");
+    if (polygon) {
+        file.write("<Polygon><tessellate>1</tessellate><outerBoundaryIs><LinearRing><coordinates>");
+    } else {
+        file.write("<LineString><coordinates>");
+    }
+    file.write(coordinates);
+    if (polygon) {
+        file.write("</coordinates></LinearRing></outerBoundaryIs></Polygon>");
+    } else {
+        file.write("</coordinates></LineString>");
+    }
+    file.write("</Placemark></Document></kml>\n");
+    file.close();
+}
+
+void KMLFileHelperTest::_testPolygonLoad(void)
+{
+    QList<QGeoCoordinate>   vertices;
+    QString                 errorString;
+
+    QCOMPARE(KMLFileHelper::determineFileContents(QStringLiteral(":/unittest/PolygonGood.kml"), errorString), KMLFileHelper::Polygon);
+    QVERIFY(KMLFileHelper::loadPolygonFromFile(QStringLiteral(":/unittest/PolygonGood.kml"), vertices, errorString));
+    QVERIFY(errorString.isEmpty());
+
+    // The closing vertex is not repeated
+    QCOMPARE(vertices.count(), 4);
+    QVERIFY(vertices.contains(QGeoCoordinate(47.65965281788451, -122.1059149362712)));
+    QVERIFY(vertices.contains(QGeoCoordinate(47.6599810708829, -122.1061470943783)));
+
+    QVERIFY(!KMLFileHelper::loadPolygonFromFile(QStringLiteral(":/unittest/PolygonBadXml.kml"), vertices, errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!KMLFileHelper::loadPolygonFromFile(QStringLiteral(":/unittest/PolygonMissingNode.kml"), vertices, errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!KMLFileHelper::loadPolygonFromFile(QStringLiteral("/not/a/real/file.kml"), vertices, errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void KMLFileHelperTest::_testPolylineLoad(void)
+{
+    QTemporaryFile          file;
+    QList<QGeoCoordinate>   coords;
+    QString                 errorString;
+
+    _writeKML(file, false /* polygon */, "8.1,47.1,0 8.2,47.2,0 8.3,47.3,0");
+
+    QCOMPARE(KMLFileHelper::determineFileContents(file.fileName(), errorString), KMLFileHelper::Polyline);
+    QVERIFY(KMLFileHelper::loadPolylineFromFile(file.fileName(), coords, errorString));
+
+    // All points are loaded, including the last one
+    QCOMPARE(coords.count(), 3);
+    QCOMPARE(coords[0], QGeoCoordinate(47.1, 8.1));
+    QCOMPARE(coords[2], QGeoCoordinate(47.3, 8.3));
+
+    // A polyline file has no polygon
+    QVERIFY(!KMLFileHelper::loadPolygonFromFile(file.fileName(), coords, errorString));
+}
+
+void KMLFileHelperTest::_testParseCoordinates(void)
+{
+    QVector<double> lat, lon;
+
+    QVERIFY(KMLFileHelper::parseCoordinates(QStringLiteral("\n\t  -122.08,37.42,0\r\n-122.09,37.43   8,47 "), lat, lon));
+    QCOMPARE(lat.count(), 3);
+    QCOMPARE(lon[0], -122.08);
+    QCOMPARE(lat[1], 37.43);
+    QCOMPARE(lon[2], 8.0);
+
+    // Exponents, a space after the comma and digits past double precision
+    QVERIFY(KMLFileHelper::parseCoordinates(QStringLiteral("1.5e1, 2E-1 0.12345678901234567890123,+45."), lat, lon));
+    QCOMPARE(lat.count(), 2);
+    QCOMPARE(lon[0], 15.0);
+    QCOMPARE(lat[0], 0.2);
+    QCOMPARE(lon[1], 0.12345678901234567890123);
+    QCOMPARE(lat[1], 45.0);
+
+    QVERIFY(!KMLFileHelper::parseCoordinates(QStringLiteral("1"), lat, lon));
+    QVERIFY(!KMLFileHelper::parseCoordinates(QStringLiteral("1,2,"), lat, lon));
+    QVERIFY(!KMLFileHelper::parseCoordinates(QStringLiteral("1,2,3,4"), lat, lon));
+    QVERIFY(!KMLFileHelper::parseCoordinates(QStringLiteral("1,,2"), lat, lon));
+    QVERIFY(!KMLFileHelper::parseCoordinates(QStringLiteral("a,b"), lat, lon));
+    QVERIFY(!KMLFileHelper::parseCoordinates(QStringLiteral("1.2.3,4"), lat, lon));
+}
+
+void KMLFileHelperTest::_testKMZLoad(void)
+{
+#ifndef QGC_ENABLE_KMZ
+    QSKIP("KMZ support not built");
+#else
+    QFile kmlFile(QStringLiteral(":/unittest/PolygonGood.kml"));
+    QVERIFY(kmlFile.open(QIODevice::ReadOnly));
+
+    QTemporaryFile kmzFile(QDir::tempPath() + QStringLiteral("/XXXXXX.kmz"));
+    QVERIFY(kmzFile.open());
+    {
+        QZipWriter zip(&kmzFile);
+        zip.addFile(QStringLiteral("files/icon.png"), QByteArray("not really an image"));
+        zip.addFile(QStringLiteral("doc.kml"), kmlFile.readAll());
+        zip.close();
+    }
+    kmzFile.close();
+
+    QList<QGeoCoordinate>   vertices;
+    QString                 errorString;
+
+    QCOMPARE(KMLFileHelper::determineFileContents(kmzFile.fileName(), errorString), KMLFileHelper::Polygon);
+    QVERIFY(KMLFileHelper::loadPolygonFromFile(kmzFile.fileName(), vertices, errorString));
+    QCOMPARE(vertices.count(), 4);
+
+    // A zip without a KML document
+    QTemporaryFile emptyKmzFile(QDir::tempPath() + QStringLiteral("/XXXXXX.kmz"));
+    QVERIFY(emptyKmzFile.open());
+    {
+        QZipWriter zip(&emptyKmzFile);
+        zip.addFile(QStringLiteral("readme.txt"), QByteArray("nothing here"));
+        zip.close();
+    }
+    emptyKmzFile.close();
+    QVERIFY(!KMLFileHelper::loadPolygonFromFile(emptyKmzFile.fileName(), vertices, errorString));
+    QVERIFY(!errorString.isEmpty());
+#endif
+}
+
+void KMLFileHelperTest::_testSimplify(void)
+{
+    // A straight line about 1km long with points wobbling by up to 1 meter, plus a 50 meter bump in the middle
+    const int       count = 1001;
+    QVector<double> lat, lon;
+    for (int i=0; i<count; i++) {
+        double wobble = ((i % 2) ? 1.0 : -1.0) / 111320.0;
+        double bump = i == count / 2 ? 50.0 / 111320.0 : 0;
+        lat.append(47.0 + wobble + bump);
+        lon.append(8.0 + i * 0.00001316);
+    }
+
+    QVector<double> simplifiedLat = lat, simplifiedLon = lon;
+    KMLFileHelper::simplify(simplifiedLat, simplifiedLon, 0);
+    QCOMPARE(simplifiedLat.count(), count);
+
+    KMLFileHelper::simplify(simplifiedLat, simplifiedLon, 5.0);
+    QCOMPARE(simplifiedLat.count(), simplifiedLon.count());
+    QVERIFY(simplifiedLat.count() < 10);
+    QCOMPARE(simplifiedLat.first(), lat.first());
+    QCOMPARE(simplifiedLat.last(), lat.last());
+    QVERIFY(simplifiedLat.contains(lat[count / 2]));
+
+    // Tolerance below the wobble keeps far more
+    simplifiedLat = lat;
+    simplifiedLon = lon;
+    KMLFileHelper::simplify(simplifiedLat, simplifiedLon, 0.5);
+    QVERIFY(simplifiedLat.count() > count / 2);
+}
+
+qint64 KMLFileHelperTest::_peakResidentBytes(void)
+{
+#if defined(Q_OS_LINUX)
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly)) {
+        foreach (const QByteArray& line, status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ')[0].toLongLong() * 1024;
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+void KMLFileHelperTest::_writeLargePolygon(QTemporaryFile& file)
+{
+    // A circle of about 10km radius
+    QByteArray coordinates;
+    coordinates.reserve(_cLargeVertexCount * 40);
+    for (int i=0; i<_cLargeVertexCount; i++) {
+        double angle = 2.0 * M_PI * i / _cLargeVertexCount;
+        coordinates += QByteArray::number(8.5 + 0.13 * qCos(angle), 'f', 12);
+        coordinates += ',';
+        coordinates += QByteArray::number(47.4 + 0.09 * qSin(angle), 'f', 12);
+        coordinates += ",0 ";
+    }
+    _writeKML(file, true /* polygon */, coordinates);
+}
+
+void KMLFileHelperTest::_benchmarkLargeImport(void)
+{
+    // Baseline before the file is generated, the coordinates buffer alone is about 40MB
+    qint64 startPeakBytes = _peakResidentBytes();
+
+    QTemporaryFile file;
+    _writeLargePolygon(file);
+
+    QList<QGeoCoordinate>   vertices;
+    QString                 errorString;
+
+    QBENCHMARK {
+        QVERIFY(KMLFileHelper::loadPolygonFromFile(file.fileName(), vertices, errorString));
+    }
+    QCOMPARE(vertices.count(), _cLargeVertexCount);
+
+    // Generating the file plus the import of a million vertices, a DOM based import needs several hundred MB on its own
+    if (startPeakBytes >= 0) {
+        QVERIFY(_peakResidentBytes() - startPeakBytes < 256 * 1024 * 1024);
+    }
+}
+
+void KMLFileHelperTest::_benchmarkLargeImportSimplified(void)
+{
+    QTemporaryFile file;
+    _writeLargePolygon(file);
+
+    QList<QGeoCoordinate>   vertices;
+    QString                 errorString;
+
+    QBENCHMARK {
+        QVERIFY(KMLFileHelper::loadPolygonFromFile(file.fileName(), vertices, errorString, _cImportSimplifyTolerance));
+    }
+
+    // Vertices are 6cm apart, at a 5cm tolerance a 10km circle needs a vertex about every 60m
+    QVERIFY(vertices.count() > 500);
+    QVERIFY(vertices.count() < _cLargeVertexCount / 100);
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QTemporaryFile;
+
+/// Unit test for KMLFileHelper streaming import
+class KMLFileHelperTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testPolygonLoad(void);
+    void _testPolylineLoad(void);
+    void _testParseCoordinates(void);
+    void _testKMZLoad(void);
+    void _testSimplify(void);
+    void _benchmarkLargeImport(void);
+    void _benchmarkLargeImportSimplified(void);
+
+private:
+    /// Writes a KML file with a polygon or polyline holding the given coordinates text
+    void _writeKML(QTemporaryFile& file, bool polygon, const QByteArray& coordinates);
+
+    /// Writes a KML file with a polygon of _cLargeVertexCount vertices
+    void _writeLargePolygon(QTemporaryFile& file);
+
+    /// @return Peak resident memory in bytes, -1 if not available
+    static qint64 _peakResidentBytes(void);
+
+    static const int _cLargeVertexCount = 1000000;
+
+    /// Tolerance in meters for the simplified import, well below GPS accuracy
+    static const double _cImportSimplifyTolerance;
+};
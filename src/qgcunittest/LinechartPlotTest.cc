@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinechartPlotTest.h"
+#include "LinechartPlot.h"
+
+#include <float.h>
+
+LinechartPlotTest::LinechartPlotTest(void)
+{
+
+}
+
+// Deterministic signal with spikes so min/max decimation has something to find
+static double _sampleValue(int field, quint64 i)
+{
+    double v = qSin((i + field * 7) * 0.01) * 10.0;
+    if (i % 997 == 0) {
+        v += 100.0;
+    }
+    if (i % 991 == 0) {
+        v -= 100.0;
+    }
+    return v;
+}
+
+void LinechartPlotTest::_testRingCapacity(void)
+{
+    TimeSeriesData series(NULL, "test", 0, 1000);
+
+    // Capacity is rounded up to a power of 2
+    QCOMPARE(series.getCapacity(), 1024);
+
+    for (int i = 0; i < 3000; i++) {
+        series.append(i, i);
+    }
+
+    QCOMPARE(series.getCount(), 1024);
+    QCOMPARE(series.getTotalCount(), (quint64)3000);
+    QCOMPARE(series.getX(0), 3000.0 - 1024.0);
+    QCOMPARE(series.getY(1023), 2999.0);
+    QCOMPARE(series.getCurrentValue(), 2999.0);
+}
+
+void LinechartPlotTest::_testStatistics(void)
+{
+    const int cWindow = 50;
+    TimeSeriesData series(NULL, "test", 0, 4096);
+    series.setAverageWindowSize(cWindow);
+
+    QVector<double> values;
+    for (int i = 0; i < 5000; i++) {
+        double v = _sampleValue(0, i);
+        values.append(v);
+        series.append(i, v);
+    }
+
+    double sum = 0;
+    for (int i = values.count() - cWindow; i < values.count(); i++) {
+        sum += values[i];
+    }
+    double mean = sum / cWindow;
+    double variance = 0;
+    for (int i = values.count() - cWindow; i < values.count(); i++) {
+        variance += (values[i] - mean) * (values[i] - mean);
+    }
+    variance /= cWindow;
+
+    QVERIFY(qAbs(series.getMean() - mean) < 1e-6);
+    QVERIFY(qAbs(series.getVariance() - variance) < 1e-6);
+}
+
+void LinechartPlotTest::_testDecimation(void)
+{
+    const int cSamples = 20000;
+    const int cPixels = 300;
+
+    TimeSeriesData series(NULL, "test", 0, 1 << 14);
+    for (int i = 0; i < cSamples; i++) {
+        series.append(i * 20, _sampleValue(0, i));
+    }
+
+    // Sparse range returns raw samples including the sample before the left edge
+    QVector<QPointF> points;
+    series.decimate(series.getX(100), series.getX(110), cPixels, points);
+    QCOMPARE(points.count(), 12);
+    QCOMPARE(points.first().x(), series.getX(99));
+    QCOMPARE(points.last().x(), series.getX(110));
+
+    // Full range is bounded by the pixel count and must preserve every extreme
+    series.decimate(series.getX(0), series.getX(series.getCount() - 1), cPixels, points);
+    QVERIFY(points.count() <= 2 * cPixels);
+
+    double expectedMin = DBL_MAX;
+    double expectedMax = -DBL_MAX;
+    for (int i = 0; i < series.getCount(); i++) {
+        expectedMin = qMin(expectedMin, series.getY(i));
+        expectedMax = qMax(expectedMax, series.getY(i));
+    }
+    double min = DBL_MAX;
+    double max = -DBL_MAX;
+    for (int i = 0; i < points.count(); i++) {
+        min = qMin(min, points[i].y());
+        max = qMax(max, points[i].y());
+    }
+    QCOMPARE(min, expectedMin);
+    QCOMPARE(max, expectedMax);
+
+    // Each column envelope must match a brute force scan of the same samples
+    int n = series.getCount();
+    for (int column = 0; column < cPixels; column++) {
+        int first = (n * column) / cPixels;
+        int last = (n * (column + 1)) / cPixels;
+        double columnMin = DBL_MAX;
+        double columnMax = -DBL_MAX;
+        for (int i = first; i < last; i++) {
+            columnMin = qMin(columnMin, series.getY(i));
+            columnMax = qMax(columnMax, series.getY(i));
+        }
+        QCOMPARE(points[column * 2].y(), columnMin);
+        QCOMPARE(points[column * 2 + 1].y(), columnMax);
+    }
+}
+
+void LinechartPlotTest::_testSeriesIds(void)
+{
+    LinechartPlot plot;
+
+    QVERIFY(!plot.appendData(-1, 0, 1.0));
+    QVERIFY(!plot.appendData(0, 0, 1.0));
+
+    int seriesId = plot.getSeriesId("a");
+    QCOMPARE(plot.getSeriesId("a"), seriesId);
+    QVERIFY(plot.getSeriesId("b") != seriesId);
+
+    QVERIFY(plot.appendData(seriesId, 10, 1.0));
+    QVERIFY(plot.appendData(seriesId, 20, 3.0));
+    QCOMPARE(plot.getMean("a"), 2.0);
+
+    // Ids of removed curves fail and are never handed out again
+    plot.removeSeries("a");
+    QVERIFY(!plot.appendData(seriesId, 30, 1.0));
+    int newSeriesId = plot.getSeriesId("a");
+    QVERIFY(newSeriesId != seriesId);
+    QVERIFY(plot.appendData(newSeriesId, 30, 5.0));
+    QCOMPARE(plot.getMean("a"), 5.0);
+
+    plot.removeAllData();
+    QVERIFY(!plot.appendData(newSeriesId, 40, 1.0));
+}
+
+// Replays a high rate telemetry stream: 50 fields at 50 Hz, one minute per benchmark iteration
+void LinechartPlotTest::_benchmarkReplayAppend(void)
+{
+    const int cFields = 50;
+    const int cRateHz = 50;
+    const int cSeconds = 60;
+
+    QVector<TimeSeriesData*> series;
+    for (int field = 0; field < cFields; field++) {
+        series.append(new TimeSeriesData(NULL, QString("field%1").arg(field)));
+    }
+
+    quint64 sample = 0;
+    QBENCHMARK {
+        for (int i = 0; i < cRateHz * cSeconds; i++, sample++) {
+            quint64 ms = sample * (1000 / cRateHz);
+            for (int field = 0; field < cFields; field++) {
+                series[field]->append(ms, _sampleValue(field, sample));
+            }
+        }
+    }
+
+    qDeleteAll(series);
+}
+
+// Redraw of a full ring of data to a typical canvas width, cost should be independent of the sample count
+void LinechartPlotTest::_benchmarkRedraw(void)
+{
+    TimeSeriesData series(NULL, "test");
+    for (int i = 0; i < series.getCapacity() * 2; i++) {
+        series.append(i * 20, _sampleValue(0, i));
+    }
+
+    QVector<QPointF> points;
+    double minTime = series.getX(0);
+    double maxTime = series.getX(series.getCount() - 1);
+    QBENCHMARK {
+        series.decimate(minTime, maxTime, 1920, points);
+    }
+    QVERIFY(points.count() <= 2 * 1920);
+}
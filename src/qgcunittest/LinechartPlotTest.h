@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TimeSeriesData ring storage and min/max decimation
+class LinechartPlotTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LinechartPlotTest(void);
+
+private slots:
+    void _testRingCapacity(void);
+    void _testStatistics(void);
+    void _testDecimation(void);
+    void _testSeriesIds(void);
+    void _benchmarkReplayAppend(void);
+    void _benchmarkRedraw(void);
+};
@@ -0,0 +1,66 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkMetricsTest.h"
+#include "LinkMetricsFactGroup.h"
+
+#include <QSignalSpy>
+
+void LinkMetricsTest::_testCounters(void)
+{
+    LinkMetricsFactGroup metrics(QStringLiteral("Test"));
+    QSignalSpy spy(metrics.bytesIn(), SIGNAL(rawValueChanged(QVariant)));
+
+    metrics.receiveQueued(100);
+    metrics.receiveQueued(50);
+    metrics.received(100, 3, 1000);
+    metrics.lost(2);
+    metrics.sendQueued(20);
+    metrics.sendQueued(30);
+    metrics.sent(20);
+
+    QVERIFY(spy.wait(2000));
+
+    QCOMPARE(metrics.bytesIn()->rawValue().toULongLong(),         (qulonglong)100);
+    QCOMPARE(metrics.bytesOut()->rawValue().toULongLong(),        (qulonglong)20);
+    QCOMPARE(metrics.messagesLost()->rawValue().toULongLong(),    (qulonglong)2);
+    QCOMPARE(metrics.receiveBacklog()->rawValue().toLongLong(),   (qlonglong)50);
+    QCOMPARE(metrics.sendBacklog()->rawValue().toLongLong(),      (qlonglong)30);
+    QVERIFY(metrics.bytesInRate()->rawValue().toDouble() > 0);
+    QVERIFY(metrics.messagesOutRate()->rawValue().toDouble() > 0);
+
+    // No round trip measured yet
+    QVERIFY(qIsNaN(metrics.rtt()->rawValue().toDouble()));
+}
+
+void LinkMetricsTest::_testRoundTrip(void)
+{
+    LinkMetricsFactGroup metrics(QStringLiteral("Test"));
+    QSignalSpy spy(&metrics, SIGNAL(rttHistogramChanged()));
+
+    QCOMPARE(metrics.rttBucketLimits().count(), LinkMetricsFactGroup::_cRttBuckets - 1);
+
+    // 21 samples: the 95th percentile is the 20th sample, which lands in the 25-50 msec bucket
+    for (int i=0; i<19; i++) {
+        metrics.roundTrip(5000);
+    }
+    metrics.roundTrip(2000000);
+    metrics.roundTrip(30000);
+
+    QVERIFY(spy.wait(2000));
+
+    QVariantList histogram = metrics.rttHistogram();
+    QCOMPARE(histogram.count(), (int)LinkMetricsFactGroup::_cRttBuckets);
+    QCOMPARE(histogram[0].toInt(), 19);
+    QCOMPARE(histogram[2].toInt(), 1);
+    QCOMPARE(histogram[LinkMetricsFactGroup::_cRttBuckets - 1].toInt(), 1);
+
+    QCOMPARE(metrics.rtt()->rawValue().toDouble(), 30.0);
+    QCOMPARE(metrics.rttP95()->rawValue().toDouble(), 50.0);
+}
@@ -0,0 +1,22 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for LinkMetricsFactGroup counters, backlogs and round trip histogram
+class LinkMetricsTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testCounters(void);
+    void _testRoundTrip(void);
+};
@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkSwarmTest.h"
+#include "MockLink.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+
+void MockLinkSwarmTest::_waitForVehicles(int vehicleCount)
+{
+    MultiVehicleManager* vehicleManager = qgcApp()->toolbox()->multiVehicleManager();
+
+    for (int i=0; i<100 && vehicleManager->vehicles()->count() < vehicleCount; i++) {
+        QTest::qWait(100);
+    }
+    QCOMPARE(vehicleManager->vehicles()->count(), vehicleCount);
+}
+
+void MockLinkSwarmTest::_testSwarmVehicles(void)
+{
+    const int vehicleCount = 3;
+
+    _mockLink = MockLink::startSwarmMockLink(vehicleCount, MockConfiguration::RateProfileTelemetryRadio, false);
+    QVERIFY(_mockLink);
+
+    // Every vehicle on the link shows up as a Vehicle of its own
+    QList<int> vehicleIds = _mockLink->vehicleIds();
+    QCOMPARE(vehicleIds.count(), vehicleCount);
+    _waitForVehicles(vehicleCount);
+    foreach (int vehicleId, vehicleIds) {
+        QVERIFY(qgcApp()->toolbox()->multiVehicleManager()->getVehicleById(vehicleId));
+    }
+
+    // Vehicles have sequence numbers of their own, so sharing the link doesn't look like loss
+    QTest::qWait(2500);
+    LinkMetricsFactGroup* metrics = _mockLink->metrics();
+    QVERIFY(metrics->messagesInRate()->rawValue().toDouble() > 0);
+    QCOMPARE(metrics->messagesLost()->rawValue().toULongLong(), (qulonglong)0);
+}
+
+void MockLinkSwarmTest::_testPacketLoss(void)
+{
+    const int vehicleCount = 2;
+
+    _mockLink = MockLink::startSwarmMockLink(vehicleCount, MockConfiguration::RateProfileOnboard, false, 20 /* packetLossPercent */);
+    QVERIFY(_mockLink);
+    _waitForVehicles(vehicleCount);
+
+    QTest::qWait(2500);
+    QVERIFY(_mockLink->metrics()->messagesLost()->rawValue().toULongLong() > 0);
+}
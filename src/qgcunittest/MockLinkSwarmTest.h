@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for MockLink carrying a swarm of vehicles
+class MockLinkSwarmTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testSwarmVehicles(void);
+    void _testPacketLoss(void);
+
+private:
+    void _waitForVehicles(int vehicleCount);
+};
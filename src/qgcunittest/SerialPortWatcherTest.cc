@@ -0,0 +1,229 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SerialPortWatcherTest.h"
+#include "SerialPortWatcher.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+int SerialPortWatcherTest::_openPty(const QString& linkPath)
+{
+#ifdef Q_OS_LINUX
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd == -1) {
+        return -1;
+    }
+    if (grantpt(fd) == -1 || unlockpt(fd) == -1 || !ptsname(fd) || !QFile::link(QString::fromLocal8Bit(ptsname(fd)), linkPath)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    Q_UNUSED(linkPath);
+    return -1;
+#endif
+}
+
+void SerialPortWatcherTest::_testInitialScan(void)
+{
+#ifdef Q_OS_LINUX
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QString portPath = dir.path() + QStringLiteral("/ttyQGC0");
+    int fd = _openPty(portPath);
+    QVERIFY(fd != -1);
+
+    SerialPortWatcher watcher;
+    QSignalSpy addedSpy(&watcher, &SerialPortWatcher::portAdded);
+    watcher.start(dir.path());
+
+    QVERIFY(addedSpy.wait(2000));
+    QCOMPARE(addedSpy.count(), 1);
+    QVERIFY(watcher.contains(portPath));
+    QCOMPARE(watcher.ports()[portPath].portName, QStringLiteral("ttyQGC0"));
+    QCOMPARE(watcher.ports()[portPath].boardType, QGCSerialPortInfo::BoardTypeUnknown);
+
+    // Nothing changes, so nothing more is reported
+    QTest::qWait(SerialPortWatcher::followUpScanMSecs);
+    QCOMPARE(addedSpy.count(), 1);
+
+    close(fd);
+#else
+    QSKIP("Pseudo terminals are only set up on Linux");
+#endif
+}
+
+void SerialPortWatcherTest::_measureLatency(bool forcePolling, qint64& addMSecs, qint64& removeMSecs)
+{
+    addMSecs = removeMSecs = -1;
+
+#ifdef Q_OS_LINUX
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    SerialPortWatcher watcher;
+    QSignalSpy addedSpy(&watcher, &SerialPortWatcher::portAdded);
+    QSignalSpy removedSpy(&watcher, &SerialPortWatcher::portRemoved);
+    watcher.start(dir.path(), forcePolling);
+
+    // Let the initial scan of the empty directory go by
+    QTest::qWait(SerialPortWatcher::settleMSecs);
+    QCOMPARE(addedSpy.count(), 0);
+
+    QElapsedTimer latencyTimer;
+    QString portPath = dir.path() + QStringLiteral("/ttyQGC1");
+
+    latencyTimer.start();
+    int fd = _openPty(portPath);
+    QVERIFY(fd != -1);
+    QVERIFY(addedSpy.wait(SerialPortWatcher::pollIntervalMSecs * 3));
+    addMSecs = latencyTimer.elapsed();
+    QVERIFY(watcher.contains(portPath));
+
+    latencyTimer.start();
+    QVERIFY(QFile::remove(portPath));
+    QVERIFY(removedSpy.wait(SerialPortWatcher::pollIntervalMSecs * 3));
+    removeMSecs = latencyTimer.elapsed();
+    QCOMPARE(removedSpy[0][0].toString(), portPath);
+    QVERIFY(!watcher.contains(portPath));
+
+    close(fd);
+#else
+    Q_UNUSED(forcePolling);
+#endif
+}
+
+void SerialPortWatcherTest::_testHotplugLatency(void)
+{
+#ifdef Q_OS_LINUX
+    qint64 addMSecs, removeMSecs;
+    _measureLatency(false /* forcePolling */, addMSecs, removeMSecs);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    // Well under a polling interval, only the settle delay stands between the event and the notification
+    QVERIFY(addMSecs < SerialPortWatcher::pollIntervalMSecs / 2);
+    QVERIFY(removeMSecs < SerialPortWatcher::pollIntervalMSecs / 2);
+#else
+    QSKIP("Pseudo terminals are only set up on Linux");
+#endif
+}
+
+void SerialPortWatcherTest::_testPollingLatency(void)
+{
+#ifdef Q_OS_LINUX
+    qint64 addMSecs, removeMSecs;
+    _measureLatency(true /* forcePolling */, addMSecs, removeMSecs);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QVERIFY(addMSecs <= SerialPortWatcher::pollIntervalMSecs * 2);
+    QVERIFY(removeMSecs <= SerialPortWatcher::pollIntervalMSecs * 2);
+#else
+    QSKIP("Pseudo terminals are only set up on Linux");
+#endif
+}
+
+void SerialPortWatcherTest::_testSystemPorts(void)
+{
+    // Same enumeration and board identification as the watcher does on its thread
+    QMap<QString, SerialPortWatcher::PortInfo_t> expectedPorts;
+    foreach (const QGCSerialPortInfo& portInfo, QGCSerialPortInfo::availablePorts()) {
+        SerialPortWatcher::PortInfo_t port;
+        port.knownBoard = portInfo.getBoardInfo(port.boardType, port.boardName);
+        port.bootloader = port.knownBoard && portInfo.isBootloader();
+        expectedPorts[portInfo.systemLocation()] = port;
+    }
+
+    SerialPortWatcher watcher;
+    watcher.start(QString(), true /* forcePolling */);
+
+    QTRY_COMPARE_WITH_TIMEOUT(watcher.ports().count(), expectedPorts.count(), SerialPortWatcher::pollIntervalMSecs * 2);
+    foreach (const QString& systemLocation, expectedPorts.keys()) {
+        QVERIFY(watcher.contains(systemLocation));
+
+        const SerialPortWatcher::PortInfo_t& port = watcher.ports()[systemLocation];
+        QCOMPARE(port.systemLocation, systemLocation);
+        QCOMPARE(port.portName, port.portInfo.portName());
+        QCOMPARE(port.knownBoard, expectedPorts[systemLocation].knownBoard);
+        QCOMPARE(port.boardType, expectedPorts[systemLocation].boardType);
+        QCOMPARE(port.boardName, expectedPorts[systemLocation].boardName);
+        QCOMPARE(port.bootloader, expectedPorts[systemLocation].bootloader);
+    }
+
+    // Board identification of a port without a usb device behind it
+    QGCSerialPortInfo::BoardType_t boardType;
+    QString boardName;
+    QVERIFY(!QGCSerialPortInfo().getBoardInfo(boardType, boardName));
+}
+
+void SerialPortWatcherTest::_testBootloaderReenumeration(void)
+{
+    SerialPortWatcherWorker worker;
+
+    QStringList events;
+    QList<SerialPortWatcher::PortInfo_t> addedPorts;
+    connect(&worker, &SerialPortWatcherWorker::portAdded, [&events, &addedPorts](const SerialPortWatcher::PortInfo_t& port) {
+        events.append(QStringLiteral("added ") + port.systemLocation);
+        addedPorts.append(port);
+    });
+    connect(&worker, &SerialPortWatcherWorker::portRemoved, [&events](const QString& systemLocation) {
+        events.append(QStringLiteral("removed ") + systemLocation);
+    });
+
+    SerialPortWatcher::PortInfo_t bootloader;
+    bootloader.systemLocation = QStringLiteral("/dev/ttyACM0");
+    bootloader.portName =       QStringLiteral("ttyACM0");
+    bootloader.boardType =      QGCSerialPortInfo::BoardTypePixhawk;
+    bootloader.boardName =      QStringLiteral("PX4 FMU v2.x");
+    bootloader.knownBoard =     true;
+    bootloader.bootloader =     true;
+
+    SerialPortWatcher::PortInfo_t application = bootloader;
+    application.bootloader = false;
+
+    SerialPortWatcher::PortInfo_t radio;
+    radio.systemLocation =  QStringLiteral("/dev/ttyUSB0");
+    radio.portName =        QStringLiteral("ttyUSB0");
+    radio.boardType =       QGCSerialPortInfo::BoardTypeSiKRadio;
+    radio.boardName =       QStringLiteral("SiK Radio");
+    radio.knownBoard =      true;
+
+    // Board plugged in, comes up in its bootloader next to a radio
+    worker._updatePorts(QList<SerialPortWatcher::PortInfo_t>() << bootloader << radio);
+    QCOMPARE(events, QStringList() << QStringLiteral("added /dev/ttyACM0") << QStringLiteral("added /dev/ttyUSB0"));
+    QVERIFY(addedPorts[0].bootloader);
+
+    // Nothing changed
+    events.clear();
+    addedPorts.clear();
+    worker._updatePorts(QList<SerialPortWatcher::PortInfo_t>() << bootloader << radio);
+    QCOMPARE(events, QStringList());
+
+    // Bootloader hands over to the application on the same device node, the radio stays as is
+    worker._updatePorts(QList<SerialPortWatcher::PortInfo_t>() << application << radio);
+    QCOMPARE(events, QStringList() << QStringLiteral("removed /dev/ttyACM0") << QStringLiteral("added /dev/ttyACM0"));
+    QCOMPARE(addedPorts.count(), 1);
+    QVERIFY(!addedPorts[0].bootloader);
+    QCOMPARE(addedPorts[0].boardType, QGCSerialPortInfo::BoardTypePixhawk);
+
+    // Board unplugged
+    events.clear();
+    worker._updatePorts(QList<SerialPortWatcher::PortInfo_t>() << radio);
+    QCOMPARE(events, QStringList() << QStringLiteral("removed /dev/ttyACM0"));
+}
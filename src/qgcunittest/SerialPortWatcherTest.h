@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class SerialPortWatcher;
+
+/// Unit test for SerialPortWatcher, uses pseudo terminals linked into a temporary directory as the serial ports. The
+/// system port enumeration and board identification are checked against QGCSerialPortInfo directly.
+class SerialPortWatcherTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testInitialScan(void);
+    void _testHotplugLatency(void);
+    void _testPollingLatency(void);
+    void _testSystemPorts(void);
+    void _testBootloaderReenumeration(void);
+
+private:
+    /// Plugs a port into the watched directory and pulls it again, timing how long the watcher takes to notice
+    ///     @param[out] addMSecs Time to portAdded
+    ///     @param[out] removeMSecs Time to portRemoved
+    void _measureLatency(bool forcePolling, qint64& addMSecs, qint64& removeMSecs);
+
+    /// Opens a pseudo terminal and links its slave side into the directory
+    ///     @return Master file descriptor, -1 on failure
+    static int _openPty(const QString& linkPath);
+};
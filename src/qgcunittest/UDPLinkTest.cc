@@ -0,0 +1,314 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "UDPLinkTest.h"
+#include "MAVLinkProtocol.h"
+
+#include <QSignalSpy>
+#include <QUdpSocket>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QTimer>
+#include <QSharedPointer>
+
+#include <functional>
+
+namespace {
+
+/// Floods a port from a number of sockets, each standing in for a vehicle. Each peer fills its datagrams with its own
+/// letter, starting at 'a'.
+class UDPFloodGenerator : public QThread
+{
+public:
+    UDPFloodGenerator(quint16 port, int peerCount, int datagramCount, int datagramBytes)
+        : _port         (port)
+        , _peerCount    (peerCount)
+        , _datagramCount(datagramCount)
+        , _datagramBytes(datagramBytes)
+    { }
+
+protected:
+    void run(void) override
+    {
+        QList<QUdpSocket*> peers;
+        for (int i=0; i<_peerCount; i++) {
+            QUdpSocket* peer = new QUdpSocket;
+            peer->bind(QHostAddress::LocalHost, 0);
+            peers.append(peer);
+        }
+
+        for (int i=0; i<_datagramCount; i++) {
+            if (i > 0 && i % _cBurstDatagrams == 0) {
+                QThread::msleep(2);
+            }
+            int peer = i % _peerCount;
+            peers[peer]->writeDatagram(QByteArray(_datagramBytes, static_cast<char>('a' + peer)), QHostAddress::LocalHost, _port);
+        }
+
+        qDeleteAll(peers);
+    }
+
+private:
+    quint16 _port;
+    int     _peerCount;
+    int     _datagramCount;
+    int     _datagramBytes;
+
+    static const int _cBurstDatagrams = 16;
+};
+
+}
+
+UDPLinkTest::UDPLinkTest(void)
+    : _link(NULL)
+{
+
+}
+
+void UDPLinkTest::init(void)
+{
+    UnitTest::init();
+
+    UDPConfiguration* udpConfig = new UDPConfiguration("MockUDP");
+    udpConfig->setLocalPort(_linkPort);
+    _sharedConfig = SharedLinkConfigurationPointer(udpConfig);
+    _link = new UDPLink(_sharedConfig);
+}
+
+void UDPLinkTest::cleanup(void)
+{
+    delete _link;
+    _link = NULL;
+
+    _sharedConfig.clear();
+
+    UnitTest::cleanup();
+}
+
+void UDPLinkTest::_connectLink(void)
+{
+    QSignalSpy connectedSpy(_link, SIGNAL(connected()));
+    QCOMPARE(_link->_connect(), true);
+    QVERIFY(connectedSpy.wait(1000));
+}
+
+QByteArray UDPLinkTest::_waitForBytes(QSignalSpy& spy, int byteCount)
+{
+    QByteArray bytes;
+    QElapsedTimer timeout;
+
+    timeout.start();
+    while (bytes.count() < byteCount && timeout.elapsed() < 2000) {
+        if (spy.isEmpty()) {
+            spy.wait(100);
+        }
+        while (!spy.isEmpty()) {
+            bytes.append(spy.takeFirst().at(1).toByteArray());
+        }
+    }
+
+    return bytes;
+}
+
+void UDPLinkTest::_datagramBoundaries_test(void)
+{
+    _connectLink();
+
+    QSignalSpy bytesSpy(_link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)));
+    QUdpSocket peer;
+    QVERIFY(peer.bind(QHostAddress::LocalHost, 0));
+
+    // Datagrams come through whole and in order, an oversized datagram is dropped rather than handed on in part
+    QByteArray datagram1(1, '1');
+    QByteArray datagram2(100, '2');
+    QByteArray oversized(UDPLink::_cMaxDatagramBytes + 1, 'o');
+    QByteArray datagram3(1000, '3');
+    peer.writeDatagram(datagram1, QHostAddress::LocalHost, _linkPort);
+    peer.writeDatagram(datagram2, QHostAddress::LocalHost, _linkPort);
+    peer.writeDatagram(oversized, QHostAddress::LocalHost, _linkPort);
+    peer.writeDatagram(datagram3, QHostAddress::LocalHost, _linkPort);
+
+    QByteArray expected = datagram1 + datagram2 + datagram3;
+    QCOMPARE(_waitForBytes(bytesSpy, expected.count()), expected);
+
+    // Nothing else shows up
+    QVERIFY(!bytesSpy.wait(200));
+}
+
+void UDPLinkTest::_sessionTable_test(void)
+{
+    // Short enough to see a session go away within the test
+    _link->_sessionTimeoutMSecs = 300;
+    _connectLink();
+
+    QSignalSpy bytesSpy(_link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)));
+    QUdpSocket peer1;
+    QUdpSocket peer2;
+    QVERIFY(peer1.bind(QHostAddress::LocalHost, 0));
+    QVERIFY(peer2.bind(QHostAddress::LocalHost, 0));
+
+    // Hearing from a peer starts a session, outgoing bytes go to every session once
+    peer1.writeDatagram("1", QHostAddress::LocalHost, _linkPort);
+    peer2.writeDatagram("2", QHostAddress::LocalHost, _linkPort);
+    peer1.writeDatagram("1", QHostAddress::LocalHost, _linkPort);
+    QCOMPARE(_waitForBytes(bytesSpy, 3).count(), 3);
+
+    QByteArray bytesOut("out");
+    _link->writeBytesSafe(bytesOut.constData(), bytesOut.count());
+    foreach (QUdpSocket* peer, QList<QUdpSocket*>() << &peer1 << &peer2) {
+        QVERIFY(peer->waitForReadyRead(1000));
+        QByteArray datagram(static_cast<int>(peer->pendingDatagramSize()), 0);
+        peer->readDatagram(datagram.data(), datagram.size());
+        QCOMPARE(datagram, bytesOut);
+        QVERIFY(!peer->hasPendingDatagrams());
+    }
+
+    // Peer 2 goes quiet and times out, peer 1 keeps its session
+    QElapsedTimer quietTimer;
+    quietTimer.start();
+    while (quietTimer.elapsed() < _link->_sessionTimeoutMSecs + (UDPLink::_cSessionExpiryMSecs * 2)) {
+        peer1.writeDatagram("1", QHostAddress::LocalHost, _linkPort);
+        QTest::qWait(100);
+    }
+    bytesSpy.clear();
+
+    _link->writeBytesSafe(bytesOut.constData(), bytesOut.count());
+    QVERIFY(peer1.waitForReadyRead(1000));
+    QVERIFY(!peer2.waitForReadyRead(500));
+}
+
+void UDPLinkTest::_coalescedSend_test(void)
+{
+    _connectLink();
+
+    QSignalSpy bytesSpy(_link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)));
+    QUdpSocket peer;
+    QVERIFY(peer.bind(QHostAddress::LocalHost, 0));
+    peer.writeDatagram("1", QHostAddress::LocalHost, _linkPort);
+    QCOMPARE(_waitForBytes(bytesSpy, 1).count(), 1);
+
+    // Holds the link's thread while a burst is queued so that timing can't split the burst. The blocker runs as a
+    // functor on the link's thread, the semaphores are shared so neither thread can destroy them under the other.
+    auto queueBurst = [this](std::function<void()> writes) {
+        struct Blocker_t {
+            QSemaphore linkBlocked;
+            QSemaphore releaseLink;
+        };
+        QSharedPointer<Blocker_t> blocker(new Blocker_t);
+        QTimer::singleShot(0, _link, [blocker]() {
+            blocker->linkBlocked.release();
+            blocker->releaseLink.acquire();
+        });
+        blocker->linkBlocked.acquire();
+        writes();
+        blocker->releaseLink.release();
+    };
+
+    QByteArray bulk(280, 'b');
+    QByteArray rtcm(100, 'r');
+    QByteArray control(20, 'c');
+
+    // The burst goes out in the order it was queued, one datagram per message. The control message at the end
+    // doesn't overtake the bulk and RTCM messages queued before it.
+    queueBurst([this, &bulk, &rtcm, &control]() {
+        for (int i=0; i<6; i++) {
+            _link->writeBytesSafe(bulk.constData(), bulk.count(), LinkInterface::SendPriorityBulk);
+        }
+        _link->writeBytesSafe(rtcm.constData(), rtcm.count(), LinkInterface::SendPriorityRTCM);
+        _link->writeBytesSafe(control.constData(), control.count(), LinkInterface::SendPriorityControl);
+    });
+
+    QList<QByteArray> expected;
+    for (int i=0; i<6; i++) {
+        expected << bulk;
+    }
+    expected << rtcm << control;
+    foreach (const QByteArray& expectedDatagram, expected) {
+        if (!peer.hasPendingDatagrams()) {
+            QVERIFY(peer.waitForReadyRead(1000));
+        }
+        QByteArray datagram(static_cast<int>(peer.pendingDatagramSize()), 0);
+        peer.readDatagram(datagram.data(), datagram.size());
+        QCOMPARE(datagram, expectedDatagram);
+    }
+    QVERIFY(!peer.waitForReadyRead(200));
+
+    // Bulk messages on their own still go out in a single flush once the coalesce window is up
+    queueBurst([this, &bulk]() {
+        for (int i=0; i<3; i++) {
+            _link->writeBytesSafe(bulk.constData(), bulk.count(), LinkInterface::SendPriorityBulk);
+        }
+    });
+    for (int i=0; i<3; i++) {
+        if (!peer.hasPendingDatagrams()) {
+            QVERIFY(peer.waitForReadyRead(1000));
+        }
+        QByteArray datagram(static_cast<int>(peer.pendingDatagramSize()), 0);
+        peer.readDatagram(datagram.data(), datagram.size());
+        QCOMPARE(datagram, bulk);
+    }
+    QVERIFY(!peer.waitForReadyRead(200));
+}
+
+void UDPLinkTest::_flood_test(void)
+{
+    _connectLink();
+
+    const int peerCount =       8;
+    const int datagramCount =   800;
+    const int datagramBytes =   280;
+
+    QSignalSpy bytesSpy(_link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)));
+
+    // Sent in short bursts so the socket buffer never overflows, every datagram has to come through whole
+    UDPFloodGenerator generator(_linkPort, peerCount, datagramCount, datagramBytes);
+    generator.start();
+    QVERIFY(generator.wait(5000));
+
+    QByteArray bytes = _waitForBytes(bytesSpy, datagramCount * datagramBytes);
+    QCOMPARE(bytes.count(), datagramCount * datagramBytes);
+    for (int i=0; i<peerCount; i++) {
+        QCOMPARE(bytes.count(static_cast<char>('a' + i)), (datagramCount / peerCount) * datagramBytes);
+    }
+}
+
+void UDPLinkTest::_sendPriority_test(void)
+{
+    // Messages are packed over garbage so that reading past the end of a short payload shows up
+    mavlink_message_t message;
+
+    mavlink_param_set_t paramSet;
+    memset(&paramSet, 0, sizeof(paramSet));
+    paramSet.target_system = 1;
+    paramSet.param_value = 1.0f;
+    paramSet.param_type = MAV_PARAM_TYPE_REAL32;
+    strncpy(paramSet.param_id, "TEST_PARAM", sizeof(paramSet.param_id));
+    memset(&message, 0xff, sizeof(message));
+    mavlink_msg_param_set_encode_chan(255, 0, 0, &message, &paramSet);
+    QCOMPARE(MAVLinkProtocol::sendPriority(message), LinkInterface::SendPriorityBulk);
+
+    mavlink_mission_request_int_t missionRequest;
+    memset(&missionRequest, 0, sizeof(missionRequest));
+    missionRequest.target_system = 1;
+    missionRequest.seq = 3;
+    memset(&message, 0xff, sizeof(message));
+    mavlink_msg_mission_request_int_encode_chan(255, 0, 0, &message, &missionRequest);
+    QCOMPARE(MAVLinkProtocol::sendPriority(message), LinkInterface::SendPriorityBulk);
+
+    // A mission item is a flight command only when it is a guided mode goto
+    mavlink_mission_item_t missionItem;
+    memset(&missionItem, 0, sizeof(missionItem));
+    missionItem.target_system = 1;
+    missionItem.command = MAV_CMD_NAV_WAYPOINT;
+    mavlink_msg_mission_item_encode_chan(255, 0, 0, &message, &missionItem);
+    QCOMPARE(MAVLinkProtocol::sendPriority(message), LinkInterface::SendPriorityBulk);
+    missionItem.current = 2;
+    mavlink_msg_mission_item_encode_chan(255, 0, 0, &message, &missionItem);
+    QCOMPARE(MAVLinkProtocol::sendPriority(message), LinkInterface::SendPriorityControl);
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "UDPLink.h"
+
+/// Unit test for UDPLink receive batching, session table and coalesced sends, and the send priority of messages
+class UDPLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    UDPLinkTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _datagramBoundaries_test(void);
+    void _sessionTable_test(void);
+    void _coalescedSend_test(void);
+    void _flood_test(void);
+    void _sendPriority_test(void);
+
+private:
+    void _connectLink(void);
+
+    /// Waits for the link to signal the given number of bytes
+    ///     @return All bytes signalled, in order
+    QByteArray _waitForBytes(QSignalSpy& spy, int byteCount);
+
+    SharedLinkConfigurationPointer  _sharedConfig;
+    UDPLink*                        _link;
+
+    static const quint16 _linkPort = 24550;
+};
@@ -16,22 +16,31 @@
 #include "FileDialogTest.h"
 #include "FlightGearTest.h"
 #include "GeoTest.h"
+#include "KMLFileHelperTest.h"
 #include "LinkManagerTest.h"
+#include "LinkMetricsTest.h"
 #include "MessageBoxTest.h"
+#include "MockLinkSwarmTest.h"
 #include "MissionItemTest.h"
 #include "SimpleMissionItemTest.h"
 #include "SurveyComplexItemTest.h"
 #include "MissionControllerTest.h"
 #include "MissionManagerTest.h"
 #include "RadioConfigTest.h"
+#include "SerialPortWatcherTest.h"
 #include "MavlinkLogTest.h"
 #include "MainWindowTest.h"
 #include "FileManagerTest.h"
 #include "TCPLinkTest.h"
+#include "UDPLinkTest.h"
+#include "XPlaneLinkTest.h"
 #include "ParameterManagerTest.h"
 #include "MissionCommandTreeTest.h"
 #include "LogDownloadTest.h"
 #include "SendMavCommandTest.h"
+#include "MAVLinkMessageDispatcherTest.h"
+#include "TimesyncEstimatorTest.h"
+#include "VehicleStateServerTest.h"
 #include "VisualMissionItemTest.h"
 #include "CameraSectionTest.h"
 #include "SpeedSectionTest.h"
@@ -44,25 +53,46 @@
 #include "CorridorScanComplexItemTest.h"
 #include "TransectStyleComplexItemTest.h"
 #include "CameraCalcTest.h"
+#include "AppMessagesTest.h"
+#include "ParameterSearchIndexTest.h"
+#include "QGCTracerTest.h"
+#include "LinechartPlotTest.h"
+#include "VideoReceiverTest.h"
+#if defined(QGC_GST_STREAMING)
+#include "pidiscoverertest.h"
+#include "nodecommandqueuetest.h"
+#include "VideoReceiverPoolTest.h"
+#include "mjpegimagegrabbertest.h"
+#include "thermalkerneltest.h"
+#endif
 
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
 UT_REGISTER_TEST(FileDialogTest)
 UT_REGISTER_TEST(FlightGearUnitTest)
 UT_REGISTER_TEST(GeoTest)
+UT_REGISTER_TEST(KMLFileHelperTest)
 UT_REGISTER_TEST(LinkManagerTest)
+UT_REGISTER_TEST(LinkMetricsTest)
 UT_REGISTER_TEST(MessageBoxTest)
+UT_REGISTER_TEST(MockLinkSwarmTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
 UT_REGISTER_TEST(MissionControllerTest)
 UT_REGISTER_TEST(MissionManagerTest)
 UT_REGISTER_TEST(RadioConfigTest)
+UT_REGISTER_TEST(SerialPortWatcherTest)
 UT_REGISTER_TEST(TCPLinkTest)
+UT_REGISTER_TEST(UDPLinkTest)
+UT_REGISTER_TEST(XPlaneLinkTest)
 UT_REGISTER_TEST(FileManagerTest)
 UT_REGISTER_TEST(ParameterManagerTest)
 UT_REGISTER_TEST(MissionCommandTreeTest)
 UT_REGISTER_TEST(LogDownloadTest)
 UT_REGISTER_TEST(SendMavCommandTest)
+UT_REGISTER_TEST(MAVLinkMessageDispatcherTest)
+UT_REGISTER_TEST(TimesyncEstimatorTest)
+UT_REGISTER_TEST(VehicleStateServerTest)
 UT_REGISTER_TEST(SurveyComplexItemTest)
 UT_REGISTER_TEST(CameraSectionTest)
 UT_REGISTER_TEST(SpeedSectionTest)
@@ -75,6 +105,18 @@ UT_REGISTER_TEST(CorridorScanComplexItemTest)
 UT_REGISTER_TEST(TransectStyleComplexItemTest)
 UT_REGISTER_TEST(QGCMapPolylineTest)
 UT_REGISTER_TEST(CameraCalcTest)
+UT_REGISTER_TEST(AppMessagesTest)
+UT_REGISTER_TEST(ParameterSearchIndexTest)
+UT_REGISTER_TEST(QGCTracerTest)
+UT_REGISTER_TEST(LinechartPlotTest)
+UT_REGISTER_TEST(VideoReceiverTest)
+#if defined(QGC_GST_STREAMING)
+UT_REGISTER_TEST(PiDiscovererTest)
+UT_REGISTER_TEST(NodeCommandQueueTest)
+UT_REGISTER_TEST(VideoReceiverPoolTest)
+UT_REGISTER_TEST(MJPEGImageGrabberTest)
+UT_REGISTER_TEST(ThermalKernelTest)
+#endif
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
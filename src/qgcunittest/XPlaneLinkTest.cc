@@ -0,0 +1,261 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "XPlaneLinkTest.h"
+#include "MockLink.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+namespace {
+
+/// Builds an X-Plane DATA packet from the given segments
+QByteArray dataPacket(const QList<QPair<qint32, QVector<float>>>& segments)
+{
+    QByteArray packet("DATA@", 5);
+    foreach (const auto& segment, segments) {
+        float values[8] = { 0 };
+        for (int i=0; i<segment.second.count() && i<8; i++) {
+            values[i] = segment.second[i];
+        }
+        packet.append(reinterpret_cast<const char*>(&segment.first), sizeof(qint32));
+        packet.append(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+    return packet;
+}
+
+/// Sends X-Plane 10 DATA packets at a fixed rate, like X-Plane running with its UDP rate set to 250 Hz
+class XPlaneDataGenerator : public QThread
+{
+public:
+    XPlaneDataGenerator(quint16 port, int packetCount, int periodUsecs)
+        : _port         (port)
+        , _packetCount  (packetCount)
+        , _periodUsecs  (periodUsecs)
+    { }
+
+protected:
+    void run(void) override
+    {
+        QUdpSocket xplane;
+        xplane.bind(QHostAddress::LocalHost, 0);
+
+        QList<QPair<qint32, QVector<float>>> segments;
+        segments << qMakePair(3,  QVector<float>() << 0 << 0 << 0 << 0 << 0 << 40.0f << 41.0f << 40.0f);      // Speeds, knots
+        segments << qMakePair(4,  QVector<float>() << 0 << 0 << 0 << 0 << 1.0f << 0.01f << 0.02f);            // G loads
+        segments << qMakePair(6,  QVector<float>() << 29.92f << 15.0f);                                         // Pressure, inHg and temperature
+        segments << qMakePair(16, QVector<float>() << 0.01f << 0.02f << 0.03f);                                 // Angular velocities
+        segments << qMakePair(17, QVector<float>() << 2.0f << 1.0f << 90.0f << 92.0f);                          // Pitch, roll, headings
+        segments << qMakePair(20, QVector<float>() << 47.397742f << 8.545594f << 1600.0f << 100.0f);           // Lat, lon, alt ft, agl ft
+        segments << qMakePair(21, QVector<float>() << 0 << 0 << 0 << 20.0f << 1.0f << -1.0f);                  // Local velocities
+        QByteArray packet = dataPacket(segments);
+
+        QElapsedTimer clock;
+        clock.start();
+        for (int i=0; i<_packetCount; i++) {
+            qint64 dueUsecs = static_cast<qint64>(i) * _periodUsecs;
+            qint64 nowUsecs = clock.nsecsElapsed() / 1000;
+            if (dueUsecs > nowUsecs) {
+                QThread::usleep(dueUsecs - nowUsecs);
+            }
+            xplane.writeDatagram(packet, QHostAddress::LocalHost, _port);
+        }
+    }
+
+private:
+    quint16 _port;
+    int     _packetCount;
+    int     _periodUsecs;
+};
+
+}
+
+XPlaneLinkTest::XPlaneLinkTest(void)
+    : _xplane   (NULL)
+    , _standIn  (NULL)
+{
+
+}
+
+void XPlaneLinkTest::init(void)
+{
+    UnitTest::init();
+
+    _connectMockLink();
+
+    _standIn = new QUdpSocket(this);
+    QVERIFY(_standIn->bind(QHostAddress::LocalHost, _standInPort));
+
+    _xplane = new QGCXPlaneLink(_vehicle, QString("127.0.0.1:%1").arg(_standInPort), QHostAddress::LocalHost, _bridgePort);
+
+    // Settings from a previous run may have changed these
+    _xplane->setRemoteHost(QString("127.0.0.1:%1").arg(_standInPort));
+    _xplane->setVersion(10u);
+    _xplane->enableSensorHIL(true);
+    _xplane->_useHilActuatorControls = true;
+}
+
+void XPlaneLinkTest::cleanup(void)
+{
+    delete _xplane;
+    _xplane = NULL;
+
+    delete _standIn;
+    _standIn = NULL;
+
+    _disconnectMockLink();
+
+    UnitTest::cleanup();
+}
+
+QByteArray XPlaneLinkTest::_readStandIn(int timeoutMSecs)
+{
+    if (!_standIn->hasPendingDatagrams() && !_standIn->waitForReadyRead(timeoutMSecs)) {
+        return QByteArray();
+    }
+
+    QByteArray datagram(static_cast<int>(_standIn->pendingDatagramSize()), 0);
+    _standIn->readDatagram(datagram.data(), datagram.size());
+    return datagram;
+}
+
+void XPlaneLinkTest::_connectSimulation(void)
+{
+    QVERIFY(_xplane->connectSimulation());
+
+    // The bridge tells X-Plane where to send its data, then sets up control surface override
+    QVERIFY(_readStandIn().startsWith("ISET"));
+    QVERIFY(_readStandIn().startsWith("DREF"));
+    QVERIFY(_xplane->isConnected());
+}
+
+void XPlaneLinkTest::_hilLoop_test(void)
+{
+    const int packetCount = 500;
+    const int periodUsecs = 4000;
+
+    // Decode what reaches the vehicle, queued to this thread
+    QMap<uint32_t, int> messageCounts;
+    QList<quint64>      gpsTimes;
+    int                 gcsComponentCount = 0;
+    QMetaObject::Connection connection = connect(_mockLink, &MockLink::mavlinkMessageReceived, this, [&messageCounts, &gpsTimes, &gcsComponentCount](const mavlink_message_t& msg) {
+        if (msg.msgid == MAVLINK_MSG_ID_HIL_SENSOR || msg.msgid == MAVLINK_MSG_ID_HIL_GPS) {
+            // The bridge has its own sequence numbers, so it must not send as QGC's component
+            if (msg.compid != MAV_COMP_ID_SYSTEM_CONTROL) {
+                gcsComponentCount++;
+            }
+        }
+        messageCounts[msg.msgid]++;
+        if (msg.msgid == MAVLINK_MSG_ID_HIL_GPS) {
+            gpsTimes.append(mavlink_msg_hil_gps_get_time_usec(&msg));
+        }
+    });
+
+    _connectSimulation();
+
+    // Connecting puts the vehicle in HIL mode. The bridge sees the same heartbeat on its own thread.
+    QTRY_VERIFY_WITH_TIMEOUT(_vehicle->hilMode(), 5000);
+    QTest::qWait(100);
+
+    XPlaneDataGenerator generator(_bridgePort, packetCount, periodUsecs);
+    generator.start();
+    QVERIFY(generator.wait(10000));
+
+    // Let the last statistics interval finish
+    QTest::qWait(1500);
+    disconnect(connection);
+
+    QGCXPlaneLink::HilStatistics_t statistics = _xplane->statistics();
+    QCOMPARE(statistics.frames, static_cast<quint64>(packetCount));
+
+    // Everything the bridge sent arrived: a HIL_SENSOR for nearly every frame, packets closer than the minimum
+    // send interval are skipped. Sensor HIL does not send HIL_STATE_QUATERNION.
+    int sensorCount = messageCounts.value(MAVLINK_MSG_ID_HIL_SENSOR);
+    int gpsCount =    messageCounts.value(MAVLINK_MSG_ID_HIL_GPS);
+    QCOMPARE(statistics.sensorMessages, static_cast<quint64>(sensorCount + gpsCount));
+    QCOMPARE(messageCounts.value(MAVLINK_MSG_ID_HIL_STATE_QUATERNION), 0);
+    QCOMPARE(gcsComponentCount, 0);
+    QVERIFY(sensorCount >= packetCount * 3 / 4);
+    QVERIFY(sensorCount <= packetCount);
+
+    // GPS at 10 Hz over the two seconds of data
+    int expectedGpsCount = packetCount * periodUsecs / 100000;
+    QVERIFY(gpsCount >= expectedGpsCount - 3);
+    QVERIFY(gpsCount <= expectedGpsCount + 1);
+    for (int i=1; i<gpsTimes.count(); i++) {
+        quint64 interval = gpsTimes[i] - gpsTimes[i - 1];
+        QVERIFY2(interval >= 90000 && interval <= 150000, qPrintable(QString("GPS interval %1 usecs").arg(interval)));
+    }
+
+    // Frame timing as seen by the bridge, the generator catches up after oversleeping so the mean stays on the period
+    QVERIFY(qAbs(statistics.framePeriodUsecs - periodUsecs) < periodUsecs / 10);
+    QVERIFY(statistics.frameJitterUsecs >= 0);
+    QVERIFY(statistics.frameJitterUsecs < periodUsecs / 2);
+    QVERIFY(statistics.loopMaxUsecs >= 0);
+    QVERIFY(statistics.loopMaxUsecs < periodUsecs);
+}
+
+void XPlaneLinkTest::_combinedControls_test(void)
+{
+    // Fixed wing controls need the most segments. The type is only read by the bridge thread once connected.
+    _xplane->_vehicleType = MAV_TYPE_FIXED_WING;
+
+    _connectSimulation();
+
+    float controls[16] = { 0 };
+    controls[0] = 0.1f;     // Aileron
+    controls[1] = 0.2f;     // Elevator
+    controls[2] = 0.3f;     // Rudder
+    controls[3] = 0.7f;     // Throttle
+    controls[4] = 0.5f;     // Flaps
+
+    mavlink_message_t msg;
+    mavlink_msg_hil_actuator_controls_pack_chan(_vehicle->id(),
+                                                MAV_COMP_ID_AUTOPILOT1,
+                                                _mockLink->mavlinkChannel(),
+                                                &msg,
+                                                0,          // time_usec
+                                                controls,
+                                                0,          // mode
+                                                0);         // flags
+    _mockLink->respondWithMavlinkMessage(msg);
+
+    // Surfaces and throttle come in a single DATA packet
+    QByteArray data = _readStandIn();
+    QCOMPARE(data.count(), 5 + (2 * 36));
+    QVERIFY(data.startsWith("DATA"));
+
+    qint32 index;
+    float values[8];
+
+    memcpy(&index, data.constData() + 5, sizeof(index));
+    memcpy(values, data.constData() + 5 + sizeof(index), sizeof(values));
+    QCOMPARE(index, 8);
+    QCOMPARE(values[0], -controls[1]);
+    QCOMPARE(values[1], controls[0]);
+    QCOMPARE(values[2], controls[2]);
+
+    memcpy(&index, data.constData() + 5 + 36, sizeof(index));
+    memcpy(values, data.constData() + 5 + 36 + sizeof(index), sizeof(values));
+    QCOMPARE(index, 25);
+    for (int i=0; i<8; i++) {
+        QCOMPARE(values[i], controls[3]);
+    }
+
+    // Flaps are datarefs, which X-Plane only takes one at a time
+    QByteArray flap = _readStandIn();
+    QVERIFY(flap.startsWith("DREF"));
+    QCOMPARE(QByteArray(flap.constData() + 9), QByteArray("sim/flightmodel/controls/flaprqst"));
+    flap = _readStandIn();
+    QVERIFY(flap.startsWith("DREF"));
+    QCOMPARE(QByteArray(flap.constData() + 9), QByteArray("sim/flightmodel/controls/flap2rqst"));
+
+    QVERIFY(_readStandIn(200).isEmpty());
+    QCOMPARE(_xplane->statistics().controlPackets, static_cast<quint64>(1));
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCXPlaneLink.h"
+
+#include <QUdpSocket>
+
+/// Unit test for the X-Plane HIL bridge. A local UDP socket stands in for X-Plane, sending DATA packets the way
+/// X-Plane 10 does and receiving the bridge's control packets.
+class XPlaneLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    XPlaneLinkTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _hilLoop_test(void);
+    void _combinedControls_test(void);
+
+private:
+    void _connectSimulation(void);
+
+    /// @return Next datagram the bridge sent to the stand-in, empty if none came in time
+    QByteArray _readStandIn(int timeoutMSecs = 1000);
+
+    QGCXPlaneLink*  _xplane;
+    QUdpSocket*     _standIn;
+
+    static const quint16 _standInPort = 24900;
+    static const quint16 _bridgePort =  24905;
+};
@@ -42,7 +42,7 @@ FileManager::FileManager(QObject* parent, Vehicle* vehicle)
 }
 
 /// Respond to the Ack associated with the Open command with the next read command.
-void FileManager::_openAckResponse(Request* openAck)
+void FileManager::_openAckResponse(const Request* openAck)
 {
     qCDebug(FileManagerLog) << QString("_openAckResponse: _currentOperation(%1) _readFileLength(%2)").arg(_currentOperation).arg(openAck->openFileLength);
     
@@ -165,7 +165,7 @@ void FileManager::_closeUploadSession(bool success)
 
 /// Respond to the Ack associated with the Read or Stream commands.
 ///		@param readFile: true: read file, false: stream file
-void FileManager::_downloadAckResponse(Request* readAck, bool readFile)
+void FileManager::_downloadAckResponse(const Request* readAck, bool readFile)
 {
     if (readAck->hdr.session != _activeSession) {
         _closeDownloadSession(false /* failure */);
@@ -235,7 +235,7 @@ void FileManager::_downloadAckResponse(Request* readAck, bool readFile)
 }
 
 /// @brief Respond to the Ack associated with the List command.
-void FileManager::_listAckResponse(Request* listAck)
+void FileManager::_listAckResponse(const Request* listAck)
 {
     if (listAck->hdr.offset != _listOffset) {
         // this is a real error (directory listing is synchronous), no need to retransmit
@@ -295,7 +295,7 @@ void FileManager::_listAckResponse(Request* listAck)
 }
 
 /// @brief Respond to the Ack associated with the create command.
-void FileManager::_createAckResponse(Request* createAck)
+void FileManager::_createAckResponse(const Request* createAck)
 {
     qCDebug(FileManagerLog) << "_createAckResponse";
     
@@ -311,7 +311,7 @@ void FileManager::_createAckResponse(Request* createAck)
 }
 
 /// @brief Respond to the Ack associated with the write command.
-void FileManager::_writeAckResponse(Request* writeAck)
+void FileManager::_writeAckResponse(const Request* writeAck)
 {
     if(_writeOffset + _writeSize >= _writeFileSize){
         _closeUploadSession(true /* success */);
@@ -373,23 +373,15 @@ void FileManager::_writeFileDatablock(void)
     _sendRequest(&request);
 }
 
-void FileManager::receiveMessage(mavlink_message_t message)
+void FileManager::receiveMessage(const mavlink_file_transfer_protocol_t& data)
 {
-    // receiveMessage is signalled will all mavlink messages so we need to filter everything else out but ours.
-    if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
-        return;
-    }
-
-    mavlink_file_transfer_protocol_t data;
-    mavlink_msg_file_transfer_protocol_decode(&message, &data);
-	
     // Make sure we are the target system
     if (data.target_system != _systemIdQGC) {
         qDebug() << "Received MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL with incorrect target_system:" <<  data.target_system << "expected:" << _systemIdQGC;
         return;
     }
     
-    Request* request = (Request*)&data.payload[0];
+    const Request* request = (const Request*)&data.payload[0];
 
     uint16_t incomingSeqNumber = request->hdr.seqNumber;
     
@@ -87,7 +87,7 @@ signals:
     void commandProgress(int value);
 
 public slots:
-    void receiveMessage(mavlink_message_t message);
+    void receiveMessage(const mavlink_file_transfer_protocol_t& data);
 	
 private slots:
 	void _ackTimeout(void);
@@ -191,11 +191,11 @@ private:
     void _sendRequest(Request* request);
     void _sendRequestNoAck(Request* request);
     void _fillRequestWithString(Request* request, const QString& str);
-    void _openAckResponse(Request* openAck);
-    void _downloadAckResponse(Request* readAck, bool readFile);
-    void _listAckResponse(Request* listAck);
-    void _createAckResponse(Request* createAck);
-    void _writeAckResponse(Request* writeAck);
+    void _openAckResponse(const Request* openAck);
+    void _downloadAckResponse(const Request* readAck, bool readFile);
+    void _listAckResponse(const Request* listAck);
+    void _createAckResponse(const Request* createAck);
+    void _writeAckResponse(const Request* writeAck);
     void _writeFileDatablock(void);
     void _sendListCommand(void);
     void _sendResetCommand(void);
@@ -127,11 +127,13 @@ UAS::UAS(MAVLinkProtocol* protocol, Vehicle* vehicle, FirmwarePluginManager * fi
     _vehicle(vehicle),
     _firmwarePluginManager(firmwarePluginManager)
 {
+    // Messages are decoded once by the vehicle and handed to the handlers registered here
+    _registerMessageHandlers();
+    connect(_vehicle, &Vehicle::mavlinkMessageReceived, this, &UAS::_updateComponents);
 
 #ifndef __mobile__
-    connect(_vehicle, &Vehicle::mavlinkMessageReceived, &fileManager, &FileManager::receiveMessage);
+    _vehicle->messageDispatcher()->add(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, mavlink_msg_file_transfer_protocol_decode, &fileManager, &FileManager::receiveMessage);
 #endif
-
 }
 
 /**
@@ -142,7 +144,32 @@ int UAS::getUASID() const
     return uasId;
 }
 
-void UAS::receiveMessage(mavlink_message_t message)
+template <class T>
+void UAS::_addMessageHandler(uint32_t msgId, MAVLinkMessageDispatcher::Decoder<T> decoder, void (UAS::*handler)(const mavlink_message_t&, const T&))
+{
+    _vehicle->messageDispatcher()->add<T>(msgId, decoder, [this, handler](LinkInterface*, const mavlink_message_t& message, const T& decoded) {
+        // Only accept messages from this system
+        if (message.sysid == uasId) {
+            (this->*handler)(message, decoded);
+        }
+    });
+}
+
+void UAS::_registerMessageHandlers(void)
+{
+    _addMessageHandler(MAVLINK_MSG_ID_HEARTBEAT,                    mavlink_msg_heartbeat_decode,                   &UAS::_handleHeartbeat);
+    _addMessageHandler(MAVLINK_MSG_ID_SYS_STATUS,                   mavlink_msg_sys_status_decode,                  &UAS::_handleSysStatus);
+    _addMessageHandler(MAVLINK_MSG_ID_HIL_CONTROLS,                 mavlink_msg_hil_controls_decode,                &UAS::_handleHilControls);
+    _addMessageHandler(MAVLINK_MSG_ID_PARAM_VALUE,                  mavlink_msg_param_value_decode,                 &UAS::_handleParamValue);
+    _addMessageHandler(MAVLINK_MSG_ID_ATTITUDE_TARGET,              mavlink_msg_attitude_target_decode,             &UAS::_handleAttitudeTarget);
+    _addMessageHandler(MAVLINK_MSG_ID_STATUSTEXT,                   mavlink_msg_statustext_decode,                  &UAS::_handleStatusText);
+    _addMessageHandler(MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE,  mavlink_msg_data_transmission_handshake_decode, &UAS::_handleDataTransmissionHandshake);
+    _addMessageHandler(MAVLINK_MSG_ID_ENCAPSULATED_DATA,            mavlink_msg_encapsulated_data_decode,           &UAS::_handleEncapsulatedData);
+    _addMessageHandler(MAVLINK_MSG_ID_LOG_ENTRY,                    mavlink_msg_log_entry_decode,                   &UAS::_handleLogEntry);
+    _addMessageHandler(MAVLINK_MSG_ID_LOG_DATA,                     mavlink_msg_log_data_decode,                    &UAS::_handleLogData);
+}
+
+void UAS::_updateComponents(const mavlink_message_t& message)
 {
     if (!components.contains(message.compid))
     {
@@ -174,243 +201,204 @@ void UAS::receiveMessage(mavlink_message_t message)
 
         components.insert(message.compid, componentName);
     }
+}
 
-    //    qDebug() << "UAS RECEIVED from" << message.sysid << "component" << message.compid << "msg id" << message.msgid << "seq no" << message.seq;
+bool UAS::_fromWrongComponent(const mavlink_message_t& message)
+{
+    bool wrongComponent = false;
 
-    // Only accept messages from this system (condition 1)
-    // and only then if a) attitudeStamped is disabled OR b) attitudeStamped is enabled
-    // and we already got one attitude packet
-    if (message.sysid == uasId && (!attitudeStamped || lastAttitude != 0 || message.msgid == MAVLINK_MSG_ID_ATTITUDE))
+    switch (message.compid)
     {
-        QString uasState;
-        QString stateDescription;
-
-        bool multiComponentSourceDetected = false;
-        bool wrongComponent = false;
+    case MAV_COMP_ID_IMU_2:
+        // Prefer IMU 2 over IMU 1 (FIXME)
+        componentID[message.msgid] = MAV_COMP_ID_IMU_2;
+        break;
+    default:
+        // Do nothing
+        break;
+    }
 
-        switch (message.compid)
+    // Store component ID
+    if (!componentID.contains(message.msgid))
+    {
+        // Prefer the first component
+        componentID[message.msgid] = message.compid;
+        componentMulti[message.msgid] = false;
+    }
+    else
+    {
+        // Got this message already
+        if (componentID[message.msgid] != message.compid)
         {
-        case MAV_COMP_ID_IMU_2:
-            // Prefer IMU 2 over IMU 1 (FIXME)
-            componentID[message.msgid] = MAV_COMP_ID_IMU_2;
-            break;
-        default:
-            // Do nothing
-            break;
+            componentMulti[message.msgid] = true;
+            wrongComponent = true;
         }
+    }
 
-        // Store component ID
-        if (!componentID.contains(message.msgid))
-        {
-            // Prefer the first component
-            componentID[message.msgid] = message.compid;
-            componentMulti[message.msgid] = false;
-        }
-        else
-        {
-            // Got this message already
-            if (componentID[message.msgid] != message.compid)
-            {
-                componentMulti[message.msgid] = true;
-                wrongComponent = true;
-            }
-        }
+    return componentMulti[message.msgid] && wrongComponent;
+}
 
-        if (componentMulti[message.msgid] == true) {
-            multiComponentSourceDetected = true;
-        }
+void UAS::_handleHeartbeat(const mavlink_message_t& message, const mavlink_heartbeat_t& state)
+{
+    if (_fromWrongComponent(message))
+    {
+        return;
+    }
 
+    // Send the base_mode and system_status values to the plotter. This uses the ground time
+    // so the Ground Time checkbox must be ticked for these values to display
+    quint64 time = getUnixTime();
+    QString name = QString("M%1:HEARTBEAT.%2").arg(message.sysid);
+    emit valueChanged(uasId, name.arg("base_mode"), "bits", state.base_mode, time);
+    emit valueChanged(uasId, name.arg("custom_mode"), "bits", state.custom_mode, time);
+    emit valueChanged(uasId, name.arg("system_status"), "-", state.system_status, time);
 
-        switch (message.msgid)
-        {
-        case MAVLINK_MSG_ID_HEARTBEAT:
-        {
-            if (multiComponentSourceDetected && wrongComponent)
-            {
-                break;
-            }
-            mavlink_heartbeat_t state;
-            mavlink_msg_heartbeat_decode(&message, &state);
-
-            // Send the base_mode and system_status values to the plotter. This uses the ground time
-            // so the Ground Time checkbox must be ticked for these values to display
-            quint64 time = getUnixTime();
-            QString name = QString("M%1:HEARTBEAT.%2").arg(message.sysid);
-            emit valueChanged(uasId, name.arg("base_mode"), "bits", state.base_mode, time);
-            emit valueChanged(uasId, name.arg("custom_mode"), "bits", state.custom_mode, time);
-            emit valueChanged(uasId, name.arg("system_status"), "-", state.system_status, time);
-
-            // We got the mode
-            receivedMode = true;
-        }
+    // We got the mode
+    receivedMode = true;
+}
 
-            break;
+void UAS::_handleSysStatus(const mavlink_message_t& message, const mavlink_sys_status_t& state)
+{
+    if (_fromWrongComponent(message))
+    {
+        return;
+    }
 
-        case MAVLINK_MSG_ID_SYS_STATUS:
-        {
-            if (multiComponentSourceDetected && wrongComponent)
-            {
-                break;
-            }
-            mavlink_sys_status_t state;
-            mavlink_msg_sys_status_decode(&message, &state);
-
-            // Prepare for sending data to the realtime plotter, which is every field excluding onboard_control_sensors_present.
-            quint64 time = getUnixTime();
-            QString name = QString("M%1:SYS_STATUS.%2").arg(message.sysid);
-            emit valueChanged(uasId, name.arg("sensors_enabled"), "bits", state.onboard_control_sensors_enabled, time);
-            emit valueChanged(uasId, name.arg("sensors_health"), "bits", state.onboard_control_sensors_health, time);
-            emit valueChanged(uasId, name.arg("errors_comm"), "-", state.errors_comm, time);
-            emit valueChanged(uasId, name.arg("errors_count1"), "-", state.errors_count1, time);
-            emit valueChanged(uasId, name.arg("errors_count2"), "-", state.errors_count2, time);
-            emit valueChanged(uasId, name.arg("errors_count3"), "-", state.errors_count3, time);
-            emit valueChanged(uasId, name.arg("errors_count4"), "-", state.errors_count4, time);
-
-            // Process CPU load.
-            emit valueChanged(uasId, name.arg("load"), "%", state.load/10.0f, time);
-            emit valueChanged(uasId, name.arg("drop_rate_comm"), "%", state.drop_rate_comm/100.0f, time);
-        }
-            break;
-        case MAVLINK_MSG_ID_HIL_CONTROLS:
-        {
-            mavlink_hil_controls_t hil;
-            mavlink_msg_hil_controls_decode(&message, &hil);
-            emit hilControlsChanged(hil.time_usec, hil.roll_ailerons, hil.pitch_elevator, hil.yaw_rudder, hil.throttle, hil.mode, hil.nav_mode);
-        }
-            break;
+    // Prepare for sending data to the realtime plotter, which is every field excluding onboard_control_sensors_present.
+    quint64 time = getUnixTime();
+    QString name = QString("M%1:SYS_STATUS.%2").arg(message.sysid);
+    emit valueChanged(uasId, name.arg("sensors_enabled"), "bits", state.onboard_control_sensors_enabled, time);
+    emit valueChanged(uasId, name.arg("sensors_health"), "bits", state.onboard_control_sensors_health, time);
+    emit valueChanged(uasId, name.arg("errors_comm"), "-", state.errors_comm, time);
+    emit valueChanged(uasId, name.arg("errors_count1"), "-", state.errors_count1, time);
+    emit valueChanged(uasId, name.arg("errors_count2"), "-", state.errors_count2, time);
+    emit valueChanged(uasId, name.arg("errors_count3"), "-", state.errors_count3, time);
+    emit valueChanged(uasId, name.arg("errors_count4"), "-", state.errors_count4, time);
+
+    // Process CPU load.
+    emit valueChanged(uasId, name.arg("load"), "%", state.load/10.0f, time);
+    emit valueChanged(uasId, name.arg("drop_rate_comm"), "%", state.drop_rate_comm/100.0f, time);
+}
 
-        case MAVLINK_MSG_ID_PARAM_VALUE:
-        {
-            mavlink_param_value_t rawValue;
-            mavlink_msg_param_value_decode(&message, &rawValue);
-            QByteArray bytes(rawValue.param_id, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
-            // Construct a string stopping at the first NUL (0) character, else copy the whole
-            // byte array (max MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN, so safe)
-            QString parameterName(bytes);
-            mavlink_param_union_t paramVal;
-            paramVal.param_float = rawValue.param_value;
-            paramVal.type = rawValue.param_type;
-
-            processParamValueMsg(message, parameterName,rawValue,paramVal);
-         }
-            break;
-        case MAVLINK_MSG_ID_ATTITUDE_TARGET:
-        {
-            mavlink_attitude_target_t out;
-            mavlink_msg_attitude_target_decode(&message, &out);
-            float roll, pitch, yaw;
-            mavlink_quaternion_to_euler(out.q, &roll, &pitch, &yaw);
-            quint64 time = getUnixTimeFromMs(out.time_boot_ms);
-
-            // For plotting emit roll sp, pitch sp and yaw sp values
-            emit valueChanged(uasId, "roll sp", "rad", roll, time);
-            emit valueChanged(uasId, "pitch sp", "rad", pitch, time);
-            emit valueChanged(uasId, "yaw sp", "rad", yaw, time);
-        }
-            break;
+void UAS::_handleHilControls(const mavlink_message_t& message, const mavlink_hil_controls_t& hil)
+{
+    Q_UNUSED(message);
+    emit hilControlsChanged(hil.time_usec, hil.roll_ailerons, hil.pitch_elevator, hil.yaw_rudder, hil.throttle, hil.mode, hil.nav_mode);
+}
 
-        case MAVLINK_MSG_ID_STATUSTEXT:
-        {
-            QByteArray b;
-            b.resize(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1);
-            mavlink_msg_statustext_get_text(&message, b.data());
-
-            // Ensure NUL-termination
-            b[b.length()-1] = '\0';
-            QString text = QString(b);
-            int severity = mavlink_msg_statustext_get_severity(&message);
-
-        // If the message is NOTIFY or higher severity, or starts with a '#',
-        // then read it aloud.
-            if (text.startsWith("#") || severity <= MAV_SEVERITY_NOTICE)
-            {
-                text.remove("#");
-                emit textMessageReceived(uasId, message.compid, severity, text);
-                _say(text.toLower(), severity);
-            }
-            else
-            {
-                emit textMessageReceived(uasId, message.compid, severity, text);
-            }
-        }
-            break;
+void UAS::_handleParamValue(const mavlink_message_t& message, const mavlink_param_value_t& rawValue)
+{
+    QByteArray bytes(rawValue.param_id, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
+    // Construct a string stopping at the first NUL (0) character, else copy the whole
+    // byte array (max MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN, so safe)
+    QString parameterName(bytes);
+    mavlink_param_union_t paramVal;
+    paramVal.param_float = rawValue.param_value;
+    paramVal.type = rawValue.param_type;
+
+    processParamValueMsg(message, parameterName,rawValue,paramVal);
+}
 
-        case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
-        {
-            mavlink_data_transmission_handshake_t p;
-            mavlink_msg_data_transmission_handshake_decode(&message, &p);
-            imageSize = p.size;
-            imagePackets = p.packets;
-            imagePayload = p.payload;
-            imageQuality = p.jpg_quality;
-            imageType = p.type;
-            imageWidth = p.width;
-            imageHeight = p.height;
-            imageStart = QGC::groundTimeMilliseconds();
-            imagePacketsArrived = 0;
+void UAS::_handleAttitudeTarget(const mavlink_message_t& message, const mavlink_attitude_target_t& out)
+{
+    Q_UNUSED(message);
 
-        }
-            break;
+    float roll, pitch, yaw;
+    mavlink_quaternion_to_euler(out.q, &roll, &pitch, &yaw);
+    quint64 time = getUnixTimeFromMs(out.time_boot_ms);
 
-        case MAVLINK_MSG_ID_ENCAPSULATED_DATA:
-        {
-            mavlink_encapsulated_data_t img;
-            mavlink_msg_encapsulated_data_decode(&message, &img);
-            int seq = img.seqnr;
-            int pos = seq * imagePayload;
-
-            // Check if we have a valid transaction
-            if (imagePackets == 0)
-            {
-                // NO VALID TRANSACTION - ABORT
-                // Restart statemachine
-                imagePacketsArrived = 0;
-                break;
-            }
-
-            for (int i = 0; i < imagePayload; ++i)
-            {
-                if (pos <= imageSize) {
-                    imageRecBuffer[pos] = img.data[i];
-                }
-                ++pos;
-            }
-
-            ++imagePacketsArrived;
-
-            // emit signal if all packets arrived
-            if (imagePacketsArrived >= imagePackets)
-            {
-                // Restart statemachine
-                imagePackets = 0;
-                imagePacketsArrived = 0;
-                emit imageReady(this);
-            }
-        }
-            break;
+    // For plotting emit roll sp, pitch sp and yaw sp values
+    emit valueChanged(uasId, "roll sp", "rad", roll, time);
+    emit valueChanged(uasId, "pitch sp", "rad", pitch, time);
+    emit valueChanged(uasId, "yaw sp", "rad", yaw, time);
+}
 
-        case MAVLINK_MSG_ID_LOG_ENTRY:
-        {
-            mavlink_log_entry_t log;
-            mavlink_msg_log_entry_decode(&message, &log);
-            emit logEntry(this, log.time_utc, log.size, log.id, log.num_logs, log.last_log_num);
-        }
-            break;
+void UAS::_handleStatusText(const mavlink_message_t& message, const mavlink_statustext_t& statusText)
+{
+    QByteArray b(statusText.text, MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
 
-        case MAVLINK_MSG_ID_LOG_DATA:
-        {
-            mavlink_log_data_t log;
-            mavlink_msg_log_data_decode(&message, &log);
-            emit logData(this, log.ofs, log.id, log.count, log.data);
-        }
-            break;
+    // Ensure NUL-termination
+    b.append('\0');
+    QString text = QString(b);
+    int severity = statusText.severity;
 
-        default:
-            break;
+    // If the message is NOTIFY or higher severity, or starts with a '#',
+    // then read it aloud.
+    if (text.startsWith("#") || severity <= MAV_SEVERITY_NOTICE)
+    {
+        text.remove("#");
+        emit textMessageReceived(uasId, message.compid, severity, text);
+        _say(text.toLower(), severity);
+    }
+    else
+    {
+        emit textMessageReceived(uasId, message.compid, severity, text);
+    }
+}
+
+void UAS::_handleDataTransmissionHandshake(const mavlink_message_t& message, const mavlink_data_transmission_handshake_t& p)
+{
+    Q_UNUSED(message);
+
+    imageSize = p.size;
+    imagePackets = p.packets;
+    imagePayload = p.payload;
+    imageQuality = p.jpg_quality;
+    imageType = p.type;
+    imageWidth = p.width;
+    imageHeight = p.height;
+    imageStart = QGC::groundTimeMilliseconds();
+    imagePacketsArrived = 0;
+}
+
+void UAS::_handleEncapsulatedData(const mavlink_message_t& message, const mavlink_encapsulated_data_t& img)
+{
+    Q_UNUSED(message);
+
+    int seq = img.seqnr;
+    int pos = seq * imagePayload;
+
+    // Check if we have a valid transaction
+    if (imagePackets == 0)
+    {
+        // NO VALID TRANSACTION - ABORT
+        // Restart statemachine
+        imagePacketsArrived = 0;
+        return;
+    }
+
+    for (int i = 0; i < imagePayload; ++i)
+    {
+        if (pos <= imageSize) {
+            imageRecBuffer[pos] = img.data[i];
         }
+        ++pos;
+    }
+
+    ++imagePacketsArrived;
+
+    // emit signal if all packets arrived
+    if (imagePacketsArrived >= imagePackets)
+    {
+        // Restart statemachine
+        imagePackets = 0;
+        imagePacketsArrived = 0;
+        emit imageReady(this);
     }
 }
 
+void UAS::_handleLogEntry(const mavlink_message_t& message, const mavlink_log_entry_t& log)
+{
+    Q_UNUSED(message);
+    emit logEntry(this, log.time_utc, log.size, log.id, log.num_logs, log.last_log_num);
+}
+
+void UAS::_handleLogData(const mavlink_message_t& message, const mavlink_log_data_t& log)
+{
+    Q_UNUSED(message);
+    emit logData(this, log.ofs, log.id, log.count, log.data);
+}
+
 void UAS::startCalibration(UASInterface::StartCalibrationType calType)
 {
     if (!_vehicle) {
@@ -812,7 +800,7 @@ quint64 UAS::getUptime() const
 }
 
 //TODO update this to use the parameter manager / param data model instead
-void UAS::processParamValueMsg(mavlink_message_t& msg, const QString& paramName, const mavlink_param_value_t& rawValue,  mavlink_param_union_t& paramUnion)
+void UAS::processParamValueMsg(const mavlink_message_t& msg, const QString& paramName, const mavlink_param_value_t& rawValue,  mavlink_param_union_t& paramUnion)
 {
     int compId = msg.compid;
 
@@ -1321,21 +1309,6 @@ void UAS::enableHilXPlane(bool enable)
             delete simulation;
         }
         simulation = new QGCXPlaneLink(_vehicle);
-
-        float noise_scaler = 0.0001f;
-        xacc_var = noise_scaler * 0.2914f;
-        yacc_var = noise_scaler * 0.2914f;
-        zacc_var = noise_scaler * 0.9577f;
-        rollspeed_var = noise_scaler * 0.8126f;
-        pitchspeed_var = noise_scaler * 0.6145f;
-        yawspeed_var = noise_scaler * 0.5852f;
-        xmag_var = noise_scaler * 0.0786f;
-        ymag_var = noise_scaler * 0.0566f;
-        zmag_var = noise_scaler * 0.0333f;
-        abs_pressure_var = noise_scaler * 0.5604f;
-        diff_pressure_var = noise_scaler * 0.2604f;
-        pressure_alt_var = noise_scaler * 0.5604f;
-        temperature_var = noise_scaler * 0.7290f;
     }
     // Connect X-Plane Link
     if (enable)
@@ -60,9 +60,9 @@ public:
     /** @brief The time interval the robot is switched on */
     quint64 getUptime() const;
 
-	/// Vehicle is about to go away
-	void shutdownVehicle(void);
-	
+	/// Vehicle is about to go away
+	void shutdownVehicle(void);
+	
     // Setters for HIL noise variance
     void setXaccVar(float var){
         xacc_var = var;
@@ -273,9 +273,6 @@ public slots:
     void setManual6DOFControlCommands(double x, double y, double z, double roll, double pitch, double yaw);
 #endif
 
-    /** @brief Receive a message from one of the communication links. */
-    virtual void receiveMessage(mavlink_message_t message);
-
     void startCalibration(StartCalibrationType calType);
     void stopCalibration(void);
 
@@ -306,7 +303,7 @@ protected:
     /** @brief Get the UNIX timestamp in milliseconds, ignore attitudeStamped mode */
     quint64 getUnixReferenceTime(quint64 time);
 
-    virtual void processParamValueMsg(mavlink_message_t& msg, const QString& paramName,const mavlink_param_value_t& rawValue, mavlink_param_union_t& paramValue);
+    virtual void processParamValueMsg(const mavlink_message_t& msg, const QString& paramName,const mavlink_param_value_t& rawValue, mavlink_param_union_t& paramValue);
 
     QMap<int, int>componentID;
     QMap<int, bool>componentMulti;
@@ -322,9 +319,27 @@ protected:
     quint64 lastSendTimeSensors; ///< Last HIL Sensors message sent
     quint64 lastSendTimeOpticalFlow; ///< Last HIL Optical Flow message sent
 
+private slots:
+    void _updateComponents(const mavlink_message_t& message);
+
 private:
     void _say(const QString& text, int severity = 6);
 
+    template <class T>
+    void _addMessageHandler(uint32_t msgId, MAVLinkMessageDispatcher::Decoder<T> decoder, void (UAS::*handler)(const mavlink_message_t&, const T&));
+    void _registerMessageHandlers(void);
+    bool _fromWrongComponent(const mavlink_message_t& message);
+    void _handleHeartbeat(const mavlink_message_t& message, const mavlink_heartbeat_t& state);
+    void _handleSysStatus(const mavlink_message_t& message, const mavlink_sys_status_t& state);
+    void _handleHilControls(const mavlink_message_t& message, const mavlink_hil_controls_t& hil);
+    void _handleParamValue(const mavlink_message_t& message, const mavlink_param_value_t& rawValue);
+    void _handleAttitudeTarget(const mavlink_message_t& message, const mavlink_attitude_target_t& out);
+    void _handleStatusText(const mavlink_message_t& message, const mavlink_statustext_t& statusText);
+    void _handleDataTransmissionHandshake(const mavlink_message_t& message, const mavlink_data_transmission_handshake_t& p);
+    void _handleEncapsulatedData(const mavlink_message_t& message, const mavlink_encapsulated_data_t& img);
+    void _handleLogEntry(const mavlink_message_t& message, const mavlink_log_entry_t& log);
+    void _handleLogData(const mavlink_message_t& message, const mavlink_log_data_t& log);
+
 private:
     Vehicle*                _vehicle;
     FirmwarePluginManager*  _firmwarePluginManager;
@@ -1,10 +1,11 @@
 #include "QGCMAVLink.h"
 #include "MAVLinkDecoder.h"
+#include "TimesyncEstimator.h"
 
 #include <QDebug>
 
 MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol) :
-    QThread(), creationThread(QThread::currentThread())
+    QThread(), protocol(protocol), creationThread(QThread::currentThread())
 {
     // We're doing it wrong - because the Qt folks got the API wrong:
     // http://blog.qt.digia.com/blog/2010/06/17/youre-doing-it-wrong/
@@ -61,13 +62,13 @@ void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t messag
     Q_UNUSED(link);
 
     uint32_t msgid = message.msgid;
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
-    if(!msgInfo) {
+    const MAVLinkDecodePlan* plan = planCache.plan(msgid);
+    if(!plan) {
         qWarning() << "Invalid MAVLink message received. ID:" << msgid;
         return;
     }
 
-    msgDict[message.msgid] = message;
+    updateSnapshot(message, plan);
 
     // Store an arrival time for this message. This value ends up being calculated later.
     quint64 time = 0;
@@ -77,43 +78,134 @@ void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t messag
     {
         mavlink_system_time_t timebase;
         mavlink_msg_system_time_decode(&message, &timebase);
-        sysDict[msgid].onboardTimeOffset = (timebase.time_unix_usec+500)/1000 - timebase.time_boot_ms;
-        sysDict[msgid].onboardToGCSUnixTimeOffsetAndDelay  = static_cast<qint64>(QGC::groundTimeMilliseconds() - (timebase.time_unix_usec+500)/1000);
+        sysDict[message.sysid].onboardTimeOffset = (timebase.time_unix_usec+500)/1000 - timebase.time_boot_ms;
+        sysDict[message.sysid].onboardToGCSUnixTimeOffsetAndDelay  = static_cast<qint64>(QGC::groundTimeMilliseconds() - (timebase.time_unix_usec+500)/1000);
     }
     else
     {
-
-        // See if first value is a time value and if it is, use that as the arrival time for this data.
-        uint8_t fieldid = 0;
-        uint8_t* m = (uint8_t*)(msgDict[msgid].payload64);
-
-        if (QString(msgInfo->fields[fieldid].name) == QString("time_boot_ms") && msgInfo->fields[fieldid].type == MAVLINK_TYPE_UINT32_T)
-        {
-            time = *((quint32*)(m+msgInfo->fields[fieldid].wire_offset));
-        }
-        else if (QString(msgInfo->fields[fieldid].name).contains("usec") && msgInfo->fields[fieldid].type == MAVLINK_TYPE_UINT64_T)
-        {
-            time = *((quint64*)(m+msgInfo->fields[fieldid].wire_offset));
-            time = (time+500)/1000; // Scale to milliseconds, round up/down correctly
-        }
+        // If the first value is a time value use that as the arrival time for this data.
+        time = plan->onboardTimeMs(message);
     }
 
     // Align UAS time to global time
     time = getUnixTimeFromMs(message.sysid, time);
 
+    // Store component ID
+    SystemData& systemData = sysDict[msgid];
+    if (systemData.componentID == -1)
+    {
+        systemData.componentID = message.compid;
+    }
+    else if (systemData.componentID != message.compid)
+    {
+        // Got this message already from a different component
+        systemData.componentMulti = true;
+    }
+    bool multiComponentSourceDetected = systemData.componentMulti;
+
+    if (messageFilter.contains(msgid)) return;
+
     // Send out all field values for this message
-    for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
+    switch (msgid)
     {
-        emitFieldValue(&message, i, time);
+    case MAVLINK_MSG_ID_DEBUG_VECT:
+    case MAVLINK_MSG_ID_DEBUG:
+    case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
+    case MAVLINK_MSG_ID_NAMED_VALUE_INT:
+    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+    case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+        emitNamedFieldValues(message, plan, multiComponentSourceDetected, time);
+        break;
+    default:
+        emitFieldValues(message, plan, multiComponentSourceDetected, time);
+        break;
     }
 
     // Send out combined math expressions
     // FIXME XXX TODO
 }
 
+void MAVLinkDecoder::updateSnapshot(const mavlink_message_t& msg, const MAVLinkDecodePlan* plan)
+{
+    quint64 key = (static_cast<quint64>(msg.sysid) << 48) | (static_cast<quint64>(msg.compid) << 32) | msg.msgid;
+
+    QMutexLocker lock(&snapshotMutex);
+
+    QHash<quint64, MAVLinkMessageSnapshot>::iterator iter = snapshotDict.find(key);
+    if (iter == snapshotDict.end()) {
+        MAVLinkMessageSnapshot snapshot;
+        snapshot.count = 0;
+        snapshot.columns.resize(plan->columnCount());
+        iter = snapshotDict.insert(key, snapshot);
+    }
+
+    MAVLinkMessageSnapshot& snapshot = iter.value();
+    snapshot.message = msg;
+    snapshot.time = QGC::groundTimeMilliseconds();
+    snapshot.count++;
+    plan->decode(msg, snapshot.columns.data());
+}
+
+QList<MAVLinkMessageSnapshot> MAVLinkDecoder::snapshots(int sysid, int compid) const
+{
+    QList<MAVLinkMessageSnapshot> list;
+
+    QMutexLocker lock(&snapshotMutex);
+
+    foreach (const MAVLinkMessageSnapshot& snapshot, snapshotDict) {
+        if ((sysid == 0 || snapshot.message.sysid == sysid) && (compid == 0 || snapshot.message.compid == compid)) {
+            list.append(snapshot);
+        }
+    }
+
+    return list;
+}
+
+int MAVLinkDecoder::curveId(const QString& name, const QString& unit)
+{
+    QString key = name + QChar('\0') + unit;
+
+    QHash<QString, int>::const_iterator iter = curveIds.constFind(key);
+    if (iter != curveIds.constEnd()) {
+        return iter.value();
+    }
+
+    QMutexLocker lock(&curveMutex);
+
+    int id = curves.count();
+    curves.append(qMakePair(name, unit));
+    curveIds.insert(key, id);
+    return id;
+}
+
+bool MAVLinkDecoder::curve(int curveId, QString& name, QString& unit) const
+{
+    QMutexLocker lock(&curveMutex);
+
+    if (curveId < 0 || curveId >= curves.count()) {
+        return false;
+    }
+    name = curves[curveId].first;
+    unit = curves[curveId].second;
+    return true;
+}
+
 quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
 {
     quint64 ret = 0;
+
+    // Prefer the TIMESYNC clock estimate of the vehicle when there is one
+    QSharedPointer<TimesyncEstimator> timesync = protocol->timesyncEstimator(systemID);
+    if (timesync && timesync->converged()) {
+        if (time == 0) {
+            // No onboard time in the message, take off the link latency from the arrival time
+            return QGC::groundTimeMilliseconds() - timesync->latencyNsecs() / 1000000;
+        } else if (time < 1261440000000LLU) {
+            return timesync->vehicleToGround(static_cast<qint64>(time) * 1000000) / 1000000;
+        }
+    }
+
     if (time == 0)
     {
         ret = QGC::groundTimeMilliseconds() - sysDict[systemID].onboardToGCSUnixTimeOffsetAndDelay;
@@ -189,318 +281,184 @@ quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
     return ret;
 }
 
-void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+void MAVLinkDecoder::emitFieldValues(const mavlink_message_t& msg, const MAVLinkDecodePlan* plan, bool multiComponent, quint64 time)
 {
-    bool multiComponentSourceDetected = false;
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
+    // Names only depend on the source, so they are built once and reused for every message
+    quint64 key = (static_cast<quint64>(msg.sysid) << 48) | (static_cast<quint64>(multiComponent ? msg.compid + 1 : 0) << 32) | msg.msgid;
 
-    uint32_t msgid = msg->msgid;
+    QHash<quint64, MessageNames>::const_iterator iter = nameCache.constFind(key);
+    if (iter == nameCache.constEnd()) {
+        QString prefix = multiComponent ? QString("M%1:C%2:").arg(msg.sysid).arg(msg.compid) : QString("M%1:").arg(msg.sysid);
 
-    // create new system data if it wasn't dectected yet
-    if (!(sysDict.keys().contains(msgid))) {
-        sysDict[msgid] = SystemData();
+        MessageNames names;
+        for (int i = 0; i < plan->columnCount(); i++) {
+            names.columnIds.append(curveId(prefix + plan->columnNames[i], plan->columnUnits[i]));
+        }
+        foreach (const MAVLinkFieldPlan& field, plan->fields) {
+            names.fieldNames.append(prefix + plan->name + QStringLiteral(".") + field.name);
+        }
+        iter = nameCache.insert(key, names);
     }
+    const MessageNames& names = iter.value();
 
-    // Store component ID
-    if (sysDict[msgid].componentID == -1)
+    for (int i = 0; i < plan->columnCount(); i++)
     {
-        sysDict[msgid].componentID = msg->compid;
+        emit curveValueChanged(msg.sysid, names.columnIds[i], plan->columnValue(msg, i), time);
     }
-    else
+
+    if (!textMessageFilter.contains(msg.msgid))
     {
-        // Got this message already
-        if (sysDict[msgid].componentID != msg->compid)
+        for (int i = 0; i < plan->fields.count(); i++)
         {
-            sysDict[msgid].componentMulti = true;
+            if (plan->fields[i].firstColumn == -1)
+            {
+                emit textMessageReceived(msg.sysid, msg.compid, MAV_SEVERITY_INFO, names.fieldNames[i] + ": " + plan->fieldValue(msg, i).toString());
+            }
         }
     }
+}
 
-    if (sysDict[msgid].componentMulti == true) {
-        multiComponentSourceDetected = true;
-    }
+void MAVLinkDecoder::emitNamedFieldValues(const mavlink_message_t& msg, const MAVLinkDecodePlan* plan, bool multiComponent, quint64 time)
+{
+    // The part of the message content the names are built from. Names and curve ids are only built the first
+    // time the content is seen from a source.
+    QByteArray content;
 
-    // Add field tree widget item
-    if (messageFilter.contains(msgid)) return;
-    QString fieldName(msgInfo->fields[fieldid].name);
-    QString fieldType;
-    uint8_t* m = (uint8_t*)(msgDict[msgid].payload64);
-    QString name("%1.%2");
-    QString unit("");
-
-    // Debug vector messages
-    if (msgid == MAVLINK_MSG_ID_DEBUG_VECT)
+    switch (msg.msgid)
+    {
+    case MAVLINK_MSG_ID_DEBUG_VECT:
     {
         mavlink_debug_vect_t debug;
-        mavlink_msg_debug_vect_decode(msg, &debug);
-        char buf[11];
-        strncpy(buf, debug.name, 10);
-        buf[10] = '\0';
-        name = QString("%1.%2").arg(buf).arg(fieldName);
-        time = getUnixTimeFromMs(msg->sysid, (debug.time_usec+500)/1000); // Scale to milliseconds, round up/down correctly
+        mavlink_msg_debug_vect_decode(&msg, &debug);
+        content = QByteArray(debug.name, static_cast<int>(qstrnlen(debug.name, 10)));
+        time = getUnixTimeFromMs(msg.sysid, (debug.time_usec+500)/1000); // Scale to milliseconds, round up/down correctly
+        break;
     }
-    else if (msgid == MAVLINK_MSG_ID_DEBUG)
+    case MAVLINK_MSG_ID_DEBUG:
     {
-        mavlink_debug_t debug;
-        mavlink_msg_debug_decode(msg, &debug);
-        name = name.arg(QString("debug")).arg(debug.ind);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
+        uint8_t ind = mavlink_msg_debug_get_ind(&msg);
+        content = QByteArray(reinterpret_cast<const char*>(&ind), 1);
+        time = getUnixTimeFromMs(msg.sysid, mavlink_msg_debug_get_time_boot_ms(&msg));
+        break;
     }
-    else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT)
+    case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
     {
         mavlink_named_value_float_t debug;
-        mavlink_msg_named_value_float_decode(msg, &debug);
-        char buf[11];
-        strncpy(buf, debug.name, 10);
-        buf[10] = '\0';
-        name = QString(buf);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
+        mavlink_msg_named_value_float_decode(&msg, &debug);
+        content = QByteArray(debug.name, static_cast<int>(qstrnlen(debug.name, 10)));
+        time = getUnixTimeFromMs(msg.sysid, debug.time_boot_ms);
+        break;
     }
-    else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT)
+    case MAVLINK_MSG_ID_NAMED_VALUE_INT:
     {
         mavlink_named_value_int_t debug;
-        mavlink_msg_named_value_int_decode(msg, &debug);
-        char buf[11];
-        strncpy(buf, debug.name, 10);
-        buf[10] = '\0';
-        name = QString(buf);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
+        mavlink_msg_named_value_int_decode(&msg, &debug);
+        content = QByteArray(debug.name, static_cast<int>(qstrnlen(debug.name, 10)));
+        time = getUnixTimeFromMs(msg.sysid, debug.time_boot_ms);
+        break;
     }
-    else if (msgid == MAVLINK_MSG_ID_RC_CHANNELS_RAW)
+    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
     {
-        // XXX this is really ugly, but we do not know a better way to do this
-        mavlink_rc_channels_raw_t raw;
-        mavlink_msg_rc_channels_raw_decode(msg, &raw);
-        name = name.arg(msgInfo->name).arg(fieldName);
-        name.prepend(QString("port%1_").arg(raw.port));
+        uint8_t port = mavlink_msg_rc_channels_raw_get_port(&msg);
+        content = QByteArray(reinterpret_cast<const char*>(&port), 1);
+        break;
     }
-    else if (msgid == MAVLINK_MSG_ID_RC_CHANNELS_SCALED)
+    case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
     {
-        // XXX this is really ugly, but we do not know a better way to do this
-        mavlink_rc_channels_scaled_t scaled;
-        mavlink_msg_rc_channels_scaled_decode(msg, &scaled);
-        name = name.arg(msgInfo->name).arg(fieldName);
-        name.prepend(QString("port%1_").arg(scaled.port));
+        uint8_t port = mavlink_msg_rc_channels_scaled_get_port(&msg);
+        content = QByteArray(reinterpret_cast<const char*>(&port), 1);
+        break;
     }
-    else if (msgid == MAVLINK_MSG_ID_SERVO_OUTPUT_RAW)
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
     {
-        // XXX this is really ugly, but we do not know a better way to do this
-        mavlink_servo_output_raw_t servo;
-        mavlink_msg_servo_output_raw_decode(msg, &servo);
-        name = name.arg(msgInfo->name).arg(fieldName);
-        name.prepend(QString("port%1_").arg(servo.port));
+        uint8_t port = mavlink_msg_servo_output_raw_get_port(&msg);
+        content = QByteArray(reinterpret_cast<const char*>(&port), 1);
+        break;
     }
-    else
-    {
-        name = name.arg(msgInfo->name).arg(fieldName);
+    default:
+        break;
     }
 
-    if (multiComponentSourceDetected)
-    {
-        name = name.prepend(QString("C%1:").arg(msg->compid));
-    }
+    quint64 key = (static_cast<quint64>(msg.sysid) << 48) | (static_cast<quint64>(multiComponent ? msg.compid + 1 : 0) << 32) | msg.msgid;
 
-    name = name.prepend(QString("M%1:").arg(msg->sysid));
+    QHash<QPair<quint64, QByteArray>, MessageNames>::const_iterator iter = namedCache.constFind(qMakePair(key, content));
+    if (iter == namedCache.constEnd()) {
+        QString prefix;             ///< Name of the value, prepended to the field name if useFieldName
+        bool useFieldName = true;
 
-    switch (msgInfo->fields[fieldid].type)
-    {
-    case MAVLINK_TYPE_CHAR:
-        if (msgInfo->fields[fieldid].array_length > 0)
+        switch (msg.msgid)
         {
-            char* str = (char*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            str[msgInfo->fields[fieldid].array_length-1] = '\0';
-            QString string(name + ": " + str);
-            if (!textMessageFilter.contains(msgid)) emit textMessageReceived(msg->sysid, msg->compid, MAV_SEVERITY_INFO, string);
+        case MAVLINK_MSG_ID_DEBUG_VECT:
+            prefix = QString("%1.").arg(QString::fromLatin1(content));
+            break;
+        case MAVLINK_MSG_ID_DEBUG:
+            prefix = QString("debug.%1").arg(static_cast<uint8_t>(content[0]));
+            useFieldName = false;
+            break;
+        case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
+        case MAVLINK_MSG_ID_NAMED_VALUE_INT:
+            prefix = QString::fromLatin1(content);
+            useFieldName = false;
+            break;
+        case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+        case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
+        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+            // XXX this is really ugly, but we do not know a better way to do this
+            prefix = QString("port%1_%2.").arg(static_cast<uint8_t>(content[0])).arg(plan->name);
+            break;
+        default:
+            prefix = plan->name + QStringLiteral(".");
+            break;
         }
-        else
-        {
-            // Single char
-            char b = *((char*)(m+msgInfo->fields[fieldid].wire_offset));
-            unit = QString("char[%1]").arg(msgInfo->fields[fieldid].array_length);
-            emit valueChanged(msg->sysid, name, unit, b, time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT8_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint8_t* nums = m+msgInfo->fields[fieldid].wire_offset;
-            fieldType = QString("uint8_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint8_t u = *(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = "uint8_t";
-            emit valueChanged(msg->sysid, name, fieldType, u, time);
-        }
-        break;
-    case MAVLINK_TYPE_INT8_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int8_t* nums = (int8_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int8_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int8_t n = *((int8_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int8_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT16_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint16_t* nums = (uint16_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("uint16_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint16_t n = *((uint16_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "uint16_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_INT16_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int16_t* nums = (int16_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int16_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int16_t n = *((int16_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int16_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT32_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint32_t* nums = (uint32_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("uint32_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
+
+        if (multiComponent)
         {
-            // Single value
-            uint32_t n = *((uint32_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "uint32_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
+            prefix.prepend(QString("C%1:").arg(msg.compid));
         }
-        break;
-    case MAVLINK_TYPE_INT32_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
+        prefix.prepend(QString("M%1:").arg(msg.sysid));
+
+        MessageNames names;
+        names.columnIds.resize(plan->columnCount());
+        foreach (const MAVLinkFieldPlan& field, plan->fields)
         {
-            int32_t* nums = (int32_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int32_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
+            QString name = useFieldName ? prefix + field.name : prefix;
+            names.fieldNames.append(name);
+
+            if (field.firstColumn == -1)
             {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
+                continue;
             }
-        }
-        else
-        {
-            // Single value
-            int32_t n = *((int32_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int32_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_FLOAT:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            float* nums = (float*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("float[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
+            else if (field.arrayLength == 0)
             {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (float)(nums[j]), time);
+                names.columnIds[field.firstColumn] = curveId(name, field.typeName);
             }
-        }
-        else
-        {
-            // Single value
-            float f = *((float*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "float";
-            emit valueChanged(msg->sysid, name, fieldType, f, time);
-        }
-        break;
-    case MAVLINK_TYPE_DOUBLE:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            double* nums = (double*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("double[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
+            else
             {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
+                for (unsigned int j = 0; j < field.arrayLength; ++j)
+                {
+                    names.columnIds[field.firstColumn + j] = curveId(QString("%1.%2").arg(name).arg(j), field.typeName);
+                }
             }
         }
-        else
-        {
-            // Single value
-            double f = *((double*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "double";
-            emit valueChanged(msg->sysid, name, fieldType, f, time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT64_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
+        iter = namedCache.insert(qMakePair(key, content), names);
+    }
+    const MessageNames& names = iter.value();
+
+    for (int i = 0; i < plan->fields.count(); i++)
+    {
+        const MAVLinkFieldPlan& field = plan->fields[i];
+
+        if (field.firstColumn == -1)
         {
-            uint64_t* nums = (uint64_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("uint64_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (quint64) nums[j], time);
-            }
+            if (!textMessageFilter.contains(msg.msgid)) emit textMessageReceived(msg.sysid, msg.compid, MAV_SEVERITY_INFO, names.fieldNames[i] + ": " + plan->fieldValue(msg, i).toString());
         }
         else
         {
-            // Single value
-            uint64_t n = *((uint64_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "uint64_t";
-            emit valueChanged(msg->sysid, name, fieldType, (quint64) n, time);
-        }
-        break;
-    case MAVLINK_TYPE_INT64_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int64_t* nums = (int64_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int64_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
+            int columnCount = field.arrayLength == 0 ? 1 : static_cast<int>(field.arrayLength);
+            for (int j = 0; j < columnCount; ++j)
             {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (qint64) nums[j], time);
+                emit curveValueChanged(msg.sysid, names.columnIds[field.firstColumn + j], plan->columnValue(msg, field.firstColumn + j), time);
             }
         }
-        else
-        {
-            // Single value
-            int64_t n = *((int64_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int64_t";
-            emit valueChanged(msg->sysid, name, fieldType, (qint64) n, time);
-        }
-        break;
-    default:
-        qDebug() << "WARNING: UNKNOWN MAVLINK TYPE";
     }
 }
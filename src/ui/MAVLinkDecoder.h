@@ -3,8 +3,11 @@
 
 #include <QObject>
 #include <QHash>
+#include <QMutex>
+#include <QVector>
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkDecodePlan.h"
 
 struct SystemData {
     /**
@@ -24,6 +27,14 @@ struct SystemData {
     quint64 firstOnboardTime;   ///< First seen onboard time
 };
 
+/// Most recent state of one message id from one component
+struct MAVLinkMessageSnapshot {
+    mavlink_message_t   message;    ///< Most recent message
+    quint64             time;       ///< Ground time the most recent message was received, msecs
+    quint32             count;      ///< Number of messages received
+    QVector<double>     columns;    ///< Decoded numeric columns of the most recent message, see MAVLinkDecodePlan
+};
+
 class MAVLinkDecoder : public QThread
 {
     Q_OBJECT
@@ -32,24 +43,59 @@ public:
 
     void run();
 
+    /// Thread safe. Returns the latest state of all received messages. Meant to be polled at the
+    /// refresh rate of the consumer instead of listening to every field update.
+    ///     @param sysid Only return messages from this system, 0 for all
+    ///     @param compid Only return messages from this component, 0 for all
+    QList<MAVLinkMessageSnapshot> snapshots(int sysid = 0, int compid = 0) const;
+
+    /// Thread safe. Looks up the name and unit of a curve id emitted through curveValueChanged.
+    /// Consumers resolve each id once and keep the result.
+    ///     @return false if the id is unknown
+    bool curve(int curveId, QString& name, QString& unit) const;
+
 signals:
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec);
+    /// A field value was decoded. The field is identified by a curve id instead of name and unit, see curve()
+    void curveValueChanged(const int uasId, const int curveId, const QVariant& value, const quint64 msec);
     void finish(); ///< Trigger a thread safe shutdown
 
 public slots:
     /** @brief Receive one message from the protocol and decode it */
     void receiveMessage(LinkInterface* link,mavlink_message_t message);
 protected:
-    /** @brief Emit the value of one message field */
-    void emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time);
+    /** @brief Emit the values of all fields of a message with a precomputed name */
+    void emitFieldValues(const mavlink_message_t& msg, const MAVLinkDecodePlan* plan, bool multiComponent, quint64 time);
+    /** @brief Emit the values of all fields of a message which is named from its content */
+    void emitNamedFieldValues(const mavlink_message_t& msg, const MAVLinkDecodePlan* plan, bool multiComponent, quint64 time);
+    /** @brief Get the id for a curve, assigning a new one the first time the curve is seen */
+    int curveId(const QString& name, const QString& unit);
+    /** @brief Store the message for snapshots() */
+    void updateSnapshot(const mavlink_message_t& msg, const MAVLinkDecodePlan* plan);
     /** @brief Shift a timestamp in Unix time if necessary */
     quint64 getUnixTimeFromMs(int systemID, quint64 time);
 
     QMap<uint16_t, bool> messageFilter;                     ///< Message/field names not to emit
     QMap<uint16_t, bool> textMessageFilter;                 ///< Message/field names not to emit in text mode
-    QHash<int, mavlink_message_t> msgDict; ///< dictionary of all mavlink messages
     QHash<int, SystemData> sysDict; ///< dictionary of all systmes
+    MAVLinkDecodePlanCache planCache;                       ///< Decode plans, only used from the decoder thread
+
+    /// Emitted names for one message id from one system: "M1:MSG.field" or "M1:C1:MSG.field"
+    struct MessageNames {
+        QStringList fieldNames;     ///< Name for each field, used for text fields
+        QVector<int> columnIds;     ///< Curve id for each numeric column
+    };
+    QHash<quint64, MessageNames> nameCache;                 ///< Keyed by system, component (if multi component) and message id
+    /// Same for messages named from their content, keyed by source as for nameCache and the naming content
+    QHash<QPair<quint64, QByteArray>, MessageNames> namedCache;
+    QHash<QString, int> curveIds;                           ///< Curve ids keyed by name and unit, only used from the decoder thread
+
+    mutable QMutex curveMutex;
+    QVector<QPair<QString, QString> > curves;               ///< Name and unit indexed by curve id
+
+    mutable QMutex snapshotMutex;
+    QHash<quint64, MAVLinkMessageSnapshot> snapshotDict;    ///< Keyed by system, component and message id
+    MAVLinkProtocol* protocol;                              ///< Source of messages and vehicle clock estimates
     QThread* creationThread;                                ///< QThread on which the object is created
 };
 
@@ -282,7 +282,6 @@ MAVLinkDecoder* MainWindow::_mavLinkDecoderInstance(void)
 {
     if (!_mavlinkDecoder) {
         _mavlinkDecoder = new MAVLinkDecoder(qgcApp()->toolbox()->mavlinkProtocol());
-        connect(_mavlinkDecoder, &MAVLinkDecoder::valueChanged, this, &MainWindow::valueChanged);
     }
 
     return _mavlinkDecoder;
@@ -336,7 +335,7 @@ bool MainWindow::_createInnerDockWidget(const QString& widgetName)
     if(action) {
         switch(action->data().toInt()) {
             case MAVLINK_INSPECTOR:
-                widget = new QGCMAVLinkInspector(widgetName, action, qgcApp()->toolbox()->mavlinkProtocol(),this);
+                widget = new QGCMAVLinkInspector(widgetName, action, _mavLinkDecoderInstance(), this);
                 break;
             case CUSTOM_COMMAND:
                 widget = new CustomCommandWidget(widgetName, action, this);
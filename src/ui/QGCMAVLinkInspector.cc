@@ -9,12 +9,14 @@
 #include <QList>
 #include <QDebug>
 
+#include <iterator>
+
 const float QGCMAVLinkInspector::updateHzLowpass = 0.2f;
 const unsigned int QGCMAVLinkInspector::updateInterval = 1000U;
 
-QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action, MAVLinkProtocol* protocol, QWidget *parent) :
+QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action, MAVLinkDecoder* decoder, QWidget *parent) :
     QGCDockWidget(title, action, parent),
-    _protocol(protocol),
+    _decoder(decoder),
     selectedSystemID(0),
     selectedComponentID(0),
     ui(new Ui::QGCMAVLinkInspector)
@@ -42,7 +44,6 @@ QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action,
 
     // Connect external connections
     connect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::vehicleAdded, this, &QGCMAVLinkInspector::_vehicleAdded);
-    connect(protocol, &MAVLinkProtocol::messageReceived, this, &QGCMAVLinkInspector::receiveMessage);
 
     // Attach the UI's refresh rate to a timer.
     connect(&updateTimer, &QTimer::timeout, this, &QGCMAVLinkInspector::refreshView);
@@ -102,171 +103,97 @@ void QGCMAVLinkInspector::addComponent(int uas, int component, const QString& na
 }
 
 /**
- * Reset the view. This entails clearing all data structures and resetting data from already-
- * received messages.
+ * Reset the view. This entails clearing all data structures. Messages which are still being
+ * received show up again on the next refresh.
  */
 void QGCMAVLinkInspector::clearView()
 {
-    QMap<int, mavlink_message_t* >::iterator ite;
-    for(ite=uasMessageStorage.begin(); ite!=uasMessageStorage.end();++ite)
-    {
-        delete ite.value();
-        ite.value() = NULL;
-    }
-    uasMessageStorage.clear();
-
-    QMap<int, QMap<int, QTreeWidgetItem*>* >::iterator iteMsg;
-    for (iteMsg=uasMsgTreeItems.begin(); iteMsg!=uasMsgTreeItems.end();++iteMsg)
-    {
-        QMap<int, QTreeWidgetItem*>* msgTreeItems = iteMsg.value();
-
-        QList<int> groupKeys = msgTreeItems->uniqueKeys();
-        QList<int>::iterator listKeys;
-        for (listKeys=groupKeys.begin();listKeys!=groupKeys.end();++listKeys)
-        {
-            delete msgTreeItems->take(*listKeys);
-        }
-    }
-    uasMsgTreeItems.clear();
-
-    QMap<int, QTreeWidgetItem* >::iterator iteTree;
-    for(iteTree=uasTreeWidgetItems.begin(); iteTree!=uasTreeWidgetItems.end();++iteTree)
-    {
-        delete iteTree.value();
-        iteTree.value() = NULL;
-    }
+    uasMessageItems.clear();
     uasTreeWidgetItems.clear();
-    
-    QMap<int, QMap<int, float>* >::iterator iteHz;
-    for (iteHz=uasMessageHz.begin(); iteHz!=uasMessageHz.end();++iteHz)
-    {
-
-        iteHz.value()->clear();
-        delete iteHz.value();
-        iteHz.value() = NULL;
-    }
-    uasMessageHz.clear();
-
-    QMap<int, QMap<int, unsigned int>* >::iterator iteCount;
-    for(iteCount=uasMessageCount.begin(); iteCount!=uasMessageCount.end();++iteCount)
-    {
-        iteCount.value()->clear();
-        delete iteCount.value();
-        iteCount.value() = NULL;
-    }
-    uasMessageCount.clear();
-
-    QMap<int, QMap<int, quint64>* >::iterator iteLast;
-    for(iteLast=uasLastMessageUpdate.begin(); iteLast!=uasLastMessageUpdate.end();++iteLast)
-    {
-        iteLast.value()->clear();
-        delete iteLast.value();
-        iteLast.value() = NULL;
-    }
-    uasLastMessageUpdate.clear();
-
-    onboardMessageInterval.clear();
 
+    // Deletes all message and field items as well
     ui->treeWidget->clear();
 }
 
 void QGCMAVLinkInspector::refreshView()
 {
-    QMap<int, mavlink_message_t* >::const_iterator ite;
-
-    for(ite=uasMessageStorage.constBegin(); ite!=uasMessageStorage.constEnd();++ite)
+    // Pull the latest state of each message, a message can come from multiple components of the same system
+    QMap<quint64, MAVLinkMessageSnapshot> latest;
+    foreach (const MAVLinkMessageSnapshot& snapshot, _decoder->snapshots(selectedSystemID, selectedComponentID))
     {
-        mavlink_message_t* msg = ite.value();
-        const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
-
-        if (!msgInfo) {
-            qWarning() << QStringLiteral("QGCMAVLinkInspector::refreshView NULL msgInfo msgid(%1)").arg(msg->msgid);
-            continue;
-        }
-
-        // Ignore NULL values
-        if (msg->msgid == 0xFF) continue;
-
-        // Update the message frenquency
-
-        // Get the previous frequency for low-pass filtering
-        float msgHz = 0.0f;
-        QMap<int, QMap<int, float>* >::const_iterator iteHz = uasMessageHz.find(msg->sysid);
-        QMap<int, float>* uasMsgHz = iteHz.value();
-
-        while((iteHz != uasMessageHz.end()) && (iteHz.key() == msg->sysid))
+        quint64 key = (static_cast<quint64>(snapshot.message.sysid) << 32) | snapshot.message.msgid;
+        QMap<quint64, MAVLinkMessageSnapshot>::iterator iter = latest.find(key);
+        if (iter == latest.end())
         {
-            if(iteHz.value()->contains(msg->msgid))
-            {
-                uasMsgHz = iteHz.value();
-                msgHz = iteHz.value()->value(msg->msgid);
-                break;
-            }
-            ++iteHz;
+            latest.insert(key, snapshot);
         }
-
-        // Get the number of message received
-        float msgCount = 0;
-        QMap<int, QMap<int, unsigned int> * >::const_iterator iter = uasMessageCount.find(msg->sysid);
-        QMap<int, unsigned int>* uasMsgCount = iter.value();
-
-        while((iter != uasMessageCount.end()) && (iter.key()==msg->sysid))
+        else
         {
-            if(iter.value()->contains(msg->msgid))
+            quint32 count = iter.value().count + snapshot.count;
+            if (snapshot.time > iter.value().time)
             {
-                msgCount = (float) iter.value()->value(msg->msgid);
-                uasMsgCount = iter.value();
-                break;
+                iter.value() = snapshot;
             }
-            ++iter;
+            iter.value().count = count;
         }
+    }
 
-        // Compute the new low-pass filtered frequency and update the message count
-        msgHz = (1.0f-updateHzLowpass)* msgHz + updateHzLowpass*msgCount/((float)updateInterval/1000.0f);
-        uasMsgHz->insert(msg->msgid,msgHz);
-        uasMsgCount->insert(msg->msgid,(unsigned int) 0);
+    foreach (const MAVLinkMessageSnapshot& snapshot, latest)
+    {
+        const mavlink_message_t& msg = snapshot.message;
+        const MAVLinkDecodePlan* plan = _planCache.plan(msg.msgid);
 
-        // Update the tree view
-        QString messageName("%1 (%2 Hz, #%3)");
-        messageName = messageName.arg(msgInfo->name).arg(msgHz, 3, 'f', 1).arg(msg->msgid);
+        if (!plan) {
+            qWarning() << QStringLiteral("QGCMAVLinkInspector::refreshView NULL msgInfo msgid(%1)").arg(msg.msgid);
+            continue;
+        }
 
-        addUAStoTree(msg->sysid);
+        addUAStoTree(msg.sysid);
 
-        // Look for the tree for the UAS sysid
-        QMap<int, QTreeWidgetItem*>* msgTreeItems = uasMsgTreeItems.value(msg->sysid);
-        if (!msgTreeItems)
+        QTreeWidgetItem* uasItem = uasTreeWidgetItems.value(msg.sysid);
+        if (!uasItem)
         {
             // The UAS tree has not been created yet, no update
-            return;
+            continue;
         }
 
         // Add the message with msgid to the tree if not done yet
-        if(!msgTreeItems->contains(msg->msgid))
-        {
-            QStringList fields;
-            fields << messageName;
-            QTreeWidgetItem* widget = new QTreeWidgetItem();
-            for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
-            {
-                QTreeWidgetItem* field = new QTreeWidgetItem();
-                widget->addChild(field);
-            }
-            msgTreeItems->insert(msg->msgid,widget);
-            QList<int> groupKeys = msgTreeItems->uniqueKeys();
-            int insertIndex = groupKeys.indexOf(msg->msgid);
-            uasTreeWidgetItems.value(msg->sysid)->insertChild(insertIndex,widget);
-        }
+        QMap<uint32_t, MessageItem>& msgItems = uasMessageItems[msg.sysid];
+        QMap<uint32_t, MessageItem>::iterator iter = msgItems.find(msg.msgid);
+        bool newItem = iter == msgItems.end();
+        if (newItem)
+        {
+            MessageItem msgItem;
+            msgItem.item = new QTreeWidgetItem();
+            msgItem.item->setFirstColumnSpanned(true);
+            msgItem.lastCount = snapshot.count;
+            msgItem.hz = 0.0f;
+            foreach (const MAVLinkFieldPlan& field, plan->fields)
+            {
+                QTreeWidgetItem* fieldItem = new QTreeWidgetItem();
+                fieldItem->setData(0, Qt::DisplayRole, field.name);
+                fieldItem->setData(2, Qt::DisplayRole, field.typeName);
+                msgItem.item->addChild(fieldItem);
+            }
+            iter = msgItems.insert(msg.msgid, msgItem);
+            uasItem->insertChild(std::distance(msgItems.begin(), iter), msgItem.item);
+        }
+        MessageItem& msgItem = iter.value();
+
+        // Compute the new low-pass filtered frequency
+        // The count goes backwards when the component selection changes
+        quint32 receivedCount = snapshot.count >= msgItem.lastCount ? snapshot.count - msgItem.lastCount : 0;
+        msgItem.lastCount = snapshot.count;
+        msgItem.hz = (1.0f-updateHzLowpass)* msgItem.hz + updateHzLowpass*receivedCount/((float)updateInterval/1000.0f);
+
+        QString messageName("%1 (%2 Hz, #%3)");
+        messageName = messageName.arg(plan->name).arg(msgItem.hz, 3, 'f', 1).arg(msg.msgid);
+        msgItem.item->setData(0, Qt::DisplayRole, messageName);
 
-        // Update the message
-        QTreeWidgetItem* message = msgTreeItems->value(msg->msgid);
-        if(message)
+        // Field values only change when a new message came in
+        if (newItem || receivedCount > 0)
         {
-            message->setFirstColumnSpanned(true);
-            message->setData(0, Qt::DisplayRole, QVariant(messageName));
-            for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
-            {
-                updateField(msg, msgInfo, i, message->child(i));
-            }
+            updateFields(plan, msg, msgItem.item);
         }
     }
 }
@@ -286,131 +213,7 @@ void QGCMAVLinkInspector::addUAStoTree(int sysId)
             uasWidget->setFirstColumnSpanned(true);
             uasTreeWidgetItems.insert(sysId,uasWidget);
             ui->treeWidget->addTopLevelItem(uasWidget);
-            uasMsgTreeItems.insert(sysId,new QMap<int, QTreeWidgetItem*>());
-        }
-    }
-}
-
-void QGCMAVLinkInspector::receiveMessage(LinkInterface* link,mavlink_message_t message)
-{
-    Q_UNUSED(link);
-
-    quint64 receiveTime;
-    
-    if (selectedSystemID != 0 && selectedSystemID != message.sysid) return;
-    if (selectedComponentID != 0 && selectedComponentID != message.compid) return;
-
-    // Create dynamically an array to store the messages for each UAS
-    if (!uasMessageStorage.contains(message.sysid))
-    {
-        mavlink_message_t* msg = new mavlink_message_t;
-        *msg = message;
-        uasMessageStorage.insertMulti(message.sysid,msg);
-    }
-
-    bool msgFound = false;
-    QMap<int, mavlink_message_t* >::const_iterator iteMsg = uasMessageStorage.find(message.sysid);
-    mavlink_message_t* uasMessage = iteMsg.value();
-    while((iteMsg != uasMessageStorage.end()) && (iteMsg.key() == message.sysid))
-    {
-        if (iteMsg.value()->msgid == message.msgid)
-        {
-            msgFound = true;
-            uasMessage = iteMsg.value();
-            break;
-        }
-        ++iteMsg;
-    }
-    if (!msgFound)
-    {
-        mavlink_message_t* msgIdMessage = new mavlink_message_t;
-        *msgIdMessage = message;
-        uasMessageStorage.insertMulti(message.sysid,msgIdMessage);
-    }
-    else
-    {
-        *uasMessage = message;
-    }
-
-    // Looking if this message has already been received once
-    msgFound = false;
-    QMap<int, QMap<int, quint64>* >::const_iterator ite = uasLastMessageUpdate.find(message.sysid);
-    QMap<int, quint64>* lastMsgUpdate = ite.value();
-    while((ite != uasLastMessageUpdate.end()) && (ite.key() == message.sysid))
-    {   
-        if(ite.value()->contains(message.msgid))
-        {
-            msgFound = true;
-
-            // Point to the found message
-            lastMsgUpdate = ite.value();
-            break;
-        }
-        ++ite;
-    }
-
-    receiveTime = QGC::groundTimeMilliseconds();
-
-    // If the message doesn't exist, create a map for the frequency, message count and time of reception
-    if(!msgFound)
-    {
-        // Create a map for the message frequency
-        QMap<int, float>* messageHz = new QMap<int,float>;
-        messageHz->insert(message.msgid,0.0f);
-        uasMessageHz.insertMulti(message.sysid,messageHz);
-
-        // Create a map for the message count
-        QMap<int, unsigned int>* messagesCount = new QMap<int, unsigned int>;
-        messagesCount->insert(message.msgid,0);
-        uasMessageCount.insertMulti(message.sysid,messagesCount);
-
-        // Create a map for the time of reception of the message
-        QMap<int, quint64>* lastMessage = new QMap<int, quint64>;
-        lastMessage->insert(message.msgid,receiveTime);
-        uasLastMessageUpdate.insertMulti(message.sysid,lastMessage);
-
-        // Point to the created message
-        lastMsgUpdate = lastMessage;
-    }
-    else
-    {
-        // The message has been found/created
-        if ((lastMsgUpdate->contains(message.msgid))&&(uasMessageCount.contains(message.sysid)))
-        {
-            // Looking for and updating the message count
-            unsigned int count = 0;
-            QMap<int, QMap<int, unsigned int>* >::const_iterator iter = uasMessageCount.find(message.sysid);
-            QMap<int, unsigned int> * uasMsgCount = iter.value();
-            while((iter != uasMessageCount.end()) && (iter.key() == message.sysid))
-            {
-                if(iter.value()->contains(message.msgid))
-                {
-                    uasMsgCount = iter.value();
-                    count = uasMsgCount->value(message.msgid,0);
-                    uasMsgCount->insert(message.msgid,count+1);
-                    break;
-                }
-                ++iter;
-            }
         }
-        lastMsgUpdate->insert(message.msgid,receiveTime);
-    }
-
-    if (selectedSystemID == 0 || selectedComponentID == 0)
-    {
-        return;
-    }
-
-    switch (message.msgid)
-    {
-        case MAVLINK_MSG_ID_DATA_STREAM:
-            {
-                mavlink_data_stream_t stream;
-                mavlink_msg_data_stream_decode(&message, &stream);
-                onboardMessageInterval.insert(stream.stream_id, stream.message_rate);
-            }
-            break;
-
     }
 }
 
@@ -420,271 +223,10 @@ QGCMAVLinkInspector::~QGCMAVLinkInspector()
     delete ui;
 }
 
-void QGCMAVLinkInspector::updateField(mavlink_message_t* msg, const mavlink_message_info_t* msgInfo, int fieldid, QTreeWidgetItem* item)
+void QGCMAVLinkInspector::updateFields(const MAVLinkDecodePlan* plan, const mavlink_message_t& msg, QTreeWidgetItem* message)
 {
-    // Add field tree widget item
-    item->setData(0, Qt::DisplayRole, QVariant(msgInfo->fields[fieldid].name));
-    
-    bool msgFound = false;
-    QMap<int, mavlink_message_t* >::const_iterator iteMsg = uasMessageStorage.find(msg->sysid);
-    mavlink_message_t* uasMessage = iteMsg.value();
-    while((iteMsg != uasMessageStorage.end()) && (iteMsg.key() == msg->sysid))
-    {
-        if (iteMsg.value()->msgid == msg->msgid)
-        {
-            msgFound = true;
-            uasMessage = iteMsg.value();
-            break;
-        }
-        ++iteMsg;
-    }
-
-    if (!msgFound)
-    {
-        return;
-    }
-
-    uint8_t* m = (uint8_t*)&uasMessage->payload64[0];
-
-    switch (msgInfo->fields[fieldid].type)
+    for (int i = 0; i < plan->fields.count() && i < message->childCount(); i++)
     {
-    case MAVLINK_TYPE_CHAR:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            char* str = (char*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            str[msgInfo->fields[fieldid].array_length-1] = '\0';
-            QString string(str);
-            item->setData(2, Qt::DisplayRole, "char");
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single char
-            char b = *((char*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, QString("char[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, b);
-        }
-        break;
-    case MAVLINK_TYPE_UINT8_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint8_t* nums = m+msgInfo->fields[fieldid].wire_offset;
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("uint8_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            uint8_t u = *(m+msgInfo->fields[fieldid].wire_offset);
-            item->setData(2, Qt::DisplayRole, "uint8_t");
-            item->setData(1, Qt::DisplayRole, u);
-        }
-        break;
-    case MAVLINK_TYPE_INT8_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int8_t* nums = (int8_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("int8_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            int8_t n = *((int8_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "int8_t");
-            item->setData(1, Qt::DisplayRole, n);
-        }
-        break;
-    case MAVLINK_TYPE_UINT16_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint16_t* nums = (uint16_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("uint16_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            uint16_t n = *((uint16_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "uint16_t");
-            item->setData(1, Qt::DisplayRole, n);
-        }
-        break;
-    case MAVLINK_TYPE_INT16_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int16_t* nums = (int16_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("int16_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            int16_t n = *((int16_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "int16_t");
-            item->setData(1, Qt::DisplayRole, n);
-        }
-        break;
-    case MAVLINK_TYPE_UINT32_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint32_t* nums = (uint32_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("uint32_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            float n = *((uint32_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "uint32_t");
-            item->setData(1, Qt::DisplayRole, n);
-        }
-        break;
-    case MAVLINK_TYPE_INT32_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int32_t* nums = (int32_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("int32_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            int32_t n = *((int32_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "int32_t");
-            item->setData(1, Qt::DisplayRole, n);
-        }
-        break;
-    case MAVLINK_TYPE_FLOAT:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            float* nums = (float*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-               string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("float[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            float f = *((float*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "float");
-            item->setData(1, Qt::DisplayRole, f);
-        }
-        break;
-    case MAVLINK_TYPE_DOUBLE:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            double* nums = (double*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("double[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            double f = *((double*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "double");
-            item->setData(1, Qt::DisplayRole, f);
-        }
-        break;
-    case MAVLINK_TYPE_UINT64_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint64_t* nums = (uint64_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("uint64_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            uint64_t n = *((uint64_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "uint64_t");
-            item->setData(1, Qt::DisplayRole, (quint64) n);
-        }
-        break;
-    case MAVLINK_TYPE_INT64_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int64_t* nums = (int64_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            QString tmp("%1, ");
-            QString string;
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                string += tmp.arg(nums[j]);
-            }
-            item->setData(2, Qt::DisplayRole, QString("int64_t[%1]").arg(msgInfo->fields[fieldid].array_length));
-            item->setData(1, Qt::DisplayRole, string);
-        }
-        else
-        {
-            // Single value
-            int64_t n = *((int64_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            item->setData(2, Qt::DisplayRole, "int64_t");
-            item->setData(1, Qt::DisplayRole, (qint64) n);
-        }
-        break;
+        message->child(i)->setData(1, Qt::DisplayRole, plan->fieldValue(msg, i));
     }
 }
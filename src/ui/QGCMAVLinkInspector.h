@@ -5,7 +5,8 @@
 #include <QTimer>
 
 #include "QGCDockWidget.h"
-#include "MAVLinkProtocol.h"
+#include "MAVLinkDecoder.h"
+#include "MAVLinkDecodePlan.h"
 #include "Vehicle.h"
 
 namespace Ui {
@@ -20,14 +21,13 @@ class QGCMAVLinkInspector : public QGCDockWidget
     Q_OBJECT
 
 public:
-    explicit QGCMAVLinkInspector(const QString& title, QAction* action, MAVLinkProtocol* protocol, QWidget *parent = 0);
+    explicit QGCMAVLinkInspector(const QString& title, QAction* action, MAVLinkDecoder* decoder, QWidget *parent = 0);
     ~QGCMAVLinkInspector();
 
 public slots:
-    void receiveMessage(LinkInterface* link,mavlink_message_t message);
     /** @brief Clear all messages */
     void clearView();
-    /** @brief Update view */
+    /** @brief Update view from the latest decoder snapshots */
     void refreshView();
     /** @brief Add component to the list */
     void addComponent(int uas, int component, const QString& name);
@@ -37,26 +37,26 @@ public slots:
     void selectDropDownMenuComponent(int dropdownid);
 
 protected:
-    MAVLinkProtocol *_protocol;     ///< MAVLink instance
+    /// Tree item and rate of one message id of one UAS
+    struct MessageItem {
+        QTreeWidgetItem*    item;
+        quint32             lastCount;  ///< Message count at the previous refresh
+        float               hz;         ///< Low-pass filtered message rate
+    };
+
+    MAVLinkDecoder *_decoder;       ///< Source of message snapshots
+    MAVLinkDecodePlanCache _planCache; ///< Field layout of each message id
     int selectedSystemID;          ///< Currently selected system
     int selectedComponentID;       ///< Currently selected component
     QMap<int, int> systems;     ///< Already observed systems
     QMap<int, int> components; ///< Already observed components
-    QMap<int, float> onboardMessageInterval; ///< Stores the onboard selected data rate
     QTimer updateTimer; ///< Only update at 1 Hz to not overload the GUI
 
     QMap<int, QTreeWidgetItem* > uasTreeWidgetItems; ///< Tree of available uas with their widget
-    QMap<int, QMap<int, QTreeWidgetItem*>* > uasMsgTreeItems; ///< Stores the widget of the received message for each UAS
+    QMap<int, QMap<uint32_t, MessageItem> > uasMessageItems; ///< Message items of each UAS, ordered by message id
 
-    QMap<int, mavlink_message_t* > uasMessageStorage; ///< Stores the messages for every UAS
-
-    QMap<int, QMap<int, float>* > uasMessageHz; ///< Stores the frequency of each message of each UAS
-    QMap<int, QMap<int, unsigned int>* > uasMessageCount; ///< Stores the message count of each message of each UAS
-
-    QMap<int, QMap<int, quint64>* > uasLastMessageUpdate; ///< Stores the time of the last message for each message of each UAS
-
-    /* @brief Update one message field */
-    void updateField(mavlink_message_t* msg, const mavlink_message_info_t* msgInfo, int fieldid, QTreeWidgetItem* item);
+    /* @brief Update the field items of one message */
+    void updateFields(const MAVLinkDecodePlan* plan, const mavlink_message_t& msg, QTreeWidgetItem* message);
     /** @brief Rebuild the list of components */
     void rebuildComponentList();
     /* @brief Create a new tree for a new UAS */
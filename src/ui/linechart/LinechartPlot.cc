@@ -183,33 +183,46 @@ void LinechartPlot::setActive(bool active)
 
 void LinechartPlot::removeTimedOutCurves()
 {
-    foreach(const QString &key, lastUpdate.keys())
+    foreach(const QString &key, data.keys())
     {
-        quint64 time = lastUpdate.value(key);
+        quint64 time = data.value(key)->getLastTime();
         if (QGC::groundTimeMilliseconds() - time > 10000)
         {
-            // Remove this curve
-            // Delete curves
-            QwtPlotCurve* curve = _curves.take(key);
-            // Delete the object
-            delete curve;
-            // Set the pointer null
-            curve = NULL;
-
-            // Notify connected components about the removal
-            emit curveRemoved(key);
-
-            // Remove from data list
-            TimeSeriesData* d = data.take(key);
-            // Delete the object
-            delete d;
-            // Set the pointer null
-            d = NULL;
-            emit curveRemoved(key);
+            removeSeries(key);
         }
     }
 }
 
+/**
+ * @brief Remove a curve and its data
+ *
+ * @param id The id of the curve
+ **/
+void LinechartPlot::removeSeries(const QString& id)
+{
+    // Delete curve, which also deletes the curve data adapter
+    QwtPlotCurve* curve = _curves.take(id);
+    delete curve;
+
+    datalock.lock();
+
+    // Invalidate series id, ids are never reused
+    QHash<QString, int>::iterator iter = seriesIds.find(id);
+    if (iter != seriesIds.end()) {
+        seriesById[iter.value()] = NULL;
+        seriesIds.erase(iter);
+    }
+
+    // Remove from data list
+    TimeSeriesData* d = data.take(id);
+    delete d;
+
+    datalock.unlock();
+
+    // Notify connected components about the removal
+    emit curveRemoved(id);
+}
+
 /**
  * @brief Set the zero (center line) value
  * The zero value defines the centerline of the plot.
@@ -222,26 +235,46 @@ void LinechartPlot::setZeroValue(QString id, double zeroValue)
     if(data.contains(id)) {
         data.value(id)->setZeroValue(zeroValue);
     } else {
-        data.insert(id, new TimeSeriesData(this, id, maxInterval, zeroValue));
+        data.insert(id, new TimeSeriesData(this, id, zeroValue));
     }
 }
 
 void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
 {
-    /* Lock resource to ensure data integrity */
-    datalock.lock();
+    appendData(getSeriesId(dataname), ms, value);
+}
+
+int LinechartPlot::getSeriesId(const QString& dataname)
+{
+    QHash<QString, int>::const_iterator iter = seriesIds.constFind(dataname);
+    if (iter != seriesIds.constEnd()) {
+        return iter.value();
+    }
 
     /* Check if dataset identifier already exists */
-    if(!data.contains(dataname)) {
+    if(!_curves.contains(dataname)) {
         addCurve(dataname);
         enforceGroundTime(m_groundTime);
-//        qDebug() << "ADDING CURVE WITH" << dataname << ms << value;
-//        qDebug() << "MINTIME:" << minTime << "MAXTIME:" << maxTime;
-//        qDebug() << "LASTTIME:" << lastTime;
     }
 
-    // Add new value
-    TimeSeriesData* dataset = data.value(dataname);
+    datalock.lock();
+    int seriesId = seriesById.count();
+    seriesById.append(data.value(dataname));
+    seriesIds.insert(dataname, seriesId);
+    datalock.unlock();
+    return seriesId;
+}
+
+bool LinechartPlot::appendData(int seriesId, quint64 ms, double value)
+{
+    /* Lock resource to ensure data integrity, removal of a series nulls its entry under the same lock */
+    datalock.lock();
+
+    TimeSeriesData* dataset = (seriesId >= 0 && seriesId < seriesById.count()) ? seriesById[seriesId] : NULL;
+    if (!dataset) {
+        datalock.unlock();
+        return false;
+    }
 
     quint64 time;
 
@@ -257,8 +290,6 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
     }
     dataset->append(time, value);
 
-    lastUpdate.insert(dataname, time);
-
     // Scaling values
     if(ms < minTime) minTime = ms;
     if(ms > maxTime) maxTime = ms;
@@ -266,22 +297,17 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
 
     if(time > lastTime)
     {
-        //qDebug() << "UPDATED LAST TIME!" << dataname << time << lastTime;
         lastTime = time;
     }
 
-    //
     if (value < minValue) minValue = value;
     if (value > maxValue) maxValue = value;
     valueInterval = maxValue - minValue;
 
-    // Assign dataset to curve
-    QwtPlotCurve* curve = _curves.value(dataname);
-    curve->setRawSamples(dataset->getPlotX(), dataset->getPlotY(), dataset->getPlotCount());
-
-    //    qDebug() << "mintime" << minTime << "maxtime" << maxTime << "last max time" << "window position" << getWindowPosition();
+    // The curve pulls decimated samples from the dataset on the next replot, nothing to assign here
 
     datalock.unlock();
+    return true;
 }
 
 /**
@@ -342,11 +368,15 @@ void LinechartPlot::addCurve(QString id)
         sym.setSize(3);
         curve->setSymbol(sym);*/
 
-    // Create dataset
-    TimeSeriesData* dataset = new TimeSeriesData(this, id, this->plotInterval, maxInterval);
+    // Create dataset, unless one was already created through setZeroValue
+    TimeSeriesData* dataset = data.value(id, NULL);
+    if (!dataset) {
+        dataset = new TimeSeriesData(this, id);
+        data.insert(id, dataset);
+    }
 
-    // Add dataset to list
-    data.insert(id, dataset);
+    // Curve takes ownership of the adapter
+    curve->setData(new TimeSeriesCurveData(dataset));
 
     // Notify connected components about new curve
     emit curveAdded(id);
@@ -574,19 +604,7 @@ quint64 LinechartPlot::getPlotInterval()
  **/
 void LinechartPlot::setPlotInterval(int interval)
 {
-    //Only ever increase the amount of stored data,
-    // so that we allow the user to change between
-    // different intervals without constantly losing
-    // data points
-    if((unsigned)interval > plotInterval) {
-
-        QMap<QString, TimeSeriesData*>::iterator j;
-        for(j = data.begin(); j != data.end(); ++j)
-        {
-            TimeSeriesData* d = data.value(j.key());
-            d->setInterval(interval);
-        }
-    }
+    // Stored data is independent of the plot interval, curves decimate to the visible interval on replot
     plotInterval = interval;
     if(plotInterval > 5*60*1000) //If the interval is longer than 4 minutes, change the time scale step to 2 minutes
         timeScaleStep = 2*60*1000;
@@ -704,54 +722,63 @@ void LinechartPlot::removeAllData()
     QMap<QString, QwtPlotCurve*>::iterator i;
     for(i = _curves.begin(); i != _curves.end(); ++i)
     {
-        // Remove from curve list
-        QwtPlotCurve* curve = _curves.take(i.key());
         // Delete the object
-        delete curve;
-        // Set the pointer null
-        curve = NULL;
+        delete i.value();
 
         // Notify connected components about the removal
         emit curveRemoved(i.key());
     }
+    _curves.clear();
 
     // Delete data
-    QMap<QString, TimeSeriesData*>::iterator j;
-    for(j = data.begin(); j != data.end(); ++j)
-    {
-        // Remove from data list
-        TimeSeriesData* d = data.take(j.key());
-        // Delete the object
-        delete d;
-        // Set the pointer null
-        d = NULL;
+    qDeleteAll(data);
+    data.clear();
+
+    // Invalidate all series ids
+    seriesIds.clear();
+    for (int j = 0; j < seriesById.count(); j++) {
+        seriesById[j] = NULL;
     }
     datalock.unlock();
     replot();
 }
 
 
-TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plotInterval, quint64 maxInterval, double zeroValue):
+TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, double zeroValue, int capacity):
     minValue(DBL_MAX),
-    maxValue(DBL_MIN),
+    maxValue(-DBL_MAX),
     zeroValue(0),
     count(0),
     mean(0.0),
     median(0.0),
     variance(0.0),
+    windowSum(0.0),
+    windowSumSquares(0.0),
     averageWindow(50)
 {
     this->plot = plot;
     this->friendlyName = friendlyName;
-    this->maxInterval = maxInterval;
     this->zeroValue = zeroValue;
-    this->plotInterval = plotInterval;
+    this->lastValue = 0.0;
+
+    /* round capacity up to a power of 2 so ring positions are a mask */
+    this->capacity = PYRAMID_FANOUT;
+    while (this->capacity < capacity) {
+        this->capacity <<= 1;
+    }
+    mask = this->capacity - 1;
+
+    ms.resize(this->capacity);
+    value.resize(this->capacity);
+
+    /* one pyramid level per fanout step, the top level has a single bucket covering the whole ring */
+    for (int bucketCount = this->capacity >> PYRAMID_SHIFT; bucketCount >= 1; bucketCount >>= PYRAMID_SHIFT) {
+        levels.append(QVector<MinMax>(bucketCount));
+    }
 
     /* initialize time */
     startTime = QUINT64_MAX;
     stopTime = QUINT64_MIN;
-
-    plotCount = 0;
 }
 
 TimeSeriesData::~TimeSeriesData()
@@ -759,14 +786,34 @@ TimeSeriesData::~TimeSeriesData()
 
 }
 
-void TimeSeriesData::setInterval(quint64 ms)
+void TimeSeriesData::setAverageWindowSize(int windowSize)
 {
-    plotInterval = ms;
+    dataMutex.lock();
+    this->averageWindow = qBound(1, windowSize, capacity);
+    _recalcWindow();
+    dataMutex.unlock();
 }
 
-void TimeSeriesData::setAverageWindowSize(int windowSize)
+/**
+ * @brief Recalculate the windowed sums from scratch
+ * Called when the window changes and periodically to shed accumulated rounding error.
+ **/
+void TimeSeriesData::_recalcWindow()
 {
-    this->averageWindow = windowSize;
+    windowSum = 0;
+    windowSumSquares = 0;
+
+    quint64 windowCount = qMin(static_cast<quint64>(averageWindow), count);
+    for (quint64 i = count - windowCount; i < count; i++) {
+        double v = value[i & mask];
+        windowSum += v;
+        windowSumSquares += v * v;
+    }
+
+    if (windowCount > 0) {
+        mean = windowSum / windowCount;
+        variance = qMax(0.0, windowSumSquares / windowCount - mean * mean);
+    }
 }
 
 /**
@@ -778,81 +825,159 @@ void TimeSeriesData::setAverageWindowSize(int windowSize)
 void TimeSeriesData::append(quint64 ms, double value)
 {
     dataMutex.lock();
-    // Qt will automatically use a smart growth strategy: http://doc.qt.io/qt-5/containers.html#growth-strategies
-    this->ms.append(ms);
-    this->value.append(value);
+
+    /* Slide the average window, the sample leaving it is still in the ring since averageWindow <= capacity */
+    if (count >= averageWindow) {
+        double old = this->value[(count - averageWindow) & mask];
+        windowSum -= old;
+        windowSumSquares -= old * old;
+    }
+    windowSum += value;
+    windowSumSquares += value * value;
+
+    quint64 pos = count & mask;
+    this->ms[pos] = ms;
+    this->value[pos] = value;
     this->lastValue = value;
-    this->mean = 0;
-    //QList<double> medianList = QList<double>();
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->mean += this->value[count-i];
-        //medianList.append(this->value[count-i]);
-    }
-    this->mean = mean / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-    this->variance = 0;
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->variance += (this->value[count-i] - mean) * (this->value[count-i] - mean);
-    }
-    this->variance = this->variance / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-//    qSort(medianList);
-
-//    if (medianList.count() > 2)
-//    {
-//        if (medianList.count() % 2 == 0)
-//        {
-//            median = (medianList.at(medianList.count()/2) + medianList.at(medianList.count()/2+1)) / 2.0;
-//        }
-//        else
-//        {
-//            median = medianList.at(medianList.count()/2+1);
-//        }
-//    }
+
+    /* Update min/max pyramid, the first sample of a bucket resets it */
+    for (int level = 0; level < levels.count(); level++) {
+        int shift = PYRAMID_SHIFT * (level + 1);
+        MinMax& bucket = levels[level][(count >> shift) & (levels[level].count() - 1)];
+        if ((count & ((Q_UINT64_C(1) << shift) - 1)) == 0) {
+            bucket.min = value;
+            bucket.max = value;
+        } else {
+            if (value < bucket.min) bucket.min = value;
+            if (value > bucket.max) bucket.max = value;
+        }
+    }
+
+    count++;
+
+    if ((count & 0xFFFF) == 0) {
+        _recalcWindow();
+    } else {
+        quint64 windowCount = qMin(static_cast<quint64>(averageWindow), count);
+        mean = windowSum / windowCount;
+        variance = qMax(0.0, windowSumSquares / windowCount - mean * mean);
+    }
 
     // Update statistical values
     if(ms < startTime) startTime = ms;
     if(ms > stopTime) stopTime = ms;
-    interval = stopTime - startTime;
 
-    if (interval > plotInterval) {
-        while (this->ms[count - plotCount] < stopTime - plotInterval) {
-            plotCount--;
+    if(minValue > value) minValue = value;
+    if(maxValue < value) maxValue = value;
+
+    dataMutex.unlock();
+}
+
+/**
+ * @brief Index of the first held sample with a time not less than ms
+ **/
+int TimeSeriesData::_lowerBound(double ms) const
+{
+    quint64 first = count - static_cast<quint64>(getCount());
+    int lo = 0;
+    int hi = getCount();
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (this->ms[(first + mid) & mask] < ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
+    return lo;
+}
 
-    count++;
-    plotCount++;
+/**
+ * @brief Min and max over the absolute sample range [first, last)
+ * Uses the largest aligned pyramid bucket that fits at each step, so the cost is logarithmic in
+ * the length of the range.
+ **/
+void TimeSeriesData::_rangeMinMax(quint64 first, quint64 last, double& min, double& max) const
+{
+    min = DBL_MAX;
+    max = -DBL_MAX;
+
+    quint64 pos = first;
+    while (pos < last) {
+        int level = levels.count() - 1;
+        for (; level >= 0; level--) {
+            quint64 bucketSize = Q_UINT64_C(1) << (PYRAMID_SHIFT * (level + 1));
+            if ((pos & (bucketSize - 1)) == 0 && pos + bucketSize <= last) {
+                const MinMax& bucket = levels[level][(pos >> (PYRAMID_SHIFT * (level + 1))) & (levels[level].count() - 1)];
+                if (bucket.min < min) min = bucket.min;
+                if (bucket.max > max) max = bucket.max;
+                pos += bucketSize;
+                break;
+            }
+        }
+        if (level < 0) {
+            double v = value[pos & mask];
+            if (v < min) min = v;
+            if (v > max) max = v;
+            pos++;
+        }
+    }
+}
 
-    if(minValue > value) minValue = value;
-    if(maxValue < value) maxValue = value;
+void TimeSeriesData::decimate(double minTime, double maxTime, int pixels, QVector<QPointF>& points)
+{
+    dataMutex.lock();
 
-    // Trim dataset if necessary
-    if(maxInterval > 0) {
-        // maxInterval = 0 means infinite
-
-        if(interval > maxInterval && !this->ms.isEmpty() && !this->value.isEmpty()) {
-            // The time at which this time series should be cut
-            double minTime = stopTime - maxInterval;
-            // Delete elements from the start of the list as long the time
-            // value of this elements is before the cut time
-            while(this->ms.first() < minTime) {
-                this->ms.pop_front();
-                this->value.pop_front();
+    points.resize(0);
+
+    quint64 first = count - static_cast<quint64>(getCount());
+    int firstIndex = qMax(0, _lowerBound(minTime) - 1);
+    int lastIndex = qMin(getCount(), _lowerBound(maxTime) + 1);
+    int n = lastIndex - firstIndex;
+    pixels = qMax(1, pixels);
+
+    if (n <= 0) {
+        // Nothing to draw
+    } else if (n <= 2 * pixels) {
+        points.reserve(n);
+        for (int i = firstIndex; i < lastIndex; i++) {
+            quint64 pos = (first + i) & mask;
+            points.append(QPointF(ms[pos], value[pos]));
+        }
+    } else {
+        points.reserve(2 * pixels);
+        for (int column = 0; column < pixels; column++) {
+            quint64 columnFirst = first + firstIndex + (static_cast<quint64>(n) * column) / pixels;
+            quint64 columnLast = first + firstIndex + (static_cast<quint64>(n) * (column + 1)) / pixels;
+            if (columnFirst >= columnLast) {
+                continue;
             }
+            double min, max;
+            _rangeMinMax(columnFirst, columnLast, min, max);
+            points.append(QPointF(ms[columnFirst & mask], min));
+            points.append(QPointF(ms[(columnLast - 1) & mask], max));
         }
     }
+
     dataMutex.unlock();
 }
 
+QRectF TimeSeriesData::boundingRect()
+{
+    if (getCount() == 0) {
+        return QRectF(1.0, 1.0, -2.0, -2.0);    // invalid
+    }
+    return QRectF(getX(0), minValue, getX(getCount() - 1) - getX(0), maxValue - minValue);
+}
+
 /**
- * @brief Get the id of this data set
+ * @brief Get the friendly name of this data set
  *
- * @return The id-string
+ * @return The friendly name
  **/
-int TimeSeriesData::getID()
+QString TimeSeriesData::getFriendlyName()
 {
-    return id;
+    return friendlyName;
 }
 
 /**
@@ -875,6 +1000,11 @@ double TimeSeriesData::getMaxValue()
     return maxValue;
 }
 
+quint64 TimeSeriesData::getLastTime()
+{
+    return stopTime;
+}
+
 /**
  * @return the mean
  */
@@ -929,62 +1059,73 @@ void TimeSeriesData::setZeroValue(double zeroValue)
 /**
  * @brief Get the number of points in the dataset
  *
- * @return The number of points
+ * @return The number of points, never more than the capacity
  **/
 int TimeSeriesData::getCount() const
+{
+    return static_cast<int>(qMin(count, static_cast<quint64>(capacity)));
+}
+
+quint64 TimeSeriesData::getTotalCount() const
 {
     return count;
 }
 
-/**
- * @brief Get the number of points in the plot selection
- *
- * @return The number of points
- **/
-int TimeSeriesData::getPlotCount() const
+int TimeSeriesData::getCapacity() const
 {
-    return plotCount;
+    return capacity;
 }
 
 /**
- * @brief Get the data array size
- * The data array size is \e NOT equal to the number of items in the data set, as
- * array space is pre-allocated. Use getCount() to get the number of data points.
+ * @brief Get the X (time) value of a sample
  *
- * @return The data array size
- * @see getCount()
+ * @param index Sample index, 0 is the oldest sample held
+ * @return The x value
  **/
-int TimeSeriesData::size() const
+double TimeSeriesData::getX(int index) const
 {
-    return ms.size();
+    return ms[(count - getCount() + index) & mask];
 }
 
 /**
- * @brief Get the X (time) values
+ * @brief Get the Y (data) value of a sample
  *
- * @return The x values
+ * @param index Sample index, 0 is the oldest sample held
+ * @return The y value
  **/
-const double* TimeSeriesData::getX() const
+double TimeSeriesData::getY(int index) const
 {
-    return ms.data();
+    return value[(count - getCount() + index) & mask];
 }
 
-const double* TimeSeriesData::getPlotX() const
+
+TimeSeriesCurveData::TimeSeriesCurveData(TimeSeriesData* series)
+    : _series(series)
 {
-    return ms.data() + (count - plotCount);
+
 }
 
-/**
- * @brief Get the Y (data) values
- *
- * @return The y values
- **/
-const double* TimeSeriesData::getY() const
+size_t TimeSeriesCurveData::size(void) const
 {
-    return value.data();
+    return _points.count();
 }
 
-const double* TimeSeriesData::getPlotY() const
+QPointF TimeSeriesCurveData::sample(size_t i) const
 {
-    return value.data() + (count - plotCount);
+    return _points[static_cast<int>(i)];
+}
+
+QRectF TimeSeriesCurveData::boundingRect(void) const
+{
+    return _series->boundingRect();
+}
+
+void TimeSeriesCurveData::setRectOfInterest(const QRectF& rect)
+{
+    int pixels = 1000;
+    QwtPlot* plot = _series->getPlot();
+    if (plot && plot->canvas()) {
+        pixels = plot->canvas()->width();
+    }
+    _series->decimate(rect.left(), rect.right(), pixels, _points);
 }
@@ -23,12 +23,14 @@
 #define QUINT64_MAX Q_UINT64_C(18446744073709551615)
 
 #include <QMap>
+#include <QHash>
 #include <QList>
 #include <QMutex>
 #include <QTime>
 #include <QTimer>
 #include <qwt_plot_panner.h>
 #include <qwt_plot_curve.h>
+#include <qwt_series_data.h>
 #include <qwt_scale_draw.h>
 #include <qwt_scale_widget.h>
 #include <qwt_scale_engine.h>
@@ -58,32 +60,56 @@ class QwtPlotCurve;
 /**
  * @brief Container class for the time series data
  *
+ * Samples are kept in a fixed size ring, so the memory used by a series is bounded no matter how
+ * long data keeps arriving. Once the ring is full the oldest samples are dropped. Alongside the raw
+ * samples a min/max pyramid is maintained (each level aggregates PYRAMID_FANOUT buckets of the level
+ * below) so that a view of any length can be decimated to a min/max envelope per pixel column
+ * without touching every sample.
  **/
 class TimeSeriesData
 {
 public:
 
-    TimeSeriesData(QwtPlot* plot, QString friendlyName = "data", quint64 plotInterval = 10000, quint64 maxInterval = 0, double zeroValue = 0);
+    TimeSeriesData(QwtPlot* plot, QString friendlyName = "data", double zeroValue = 0, int capacity = DEFAULT_CAPACITY);
     ~TimeSeriesData();
 
     void append(quint64 ms, double value);
 
-    QwtScaleMap* getScaleMap();
-
+    /** @brief Number of samples currently held, at most getCapacity() */
     int getCount() const;
-    int size() const;
-    const double* getX() const;
-    const double* getY() const;
+    /** @brief Number of samples appended since creation, including those already dropped */
+    quint64 getTotalCount() const;
+    int getCapacity() const;
+
+    /** @brief Time of sample index, 0 is the oldest sample held */
+    double getX(int index) const;
+    /** @brief Value of sample index, 0 is the oldest sample held */
+    double getY(int index) const;
+
+    /**
+     * @brief Decimate the samples within a time range
+     *
+     * If the range holds more than two samples per pixel column the result is a min/max pair
+     * per column, otherwise the raw samples. The samples at or just past either edge of the range
+     * are included so lines run to the edge of the plot.
+     *
+     * @param minTime Left edge of the range, in milliseconds
+     * @param maxTime Right edge of the range, in milliseconds
+     * @param pixels Number of pixel columns available for the range
+     * @param points Decimated points, replaced
+     */
+    void decimate(double minTime, double maxTime, int pixels, QVector<QPointF>& points);
 
-    const double* getPlotX() const;
-    const double* getPlotY() const;
-    int getPlotCount() const;
+    /** @brief Rectangle containing all samples held */
+    QRectF boundingRect();
 
-    int getID();
+    QwtPlot* getPlot() const { return plot; }
     QString getFriendlyName();
     double getMinValue();
     double getMaxValue();
     double getZeroValue();
+    /** @brief Get the time of the last inserted value */
+    quint64 getLastTime();
     /** @brief Get the short-term mean */
     double getMean();
     /** @brief Get the short-term median */
@@ -93,18 +119,16 @@ public:
     /** @brief Get the current value */
     double getCurrentValue();
     void setZeroValue(double zeroValue);
-    void setInterval(quint64 ms);
     void setAverageWindowSize(int windowSize);
 
+    static const int DEFAULT_CAPACITY = 1 << 17;    ///< ~2.8 MB per series including the pyramid, 43 minutes at 50 Hz
+    static const int PYRAMID_SHIFT = 2;             ///< log2 of the pyramid fanout
+    static const int PYRAMID_FANOUT = 1 << PYRAMID_SHIFT;
+
 protected:
     QwtPlot* plot;
     quint64 startTime;
     quint64 stopTime;
-    quint64 interval;
-    quint64 plotInterval;
-    quint64 maxInterval;
-    int id;
-    quint64 plotCount;
     QString friendlyName;
 
     double lastValue; ///< The last inserted value
@@ -114,23 +138,52 @@ protected:
 
     QMutex dataMutex;
 
-    QwtScaleMap* scaleMap;
-
-    void updateScaleMap();
-
 private:
-    quint64 count;
+    struct MinMax {
+        double min;
+        double max;
+    };
+
+    int _lowerBound(double ms) const;
+    void _rangeMinMax(quint64 first, quint64 last, double& min, double& max) const;
+    void _recalcWindow();
+
+    int capacity;               ///< Ring size, power of 2
+    quint64 mask;
+    quint64 count;              ///< Total number of samples appended
     QVector<double> ms;
     QVector<double> value;
+    QVector< QVector<MinMax> > levels;  ///< levels[k] buckets cover PYRAMID_FANOUT^(k+1) samples
     double mean;
     double median;
     double variance;
+    double windowSum;           ///< Sum of values in average window
+    double windowSumSquares;    ///< Sum of squared values in average window
     unsigned int averageWindow;
-    QVector<double> outputMs;
-    QVector<double> outputValue;
 };
 
+/**
+ * @brief Qwt adapter which feeds a curve with the decimated samples of a TimeSeriesData
+ *
+ * Qwt calls setRectOfInterest with the visible scale rectangle on every replot, which is where the
+ * decimation happens. The number of points handed to the curve is therefore bounded by the canvas
+ * width rather than the number of samples.
+ **/
+class TimeSeriesCurveData : public QwtSeriesData<QPointF>
+{
+public:
+    TimeSeriesCurveData(TimeSeriesData* series);
 
+    // Overrides from QwtSeriesData
+    size_t  size                (void) const override;
+    QPointF sample              (size_t i) const override;
+    QRectF  boundingRect        (void) const override;
+    void    setRectOfInterest   (const QRectF& rect) override;
+
+private:
+    TimeSeriesData*     _series;
+    QVector<QPointF>    _points;
+};
 
 
 
@@ -140,6 +193,9 @@ private:
 class LinechartPlot : public ChartPlot
 {
     Q_OBJECT
+
+    friend class LinechartPlotTest;
+
 public:
     LinechartPlot(QWidget *parent = NULL, int plotid=0, quint64 interval = LinechartPlot::DEFAULT_PLOT_INTERVAL);
     virtual ~LinechartPlot();
@@ -147,6 +203,14 @@ public:
     void setZeroValue(QString id, double zeroValue);
     void removeAllData();
 
+    /**
+     * @brief Get the integer id of a curve, creating the curve if it does not exist yet
+     *
+     * Ids are used with the fast path appendData(int, quint64, double) to avoid looking
+     * up the curve by name for every value.
+     */
+    int getSeriesId(const QString& dataname);
+
     QList<QwtPlotCurve*> getCurves();
     bool isVisible(QString id);
     /** @brief Check if any curve is visible */
@@ -193,6 +257,12 @@ public slots:
      * @param value value of the data point
      */
     void appendData(QString dataname, quint64 ms, double value);
+    /**
+     * @brief Append data to the curve with the given series id
+     *
+     * @return false if the curve for the id has been removed, a new id must be requested
+     */
+    bool appendData(int seriesId, quint64 ms, double value);
     void hideCurve(QString id);
     void showCurve(QString id);
     /** @brief Enable auto-refreshing of plot */
@@ -233,7 +303,8 @@ public slots:
 protected:
     QMap<QString, TimeSeriesData*> data;
     QMap<QString, QwtScaleMap*> scaleMaps;
-    QMap<QString, quint64> lastUpdate;
+    QHash<QString, int> seriesIds;          ///< Curve name to series id
+    QVector<TimeSeriesData*> seriesById;    ///< Series indexed by series id, NULL once removed
 
     //static const quint64 MAX_STORAGE_INTERVAL = Q_UINT64_C(300000);
     static const quint64 MAX_STORAGE_INTERVAL = Q_UINT64_C(0);  ///< The maximum interval which is stored
@@ -267,6 +338,7 @@ protected:
 
     // Methods
     void addCurve(QString id);
+    void removeSeries(const QString& id);
     void showEvent(QShowEvent* event);
     void hideEvent(QHideEvent* event);
 
@@ -42,7 +42,7 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 
-LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent),
+LinechartWidget::LinechartWidget(int systemid, MAVLinkDecoder* decoder, QWidget *parent) : QWidget(parent),
     sysid(systemid),
     activePlot(NULL),
     curvesLock(new QReadWriteLock()),
@@ -53,6 +53,7 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     curveMeans(new QMap<QString, QLabel*>()),
     curveMedians(new QMap<QString, QLabel*>()),
     curveVariances(new QMap<QString, QLabel*>()),
+    decoder(decoder),
     logFile(new QFile()),
     logindex(1),
     logging(false),
@@ -305,6 +306,41 @@ void LinechartWidget::toggleLogarithmicScaling(bool checked)
 }
 
 void LinechartWidget::appendData(int uasId, const QString& curve, const QString& unit, const QVariant &variant, quint64 usec)
+{
+    QString curveID = curve + unit;
+
+    QHash<QString, CurveSeries>::iterator iter = namedCurves.find(curveID);
+    if (iter == namedCurves.end()) {
+        CurveSeries series;
+        series.curve = curve;
+        series.unit = unit;
+        series.curveID = curveID;
+        iter = namedCurves.insert(curveID, series);
+    }
+    appendSeriesData(uasId, iter.value(), variant, usec);
+}
+
+void LinechartWidget::appendCurveData(int uasId, int curveId, const QVariant& variant, quint64 usec)
+{
+    if (curveId < 0) {
+        return;
+    }
+    if (curveId >= decoderCurves.count()) {
+        decoderCurves.resize(curveId + 1);
+    }
+
+    // The name of a decoder curve is looked up once, after that values go straight to the plot series
+    CurveSeries& series = decoderCurves[curveId];
+    if (series.curveID.isEmpty()) {
+        if (!decoder || !decoder->curve(curveId, series.curve, series.unit)) {
+            return;
+        }
+        series.curveID = series.curve + series.unit;
+    }
+    appendSeriesData(uasId, series, variant, usec);
+}
+
+void LinechartWidget::appendSeriesData(int uasId, CurveSeries& series, const QVariant& variant, quint64 usec)
 {
     QMetaType::Type type = static_cast<QMetaType::Type>(variant.type());
     bool ok;
@@ -312,25 +348,28 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
     if(!ok || type == QMetaType::QByteArray || type == QMetaType::QString)
         return;
     bool isDouble = type == QMetaType::Float || type == QMetaType::Double;
-    QString curveID = curve + unit;
 
     if ((selectedMAV == -1 && isVisible()) || (selectedMAV == uasId && isVisible()))
     {
-        // Order matters here, first append to plot, then update curve list
-        activePlot->appendData(curveID, usec, value);
-        // Store data
-        QLabel* label = curveLabels->value(curveID, NULL);
-        // Make sure the curve will be created if it does not yet exist
-        if(!label)
-        {
-            if(!isDouble)
-                intData.insert(curveID, 0);
-            addCurve(curve, unit);
+        // Order matters here, first append to plot, then update curve list.
+        // The series id fails once the plot removed the curve, it is resolved again and the curve list entry recreated.
+        if (!activePlot->appendData(series.seriesId, usec, value)) {
+            series.seriesId = activePlot->getSeriesId(series.curveID);
+            activePlot->appendData(series.seriesId, usec, value);
+
+            // Make sure the curve will be created if it does not yet exist
+            if (!curveLabels->contains(series.curveID))
+            {
+                if(!isDouble)
+                    intData.insert(series.curveID, 0);
+                addCurve(series.curve, series.unit);
+            }
+            series.intValue = isDouble ? NULL : &intData[series.curveID];
         }
 
         // Add int data
-        if(!isDouble)
-            intData.insert(curveID, variant.toInt());
+        if(series.intValue)
+            *series.intValue = variant.toInt();
     }
 
     if (lastTimestamp == 0 && usec != 0)
@@ -353,14 +392,14 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
     // Log data
     if (logging)
     {
-        if (activePlot->isVisible(curveID))
+        if (activePlot->isVisible(series.curveID))
         {
             if (usec == 0) usec = QGC::groundTimeMilliseconds();
             if (logStartTime == 0) logStartTime = usec;
             qint64 time = usec - logStartTime;
             if (time < 0) time = 0;
 
-            QString line = QString("%1\t%2\t%3\t%4\n").arg(time).arg(uasId).arg(curve).arg(value, 0, 'e', 15);
+            QString line = QString("%1\t%2\t%3\t%4\n").arg(time).arg(uasId).arg(series.curve).arg(value, 0, 'e', 15);
             logFile->write(line.toLatin1());
         }
     }
@@ -27,6 +27,7 @@
 #include <QScrollBar>
 #include <QSpinBox>
 #include <QMap>
+#include <QHash>
 #include <QString>
 #include <QAction>
 #include <QIcon>
@@ -37,6 +38,7 @@
 #include <qwt_plot_curve.h>
 
 #include "LinechartPlot.h"
+#include "MAVLinkDecoder.h"
 #include "UASInterface.h"
 #include "ui_Linechart.h"
 
@@ -51,7 +53,7 @@ class LinechartWidget : public QWidget
     Q_OBJECT
 
 public:
-    LinechartWidget(int systemid, QWidget *parent = 0);
+    LinechartWidget(int systemid, MAVLinkDecoder* decoder = NULL, QWidget *parent = 0);
     ~LinechartWidget();
 
     static const int MIN_TIME_SCROLLBAR_VALUE = 0; ///< The minimum scrollbar value
@@ -66,6 +68,8 @@ public slots:
     void setShortNames(bool enable);
     /** @brief Append data to the given curve. */
     void appendData(int uasId, const QString& curve, const QString& unit, const QVariant& value, quint64 usec);
+    /** @brief Append data to the decoder curve with the given id, see MAVLinkDecoder::curveValueChanged */
+    void appendCurveData(int uasId, int curveId, const QVariant& value, quint64 usec);
     /** @brief Hide curves which do not match the filter pattern */
     void filterCurves(const QString &filter);
 
@@ -113,6 +117,17 @@ protected:
     /** @brief Get the name for a curve key */
     QString getCurveName(const QString& key, bool shortEnabled);
 
+    /// A curve resolved to its plot series, so values can be appended without looking up the curve by name
+    struct CurveSeries {
+        CurveSeries() : seriesId(-1), intValue(NULL) {}
+        QString curve;
+        QString unit;
+        QString curveID;    ///< curve + unit, key of the curve in the curve list
+        int     seriesId;   ///< Plot series id, -1 until resolved
+        int*    intValue;   ///< Entry in intData for integer-valued curves
+    };
+    void appendSeriesData(int uasId, CurveSeries& series, const QVariant& variant, quint64 usec);
+
     int sysid;                            ///< ID of the unmanned system this plot belongs to
     LinechartPlot* activePlot;            ///< Plot for this system
     QReadWriteLock* curvesLock;           ///< A lock (mutex) for the concurrent access on the curves
@@ -127,7 +142,10 @@ protected:
     QMap<QString, QLabel*>* curveMedians; ///< References to the curve medians
     QMap<QString, QWidget*> curveUnits;    ///< References to the curve units
     QMap<QString, QLabel*>* curveVariances; ///< References to the curve variances
-    QMap<QString, int> intData;           ///< Current values for integer-valued curves
+    QMap<QString, int> intData;           ///< Current values for integer-valued curves, never removed as CurveSeries points into it
+    QHash<QString, CurveSeries> namedCurves;  ///< Curves appended by name, keyed by curve + unit
+    QVector<CurveSeries> decoderCurves;   ///< Curves appended by decoder curve id, indexed by id
+    MAVLinkDecoder* decoder;              ///< Source of curve names for decoder curve ids
     QMap<QString, QWidget*> colorIcons;    ///< Reference to color icons
     QMap<QString, QCheckBox*> checkBoxes;    ///< Reference to checkboxes
 
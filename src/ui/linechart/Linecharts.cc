@@ -16,13 +16,13 @@ Linecharts::Linecharts(const QString& title, QAction* action, MAVLinkDecoder* de
 
 QWidget* Linecharts::_newVehicleWidget(Vehicle* vehicle, QWidget* parent)
 {
-    LinechartWidget* widget = new LinechartWidget(vehicle->id(), parent);
+    LinechartWidget* widget = new LinechartWidget(vehicle->id(), _mavlinkDecoder, parent);
 
     // Connect valueChanged signals
     connect(vehicle->uas(), &UAS::valueChanged, widget, &LinechartWidget::appendData);
 
     // Connect decoder
-    connect(_mavlinkDecoder, &MAVLinkDecoder::valueChanged, widget, &LinechartWidget::appendData);
+    connect(_mavlinkDecoder, &MAVLinkDecoder::curveValueChanged, widget, &LinechartWidget::appendCurveData);
 
     // Select system
     widget->setActive(true);
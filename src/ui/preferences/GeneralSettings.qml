@@ -343,6 +343,17 @@ QGCView {
                                         fact:                   QGroundControl.settingsManager.appSettings.defaultMissionItemAltitude
                                     }
                                 }
+
+                                RowLayout {
+                                    spacing:    ScreenTools.defaultFontPixelWidth
+                                    visible:    QGroundControl.settingsManager.appSettings.kmlImportSimplifyTolerance.visible
+
+                                    QGCLabel { text: qsTr("KML Import Simplify Tolerance") }
+                                    FactTextField {
+                                        Layout.preferredWidth:  _valueFieldWidth
+                                        fact:                   QGroundControl.settingsManager.appSettings.kmlImportSimplifyTolerance
+                                    }
+                                }
                             }
                         }
 
@@ -565,6 +576,39 @@ QGCView {
                                 anchors.verticalCenter: parent.verticalCenter
                             }
                         }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.settingsManager.videoSettings.poolSize.visible
+                            QGCLabel {
+                                text:               qsTr("Warm Video Streams")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                width:      _editFieldWidth
+                                fact:       QGroundControl.settingsManager.videoSettings.poolSize
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.settingsManager.videoSettings.decoderThreads.visible
+                            QGCLabel {
+                                text:               qsTr("Decoder Threads")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                width:      _editFieldWidth
+                                fact:       QGroundControl.settingsManager.videoSettings.decoderThreads
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
+                        FactCheckBox {
+                            text:       qsTr("Drop late video frames")
+                            fact:       QGroundControl.settingsManager.videoSettings.leakyQueue
+                            visible:    QGroundControl.settingsManager.videoSettings.leakyQueue.visible
+                        }
                         Row {
                             spacing:    ScreenTools.defaultFontPixelWidth
                             visible:    QGroundControl.settingsManager.videoSettings.udpPort.visible && QGroundControl.videoManager.isGStreamer && videoSource.currentIndex === 1
@@ -672,6 +716,26 @@ QGCView {
                                 fact:                   QGroundControl.settingsManager.videoSettings.recordingFormat
                                 visible:                QGroundControl.settingsManager.videoSettings.recordingFormat.visible
                             }
+
+                            QGCLabel {
+                                text:       qsTr("Pre-Roll")
+                                visible:    QGroundControl.settingsManager.videoSettings.recordingPreRoll.visible
+                            }
+                            FactTextField {
+                                Layout.preferredWidth:  _comboFieldWidth
+                                fact:                   QGroundControl.settingsManager.videoSettings.recordingPreRoll
+                                visible:                QGroundControl.settingsManager.videoSettings.recordingPreRoll.visible
+                            }
+
+                            QGCLabel {
+                                text:       qsTr("Segment Duration")
+                                visible:    QGroundControl.settingsManager.videoSettings.recordingSegmentDuration.visible
+                            }
+                            FactTextField {
+                                Layout.preferredWidth:  _comboFieldWidth
+                                fact:                   QGroundControl.settingsManager.videoSettings.recordingSegmentDuration
+                                visible:                QGroundControl.settingsManager.videoSettings.recordingSegmentDuration.visible
+                            }
                         }
                     }
 
@@ -160,6 +160,13 @@ QGCView {
                                 width: shutdownButton.width
                                 onClicked: confirmAction(confirmRestart)
                             }
+                            QGCLabel {
+                                visible:    QGroundControl.nodeSelector.commandsTotal > 0
+                                text:       qsTr("%1 of %2 node commands done, %3 failed")
+                                                .arg(QGroundControl.nodeSelector.commandsTotal - QGroundControl.nodeSelector.commandsPending)
+                                                .arg(QGroundControl.nodeSelector.commandsTotal)
+                                                .arg(QGroundControl.nodeSelector.commandsFailed)
+                            }
                         }
                     } // Rectangle - System Control
                 } // OS control column
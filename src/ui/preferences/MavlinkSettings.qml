@@ -68,6 +68,16 @@ Rectangle {
         }
     }
 
+    function _rttHistogramText(limits, histogram)
+    {
+        var text = ""
+        for (var i = 0; i < histogram.length; i++) {
+            var label = i < limits.length ? "<" + limits[i] : ">" + limits[limits.length - 1]
+            text += (i > 0 ? "  " : "") + label + ": " + histogram[i]
+        }
+        return text
+    }
+
     MessageDialog {
         id:         emptyEmailDialog
         visible:    false
@@ -152,6 +162,62 @@ Rectangle {
                 }
             }
             //-----------------------------------------------------------------
+            //-- Link Status
+            Item {
+                width:              __mavlinkRoot.width * 0.8
+                height:             linkStatusLabel.height
+                anchors.margins:    ScreenTools.defaultFontPixelWidth
+                anchors.horizontalCenter: parent.horizontalCenter
+                QGCLabel {
+                    id:             linkStatusLabel
+                    text:           qsTr("Link Status")
+                    font.family:    ScreenTools.demiboldFontFamily
+                }
+            }
+            Rectangle {
+                height:         linkStatusColumn.height + (ScreenTools.defaultFontPixelHeight * 2)
+                width:          __mavlinkRoot.width * 0.8
+                color:          qgcPal.windowShade
+                anchors.margins: ScreenTools.defaultFontPixelWidth
+                anchors.horizontalCenter: parent.horizontalCenter
+                Column {
+                    id:         linkStatusColumn
+                    width:      gcsColumn.width
+                    spacing:    _columnSpacing
+                    anchors.centerIn: parent
+                    Repeater {
+                        model: QGroundControl.linkManager.linkConfigurations
+                        Column {
+                            spacing:    _columnSpacing
+                            visible:    object.link
+                            property var _metrics: object.link ? object.link.metrics : null
+                            QGCLabel {
+                                text:           object.name
+                                font.family:    ScreenTools.demiboldFontFamily
+                            }
+                            Repeater {
+                                model: _metrics ? _metrics.factNames : 0
+                                Row {
+                                    spacing:    ScreenTools.defaultFontPixelWidth
+                                    property Fact _fact: _metrics.getFact(modelData)
+                                    QGCLabel {
+                                        width:  _labelWidth
+                                        text:   _fact.shortDescription + ":"
+                                    }
+                                    QGCLabel {
+                                        text:   _fact.valueString + " " + _fact.units
+                                    }
+                                }
+                            }
+                            QGCLabel {
+                                text:       _metrics ? qsTr("Round trip histogram (ms): ") + _rttHistogramText(_metrics.rttBucketLimits, _metrics.rttHistogram) : ""
+                                visible:    _metrics ? !isNaN(_metrics.rtt.rawValue) : false
+                            }
+                        }
+                    }
+                }
+            }
+            //-----------------------------------------------------------------
             //-- Mavlink Logging
             Item {
                 width:              __mavlinkRoot.width * 0.8
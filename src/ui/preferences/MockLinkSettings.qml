@@ -36,6 +36,12 @@ Item {
             subEditConfig.firmware = 0
         subEditConfig.sendStatus = sendStatus.checked
         subEditConfig.highLatency = highLatency.checked
+        subEditConfig.vehicleCount = parseInt(vehicleCountField.text)
+        subEditConfig.rateProfile = rateProfileCombo.currentIndex
+        subEditConfig.packetLossPercent = parseInt(packetLossField.text)
+        subEditConfig.jitterMsecs = parseInt(jitterField.text)
+        subEditConfig.reorderPercent = parseInt(reorderField.text)
+        subEditConfig.mavlink1 = mavlink1.checked
     }
 
     Component.onCompleted: {
@@ -51,6 +57,12 @@ Item {
             copterVehicle.checked = true
         sendStatus.checked = subEditConfig.sendStatus
         highLatency.checked = subEditConfig.highLatency
+        vehicleCountField.text = subEditConfig.vehicleCount.toString()
+        rateProfileCombo.currentIndex = subEditConfig.rateProfile
+        packetLossField.text = subEditConfig.packetLossPercent.toString()
+        jitterField.text = subEditConfig.jitterMsecs.toString()
+        reorderField.text = subEditConfig.reorderPercent.toString()
+        mavlink1.checked = subEditConfig.mavlink1
     }
 
     Column {
@@ -123,5 +135,47 @@ Item {
                 exclusiveGroup: apmVehicleGroup
             }
         }
+        Item {
+            height: ScreenTools.defaultFontPixelHeight / 2
+            width:  parent.width
+        }
+        QGCLabel {
+            text:   qsTr("Load Generator")
+        }
+        GridLayout {
+            columns:        2
+            columnSpacing:  ScreenTools.defaultFontPixelWidth
+
+            QGCLabel { text: qsTr("Vehicles:") }
+            QGCTextField {
+                id:                 vehicleCountField
+                inputMethodHints:   Qt.ImhDigitsOnly
+            }
+            QGCLabel { text: qsTr("Telemetry rates:") }
+            QGCComboBox {
+                id:     rateProfileCombo
+                model:  [ qsTr("Standard"), qsTr("Telemetry radio"), qsTr("Onboard") ]
+            }
+            QGCLabel { text: qsTr("Packet loss (%):") }
+            QGCTextField {
+                id:                 packetLossField
+                inputMethodHints:   Qt.ImhDigitsOnly
+            }
+            QGCLabel { text: qsTr("Jitter (msecs):") }
+            QGCTextField {
+                id:                 jitterField
+                inputMethodHints:   Qt.ImhDigitsOnly
+            }
+            QGCLabel { text: qsTr("Reordered (%):") }
+            QGCTextField {
+                id:                 reorderField
+                inputMethodHints:   Qt.ImhDigitsOnly
+            }
+        }
+        QGCCheckBox {
+            id:         mavlink1
+            text:       qsTr("MAVLink 1")
+            checked:    false
+        }
     }
 }